@@ -18,13 +18,15 @@ RED='\033[0;31m'
 NC='\033[0m' # No Color
 
 # Function to run a test and check its exit code
+# Options after the file name are passed to tiny_node before it
 run_test() {
     local test_file="$1"
+    shift
     echo -e "\n${GREEN}===============================================${NC}"
-    echo -e "${GREEN}Running test: $test_file${NC}"
+    echo -e "${GREEN}Running test: $test_file $*${NC}"
     echo -e "${GREEN}===============================================${NC}"
     
-    if ./build/bin/tiny_node "test/$test_file"; then
+    if ./build/bin/tiny_node "$@" "test/$test_file"; then
         echo -e "${GREEN}✓ Test $test_file passed${NC}"
         return 0
     else
@@ -52,6 +54,15 @@ for test_file in $TEST_FILES; do
     fi
 done
 
+# Time slicing is opt-in, so check it with a run that turns it on
+((TOTAL++))
+if run_test scheduler_test.js --time-slice=5; then
+    ((PASSED++))
+else
+    ((FAILED++))
+    FAILED_TESTS="$FAILED_TESTS scheduler_test.js(--time-slice=5)"
+fi
+
 # Print summary
 echo -e "\n${GREEN}===============================================${NC}"
 echo -e "${GREEN}Test Results:${NC}"
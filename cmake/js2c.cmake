@@ -0,0 +1,55 @@
+# js2c.cmake
+# Embed the built-in JavaScript modules from lib/ into a C++ source file
+#
+# Usage:
+#  cmake -DLIB_DIR=<dir> -DOUTPUT=<file> -P js2c.cmake
+#
+# Every lib/<id>.js becomes a static byte array and an entry in the
+# kBuiltinSources table declared in include/builtins.h.
+
+if(NOT LIB_DIR OR NOT OUTPUT)
+  message(FATAL_ERROR "js2c.cmake requires LIB_DIR and OUTPUT")
+endif()
+
+file(GLOB JS_FILES "${LIB_DIR}/*.js")
+list(SORT JS_FILES)
+
+set(ARRAYS "")
+set(ENTRIES "")
+set(COUNT 0)
+
+foreach(JS_FILE ${JS_FILES})
+  get_filename_component(MODULE_ID ${JS_FILE} NAME_WE)
+  string(MAKE_C_IDENTIFIER ${MODULE_ID} SYMBOL)
+
+  file(READ ${JS_FILE} HEX_CONTENT HEX)
+
+  # Sources become external one-byte strings, so they must be pure ASCII
+  string(REGEX MATCH "^(..)*[89a-f]." NON_ASCII "${HEX_CONTENT}")
+  if(NON_ASCII)
+    message(FATAL_ERROR "Built-in module ${JS_FILE} contains non-ASCII characters")
+  endif()
+
+  string(LENGTH "${HEX_CONTENT}" HEX_LENGTH)
+  math(EXPR BYTE_LENGTH "${HEX_LENGTH} / 2")
+  string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX_CONTENT}")
+
+  string(APPEND ARRAYS "static const uint8_t k_${SYMBOL}_source[] = {${BYTES}};\n")
+  string(APPEND ENTRIES "    {\"${MODULE_ID}\", k_${SYMBOL}_source, ${BYTE_LENGTH}},\n")
+  math(EXPR COUNT "${COUNT} + 1")
+endforeach()
+
+if(COUNT EQUAL 0)
+  # Keep the table well-formed when lib/ is empty
+  set(ENTRIES "    {nullptr, nullptr, 0},\n")
+endif()
+
+set(CONTENT "// Generated by cmake/js2c.cmake. Do not edit.\n#include \"builtins.h\"\n\n${ARRAYS}\nextern const BuiltinSource kBuiltinSources[] = {\n${ENTRIES}};\n\nextern const size_t kBuiltinSourceCount = ${COUNT};\n")
+
+# Only touch the output when it changes to avoid needless rebuilds
+if(EXISTS ${OUTPUT})
+  file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT "${OLD_CONTENT}" STREQUAL "${CONTENT}")
+  file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
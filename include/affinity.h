@@ -0,0 +1,108 @@
+#ifndef TINY_NODEJS_AFFINITY_H
+#define TINY_NODEJS_AFFINITY_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Set of CPUs a thread may run on, named by CPU or by NUMA node
+ * 
+ * An affinity is written as a CPU list, "0-3,8", or as a list of NUMA
+ * nodes, "node:0,1", which stands for every CPU of those nodes. The same
+ * syntax is used by the tiny_node command line, RuntimeOptions and the
+ * workerpool module.
+ * 
+ * Threads started from an affinity are given slots: with a node list, slot
+ * i is pinned to the CPUs of node i modulo the number of nodes, so a pool of
+ * threads is spread evenly over the nodes; with a CPU list every slot may
+ * use every listed CPU. Linux places memory on the node of the thread that
+ * first touches it, so a pinned thread's stacks, isolate heap, queues and
+ * read slabs stay on its node.
+ */
+class CpuAffinity {
+public:
+    CpuAffinity() = default;
+    
+    /**
+     * @brief Parse an affinity
+     *
+     * @param spec "0-3,8" for CPUs or "node:0,1" for NUMA nodes
+     * @param affinity Receives the parsed affinity
+     * @param error Receives a description of what is wrong with spec
+     * @return true if spec was valid and names CPUs or nodes that exist
+     */
+    static bool Parse(const std::string& spec, CpuAffinity* affinity, std::string* error);
+    
+    /**
+     * @brief Check whether the affinity restricts anything
+     *
+     * @return false for a default-constructed affinity
+     */
+    bool IsSet() const { return !cpus_.empty(); }
+    
+    /**
+     * @brief Get the NUMA nodes the affinity was given as
+     *
+     * @return Node numbers, empty for an affinity given as a CPU list
+     */
+    const std::vector<int>& GetNodes() const { return nodes_; }
+    
+    /**
+     * @brief Get the NUMA node a slot is pinned to
+     *
+     * @param slot Index of the thread among those started from this affinity
+     * @return Node number, or -1 for an affinity given as a CPU list
+     */
+    int GetNodeForSlot(size_t slot) const;
+    
+    /**
+     * @brief Get the CPUs a slot may run on
+     *
+     * @param slot Index of the thread among those started from this affinity
+     * @return CPU numbers
+     */
+    const std::vector<int>& GetCpusForSlot(size_t slot) const;
+    
+    /**
+     * @brief Pin the calling thread to the CPUs of a slot
+     *
+     * Does nothing for an affinity that is not set. Failures are reported
+     * on stderr and leave the thread unpinned.
+     *
+     * @param slot Index of the thread among those started from this affinity
+     * @return true if the thread was pinned or nothing was asked for
+     */
+    bool ApplyToCurrentThread(size_t slot = 0) const;
+    
+    /**
+     * @brief Get the affinity in the syntax Parse() accepts
+     *
+     * @return The affinity as a string, empty if not set
+     */
+    std::string ToString() const;
+
+private:
+    // Every CPU of the affinity
+    std::vector<int> cpus_;
+    
+    // Nodes, and the CPUs of each, for an affinity given as nodes
+    std::vector<int> nodes_;
+    std::vector<std::vector<int>> node_cpus_;
+};
+
+/**
+ * @brief Get the number of NUMA nodes
+ * 
+ * @return Number of nodes, 1 on machines without NUMA information
+ */
+int GetNumaNodeCount();
+
+/**
+ * @brief Get the NUMA node of the CPU the calling thread runs on
+ * 
+ * @return Node number, 0 if it cannot be determined
+ */
+int GetCurrentNumaNode();
+
+#endif // TINY_NODEJS_AFFINITY_H
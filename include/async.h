@@ -0,0 +1,339 @@
+#ifndef TINY_NODEJS_ASYNC_H
+#define TINY_NODEJS_ASYNC_H
+
+#include <v8.h>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Coroutines for asynchronous native functions
+ * 
+ * An asynchronous native is written as a C++20 coroutine returning JsPromise
+ * (or AsyncTask, when nothing in JavaScript waits for it) and suspends with
+ * co_await on the awaitables below instead of chaining QueueWork() and
+ * ScheduleDelayedTask() callbacks by hand:
+ * 
+ *     static JsPromise Checksum(v8::Isolate* isolate, std::string path) {
+ *         std::string data = co_await FsRead(path);
+ *         uint32_t sum = co_await RunOnPool([&data]() { return Sum(data); });
+ *         co_return v8::Integer::NewFromUnsigned(isolate, sum);
+ *     }
+ * 
+ *     args.GetReturnValue().Set(Checksum(isolate, path).GetPromise());
+ * 
+ * The coroutine runs synchronously up to its first co_await. Every later
+ * part runs in a task on the runtime's event loop, with the isolate locked,
+ * a fresh HandleScope and the context the coroutine was called from entered.
+ * Arguments and locals live in the coroutine frame, so the Globals and
+ * buffers an operation needs are held there rather than in per-callback
+ * heap allocations.
+ * 
+ * Rules for coroutine bodies:
+ * - The coroutine must be called from a V8 callback (a context is entered)
+ * - v8::Local handles do not survive a co_await; keep v8::Global in the frame
+ * - References to the caller's locals (FunctionCallbackInfo included) are
+ *   only valid until the first co_await; take arguments by value
+ * - A C++ exception leaving the body rejects the JsPromise with an Error
+ *   carrying its message
+ * 
+ * A coroutine that is suspended when its wake-up is dropped (a cancelled
+ * timer, or a task discarded at runtime shutdown) is destroyed without
+ * resuming, which releases everything in its frame.
+ */
+
+/**
+ * @brief State shared by the promise types of JsPromise and AsyncTask
+ * 
+ * Records the runtime and the calling context when the coroutine starts,
+ * and re-enters that context whenever the coroutine is resumed.
+ */
+class AsyncFrame {
+public:
+    AsyncFrame();
+    
+    AsyncFrame(const AsyncFrame&) = delete;
+    AsyncFrame& operator=(const AsyncFrame&) = delete;
+    
+    /**
+     * @brief Get the isolate the coroutine runs on
+     *
+     * @return Pointer to the V8 isolate
+     */
+    v8::Isolate* GetIsolate() const { return isolate_; }
+    
+    /**
+     * @brief Get the runtime the coroutine was started in
+     *
+     * @return Pointer to the Runtime instance
+     */
+    Runtime* GetRuntime() const { return runtime_; }
+    
+    /**
+     * @brief Resume a coroutine of this frame on the event loop
+     *
+     * Opens a HandleScope and enters the calling context around resume().
+     *
+     * @param handle The suspended coroutine
+     */
+    void Resume(std::coroutine_handle<> handle);
+
+protected:
+    v8::Isolate* isolate_;
+    Runtime* runtime_;
+    v8::Global<v8::Context> context_;
+};
+
+/**
+ * @brief Resumes a suspended coroutine once, or destroys it
+ * 
+ * Awaitables capture a shared AsyncResumer in the callbacks they hand to
+ * the runtime. If the last copy goes away without Resume() having been
+ * called, the coroutine will never be woken up and is destroyed instead.
+ * That only happens on the event loop thread with the isolate locked.
+ */
+class AsyncResumer {
+public:
+    AsyncResumer(AsyncFrame* frame, std::coroutine_handle<> handle)
+        : frame_(frame), handle_(handle) {}
+    ~AsyncResumer();
+    
+    AsyncResumer(const AsyncResumer&) = delete;
+    AsyncResumer& operator=(const AsyncResumer&) = delete;
+    
+    /**
+     * @brief Resume the coroutine in its calling context
+     */
+    void Resume();
+    
+    /**
+     * @brief Get the runtime the coroutine was started in
+     *
+     * @return Pointer to the Runtime instance
+     */
+    Runtime* GetRuntime() const { return frame_->GetRuntime(); }
+    
+    /**
+     * @brief Create a resumer for the coroutine behind a handle
+     *
+     * @param handle Handle of a JsPromise or AsyncTask coroutine
+     * @return Shared resumer
+     */
+    template <typename Promise>
+    static std::shared_ptr<AsyncResumer> For(std::coroutine_handle<Promise> handle) {
+        static_assert(std::is_base_of_v<AsyncFrame, Promise>,
+                      "Only JsPromise and AsyncTask coroutines can await runtime operations");
+        return std::make_shared<AsyncResumer>(&handle.promise(), handle);
+    }
+
+private:
+    AsyncFrame* frame_;
+    std::coroutine_handle<> handle_;
+    bool resumed_ = false;
+};
+
+/**
+ * @brief Value to co_return from a JsPromise coroutine to reject its promise
+ */
+struct Rejected {
+    v8::Local<v8::Value> reason;
+};
+
+/**
+ * @brief Coroutine that settles a JavaScript promise
+ * 
+ * Calling the coroutine creates the promise in the caller's context;
+ * co_return with a value resolves it and co_return Rejected{reason} rejects
+ * it.
+ */
+class JsPromise {
+public:
+    class promise_type : public AsyncFrame {
+    public:
+        promise_type();
+        
+        JsPromise get_return_object();
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_value(v8::Local<v8::Value> value);
+        void return_value(Rejected rejected);
+        void unhandled_exception();
+    
+    private:
+        v8::Global<v8::Promise::Resolver> resolver_;
+    };
+    
+    /**
+     * @brief Get the promise, to return to JavaScript
+     *
+     * @return The promise, in the caller's HandleScope
+     */
+    v8::Local<v8::Promise> GetPromise() const { return promise_; }
+
+private:
+    explicit JsPromise(v8::Local<v8::Promise> promise) : promise_(promise) {}
+    
+    v8::Local<v8::Promise> promise_;
+};
+
+/**
+ * @brief Coroutine that runs on the event loop without a promise
+ * 
+ * For natives that call back into JavaScript themselves, such as timers.
+ * An exception leaving the body is reported on stderr.
+ */
+class AsyncTask {
+public:
+    class promise_type : public AsyncFrame {
+    public:
+        AsyncTask get_return_object() { return AsyncTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+};
+
+/**
+ * @brief Awaitable that suspends for a delay on the event loop's timers
+ * 
+ * co_await Sleep(ms) resumes after ms milliseconds. The timer counts as
+ * pending work, so the runtime stays alive until it fires. If timer_id is
+ * given, it receives the timer's ID before the coroutine suspends, and
+ * Runtime::CancelDelayedTask() with it destroys the sleeping coroutine.
+ */
+class Sleep {
+public:
+    explicit Sleep(uint64_t delay_ms, uint64_t* timer_id = nullptr)
+        : delay_ms_(delay_ms), timer_id_(timer_id) {}
+    
+    bool await_ready() const noexcept { return false; }
+    
+    template <typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        Start(AsyncResumer::For(handle));
+    }
+    
+    void await_resume() const noexcept {}
+
+private:
+    void Start(std::shared_ptr<AsyncResumer> resumer);
+    
+    uint64_t delay_ms_;
+    uint64_t* timer_id_;
+};
+
+/**
+ * @brief Awaitable that gives the event loop a turn
+ * 
+ * co_await YieldToLoop() resumes on the next loop iteration, after the
+ * pending libuv callbacks and ahead of tasks queued in the meantime (see
+ * EventLoop::ScheduleContinuation()).
+ */
+class YieldToLoop {
+public:
+    bool await_ready() const noexcept { return false; }
+    
+    template <typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        Start(AsyncResumer::For(handle));
+    }
+    
+    void await_resume() const noexcept {}
+
+private:
+    void Start(std::shared_ptr<AsyncResumer> resumer);
+};
+
+/**
+ * @brief Queue work on the shared thread pool for an awaitable
+ * 
+ * Runs work on a pool thread through Runtime::QueueWork() and resumes the
+ * coroutine on the event loop when it is done.
+ * 
+ * @param resumer Resumer of the awaiting coroutine
+ * @param work Function to be executed on a pool thread
+ */
+void QueueAsyncWork(std::shared_ptr<AsyncResumer> resumer, std::function<void()> work);
+
+/**
+ * @brief Awaitable that runs a function on the shared thread pool
+ * 
+ * co_await RunOnPool(fn) evaluates to what fn returns, and rethrows what it
+ * throws. fn runs on a pool thread and must not touch V8; it may refer to
+ * the coroutine's locals, which stay put while it runs.
+ */
+template <typename Work>
+class RunOnPool {
+public:
+    using Result = std::invoke_result_t<Work&>;
+    
+    explicit RunOnPool(Work work) : work_(std::move(work)) {}
+    
+    bool await_ready() const noexcept { return false; }
+    
+    template <typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        QueueAsyncWork(AsyncResumer::For(handle), [this]() {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    work_();
+                } else {
+                    result_.emplace(work_());
+                }
+            } catch (...) {
+                error_ = std::current_exception();
+            }
+        });
+    }
+    
+    Result await_resume() {
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        if constexpr (!std::is_void_v<Result>) {
+            return std::move(*result_);
+        }
+    }
+
+private:
+    using Storage = std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>>;
+    
+    Work work_;
+    Storage result_{};
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Read a whole file, throwing std::runtime_error on failure
+ * 
+ * Blocking; used by FsRead() on the thread pool.
+ * 
+ * @param path Path of the file
+ * @return Contents of the file
+ */
+std::string ReadFileContents(const std::string& path);
+
+/**
+ * @brief Awaitable that reads a whole file on the thread pool
+ * 
+ * co_await FsRead(path) evaluates to the file's contents, or throws
+ * std::runtime_error with a message naming the path and the error.
+ * 
+ * @param path Path of the file
+ * @return Awaitable of the contents
+ */
+inline auto FsRead(std::string path) {
+    return RunOnPool([path = std::move(path)]() { return ReadFileContents(path); });
+}
+
+#endif // TINY_NODEJS_ASYNC_H
@@ -0,0 +1,116 @@
+#ifndef TINY_NODEJS_BINDING_TABLE_H
+#define TINY_NODEJS_BINDING_TABLE_H
+
+#include <v8.h>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Compile-time tables of the native functions of a binding
+ * 
+ * A binding lists its functions once, in a constexpr array next to the
+ * callbacks, and builds its exports from that array:
+ * 
+ *     static constexpr NativeMethod kFsMethods[] = {
+ *         {"readFile", ReadFile, 1},
+ *         {"exists", Exists, 1, v8::None, v8::SideEffectType::kHasNoSideEffect},
+ *     };
+ *     static const BindingTableRegistration kFsRegistration(kFsMethods);
+ * 
+ *     v8::Local<v8::ObjectTemplate> fs = NewBindingTemplate(isolate, kFsMethods, data);
+ *     runtime->GetModuleSystem()->RegisterNativeModule("internal/fs", fs);
+ * 
+ * The template holds FunctionTemplates, so registration needs neither a
+ * context nor any JavaScript objects; the exports object and its functions
+ * are created in the calling context the first time the module is required.
+ * The registration adds the table's callbacks to the list that
+ * GetBindingExternalReferences() returns, which every isolate is created
+ * with, so a snapshot of the runtime can refer to them.
+ */
+
+/**
+ * @brief One native function of a binding
+ */
+struct NativeMethod {
+    // Property name of the function, also used as its name
+    const char* name;
+    
+    v8::FunctionCallback callback;
+    
+    // Value of the function's length property
+    int length = 0;
+    
+    // Attributes of the property holding the function
+    v8::PropertyAttribute attributes = v8::None;
+    
+    // kHasNoSideEffect lets the inspector and REPL evaluate calls eagerly
+    v8::SideEffectType side_effect = v8::SideEffectType::kHasSideEffect;
+    
+    // Optional fast API signature, used by optimized code instead of callback
+    const v8::CFunction* fast_function = nullptr;
+};
+
+/**
+ * @brief View of a constexpr array of NativeMethod entries
+ */
+class BindingTable {
+public:
+    template <size_t N>
+    constexpr BindingTable(const NativeMethod (&methods)[N]) : methods_(methods), count_(N) {}
+    
+    constexpr const NativeMethod* begin() const { return methods_; }
+    constexpr const NativeMethod* end() const { return methods_ + count_; }
+
+private:
+    const NativeMethod* methods_;
+    size_t count_;
+};
+
+/**
+ * @brief Add the functions of a table to a template
+ * 
+ * Each function is a non-constructible FunctionTemplate with the entry's
+ * name, length, side effect type and fast API signature.
+ * 
+ * @param isolate The V8 isolate
+ * @param target Object or prototype template to add the functions to
+ * @param table Functions to add
+ * @param data Value passed to the callbacks as args.Data()
+ */
+void SetBindingMethods(v8::Isolate* isolate, v8::Local<v8::Template> target,
+                       BindingTable table, v8::Local<v8::Value> data = v8::Local<v8::Value>());
+
+/**
+ * @brief Create the exports template of a binding from its table
+ * 
+ * @param isolate The V8 isolate
+ * @param table Functions of the binding
+ * @param data Value passed to the callbacks as args.Data()
+ * @return Object template holding one function per entry
+ */
+v8::Local<v8::ObjectTemplate> NewBindingTemplate(v8::Isolate* isolate, BindingTable table,
+                                                 v8::Local<v8::Value> data = v8::Local<v8::Value>());
+
+/**
+ * @brief Adds a table's functions to the external references at startup
+ * 
+ * Defined as a static object next to the table, so every table linked into
+ * the binary is listed before the first isolate is created.
+ */
+class BindingTableRegistration {
+public:
+    explicit BindingTableRegistration(BindingTable table);
+};
+
+/**
+ * @brief Get the external references of every registered table
+ * 
+ * Holds the address of every callback and fast API function, and the type
+ * information of every fast API signature, followed by a terminating 0, as
+ * v8::Isolate::CreateParams::external_references expects.
+ * 
+ * @return Null-terminated list, valid for the lifetime of the process
+ */
+const intptr_t* GetBindingExternalReferences();
+
+#endif // TINY_NODEJS_BINDING_TABLE_H
@@ -0,0 +1,30 @@
+#ifndef TINY_NODEJS_BUFFER_MODULE_H
+#define TINY_NODEJS_BUFFER_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of Buffer with the runtime
+ * 
+ * This function creates and registers the internal/buffer module, which
+ * holds the encoding and byte-search primitives lib/buffer.js builds the
+ * Node.js-compatible Buffer class on. Scripts use require('buffer') or the
+ * global Buffer rather than this module.
+ * 
+ * The internal/buffer module exposes the following functionality:
+ * - encodings: Map from encoding names (and aliases) to encoding codes
+ * - byteLength(string, encoding): Bytes needed to encode a string
+ * - write(target, string, offset, length, encoding): Encodes into a Uint8Array
+ * - toString(source, start, end, encoding): Decodes a byte range
+ * - compare(a, aStart, aEnd, b, bStart, bEnd): memcmp of two ranges
+ * - indexOf(haystack, needle, byteOffset, forward): memmem/memchr search
+ * - indexOfByte(haystack, byte, byteOffset, forward)
+ * - fill(target, pattern, start, end): Repeats a byte pattern
+ * - isUtf8(view), isAscii(view)
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterBufferModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_BUFFER_MODULE_H
@@ -0,0 +1,99 @@
+#ifndef TINY_NODEJS_BUILTINS_H
+#define TINY_NODEJS_BUILTINS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "v8.h"
+
+/**
+ * @brief Source of a built-in JavaScript module compiled into the binary
+ * 
+ * The table of built-in sources is generated at build time by
+ * cmake/js2c.cmake from the files in lib/. Sources are restricted to ASCII
+ * so they can be handed to V8 as external one-byte strings that point
+ * straight into read-only memory.
+ */
+struct BuiltinSource {
+    /**
+     * @brief Module identifier (e.g., 'events')
+     */
+    const char* id;
+    
+    /**
+     * @brief ASCII source code of the module (not NUL-terminated)
+     */
+    const uint8_t* data;
+    
+    /**
+     * @brief Length of the source code in bytes
+     */
+    size_t length;
+};
+
+/**
+ * @brief Pre-generated V8 code cache for a built-in module
+ * 
+ * Produced at build time by tools/mkcodecache.cpp and linked into
+ * tiny_node_core (the table is empty when TINY_NODE_CODE_CACHE is off). If
+ * V8 rejects an entry (e.g. because it was built with different flags), the
+ * module is simply compiled from source.
+ */
+struct BuiltinCodeCache {
+    /**
+     * @brief Module identifier (e.g., 'events')
+     */
+    const char* id;
+    
+    /**
+     * @brief Serialized code cache
+     */
+    const uint8_t* data;
+    
+    /**
+     * @brief Length of the code cache in bytes
+     */
+    size_t length;
+};
+
+/**
+ * @brief Get the number of built-in modules compiled into the binary
+ * 
+ * @return Number of built-in modules
+ */
+size_t GetBuiltinSourceCount();
+
+/**
+ * @brief Get a built-in module by index
+ * 
+ * @param index Index in the range [0, GetBuiltinSourceCount())
+ * @return Built-in module source
+ */
+const BuiltinSource* GetBuiltinSource(size_t index);
+
+/**
+ * @brief Find a built-in module by ID
+ * 
+ * @param module_id Module identifier (e.g., 'events')
+ * @return Built-in module source, or nullptr if there is no such module
+ */
+const BuiltinSource* FindBuiltinSource(const std::string& module_id);
+
+/**
+ * @brief Find the code cache for a built-in module
+ * 
+ * @param module_id Module identifier (e.g., 'events')
+ * @return Code cache entry, or nullptr if the module has none
+ */
+const BuiltinCodeCache* FindBuiltinCodeCache(const std::string& module_id);
+
+/**
+ * @brief Create a V8 string for a built-in module without copying it
+ * 
+ * @param isolate V8 isolate instance
+ * @param builtin Built-in module source
+ * @return External one-byte string backed by the static source bytes
+ */
+v8::Local<v8::String> NewBuiltinSourceString(v8::Isolate* isolate, const BuiltinSource* builtin);
+
+#endif // TINY_NODEJS_BUILTINS_H
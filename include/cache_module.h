@@ -0,0 +1,31 @@
+#ifndef TINY_NODEJS_CACHE_MODULE_H
+#define TINY_NODEJS_CACHE_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the cache module with the runtime
+ * 
+ * This function creates and registers the cache module, an in-process
+ * key-value cache whose keys and values live outside the V8 heap. Large
+ * caches therefore do not grow old-space or lengthen major GC pauses.
+ * 
+ * The cache is split into shards, each an open-addressing hash table with
+ * its own lock, and evicts with the CLOCK approximation of LRU when the
+ * byte budget is exceeded. Entries may carry a time-to-live.
+ * 
+ * The cache module exposes the following functionality to JavaScript:
+ * - cache.create(options): Creates a cache; options are maxBytes, shards,
+ *   ttl (default time-to-live in ms, 0 for none) and name (share the cache
+ *   process-wide, so other runtimes calling create with the same name get it)
+ * - c.set(key, value, ttl): Stores a Uint8Array, ArrayBuffer or string value
+ * - c.get(key): Returns a copy of the value as a Uint8Array, or undefined
+ * - c.has(key), c.delete(key), c.clear()
+ * - c.stats(): Returns hits, misses, evictions, expirations, entries and bytes
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterCacheModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_CACHE_MODULE_H
@@ -0,0 +1,51 @@
+#ifndef TINY_NODEJS_DGRAM_MODULE_H
+#define TINY_NODEJS_DGRAM_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the dgram module
+ * 
+ * This function creates and registers the internal/udp module, which
+ * lib/dgram.js builds the Node.js-style dgram API on (createSocket, bind,
+ * send and the 'message' event). Scripts use require('dgram') rather than
+ * this module.
+ * 
+ * Sockets are libuv UDP handles on the runtime's event loop, created with
+ * UV_UDP_RECVMMSG so a readable socket is drained with recvmmsg(2), up to
+ * 20 datagrams per system call. Datagrams are packed into a shared 256 KB
+ * ArrayBuffer slab and delivered at the end of the loop iteration, so a
+ * socket makes one JavaScript call per iteration however many datagrams
+ * arrived.
+ * 
+ * Sends take a whole batch of datagrams (lib/dgram.js collects the sends
+ * made in one tick). On Linux the batch goes out with sendmmsg(2), and runs
+ * of equal-sized datagrams to the same address are merged into one message
+ * segmented by the kernel (UDP_SEGMENT, generic segmentation offload). GSO
+ * is switched off for a socket the first time the kernel rejects it. What
+ * the socket buffer cannot take is queued on libuv.
+ * 
+ * The internal/udp module exposes the following functionality:
+ * - setup(callbacks): Registers onmessage(count, slab, layout, addresses),
+ *   onsend(status) and onclose(). layout holds an offset, length and port
+ *   into slab for each of the count datagrams; count is a negative libuv
+ *   error code when receiving failed
+ * - UDP: Handle class with bind(ip, port, flags), recvStart(), recvStop(),
+ *   send(list), close(), getsockname(out), setBroadcast(on), setTTL(ttl),
+ *   setMulticastTTL(ttl), setMulticastLoopback(on),
+ *   setMembership(group, iface, join), bufferSize(size, receive),
+ *   getSendQueueSize(), getSendQueueCount(), ref() and unref()
+ * - constants: UV_UDP_REUSEADDR, UV_UDP_IPV6ONLY and the error codes
+ *   lib/dgram.js checks for
+ * 
+ * send(list) takes a flat array of (data, port, ip) triples. It returns 0
+ * when every datagram went out at once, a negative libuv error code if one
+ * of them failed, and 1 when some were queued, in which case onsend()
+ * follows once they have been sent.
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterDgramModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_DGRAM_MODULE_H
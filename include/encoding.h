@@ -0,0 +1,142 @@
+#ifndef TINY_NODEJS_ENCODING_H
+#define TINY_NODEJS_ENCODING_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Byte and string encoding kernels shared by Buffer and TextDecoder
+ * 
+ * These functions work on raw memory and never touch V8. Hot loops use
+ * SSE2 on x86-64 and NEON on AArch64 (both part of the baseline ISA, so no
+ * runtime dispatch is needed), with a word-at-a-time fallback elsewhere.
+ */
+
+/**
+ * @brief Get the length of the leading run of ASCII bytes
+ * 
+ * @param data Bytes to scan
+ * @param length Number of bytes
+ * @return Index of the first byte >= 0x80, or length if there is none
+ */
+size_t AsciiPrefixLength(const uint8_t* data, size_t length);
+
+/**
+ * @brief Check if bytes are well-formed UTF-8
+ * 
+ * @param data Bytes to check
+ * @param length Number of bytes
+ * @return true if the bytes are valid UTF-8, false otherwise
+ */
+bool IsValidUtf8(const uint8_t* data, size_t length);
+
+/**
+ * @brief Decode UTF-8 to UTF-16, replacing malformed sequences with U+FFFD
+ * 
+ * Replacement follows the WHATWG Encoding Standard (one U+FFFD per maximal
+ * subpart of an ill-formed sequence), which is what TextDecoder and
+ * Buffer.prototype.toString produce.
+ * 
+ * @param data UTF-8 bytes
+ * @param length Number of bytes
+ * @param output Buffer of at least length code units
+ * @return Number of UTF-16 code units written
+ */
+size_t Utf8ToUtf16(const uint8_t* data, size_t length, uint16_t* output);
+
+/**
+ * @brief Get the length of an incomplete UTF-8 sequence at the end of bytes
+ * 
+ * Used by streaming decoders to hold back a sequence split across chunks.
+ * 
+ * @param data UTF-8 bytes
+ * @param length Number of bytes
+ * @return Number of trailing bytes (0 to 3) that start a valid but unfinished sequence
+ */
+size_t Utf8IncompleteTailLength(const uint8_t* data, size_t length);
+
+/**
+ * @brief Widen Latin-1 characters to UTF-16 code units
+ * 
+ * @param data Latin-1 characters
+ * @param length Number of characters
+ * @param output Buffer of at least length code units
+ */
+void Latin1ToUtf16(const uint8_t* data, size_t length, uint16_t* output);
+
+/**
+ * @brief Get the UTF-8 length of Latin-1 characters
+ * 
+ * @param data Latin-1 characters
+ * @param length Number of characters
+ * @return Number of bytes Latin1ToUtf8 needs for all of them
+ */
+size_t Latin1Utf8Length(const uint8_t* data, size_t length);
+
+/**
+ * @brief Encode Latin-1 characters as UTF-8, stopping when the output is full
+ * 
+ * A character is never split: encoding stops before one that does not fit.
+ * 
+ * @param data Latin-1 characters
+ * @param length Number of characters
+ * @param output Buffer to write to
+ * @param capacity Size of the output buffer in bytes
+ * @param read Set to the number of characters consumed
+ * @return Number of bytes written
+ */
+size_t Latin1ToUtf8(const uint8_t* data, size_t length, uint8_t* output, size_t capacity, size_t* read);
+
+/**
+ * @brief Get the encoded length of bytes in base64
+ * 
+ * @param length Number of input bytes
+ * @param url true for unpadded base64url, false for padded base64
+ * @return Number of output characters
+ */
+size_t Base64EncodedLength(size_t length, bool url);
+
+/**
+ * @brief Encode bytes as base64 or base64url
+ * 
+ * @param data Bytes to encode
+ * @param length Number of bytes
+ * @param output Buffer of at least Base64EncodedLength(length, url) bytes
+ * @param url true for unpadded base64url, false for padded base64
+ * @return Number of characters written
+ */
+size_t Base64Encode(const uint8_t* data, size_t length, char* output, bool url);
+
+/**
+ * @brief Decode base64 or base64url, skipping whitespace and stopping at padding
+ * 
+ * Both alphabets are accepted, as in Node.js. Decoding stops at the first
+ * character that is not part of either alphabet.
+ * 
+ * @param data Characters to decode
+ * @param length Number of characters
+ * @param output Buffer of at least length * 3 / 4 + 3 bytes
+ * @return Number of bytes written
+ */
+size_t Base64Decode(const uint8_t* data, size_t length, uint8_t* output);
+
+/**
+ * @brief Encode bytes as lowercase hex
+ * 
+ * @param data Bytes to encode
+ * @param length Number of bytes
+ * @param output Buffer of at least 2 * length bytes
+ */
+void HexEncode(const uint8_t* data, size_t length, char* output);
+
+/**
+ * @brief Decode hex, stopping at the first invalid pair
+ * 
+ * @param data Characters to decode
+ * @param length Number of characters
+ * @param output Buffer of at least length / 2 bytes
+ * @return Number of bytes written
+ */
+size_t HexDecode(const uint8_t* data, size_t length, uint8_t* output);
+
+#endif // TINY_NODEJS_ENCODING_H
@@ -0,0 +1,36 @@
+#ifndef TINY_NODEJS_ENCODING_MODULE_H
+#define TINY_NODEJS_ENCODING_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of TextEncoder and TextDecoder
+ * 
+ * This function creates and registers the internal/encoding module, which
+ * lib/util.js builds the WHATWG TextEncoder and TextDecoder classes on.
+ * Scripts use the TextEncoder and TextDecoder globals (or require('util'))
+ * rather than this module.
+ * 
+ * Strings are read with WriteOneByte/WriteUtf8 straight into the output
+ * and decoded bytes are turned into strings with NewFromOneByte or
+ * NewFromTwoByte, so no std::string is built along the way. ASCII input
+ * takes a vectorized fast path in both directions.
+ * 
+ * The internal/encoding module exposes the following functionality:
+ * - encodings: Map from decoder encoding names to encoding codes
+ *   ('utf-8', 'utf-16le' and 'windows-1252', which is what the WHATWG
+ *   standard calls latin1)
+ * - encode(string): Encodes a string as UTF-8 into a new Uint8Array
+ * - encodeInto(string, target, results): Encodes as much of a string as
+ *   fits into target, storing the UTF-16 code units read and bytes written
+ *   in the Uint32Array results
+ * - decode(state, input, encoding, flags): Decodes bytes to a string. state
+ *   is a Uint8Array the decoder keeps between calls to hold a sequence split
+ *   across chunks; flags combines 1 (fatal), 2 (ignoreBOM) and 4 (stream)
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterEncodingModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_ENCODING_MODULE_H
@@ -10,19 +10,81 @@
 #include <chrono>
 #include <map>
 #include <vector>
+#include <uv.h>
+#include <v8.h>
+#include "affinity.h"
 
 // Forward declaration
 class Runtime;
 
+/**
+ * @brief Queues of the event loop, each with its own capacity
+ * 
+ * A batch runs the continuations first, then the tasks, then the completions.
+ */
+enum class TaskLane {
+    // Tasks scheduled by bindings and embedders, and timers that are due
+    kTask = 0,
+    
+    // Results of thread pool work, scheduled by Runtime::QueueWork() without waiting
+    kCompletion = 1,
+    
+    // Continuations of tasks that yielded to the loop
+    kContinuation = 2,
+};
+
+/**
+ * @brief Number of TaskLane values
+ */
+constexpr size_t kTaskLaneCount = 3;
+
+/**
+ * @brief Outcome of EventLoop::TrySchedule()
+ */
+enum class ScheduleResult {
+    kOk,
+    kFull,
+};
+
+/**
+ * @brief Queue depth and backpressure counters of one lane
+ */
+struct TaskLaneStats {
+    // Most tasks the lane holds before it pauses producers, 0 for no limit
+    size_t capacity = 0;
+    
+    // Tasks queued or taken by a batch that has not finished
+    size_t depth = 0;
+    
+    // Largest depth seen
+    size_t high_water = 0;
+    
+    uint64_t scheduled = 0;
+    
+    // TrySchedule() calls turned away, and ScheduleTask() calls that had to wait
+    uint64_t rejected = 0;
+    uint64_t waits = 0;
+    
+    // Set from the time the lane fills until it drains to half its capacity
+    bool paused = false;
+};
+
 /**
  * @brief Event loop for handling asynchronous operations
  * 
  * The EventLoop class is responsible for:
  * - Running tasks asynchronously in a separate thread
  * - Scheduling delayed tasks (for setTimeout/setInterval)
+ * - Driving a libuv loop for sockets and other I/O handles
  * - Managing the execution order of asynchronous operations
  * 
- * This is a simplified version of Node.js's event loop, which is based on libuv.
+ * This is a simplified version of Node.js's event loop. Tasks and timers are
+ * kept by the EventLoop itself; network I/O goes through an embedded libuv
+ * loop. While libuv has active handles, a thread blocked in RunOnce() waits
+ * on the libuv backend descriptor, so both new tasks (which signal a
+ * uv_async_t) and ready sockets wake it.
+ * libuv callbacks call into JavaScript, so the libuv loop is only ever
+ * touched with the runtime's isolate locked.
  */
 class EventLoop {
 public:
@@ -47,6 +109,17 @@ public:
      */
     void Start();
     
+    /**
+     * @brief Pin the event loop thread
+     * 
+     * Takes effect when Start() starts the thread. Memory the loop thread
+     * allocates first, such as read buffers and queued tasks, is then
+     * placed on the pinned NUMA node.
+     * 
+     * @param affinity CPUs or NUMA nodes the loop thread is pinned to
+     */
+    void SetAffinity(const CpuAffinity& affinity);
+    
     /**
      * @brief Stop the event loop
      * 
@@ -54,14 +127,128 @@ public:
      */
     void Stop();
     
+    /**
+     * @brief Stop making producers wait for room in paused lanes
+     * 
+     * Called when the runtime shuts down, before it waits for thread pool
+     * work whose submitters may be waiting for a loop nobody pumps any
+     * more. Tasks scheduled afterwards are queued over capacity. Stop()
+     * calls it too.
+     */
+    void CloseQueues();
+    
     /**
      * @brief Schedule a task to be executed on the event loop
      * 
      * The task will be executed as soon as possible on the event loop thread.
      * 
+     * While the lane is paused (see TrySchedule()), a thread that does not
+     * hold the runtime's isolate lock waits until the loop has drained the
+     * lane to half its capacity, so a producer on another thread is slowed
+     * to the pace of the loop. A thread holding the lock, such as a task or
+     * the main script, cannot wait for the loop it is blocking; its task is
+     * queued over capacity. Producers only wait while the loop thread started
+     * by Start() runs: a host that pumps the loop with RunOnce() may be the
+     * producer itself, so without that thread tasks are always queued over
+     * capacity. Neither ever drops the task.
+     * 
+     * @param task Function to be executed
+     * @param lane Queue to add the task to
+     */
+    void ScheduleTask(std::function<void()> task, TaskLane lane = TaskLane::kTask);
+    
+    /**
+     * @brief Schedule a task unless its lane is full
+     * 
+     * A lane pauses when its depth reaches its capacity, and resumes when
+     * the loop has run enough of it to bring the depth down to half the
+     * capacity. While it is paused nothing is queued and kFull is returned,
+     * so a producer that must not block can hold its work back and retry
+     * once a backpressure listener reports the lane resumed.
+     * 
+     * @param task Function to be executed
+     * @param lane Queue to add the task to
+     * @return kOk if the task was queued, kFull if the lane is paused
+     */
+    ScheduleResult TrySchedule(std::function<void()> task, TaskLane lane = TaskLane::kTask);
+    
+    /**
+     * @brief Schedule the continuation of a task that yielded to the loop
+     * 
+     * The continuation runs at the start of the next iteration, after the
+     * libuv callbacks of the current one and ahead of the tasks and timers
+     * that are queued in the meantime. A task that yields gives I/O a turn
+     * without going to the back of the queue. This is how scheduler.yield()
+     * resumes. Same as ScheduleTask(task, TaskLane::kContinuation).
+     * 
      * @param task Function to be executed
      */
-    void ScheduleTask(std::function<void()> task);
+    void ScheduleContinuation(std::function<void()> task);
+    
+    /**
+     * @brief Schedule the result of thread pool work
+     * 
+     * Queues the task in the kCompletion lane without waiting, over capacity
+     * if the lane is paused, so a shared pool thread is never held back by
+     * one runtime's loop. Backpressure on completions is applied when the
+     * work is submitted instead; see WaitForRoom() and Runtime::QueueWork().
+     * 
+     * @param task Function to be executed
+     */
+    void ScheduleCompletion(std::function<void()> task);
+    
+    /**
+     * @brief Wait while a lane is paused
+     * 
+     * Does what ScheduleTask() does before it queues a task, for a producer
+     * that applies backpressure before it starts the work whose result it
+     * queues later. Returns at once on a thread holding the runtime's
+     * isolate lock, when no loop thread is running, and once the queues are
+     * closed.
+     * 
+     * @param lane Lane to wait for
+     */
+    void WaitForRoom(TaskLane lane);
+    
+    /**
+     * @brief Set how many tasks a lane holds before producers are paused
+     * 
+     * Timers that fall due are queued in the kTask lane regardless of its
+     * capacity, but count towards its depth.
+     * 
+     * @param lane Lane to configure
+     * @param capacity Most tasks queued at once, 0 for no limit
+     */
+    void SetLaneCapacity(TaskLane lane, size_t capacity);
+    
+    /**
+     * @brief Get the depth and backpressure counters of a lane
+     * 
+     * @param lane Lane to report on
+     * @return Counters of the lane
+     */
+    TaskLaneStats GetLaneStats(TaskLane lane);
+    
+    /**
+     * @brief Register a function told when a lane pauses and resumes
+     * 
+     * The listener is called with true when the lane fills and with false
+     * once it has drained to half its capacity. It runs on the thread whose
+     * task filled the lane or whose batch drained it, must not block, and
+     * must not add or remove listeners.
+     * 
+     * @param lane Lane to watch
+     * @param listener Function called with whether the lane is now paused
+     * @return ID for RemoveBackpressureListener()
+     */
+    uint64_t AddBackpressureListener(TaskLane lane, std::function<void(bool paused)> listener);
+    
+    /**
+     * @brief Unregister a backpressure listener
+     * 
+     * @param listener_id ID returned by AddBackpressureListener()
+     */
+    void RemoveBackpressureListener(uint64_t listener_id);
     
     /**
      * @brief Schedule a task to be executed after a delay
@@ -91,6 +278,109 @@ public:
      */
     bool IsRunning() const;
     
+    /**
+     * @brief Run one iteration of the event loop on the calling thread
+     * 
+     * Moves due delayed tasks to the task queue, executes every queued task,
+     * runs pending V8 platform tasks for the isolate (which deliver
+     * Atomics.waitAsync wakeups) and then runs ready libuv callbacks. If
+     * nothing is queued, blocks for at most timeout_ms (or until the next
+     * delayed task is due, a libuv handle becomes ready, or Wake() is called)
+     * before running what arrived. Queued tasks are only taken once the
+     * isolate is locked, so while JavaScript on another thread holds it they
+     * stay queued, where the time slicing thread sees them waiting.
+     * 
+     * This is how an embedder that owns its threads pumps the loop when the
+     * runtime was created without a dedicated loop thread. It must not be
+     * called while the loop thread started by Start() is running.
+     * 
+     * @param timeout_ms Maximum time to wait for work, 0 to never block
+     * @return Number of tasks executed, including V8 platform tasks
+     */
+    size_t RunOnce(uint64_t timeout_ms);
+    
+    /**
+     * @brief Wake up a thread blocked in RunOnce()
+     */
+    void Wake();
+    
+    /**
+     * @brief Ask long-running JavaScript to yield to the loop
+     * 
+     * Starts a thread that checks every slice_ms whether the loop has
+     * work that has not been picked up for a whole slice: queued tasks or
+     * tasks waiting behind the running one in its batch, due timers, or
+     * libuv descriptors that are ready. Such work means
+     * JavaScript has been holding the isolate for that long, whether in
+     * ExecuteString() or in a loop task. The thread then sets a flag; it
+     * never interrupts the running code, which keeps run-to-completion.
+     * 
+     * The flag is honoured at two points. ShouldYield() (scheduler.shouldYield()
+     * in JavaScript) reports it, so code can await scheduler.yield() only when
+     * the loop needs a turn. And when the task that held the isolate returns,
+     * ready libuv callbacks run before the next task of the same batch; the
+     * rest of the batch keeps its order ahead of due timers and newer tasks.
+     * 
+     * @param slice_ms Interval between checks, in milliseconds
+     */
+    void StartTimeSlicing(uint64_t slice_ms);
+    
+    /**
+     * @brief Get the number of times long-running JavaScript was asked to yield
+     * 
+     * @return Number of slices after which the loop still had work waiting
+     */
+    uint64_t GetTimeSliceCount() const;
+    
+    /**
+     * @brief Check whether running JavaScript should yield to the loop
+     * 
+     * Set once loop work has waited a whole time slice, and cleared when the
+     * loop gets its turn. Always false without time slicing.
+     * 
+     * @return true if the loop has been waiting for the isolate
+     */
+    bool ShouldYield() const;
+    
+    /**
+     * @brief Get the time slice length
+     * 
+     * @return Milliseconds between checks, or 0 if time slicing is off
+     */
+    uint64_t GetTimeSlice() const;
+    
+    /**
+     * @brief Check if the event loop has pending work
+     * 
+     * Work is pending while tasks are queued, delayed or running, and while
+     * the libuv loop has referenced handles or requests (a listening server,
+     * an open socket, a pending DNS lookup). Takes the isolate lock.
+     * 
+     * @return true if there is pending work, false otherwise
+     */
+    bool HasPendingTasks();
+    
+    /**
+     * @brief Drop the tasks and timers that have not run yet
+     * 
+     * Called by the runtime at shutdown, after the loop has stopped and with
+     * the isolate locked, so that whatever the dropped tasks hold (persistent
+     * handles, suspended coroutines) is released while V8 is still usable.
+     */
+    void DiscardPendingTasks();
+    
+    /**
+     * @brief Get the libuv loop driven by this event loop
+     * 
+     * Handles may only be created, started or closed with the runtime's
+     * isolate locked. A binding that starts I/O from outside a loop task
+     * (for example from the main script) must call Wake() afterwards so the
+     * loop picks up the new watcher.
+     * 
+     * @return Pointer to the libuv loop
+     */
+    uv_loop_t* GetUvLoop();
+    
 private:
     /**
      * @brief Pointer to the Runtime instance that owns this event loop
@@ -103,25 +393,103 @@ private:
     std::thread thread_;
     
     /**
-     * @brief Queue of tasks to be executed
+     * @brief CPUs or NUMA nodes the loop thread is pinned to
+     */
+    CpuAffinity affinity_;
+    
+    /**
+     * @brief Tasks of one lane waiting to run, and its counters
      */
-    std::queue<std::function<void()>> task_queue_;
+    struct Lane {
+        std::queue<std::function<void()>> tasks;
+        TaskLaneStats stats;
+        
+        // Paused state last reported to the listeners
+        bool notified_paused = false;
+    };
     
     /**
-     * @brief Mutex for protecting access to the task queue
+     * @brief Queues of tasks to be executed, indexed by TaskLane
+     */
+    Lane lanes_[kTaskLaneCount];
+    
+    /**
+     * @brief Mutex for protecting access to the lanes
      */
     std::mutex queue_mutex_;
     
+    /**
+     * @brief Condition variable producers wait on while their lane is paused
+     */
+    std::condition_variable space_cv_;
+    
+    /**
+     * @brief Set by Stop(); producers no longer wait for the loop after that
+     */
+    bool queues_closed_;
+    
+    /**
+     * @brief Backpressure listeners by ID, with the lane each watches
+     */
+    std::map<uint64_t, std::pair<TaskLane, std::function<void(bool)>>> listeners_;
+    
+    /**
+     * @brief Mutex held while listeners are added, removed or called
+     * 
+     * Taken before queue_mutex_ when both are needed.
+     */
+    std::mutex listeners_mutex_;
+    
+    /**
+     * @brief Counter for generating listener IDs
+     */
+    uint64_t next_listener_id_;
+    
     /**
      * @brief Condition variable for signaling when tasks are added to the queue
+     * 
+     * A thread blocked in RunOnce() waits on it while no libuv handle is
+     * active, and on the libuv backend descriptor otherwise.
      */
     std::condition_variable queue_cv_;
     
+    /**
+     * @brief libuv loop for I/O handles
+     */
+    uv_loop_t uv_loop_;
+    
+    /**
+     * @brief Async handle signaled to wake a thread blocked in RunOnce()
+     * 
+     * It is unreferenced, so it never keeps the loop alive on its own.
+     */
+    uv_async_t wake_async_;
+    
+    /**
+     * @brief Set while a batch of tasks taken from the queue is running
+     */
+    bool running_batch_;
+    
+    /**
+     * @brief Set while the libuv loop has active handles or requests
+     */
+    std::atomic<bool> uv_alive_;
+    
+    /**
+     * @brief Set when libuv has callbacks to run without waiting for I/O
+     */
+    bool uv_ready_;
+    
     /**
      * @brief Flag indicating whether the event loop is running
      */
     std::atomic<bool> running_;
     
+    /**
+     * @brief Flag set by Wake() and Stop() to interrupt a blocking wait
+     */
+    bool wake_requested_;
+    
     /**
      * @brief Counter for generating unique task IDs
      */
@@ -139,6 +507,61 @@ private:
      */
     std::mutex delayed_tasks_mutex_;
     
+    /**
+     * @brief Thread that asks long-running JavaScript to yield, if time slicing is on
+     */
+    std::thread slice_thread_;
+    
+    /**
+     * @brief Interval of the time slicing checks
+     */
+    std::chrono::milliseconds slice_interval_;
+    
+    /**
+     * @brief Set to stop the time slicing thread
+     */
+    bool slice_stop_;
+    
+    /**
+     * @brief Mutex and condition variable the time slicing thread sleeps on
+     */
+    std::mutex slice_mutex_;
+    std::condition_variable slice_cv_;
+    
+    /**
+     * @brief Set by the time slicing thread while loop work waits for the isolate
+     * 
+     * Cleared when the loop takes a batch or runs libuv callbacks between
+     * two of its tasks.
+     */
+    std::atomic<bool> yield_requested_;
+    
+    /**
+     * @brief Incremented whenever the loop runs its work
+     * 
+     * The time slicing thread only asks for a yield when this has not moved
+     * for a whole slice.
+     */
+    std::atomic<uint64_t> progress_;
+    
+    /**
+     * @brief Number of slices that asked for a yield
+     */
+    std::atomic<uint64_t> slice_count_;
+    
+    /**
+     * @brief Set while the running task has others of its batch waiting behind it
+     */
+    std::atomic<bool> batch_waiting_;
+    
+    /**
+     * @brief Set while uv_run() is on the stack; only used with the isolate locked
+     * 
+     * A task boundary reached from inside a libuv callback must not run the
+     * libuv loop again.
+     */
+    bool in_uv_;
+    
     /**
      * @brief Main event loop function that runs in a separate thread
      * 
@@ -151,8 +574,100 @@ private:
      * 
      * Checks for delayed tasks that have reached their execution time and
      * schedules them for immediate execution.
+     * 
+     * @return Time until the next delayed task is due, or timeout if none
+     */
+    std::chrono::milliseconds ProcessDelayedTasks(std::chrono::milliseconds timeout);
+    
+    /**
+     * @brief Add a task to a lane; queue_mutex_ must be held
+     * 
+     * @param lane Lane to add the task to
+     * @param task Function to be executed
+     * @return true if the task filled the lane and paused it
+     */
+    bool PushTask(TaskLane lane, std::function<void()> task);
+    
+    /**
+     * @brief Check whether any lane has tasks queued; queue_mutex_ must be held
+     * 
+     * @return true if a task is waiting
+     */
+    bool HasQueuedTasks() const;
+    
+    /**
+     * @brief Take every queued task, in the order the lanes run
+     * 
+     * queue_mutex_ must be held. The tasks still count towards the depth of
+     * their lanes until FinishBatch() is called with the returned counts.
+     * 
+     * @param batch Receives the tasks
+     * @param counts Receives the number of tasks taken from each lane
+     */
+    void TakeBatch(std::queue<std::function<void()>>* batch, size_t (&counts)[kTaskLaneCount]);
+    
+    /**
+     * @brief Run a batch taken by TakeBatch() and release its lane depth
+     * 
+     * Between two tasks, runs ready libuv callbacks if the time slicing
+     * thread asked for a yield while the earlier one ran.
+     * 
+     * @param batch Tasks to run
+     * @param counts Number of tasks taken from each lane
+     */
+    void RunBatch(std::queue<std::function<void()>>* batch, const size_t (&counts)[kTaskLaneCount]);
+    
+    /**
+     * @brief Tell the listeners of a lane whose paused state changed
+     * 
+     * @param lane Lane that paused or resumed
+     */
+    void NotifyBackpressure(TaskLane lane);
+    
+    /**
+     * @brief Wait until a lane resumes or the queues close
+     * 
+     * @param lock Lock of queue_mutex_, released while waiting
+     * @param lane Lane to wait for
+     */
+    void WaitForRoomLocked(std::unique_lock<std::mutex>& lock, TaskLane lane);
+    
+    /**
+     * @brief Execute a single task with the runtime's isolate locked
+     * 
+     * Tasks may run on the loop thread or on an embedder thread, so every
+     * task takes a v8::Locker and enters the isolate before running.
+     * 
+     * @param task Function to be executed
+     */
+    void RunTask(const std::function<void()>& task);
+    
+    /**
+     * @brief Run ready libuv callbacks without blocking
+     * 
+     * @return true if the libuv loop still has active handles or requests
+     */
+    bool RunUv();
+    
+    /**
+     * @brief Block until the libuv backend is readable or the timeout expires
+     * 
+     * @param timeout Maximum time to wait
+     */
+    void WaitForEvents(std::chrono::milliseconds timeout);
+    
+    /**
+     * @brief Time slicing thread function
+     */
+    void RunTimeSlicer();
+    
+    /**
+     * @brief Check whether the loop has work it could run right now
+     * 
+     * @return true if tasks are queued or wait in the running batch, a timer is
+     *         due or a libuv descriptor is ready
      */
-    void ProcessDelayedTasks();
+    bool HasDueWork();
 };
 
 #endif // TINY_NODEJS_EVENT_LOOP_H 
\ No newline at end of file
@@ -7,16 +7,24 @@ class Runtime;
 /**
  * @brief Register the file system module with the runtime
  * 
- * This function creates and registers the fs module, which provides
- * file system operations, similar to Node.js's fs module.
+ * This function creates and registers internal/fs, the binding behind
+ * lib/fs.js, which provides file system operations similar to Node.js's
+ * fs module.
  * 
- * The fs module exposes the following functionality to JavaScript:
- * - fs.readFile(path): Reads the content of a file
- * - fs.writeFile(path, data): Writes data to a file
- * - fs.exists(path): Checks if a file or directory exists
+ * The binding exposes the following functionality to JavaScript:
+ * - readFile(path): Reads the content of a file
+ * - readFileAsync(path): Reads a file on the thread pool; returns a promise
+ *   of its bytes as a Uint8Array
+ * - writeFile(path, data): Writes data to a file
+ * - exists(path): Checks if a file or directory exists
+ * - FileStream: A handle reading and writing a file in chunks on the thread
+ *   pool, with open(), read(), writev() and close(); it is a StreamBase, so
+ *   a native pipe can move its data to a socket or another file directly
+ * - setup(callbacks): Sets the onread, onwrite and onclose callbacks of
+ *   FileStream handles
  * 
  * Note: This is a simplified version of Node.js's fs module and does not
- * include all the functionality or the asynchronous versions of these methods.
+ * include all the functionality or asynchronous versions of most methods.
  * 
  * @param runtime Pointer to the Runtime instance
  */
@@ -0,0 +1,101 @@
+#ifndef TINY_NODEJS_HASH_H
+#define TINY_NODEJS_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Hash algorithms provided by the hash module
+ */
+enum class HashAlgorithm {
+    kSha1,
+    kSha256,
+    kSha512,
+    kXxh3,
+    kCrc32c,
+};
+
+/**
+ * @brief Incremental hash over a byte stream
+ * 
+ * Implementations work on raw memory and never touch V8, so a Hasher can be
+ * fed from the thread pool. Block functions are picked once at startup from
+ * what the CPU supports: SHA-NI for SHA-1 and SHA-256, AVX2 (or SSE2) for
+ * XXH3 and SSE4.2 (or the ARMv8 CRC32 extension) for CRC32C, with portable
+ * code everywhere else.
+ */
+class Hasher {
+public:
+    virtual ~Hasher() = default;
+    
+    /**
+     * @brief Create a hasher for an algorithm
+     *
+     * @param algorithm Algorithm to use
+     * @return A new hasher in its initial state
+     */
+    static std::unique_ptr<Hasher> Create(HashAlgorithm algorithm);
+    
+    /**
+     * @brief Feed more bytes into the hash
+     *
+     * @param data Bytes to hash
+     * @param length Number of bytes
+     */
+    virtual void Update(const uint8_t* data, size_t length) = 0;
+    
+    /**
+     * @brief Finish the hash and write the digest
+     *
+     * The hasher must not be used afterwards.
+     *
+     * @param output Buffer of at least DigestLength() bytes
+     */
+    virtual void Final(uint8_t* output) = 0;
+    
+    /**
+     * @brief Get the size of the digest in bytes
+     */
+    virtual size_t DigestLength() const = 0;
+    
+    /**
+     * @brief Copy the hasher, including the data fed so far
+     */
+    virtual std::unique_ptr<Hasher> Clone() const = 0;
+};
+
+/**
+ * @brief Look up an algorithm by name
+ * 
+ * Names are case-insensitive: sha1 (sha-1), sha256 (sha-256), sha512
+ * (sha-512), xxh3 (xxh3-64) and crc32c.
+ * 
+ * @param name Algorithm name
+ * @param algorithm Set to the algorithm when found
+ * @return true if the name is known, false otherwise
+ */
+bool ParseHashAlgorithm(const std::string& name, HashAlgorithm* algorithm);
+
+/**
+ * @brief Extend a CRC-32C (Castagnoli) checksum over more data
+ * 
+ * @param crc Checksum of the data so far (0 to start)
+ * @param data Bytes to add
+ * @param length Number of bytes
+ * @return Updated checksum
+ */
+uint32_t Crc32c(uint32_t crc, const void* data, size_t length);
+
+/**
+ * @brief Compute the 64-bit XXH3 hash of a buffer
+ * 
+ * @param data Bytes to hash
+ * @param length Number of bytes
+ * @param seed Hash seed
+ * @return The XXH3-64 hash, identical to the reference implementation's
+ */
+uint64_t Xxh3Hash64(const void* data, size_t length, uint64_t seed);
+
+#endif // TINY_NODEJS_HASH_H
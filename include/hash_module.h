@@ -0,0 +1,34 @@
+#ifndef TINY_NODEJS_HASH_MODULE_H
+#define TINY_NODEJS_HASH_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the hash module
+ * 
+ * This function creates and registers the hash module, a small subset of
+ * Node.js crypto hashing for content addressing and ETags. Algorithms are
+ * sha1, sha256, sha512, xxh3 (64-bit XXH3) and crc32c; the block functions
+ * use SHA-NI, AVX2 and SSE4.2 when the CPU has them.
+ * 
+ * Data may be a string (with an encoding of 'utf8', 'utf16le', 'latin1',
+ * 'hex', 'base64' or 'base64url'), an ArrayBuffer or any ArrayBufferView.
+ * One-byte strings are hashed in fixed-size chunks straight from V8, so no
+ * copy of the whole string is made.
+ * 
+ * The hash module exposes the following functionality:
+ * - createHash(algorithm): Creates a hash object with update(data, encoding),
+ *   digest(encoding) and copy() methods. digest() returns a Uint8Array, or a
+ *   string for 'hex', 'base64', 'base64url' or 'latin1'
+ * - hash(algorithm, data, outputEncoding): Hashes data in one call
+ *   (outputEncoding defaults to 'hex')
+ * - hashFile(algorithm, path, outputEncoding): Hashes a file on the thread
+ *   pool and returns a Promise for the digest
+ * - getHashes(): Returns the supported algorithm names
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterHashModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_HASH_MODULE_H
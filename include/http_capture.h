@@ -0,0 +1,154 @@
+#ifndef TINY_NODEJS_HTTP_CAPTURE_H
+#define TINY_NODEJS_HTTP_CAPTURE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Binary capture files of HTTP requests
+ * 
+ * A capture records the requests a server received, with their timing, so
+ * that `tiny_node --replay` can send the same traffic, bursts included, to
+ * a local server (see http_replay.h). The file starts with the 8 byte magic
+ * "TNHTCAP1" and the capture's wall-clock start time, in microseconds since
+ * the Unix epoch, as a little-endian uint64. Each request follows as:
+ * 
+ *     varint  microseconds since the previous request (or the start)
+ *     string  method
+ *     string  url
+ *     varint  number of headers, then a name string and a value string each
+ *     string  body
+ * 
+ * where a string is a varint byte length followed by the bytes, and varints
+ * are unsigned LEB128. A file cut short by a crash is read up to its last
+ * complete request.
+ */
+
+/**
+ * @brief One captured request
+ */
+struct HttpCaptureRecord {
+    // Microseconds since the capture started
+    uint64_t time_us = 0;
+    
+    std::string method;
+    std::string url;
+    std::vector<std::pair<std::string, std::string>> headers;
+    std::string body;
+};
+
+/**
+ * @brief Counters of a capture writer
+ */
+struct HttpCaptureStats {
+    // Requests handed to the writer, and those dropped because it fell behind
+    uint64_t records = 0;
+    uint64_t dropped = 0;
+    
+    // Bytes written to the file so far
+    uint64_t bytes = 0;
+};
+
+/**
+ * @brief Appends requests to a capture file from a background thread
+ * 
+ * Record() encodes the request into an in-memory buffer and returns; the
+ * writer thread swaps the buffer out and writes it, so a server never waits
+ * for the disk. If the disk falls more than kMaxPendingBytes behind, further
+ * requests are counted as dropped rather than buffered.
+ */
+class HttpCaptureWriter {
+public:
+    /**
+     * @brief Most encoded bytes waiting for the writer thread
+     */
+    static constexpr size_t kMaxPendingBytes = 16 * 1024 * 1024;
+    
+    /**
+     * @brief Create a capture file and start its writer thread
+     *
+     * @param path File to create, replacing any existing file
+     * @param error Receives the reason if the file cannot be created
+     * @return The writer, or nullptr on failure
+     */
+    static std::unique_ptr<HttpCaptureWriter> Open(const std::string& path, std::string* error);
+    
+    /**
+     * @brief Destructor; writes what is buffered and closes the file
+     */
+    ~HttpCaptureWriter();
+    
+    /**
+     * @brief Record a request received now
+     *
+     * The record's time_us is ignored; the time of the call is used. May be
+     * called from any thread.
+     *
+     * @param record The request
+     */
+    void Record(const HttpCaptureRecord& record);
+    
+    /**
+     * @brief Write what is buffered, stop the writer thread and close the file
+     *
+     * Requests recorded afterwards are dropped. Safe to call more than once.
+     */
+    void Close();
+    
+    /**
+     * @brief Get the writer's counters
+     *
+     * @return Requests recorded and dropped, and bytes written
+     */
+    HttpCaptureStats GetStats();
+    
+    /**
+     * @brief Get the path of the capture file
+     *
+     * @return The path passed to Open()
+     */
+    const std::string& GetPath() const;
+
+private:
+    HttpCaptureWriter(const std::string& path, std::FILE* file);
+    
+    /**
+     * @brief Writer thread function
+     */
+    void WriterMain();
+    
+    std::string path_;
+    std::FILE* file_;
+    std::thread thread_;
+    
+    // Encoded requests not written yet, swapped out by the writer thread
+    std::string pending_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool closing_;
+    
+    // Time of the last request, which the next one's delta is taken from
+    std::chrono::steady_clock::time_point last_;
+    
+    HttpCaptureStats stats_;
+};
+
+/**
+ * @brief Read every complete request of a capture file
+ * 
+ * @param path Capture file
+ * @param records Receives the requests, in the order they were received
+ * @param error Receives the reason if the file is not a capture
+ * @return true if the file was read
+ */
+bool ReadHttpCapture(const std::string& path, std::vector<HttpCaptureRecord>* records, std::string* error);
+
+#endif // TINY_NODEJS_HTTP_CAPTURE_H
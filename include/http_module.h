@@ -13,6 +13,12 @@ class Runtime;
  * The HTTP module exposes the following functionality to JavaScript:
  * - http.createServer(callback): Creates an HTTP server
  * - server.listen(port): Starts the server on the specified port
+ * - http.startCapture(path): Records every request servers dispatch to a
+ *   capture file (see http_capture.h), as --http-capture=<file> does
+ * - http.stopCapture(): Finishes the capture file and returns { path,
+ *   records, dropped, bytes }
+ * - http.readCapture(path): Reads a capture file back as an array of
+ *   { method, url, headers, body }, as tiny_node --replay does
  * 
  * The callback function passed to createServer receives request and response objects:
  * - request: Contains information about the HTTP request (method, url, etc.)
@@ -0,0 +1,45 @@
+#ifndef TINY_NODEJS_HTTP_REPLAY_H
+#define TINY_NODEJS_HTTP_REPLAY_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Options of an HTTP capture replay
+ */
+struct HttpReplayOptions {
+    // Capture file written by the http module (see http_capture.h)
+    std::string capture_path;
+    
+    // How much faster than recorded to send: 10 sends ten times the rate
+    double speed = 1.0;
+    
+    // Server to send the requests to; host must be an IP address or localhost
+    std::string host = "127.0.0.1";
+    int port = 3000;
+    
+    // Requests without a complete response after this long count as timed out
+    uint64_t timeout_ms = 10000;
+};
+
+/**
+ * @brief Replay a capture against a server and report latency
+ * 
+ * Implements `tiny_node --replay <capture> [--speed <n>x] [--target
+ * <host:port>]`. Each request is sent on its own connection at its
+ * recorded time divided by the speed, whether or not earlier requests have
+ * been answered, so bursts in the capture reach the server as bursts. The
+ * request carries its recorded method, URL, headers and body, with
+ * Connection: close and a recomputed Content-Length.
+ * 
+ * Latency runs from the time a request was due to be sent until its
+ * response has been read completely, so time spent waiting behind a
+ * saturated client counts too. A summary with latency percentiles, status
+ * codes and errors is printed to stdout. No JavaScript runtime is created.
+ * 
+ * @param options Capture, speed and target server
+ * @return 0 if every request got a response, 1 otherwise
+ */
+int RunHttpReplay(const HttpReplayOptions& options);
+
+#endif // TINY_NODEJS_HTTP_REPLAY_H
@@ -0,0 +1,91 @@
+#ifndef TINY_NODEJS_INSPECT_H
+#define TINY_NODEJS_INSPECT_H
+
+#include <v8.h>
+#include <string>
+
+/**
+ * @brief Options for InspectValue, matching those of Node.js's util.inspect
+ */
+struct InspectOptions {
+    /**
+     * @brief Levels of nested objects to show; negative means no limit
+     */
+    int depth = 2;
+    
+    /**
+     * @brief Line length above which entries are put on separate lines
+     */
+    size_t break_length = 80;
+    
+    /**
+     * @brief Array, Set and Map entries shown before "... n more items"
+     */
+    size_t max_array_length = 100;
+};
+
+/**
+ * @brief Append the util.inspect() rendering of a value to a string
+ * 
+ * Objects are walked through the V8 API and written straight into out,
+ * with the same layout rules as Node.js: entries stay on one line while
+ * they fit in break_length, long arrays of short items are grouped into
+ * columns, cycles print as [Circular *n] with a <ref *n> marker on the
+ * target, and objects nested deeper than depth print as [Object] or
+ * [ClassName]. Getters of own properties are called, as Object.keys() plus
+ * a property read would.
+ * 
+ * @param context Context to read properties in
+ * @param value Value to render
+ * @param options Depth and layout limits
+ * @param out String to append to
+ * @return false if JavaScript code run by the walk threw; the exception is left pending
+ */
+bool InspectValue(v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                  const InspectOptions& options, std::string* out);
+
+/**
+ * @brief Append the util.format() rendering of call arguments to a string
+ * 
+ * The first argument may be a format string with %s, %d, %i, %f, %j, %o,
+ * %O, %c and %%; remaining arguments are appended separated by spaces,
+ * strings as they are and everything else through InspectValue. This is
+ * also what print() writes.
+ * 
+ * @param context Context to read properties in
+ * @param args Arguments to format, starting at index 0
+ * @param out String to append to
+ * @return false if JavaScript code run by the formatting threw; the exception is left pending
+ */
+bool FormatValues(v8::Local<v8::Context> context, const v8::FunctionCallbackInfo<v8::Value>& args,
+                  std::string* out);
+
+/**
+ * @brief Output buffer reused by inspect, format and print on one thread
+ * 
+ * Logging a value should not allocate a new string for every line. Each
+ * thread keeps one buffer that grows to the longest line written and is
+ * handed out again on the next call; a nested call (a getter that logs
+ * while an object is being inspected) gets a buffer of its own.
+ */
+class InspectBuffer {
+public:
+    InspectBuffer();
+    ~InspectBuffer();
+    
+    InspectBuffer(const InspectBuffer&) = delete;
+    InspectBuffer& operator=(const InspectBuffer&) = delete;
+    
+    /**
+     * @brief Get the empty buffer to write into
+     *
+     * @return The buffer
+     */
+    std::string* Get() { return buffer_; }
+
+private:
+    std::string* buffer_;
+    bool shared_;
+};
+
+#endif // TINY_NODEJS_INSPECT_H
@@ -0,0 +1,44 @@
+#ifndef TINY_NODEJS_KV_MODULE_H
+#define TINY_NODEJS_KV_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the kv module with the runtime
+ * 
+ * This function creates and registers the kv module, a small durable
+ * key-value store for local state. A store is a directory holding:
+ * - segment-N.log: Append-only log segments of checksummed put and delete
+ *   records; the newest segment receives writes
+ * - snapshot: A checkpoint of the in-memory hash index and the log position
+ *   it covers
+ * 
+ * Opening a store maps the snapshot, loads the index from it and replays
+ * only the log written after the checkpoint. A torn record at the tail of
+ * the log (from a crash during a write) is detected by its checksum and
+ * truncated away.
+ * 
+ * The kv module exposes the following functionality to JavaScript:
+ * - kv.open(dir, options): Opens or creates a store; options are sync
+ *   ('none', 'group' or 'always'), groupCommitMs, segmentSize and
+ *   compactThreshold (fraction of dead bytes that triggers compaction)
+ * - db.put(key, value), db.delete(key): Append a single record
+ * - db.batch(entries): Appends [key, value] pairs (null value to delete)
+ *   with one writev call
+ * - db.get(key): Returns a copy of the value, read from the mapped log
+ * - db.has(key), db.keys(), db.stats()
+ * - db.flush(): Makes every write so far durable
+ * - db.checkpoint(): Writes a new snapshot
+ * - db.compact(): Rewrites sealed segments without dead records on the
+ *   thread pool, returning a promise for the number of bytes reclaimed
+ * - db.close()
+ * 
+ * With sync set to 'group', writes return immediately and a background
+ * thread issues one fdatasync per groupCommitMs for all of them.
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterKvModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_KV_MODULE_H
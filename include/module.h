@@ -6,8 +6,9 @@
 #include <memory>
 #include "v8.h"
 
-// Forward declaration
+// Forward declarations
 class Runtime;
+struct BuiltinSource;
 
 /**
  * @brief Represents a JavaScript module
@@ -26,6 +27,17 @@ public:
      */
     Module(Runtime* runtime, const std::string& id, const std::string& filename);
     
+    /**
+     * @brief Constructor for a built-in module compiled into the binary
+     * 
+     * Built-in modules are served from read-only memory and use the
+     * pre-generated code cache when one is available.
+     * 
+     * @param runtime Pointer to the Runtime instance
+     * @param builtin Built-in module source
+     */
+    Module(Runtime* runtime, const BuiltinSource* builtin);
+    
     /**
      * @brief Destructor for the Module class
      */
@@ -34,8 +46,9 @@ public:
     /**
      * @brief Load and execute the module
      * 
-     * Reads the module file, wraps it in a function to create a module scope,
-     * and executes it to populate the exports object.
+     * Reads the module file (or the embedded source of a built-in module),
+     * compiles it as a function to create a module scope, and executes it
+     * to populate the exports object.
      * 
      * @return true if the module was loaded successfully, false otherwise
      */
@@ -63,6 +76,27 @@ public:
      */
     v8::Local<v8::Object> GetExports(v8::Isolate* isolate);
     
+    /**
+     * @brief Compile module source into its CommonJS wrapper function
+     * 
+     * The function takes (exports, require, module, __filename, __dirname).
+     * This is shared with tools/mkcodecache.cpp so that the code cache is
+     * produced for exactly the function the runtime compiles.
+     * 
+     * @param context V8 context to compile in
+     * @param source Module source code
+     * @param filename Name used in stack traces
+     * @param cached_data Code cache to consume, or nullptr (ownership is taken)
+     * @param eager Compile all inner functions eagerly (for producing code cache)
+     * @return Compiled module function
+     */
+    static v8::MaybeLocal<v8::Function> CompileFunction(
+        v8::Local<v8::Context> context,
+        v8::Local<v8::String> source,
+        const std::string& filename,
+        v8::ScriptCompiler::CachedData* cached_data = nullptr,
+        bool eager = false);
+    
 private:
     /**
      * @brief Pointer to the Runtime instance
@@ -86,6 +120,11 @@ private:
      */
     v8::Global<v8::Object> exports_;
     
+    /**
+     * @brief Embedded source for built-in modules, nullptr for file modules
+     */
+    const BuiltinSource* builtin_;
+    
     /**
      * @brief Flag indicating whether the module has been loaded
      */
@@ -118,6 +157,8 @@ public:
      * @brief Require a module (similar to require() in Node.js)
      * 
      * Loads the module if it hasn't been loaded yet, or returns the cached module.
+     * Native modules are checked first, then built-in JavaScript modules
+     * compiled into the binary, then files on disk.
      * 
      * @param module_id Module identifier (e.g., './math' or 'fs')
      * @return Module exports object
@@ -132,6 +173,17 @@ public:
      */
     void RegisterNativeModule(const std::string& module_id, v8::Local<v8::Object> exports);
     
+    /**
+     * @brief Register a native module by the template of its exports
+     * 
+     * The exports object is created from the template in the current
+     * context the first time the module is requested.
+     * 
+     * @param module_id Module identifier (e.g., 'fs')
+     * @param exports_template Template of the module exports object
+     */
+    void RegisterNativeModule(const std::string& module_id, v8::Local<v8::ObjectTemplate> exports_template);
+    
     /**
      * @brief Get a native module by ID
      * 
@@ -166,6 +218,11 @@ private:
      */
     std::unordered_map<std::string, v8::Global<v8::Object>> native_modules_;
     
+    /**
+     * @brief Templates of native modules not yet instantiated, indexed by module ID
+     */
+    std::unordered_map<std::string, v8::Global<v8::ObjectTemplate>> native_templates_;
+    
     /**
      * @brief Resolve a module ID to a filename
      * 
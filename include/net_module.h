@@ -0,0 +1,49 @@
+#ifndef TINY_NODEJS_NET_MODULE_H
+#define TINY_NODEJS_NET_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the net module
+ * 
+ * This function creates and registers the internal/net module, which
+ * lib/net.js builds the Node.js-style net API on (createServer, connect,
+ * Socket and Server). Scripts use require('net') rather than this module.
+ * 
+ * Sockets are libuv TCP handles on the runtime's event loop. Reads are
+ * carved out of shared 256 KB ArrayBuffer slabs: each read lands directly
+ * after the previous one and is handed to JavaScript as a Uint8Array view,
+ * so a busy connection costs neither an allocation nor a copy per read.
+ * Writes take any number of chunks at once (one writev(2) for a corked
+ * socket) and are tried synchronously before anything is queued.
+ * 
+ * TCP handles are also StreamBase streams (stream_base.h): while a native
+ * pipe from internal/stream is attached, reads go to the pipe's buffers
+ * and never reach JavaScript.
+ * 
+ * Callbacks are registered once with setup() and called with the handle
+ * as this; lib/net.js finds the socket or server through handle.owner.
+ * 
+ * The internal/net module exposes the following functionality:
+ * - setup(callbacks): Registers onread(nread, chunk), onconnection(status,
+ *   handle), onconnect(status), onwrite(status), onshutdown(status) and
+ *   onclose()
+ * - TCP: Handle class with bind(ip, port), listen(backlog), connect(host,
+ *   port), readStart(), readStop(), writev(chunks), shutdown(), close(),
+ *   setNoDelay(enable), setKeepAlive(enable, delaySeconds),
+ *   getsockname(out), getpeername(out), ref(), unref() and
+ *   writeQueueSize()
+ * - isIP(input): 4 or 6 for an IP address literal, 0 otherwise
+ * - errname(err), strerror(err): Name and message of a libuv error
+ * - constants: UV_EOF and the libuv error codes lib/net.js checks for
+ * 
+ * Methods that start an operation return 0 or a negative libuv error code
+ * instead of throwing. writev() returns 0 when the data went out at once
+ * and 1 when it was queued, in which case onwrite() follows.
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterNetModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_NET_MODULE_H
@@ -0,0 +1,156 @@
+#ifndef TINY_NODEJS_PROPERTY_KEYS_H
+#define TINY_NODEJS_PROPERTY_KEYS_H
+
+#include <v8.h>
+
+// Property names natives read or write, as V(accessor, "name")
+#define PROPERTY_KEY_STRINGS(V)                                                \
+    V(address, "address")                                                      \
+    V(body, "body")                                                            \
+    V(bytes, "bytes")                                                          \
+    V(bytes_streamed, "bytesStreamed")                                         \
+    V(cache_hits, "cacheHits")                                                 \
+    V(cache_misses, "cacheMisses")                                             \
+    V(cache_rejected, "cacheRejected")                                         \
+    V(cache_writes, "cacheWrites")                                             \
+    V(cached_data, "cachedData")                                               \
+    V(cached_data_rejected, "cachedDataRejected")                              \
+    V(cancelled, "cancelled")                                                  \
+    V(capacity, "capacity")                                                    \
+    V(close, "close")                                                          \
+    V(code, "code")                                                            \
+    V(compact_threshold, "compactThreshold")                                   \
+    V(compactions, "compactions")                                              \
+    V(compiling, "compiling")                                                  \
+    V(completed, "completed")                                                  \
+    V(completion, "completion")                                                \
+    V(constructor, "constructor")                                              \
+    V(continuation, "continuation")                                            \
+    V(depth, "depth")                                                          \
+    V(dropped, "dropped")                                                      \
+    V(end, "end")                                                              \
+    V(entries, "entries")                                                      \
+    V(error_number, "errno")                                                   \
+    V(evictions, "evictions")                                                  \
+    V(expirations, "expirations")                                              \
+    V(exports, "exports")                                                      \
+    V(failed, "failed")                                                        \
+    V(family, "family")                                                        \
+    V(group_commit_ms, "groupCommitMs")                                        \
+    V(headers, "headers")                                                      \
+    V(high_water, "highWater")                                                 \
+    V(hits, "hits")                                                            \
+    V(ipv4, "IPv4")                                                            \
+    V(ipv6, "IPv6")                                                            \
+    V(keys, "keys")                                                            \
+    V(length, "length")                                                        \
+    V(listen, "listen")                                                        \
+    V(live_bytes, "liveBytes")                                                 \
+    V(max_bytes, "maxBytes")                                                   \
+    V(max_queued, "maxQueued")                                                 \
+    V(method, "method")                                                        \
+    V(misses, "misses")                                                        \
+    V(module, "module")                                                        \
+    V(name, "name")                                                            \
+    V(oncomplete, "oncomplete")                                                \
+    V(path, "path")                                                            \
+    V(paused, "paused")                                                        \
+    V(port, "port")                                                            \
+    V(process, "process")                                                      \
+    V(queue_depths, "queueDepths")                                             \
+    V(queued, "queued")                                                        \
+    V(queues, "queues")                                                        \
+    V(records, "records")                                                      \
+    V(rejected, "rejected")                                                    \
+    V(running, "running")                                                      \
+    V(scheduled, "scheduled")                                                  \
+    V(segment_size, "segmentSize")                                             \
+    V(segments, "segments")                                                    \
+    V(shards, "shards")                                                        \
+    V(slices, "slices")                                                        \
+    V(stack, "stack")                                                          \
+    V(stolen, "stolen")                                                        \
+    V(submitted, "submitted")                                                  \
+    V(sync, "sync")                                                            \
+    V(task, "task")                                                            \
+    V(time_slice, "timeSlice")                                                 \
+    V(timed_out, "timedOut")                                                   \
+    V(to_string, "toString")                                                   \
+    V(transfer, "transfer")                                                    \
+    V(ttl, "ttl")                                                              \
+    V(url, "url")                                                              \
+    V(waits, "waits")                                                          \
+    V(workers, "workers")                                                      \
+    V(write_head, "writeHead")
+
+// Private symbols for slots on JavaScript objects that scripts must not see
+#define PROPERTY_KEY_PRIVATE_SYMBOLS(V)                                        \
+    V(http_callback, "tiny_node:http:callback")                                \
+    V(http_server_id, "tiny_node:http:serverId")                               \
+    V(vm_context, "tiny_node:vm:context")                                      \
+    V(vm_global, "tiny_node:vm:global")
+
+/**
+ * @brief Property keys shared by all native bindings of a runtime
+ * 
+ * Every runtime creates one PropertyKeys with its isolate. The strings are
+ * internalized once and kept in v8::Eternal handles, so reading or writing
+ * a property from C++ neither allocates nor hashes the name:
+ * 
+ *     const PropertyKeys& keys = PropertyKeys::Get(isolate);
+ *     out->Set(context, keys.port_string(), port).Check();
+ * 
+ * The keys are generated from the PROPERTY_KEY_STRINGS and
+ * PROPERTY_KEY_PRIVATE_SYMBOLS lists above; a binding that needs a new key
+ * adds it there. Private symbols name internal slots, which unlike
+ * underscore-prefixed properties are invisible to scripts.
+ */
+class PropertyKeys {
+public:
+    /**
+     * @brief Create the keys in an isolate
+     * 
+     * Must be called with the isolate locked and a HandleScope open.
+     * 
+     * @param isolate The isolate the keys belong to
+     */
+    explicit PropertyKeys(v8::Isolate* isolate);
+    
+    PropertyKeys(const PropertyKeys&) = delete;
+    PropertyKeys& operator=(const PropertyKeys&) = delete;
+    
+    /**
+     * @brief Get the keys of the runtime that owns an isolate
+     * 
+     * @param isolate An isolate created by a Runtime
+     * @return The runtime's keys
+     */
+    static const PropertyKeys& Get(v8::Isolate* isolate);
+    
+#define V(accessor, value)                                                     \
+    v8::Local<v8::String> accessor##_string() const {                          \
+        return accessor##_string_.Get(isolate_);                               \
+    }
+    PROPERTY_KEY_STRINGS(V)
+#undef V
+    
+#define V(accessor, value)                                                     \
+    v8::Local<v8::Private> accessor##_private_symbol() const {                 \
+        return accessor##_private_symbol_.Get(isolate_);                       \
+    }
+    PROPERTY_KEY_PRIVATE_SYMBOLS(V)
+#undef V
+    
+private:
+    v8::Isolate* isolate_;
+    
+#define V(accessor, value) v8::Eternal<v8::String> accessor##_string_;
+    PROPERTY_KEY_STRINGS(V)
+#undef V
+    
+#define V(accessor, value) v8::Eternal<v8::Private> accessor##_private_symbol_;
+    PROPERTY_KEY_PRIVATE_SYMBOLS(V)
+#undef V
+};
+
+#endif // TINY_NODEJS_PROPERTY_KEYS_H
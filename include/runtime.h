@@ -6,12 +6,88 @@
 #include <vector>
 #include <unordered_map>
 #include <functional>
+#include <mutex>
+#include <condition_variable>
 #include "v8.h"
 #include "libplatform/libplatform.h"
+#include "affinity.h"
 
 // Forward declarations
 class EventLoop;
 class ModuleSystem;
+class PropertyKeys;
+
+/**
+ * @brief Options for creating a Runtime instance
+ * 
+ * The defaults match the tiny_node executable. Embedders that drive the
+ * runtime from their own threads set own_loop_thread to false and call
+ * Runtime::PumpEventLoop() instead.
+ */
+struct RuntimeOptions {
+    /**
+     * @brief Start a dedicated event loop thread for this runtime
+     */
+    bool own_loop_thread = true;
+    
+    /**
+     * @brief Allow blocking Atomics.wait in this runtime
+     * 
+     * Worker runtimes may block; a runtime whose thread also serves the
+     * event loop should use Atomics.waitAsync instead, whose wakeups are
+     * delivered as event loop tasks.
+     */
+    bool allow_atomics_wait = true;
+    
+    /**
+     * @brief Ask JavaScript that holds the isolate this long to yield to the event loop
+     * 
+     * In milliseconds; 0 (the default) never asks. See
+     * EventLoop::StartTimeSlicing().
+     */
+    uint64_t time_slice_ms = 0;
+    
+    /**
+     * @brief Capacity of the event loop's task and completion lanes
+     * 
+     * Producers on other threads wait (only while the runtime has its own
+     * loop thread), and EventLoop::TrySchedule() fails, once this many tasks
+     * are queued in a lane; 0 means no limit. See EventLoop::ScheduleTask().
+     */
+    size_t task_queue_capacity = 65536;
+    
+    /**
+     * @brief Record the requests the http module's servers dispatch to this file
+     * 
+     * Empty (the default) records nothing. See http_capture.h.
+     */
+    std::string http_capture_path;
+    
+    /**
+     * @brief CPUs or NUMA nodes the event loop thread is pinned to
+     * 
+     * Only applies to the thread started when own_loop_thread is set; the
+     * embedder pins threads it pumps the loop from itself.
+     */
+    CpuAffinity loop_affinity;
+    
+    /**
+     * @brief Default CPUs or NUMA nodes of the workerpool module's workers
+     * 
+     * A pool created without an affinity option pins worker i to slot i.
+     */
+    CpuAffinity worker_affinity;
+    
+    /**
+     * @brief Number of arguments exposed as process.argv (0 skips the process module)
+     */
+    int argc = 0;
+    
+    /**
+     * @brief Arguments exposed as process.argv
+     */
+    char** argv = nullptr;
+};
 
 /**
  * @brief Core runtime class for the tiny Node.js implementation
@@ -29,7 +105,8 @@ public:
      * @brief Initialize the V8 platform and JavaScript engine
      * 
      * This static method must be called before creating any Runtime instances.
-     * It initializes the V8 platform and JavaScript engine.
+     * It initializes the V8 platform and JavaScript engine. It is safe to call
+     * from several threads; only the first call initializes V8.
      * 
      * @return true if initialization was successful, false otherwise
      */
@@ -47,8 +124,13 @@ public:
      * @brief Constructor for the Runtime class
      * 
      * Creates a new Runtime instance with its own V8 isolate, event loop, and module system.
+     * Any number of runtimes may exist at once, on any threads. Every entry point
+     * below takes the isolate's v8::Locker, so a runtime may be used from one
+     * thread at a time without further synchronization by the caller.
+     * 
+     * @param options Runtime creation options
      */
-    Runtime();
+    explicit Runtime(const RuntimeOptions& options = RuntimeOptions());
     
     /**
      * @brief Destructor for the Runtime class
@@ -79,6 +161,40 @@ public:
      */
     bool ExecuteString(const std::string& source, const std::string& source_name = "");
     
+    /**
+     * @brief Submit a JavaScript string for execution on the event loop
+     * 
+     * Thread-safe. The script runs the next time the loop processes tasks,
+     * either on the loop thread or inside PumpEventLoop().
+     * 
+     * @param source JavaScript code to execute
+     * @param source_name Optional name for the source (used in error messages)
+     * @param done Optional callback receiving the result of ExecuteString
+     */
+    void SubmitScript(const std::string& source, const std::string& source_name = "",
+                      std::function<void(bool)> done = nullptr);
+    
+    /**
+     * @brief Run one iteration of the event loop on the calling thread
+     * 
+     * Used by embedders that created the runtime with own_loop_thread set to
+     * false. Executes due tasks and pending V8 platform tasks for this isolate.
+     * 
+     * @param timeout_ms Maximum time to wait for work, 0 to never block
+     * @return Number of loop tasks executed
+     */
+    size_t PumpEventLoop(uint64_t timeout_ms = 0);
+    
+    /**
+     * @brief Run pending V8 platform tasks for this runtime's isolate
+     * 
+     * Called by the event loop on every iteration. This is how Atomics.waitAsync
+     * wakeups and other V8 foreground tasks reach the runtime.
+     * 
+     * @return Number of platform tasks executed
+     */
+    size_t PumpPlatformTasks();
+    
     /**
      * @brief Register a native C++ function to be callable from JavaScript
      * 
@@ -101,6 +217,20 @@ public:
      */
     ModuleSystem* GetModuleSystem() const;
     
+    /**
+     * @brief Get the options the runtime was created with
+     * 
+     * @return The runtime's options
+     */
+    const RuntimeOptions& GetOptions() const;
+    
+    /**
+     * @brief Get the interned property keys shared by native bindings
+     * 
+     * @return The runtime's property keys
+     */
+    const PropertyKeys& GetPropertyKeys() const;
+    
     /**
      * @brief Get the V8 isolate instance
      * 
@@ -131,6 +261,45 @@ public:
      */
     void CancelDelayedTask(uint64_t task_id);
     
+    /**
+     * @brief Run work on the shared thread pool and continue on the event loop
+     * 
+     * The work function runs on a pool thread and must not touch V8. When it
+     * returns, after_work is scheduled on this runtime's event loop, where it
+     * can create handles and resolve promises, through the loop's completion
+     * lane. While that lane is full, a caller that does not hold the isolate
+     * lock waits for the loop before the work is submitted; the pool thread
+     * never waits. The runtime waits for queued work to finish before it is
+     * destroyed.
+     * 
+     * @param work Function to be executed on a pool thread
+     * @param after_work Function to be executed on the event loop afterwards
+     */
+    void QueueWork(std::function<void()> work, std::function<void()> after_work);
+    
+    /**
+     * @brief Check whether the runtime still has work that will call back into JavaScript
+     * 
+     * True while thread pool work is queued, event loop tasks or timers are
+     * pending, or libuv handles such as sockets are open. The tiny_node
+     * executable keeps running until this returns false, like Node.js.
+     * 
+     * @return true if there is pending work, false otherwise
+     */
+    bool HasPendingWork();
+    
+    /**
+     * @brief Register a function to run when the runtime is destroyed
+     * 
+     * Hooks run with the isolate locked, after the event loop has stopped and
+     * before the module system and isolate are torn down, in reverse order of
+     * registration. Native modules use them to close libuv handles and release
+     * persistent handles they own.
+     * 
+     * @param hook Function to be executed during destruction
+     */
+    void AddCleanupHook(std::function<void()> hook);
+    
 private:
     /**
      * @brief V8 platform instance (shared by all Runtime instances)
@@ -142,6 +311,11 @@ private:
      */
     v8::Isolate* isolate_;
     
+    /**
+     * @brief Options the runtime was created with
+     */
+    RuntimeOptions options_;
+    
     /**
      * @brief Global object template for creating JavaScript contexts
      */
@@ -162,6 +336,31 @@ private:
      */
     std::unordered_map<std::string, v8::FunctionCallback> native_functions_;
     
+    /**
+     * @brief Functions registered with AddCleanupHook
+     */
+    std::vector<std::function<void()>> cleanup_hooks_;
+    
+    /**
+     * @brief Interned property keys and private symbols, see property_keys.h
+     */
+    std::unique_ptr<PropertyKeys> property_keys_;
+    
+    /**
+     * @brief Number of QueueWork items that have not finished yet
+     */
+    size_t pending_work_;
+    
+    /**
+     * @brief Mutex for protecting access to the pending work count
+     */
+    std::mutex pending_work_mutex_;
+    
+    /**
+     * @brief Condition variable for signaling when queued work finishes
+     */
+    std::condition_variable pending_work_cv_;
+    
     /**
      * @brief Read a file into a string
      * 
@@ -0,0 +1,29 @@
+#ifndef TINY_NODEJS_SCHEDULER_MODULE_H
+#define TINY_NODEJS_SCHEDULER_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the scheduler module
+ * 
+ * This function creates and registers the internal/scheduler module, which
+ * lib/scheduler.js builds the global scheduler object on.
+ * 
+ * yield() returns a promise that is resolved by a continuation task (see
+ * EventLoop::ScheduleContinuation()). Code awaiting it lets libuv callbacks
+ * run and then resumes before any task queued in the meantime. A batch job
+ * that yields every few milliseconds keeps a server in the same runtime
+ * responsive without giving up its place in the queue.
+ * 
+ * The internal/scheduler module exposes the following functionality:
+ * - yield(): Returns a promise resolved on the next loop iteration
+ * - stats(): The time slice length in milliseconds (0 when time slicing is
+ *   off), the number of slices that interrupted long-running code, and
+ *   under queues the TaskLaneStats of each event loop lane
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterSchedulerModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_SCHEDULER_MODULE_H
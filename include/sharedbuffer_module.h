@@ -0,0 +1,60 @@
+#ifndef TINY_NODEJS_SHAREDBUFFER_MODULE_H
+#define TINY_NODEJS_SHAREDBUFFER_MODULE_H
+
+#include <memory>
+#include <string>
+#include "v8.h"
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the sharedbuffer module with the runtime
+ * 
+ * This function creates and registers the sharedbuffer module, which lets
+ * several runtimes (each with its own isolate, usually on its own thread)
+ * share SharedArrayBuffer memory. Buffers are published under a name in a
+ * process-wide registry; opening a name in another runtime creates a new
+ * SharedArrayBuffer over the same backing store, so no data is copied.
+ * 
+ * The sharedbuffer module exposes the following functionality to JavaScript:
+ * - sharedbuffer.create(name, byteLength): Creates and publishes a new buffer
+ * - sharedbuffer.publish(name, sab): Publishes an existing SharedArrayBuffer
+ * - sharedbuffer.open(name): Returns the buffer published under name, or undefined
+ * - sharedbuffer.unlink(name): Removes name from the registry
+ * 
+ * Atomics.wait/notify work across runtimes on these buffers. Atomics.waitAsync
+ * wakeups are delivered by the waiting runtime's event loop.
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterSharedBufferModule(Runtime* runtime);
+
+/**
+ * @brief Publish a backing store under a name (for embedders)
+ * 
+ * @param name Registry name
+ * @param backing_store Shared backing store
+ * @return true if published, false if the name is already taken
+ */
+bool PublishSharedBuffer(const std::string& name, std::shared_ptr<v8::BackingStore> backing_store);
+
+/**
+ * @brief Find a published backing store by name (for embedders)
+ * 
+ * @param name Registry name
+ * @return Shared backing store, or nullptr if the name is not published
+ */
+std::shared_ptr<v8::BackingStore> FindSharedBuffer(const std::string& name);
+
+/**
+ * @brief Remove a name from the registry
+ * 
+ * Runtimes that already opened the buffer keep it alive.
+ * 
+ * @param name Registry name
+ * @return true if the name was published, false otherwise
+ */
+bool UnlinkSharedBuffer(const std::string& name);
+
+#endif // TINY_NODEJS_SHAREDBUFFER_MODULE_H
@@ -0,0 +1,162 @@
+#ifndef TINY_NODEJS_STREAM_BASE_H
+#define TINY_NODEJS_STREAM_BASE_H
+
+#include <v8.h>
+#include <uv.h>
+#include <cstddef>
+
+/**
+ * @brief A byte stream that native code can read from and write to directly
+ * 
+ * Handles backed by a file descriptor or socket (TCP handles from
+ * internal/net, file streams from internal/fs) implement this interface, so
+ * a native pipe can move data between two of them without calling into
+ * JavaScript per chunk. Their JavaScript objects keep a pointer to the
+ * StreamBase in internal field kStreamBaseField; FromObject() finds it.
+ * 
+ * While a read listener is attached, reads go to the listener instead of
+ * the handle's JavaScript callbacks, into memory the listener provides.
+ * Writes made through Write() report completion to the listener passed
+ * with them.
+ */
+class StreamBase {
+public:
+    /**
+     * @brief Internal field of handle objects holding their StreamBase
+     */
+    static constexpr int kStreamBaseField = 1;
+    
+    /**
+     * @brief Receives reads, write completions and close notices from streams
+     */
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+        
+        /**
+         * @brief Provide the memory for the next read
+         *
+         * @param suggested_size Size the stream would like to read
+         * @param buf Set to the memory to read into
+         */
+        virtual void OnStreamAlloc(size_t suggested_size, uv_buf_t* buf) = 0;
+        
+        /**
+         * @brief Handle a read into memory from OnStreamAlloc()
+         *
+         * Every OnStreamAlloc() is followed by exactly one OnStreamRead()
+         * with the same memory, so the listener can reuse it. A read that
+         * was in flight when the listener was detached still reports, with
+         * UV_ECANCELED, possibly after OnStreamClose().
+         *
+         * @param nread Bytes read (0 if nothing was available), or a negative
+         *        libuv error (UV_EOF at the end)
+         * @param buf The memory that was read into
+         */
+        virtual void OnStreamRead(ssize_t nread, const uv_buf_t& buf) = 0;
+        
+        /**
+         * @brief Handle the completion of a queued Write()
+         *
+         * @param token The token passed to Write()
+         * @param status 0 or a negative libuv error
+         */
+        virtual void OnStreamWrite(void* token, int status) = 0;
+        
+        /**
+         * @brief Handle a stream closing while the listener is attached to it
+         *
+         * The stream must not be used after this returns; only reads and
+         * writes already in flight still report back.
+         *
+         * @param stream The stream being closed
+         */
+        virtual void OnStreamClose(StreamBase* stream) = 0;
+    };
+    
+    virtual ~StreamBase() = default;
+    
+    /**
+     * @brief Start reading into the read listener
+     *
+     * @return 0 or a negative libuv error
+     */
+    virtual int ReadStart() = 0;
+    
+    /**
+     * @brief Stop reading; a read already in progress may still complete
+     *
+     * @return 0 or a negative libuv error
+     */
+    virtual int ReadStop() = 0;
+    
+    /**
+     * @brief Write buffers whose memory the caller keeps alive until completion
+     *
+     * @param bufs Buffers to write, in order
+     * @param count Number of buffers
+     * @param listener Listener told when a queued write completes
+     * @param token Passed back to OnStreamWrite()
+     * @return 0 if everything was written at once, 1 if the write was queued
+     *         and OnStreamWrite() follows, or a negative libuv error
+     */
+    virtual int Write(const uv_buf_t* bufs, size_t count, Listener* listener, void* token) = 0;
+    
+    /**
+     * @brief Attach the listener that receives reads, or detach with nullptr
+     *
+     * @param listener The listener
+     */
+    void SetReadListener(Listener* listener) { read_listener_ = listener; }
+    
+    /**
+     * @brief Attach the listener told about closing while writes go through it
+     *
+     * @param listener The listener
+     */
+    void SetWriteListener(Listener* listener) { write_listener_ = listener; }
+    
+    /**
+     * @brief Get the listener that receives reads
+     *
+     * @return The listener, or nullptr when reads go to JavaScript
+     */
+    Listener* GetReadListener() const { return read_listener_; }
+    
+    /**
+     * @brief Find the stream behind a handle object
+     *
+     * @param object A JavaScript handle object
+     * @return The stream, or nullptr if the object is not a native stream or has closed
+     */
+    static StreamBase* FromObject(v8::Local<v8::Object> object) {
+        if (object->InternalFieldCount() <= kStreamBaseField) {
+            return nullptr;
+        }
+        return static_cast<StreamBase*>(object->GetAlignedPointerFromInternalField(kStreamBaseField));
+    }
+    
+    /**
+     * @brief Tell attached listeners the stream is closing, and detach them
+     *
+     * Bindings call this when a handle starts to close.
+     */
+    void NotifyClose() {
+        Listener* read_listener = read_listener_;
+        Listener* write_listener = write_listener_;
+        read_listener_ = nullptr;
+        write_listener_ = nullptr;
+        if (read_listener) {
+            read_listener->OnStreamClose(this);
+        }
+        if (write_listener && write_listener != read_listener) {
+            write_listener->OnStreamClose(this);
+        }
+    }
+
+private:
+    Listener* read_listener_ = nullptr;
+    Listener* write_listener_ = nullptr;
+};
+
+#endif // TINY_NODEJS_STREAM_BASE_H
@@ -0,0 +1,40 @@
+#ifndef TINY_NODEJS_STREAM_MODULE_H
+#define TINY_NODEJS_STREAM_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the stream module
+ * 
+ * This function creates and registers the internal/stream module, which
+ * lib/stream.js uses for the bookkeeping of every Readable and Writable and
+ * for pipelines between native streams. Scripts use require('stream')
+ * rather than this module.
+ * 
+ * A BufferList is the chunk queue of one side of a stream. It keeps the
+ * chunks themselves in a JavaScript array owned by the list object and
+ * their sizes natively, so the high-water mark check done on every push()
+ * and write() needs no property reads; chunks taken for a write stay
+ * counted until done() reports them written.
+ * 
+ * pipe() connects two StreamBase handles (stream_base.h), such as a file
+ * stream from internal/fs and a TCP handle from internal/net. The source
+ * reads into a small pool of 64 KB buffers owned by the pipe and each
+ * buffer is written straight to the sink; reading stops while
+ * highWaterMark buffers are being written and resumes as they finish.
+ * JavaScript is called once, when the pipe ends.
+ * 
+ * The internal/stream module exposes the following functionality:
+ * - BufferList(highWaterMark, objectMode): Chunk queue with push(chunk,
+ *   measured), shift(), take(), takeAll(), done(count), takeDrain(),
+ *   clear(), length() and count()
+ * - pipe(source, sink, highWaterMark, callback): Starts a native pipe and
+ *   returns 0 or a negative libuv error; callback(status) follows with 0
+ *   once the source ended and everything was written, or an error
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterStreamModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_STREAM_MODULE_H
@@ -0,0 +1,141 @@
+#ifndef TINY_NODEJS_THREAD_POOL_H
+#define TINY_NODEJS_THREAD_POOL_H
+
+#include <functional>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include "affinity.h"
+
+/**
+ * @brief Fixed-size pool of worker threads for blocking and CPU-bound work
+ * 
+ * The ThreadPool class plays the role of libuv's thread pool: native modules
+ * submit work that must not block the event loop (file I/O, compression,
+ * hashing, compaction) and post the result back to the loop when done.
+ * Work items never touch V8; results are handed to JavaScript by a task
+ * scheduled on the owning runtime's event loop (see Runtime::QueueWork).
+ * 
+ * A pool given a NUMA node affinity keeps one queue per node. Worker i is
+ * pinned to node i modulo the node count and serves its node's queue, so
+ * work submitted from a thread on a node runs on that node, next to the
+ * buffers the submitter touched. A worker whose queue is empty takes work
+ * from the other nodes before going idle.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Constructor for the ThreadPool class
+     * 
+     * @param thread_count Number of worker threads to start
+     * @param affinity CPUs or NUMA nodes the workers are pinned to
+     */
+    explicit ThreadPool(size_t thread_count, const CpuAffinity& affinity = CpuAffinity());
+    
+    /**
+     * @brief Destructor for the ThreadPool class
+     * 
+     * Runs the work already queued and joins the worker threads.
+     */
+    ~ThreadPool();
+    
+    /**
+     * @brief Queue work to run on a worker thread
+     * 
+     * @param work Function to be executed
+     */
+    void Submit(std::function<void()> work);
+    
+    /**
+     * @brief Get the number of worker threads
+     * 
+     * @return Number of worker threads
+     */
+    size_t GetThreadCount() const;
+    
+    /**
+     * @brief Get the process-wide pool shared by all runtimes
+     * 
+     * The pool is created on first use with TINY_NODE_THREADPOOL_SIZE threads
+     * (4 if unset), pinned as set by SetDefaultAffinity() or else by
+     * TINY_NODE_THREADPOOL_AFFINITY, and lives until the process exits.
+     * 
+     * @return Pointer to the shared pool
+     */
+    static ThreadPool* GetDefault();
+    
+    /**
+     * @brief Set the affinity of the process-wide pool
+     * 
+     * @param affinity CPUs or NUMA nodes the shared pool's workers are pinned to
+     * @return false if the shared pool has already been created
+     */
+    static bool SetDefaultAffinity(const CpuAffinity& affinity);
+    
+private:
+    /**
+     * @brief Work waiting for the workers of one NUMA node
+     */
+    struct NodeQueue {
+        std::queue<std::function<void()>> queue;
+        
+        // Signaled when work is queued here and one of this node's workers is idle
+        std::condition_variable cv;
+        size_t idle = 0;
+    };
+    
+    /**
+     * @brief Worker threads
+     */
+    std::vector<std::thread> threads_;
+    
+    /**
+     * @brief CPUs or NUMA nodes the workers are pinned to
+     */
+    CpuAffinity affinity_;
+    
+    /**
+     * @brief One queue per node of a node affinity, a single queue otherwise
+     */
+    std::vector<NodeQueue> queues_;
+    
+    /**
+     * @brief Index into queues_ of each NUMA node of the machine, -1 if not served
+     */
+    std::vector<int> node_queues_;
+    
+    /**
+     * @brief Queue for work submitted from nodes the pool does not serve
+     */
+    size_t next_queue_;
+    
+    /**
+     * @brief Mutex for protecting access to the queues
+     */
+    std::mutex mutex_;
+    
+    /**
+     * @brief Flag set by the destructor to stop the workers
+     */
+    bool stopping_;
+    
+    /**
+     * @brief Main function of each worker thread
+     * 
+     * @param slot Index of the worker, which picks its node and queue
+     */
+    void WorkerMain(size_t slot);
+    
+    /**
+     * @brief Take work for a worker, from its own queue first
+     * 
+     * @param home Index of the worker's queue
+     * @param work Receives the work
+     * @return true if work was found
+     */
+    bool TakeWork(size_t home, std::function<void()>* work);
+};
+
+#endif // TINY_NODEJS_THREAD_POOL_H
@@ -0,0 +1,32 @@
+#ifndef TINY_NODEJS_TINY_NODE_H
+#define TINY_NODEJS_TINY_NODE_H
+
+/**
+ * @brief Embedding API for the tiny_node_core library
+ * 
+ * Include this header and link against tiny_node_core to use the runtime as a
+ * scripting engine inside another C++ program. A typical host looks like this:
+ * 
+ *     Runtime::Initialize();                  // once per process, any thread
+ * 
+ *     RuntimeOptions options;
+ *     options.own_loop_thread = false;        // the host pumps the loop
+ *     Runtime runtime(options);               // one isolate per runtime
+ * 
+ *     runtime.SubmitScript("print('hi')", "job.js");
+ *     while (running) {
+ *         runtime.PumpEventLoop(10);          // run due tasks, wait up to 10ms
+ *     }
+ * 
+ * Each Runtime owns its own isolate, and every entry point (ExecuteString,
+ * SubmitScript tasks, PumpEventLoop, loop tasks) takes that isolate's
+ * v8::Locker. Many runtimes can therefore live on many threads at once, and a
+ * runtime may be handed from one thread to another between calls.
+ * Runtime::Shutdown() is called once after all runtimes have been destroyed.
+ */
+
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+
+#endif // TINY_NODEJS_TINY_NODE_H
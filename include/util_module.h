@@ -0,0 +1,24 @@
+#ifndef TINY_NODEJS_UTIL_MODULE_H
+#define TINY_NODEJS_UTIL_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the util module
+ * 
+ * This function creates and registers the internal/util module, which backs
+ * util.inspect() and util.format() in lib/util.js with the engine in
+ * inspect.h. Each call renders into the thread's InspectBuffer and returns
+ * one string, so logging does not build intermediate strings per property.
+ * Scripts use require('util') rather than this module.
+ * 
+ * The internal/util module exposes the following functionality:
+ * - inspect(value, depth): Renders a value; a depth of null or Infinity means no limit
+ * - format(format, ...args): printf-style formatting as util.format()
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterUtilModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_UTIL_MODULE_H
@@ -0,0 +1,135 @@
+#ifndef TINY_NODEJS_V8_MODULE_H
+#define TINY_NODEJS_V8_MODULE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "v8.h"
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Serializer for a kind of host object (objects backed by C++ state)
+ * 
+ * Native modules register a codec for their wrapper objects so that those
+ * objects can be passed through the structured clone serializer. Codecs are
+ * identified in the serialized data by name.
+ */
+struct HostObjectCodec {
+    /**
+     * @brief Unique codec name written into the serialized data
+     */
+    const char* name;
+    
+    /**
+     * @brief Check whether an object is handled by this codec
+     */
+    bool (*matches)(v8::Isolate* isolate, v8::Local<v8::Object> object);
+    
+    /**
+     * @brief Write the object's state using the serializer's raw write methods
+     */
+    bool (*write)(v8::Isolate* isolate, v8::ValueSerializer* serializer, v8::Local<v8::Object> object);
+    
+    /**
+     * @brief Recreate the object from the deserializer's raw read methods
+     */
+    v8::MaybeLocal<v8::Object> (*read)(v8::Isolate* isolate, v8::ValueDeserializer* deserializer);
+};
+
+/**
+ * @brief Register a host object codec (process-wide, not thread-safe against serialization)
+ * 
+ * Call during startup, before any runtime serializes values.
+ * 
+ * @param codec Codec with static storage duration
+ */
+void RegisterHostObjectCodec(const HostObjectCodec* codec);
+
+/**
+ * @brief A value serialized with the structured clone algorithm
+ * 
+ * The bytes live in a pooled buffer. Transferred ArrayBuffers and shared
+ * SharedArrayBuffers travel alongside as backing stores, so a message is only
+ * meaningful inside the process that produced it.
+ */
+struct SerializedValue {
+    /**
+     * @brief Serialized bytes (pooled memory)
+     */
+    std::shared_ptr<uint8_t> data;
+    
+    /**
+     * @brief Number of serialized bytes
+     */
+    size_t length = 0;
+    
+    /**
+     * @brief Backing stores of transferred ArrayBuffers, in transfer order
+     */
+    std::vector<std::shared_ptr<v8::BackingStore>> transferred;
+    
+    /**
+     * @brief Backing stores of SharedArrayBuffers referenced by the value
+     */
+    std::vector<std::shared_ptr<v8::BackingStore>> shared;
+};
+
+/**
+ * @brief Serialize a value for another runtime in the same process
+ * 
+ * ArrayBuffers listed in transfer are detached in this isolate and handed
+ * over without copying.
+ * 
+ * @param context Current V8 context
+ * @param value Value to serialize
+ * @param transfer ArrayBuffers to transfer
+ * @param result Receives the serialized value
+ * @return true on success, false if an exception was thrown
+ */
+bool SerializeValue(v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                    const std::vector<v8::Local<v8::ArrayBuffer>>& transfer,
+                    SerializedValue* result);
+
+/**
+ * @brief Deserialize a value produced by SerializeValue
+ * 
+ * @param context Current V8 context
+ * @param value Serialized value (its transferred buffers are consumed)
+ * @return Deserialized value, or empty if an exception was thrown
+ */
+v8::MaybeLocal<v8::Value> DeserializeValue(v8::Local<v8::Context> context, SerializedValue* value);
+
+/**
+ * @brief Register the v8 module with the runtime
+ * 
+ * This function creates and registers the v8 module, which exposes V8's
+ * structured clone serializer, similar to Node.js's v8 module.
+ * 
+ * The v8 module exposes the following functionality to JavaScript:
+ * - v8.serialize(value, { transfer }): Serializes a value into a Uint8Array
+ * - v8.deserialize(bytes): Deserializes a value from a Uint8Array or ArrayBuffer
+ * - v8.releaseTransfers(bytes): Drops the transferred and shared buffers kept
+ *   for bytes returned by v8.serialize, before they are garbage collected
+ * - v8.createWriter(path): Opens a file for appending serialized records
+ *   (writer.write(value), writer.flush(), writer.close())
+ * - v8.createReader(path): Opens a record file for reading
+ *   (reader.read() returns the next value or undefined at the end, reader.close())
+ *   Files left open are closed when their wrapper is collected, or when the
+ *   runtime is destroyed, which also flushes a writer's buffered records
+ * 
+ * Serialization buffers come from a process-wide pool; v8.serialize copies
+ * the result into a buffer from the isolate's allocator, since ArrayBuffers
+ * cannot wrap memory outside the V8 sandbox. Transferred ArrayBuffers and
+ * SharedArrayBuffers are only supported for data that stays in this process.
+ * They are kept for as long as the Uint8Array v8.serialize returned is
+ * alive: transferred buffers go to the first deserialization, shared ones
+ * to every deserialization of those bytes.
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterV8Module(Runtime* runtime);
+
+#endif // TINY_NODEJS_V8_MODULE_H
@@ -0,0 +1,40 @@
+#ifndef TINY_NODEJS_VM_MODULE_H
+#define TINY_NODEJS_VM_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the vm module
+ * 
+ * This function creates and registers the internal/vm module, which
+ * lib/vm.js builds the Node.js-style vm API on (Script, createContext,
+ * runInContext). Scripts use require('vm') rather than this module.
+ * 
+ * A ContextifyScript is compiled once into a context-independent
+ * UnboundScript, so the same script can be bound to and run in any number
+ * of contexts without being compiled again. Its code cache can be
+ * produced after compiling and handed to a later compile of the same
+ * source, which then skips parsing and compiling.
+ * 
+ * Contexts made by makeContext() come from V8's startup snapshot with a
+ * global template whose interceptors send global variable reads and
+ * writes to the sandbox object, as in Node.js. A few blank contexts are
+ * kept ready and refilled by an event loop task after each one is handed
+ * out, so making a context usually only attaches the sandbox.
+ * 
+ * The internal/vm module exposes the following functionality:
+ * - ContextifyScript(code, filename, lineOffset, columnOffset, cachedData,
+ *   produceCachedData): Compiles code; sets cachedDataRejected when
+ *   cachedData was given, and cachedData when produceCachedData is true
+ * - ContextifyScript methods run(sandbox, timeout) (null for the calling context; a
+ *   positive timeout in ms terminates the script with ERR_SCRIPT_EXECUTION_TIMEOUT)
+ *   and createCachedData()
+ * - makeContext(sandbox): Makes sandbox a contextified object
+ * - isContext(object): Whether an object was contextified
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterVmModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_VM_MODULE_H
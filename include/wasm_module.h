@@ -0,0 +1,41 @@
+#ifndef TINY_NODEJS_WASM_MODULE_H
+#define TINY_NODEJS_WASM_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the wasm module
+ * 
+ * This function creates and registers the internal/wasm module, which
+ * lib/wasm.js builds on, and installs the isolate's WebAssembly streaming
+ * callback. Scripts use require('wasm') rather than this module.
+ * 
+ * WebAssembly.compileStreaming() and instantiateStreaming() accept a
+ * WasmSource, which names a .wasm file. The file is read on the thread pool
+ * in 64 KB chunks, and each chunk is handed to V8's streaming compiler on
+ * the event loop as it arrives, so decoding and compilation overlap the
+ * read. While a compilation is in flight the event loop keeps running and
+ * pumps V8's foreground tasks, which is where compile results are delivered.
+ * 
+ * Compiled modules are cached on disk, one file per .wasm path, holding the
+ * serialized module and the length and XXH3 hash of the wire bytes it was
+ * compiled from. A later compile of the same path passes the cached module
+ * to V8 before streaming, and lets V8 use it only if the wire bytes still
+ * match. Cache files are written when V8 reports that tier-up has produced
+ * enough optimized code, on flushCache(), and for anything still unwritten
+ * when the runtime shuts down.
+ * 
+ * The internal/wasm module exposes the following functionality:
+ * - WasmSource(path): A .wasm file to pass to WebAssembly.compileStreaming()
+ * - setCacheDirectory(dir): Sets where cache files go; null turns caching off
+ * - cacheDirectory(): The cache directory, or null
+ * - flushCache(): Writes every module that is not yet cached; returns a
+ *   promise of the number written
+ * - stats(): Compilations in flight and cache hit, miss and write counts
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterWasmModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_WASM_MODULE_H
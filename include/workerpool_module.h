@@ -0,0 +1,47 @@
+#ifndef TINY_NODEJS_WORKERPOOL_MODULE_H
+#define TINY_NODEJS_WORKERPOOL_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the workerpool module
+ * 
+ * This function creates and registers the internal/workerpool module, which
+ * lib/workerpool.js builds pools of worker runtimes on. Scripts use
+ * require('workerpool') rather than this module.
+ * 
+ * A pool starts a fixed number of threads, each with its own Runtime that
+ * is created and bootstrapped once and then reused for every task, so
+ * running a task costs no isolate startup. Every worker has its own task
+ * deque: submissions are spread over the deques round-robin, a worker takes
+ * from the front of its own deque and, when that is empty, steals from the
+ * back of the others'. Arguments and results cross between runtimes as
+ * structured clones (SerializeValue), with ArrayBuffers in a transfer list
+ * moved rather than copied.
+ * 
+ * A queued task can be cancelled; a running one is stopped with
+ * TerminateExecution and its worker carries on with the next task. Tasks
+ * with a timeout are cancelled the same way once it expires. Finished
+ * tasks are handed back through a libuv async handle, so one wakeup of the
+ * owning event loop delivers every result that is ready. The pool keeps
+ * the owning runtime alive only while tasks are outstanding.
+ * 
+ * The internal/workerpool module exposes the following functionality:
+ * - WorkerPool(size, affinity): Starts size worker runtimes, pinning worker
+ *   i to slot i of affinity ("0-3" or "node:0,1", see CpuAffinity), or of
+ *   RuntimeOptions::worker_affinity when affinity is undefined
+ * - WorkerPool methods submit(id, code, isPath, args, transfer, timeoutMs),
+ *   cancel(id), stats() and terminate()
+ * - setup(callbacks): Sets oncomplete(id, status, value), called with the
+ *   pool object as this for every submitted task
+ * - setupWorker(dispatch): Used by a worker runtime's bootstrap to receive
+ *   tasks as dispatch(id, code, isPath, args, done)
+ * - defaultSize: Number of CPUs, the default pool size
+ * - constants: TASK_OK, TASK_ERROR, TASK_CANCELLED and TASK_TIMED_OUT
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterWorkerPoolModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_WORKERPOOL_MODULE_H
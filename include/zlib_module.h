@@ -0,0 +1,40 @@
+#ifndef TINY_NODEJS_ZLIB_MODULE_H
+#define TINY_NODEJS_ZLIB_MODULE_H
+
+// Forward declaration
+class Runtime;
+
+/**
+ * @brief Register the native part of the zlib module
+ * 
+ * This function creates and registers the internal/zlib module, which
+ * lib/zlib.js builds the Node.js-style zlib API on (deflateSync, gzip,
+ * createGunzip and so on). Scripts use require('zlib') rather than this
+ * module.
+ * 
+ * Compression runs on the system zlib. One-shot calls borrow a z_stream
+ * from a process-wide pool and reset it afterwards instead of paying for
+ * deflateInit/inflateInit (and their window allocations) every time.
+ * Output is grown in place and handed to V8 as the backing store of the
+ * result, so it is never copied.
+ * 
+ * The internal/zlib module exposes the following functionality:
+ * - constants: Flush values, levels, strategies, limits and modes
+ * - processSync(data, mode, level, windowBits, memLevel, strategy):
+ *   Compresses or decompresses a whole ArrayBufferView into a Uint8Array
+ * - process(data, mode, level, windowBits, memLevel, strategy): Same as
+ *   processSync, but runs on the thread pool and returns a Promise
+ * - createContext(mode, level, windowBits, memLevel, strategy): Creates a
+ *   streaming context with write(chunk, flush), writeAsync(chunk, flush),
+ *   reset() and close() methods
+ * - crc32(data, value): Extends a CRC-32 over a string or ArrayBufferView
+ * 
+ * Modes are the Node.js ones: 1 deflate, 2 inflate, 3 gzip, 4 gunzip,
+ * 5 deflateRaw, 6 inflateRaw and 7 unzip (gzip or zlib, detected from the
+ * header).
+ * 
+ * @param runtime Pointer to the Runtime instance
+ */
+void RegisterZlibModule(Runtime* runtime);
+
+#endif // TINY_NODEJS_ZLIB_MODULE_H
@@ -0,0 +1,739 @@
+// Buffer module
+//
+// Node.js-compatible Buffer built on Uint8Array. Encoding, comparison and
+// search run natively (internal/buffer); small allocations are carved out
+// of a shared 8 KB slab like in Node.js. Built into the runtime binary,
+// served by require('buffer') and exposed as the global Buffer.
+
+const binding = require('internal/buffer');
+
+const encodings = binding.encodings;
+const kMaxLength = 2 ** 32;
+const kStringMaxLength = 2 ** 29 - 24;
+const kUtf8 = encodings.utf8;
+
+class FastBuffer extends Uint8Array {
+    constructor(bufferOrLength, byteOffset, length) {
+        super(bufferOrLength, byteOffset, length);
+    }
+}
+
+// Legacy constructor; new code should use Buffer.from and Buffer.alloc
+function Buffer(arg, encodingOrOffset, length) {
+    if (typeof arg === 'number') {
+        return Buffer.alloc(arg);
+    }
+    return Buffer.from(arg, encodingOrOffset, length);
+}
+
+Buffer.prototype = FastBuffer.prototype;
+FastBuffer.prototype.constructor = Buffer;
+Object.setPrototypeOf(Buffer, Uint8Array);
+
+Buffer.poolSize = 8 * 1024;
+
+let allocPool;
+let poolOffset;
+
+function createPool() {
+    allocPool = new ArrayBuffer(Buffer.poolSize);
+    poolOffset = 0;
+}
+createPool();
+
+// Allocate from the shared slab when small enough, keeping 8-byte alignment
+function allocate(size) {
+    if (size <= 0) {
+        return new FastBuffer();
+    }
+    if (size < (Buffer.poolSize >>> 1)) {
+        if (size > allocPool.byteLength - poolOffset) {
+            createPool();
+        }
+        const buffer = new FastBuffer(allocPool, poolOffset, size);
+        poolOffset = (poolOffset + size + 7) & ~7;
+        return buffer;
+    }
+    return new FastBuffer(size);
+}
+
+function validateSize(size) {
+    if (typeof size !== 'number' || !(size >= 0 && size <= kMaxLength)) {
+        throw new RangeError('The argument "size" is invalid. Received ' + size);
+    }
+}
+
+function normalizeEncoding(encoding) {
+    if (encoding === undefined || encoding === null || encoding === 'utf8' || encoding === 'utf-8') {
+        return kUtf8;
+    }
+    let code = encodings[encoding];
+    if (code === undefined) {
+        code = encodings[String(encoding).toLowerCase()];
+    }
+    if (code === undefined) {
+        throw new TypeError('Unknown encoding: ' + encoding);
+    }
+    return code;
+}
+
+// Clamp a start or end argument like TypedArray.prototype.subarray
+function adjustOffset(offset, length) {
+    offset = Math.trunc(offset);
+    if (offset === 0 || Number.isNaN(offset)) {
+        return 0;
+    }
+    if (offset < 0) {
+        offset += length;
+        return offset > 0 ? offset : 0;
+    }
+    return offset < length ? offset : length;
+}
+
+function fromString(string, encoding) {
+    const code = normalizeEncoding(encoding);
+    const length = binding.byteLength(string, code);
+    const buffer = allocate(length);
+    const actual = binding.write(buffer, string, 0, length, code);
+    if (actual !== length) {
+        // Base64 lengths are estimates; trim to what was decoded
+        return new FastBuffer(buffer.buffer, buffer.byteOffset, actual);
+    }
+    return buffer;
+}
+
+function fromArrayLike(object) {
+    const length = object.length >>> 0;
+    const buffer = allocate(length);
+    if (length > 0) {
+        buffer.set(object.length === length ? object : Array.prototype.slice.call(object, 0, length));
+    }
+    return buffer;
+}
+
+Buffer.from = function from(value, encodingOrOffset, length) {
+    if (typeof value === 'string') {
+        return fromString(value, encodingOrOffset);
+    }
+    if (typeof value === 'object' && value !== null) {
+        if (value instanceof ArrayBuffer ||
+            (typeof SharedArrayBuffer !== 'undefined' && value instanceof SharedArrayBuffer)) {
+            const byteOffset = encodingOrOffset === undefined ? 0 : +encodingOrOffset || 0;
+            const maxLength = value.byteLength - byteOffset;
+            if (maxLength < 0) {
+                throw new RangeError('"offset" is outside of buffer bounds');
+            }
+            const viewLength = length === undefined ? maxLength : +length || 0;
+            if (viewLength > maxLength) {
+                throw new RangeError('"length" is outside of buffer bounds');
+            }
+            return new FastBuffer(value, byteOffset, viewLength);
+        }
+        if (value instanceof Uint8Array) {
+            const buffer = allocate(value.length);
+            buffer.set(value);
+            return buffer;
+        }
+        if (ArrayBuffer.isView(value) || Array.isArray(value) || typeof value.length === 'number') {
+            return fromArrayLike(value);
+        }
+        if (value.type === 'Buffer' && Array.isArray(value.data)) {
+            return fromArrayLike(value.data);
+        }
+        const primitive = typeof value[Symbol.toPrimitive] === 'function'
+            ? value[Symbol.toPrimitive]('string')
+            : value.valueOf();
+        if (primitive !== value && primitive !== null && primitive !== undefined) {
+            return Buffer.from(primitive, encodingOrOffset, length);
+        }
+    }
+    throw new TypeError('The first argument must be of type string, Buffer, ArrayBuffer, Array, ' +
+                        'or Array-like Object. Received ' + (value === null ? 'null' : typeof value));
+};
+
+Buffer.of = function of(...items) {
+    return fromArrayLike(items);
+};
+
+Buffer.alloc = function alloc(size, fill, encoding) {
+    validateSize(size);
+    const buffer = new FastBuffer(size);
+    if (fill !== undefined && fill !== 0 && size > 0) {
+        buffer.fill(fill, encoding);
+    }
+    return buffer;
+};
+
+Buffer.allocUnsafe = function allocUnsafe(size) {
+    validateSize(size);
+    return allocate(size);
+};
+
+Buffer.allocUnsafeSlow = function allocUnsafeSlow(size) {
+    validateSize(size);
+    return new FastBuffer(size);
+};
+
+Buffer.isBuffer = function isBuffer(value) {
+    return value instanceof Buffer;
+};
+
+Buffer.isEncoding = function isEncoding(encoding) {
+    return typeof encoding === 'string' && encoding.length !== 0 &&
+        (encodings[encoding] !== undefined || encodings[encoding.toLowerCase()] !== undefined);
+};
+
+Buffer.byteLength = function byteLength(value, encoding) {
+    if (typeof value !== 'string') {
+        if (ArrayBuffer.isView(value) || value instanceof ArrayBuffer ||
+            (typeof SharedArrayBuffer !== 'undefined' && value instanceof SharedArrayBuffer)) {
+            return value.byteLength;
+        }
+        throw new TypeError('The "string" argument must be of type string, Buffer, or ArrayBuffer');
+    }
+    return binding.byteLength(value, normalizeEncoding(encoding));
+};
+
+Buffer.compare = function compare(a, b) {
+    if (!(a instanceof Uint8Array) || !(b instanceof Uint8Array)) {
+        throw new TypeError('The "buf1" and "buf2" arguments must be Buffer or Uint8Array');
+    }
+    return binding.compare(a, 0, a.length, b, 0, b.length);
+};
+
+Buffer.concat = function concat(list, totalLength) {
+    if (!Array.isArray(list)) {
+        throw new TypeError('The "list" argument must be an Array of Buffers or Uint8Arrays');
+    }
+    if (list.length === 0) {
+        return new FastBuffer();
+    }
+    if (totalLength === undefined) {
+        totalLength = 0;
+        for (let i = 0; i < list.length; i++) {
+            if (!(list[i] instanceof Uint8Array)) {
+                throw new TypeError('The "list[' + i + ']" argument must be a Buffer or Uint8Array');
+            }
+            totalLength += list[i].length;
+        }
+    } else {
+        totalLength = totalLength >>> 0;
+    }
+
+    const buffer = allocate(totalLength);
+    let position = 0;
+    for (let i = 0; i < list.length && position < totalLength; i++) {
+        const item = list[i];
+        if (!(item instanceof Uint8Array)) {
+            throw new TypeError('The "list[' + i + ']" argument must be a Buffer or Uint8Array');
+        }
+        if (position + item.length > totalLength) {
+            buffer.set(item.subarray(0, totalLength - position), position);
+            position = totalLength;
+        } else {
+            buffer.set(item, position);
+            position += item.length;
+        }
+    }
+    if (position < totalLength) {
+        buffer.fill(0, position, totalLength);
+    }
+    return buffer;
+};
+
+const proto = Buffer.prototype;
+
+proto.toString = function toString(encoding, start, end) {
+    if (arguments.length === 0) {
+        return binding.toString(this, 0, this.length, kUtf8);
+    }
+    const length = this.length;
+    start = start === undefined || start <= 0 ? 0 : Math.min(Math.trunc(start) || 0, length);
+    end = end === undefined || end > length ? length : Math.trunc(end) || 0;
+    if (end <= start) {
+        return '';
+    }
+    return binding.toString(this, start, end, normalizeEncoding(encoding));
+};
+
+proto.toLocaleString = proto.toString;
+
+proto.write = function write(string, offset, length, encoding) {
+    if (typeof string !== 'string') {
+        throw new TypeError('The "string" argument must be of type string');
+    }
+    if (offset === undefined) {
+        return binding.write(this, string, 0, this.length, kUtf8);
+    }
+    if (length === undefined && typeof offset === 'string') {
+        return binding.write(this, string, 0, this.length, normalizeEncoding(offset));
+    }
+    offset = offset >>> 0;
+    if (offset > this.length) {
+        throw new RangeError('The value of "offset" is out of range');
+    }
+    const remaining = this.length - offset;
+    if (length === undefined) {
+        length = remaining;
+    } else if (typeof length === 'string') {
+        encoding = length;
+        length = remaining;
+    } else {
+        length = Math.min(length >>> 0, remaining);
+    }
+    return binding.write(this, string, offset, length, normalizeEncoding(encoding));
+};
+
+proto.toJSON = function toJSON() {
+    return { type: 'Buffer', data: Array.from(this) };
+};
+
+proto.equals = function equals(other) {
+    if (!(other instanceof Uint8Array)) {
+        throw new TypeError('The "otherBuffer" argument must be a Buffer or Uint8Array');
+    }
+    if (this === other) {
+        return true;
+    }
+    if (this.length !== other.length) {
+        return false;
+    }
+    return binding.compare(this, 0, this.length, other, 0, other.length) === 0;
+};
+
+proto.compare = function compare(target, targetStart, targetEnd, sourceStart, sourceEnd) {
+    if (!(target instanceof Uint8Array)) {
+        throw new TypeError('The "target" argument must be a Buffer or Uint8Array');
+    }
+    targetStart = targetStart === undefined ? 0 : targetStart >>> 0;
+    targetEnd = targetEnd === undefined ? target.length : targetEnd >>> 0;
+    sourceStart = sourceStart === undefined ? 0 : sourceStart >>> 0;
+    sourceEnd = sourceEnd === undefined ? this.length : sourceEnd >>> 0;
+    if (targetEnd > target.length || sourceEnd > this.length) {
+        throw new RangeError('The value of "targetEnd" or "sourceEnd" is out of range');
+    }
+    if (sourceStart >= sourceEnd) {
+        return targetStart >= targetEnd ? 0 : -1;
+    }
+    if (targetStart >= targetEnd) {
+        return 1;
+    }
+    return binding.compare(this, sourceStart, sourceEnd, target, targetStart, targetEnd);
+};
+
+function bidirectionalIndexOf(buffer, value, byteOffset, encoding, forward) {
+    if (typeof byteOffset === 'string') {
+        encoding = byteOffset;
+        byteOffset = undefined;
+    }
+    byteOffset = +byteOffset;
+    if (Number.isNaN(byteOffset)) {
+        byteOffset = forward ? 0 : buffer.length;
+    }
+
+    if (typeof value === 'number') {
+        return binding.indexOfByte(buffer, value >>> 0, byteOffset, forward);
+    }
+    if (typeof value === 'string') {
+        value = fromString(value, encoding);
+    } else if (!(value instanceof Uint8Array)) {
+        throw new TypeError('The "value" argument must be one of type number or string ' +
+                            'or an instance of Buffer or Uint8Array');
+    }
+    return binding.indexOf(buffer, value, byteOffset, forward);
+}
+
+proto.indexOf = function indexOf(value, byteOffset, encoding) {
+    return bidirectionalIndexOf(this, value, byteOffset, encoding, true);
+};
+
+proto.lastIndexOf = function lastIndexOf(value, byteOffset, encoding) {
+    return bidirectionalIndexOf(this, value, byteOffset, encoding, false);
+};
+
+proto.includes = function includes(value, byteOffset, encoding) {
+    return this.indexOf(value, byteOffset, encoding) !== -1;
+};
+
+proto.fill = function fill(value, offset, end, encoding) {
+    if (typeof offset === 'string') {
+        encoding = offset;
+        offset = 0;
+        end = this.length;
+    } else if (typeof end === 'string') {
+        encoding = end;
+        end = this.length;
+    }
+    offset = offset === undefined ? 0 : offset >>> 0;
+    end = end === undefined ? this.length : end >>> 0;
+    if (offset > this.length || end > this.length) {
+        throw new RangeError('The value of "offset" or "end" is out of range');
+    }
+    if (end <= offset) {
+        return this;
+    }
+
+    if (typeof value === 'number' || typeof value === 'boolean') {
+        Uint8Array.prototype.fill.call(this, value & 255, offset, end);
+        return this;
+    }
+    if (typeof value === 'string') {
+        const code = normalizeEncoding(encoding);
+        if (value.length === 0) {
+            Uint8Array.prototype.fill.call(this, 0, offset, end);
+            return this;
+        }
+        if (value.length === 1 && code === kUtf8 && value.charCodeAt(0) < 128) {
+            Uint8Array.prototype.fill.call(this, value.charCodeAt(0), offset, end);
+            return this;
+        }
+        value = fromString(value, encoding);
+        if (value.length === 0) {
+            throw new TypeError('The argument "value" is invalid for encoding ' + encoding);
+        }
+    } else if (!(value instanceof Uint8Array)) {
+        throw new TypeError('The "value" argument must be of type number, string, Buffer or Uint8Array');
+    }
+    if (value.length === 0) {
+        Uint8Array.prototype.fill.call(this, 0, offset, end);
+        return this;
+    }
+    binding.fill(this, value, offset, end);
+    return this;
+};
+
+proto.subarray = function subarray(start, end) {
+    const length = this.length;
+    start = adjustOffset(start, length);
+    end = end === undefined ? length : adjustOffset(end, length);
+    return new FastBuffer(this.buffer, this.byteOffset + start, end > start ? end - start : 0);
+};
+
+// Like Node.js, slice returns a view rather than a copy
+proto.slice = proto.subarray;
+
+proto.copy = function copy(target, targetStart, sourceStart, sourceEnd) {
+    if (!(target instanceof Uint8Array)) {
+        throw new TypeError('The "target" argument must be a Buffer or Uint8Array');
+    }
+    targetStart = targetStart === undefined ? 0 : Math.max(0, Math.trunc(targetStart) || 0);
+    sourceStart = sourceStart === undefined ? 0 : Math.max(0, Math.trunc(sourceStart) || 0);
+    sourceEnd = sourceEnd === undefined ? this.length : Math.min(this.length, Math.trunc(sourceEnd) || 0);
+    if (targetStart >= target.length || sourceStart >= sourceEnd) {
+        return 0;
+    }
+    const count = Math.min(sourceEnd - sourceStart, target.length - targetStart);
+    target.set(new Uint8Array(this.buffer, this.byteOffset + sourceStart, count), targetStart);
+    return count;
+};
+
+function swap(buffer, size) {
+    if (buffer.length % size !== 0) {
+        throw new RangeError('Buffer size must be a multiple of ' + (size * 8) + '-bits');
+    }
+    for (let i = 0; i < buffer.length; i += size) {
+        for (let low = i, high = i + size - 1; low < high; low++, high--) {
+            const byte = buffer[low];
+            buffer[low] = buffer[high];
+            buffer[high] = byte;
+        }
+    }
+    return buffer;
+}
+
+proto.swap16 = function swap16() {
+    return swap(this, 2);
+};
+
+proto.swap32 = function swap32() {
+    return swap(this, 4);
+};
+
+proto.swap64 = function swap64() {
+    return swap(this, 8);
+};
+
+// Fixed-width reads and writes. Integers are assembled byte by byte; floats
+// go through scratch typed arrays sharing one ArrayBuffer.
+
+function checkBounds(buffer, offset, byteLength) {
+    if (offset === undefined) {
+        offset = 0;
+    }
+    if (typeof offset !== 'number' || offset !== Math.floor(offset) ||
+        offset < 0 || offset + byteLength > buffer.length) {
+        throw new RangeError('The value of "offset" is out of range. It must be >= 0 and <= ' +
+                             (buffer.length - byteLength) + '. Received ' + offset);
+    }
+    return offset;
+}
+
+function checkValue(value, min, max) {
+    if (typeof value !== 'number' || value < min || value > max) {
+        throw new RangeError('The value of "value" is out of range. It must be >= ' + min +
+                             ' and <= ' + max + '. Received ' + value);
+    }
+}
+
+const float32Array = new Float32Array(1);
+const float64Array = new Float64Array(1);
+const float32Bytes = new Uint8Array(float32Array.buffer);
+const float64Bytes = new Uint8Array(float64Array.buffer);
+const bigEndian = new Uint8Array(new Uint16Array([1]).buffer)[0] === 0;
+
+function readBytes(buffer, offset, scratch, littleEndian) {
+    const size = scratch.length;
+    if (littleEndian !== bigEndian) {
+        for (let i = 0; i < size; i++) {
+            scratch[i] = buffer[offset + i];
+        }
+    } else {
+        for (let i = 0; i < size; i++) {
+            scratch[size - 1 - i] = buffer[offset + i];
+        }
+    }
+}
+
+function writeBytes(buffer, offset, scratch, littleEndian) {
+    const size = scratch.length;
+    if (littleEndian !== bigEndian) {
+        for (let i = 0; i < size; i++) {
+            buffer[offset + i] = scratch[i];
+        }
+    } else {
+        for (let i = 0; i < size; i++) {
+            buffer[offset + i] = scratch[size - 1 - i];
+        }
+    }
+    return offset + size;
+}
+
+proto.readUInt8 = function readUInt8(offset) {
+    offset = checkBounds(this, offset, 1);
+    return this[offset];
+};
+
+proto.readInt8 = function readInt8(offset) {
+    offset = checkBounds(this, offset, 1);
+    const value = this[offset];
+    return value | (value & 0x80) * 0x1fffffe;
+};
+
+proto.readUInt16LE = function readUInt16LE(offset) {
+    offset = checkBounds(this, offset, 2);
+    return this[offset] | (this[offset + 1] << 8);
+};
+
+proto.readUInt16BE = function readUInt16BE(offset) {
+    offset = checkBounds(this, offset, 2);
+    return (this[offset] << 8) | this[offset + 1];
+};
+
+proto.readInt16LE = function readInt16LE(offset) {
+    const value = this.readUInt16LE(offset);
+    return value | (value & 0x8000) * 0x1fffe;
+};
+
+proto.readInt16BE = function readInt16BE(offset) {
+    const value = this.readUInt16BE(offset);
+    return value | (value & 0x8000) * 0x1fffe;
+};
+
+proto.readInt32LE = function readInt32LE(offset) {
+    offset = checkBounds(this, offset, 4);
+    return this[offset] | (this[offset + 1] << 8) | (this[offset + 2] << 16) | (this[offset + 3] << 24);
+};
+
+proto.readInt32BE = function readInt32BE(offset) {
+    offset = checkBounds(this, offset, 4);
+    return (this[offset] << 24) | (this[offset + 1] << 16) | (this[offset + 2] << 8) | this[offset + 3];
+};
+
+proto.readUInt32LE = function readUInt32LE(offset) {
+    return this.readInt32LE(offset) >>> 0;
+};
+
+proto.readUInt32BE = function readUInt32BE(offset) {
+    return this.readInt32BE(offset) >>> 0;
+};
+
+proto.readBigUInt64LE = function readBigUInt64LE(offset) {
+    const low = this.readUInt32LE(offset);
+    const high = this.readUInt32LE((offset || 0) + 4);
+    return (BigInt(high) << 32n) | BigInt(low);
+};
+
+proto.readBigUInt64BE = function readBigUInt64BE(offset) {
+    const high = this.readUInt32BE(offset);
+    const low = this.readUInt32BE((offset || 0) + 4);
+    return (BigInt(high) << 32n) | BigInt(low);
+};
+
+proto.readBigInt64LE = function readBigInt64LE(offset) {
+    return BigInt.asIntN(64, this.readBigUInt64LE(offset));
+};
+
+proto.readBigInt64BE = function readBigInt64BE(offset) {
+    return BigInt.asIntN(64, this.readBigUInt64BE(offset));
+};
+
+proto.readFloatLE = function readFloatLE(offset) {
+    readBytes(this, checkBounds(this, offset, 4), float32Bytes, true);
+    return float32Array[0];
+};
+
+proto.readFloatBE = function readFloatBE(offset) {
+    readBytes(this, checkBounds(this, offset, 4), float32Bytes, false);
+    return float32Array[0];
+};
+
+proto.readDoubleLE = function readDoubleLE(offset) {
+    readBytes(this, checkBounds(this, offset, 8), float64Bytes, true);
+    return float64Array[0];
+};
+
+proto.readDoubleBE = function readDoubleBE(offset) {
+    readBytes(this, checkBounds(this, offset, 8), float64Bytes, false);
+    return float64Array[0];
+};
+
+proto.writeUInt8 = function writeUInt8(value, offset) {
+    checkValue(value, 0, 0xff);
+    offset = checkBounds(this, offset, 1);
+    this[offset] = value;
+    return offset + 1;
+};
+
+proto.writeInt8 = function writeInt8(value, offset) {
+    checkValue(value, -0x80, 0x7f);
+    offset = checkBounds(this, offset, 1);
+    this[offset] = value;
+    return offset + 1;
+};
+
+function writeU16(buffer, value, offset, littleEndian) {
+    offset = checkBounds(buffer, offset, 2);
+    buffer[offset + (littleEndian ? 0 : 1)] = value;
+    buffer[offset + (littleEndian ? 1 : 0)] = value >>> 8;
+    return offset + 2;
+}
+
+function writeU32(buffer, value, offset, littleEndian) {
+    offset = checkBounds(buffer, offset, 4);
+    for (let i = 0; i < 4; i++) {
+        buffer[offset + (littleEndian ? i : 3 - i)] = value >>> (8 * i);
+    }
+    return offset + 4;
+}
+
+proto.writeUInt16LE = function writeUInt16LE(value, offset) {
+    checkValue(value, 0, 0xffff);
+    return writeU16(this, value, offset, true);
+};
+
+proto.writeUInt16BE = function writeUInt16BE(value, offset) {
+    checkValue(value, 0, 0xffff);
+    return writeU16(this, value, offset, false);
+};
+
+proto.writeInt16LE = function writeInt16LE(value, offset) {
+    checkValue(value, -0x8000, 0x7fff);
+    return writeU16(this, value, offset, true);
+};
+
+proto.writeInt16BE = function writeInt16BE(value, offset) {
+    checkValue(value, -0x8000, 0x7fff);
+    return writeU16(this, value, offset, false);
+};
+
+proto.writeUInt32LE = function writeUInt32LE(value, offset) {
+    checkValue(value, 0, 0xffffffff);
+    return writeU32(this, value, offset, true);
+};
+
+proto.writeUInt32BE = function writeUInt32BE(value, offset) {
+    checkValue(value, 0, 0xffffffff);
+    return writeU32(this, value, offset, false);
+};
+
+proto.writeInt32LE = function writeInt32LE(value, offset) {
+    checkValue(value, -0x80000000, 0x7fffffff);
+    return writeU32(this, value, offset, true);
+};
+
+proto.writeInt32BE = function writeInt32BE(value, offset) {
+    checkValue(value, -0x80000000, 0x7fffffff);
+    return writeU32(this, value, offset, false);
+};
+
+function writeBig64(buffer, value, offset, littleEndian, signed) {
+    if (typeof value !== 'bigint') {
+        throw new TypeError('The "value" argument must be of type bigint');
+    }
+    const min = signed ? -(2n ** 63n) : 0n;
+    const max = signed ? 2n ** 63n - 1n : 2n ** 64n - 1n;
+    if (value < min || value > max) {
+        throw new RangeError('The value of "value" is out of range. Received ' + value + 'n');
+    }
+    const unsigned = BigInt.asUintN(64, value);
+    const low = Number(unsigned & 0xffffffffn);
+    const high = Number(unsigned >> 32n);
+    offset = checkBounds(buffer, offset, 8);
+    writeU32(buffer, littleEndian ? low : high, offset, littleEndian);
+    writeU32(buffer, littleEndian ? high : low, offset + 4, littleEndian);
+    return offset + 8;
+}
+
+proto.writeBigUInt64LE = function writeBigUInt64LE(value, offset) {
+    return writeBig64(this, value, offset, true, false);
+};
+
+proto.writeBigUInt64BE = function writeBigUInt64BE(value, offset) {
+    return writeBig64(this, value, offset, false, false);
+};
+
+proto.writeBigInt64LE = function writeBigInt64LE(value, offset) {
+    return writeBig64(this, value, offset, true, true);
+};
+
+proto.writeBigInt64BE = function writeBigInt64BE(value, offset) {
+    return writeBig64(this, value, offset, false, true);
+};
+
+proto.writeFloatLE = function writeFloatLE(value, offset) {
+    float32Array[0] = value;
+    return writeBytes(this, checkBounds(this, offset, 4), float32Bytes, true);
+};
+
+proto.writeFloatBE = function writeFloatBE(value, offset) {
+    float32Array[0] = value;
+    return writeBytes(this, checkBounds(this, offset, 4), float32Bytes, false);
+};
+
+proto.writeDoubleLE = function writeDoubleLE(value, offset) {
+    float64Array[0] = value;
+    return writeBytes(this, checkBounds(this, offset, 8), float64Bytes, true);
+};
+
+proto.writeDoubleBE = function writeDoubleBE(value, offset) {
+    float64Array[0] = value;
+    return writeBytes(this, checkBounds(this, offset, 8), float64Bytes, false);
+};
+
+// Lowercase "Uint" aliases, as in Node.js
+for (const name of Object.getOwnPropertyNames(proto)) {
+    if (/^(read|write)(Big)?UInt/.test(name)) {
+        proto[name.replace('UInt', 'Uint')] = proto[name];
+    }
+}
+
+module.exports = {
+    Buffer,
+    SlowBuffer: Buffer.allocUnsafeSlow,
+    kMaxLength,
+    kStringMaxLength,
+    constants: { MAX_LENGTH: kMaxLength, MAX_STRING_LENGTH: kStringMaxLength },
+    INSPECT_MAX_BYTES: 50,
+    isUtf8: binding.isUtf8,
+    isAscii: binding.isAscii,
+};
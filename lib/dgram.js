@@ -0,0 +1,430 @@
+// Dgram module
+//
+// Node.js-compatible UDP sockets on libuv handles from internal/udp.
+// Datagrams received in one loop iteration reach JavaScript in a single
+// call, as Buffers over a shared slab, and the sends made in one tick go
+// to the kernel together (sendmmsg, with GSO on Linux). Built into the
+// runtime binary and served by require('dgram').
+
+const binding = require('internal/udp');
+const net = require('internal/net');
+const EventEmitter = require('events');
+const { Buffer } = require('buffer');
+
+const { UV_UDP_IPV6ONLY, UV_UDP_REUSEADDR } = binding.constants;
+
+function nextTick(fn) {
+    setTimeout(fn, 0);
+}
+
+// Create an Error for a failed libuv call, with errno and code like Node.js
+function errnoException(err, syscall, address, port) {
+    const code = net.errname(err);
+    let message = syscall + ' ' + code;
+    if (address !== undefined) {
+        message += ' ' + address + (port !== undefined ? ':' + port : '');
+    }
+    const error = new Error(message);
+    error.errno = err;
+    error.code = code;
+    error.syscall = syscall;
+    if (address !== undefined) {
+        error.address = address;
+    }
+    if (port !== undefined) {
+        error.port = port;
+    }
+    return error;
+}
+
+function notRunning() {
+    const error = new Error('Not running');
+    error.code = 'ERR_SOCKET_DGRAM_NOT_RUNNING';
+    return error;
+}
+
+// The datagrams one socket received in a loop iteration, for 'messages' listeners
+function MessageBatch(count, slab, layout, addresses, family) {
+    this.count = count;
+    this._slab = slab;
+    this._layout = layout;
+    this._addresses = addresses;
+    this._family = family;
+}
+
+MessageBatch.prototype.message = function(i) {
+    return Buffer.from(this._slab, this._layout[i * 3], this._layout[i * 3 + 1]);
+};
+
+MessageBatch.prototype.rinfo = function(i) {
+    return {
+        address: this._addresses[i],
+        family: this._family,
+        port: this._layout[i * 3 + 2],
+        size: this._layout[i * 3 + 1],
+    };
+};
+
+MessageBatch.prototype.forEach = function(fn) {
+    for (let i = 0; i < this.count; i++) {
+        fn(this.message(i), this.rinfo(i), i);
+    }
+};
+
+// Callbacks from the native handles; this is the handle and this.owner its socket
+
+function onmessage(count, slab, layout, addresses) {
+    const socket = this.owner;
+    if (count < 0) {
+        socket.emit('error', errnoException(count, 'recvmsg'));
+        return;
+    }
+    const family = socket.type === 'udp6' ? 'IPv6' : 'IPv4';
+    if (socket.listenerCount('messages') > 0) {
+        socket.emit('messages', new MessageBatch(count, slab, layout, addresses, family));
+    }
+    if (socket.listenerCount('message') === 0) {
+        return;
+    }
+    for (let i = 0; i < count && socket._handle; i++) {
+        const offset = layout[i * 3];
+        const size = layout[i * 3 + 1];
+        socket.emit('message', Buffer.from(slab, offset, size),
+            { address: addresses[i], family, port: layout[i * 3 + 2], size });
+    }
+}
+
+function onsend(status) {
+    const socket = this.owner;
+    const callbacks = socket._sendBatches.shift();
+    if (callbacks) {
+        socket._completeSends(callbacks, status < 0 ? errnoException(status, 'send') : null);
+    }
+}
+
+function onclose() {
+    const socket = this.owner;
+    for (const callbacks of socket._sendBatches) {
+        socket._completeSends(callbacks, notRunning());
+    }
+    socket._sendBatches = [];
+    socket.emit('close');
+}
+
+binding.setup({ onmessage, onsend, onclose });
+
+// Socket
+
+function Socket(type, listener) {
+    if (!(this instanceof Socket)) {
+        return new Socket(type, listener);
+    }
+    EventEmitter.call(this);
+    const options = typeof type === 'object' && type !== null ? type : { type };
+    if (options.type !== 'udp4' && options.type !== 'udp6') {
+        const error = new TypeError('Bad socket type specified. Valid types are: udp4, udp6');
+        error.code = 'ERR_SOCKET_BAD_TYPE';
+        throw error;
+    }
+    this.type = options.type;
+    this._reuseAddr = !!options.reuseAddr;
+    this._ipv6Only = !!options.ipv6Only;
+    this._recvBufferSize = options.recvBufferSize;
+    this._sendBufferSize = options.sendBufferSize;
+    this._handle = new binding.UDP();
+    this._handle.owner = this;
+    this._bound = false;
+
+    // Sends made in the current tick, as (data, port, address) triples
+    this._sendQueue = [];
+    this._sendCallbacks = [];
+    this._sendScheduled = false;
+    this._sendBatches = [];
+
+    if (listener) {
+        this.on('message', listener);
+    }
+}
+Object.setPrototypeOf(Socket.prototype, EventEmitter.prototype);
+Object.setPrototypeOf(Socket, EventEmitter);
+
+Socket.prototype._anyAddress = function() {
+    return this.type === 'udp6' ? '::' : '0.0.0.0';
+};
+
+Socket.prototype._resolve = function(address) {
+    if (address === undefined || address === null || address === 'localhost') {
+        return this.type === 'udp6' ? '::1' : '127.0.0.1';
+    }
+    return address;
+};
+
+Socket.prototype._healthCheck = function() {
+    if (!this._handle) {
+        throw notRunning();
+    }
+};
+
+// bind([port][, address][, callback]) or bind(options[, callback])
+Socket.prototype.bind = function(...args) {
+    this._healthCheck();
+    const callback = typeof args[args.length - 1] === 'function' ? args.pop() : undefined;
+    let options = args[0];
+    if (typeof options !== 'object' || options === null) {
+        options = { port: args[0], address: args[1] };
+    }
+    if (this._bound) {
+        const error = new Error('Socket is already bound');
+        error.code = 'ERR_SOCKET_ALREADY_BOUND';
+        throw error;
+    }
+
+    const port = options.port === undefined || options.port === null ? 0 : Number(options.port);
+    if (!Number.isInteger(port) || port < 0 || port > 65535) {
+        throw new RangeError('Port should be >= 0 and < 65536. Received ' + options.port + '.');
+    }
+    let address = options.address;
+    if (address === undefined || address === null || address === '') {
+        address = this._anyAddress();
+    } else {
+        address = this._resolve(address);
+    }
+    if (!net.isIP(address)) {
+        nextTick(() => this.emit('error', errnoException(binding.constants.UV_EINVAL, 'bind', address, port)));
+        return this;
+    }
+
+    let flags = 0;
+    if (this._reuseAddr) {
+        flags |= UV_UDP_REUSEADDR;
+    }
+    if (this._ipv6Only) {
+        flags |= UV_UDP_IPV6ONLY;
+    }
+    const err = this._handle.bind(address, port, flags);
+    if (err !== 0) {
+        nextTick(() => this.emit('error', errnoException(err, 'bind', address, port)));
+        return this;
+    }
+    this._bound = true;
+    if (this._recvBufferSize) {
+        this.setRecvBufferSize(this._recvBufferSize);
+    }
+    if (this._sendBufferSize) {
+        this.setSendBufferSize(this._sendBufferSize);
+    }
+    this._handle.recvStart();
+
+    if (callback) {
+        this.once('listening', callback);
+    }
+    nextTick(() => this.emit('listening'));
+    return this;
+};
+
+// send(msg[, offset, length][, port][, address][, callback])
+Socket.prototype.send = function(msg, ...args) {
+    this._healthCheck();
+    const callback = typeof args[args.length - 1] === 'function' ? args.pop() : undefined;
+    let offset;
+    let length;
+    if (args.length >= 3 || (args.length === 2 && typeof args[1] === 'number')) {
+        offset = args.shift();
+        length = args.shift();
+    }
+    const port = Number(args[0]);
+    const address = this._resolve(args[1]);
+    if (!Number.isInteger(port) || port <= 0 || port > 65535) {
+        throw new RangeError('Port should be > 0 and < 65536. Received ' + args[0] + '.');
+    }
+
+    let data;
+    if (typeof msg === 'string') {
+        data = Buffer.from(msg);
+    } else if (Array.isArray(msg)) {
+        data = Buffer.concat(msg.map((part) => (typeof part === 'string' ? Buffer.from(part) : part)));
+    } else if (ArrayBuffer.isView(msg)) {
+        data = msg;
+    } else {
+        throw new TypeError('The "msg" argument must be of type string or an instance of Buffer, TypedArray, or DataView');
+    }
+    if (offset !== undefined) {
+        data = new Uint8Array(data.buffer, data.byteOffset + offset, length);
+    }
+
+    if (!net.isIP(address)) {
+        // Only address literals are supported; there is no resolver in the runtime
+        const error = errnoException(binding.constants.UV_EINVAL, 'send', address, port);
+        if (callback) {
+            nextTick(() => callback(error));
+        } else {
+            nextTick(() => this.emit('error', error));
+        }
+        return;
+    }
+
+    // An unbound socket is bound to a random port, as in Node.js
+    if (!this._bound) {
+        this.bind({ port: 0 });
+    }
+
+    this._sendQueue.push(data, port, address);
+    this._sendCallbacks.push(callback, data.byteLength);
+    if (!this._sendScheduled) {
+        this._sendScheduled = true;
+        Promise.resolve().then(() => this._flushSends());
+    }
+};
+
+// Hand the sends of the last tick to the native side in one call
+Socket.prototype._flushSends = function() {
+    this._sendScheduled = false;
+    const list = this._sendQueue;
+    const callbacks = this._sendCallbacks;
+    this._sendQueue = [];
+    this._sendCallbacks = [];
+    if (!this._handle) {
+        this._completeSends(callbacks, notRunning());
+        return;
+    }
+    const result = this._handle.send(list);
+    if (result === 1) {
+        this._sendBatches.push(callbacks);
+        return;
+    }
+    this._completeSends(callbacks, result < 0 ? errnoException(result, 'send') : null);
+};
+
+// Report a batch of sends; the batch shares one status
+Socket.prototype._completeSends = function(callbacks, error) {
+    let reported = false;
+    for (let i = 0; i < callbacks.length; i += 2) {
+        const callback = callbacks[i];
+        if (callback) {
+            reported = true;
+            if (error) {
+                callback(error);
+            } else {
+                callback(null, callbacks[i + 1]);
+            }
+        }
+    }
+    if (error && !reported && this._handle) {
+        this.emit('error', error);
+    }
+};
+
+Socket.prototype.close = function(callback) {
+    this._healthCheck();
+    if (callback) {
+        this.once('close', callback);
+    }
+    // Sends of the current tick still go out before the handle closes
+    if (this._sendQueue.length > 0) {
+        this._flushSends();
+    }
+    this._handle.close();
+    this._handle = null;
+    return this;
+};
+
+Socket.prototype.address = function() {
+    this._healthCheck();
+    const out = {};
+    const err = this._handle.getsockname(out);
+    if (err !== 0) {
+        throw errnoException(err, 'getsockname');
+    }
+    return out;
+};
+
+function checkResult(err, syscall) {
+    if (err < 0) {
+        throw errnoException(err, syscall);
+    }
+    return err;
+}
+
+Socket.prototype.setBroadcast = function(flag) {
+    this._healthCheck();
+    checkResult(this._handle.setBroadcast(!!flag), 'setBroadcast');
+};
+
+Socket.prototype.setTTL = function(ttl) {
+    this._healthCheck();
+    checkResult(this._handle.setTTL(ttl), 'setTTL');
+    return ttl;
+};
+
+Socket.prototype.setMulticastTTL = function(ttl) {
+    this._healthCheck();
+    checkResult(this._handle.setMulticastTTL(ttl), 'setMulticastTTL');
+    return ttl;
+};
+
+Socket.prototype.setMulticastLoopback = function(flag) {
+    this._healthCheck();
+    checkResult(this._handle.setMulticastLoopback(!!flag), 'setMulticastLoopback');
+    return flag;
+};
+
+Socket.prototype.addMembership = function(multicastAddress, interfaceAddress) {
+    this._healthCheck();
+    checkResult(this._handle.setMembership(multicastAddress, interfaceAddress, true), 'addMembership');
+};
+
+Socket.prototype.dropMembership = function(multicastAddress, interfaceAddress) {
+    this._healthCheck();
+    checkResult(this._handle.setMembership(multicastAddress, interfaceAddress, false), 'dropMembership');
+};
+
+Socket.prototype.setRecvBufferSize = function(size) {
+    this._healthCheck();
+    checkResult(this._handle.bufferSize(size, true), 'uv_recv_buffer_size');
+};
+
+Socket.prototype.setSendBufferSize = function(size) {
+    this._healthCheck();
+    checkResult(this._handle.bufferSize(size, false), 'uv_send_buffer_size');
+};
+
+Socket.prototype.getRecvBufferSize = function() {
+    this._healthCheck();
+    return checkResult(this._handle.bufferSize(0, true), 'uv_recv_buffer_size');
+};
+
+Socket.prototype.getSendBufferSize = function() {
+    this._healthCheck();
+    return checkResult(this._handle.bufferSize(0, false), 'uv_send_buffer_size');
+};
+
+Socket.prototype.getSendQueueSize = function() {
+    return this._handle ? this._handle.getSendQueueSize() : 0;
+};
+
+Socket.prototype.getSendQueueCount = function() {
+    return this._handle ? this._handle.getSendQueueCount() : 0;
+};
+
+Socket.prototype.ref = function() {
+    if (this._handle) {
+        this._handle.ref();
+    }
+    return this;
+};
+
+Socket.prototype.unref = function() {
+    if (this._handle) {
+        this._handle.unref();
+    }
+    return this;
+};
+
+function createSocket(type, listener) {
+    return new Socket(type, listener);
+}
+
+module.exports = {
+    createSocket,
+    Socket,
+};
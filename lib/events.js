@@ -0,0 +1,268 @@
+// Events module
+//
+// A CommonJS implementation of Node.js's EventEmitter. Built into the
+// runtime binary and served by require('events').
+//
+// A type with one listener stores the function itself; several listeners
+// live in an array that is replaced, never mutated, when listeners are
+// added or removed. emit() can therefore walk the array it read without
+// copying it, and passes up to three arguments without building an
+// arguments array.
+
+function EventEmitter() {
+    EventEmitter.init.call(this);
+}
+
+EventEmitter.EventEmitter = EventEmitter;
+EventEmitter.defaultMaxListeners = 10;
+
+EventEmitter.init = function() {
+    if (this._events === undefined || this._events === Object.getPrototypeOf(this)._events) {
+        this._events = Object.create(null);
+        this._eventsCount = 0;
+    }
+    this._maxListeners = this._maxListeners || undefined;
+};
+
+EventEmitter.prototype.setMaxListeners = function(n) {
+    if (typeof n !== 'number' || n < 0 || Number.isNaN(n)) {
+        throw new RangeError('The value of "n" is out of range');
+    }
+    this._maxListeners = n;
+    return this;
+};
+
+EventEmitter.prototype.getMaxListeners = function() {
+    return this._maxListeners === undefined ? EventEmitter.defaultMaxListeners : this._maxListeners;
+};
+
+// Add a listener, either at the end or at the front of the list
+function addListener(target, type, listener, prepend) {
+    if (typeof listener !== 'function') {
+        throw new TypeError('The "listener" argument must be of type function');
+    }
+
+    let events = target._events;
+    if (events === undefined) {
+        events = target._events = Object.create(null);
+        target._eventsCount = 0;
+    } else if (events.newListener !== undefined) {
+        target.emit('newListener', type, listener.listener ? listener.listener : listener);
+        events = target._events;
+    }
+
+    const existing = events[type];
+    if (existing === undefined) {
+        // A single listener is stored directly, without an array
+        events[type] = listener;
+        target._eventsCount++;
+    } else if (typeof existing === 'function') {
+        events[type] = prepend ? [listener, existing] : [existing, listener];
+    } else {
+        // Copy on write, so an emit walking the old array is not affected
+        events[type] = prepend ? [listener].concat(existing) : existing.concat([listener]);
+    }
+
+    return target;
+}
+
+EventEmitter.prototype.addListener = function(type, listener) {
+    return addListener(this, type, listener, false);
+};
+
+EventEmitter.prototype.on = EventEmitter.prototype.addListener;
+
+EventEmitter.prototype.prependListener = function(type, listener) {
+    return addListener(this, type, listener, true);
+};
+
+// Wrap a listener so that it removes itself before its first call
+function onceWrapper(target, type, listener) {
+    const state = { fired: false, target, type, listener, wrapFn: undefined };
+    const wrapped = function() {
+        if (!state.fired) {
+            state.target.removeListener(state.type, state.wrapFn);
+            state.fired = true;
+            return state.listener.apply(state.target, arguments);
+        }
+    };
+    wrapped.listener = listener;
+    state.wrapFn = wrapped;
+    return wrapped;
+}
+
+EventEmitter.prototype.once = function(type, listener) {
+    if (typeof listener !== 'function') {
+        throw new TypeError('The "listener" argument must be of type function');
+    }
+    this.on(type, onceWrapper(this, type, listener));
+    return this;
+};
+
+EventEmitter.prototype.prependOnceListener = function(type, listener) {
+    if (typeof listener !== 'function') {
+        throw new TypeError('The "listener" argument must be of type function');
+    }
+    this.prependListener(type, onceWrapper(this, type, listener));
+    return this;
+};
+
+// Call a listener with the arguments emit() received after the event name
+function callListener(listener, target, argc, a1, a2, a3, args) {
+    switch (argc) {
+        case 0:
+            listener.call(target);
+            break;
+        case 1:
+            listener.call(target, a1);
+            break;
+        case 2:
+            listener.call(target, a1, a2);
+            break;
+        case 3:
+            listener.call(target, a1, a2, a3);
+            break;
+        default:
+            listener.apply(target, args);
+    }
+}
+
+EventEmitter.prototype.emit = function(type, a1, a2, a3) {
+    const events = this._events;
+    const handler = events === undefined ? undefined : events[type];
+
+    if (handler === undefined) {
+        if (type === 'error') {
+            if (a1 instanceof Error) {
+                throw a1;
+            }
+            throw new Error('Unhandled error. (' + a1 + ')');
+        }
+        return false;
+    }
+
+    const argc = arguments.length - 1;
+    let args;
+    if (argc > 3) {
+        args = new Array(argc);
+        for (let i = 0; i < argc; i++) {
+            args[i] = arguments[i + 1];
+        }
+    }
+
+    if (typeof handler === 'function') {
+        callListener(handler, this, argc, a1, a2, a3, args);
+    } else {
+        // Listener arrays are never mutated, so listeners added or removed now do not affect this call
+        for (let i = 0; i < handler.length; i++) {
+            callListener(handler[i], this, argc, a1, a2, a3, args);
+        }
+    }
+
+    return true;
+};
+
+EventEmitter.prototype.removeListener = function(type, listener) {
+    if (typeof listener !== 'function') {
+        throw new TypeError('The "listener" argument must be of type function');
+    }
+
+    const events = this._events;
+    if (events === undefined) {
+        return this;
+    }
+
+    const list = events[type];
+    if (list === undefined) {
+        return this;
+    }
+
+    if (list === listener || list.listener === listener) {
+        if (--this._eventsCount === 0) {
+            this._events = Object.create(null);
+        } else {
+            delete events[type];
+        }
+        if (events.removeListener) {
+            this.emit('removeListener', type, list.listener || listener);
+        }
+    } else if (typeof list !== 'function') {
+        for (let i = list.length - 1; i >= 0; i--) {
+            if (list[i] === listener || list[i].listener === listener) {
+                if (list.length === 2) {
+                    events[type] = list[1 - i];
+                } else {
+                    events[type] = list.slice(0, i).concat(list.slice(i + 1));
+                }
+                if (events.removeListener !== undefined) {
+                    this.emit('removeListener', type, listener);
+                }
+                break;
+            }
+        }
+    }
+
+    return this;
+};
+
+EventEmitter.prototype.off = EventEmitter.prototype.removeListener;
+
+EventEmitter.prototype.removeAllListeners = function(type) {
+    const events = this._events;
+    if (events === undefined) {
+        return this;
+    }
+
+    if (type === undefined) {
+        this._events = Object.create(null);
+        this._eventsCount = 0;
+    } else if (events[type] !== undefined) {
+        if (--this._eventsCount === 0) {
+            this._events = Object.create(null);
+        } else {
+            delete events[type];
+        }
+    }
+
+    return this;
+};
+
+EventEmitter.prototype.listeners = function(type) {
+    const events = this._events;
+    if (events === undefined || events[type] === undefined) {
+        return [];
+    }
+    const list = events[type];
+    if (typeof list === 'function') {
+        return [list.listener || list];
+    }
+    return list.map((fn) => fn.listener || fn);
+};
+
+EventEmitter.prototype.rawListeners = function(type) {
+    const events = this._events;
+    if (events === undefined || events[type] === undefined) {
+        return [];
+    }
+    const list = events[type];
+    return typeof list === 'function' ? [list] : list.slice();
+};
+
+EventEmitter.prototype.listenerCount = function(type) {
+    const events = this._events;
+    if (events === undefined || events[type] === undefined) {
+        return 0;
+    }
+    const list = events[type];
+    return typeof list === 'function' ? 1 : list.length;
+};
+
+EventEmitter.prototype.eventNames = function() {
+    return this._eventsCount > 0 ? Reflect.ownKeys(this._events) : [];
+};
+
+EventEmitter.listenerCount = function(emitter, type) {
+    return emitter.listenerCount(type);
+};
+
+module.exports = EventEmitter;
@@ -0,0 +1,329 @@
+// Fs module
+//
+// readFile, writeFile and exists from internal/fs, promises.readFile, and
+// Node.js-compatible ReadStream and WriteStream over native file stream
+// handles. Reads and writes run on the thread pool in 64 KB chunks, and
+// pipeline() between a file stream and a socket or another file runs
+// entirely in native code.
+// Built into the runtime binary and served by require('fs').
+
+const binding = require('internal/fs');
+const { errname, strerror } = require('internal/net');
+const { Buffer } = require('buffer');
+const { Readable, Writable } = require('stream');
+
+const constants = binding.constants;
+const UV_EOF = constants.UV_EOF;
+
+const kFlags = {
+    'r': constants.O_RDONLY,
+    'r+': constants.O_RDWR,
+    'w': constants.O_WRONLY | constants.O_CREAT | constants.O_TRUNC,
+    'wx': constants.O_WRONLY | constants.O_CREAT | constants.O_TRUNC | constants.O_EXCL,
+    'w+': constants.O_RDWR | constants.O_CREAT | constants.O_TRUNC,
+    'wx+': constants.O_RDWR | constants.O_CREAT | constants.O_TRUNC | constants.O_EXCL,
+    'a': constants.O_WRONLY | constants.O_CREAT | constants.O_APPEND,
+    'ax': constants.O_WRONLY | constants.O_CREAT | constants.O_APPEND | constants.O_EXCL,
+    'a+': constants.O_RDWR | constants.O_CREAT | constants.O_APPEND,
+    'ax+': constants.O_RDWR | constants.O_CREAT | constants.O_APPEND | constants.O_EXCL,
+};
+
+function nextTick(fn) {
+    setTimeout(fn, 0);
+}
+
+// Create an Error for a failed libuv call, worded like Node.js
+function uvException(err, syscall, path) {
+    const code = errname(err);
+    let message = code + ': ' + strerror(err) + ', ' + syscall;
+    if (path !== undefined) {
+        message += " '" + path + "'";
+    }
+    const error = new Error(message);
+    error.errno = err;
+    error.code = code;
+    error.syscall = syscall;
+    if (path !== undefined) {
+        error.path = path;
+    }
+    return error;
+}
+
+function stringToFlags(flags) {
+    if (typeof flags === 'number') {
+        return flags;
+    }
+    const value = kFlags[flags];
+    if (value === undefined) {
+        throw new TypeError("The value \"" + flags + "\" is invalid for option \"flags\"");
+    }
+    return value;
+}
+
+// Callbacks from the native handles; this is the handle and this.owner its stream
+
+function onread(nread, chunk) {
+    const stream = this.owner;
+    stream._readPending = false;
+    if (nread > 0) {
+        stream.bytesRead += nread;
+        stream.push(Buffer.from(chunk.buffer, chunk.byteOffset, nread));
+        return;
+    }
+    if (nread === UV_EOF) {
+        stream.push(null);
+        return;
+    }
+    stream.destroy(uvException(nread, 'read'));
+}
+
+function onwrite(status) {
+    const stream = this.owner;
+    const callback = stream._pendingWrite;
+    stream._pendingWrite = null;
+    if (callback) {
+        callback(status < 0 ? uvException(status, 'write') : undefined);
+    }
+}
+
+function onclose() {
+    const owner = this.owner;
+    if (owner && owner._onHandleClose) {
+        const callback = owner._onHandleClose;
+        owner._onHandleClose = null;
+        callback();
+    }
+}
+
+binding.setup({ onread, onwrite, onclose });
+
+// Open a handle for a stream; errors destroy the stream on the next tick
+function openHandle(stream, flags, mode) {
+    const handle = new binding.FileStream();
+    const err = handle.open(stream.path, stringToFlags(flags), mode, stream.start, stream.end);
+    if (err < 0) {
+        nextTick(() => stream.destroy(uvException(err, 'open', stream.path)));
+        return;
+    }
+    handle.owner = stream;
+    stream._handle = handle;
+    stream.pending = false;
+    nextTick(() => {
+        stream.emit('open');
+        stream.emit('ready');
+    });
+}
+
+// Close the handle of a destroyed stream, then let it emit 'close'
+function closeHandle(stream, err, callback) {
+    const handle = stream._handle;
+    stream._handle = null;
+    if (!handle) {
+        nextTick(() => callback(err));
+        return;
+    }
+    stream._onHandleClose = () => callback(err);
+    handle.close();
+}
+
+// ReadStream
+
+function ReadStream(path, options) {
+    if (!(this instanceof ReadStream)) {
+        return new ReadStream(path, options);
+    }
+    options = typeof options === 'string' ? { encoding: options } : (options || {});
+    Readable.call(this, Object.assign({ highWaterMark: 64 * 1024 }, options));
+
+    this.path = String(path);
+    this.start = options.start;
+    this.end = options.end;
+    this.bytesRead = 0;
+    this.pending = true;
+    this._handle = null;
+    this._readPending = false;
+    this._nativePipe = false;
+    this._onHandleClose = null;
+    if (this.start !== undefined && this.end !== undefined && this.start > this.end) {
+        throw new RangeError('The value of "start" must be <= "end". Received ' + this.start);
+    }
+
+    openHandle(this, options.flags || 'r', options.mode === undefined ? 0o666 : options.mode);
+    if (options.autoClose !== false) {
+        this.on('end', () => this.destroy());
+    }
+}
+Object.setPrototypeOf(ReadStream.prototype, Readable.prototype);
+Object.setPrototypeOf(ReadStream, Readable);
+
+ReadStream.prototype._read = function(size) {
+    if (!this._handle) {
+        this.once('open', () => this._read(size));
+        return;
+    }
+    if (this._readPending || this._nativePipe) {
+        return;
+    }
+    this._readPending = true;
+    this._handle.read(size);
+};
+
+ReadStream.prototype._destroy = function(err, callback) {
+    closeHandle(this, err, callback);
+};
+
+ReadStream.prototype.close = function(callback) {
+    if (callback) {
+        this.once('close', callback);
+    }
+    this.destroy();
+};
+
+// The handle for reading in a native pipeline, while nothing is buffered or being read
+ReadStream.prototype._nativeStreamHandle = function(mode) {
+    const state = this._readableState;
+    if (mode !== 'read' || !this._handle || this._readPending || state.ended || state.destroyed ||
+        state.buffer.count() > 0) {
+        return null;
+    }
+    return this._handle;
+};
+
+ReadStream.prototype._nativePipeStart = function() {
+    this._nativePipe = true;
+};
+
+ReadStream.prototype._nativePipeEnd = function(mode, ended) {
+    this._nativePipe = false;
+    if (ended) {
+        this.push(null);
+    }
+};
+
+// WriteStream
+
+function WriteStream(path, options) {
+    if (!(this instanceof WriteStream)) {
+        return new WriteStream(path, options);
+    }
+    options = typeof options === 'string' ? { encoding: options } : (options || {});
+    Writable.call(this, options);
+
+    this.path = String(path);
+    this.start = options.start;
+    this.bytesWritten = 0;
+    this.pending = true;
+    this._handle = null;
+    this._pendingWrite = null;
+    this._onHandleClose = null;
+
+    openHandle(this, options.flags || 'w', options.mode === undefined ? 0o666 : options.mode);
+    if (options.autoClose !== false) {
+        this.on('finish', () => this.destroy());
+    }
+}
+Object.setPrototypeOf(WriteStream.prototype, Writable.prototype);
+Object.setPrototypeOf(WriteStream, Writable);
+
+WriteStream.prototype._write = function(chunk, encoding, callback) {
+    this._writev([{ chunk, encoding }], callback);
+};
+
+WriteStream.prototype._writev = function(entries, callback) {
+    if (!this._handle) {
+        if (this.destroyed) {
+            return;
+        }
+        this.once('open', () => this._writev(entries, callback));
+        return;
+    }
+
+    const chunks = new Array(entries.length);
+    let bytes = 0;
+    for (let i = 0; i < entries.length; i++) {
+        const chunk = entries[i].chunk;
+        chunks[i] = typeof chunk === 'string' ? Buffer.from(chunk, entries[i].encoding) : chunk;
+        bytes += chunks[i].byteLength;
+    }
+    const result = this._handle.writev(chunks);
+    if (result < 0) {
+        callback(uvException(result, 'write'));
+        return;
+    }
+    this.bytesWritten += bytes;
+    this._pendingWrite = callback;
+};
+
+WriteStream.prototype._destroy = function(err, callback) {
+    closeHandle(this, err, callback);
+};
+
+WriteStream.prototype.close = function(callback) {
+    if (callback) {
+        this.once('close', callback);
+    }
+    if (this._writableState.ending) {
+        this.destroy();
+    } else {
+        this.end();
+    }
+};
+
+Object.defineProperty(WriteStream.prototype, 'destroyed', {
+    get() {
+        return this._writableState.destroyed;
+    },
+});
+
+// The handle for writing in a native pipeline, while no write is buffered or in flight
+WriteStream.prototype._nativeStreamHandle = function(mode) {
+    const state = this._writableState;
+    if (mode !== 'write' || !this._handle || state.ending || state.destroyed || state.length > 0) {
+        return null;
+    }
+    return this._handle;
+};
+
+// Writes made while piped simply queue behind the pipe's
+WriteStream.prototype._nativePipeStart = function() {
+};
+
+WriteStream.prototype._nativePipeEnd = function() {
+};
+
+function createReadStream(path, options) {
+    return new ReadStream(path, options);
+}
+
+function createWriteStream(path, options) {
+    return new WriteStream(path, options);
+}
+
+// fs.promises.readFile: the file is read on the thread pool in one piece
+function readFilePromise(path, options) {
+    if (typeof path !== 'string') {
+        return Promise.reject(new TypeError('The "path" argument must be of type string'));
+    }
+    options = typeof options === 'string' ? { encoding: options } : (options || {});
+    const encoding = options.encoding;
+    return binding.readFileAsync(path).then((bytes) => {
+        const buffer = Buffer.from(bytes.buffer, bytes.byteOffset, bytes.length);
+        return encoding ? buffer.toString(encoding) : buffer;
+    });
+}
+
+const promises = {
+    readFile: readFilePromise,
+};
+
+module.exports = {
+    readFile: binding.readFile,
+    writeFile: binding.writeFile,
+    exists: binding.exists,
+    ReadStream,
+    WriteStream,
+    createReadStream,
+    createWriteStream,
+    promises,
+    constants,
+};
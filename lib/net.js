@@ -0,0 +1,706 @@
+// Net module
+//
+// Node.js-compatible TCP servers and sockets on libuv handles from
+// internal/net. Reads arrive as Buffers over shared slabs, corked writes
+// go out in a single writev, and pausing a socket stops reading from the
+// kernel so a slow consumer pushes back on its peer. Built into the
+// runtime binary and served by require('net').
+
+const binding = require('internal/net');
+const EventEmitter = require('events');
+const { Buffer } = require('buffer');
+const { Duplex, Readable } = require('stream');
+
+const UV_EOF = binding.constants.UV_EOF;
+
+function nextTick(fn) {
+    setTimeout(fn, 0);
+}
+
+// Wrap a slab view without copying it
+function toBuffer(array) {
+    return Buffer.from(array.buffer, array.byteOffset, array.length);
+}
+
+// Create an Error for a failed libuv call, with errno and code like Node.js
+function errnoException(err, syscall, address, port) {
+    const code = binding.errname(err);
+    let message = syscall + ' ' + code;
+    if (address !== undefined) {
+        message += ' ' + address + (port !== undefined ? ':' + port : '');
+    }
+    const error = new Error(message);
+    error.errno = err;
+    error.code = code;
+    error.syscall = syscall;
+    if (address !== undefined) {
+        error.address = address;
+    }
+    if (port !== undefined) {
+        error.port = port;
+    }
+    return error;
+}
+
+function isIP(input) {
+    return binding.isIP(String(input));
+}
+
+// Callbacks from the native handles; this is the handle and this.owner its socket or server
+
+function onread(nread, chunk) {
+    const socket = this.owner;
+    if (nread > 0) {
+        socket.bytesRead += nread;
+        socket._touch();
+        // Stop reading from the kernel once the readable buffer is full
+        if (!socket.push(toBuffer(chunk)) && socket._handle) {
+            socket._stopReading();
+        }
+        return;
+    }
+    socket._stopReading();
+    if (nread === UV_EOF) {
+        socket.push(null);
+        if (!socket.allowHalfOpen) {
+            socket.end();
+        }
+        return;
+    }
+    socket.destroy(errnoException(nread, 'read'));
+}
+
+function onconnection(status, handle) {
+    const server = this.owner;
+    if (status < 0) {
+        server.emit('error', errnoException(status, 'accept'));
+        return;
+    }
+    if (server.maxConnections && server._connections >= server.maxConnections) {
+        handle.close();
+        return;
+    }
+    const socket = new Socket({ handle, allowHalfOpen: server._allowHalfOpen });
+    socket.server = server;
+    server._connections++;
+    socket.once('close', () => {
+        server._connections--;
+        server._emitCloseIfDrained();
+    });
+    if (server._noDelay) {
+        socket.setNoDelay(true);
+    }
+    server.emit('connection', socket);
+    socket._startReading();
+}
+
+function onconnect(status) {
+    const socket = this.owner;
+    if (socket.destroyed) {
+        return;
+    }
+    socket.connecting = false;
+    if (status < 0) {
+        socket.destroy(errnoException(status, 'connect', socket._host, socket._port));
+        return;
+    }
+    socket._touch();
+    socket.emit('connect');
+    socket.emit('ready');
+    socket._startReading();
+
+    // Writes and end() issued while connecting
+    const pending = socket._pendingConnect;
+    socket._pendingConnect = null;
+    if (pending) {
+        pending();
+    }
+}
+
+function onwrite(status) {
+    const socket = this.owner;
+    const callback = socket._pendingWrite;
+    socket._pendingWrite = null;
+    if (!callback) {
+        return;
+    }
+    socket._touch();
+    callback(status < 0 && !socket.destroyed ? errnoException(status, 'write') : undefined);
+}
+
+function onshutdown(status) {
+    const socket = this.owner;
+    const callback = socket._pendingShutdown;
+    socket._pendingShutdown = null;
+    if (callback) {
+        callback(status < 0 && !socket.destroyed ? errnoException(status, 'shutdown') : undefined);
+    }
+}
+
+function onclose() {
+    const owner = this.owner;
+    if (owner && owner._onHandleClose) {
+        const callback = owner._onHandleClose;
+        owner._onHandleClose = null;
+        callback();
+    }
+}
+
+binding.setup({ onread, onconnection, onconnect, onwrite, onshutdown, onclose });
+
+// Accept (options[, listener]) as well as (port[, host][, listener])
+function normalizeConnectArgs(args) {
+    let options = args[0];
+    if (typeof options !== 'object' || options === null) {
+        options = { port: args[0], host: typeof args[1] === 'string' ? args[1] : undefined };
+    }
+    const last = args[args.length - 1];
+    return [options, typeof last === 'function' ? last : undefined];
+}
+
+// Socket
+
+function Socket(options) {
+    if (!(this instanceof Socket)) {
+        return new Socket(options);
+    }
+    options = options || {};
+    Duplex.call(this, options);
+
+    this._handle = null;
+    this._reading = false;
+    this._nativePipe = false;
+    this._pendingWrite = null;
+    this._pendingShutdown = null;
+    this._pendingConnect = null;
+    this._onHandleClose = null;
+    this._host = undefined;
+    this._port = undefined;
+    this._timeout = 0;
+    this._timer = null;
+    this._lastActive = 0;
+    this.connecting = false;
+    this.allowHalfOpen = !!options.allowHalfOpen;
+    this.bytesRead = 0;
+    this._bytesDispatched = 0;
+    this.server = null;
+    this._endEmitted = false;
+
+    if (options.handle) {
+        this._attach(options.handle);
+    }
+
+    // The socket closes once both directions are done
+    this.on('end', () => {
+        this._endEmitted = true;
+        this._maybeDestroy();
+    });
+    this.on('finish', () => this._maybeDestroy());
+}
+Object.setPrototypeOf(Socket.prototype, Duplex.prototype);
+Object.setPrototypeOf(Socket, Duplex);
+
+Socket.prototype._attach = function(handle) {
+    this._handle = handle;
+    handle.owner = this;
+};
+
+Socket.prototype._startReading = function() {
+    if (this._handle && !this.connecting && !this._reading && !this._nativePipe && !this.isPaused()) {
+        this._reading = true;
+        this._handle.readStart();
+    }
+};
+
+Socket.prototype._stopReading = function() {
+    if (this._reading && !this._nativePipe) {
+        this._reading = false;
+        if (this._handle) {
+            this._handle.readStop();
+        }
+    }
+};
+
+Socket.prototype._read = function() {
+    this._startReading();
+};
+
+// The handle for one direction of a native pipeline, while the socket has nothing buffered that way
+Socket.prototype._nativeStreamHandle = function(mode) {
+    if (!this._handle || this.connecting) {
+        return null;
+    }
+    if (mode === 'read') {
+        const state = this._readableState;
+        return state.ended || state.destroyed || state.buffer.count() > 0 || this._nativePipe ? null : this._handle;
+    }
+    const state = this._writableState;
+    return state.ending || state.destroyed || state.length > 0 || this._pendingWrite ? null : this._handle;
+};
+
+// While piped from, reads go to the native pipe and the socket leaves reading alone
+Socket.prototype._nativePipeStart = function(mode) {
+    if (mode === 'read') {
+        this._nativePipe = true;
+    }
+};
+
+// The pipe stopped reading when it ended; after the end of the data, end like onread() does
+Socket.prototype._nativePipeEnd = function(mode, ended) {
+    if (mode !== 'read') {
+        return;
+    }
+    this._nativePipe = false;
+    this._reading = false;
+    if (ended) {
+        this.push(null);
+        if (!this.allowHalfOpen) {
+            this.end();
+        }
+    }
+};
+
+// Pausing stops reads at the kernel, so TCP flow control reaches the peer
+Socket.prototype.pause = function() {
+    Readable.prototype.pause.call(this);
+    this._stopReading();
+    return this;
+};
+
+Socket.prototype.resume = function() {
+    Readable.prototype.resume.call(this);
+    this._startReading();
+    return this;
+};
+
+Socket.prototype._write = function(chunk, encoding, callback) {
+    this._writeGeneric([{ chunk, encoding }], callback);
+};
+
+Socket.prototype._writev = function(entries, callback) {
+    this._writeGeneric(entries, callback);
+};
+
+Socket.prototype._writeGeneric = function(entries, callback) {
+    if (this.connecting) {
+        this._pendingConnect = () => this._writeGeneric(entries, callback);
+        return;
+    }
+    if (this.destroyed) {
+        return;
+    }
+    if (!this._handle) {
+        callback(new Error('This socket has been ended by the other party'));
+        return;
+    }
+
+    const chunks = new Array(entries.length);
+    let bytes = 0;
+    for (let i = 0; i < entries.length; i++) {
+        const chunk = entries[i].chunk;
+        chunks[i] = typeof chunk === 'string' ? Buffer.from(chunk, entries[i].encoding) : chunk;
+        bytes += chunks[i].byteLength;
+    }
+
+    const result = this._handle.writev(chunks);
+    if (result < 0) {
+        callback(errnoException(result, 'write'));
+        return;
+    }
+    this._bytesDispatched += bytes;
+    this._touch();
+    if (result === 0) {
+        callback();
+    } else {
+        this._pendingWrite = callback;
+    }
+};
+
+// Half-close the connection once everything written has gone out
+Socket.prototype._final = function(callback) {
+    if (this.connecting) {
+        this._pendingConnect = () => this._final(callback);
+        return;
+    }
+    if (!this._handle) {
+        callback();
+        return;
+    }
+    const err = this._handle.shutdown();
+    if (err < 0) {
+        callback(errnoException(err, 'shutdown'));
+        return;
+    }
+    this._pendingShutdown = callback;
+};
+
+Socket.prototype._maybeDestroy = function() {
+    if (this._endEmitted && this._writableState.finished) {
+        this.destroy();
+    }
+};
+
+Socket.prototype._destroy = function(err, callback) {
+    this.connecting = false;
+    this._writableState.destroyed = true;
+    if (this._timer) {
+        clearTimeout(this._timer);
+        this._timer = null;
+    }
+    if (!this._handle) {
+        nextTick(() => callback(err));
+        return;
+    }
+    this._reading = false;
+    this._onHandleClose = () => callback(err);
+    this._handle.close();
+    this._handle = null;
+};
+
+Object.defineProperty(Socket.prototype, 'destroyed', {
+    get() {
+        return this._readableState.destroyed;
+    },
+});
+
+Socket.prototype.connect = function(...args) {
+    const [options, connectListener] = normalizeConnectArgs(args);
+    const port = Number(options.port);
+    if (!Number.isInteger(port) || port < 0 || port > 65535) {
+        throw new RangeError('Port should be >= 0 and < 65536. Received ' + options.port + '.');
+    }
+    this._host = options.host || 'localhost';
+    this._port = port;
+
+    if (!this._handle) {
+        this._attach(new binding.TCP());
+    }
+    if (connectListener) {
+        this.once('connect', connectListener);
+    }
+    if (options.noDelay) {
+        this._handle.setNoDelay(true);
+    }
+    if (options.keepAlive) {
+        this._handle.setKeepAlive(true, Math.floor((options.keepAliveInitialDelay || 0) / 1000));
+    }
+
+    this.connecting = true;
+    const err = this._handle.connect(this._host, port);
+    if (err < 0) {
+        nextTick(() => this.destroy(errnoException(err, 'connect', this._host, port)));
+    }
+    return this;
+};
+
+Socket.prototype.setNoDelay = function(noDelay) {
+    if (this._handle) {
+        this._handle.setNoDelay(noDelay === undefined ? true : !!noDelay);
+    }
+    return this;
+};
+
+Socket.prototype.setKeepAlive = function(enable, initialDelay) {
+    if (this._handle) {
+        this._handle.setKeepAlive(!!enable, Math.floor((initialDelay || 0) / 1000));
+    }
+    return this;
+};
+
+// Emit 'timeout' after ms of inactivity; the timer is re-armed lazily on activity
+Socket.prototype.setTimeout = function(ms, callback) {
+    this._timeout = ms;
+    if (this._timer) {
+        clearTimeout(this._timer);
+        this._timer = null;
+    }
+    if (callback) {
+        if (ms === 0) {
+            this.removeListener('timeout', callback);
+        } else {
+            this.once('timeout', callback);
+        }
+    }
+    this._touch();
+    return this;
+};
+
+Socket.prototype._touch = function() {
+    this._lastActive = Date.now();
+    if (this._timeout > 0 && !this._timer && !this.destroyed) {
+        this._armTimer(this._timeout);
+    }
+};
+
+Socket.prototype._armTimer = function(delay) {
+    this._timer = setTimeout(() => {
+        this._timer = null;
+        if (this._timeout === 0 || this.destroyed) {
+            return;
+        }
+        const idle = Date.now() - this._lastActive;
+        if (idle >= this._timeout) {
+            this.emit('timeout');
+        } else {
+            this._armTimer(this._timeout - idle);
+        }
+    }, delay);
+};
+
+Socket.prototype.address = function() {
+    const out = {};
+    return this._handle && this._handle.getsockname(out) === 0 ? out : {};
+};
+
+Socket.prototype._peer = function() {
+    const out = {};
+    return this._handle && this._handle.getpeername(out) === 0 ? out : {};
+};
+
+Object.defineProperty(Socket.prototype, 'remoteAddress', {
+    get() {
+        return this._peer().address;
+    },
+});
+
+Object.defineProperty(Socket.prototype, 'remotePort', {
+    get() {
+        return this._peer().port;
+    },
+});
+
+Object.defineProperty(Socket.prototype, 'remoteFamily', {
+    get() {
+        return this._peer().family;
+    },
+});
+
+Object.defineProperty(Socket.prototype, 'localAddress', {
+    get() {
+        return this.address().address;
+    },
+});
+
+Object.defineProperty(Socket.prototype, 'localPort', {
+    get() {
+        return this.address().port;
+    },
+});
+
+Object.defineProperty(Socket.prototype, 'bytesWritten', {
+    get() {
+        return this._bytesDispatched;
+    },
+});
+
+// Bytes waiting in the stream buffer and in the kernel-bound write queue
+Object.defineProperty(Socket.prototype, 'bufferSize', {
+    get() {
+        return this._writableState.length + (this._handle ? this._handle.writeQueueSize() : 0);
+    },
+});
+
+Object.defineProperty(Socket.prototype, 'readyState', {
+    get() {
+        if (this.connecting) {
+            return 'opening';
+        }
+        if (!this._handle) {
+            return 'closed';
+        }
+        if (this._readableState.ended) {
+            return this._writableState.ending ? 'closed' : 'writeOnly';
+        }
+        return this._writableState.ending ? 'readOnly' : 'open';
+    },
+});
+
+Socket.prototype.ref = function() {
+    if (this._handle) {
+        this._handle.ref();
+    }
+    return this;
+};
+
+Socket.prototype.unref = function() {
+    if (this._handle) {
+        this._handle.unref();
+    }
+    return this;
+};
+
+// Server
+
+function Server(options, connectionListener) {
+    if (!(this instanceof Server)) {
+        return new Server(options, connectionListener);
+    }
+    EventEmitter.call(this);
+    if (typeof options === 'function') {
+        connectionListener = options;
+        options = {};
+    }
+    options = options || {};
+    if (connectionListener) {
+        this.on('connection', connectionListener);
+    }
+    this._handle = null;
+    this._connections = 0;
+    this._allowHalfOpen = !!options.allowHalfOpen;
+    this._noDelay = !!options.noDelay;
+    this._unref = false;
+    this._closeEmitted = false;
+    this.maxConnections = undefined;
+    this.listening = false;
+}
+Object.setPrototypeOf(Server.prototype, EventEmitter.prototype);
+Object.setPrototypeOf(Server, EventEmitter);
+
+// Bind and listen on a fresh handle, returning it or a negative error code
+function listenOn(server, address, port, backlog) {
+    const handle = new binding.TCP();
+    handle.owner = server;
+    let err = handle.bind(address, port);
+    if (err === 0) {
+        err = handle.listen(backlog);
+    }
+    if (err !== 0) {
+        handle.close();
+        return err;
+    }
+    return handle;
+}
+
+Server.prototype.listen = function(...args) {
+    let options = {};
+    if (typeof args[0] === 'object' && args[0] !== null) {
+        options = args.shift();
+    } else {
+        if (typeof args[0] !== 'function') {
+            options.port = args.shift();
+        }
+        if (typeof args[0] === 'string') {
+            options.host = args.shift();
+        }
+        if (typeof args[0] === 'number') {
+            options.backlog = args.shift();
+        }
+    }
+    const callback = typeof args[args.length - 1] === 'function' ? args[args.length - 1] : undefined;
+
+    const port = options.port === undefined || options.port === null ? 0 : Number(options.port);
+    if (!Number.isInteger(port) || port < 0 || port > 65535) {
+        throw new RangeError('options.port should be >= 0 and < 65536. Received ' + options.port + '.');
+    }
+    if (this._handle) {
+        throw new Error('Listen method has been called more than once without closing.');
+    }
+    const backlog = options.backlog || 511;
+
+    let host = options.host;
+    let result;
+    if (host === undefined || host === null) {
+        // Prefer a dual-stack socket, like Node.js
+        host = '::';
+        result = listenOn(this, host, port, backlog);
+        if (result === binding.constants.UV_EAFNOSUPPORT || result === binding.constants.UV_EADDRNOTAVAIL) {
+            host = '0.0.0.0';
+            result = listenOn(this, host, port, backlog);
+        }
+    } else {
+        result = listenOn(this, host === 'localhost' ? '127.0.0.1' : host, port, backlog);
+    }
+
+    if (typeof result === 'number') {
+        nextTick(() => this.emit('error', errnoException(result, 'listen', host, port)));
+        return this;
+    }
+
+    this._handle = result;
+    this.listening = true;
+    this._closeEmitted = false;
+    if (this._unref) {
+        result.unref();
+    }
+    if (callback) {
+        this.once('listening', callback);
+    }
+    nextTick(() => this.emit('listening'));
+    return this;
+};
+
+Server.prototype.address = function() {
+    const out = {};
+    return this._handle && this._handle.getsockname(out) === 0 ? out : null;
+};
+
+// Stop accepting connections; 'close' follows once the open ones have closed
+Server.prototype.close = function(callback) {
+    if (callback) {
+        if (!this._handle) {
+            nextTick(() => callback(new Error('Server is not running.')));
+        } else {
+            this.once('close', callback);
+        }
+    }
+    if (this._handle) {
+        this._handle.close();
+        this._handle = null;
+        this.listening = false;
+        this._emitCloseIfDrained();
+    }
+    return this;
+};
+
+Server.prototype._emitCloseIfDrained = function() {
+    if (!this._handle && !this.listening && this._connections === 0 && !this._closeEmitted) {
+        this._closeEmitted = true;
+        nextTick(() => this.emit('close'));
+    }
+};
+
+Server.prototype.getConnections = function(callback) {
+    nextTick(() => callback(null, this._connections));
+    return this;
+};
+
+Server.prototype.ref = function() {
+    this._unref = false;
+    if (this._handle) {
+        this._handle.ref();
+    }
+    return this;
+};
+
+Server.prototype.unref = function() {
+    this._unref = true;
+    if (this._handle) {
+        this._handle.unref();
+    }
+    return this;
+};
+
+function createServer(options, connectionListener) {
+    return new Server(options, connectionListener);
+}
+
+function connect(...args) {
+    const [options, callback] = normalizeConnectArgs(args);
+    const socket = new Socket(options);
+    if (options.timeout) {
+        socket.setTimeout(options.timeout);
+    }
+    return socket.connect(options, callback);
+}
+
+module.exports = {
+    createServer,
+    connect,
+    createConnection: connect,
+    Socket,
+    Stream: Socket,
+    Server,
+    isIP,
+    isIPv4: (input) => isIP(input) === 4,
+    isIPv6: (input) => isIP(input) === 6,
+};
@@ -0,0 +1,186 @@
+// Path module
+//
+// POSIX path utilities compatible with Node.js's path module. Built into
+// the runtime binary and served by require('path').
+
+function assertPath(path) {
+    if (typeof path !== 'string') {
+        throw new TypeError('Path must be a string. Received ' + typeof path);
+    }
+}
+
+// Resolve '.' and '..' segments
+function normalizeSegments(path, allowAboveRoot) {
+    const result = [];
+    const segments = path.split('/');
+    for (let i = 0; i < segments.length; i++) {
+        const segment = segments[i];
+        if (segment === '' || segment === '.') {
+            continue;
+        }
+        if (segment === '..') {
+            if (result.length > 0 && result[result.length - 1] !== '..') {
+                result.pop();
+            } else if (allowAboveRoot) {
+                result.push('..');
+            }
+        } else {
+            result.push(segment);
+        }
+    }
+    return result.join('/');
+}
+
+function normalize(path) {
+    assertPath(path);
+    if (path.length === 0) {
+        return '.';
+    }
+
+    const absolute = path.charCodeAt(0) === 47;
+    const trailingSeparator = path.charCodeAt(path.length - 1) === 47;
+
+    let result = normalizeSegments(path, !absolute);
+    if (result.length === 0) {
+        return absolute ? '/' : (trailingSeparator ? './' : '.');
+    }
+    if (trailingSeparator) {
+        result += '/';
+    }
+    return absolute ? '/' + result : result;
+}
+
+function isAbsolute(path) {
+    assertPath(path);
+    return path.length > 0 && path.charCodeAt(0) === 47;
+}
+
+function join(...paths) {
+    let joined = '';
+    for (let i = 0; i < paths.length; i++) {
+        assertPath(paths[i]);
+        if (paths[i].length > 0) {
+            joined = joined.length === 0 ? paths[i] : joined + '/' + paths[i];
+        }
+    }
+    return joined.length === 0 ? '.' : normalize(joined);
+}
+
+function resolve(...paths) {
+    let resolved = '';
+    let absolute = false;
+
+    for (let i = paths.length - 1; i >= -1 && !absolute; i--) {
+        const path = i >= 0 ? paths[i] : process.cwd();
+        assertPath(path);
+        if (path.length === 0) {
+            continue;
+        }
+        resolved = path + '/' + resolved;
+        absolute = path.charCodeAt(0) === 47;
+    }
+
+    resolved = normalizeSegments(resolved, !absolute);
+    if (absolute) {
+        return '/' + resolved;
+    }
+    return resolved.length > 0 ? resolved : '.';
+}
+
+function relative(from, to) {
+    assertPath(from);
+    assertPath(to);
+
+    const fromParts = resolve(from).split('/').filter(Boolean);
+    const toParts = resolve(to).split('/').filter(Boolean);
+
+    let common = 0;
+    while (common < fromParts.length && common < toParts.length &&
+           fromParts[common] === toParts[common]) {
+        common++;
+    }
+
+    const up = fromParts.slice(common).map(() => '..');
+    return up.concat(toParts.slice(common)).join('/');
+}
+
+function dirname(path) {
+    assertPath(path);
+    if (path.length === 0) {
+        return '.';
+    }
+
+    let end = path.length - 1;
+    while (end > 0 && path.charCodeAt(end) === 47) {
+        end--;
+    }
+    const index = path.lastIndexOf('/', end);
+    if (index === -1) {
+        return '.';
+    }
+    if (index === 0) {
+        return '/';
+    }
+    return path.slice(0, index);
+}
+
+function basename(path, ext) {
+    assertPath(path);
+
+    let end = path.length;
+    while (end > 1 && path.charCodeAt(end - 1) === 47) {
+        end--;
+    }
+    const trimmed = path.slice(0, end);
+    let base = trimmed.slice(trimmed.lastIndexOf('/') + 1);
+
+    if (ext !== undefined && base.endsWith(ext) && base !== ext) {
+        base = base.slice(0, base.length - ext.length);
+    }
+    return base;
+}
+
+function extname(path) {
+    const base = basename(path);
+    const index = base.lastIndexOf('.');
+    if (index <= 0) {
+        return '';
+    }
+    return base.slice(index);
+}
+
+function parse(path) {
+    const root = isAbsolute(path) ? '/' : '';
+    const base = basename(path);
+    const ext = extname(path);
+    let dir = dirname(path);
+    if (dir === '.' && !path.startsWith('.')) {
+        dir = '';
+    }
+    return { root, dir, base, ext, name: ext ? base.slice(0, base.length - ext.length) : base };
+}
+
+function format(pathObject) {
+    const dir = pathObject.dir || pathObject.root || '';
+    const base = pathObject.base || ((pathObject.name || '') + (pathObject.ext || ''));
+    if (!dir) {
+        return base;
+    }
+    return dir === pathObject.root ? dir + base : dir + '/' + base;
+}
+
+module.exports = {
+    sep: '/',
+    delimiter: ':',
+    normalize,
+    isAbsolute,
+    join,
+    resolve,
+    relative,
+    dirname,
+    basename,
+    extname,
+    parse,
+    format,
+};
+module.exports.posix = module.exports;
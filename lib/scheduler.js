@@ -0,0 +1,26 @@
+// Scheduler module
+//
+// Cooperative scheduling for long-running scripts. scheduler.yield() returns
+// a promise that resolves on the next turn of the event loop: pending I/O
+// callbacks run first, and the awaiting code resumes ahead of tasks queued
+// in the meantime. A loop that awaits it every few milliseconds keeps a
+// server in the same process responsive. With --time-slice=<ms>,
+// shouldYield() turns true once loop work has waited a whole slice, so code
+// can yield only when the loop needs a turn; stats() reports how often, along
+// with the depth and high-water mark of each event loop queue.
+// Available as the global scheduler and through require('scheduler').
+
+const binding = require('internal/scheduler');
+
+const scheduler = {
+    yield: binding.yield,
+    shouldYield: binding.shouldYield,
+    stats: binding.stats,
+};
+
+module.exports = {
+    scheduler,
+    yield: binding.yield,
+    shouldYield: binding.shouldYield,
+    stats: binding.stats,
+};
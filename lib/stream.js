@@ -0,0 +1,584 @@
+// Stream module
+//
+// Readable, Writable, Duplex and Transform streams with high-water-mark
+// backpressure, plus pipeline(). Chunk queues and their size accounting are
+// native BufferLists from internal/stream, and pipeline() between two
+// streams backed by native handles (files, sockets) moves the data in
+// native code. Built into the runtime binary and served by require('stream').
+
+const binding = require('internal/stream');
+const EventEmitter = require('events');
+
+const BufferList = binding.BufferList;
+
+function defaultHighWaterMark(objectMode) {
+    return objectMode ? 16 : 16384;
+}
+
+// Readable and Writable state; length is what the buffer list counts
+
+function ReadableState(options) {
+    this.objectMode = !!(options.objectMode || options.readableObjectMode);
+    this.highWaterMark = options.highWaterMark !== undefined ? options.highWaterMark
+                                                            : defaultHighWaterMark(this.objectMode);
+    this.buffer = new BufferList(this.highWaterMark, this.objectMode);
+    this.flowing = null;
+    this.ended = false;
+    this.endEmitted = false;
+    this.reading = false;
+    this.destroyed = false;
+}
+
+Object.defineProperty(ReadableState.prototype, 'length', {
+    get() {
+        return this.buffer.length();
+    },
+});
+
+function WritableState(options) {
+    this.objectMode = !!(options.objectMode || options.writableObjectMode);
+    this.highWaterMark = options.highWaterMark !== undefined ? options.highWaterMark
+                                                            : defaultHighWaterMark(this.objectMode);
+    this.buffer = new BufferList(this.highWaterMark, this.objectMode);
+    this.writing = false;
+    this.ending = false;
+    this.finished = false;
+    this.destroyed = false;
+    this.corked = 0;
+}
+
+// Counts chunks being written as well as queued ones
+Object.defineProperty(WritableState.prototype, 'length', {
+    get() {
+        return this.buffer.length();
+    },
+});
+
+function nextTick(fn) {
+    setTimeout(fn, 0);
+}
+
+function Stream(options) {
+    EventEmitter.call(this);
+}
+Object.setPrototypeOf(Stream.prototype, EventEmitter.prototype);
+Object.setPrototypeOf(Stream, EventEmitter);
+
+// Readable
+
+function Readable(options) {
+    if (!(this instanceof Readable)) {
+        return new Readable(options);
+    }
+    options = options || {};
+    Stream.call(this, options);
+
+    this._readableState = new ReadableState(options);
+
+    if (typeof options.read === 'function') {
+        this._read = options.read;
+    }
+    if (typeof options.destroy === 'function') {
+        this._destroy = options.destroy;
+    }
+}
+Object.setPrototypeOf(Readable.prototype, Stream.prototype);
+Object.setPrototypeOf(Readable, Stream);
+
+Readable.prototype._read = function(size) {
+    throw new Error('The _read() method is not implemented');
+};
+
+Readable.prototype.push = function(chunk) {
+    const state = this._readableState;
+    state.reading = false;
+
+    if (chunk === null) {
+        state.ended = true;
+        this._flow();
+        return false;
+    }
+
+    if (state.flowing && state.buffer.count() === 0) {
+        this.emit('data', chunk);
+        this._maybeRead();
+        return state.length < state.highWaterMark;
+    }
+
+    const below = state.buffer.push(chunk);
+    if (state.flowing) {
+        this._flow();
+    } else {
+        this.emit('readable');
+    }
+    return below;
+};
+
+Readable.prototype.read = function() {
+    const state = this._readableState;
+    if (state.buffer.count() === 0) {
+        this._maybeRead();
+        return null;
+    }
+    const chunk = state.buffer.shift();
+    this._maybeRead();
+    return chunk;
+};
+
+// Ask the implementation for more data while below the high-water mark
+Readable.prototype._maybeRead = function() {
+    const state = this._readableState;
+    if (state.ended || state.reading || state.destroyed || state.length >= state.highWaterMark) {
+        if (state.ended && state.buffer.count() === 0) {
+            this._endIfDone();
+        }
+        return;
+    }
+    state.reading = true;
+    nextTick(() => this._read(state.highWaterMark - state.length));
+};
+
+Readable.prototype._flow = function() {
+    const state = this._readableState;
+    while (state.flowing && state.buffer.count() > 0) {
+        this.emit('data', state.buffer.shift());
+    }
+    if (state.flowing) {
+        this._maybeRead();
+    }
+    this._endIfDone();
+};
+
+Readable.prototype._endIfDone = function() {
+    const state = this._readableState;
+    if (state.ended && state.buffer.count() === 0 && !state.endEmitted) {
+        state.endEmitted = true;
+        nextTick(() => this.emit('end'));
+    }
+};
+
+Readable.prototype.on = function(type, listener) {
+    const result = Stream.prototype.on.call(this, type, listener);
+    if (type === 'data' && this._readableState.flowing !== false) {
+        this.resume();
+    }
+    return result;
+};
+Readable.prototype.addListener = Readable.prototype.on;
+
+Readable.prototype.pause = function() {
+    this._readableState.flowing = false;
+    this.emit('pause');
+    return this;
+};
+
+Readable.prototype.resume = function() {
+    const state = this._readableState;
+    if (!state.flowing) {
+        state.flowing = true;
+        this.emit('resume');
+        nextTick(() => this._flow());
+    }
+    return this;
+};
+
+Readable.prototype.isPaused = function() {
+    return this._readableState.flowing === false;
+};
+
+Readable.prototype.pipe = function(dest, options) {
+    const src = this;
+    const endDest = !options || options.end !== false;
+
+    src.on('data', (chunk) => {
+        if (dest.write(chunk) === false) {
+            src.pause();
+        }
+    });
+    dest.on('drain', () => src.resume());
+    if (endDest) {
+        src.on('end', () => dest.end());
+    }
+
+    dest.emit('pipe', src);
+    return dest;
+};
+
+Readable.prototype.destroy = function(err) {
+    const state = this._readableState;
+    if (state.destroyed) {
+        return this;
+    }
+    state.destroyed = true;
+    const finish = (error) => {
+        if (error) {
+            this.emit('error', error);
+        }
+        this.emit('close');
+    };
+    if (this._destroy) {
+        this._destroy(err || null, finish);
+    } else {
+        nextTick(() => finish(err));
+    }
+    return this;
+};
+
+Readable.from = function(iterable, options) {
+    const iterator = iterable[Symbol.iterator]();
+    return new Readable(Object.assign({ objectMode: true }, options, {
+        read() {
+            const next = iterator.next();
+            this.push(next.done ? null : next.value);
+        },
+    }));
+};
+
+// Writable
+
+function Writable(options) {
+    if (!(this instanceof Writable) && !(this instanceof Duplex)) {
+        return new Writable(options);
+    }
+    options = options || {};
+    Stream.call(this, options);
+
+    this._writableState = new WritableState(options);
+
+    if (typeof options.write === 'function') {
+        this._write = options.write;
+    }
+    if (typeof options.writev === 'function') {
+        this._writev = options.writev;
+    }
+    if (typeof options.final === 'function') {
+        this._final = options.final;
+    }
+    if (typeof options.destroy === 'function') {
+        this._destroy = options.destroy;
+    }
+}
+Object.setPrototypeOf(Writable.prototype, Stream.prototype);
+Object.setPrototypeOf(Writable, Stream);
+
+Writable.prototype._write = function(chunk, encoding, callback) {
+    throw new Error('The _write() method is not implemented');
+};
+
+Writable.prototype.write = function(chunk, encoding, callback) {
+    const state = this._writableState;
+    if (typeof encoding === 'function') {
+        callback = encoding;
+        encoding = undefined;
+    }
+    if (state.ending) {
+        const err = new Error('write after end');
+        nextTick(() => this.emit('error', err));
+        return false;
+    }
+
+    // The entry is queued, but sized by its chunk
+    const ret = state.buffer.push({ chunk, encoding, callback }, chunk);
+    if (!state.writing && state.corked === 0) {
+        this._writeNext();
+    }
+    return ret;
+};
+
+Writable.prototype._writeNext = function() {
+    const state = this._writableState;
+    if (state.buffer.count() === 0) {
+        // Deferred, as the write that filled the buffer may not have returned yet
+        if (state.buffer.takeDrain()) {
+            nextTick(() => this.emit('drain'));
+        }
+        if (state.ending) {
+            this._finish();
+        }
+        return;
+    }
+
+    // Streams with _writev() take everything buffered (say, while corked) at once
+    if (this._writev && state.buffer.count() > 1) {
+        const entries = state.buffer.takeAll();
+        state.writing = true;
+        this._writev(entries, (err) => {
+            state.writing = false;
+            state.buffer.done(entries.length);
+            for (const entry of entries) {
+                if (entry.callback) {
+                    entry.callback(err);
+                }
+            }
+            if (err) {
+                this.emit('error', err);
+                return;
+            }
+            this._writeNext();
+        });
+        return;
+    }
+
+    const entry = state.buffer.take();
+    state.writing = true;
+    this._write(entry.chunk, entry.encoding || 'utf8', (err) => {
+        state.writing = false;
+        state.buffer.done(1);
+        if (entry.callback) {
+            entry.callback(err);
+        }
+        if (err) {
+            this.emit('error', err);
+            return;
+        }
+        this._writeNext();
+    });
+};
+
+Writable.prototype._finish = function() {
+    const state = this._writableState;
+    if (state.finished) {
+        return;
+    }
+    const done = (err) => {
+        if (err) {
+            this.emit('error', err);
+            return;
+        }
+        state.finished = true;
+        this.emit('finish');
+    };
+    if (this._final) {
+        this._final(done);
+    } else {
+        nextTick(() => done());
+    }
+};
+
+Writable.prototype.cork = function() {
+    this._writableState.corked++;
+};
+
+Writable.prototype.uncork = function() {
+    const state = this._writableState;
+    if (state.corked > 0 && --state.corked === 0 && !state.writing) {
+        this._writeNext();
+    }
+};
+
+Writable.prototype.end = function(chunk, encoding, callback) {
+    const state = this._writableState;
+    if (typeof chunk === 'function') {
+        callback = chunk;
+        chunk = undefined;
+    } else if (typeof encoding === 'function') {
+        callback = encoding;
+        encoding = undefined;
+    }
+    if (chunk !== undefined && chunk !== null) {
+        this.write(chunk, encoding);
+    }
+    if (callback) {
+        this.once('finish', callback);
+    }
+    if (!state.ending) {
+        state.ending = true;
+        state.corked = 0;
+        if (!state.writing) {
+            this._writeNext();
+        }
+    }
+    return this;
+};
+
+Writable.prototype.destroy = function(err) {
+    const state = this._writableState;
+    if (state.destroyed) {
+        return this;
+    }
+    state.destroyed = true;
+    const finish = (error) => {
+        if (error) {
+            this.emit('error', error);
+        }
+        this.emit('close');
+    };
+    if (this._destroy) {
+        this._destroy(err || null, finish);
+    } else {
+        nextTick(() => finish(err));
+    }
+    return this;
+};
+
+// Duplex
+
+function Duplex(options) {
+    if (!(this instanceof Duplex)) {
+        return new Duplex(options);
+    }
+    Readable.call(this, options);
+    Writable.call(this, options);
+}
+Object.setPrototypeOf(Duplex.prototype, Readable.prototype);
+Object.setPrototypeOf(Duplex, Readable);
+for (const method of ['write', '_writeNext', '_finish', 'cork', 'uncork', 'end']) {
+    Duplex.prototype[method] = Writable.prototype[method];
+}
+Duplex.prototype._write = Writable.prototype._write;
+
+// Transform
+
+function Transform(options) {
+    if (!(this instanceof Transform)) {
+        return new Transform(options);
+    }
+    options = options || {};
+    Duplex.call(this, options);
+
+    if (typeof options.transform === 'function') {
+        this._transform = options.transform;
+    }
+    if (typeof options.flush === 'function') {
+        this._flush = options.flush;
+    }
+
+    // Readable side ends once the writable side has finished and flushed
+    this._final = (done) => {
+        const finish = (err, data) => {
+            if (data !== undefined && data !== null) {
+                this.push(data);
+            }
+            this.push(null);
+            done(err);
+        };
+        if (this._flush) {
+            this._flush(finish);
+        } else {
+            finish();
+        }
+    };
+}
+Object.setPrototypeOf(Transform.prototype, Duplex.prototype);
+Object.setPrototypeOf(Transform, Duplex);
+
+Transform.prototype._transform = function(chunk, encoding, callback) {
+    throw new Error('The _transform() method is not implemented');
+};
+
+Transform.prototype._write = function(chunk, encoding, callback) {
+    this._transform(chunk, encoding, (err, data) => {
+        if (data !== undefined && data !== null) {
+            this.push(data);
+        }
+        callback(err);
+    });
+};
+
+Transform.prototype._read = function() {
+};
+
+function PassThrough(options) {
+    if (!(this instanceof PassThrough)) {
+        return new PassThrough(options);
+    }
+    Transform.call(this, options);
+}
+Object.setPrototypeOf(PassThrough.prototype, Transform.prototype);
+Object.setPrototypeOf(PassThrough, Transform);
+
+PassThrough.prototype._transform = function(chunk, encoding, callback) {
+    callback(null, chunk);
+};
+
+// Create an Error for a failed native pipe
+function pipeException(status) {
+    const code = require('internal/net').errname(status);
+    const error = new Error('pipe ' + code);
+    error.errno = status;
+    error.code = code;
+    error.syscall = 'pipe';
+    return error;
+}
+
+// Pipe src to dest in native code if both are backed by native handles
+//
+// The pipe reads into its own buffers and writes them straight to the
+// sink, so no chunk passes through JavaScript; the streams are told when
+// it starts and ends, and dest is ended once src has been read to the end.
+function nativePipe(src, dest, done) {
+    if (typeof src._nativeStreamHandle !== 'function' || typeof dest._nativeStreamHandle !== 'function') {
+        return false;
+    }
+    const source = src._nativeStreamHandle('read');
+    const sink = source ? dest._nativeStreamHandle('write') : null;
+    if (!sink) {
+        return false;
+    }
+
+    // Buffers of 64 KB in flight before the source is paused
+    const buffers = Math.max(2, Math.ceil(src._readableState.highWaterMark / 65536));
+    const err = binding.pipe(source, sink, buffers, (status) => {
+        src._nativePipeEnd('read', status === 0);
+        dest._nativePipeEnd('write', false);
+        if (status < 0) {
+            done(pipeException(status));
+            return;
+        }
+        dest.end();
+    });
+    if (err < 0) {
+        return false;
+    }
+    src._nativePipeStart('read');
+    dest._nativePipeStart('write');
+    dest.emit('pipe', src);
+    return true;
+}
+
+// Pipe streams together, forwarding errors and cleaning up on failure
+function pipeline(...streams) {
+    const callback = typeof streams[streams.length - 1] === 'function' ? streams.pop() : null;
+    if (streams.length < 2) {
+        throw new Error('pipeline() requires at least two streams');
+    }
+
+    let finished = false;
+    const done = (err) => {
+        if (finished) {
+            return;
+        }
+        finished = true;
+        if (err) {
+            for (const stream of streams) {
+                stream.destroy();
+            }
+        }
+        if (callback) {
+            callback(err);
+        }
+    };
+
+    for (const stream of streams) {
+        stream.on('error', done);
+    }
+    if (streams.length !== 2 || !nativePipe(streams[0], streams[1], done)) {
+        for (let i = 0; i < streams.length - 1; i++) {
+            streams[i].pipe(streams[i + 1]);
+        }
+    }
+
+    const last = streams[streams.length - 1];
+    last.on(last._writableState ? 'finish' : 'end', () => done());
+    return last;
+}
+
+Stream.Stream = Stream;
+Stream.Readable = Readable;
+Stream.Writable = Writable;
+Stream.Duplex = Duplex;
+Stream.Transform = Transform;
+Stream.PassThrough = PassThrough;
+Stream.pipeline = pipeline;
+
+module.exports = Stream;
@@ -0,0 +1,148 @@
+// Util module
+//
+// Helpers compatible with Node.js's util module. Built into the runtime
+// binary and served by require('util'). TextEncoder and TextDecoder are
+// also installed as globals.
+
+const binding = require('internal/util');
+
+// Render a value for log output; the walk and layout are native
+function inspect(value, options) {
+    const depth = options && options.depth !== undefined ? options.depth : 2;
+    return binding.inspect(value, depth);
+}
+
+// printf-style formatting with %s, %d, %i, %f, %j, %o, %O, %c and %%
+const format = binding.format;
+
+function inherits(ctor, superCtor) {
+    Object.defineProperty(ctor, 'super_', { value: superCtor, writable: true, configurable: true });
+    Object.setPrototypeOf(ctor.prototype, superCtor.prototype);
+}
+
+function promisify(original) {
+    if (typeof original !== 'function') {
+        throw new TypeError('The "original" argument must be of type function');
+    }
+    return function(...args) {
+        return new Promise((resolve, reject) => {
+            original.call(this, ...args, (err, value) => {
+                if (err) {
+                    reject(err);
+                } else {
+                    resolve(value);
+                }
+            });
+        });
+    };
+}
+
+function deprecate(fn, message) {
+    let warned = false;
+    return function(...args) {
+        if (!warned) {
+            warned = true;
+            print('DeprecationWarning: ' + message);
+        }
+        return fn.apply(this, args);
+    };
+}
+
+// WHATWG encoding labels accepted by TextDecoder, by canonical name
+const decoderLabels = {
+    'utf-8': ['utf-8', 'utf8', 'unicode-1-1-utf-8', 'unicode11utf8', 'unicode20utf8', 'x-unicode20utf8'],
+    'utf-16le': ['utf-16le', 'utf-16', 'ucs-2', 'unicode', 'csunicode', 'iso-10646-ucs-2', 'unicodefeff'],
+    'windows-1252': ['windows-1252', 'latin1', 'iso-8859-1', 'ascii', 'us-ascii', 'cp1252', 'cp819',
+                     'csisolatin1', 'ibm819', 'iso8859-1', 'iso88591', 'iso_8859-1', 'iso_8859-1:1987',
+                     'iso-ir-100', 'l1', 'x-cp1252'],
+};
+
+let encodingBinding;
+let labelToEncoding;
+
+// Load the native encoder lazily so plain require('util') stays cheap
+function getEncodingBinding() {
+    if (!encodingBinding) {
+        encodingBinding = require('internal/encoding');
+        labelToEncoding = Object.create(null);
+        for (const name of Object.keys(decoderLabels)) {
+            for (const label of decoderLabels[name]) {
+                labelToEncoding[label] = name;
+            }
+        }
+    }
+    return encodingBinding;
+}
+
+const encodeIntoResults = new Uint32Array(2);
+
+class TextEncoder {
+    get encoding() {
+        return 'utf-8';
+    }
+
+    encode(input = '') {
+        return getEncodingBinding().encode(String(input));
+    }
+
+    encodeInto(source, destination) {
+        if (!(destination instanceof Uint8Array)) {
+            throw new TypeError('The "destination" argument must be an instance of Uint8Array');
+        }
+        getEncodingBinding().encodeInto(String(source), destination, encodeIntoResults);
+        return { read: encodeIntoResults[0], written: encodeIntoResults[1] };
+    }
+}
+
+const kDecodeFatal = 1;
+const kDecodeIgnoreBom = 2;
+const kDecodeStream = 4;
+
+class TextDecoder {
+    constructor(label = 'utf-8', options = {}) {
+        const binding = getEncodingBinding();
+        const encoding = labelToEncoding[String(label).trim().toLowerCase()];
+        if (encoding === undefined) {
+            throw new RangeError('The "' + label + '" encoding is not supported');
+        }
+        this._encoding = encoding;
+        this._code = binding.encodings[encoding];
+        this._flags = (options && options.fatal ? kDecodeFatal : 0) |
+                      (options && options.ignoreBOM ? kDecodeIgnoreBom : 0);
+        // Bytes of a character split across chunks, kept by the native decoder
+        this._state = new Uint8Array(8);
+    }
+
+    get encoding() {
+        return this._encoding;
+    }
+
+    get fatal() {
+        return (this._flags & kDecodeFatal) !== 0;
+    }
+
+    get ignoreBOM() {
+        return (this._flags & kDecodeIgnoreBom) !== 0;
+    }
+
+    decode(input = new Uint8Array(0), options = {}) {
+        if (input instanceof ArrayBuffer ||
+            (typeof SharedArrayBuffer !== 'undefined' && input instanceof SharedArrayBuffer)) {
+            input = new Uint8Array(input);
+        } else if (!ArrayBuffer.isView(input)) {
+            throw new TypeError('The "input" argument must be an instance of ArrayBuffer or ArrayBufferView');
+        }
+        const flags = this._flags | (options && options.stream ? kDecodeStream : 0);
+        return encodingBinding.decode(this._state, input, this._code, flags);
+    }
+}
+
+module.exports = {
+    inspect,
+    format,
+    inherits,
+    promisify,
+    deprecate,
+    TextEncoder,
+    TextDecoder,
+};
@@ -0,0 +1,136 @@
+// Vm module
+//
+// Script, createContext and the run* functions compatible with Node.js's vm
+// module. A Script is compiled once and can run in any number of contexts;
+// its code cache can be saved and passed back as cachedData to skip
+// compiling the same source again. A run given a timeout is stopped by a
+// watchdog thread once it expires. New contexts are taken from a pool of
+// ready ones, so createContext() is cheap enough to call per request.
+// Built into the runtime binary and served by require('vm').
+
+const binding = require('internal/vm');
+const { Buffer } = require('buffer');
+
+function toBuffer(array) {
+    return Buffer.from(array.buffer, array.byteOffset, array.length);
+}
+
+function validateContext(contextifiedObject) {
+    if (!binding.isContext(contextifiedObject)) {
+        throw new TypeError('The "contextifiedObject" argument must be an vm.Context');
+    }
+}
+
+function getOptions(options) {
+    if (typeof options === 'string') {
+        return { filename: options };
+    }
+    return options || {};
+}
+
+// Milliseconds a run may take, or 0 for no limit
+function getTimeout(options) {
+    const timeout = getOptions(options).timeout;
+    if (timeout === undefined) {
+        return 0;
+    }
+    if (typeof timeout !== 'number') {
+        const error = new TypeError('The "options.timeout" property must be of type number');
+        error.code = 'ERR_INVALID_ARG_TYPE';
+        throw error;
+    }
+    if (!Number.isInteger(timeout) || timeout <= 0) {
+        const error = new RangeError('The value of "options.timeout" is out of range. ' +
+            'It must be a positive integer. Received ' + timeout);
+        error.code = 'ERR_OUT_OF_RANGE';
+        throw error;
+    }
+    return timeout;
+}
+
+// Script
+
+function Script(code, options) {
+    if (!(this instanceof Script)) {
+        throw new TypeError("Class constructor Script cannot be invoked without 'new'");
+    }
+    options = getOptions(options);
+    const cachedData = options.cachedData;
+    if (cachedData !== undefined && !ArrayBuffer.isView(cachedData)) {
+        throw new TypeError('The "options.cachedData" property must be a Buffer, TypedArray or DataView');
+    }
+
+    this._script = new binding.ContextifyScript(
+        String(code),
+        options.filename === undefined ? 'evalmachine.<anonymous>' : String(options.filename),
+        options.lineOffset | 0,
+        options.columnOffset | 0,
+        cachedData,
+        !!options.produceCachedData);
+    if (cachedData !== undefined) {
+        this.cachedDataRejected = this._script.cachedDataRejected;
+    }
+    if (options.produceCachedData) {
+        this.cachedData = toBuffer(this._script.cachedData);
+        this.cachedDataProduced = this.cachedData.length > 0;
+    }
+}
+
+Script.prototype.runInThisContext = function(options) {
+    return this._script.run(null, getTimeout(options));
+};
+
+Script.prototype.runInContext = function(contextifiedObject, options) {
+    validateContext(contextifiedObject);
+    return this._script.run(contextifiedObject, getTimeout(options));
+};
+
+Script.prototype.runInNewContext = function(contextObject, options) {
+    return this.runInContext(createContext(contextObject), options);
+};
+
+Script.prototype.createCachedData = function() {
+    return toBuffer(this._script.createCachedData());
+};
+
+// Contexts
+
+function createContext(contextObject) {
+    if (contextObject === undefined) {
+        contextObject = {};
+    }
+    if (typeof contextObject !== 'object' || contextObject === null) {
+        throw new TypeError('The "contextObject" argument must be of type object');
+    }
+    binding.makeContext(contextObject);
+    return contextObject;
+}
+
+function isContext(object) {
+    if (typeof object !== 'object' || object === null) {
+        throw new TypeError('The "object" argument must be of type object');
+    }
+    return binding.isContext(object);
+}
+
+function runInContext(code, contextifiedObject, options) {
+    validateContext(contextifiedObject);
+    return new Script(code, options).runInContext(contextifiedObject, options);
+}
+
+function runInNewContext(code, contextObject, options) {
+    return new Script(code, options).runInNewContext(contextObject, options);
+}
+
+function runInThisContext(code, options) {
+    return new Script(code, options).runInThisContext(options);
+}
+
+module.exports = {
+    Script,
+    createContext,
+    isContext,
+    runInContext,
+    runInNewContext,
+    runInThisContext,
+};
@@ -0,0 +1,49 @@
+// Wasm module
+//
+// Loading WebAssembly modules from .wasm files. source(path) names a file
+// for WebAssembly.compileStreaming() and instantiateStreaming(), which read
+// it on the thread pool and compile it while it is being read. Compiled
+// modules are cached on disk and reused by later runs as long as the file
+// is unchanged, so hot numeric kernels are not recompiled at every start.
+// Built into the runtime binary and served by require('wasm').
+
+const binding = require('internal/wasm');
+
+function validatePath(path) {
+    if (typeof path !== 'string') {
+        throw new TypeError('The "path" argument must be of type string');
+    }
+}
+
+// A .wasm file, to pass where fetch() would give a Response elsewhere
+function source(path) {
+    validatePath(path);
+    return new binding.WasmSource(path);
+}
+
+function compileFile(path) {
+    return WebAssembly.compileStreaming(source(path));
+}
+
+// Resolves to { module, instance }
+function instantiateFile(path, imports) {
+    return WebAssembly.instantiateStreaming(source(path), imports);
+}
+
+function setCacheDirectory(directory) {
+    if (directory !== null && typeof directory !== 'string') {
+        throw new TypeError('The "directory" argument must be a string or null');
+    }
+    binding.setCacheDirectory(directory);
+}
+
+module.exports = {
+    WasmSource: binding.WasmSource,
+    source,
+    compileFile,
+    instantiateFile,
+    setCacheDirectory,
+    cacheDirectory: binding.cacheDirectory,
+    flushCache: binding.flushCache,
+    stats: binding.stats,
+};
@@ -0,0 +1,195 @@
+// Workerpool module
+//
+// Pools of warm worker runtimes for CPU-bound JavaScript. pool.run(task,
+// args) runs task, a function or the path of a module exporting one, on
+// one of a fixed set of workers and returns a promise of its result.
+// Arguments and results are structured clones; ArrayBuffers listed in
+// options.transfer (or returned through workerpool.transfer()) are moved
+// instead of copied. Tasks can be cancelled or given a timeout, and
+// pool.stats() reports queue depths and task counts. Built into the
+// runtime binary and served by require('workerpool').
+
+const binding = require('internal/workerpool');
+const { TASK_OK, TASK_ERROR, TASK_TIMED_OUT } = binding.constants;
+
+function makeError(message, code) {
+    const error = new Error(message);
+    error.code = code;
+    return error;
+}
+
+function oncomplete(id, status, value) {
+    const pool = this.owner;
+    const task = pool._tasks.get(id);
+    if (!task) {
+        return;
+    }
+    pool._tasks.delete(id);
+    if (status === TASK_OK) {
+        task.resolve(value);
+    } else if (status === TASK_ERROR) {
+        task.reject(value);
+    } else if (status === TASK_TIMED_OUT) {
+        task.reject(makeError('Task timed out after ' + task.timeout + ' ms', 'ERR_WORKERPOOL_TIMEOUT'));
+    } else {
+        task.reject(makeError('Task was cancelled', 'ERR_WORKERPOOL_CANCELLED'));
+    }
+}
+
+binding.setup({ oncomplete });
+
+// A task result whose ArrayBuffers in transferList are moved to the caller
+function Transfer(value, transferList) {
+    this.value = value;
+    this.transferList = transferList || [];
+}
+
+function transfer(value, transferList) {
+    return new Transfer(value, transferList);
+}
+
+// WorkerPool
+
+function WorkerPool(options) {
+    if (!(this instanceof WorkerPool)) {
+        return new WorkerPool(options);
+    }
+    options = options || {};
+    const size = options.size === undefined ? binding.defaultSize : options.size;
+    if (!Number.isInteger(size) || size < 1) {
+        throw new RangeError('The value of "options.size" is out of range. Received ' + size);
+    }
+    const affinity = options.affinity;
+    if (affinity !== undefined && typeof affinity !== 'string') {
+        throw new TypeError('The "options.affinity" property must be of type string. Received ' + typeof affinity);
+    }
+    this.size = size;
+    this._handle = new binding.WorkerPool(size, affinity);
+    this._handle.owner = this;
+    this._tasks = new Map();
+    this._nextId = 1;
+}
+
+// Run task(...args) on a worker; the promise also has a cancel() method
+WorkerPool.prototype.run = function(task, args, options) {
+    options = options || {};
+    if (!this._handle) {
+        return Promise.reject(makeError('Worker pool has been terminated', 'ERR_WORKERPOOL_TERMINATED'));
+    }
+
+    let code;
+    let isPath = false;
+    if (typeof task === 'function') {
+        code = '(' + task.toString() + ')';
+    } else if (typeof task === 'string') {
+        code = task + '#' + (options.method || '');
+        isPath = true;
+    } else {
+        throw new TypeError('The "task" argument must be a function or a module path');
+    }
+    if (args === undefined) {
+        args = [];
+    } else if (!Array.isArray(args)) {
+        throw new TypeError('The "args" argument must be an array');
+    }
+    const timeout = options.timeout === undefined ? 0 : options.timeout;
+    if (typeof timeout !== 'number' || !(timeout >= 0)) {
+        throw new RangeError('The value of "options.timeout" is out of range. Received ' + timeout);
+    }
+
+    const id = this._nextId++;
+    let entry;
+    const promise = new Promise((resolve, reject) => {
+        entry = { resolve, reject, timeout };
+    });
+    this._handle.submit(id, code, isPath, args, options.transfer || [], timeout);
+    this._tasks.set(id, entry);
+    promise.cancel = () => this._handle !== null && this._handle.cancel(id);
+    return promise;
+};
+
+// Worker count, queue depths and task counters
+WorkerPool.prototype.stats = function() {
+    if (!this._handle) {
+        return { workers: 0, queued: 0, running: 0, pending: 0 };
+    }
+    const stats = this._handle.stats();
+    stats.pending = this._tasks.size;
+    return stats;
+};
+
+// Stop the workers; tasks still queued or running are rejected as cancelled
+WorkerPool.prototype.terminate = function() {
+    if (this._handle) {
+        const handle = this._handle;
+        this._handle = null;
+        handle.terminate();
+    }
+    return Promise.resolve();
+};
+
+function createPool(options) {
+    return new WorkerPool(options);
+}
+
+// Worker side: each worker runtime calls this once, at startup
+
+function settle(id, value, done) {
+    if (value instanceof Transfer) {
+        done(id, true, value.value, value.transferList);
+    } else {
+        done(id, true, value);
+    }
+}
+
+function setupWorker() {
+    const loaded = new Map();
+
+    // Functions are compiled once per worker and reused for every task with the same source
+    function load(code, isPath) {
+        const key = (isPath ? 'path:' : 'code:') + code;
+        let fn = loaded.get(key);
+        if (fn !== undefined) {
+            return fn;
+        }
+        if (isPath) {
+            const separator = code.lastIndexOf('#');
+            const exported = require(code.slice(0, separator));
+            const method = code.slice(separator + 1);
+            fn = method ? exported[method] : exported;
+            if (typeof fn !== 'function' && !method && exported) {
+                fn = exported.default;
+            }
+        } else {
+            fn = new Function('return ' + code)();
+        }
+        if (typeof fn !== 'function') {
+            throw new TypeError('Task ' + code + ' is not a function');
+        }
+        loaded.set(key, fn);
+        return fn;
+    }
+
+    binding.setupWorker(function dispatch(id, code, isPath, args, done) {
+        let result;
+        try {
+            result = load(code, isPath).apply(undefined, args);
+        } catch (error) {
+            done(id, false, error);
+            return;
+        }
+        if (result !== null && typeof result === 'object' && typeof result.then === 'function') {
+            Promise.resolve(result).then((value) => settle(id, value, done), (error) => done(id, false, error));
+        } else {
+            settle(id, result, done);
+        }
+    });
+}
+
+module.exports = {
+    WorkerPool,
+    createPool,
+    transfer,
+    isWorker: binding.isWorker(),
+    _setupWorker: setupWorker,
+};
@@ -0,0 +1,190 @@
+// Zlib module
+//
+// Node.js-compatible gzip, deflate and raw deflate on top of the system
+// zlib (internal/zlib). Every format has a synchronous function, an
+// asynchronous one that compresses on the thread pool, and a Transform
+// stream. Built into the runtime binary and served by require('zlib').
+
+const binding = require('internal/zlib');
+const { Buffer } = require('buffer');
+const { Transform } = require('stream');
+
+const constants = binding.constants;
+const emptyBuffer = Buffer.alloc(0);
+
+// Wrap a native result without copying it
+function toBuffer(array) {
+    return Buffer.from(array.buffer, array.byteOffset, array.length);
+}
+
+function toInput(data) {
+    if (typeof data === 'string') {
+        return Buffer.from(data);
+    }
+    if (data instanceof ArrayBuffer) {
+        return new Uint8Array(data);
+    }
+    if (ArrayBuffer.isView(data)) {
+        return data;
+    }
+    throw new TypeError('The "buffer" argument must be of type string, Buffer, TypedArray, DataView or ArrayBuffer');
+}
+
+function checkRange(options, name, min, max, fallback) {
+    const value = options[name];
+    if (value === undefined) {
+        return fallback;
+    }
+    if (!Number.isInteger(value) || value < min || value > max) {
+        throw new RangeError('The value of "options.' + name + '" is out of range. It must be >= ' + min +
+                             ' and <= ' + max + '. Received ' + value);
+    }
+    return value;
+}
+
+// Turn options into the arguments the native functions take after the data
+function params(mode, options) {
+    options = options || {};
+    const isInflate = mode === constants.INFLATE || mode === constants.GUNZIP || mode === constants.UNZIP;
+    let windowBits = checkRange(options, 'windowBits', isInflate ? 0 : constants.Z_MIN_WINDOWBITS,
+                                constants.Z_MAX_WINDOWBITS, constants.Z_DEFAULT_WINDOWBITS);
+    // zlib no longer supports 8 for raw deflate and silently uses 9
+    if (mode === constants.DEFLATERAW && windowBits === 8) {
+        windowBits = 9;
+    }
+    return [
+        mode,
+        checkRange(options, 'level', constants.Z_MIN_LEVEL, constants.Z_MAX_LEVEL, constants.Z_DEFAULT_LEVEL),
+        windowBits,
+        checkRange(options, 'memLevel', constants.Z_MIN_MEMLEVEL, constants.Z_MAX_MEMLEVEL,
+                   constants.Z_DEFAULT_MEMLEVEL),
+        checkRange(options, 'strategy', constants.Z_DEFAULT_STRATEGY, constants.Z_FIXED,
+                   constants.Z_DEFAULT_STRATEGY),
+    ];
+}
+
+function processSync(mode, buffer, options) {
+    return toBuffer(binding.processSync(toInput(buffer), ...params(mode, options)));
+}
+
+function processAsync(mode, buffer, options, callback) {
+    if (typeof options === 'function') {
+        callback = options;
+        options = {};
+    }
+    if (typeof callback !== 'function') {
+        throw new TypeError('The "callback" argument must be of type function');
+    }
+    binding.process(toInput(buffer), ...params(mode, options)).then(
+        (result) => callback(null, toBuffer(result)),
+        (err) => callback(err));
+}
+
+// Flush requests travel through the writable queue so they stay in order
+function FlushRequest(kind) {
+    this.kind = kind;
+}
+
+// Base class of the compression streams
+function Zlib(mode, options) {
+    options = options || {};
+    Transform.call(this, options);
+    this._handle = binding.createContext(...params(mode, options));
+    this._defaultFlush = options.flush !== undefined ? options.flush : constants.Z_NO_FLUSH;
+    this._finishFlush = options.finishFlush !== undefined ? options.finishFlush : constants.Z_FINISH;
+    this.bytesWritten = 0;
+}
+Object.setPrototypeOf(Zlib.prototype, Transform.prototype);
+Object.setPrototypeOf(Zlib, Transform);
+
+Zlib.prototype._transform = function(chunk, encoding, callback) {
+    if (chunk instanceof FlushRequest) {
+        this._processChunk(emptyBuffer, chunk.kind, callback);
+        return;
+    }
+    if (typeof chunk === 'string') {
+        chunk = Buffer.from(chunk, encoding);
+    }
+    chunk = toInput(chunk);
+    this.bytesWritten += chunk.byteLength;
+    this._processChunk(chunk, this._defaultFlush, callback);
+};
+
+Zlib.prototype._flush = function(callback) {
+    this._processChunk(emptyBuffer, this._finishFlush, callback);
+};
+
+// Each chunk is (de)compressed on the thread pool
+Zlib.prototype._processChunk = function(chunk, flush, callback) {
+    if (!this._handle) {
+        callback(new Error('zlib binding closed'));
+        return;
+    }
+    this._handle.writeAsync(chunk, flush).then(
+        (output) => callback(null, output.length > 0 ? toBuffer(output) : null),
+        (err) => callback(err));
+};
+
+Zlib.prototype._destroy = function(err, callback) {
+    this.close();
+    callback(err);
+};
+
+Zlib.prototype.flush = function(kind, callback) {
+    if (typeof kind === 'function' || kind === undefined) {
+        callback = kind;
+        kind = constants.Z_FULL_FLUSH;
+    }
+    this.write(new FlushRequest(kind), callback);
+};
+
+Zlib.prototype.reset = function() {
+    if (this._handle) {
+        this._handle.reset();
+    }
+};
+
+Zlib.prototype.close = function(callback) {
+    if (this._handle) {
+        this._handle.close();
+        this._handle = null;
+    }
+    if (callback) {
+        setTimeout(callback, 0);
+    }
+};
+
+const zlib = {
+    constants,
+    crc32: binding.crc32,
+    Zlib,
+};
+
+const formats = [
+    ['Deflate', 'deflate', constants.DEFLATE],
+    ['Inflate', 'inflate', constants.INFLATE],
+    ['Gzip', 'gzip', constants.GZIP],
+    ['Gunzip', 'gunzip', constants.GUNZIP],
+    ['DeflateRaw', 'deflateRaw', constants.DEFLATERAW],
+    ['InflateRaw', 'inflateRaw', constants.INFLATERAW],
+    ['Unzip', 'unzip', constants.UNZIP],
+];
+
+for (const [className, name, mode] of formats) {
+    const Format = function(options) {
+        if (!(this instanceof Format)) {
+            return new Format(options);
+        }
+        Zlib.call(this, mode, options);
+    };
+    Object.setPrototypeOf(Format.prototype, Zlib.prototype);
+    Object.setPrototypeOf(Format, Zlib);
+    Object.defineProperty(Format, 'name', { value: className });
+
+    zlib[className] = Format;
+    zlib['create' + className] = (options) => new Format(options);
+    zlib[name] = (buffer, options, callback) => processAsync(mode, buffer, options, callback);
+    zlib[name + 'Sync'] = (buffer, options) => processSync(mode, buffer, options);
+}
+
+module.exports = zlib;
@@ -0,0 +1,207 @@
+#include "affinity.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+// Where Linux describes the NUMA topology
+static const char kNodeDirectory[] = "/sys/devices/system/node/node";
+
+// NUMA nodes and their CPUs, read once from sysfs
+struct NumaTopology {
+    std::vector<std::vector<int>> node_cpus;
+    std::vector<int> cpu_nodes;
+};
+
+// Parse a list such as "0-3,8,10-11"; false if it is malformed
+static bool ParseList(const std::string& list, std::vector<int>* values) {
+    values->clear();
+    size_t position = 0;
+    while (position < list.size()) {
+        size_t end = list.find(',', position);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = list.substr(position, end - position);
+        position = end + 1;
+        
+        char* rest = nullptr;
+        long first = std::strtol(item.c_str(), &rest, 10);
+        long last = first;
+        if (rest == item.c_str() || first < 0) {
+            return false;
+        }
+        if (*rest == '-') {
+            const char* range_end = rest + 1;
+            last = std::strtol(range_end, &rest, 10);
+            if (rest == range_end || last < first) {
+                return false;
+            }
+        }
+        if (*rest != '\0' && *rest != '\n') {
+            return false;
+        }
+        if (last >= CPU_SETSIZE) {
+            return false;
+        }
+        for (long value = first; value <= last; value++) {
+            values->push_back(static_cast<int>(value));
+        }
+    }
+    std::sort(values->begin(), values->end());
+    values->erase(std::unique(values->begin(), values->end()), values->end());
+    return !values->empty();
+}
+
+// Read the nodes from sysfs, or make one node of every CPU without NUMA information
+static const NumaTopology& GetTopology() {
+    static const NumaTopology topology = []() {
+        NumaTopology result;
+        for (int node = 0;; node++) {
+            std::ifstream file(kNodeDirectory + std::to_string(node) + "/cpulist");
+            std::string list;
+            if (!file.is_open() || !std::getline(file, list)) {
+                break;
+            }
+            std::vector<int> cpus;
+            ParseList(list, &cpus);
+            result.node_cpus.push_back(std::move(cpus));
+        }
+        if (result.node_cpus.empty()) {
+            std::vector<int> cpus;
+            unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned int cpu = 0; cpu < count; cpu++) {
+                cpus.push_back(static_cast<int>(cpu));
+            }
+            result.node_cpus.push_back(std::move(cpus));
+        }
+        
+        for (size_t node = 0; node < result.node_cpus.size(); node++) {
+            for (int cpu : result.node_cpus[node]) {
+                if (static_cast<size_t>(cpu) >= result.cpu_nodes.size()) {
+                    result.cpu_nodes.resize(cpu + 1, -1);
+                }
+                result.cpu_nodes[cpu] = static_cast<int>(node);
+            }
+        }
+        return result;
+    }();
+    return topology;
+}
+
+// Parse an affinity
+bool CpuAffinity::Parse(const std::string& spec, CpuAffinity* affinity, std::string* error) {
+    const NumaTopology& topology = GetTopology();
+    CpuAffinity result;
+    
+    if (spec.compare(0, 5, "node:") == 0) {
+        if (!ParseList(spec.substr(5), &result.nodes_)) {
+            *error = "Invalid NUMA node list: " + spec;
+            return false;
+        }
+        for (int node : result.nodes_) {
+            if (static_cast<size_t>(node) >= topology.node_cpus.size() || topology.node_cpus[node].empty()) {
+                *error = "No CPUs on NUMA node " + std::to_string(node);
+                return false;
+            }
+            result.node_cpus_.push_back(topology.node_cpus[node]);
+            result.cpus_.insert(result.cpus_.end(), topology.node_cpus[node].begin(),
+                                topology.node_cpus[node].end());
+        }
+        std::sort(result.cpus_.begin(), result.cpus_.end());
+    } else {
+        if (!ParseList(spec, &result.cpus_)) {
+            *error = "Invalid CPU list: " + spec;
+            return false;
+        }
+        for (int cpu : result.cpus_) {
+            if (static_cast<size_t>(cpu) >= topology.cpu_nodes.size() || topology.cpu_nodes[cpu] < 0) {
+                *error = "No such CPU: " + std::to_string(cpu);
+                return false;
+            }
+        }
+    }
+    
+    *affinity = std::move(result);
+    return true;
+}
+
+// Get the NUMA node a slot is pinned to
+int CpuAffinity::GetNodeForSlot(size_t slot) const {
+    if (nodes_.empty()) {
+        return -1;
+    }
+    return nodes_[slot % nodes_.size()];
+}
+
+// Get the CPUs a slot may run on
+const std::vector<int>& CpuAffinity::GetCpusForSlot(size_t slot) const {
+    if (node_cpus_.empty()) {
+        return cpus_;
+    }
+    return node_cpus_[slot % node_cpus_.size()];
+}
+
+// Pin the calling thread
+bool CpuAffinity::ApplyToCurrentThread(size_t slot) const {
+    if (!IsSet()) {
+        return true;
+    }
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : GetCpusForSlot(slot)) {
+        CPU_SET(cpu, &set);
+    }
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        std::cerr << "Failed to set CPU affinity " << ToString() << ": " << std::strerror(result) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Get the affinity as a string
+std::string CpuAffinity::ToString() const {
+    const std::vector<int>& values = nodes_.empty() ? cpus_ : nodes_;
+    std::string result = nodes_.empty() ? "" : "node:";
+    for (size_t i = 0; i < values.size(); i++) {
+        // Collapse runs of consecutive numbers into ranges
+        size_t last = i;
+        while (last + 1 < values.size() && values[last + 1] == values[last] + 1) {
+            last++;
+        }
+        if (i > 0) {
+            result += ',';
+        }
+        result += std::to_string(values[i]);
+        if (last > i) {
+            result += '-' + std::to_string(values[last]);
+        }
+        i = last;
+    }
+    return result;
+}
+
+// Get the number of NUMA nodes
+int GetNumaNodeCount() {
+    return static_cast<int>(GetTopology().node_cpus.size());
+}
+
+// Get the NUMA node the calling thread runs on
+int GetCurrentNumaNode() {
+    const NumaTopology& topology = GetTopology();
+    if (topology.node_cpus.size() == 1) {
+        return 0;
+    }
+    int cpu = sched_getcpu();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= topology.cpu_nodes.size() || topology.cpu_nodes[cpu] < 0) {
+        return 0;
+    }
+    return topology.cpu_nodes[cpu];
+}
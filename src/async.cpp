@@ -0,0 +1,155 @@
+#include "async.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Smallest buffer for reading a file whose size is not known up front
+static constexpr size_t kReadChunk = 64 * 1024;
+
+// Record the runtime and the context the coroutine was called from
+AsyncFrame::AsyncFrame() : isolate_(v8::Isolate::GetCurrent()) {
+    runtime_ = static_cast<Runtime*>(isolate_->GetData(0));
+    context_.Reset(isolate_, isolate_->GetEnteredOrMicrotaskContext());
+}
+
+// Resume the coroutine in the context it was called from
+void AsyncFrame::Resume(std::coroutine_handle<> handle) {
+    v8::HandleScope handle_scope(isolate_);
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    v8::Context::Scope context_scope(context);
+    
+    // The frame, and this object with it, may be gone once resume() returns
+    handle.resume();
+}
+
+// Destroy a coroutine that can no longer be woken up
+AsyncResumer::~AsyncResumer() {
+    if (!resumed_) {
+        handle_.destroy();
+    }
+}
+
+// Resume the coroutine
+void AsyncResumer::Resume() {
+    resumed_ = true;
+    frame_->Resume(handle_);
+}
+
+// Create the promise in the caller's context
+JsPromise::promise_type::promise_type() {
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    resolver_.Reset(isolate_, v8::Promise::Resolver::New(context).ToLocalChecked());
+}
+
+JsPromise JsPromise::promise_type::get_return_object() {
+    return JsPromise(resolver_.Get(isolate_)->GetPromise());
+}
+
+// Resolve the promise with the co_return value
+void JsPromise::promise_type::return_value(v8::Local<v8::Value> value) {
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    resolver_.Get(isolate_)->Resolve(context, value).Check();
+}
+
+// Reject the promise with the co_return reason
+void JsPromise::promise_type::return_value(Rejected rejected) {
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    resolver_.Get(isolate_)->Reject(context, rejected.reason).Check();
+}
+
+// Reject the promise with an Error for a C++ exception
+void JsPromise::promise_type::unhandled_exception() {
+    std::string message;
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        message = e.what();
+    } catch (...) {
+        message = "Unknown exception in async native function";
+    }
+    v8::Local<v8::Context> context = context_.Get(isolate_);
+    resolver_.Get(isolate_)->Reject(context, v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate_, message.c_str()).ToLocalChecked())).Check();
+}
+
+// Report a C++ exception, as the event loop does for its tasks
+void AsyncTask::promise_type::unhandled_exception() {
+    try {
+        throw;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in async task: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in async task" << std::endl;
+    }
+}
+
+// Start the timer that resumes a sleeping coroutine
+void Sleep::Start(std::shared_ptr<AsyncResumer> resumer) {
+    uint64_t task_id = resumer->GetRuntime()->ScheduleDelayedTask([resumer]() {
+        resumer->Resume();
+    }, delay_ms_);
+    if (timer_id_) {
+        *timer_id_ = task_id;
+    }
+}
+
+// Resume the coroutine as a continuation on the next loop iteration
+void YieldToLoop::Start(std::shared_ptr<AsyncResumer> resumer) {
+    resumer->GetRuntime()->GetEventLoop()->ScheduleContinuation([resumer]() {
+        resumer->Resume();
+    });
+}
+
+// Run work on the thread pool and resume the coroutine on the event loop
+void QueueAsyncWork(std::shared_ptr<AsyncResumer> resumer, std::function<void()> work) {
+    Runtime* runtime = resumer->GetRuntime();
+    runtime->QueueWork(std::move(work), [resumer]() {
+        resumer->Resume();
+    });
+}
+
+// Read a whole file
+std::string ReadFileContents(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open " + path + ": " + std::strerror(errno));
+    }
+    
+    // Regular files are read into one allocation, with a spare byte to see EOF
+    std::string contents;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode)) {
+        contents.resize(static_cast<size_t>(info.st_size) + 1);
+    }
+    
+    size_t length = 0;
+    while (true) {
+        if (length == contents.size()) {
+            contents.resize(std::max(contents.size() * 2, kReadChunk));
+        }
+        ssize_t count = read(fd, &contents[length], contents.size() - length);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            int error = errno;
+            close(fd);
+            throw std::runtime_error("Failed to read " + path + ": " + std::strerror(error));
+        }
+        if (count == 0) {
+            break;
+        }
+        length += static_cast<size_t>(count);
+    }
+    close(fd);
+    
+    contents.resize(length);
+    return contents;
+}
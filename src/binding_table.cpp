@@ -0,0 +1,54 @@
+#include "binding_table.h"
+#include <v8-fast-api-calls.h>
+#include <vector>
+
+// Tables registered by static BindingTableRegistration objects
+static std::vector<BindingTable>& RegisteredTables() {
+    static std::vector<BindingTable> tables;
+    return tables;
+}
+
+// Add one FunctionTemplate per entry
+void SetBindingMethods(v8::Isolate* isolate, v8::Local<v8::Template> target,
+                       BindingTable table, v8::Local<v8::Value> data) {
+    for (const NativeMethod& method : table) {
+        v8::Local<v8::String> name = v8::String::NewFromUtf8(
+            isolate, method.name, v8::NewStringType::kInternalized).ToLocalChecked();
+        v8::Local<v8::FunctionTemplate> function = v8::FunctionTemplate::New(
+            isolate, method.callback, data, v8::Local<v8::Signature>(), method.length,
+            v8::ConstructorBehavior::kThrow, method.side_effect, method.fast_function);
+        function->SetClassName(name);
+        target->Set(name, function, method.attributes);
+    }
+}
+
+// Build the exports template of a binding
+v8::Local<v8::ObjectTemplate> NewBindingTemplate(v8::Isolate* isolate, BindingTable table,
+                                                 v8::Local<v8::Value> data) {
+    v8::Local<v8::ObjectTemplate> exports = v8::ObjectTemplate::New(isolate);
+    SetBindingMethods(isolate, exports, table, data);
+    return exports;
+}
+
+BindingTableRegistration::BindingTableRegistration(BindingTable table) {
+    RegisteredTables().push_back(table);
+}
+
+// Collect the references once, after static initialization has registered every table
+const intptr_t* GetBindingExternalReferences() {
+    static const std::vector<intptr_t> references = []() {
+        std::vector<intptr_t> list;
+        for (const BindingTable& table : RegisteredTables()) {
+            for (const NativeMethod& method : table) {
+                list.push_back(reinterpret_cast<intptr_t>(method.callback));
+                if (method.fast_function) {
+                    list.push_back(reinterpret_cast<intptr_t>(method.fast_function->GetAddress()));
+                    list.push_back(reinterpret_cast<intptr_t>(method.fast_function->GetTypeInfo()));
+                }
+            }
+        }
+        list.push_back(0);
+        return list;
+    }();
+    return references.data();
+}
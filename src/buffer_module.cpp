@@ -0,0 +1,591 @@
+#include "buffer_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "encoding.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Encoding codes shared with lib/buffer.js through the encodings object
+enum BufferEncoding {
+    kEncodingUtf8 = 0,
+    kEncodingLatin1 = 1,
+    kEncodingAscii = 2,
+    kEncodingBase64 = 3,
+    kEncodingBase64Url = 4,
+    kEncodingHex = 5,
+    kEncodingUtf16Le = 6,
+};
+
+// Strings at least this long are handed to V8 as external strings instead of copied
+static constexpr size_t kExternalStringThreshold = 64 * 1024;
+
+// An external one-byte string that owns its characters
+class OwnedOneByteResource : public v8::String::ExternalOneByteStringResource {
+public:
+    explicit OwnedOneByteResource(std::string data) : data_(std::move(data)) {}
+    
+    const char* data() const override {
+        return data_.data();
+    }
+    
+    size_t length() const override {
+        return data_.size();
+    }
+
+private:
+    std::string data_;
+};
+
+// Create a one-byte string, avoiding a second copy of large strings
+static v8::MaybeLocal<v8::String> NewOneByteString(v8::Isolate* isolate, std::string data) {
+    if (data.size() >= kExternalStringThreshold) {
+        return v8::String::NewExternalOneByte(isolate, new OwnedOneByteResource(std::move(data)));
+    }
+    return v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t*>(data.data()),
+                                      v8::NewStringType::kNormal, static_cast<int>(data.size()));
+}
+
+// Get the bytes of a Uint8Array (or any ArrayBufferView)
+static bool GetBytes(v8::Local<v8::Value> value, uint8_t** data, size_t* length) {
+    if (!value->IsArrayBufferView()) {
+        return false;
+    }
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    *data = static_cast<uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+    *length = view->ByteLength();
+    return true;
+}
+
+// Read an integer argument clamped to [0, limit]
+static size_t ClampedArgument(v8::Local<v8::Context> context, v8::Local<v8::Value> value, size_t limit) {
+    if (!value->IsNumber()) {
+        return 0;
+    }
+    int64_t number = value->IntegerValue(context).FromMaybe(0);
+    if (number < 0) {
+        return 0;
+    }
+    return std::min<size_t>(static_cast<size_t>(number), limit);
+}
+
+// Copy a string's characters as one byte each (for base64 and hex input)
+static std::string OneByteCharacters(v8::Isolate* isolate, v8::Local<v8::String> string) {
+    std::string result(string->Length(), '\0');
+    string->WriteOneByte(isolate, reinterpret_cast<uint8_t*>(result.data()), 0, string->Length(),
+                         v8::String::NO_NULL_TERMINATION);
+    return result;
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// byteLength(string, encoding)
+static void ByteLength(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsInt32()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::Local<v8::String> string = args[0].As<v8::String>();
+    int length = string->Length();
+    double result = 0;
+    
+    switch (args[1]->Int32Value(context).FromJust()) {
+        case kEncodingUtf8:
+            result = string->Utf8Length(isolate);
+            break;
+        case kEncodingLatin1:
+        case kEncodingAscii:
+            result = length;
+            break;
+        case kEncodingUtf16Le:
+            result = 2.0 * length;
+            break;
+        case kEncodingHex:
+            result = length >> 1;
+            break;
+        case kEncodingBase64:
+        case kEncodingBase64Url: {
+            // Same estimate as Node.js: ignore up to two trailing '='
+            uint8_t tail[2] = {0, 0};
+            int tail_length = std::min(length, 2);
+            string->WriteOneByte(isolate, tail, length - tail_length, tail_length, v8::String::NO_NULL_TERMINATION);
+            int padding = 0;
+            if (tail_length == 2 && tail[1] == '=') {
+                padding = tail[0] == '=' ? 2 : 1;
+            } else if (tail_length >= 1 && tail[tail_length - 1] == '=') {
+                padding = 1;
+            }
+            result = static_cast<double>((static_cast<uint64_t>(length - padding) * 3) >> 2);
+            break;
+        }
+        default:
+            ThrowInvalidArguments(isolate);
+            return;
+    }
+    
+    args.GetReturnValue().Set(v8::Number::New(isolate, result));
+}
+
+// write(target, string, offset, length, encoding)
+static void Write(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* target;
+    size_t target_length;
+    if (args.Length() < 5 || !GetBytes(args[0], &target, &target_length) || !args[1]->IsString() ||
+        !args[4]->IsInt32()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::Local<v8::String> string = args[1].As<v8::String>();
+    size_t offset = ClampedArgument(context, args[2], target_length);
+    size_t capacity = ClampedArgument(context, args[3], target_length - offset);
+    uint8_t* output = target + offset;
+    size_t string_length = static_cast<size_t>(string->Length());
+    size_t written = 0;
+    
+    switch (args[4]->Int32Value(context).FromJust()) {
+        case kEncodingUtf8: {
+            // One-byte strings are usually ASCII: copy them straight in and
+            // check the result with the vectorized scan
+            if (string->IsOneByte()) {
+                size_t count = std::min(string_length, capacity);
+                string->WriteOneByte(isolate, output, 0, static_cast<int>(count), v8::String::NO_NULL_TERMINATION);
+                if (AsciiPrefixLength(output, count) == count) {
+                    written = count;
+                    break;
+                }
+            }
+            written = string->WriteUtf8(isolate, reinterpret_cast<char*>(output), static_cast<int>(capacity), nullptr,
+                                        v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+            break;
+        }
+        case kEncodingLatin1:
+        case kEncodingAscii: {
+            written = std::min(string_length, capacity);
+            string->WriteOneByte(isolate, output, 0, static_cast<int>(written), v8::String::NO_NULL_TERMINATION);
+            break;
+        }
+        case kEncodingUtf16Le: {
+            size_t count = std::min(string_length, capacity / 2);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+            if (reinterpret_cast<uintptr_t>(output) % alignof(uint16_t) == 0) {
+                string->Write(isolate, reinterpret_cast<uint16_t*>(output), 0, static_cast<int>(count),
+                              v8::String::NO_NULL_TERMINATION);
+                written = count * 2;
+                break;
+            }
+#endif
+            std::vector<uint16_t> units(count);
+            string->Write(isolate, units.data(), 0, static_cast<int>(count), v8::String::NO_NULL_TERMINATION);
+            for (size_t i = 0; i < count; i++) {
+                output[2 * i] = static_cast<uint8_t>(units[i]);
+                output[2 * i + 1] = static_cast<uint8_t>(units[i] >> 8);
+            }
+            written = count * 2;
+            break;
+        }
+        case kEncodingBase64:
+        case kEncodingBase64Url:
+        case kEncodingHex: {
+            std::string characters = OneByteCharacters(isolate, string);
+            const uint8_t* input = reinterpret_cast<const uint8_t*>(characters.data());
+            bool hex = args[4]->Int32Value(context).FromJust() == kEncodingHex;
+            
+            // Decode in place when the whole result fits
+            size_t bound = hex ? characters.size() / 2 : characters.size() / 4 * 3 + 3;
+            if (bound <= capacity) {
+                written = hex ? HexDecode(input, characters.size(), output)
+                              : Base64Decode(input, characters.size(), output);
+            } else {
+                std::vector<uint8_t> decoded(bound);
+                size_t count = hex ? HexDecode(input, characters.size(), decoded.data())
+                                   : Base64Decode(input, characters.size(), decoded.data());
+                written = std::min(count, capacity);
+                std::memcpy(output, decoded.data(), written);
+            }
+            break;
+        }
+        default:
+            ThrowInvalidArguments(isolate);
+            return;
+    }
+    
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(written)));
+}
+
+// toString(source, start, end, encoding)
+static void ToString(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* source;
+    size_t source_length;
+    if (args.Length() < 4 || !GetBytes(args[0], &source, &source_length) || !args[3]->IsInt32()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    size_t start = ClampedArgument(context, args[1], source_length);
+    size_t end = std::max(start, ClampedArgument(context, args[2], source_length));
+    const uint8_t* data = source + start;
+    size_t length = end - start;
+    
+    v8::MaybeLocal<v8::String> result;
+    switch (args[3]->Int32Value(context).FromJust()) {
+        case kEncodingUtf8: {
+            size_t ascii = AsciiPrefixLength(data, length);
+            if (ascii == length) {
+                result = v8::String::NewFromOneByte(isolate, data, v8::NewStringType::kNormal, static_cast<int>(length));
+                break;
+            }
+            std::unique_ptr<uint16_t[]> units(new uint16_t[length]);
+            size_t count = Utf8ToUtf16(data, length, units.get());
+            result = v8::String::NewFromTwoByte(isolate, units.get(), v8::NewStringType::kNormal, static_cast<int>(count));
+            break;
+        }
+        case kEncodingLatin1:
+            result = v8::String::NewFromOneByte(isolate, data, v8::NewStringType::kNormal, static_cast<int>(length));
+            break;
+        case kEncodingAscii: {
+            if (AsciiPrefixLength(data, length) == length) {
+                result = v8::String::NewFromOneByte(isolate, data, v8::NewStringType::kNormal, static_cast<int>(length));
+                break;
+            }
+            // Node.js drops the high bit of each byte
+            std::string characters(reinterpret_cast<const char*>(data), length);
+            for (char& c : characters) {
+                c &= 0x7f;
+            }
+            result = NewOneByteString(isolate, std::move(characters));
+            break;
+        }
+        case kEncodingUtf16Le: {
+            size_t count = length / 2;
+            std::unique_ptr<uint16_t[]> units(new uint16_t[count]);
+            for (size_t i = 0; i < count; i++) {
+                units[i] = static_cast<uint16_t>(data[2 * i] | (data[2 * i + 1] << 8));
+            }
+            result = v8::String::NewFromTwoByte(isolate, units.get(), v8::NewStringType::kNormal, static_cast<int>(count));
+            break;
+        }
+        case kEncodingBase64:
+        case kEncodingBase64Url: {
+            bool url = args[3]->Int32Value(context).FromJust() == kEncodingBase64Url;
+            std::string characters(Base64EncodedLength(length, url), '\0');
+            Base64Encode(data, length, characters.data(), url);
+            result = NewOneByteString(isolate, std::move(characters));
+            break;
+        }
+        case kEncodingHex: {
+            std::string characters(length * 2, '\0');
+            HexEncode(data, length, characters.data());
+            result = NewOneByteString(isolate, std::move(characters));
+            break;
+        }
+        default:
+            ThrowInvalidArguments(isolate);
+            return;
+    }
+    
+    v8::Local<v8::String> string;
+    if (!result.ToLocal(&string)) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Cannot create a string longer than the maximum length").ToLocalChecked()));
+        return;
+    }
+    args.GetReturnValue().Set(string);
+}
+
+// compare(a, aStart, aEnd, b, bStart, bEnd)
+static void Compare(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* a;
+    uint8_t* b;
+    size_t a_length;
+    size_t b_length;
+    if (args.Length() < 6 || !GetBytes(args[0], &a, &a_length) || !GetBytes(args[3], &b, &b_length)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    size_t a_start = ClampedArgument(context, args[1], a_length);
+    size_t a_end = std::max(a_start, ClampedArgument(context, args[2], a_length));
+    size_t b_start = ClampedArgument(context, args[4], b_length);
+    size_t b_end = std::max(b_start, ClampedArgument(context, args[5], b_length));
+    
+    size_t a_count = a_end - a_start;
+    size_t b_count = b_end - b_start;
+    int result = std::memcmp(a + a_start, b + b_start, std::min(a_count, b_count));
+    if (result == 0) {
+        result = a_count < b_count ? -1 : (a_count > b_count ? 1 : 0);
+    }
+    args.GetReturnValue().Set(result < 0 ? -1 : (result > 0 ? 1 : 0));
+}
+
+// Resolve a possibly negative search offset like Buffer.prototype.indexOf
+static int64_t SearchStart(v8::Local<v8::Context> context, v8::Local<v8::Value> value, size_t length) {
+    int64_t offset = value->IsNumber() ? value->IntegerValue(context).FromMaybe(0) : 0;
+    if (offset < 0) {
+        offset += static_cast<int64_t>(length);
+    }
+    return offset;
+}
+
+// Search backwards for a byte
+static const uint8_t* FindLastByte(const uint8_t* data, size_t length, uint8_t byte) {
+#if defined(__GLIBC__)
+    return static_cast<const uint8_t*>(memrchr(data, byte, length));
+#else
+    for (size_t i = length; i > 0; i--) {
+        if (data[i - 1] == byte) {
+            return data + i - 1;
+        }
+    }
+    return nullptr;
+#endif
+}
+
+// Find a needle in a haystack from an offset, forwards or backwards
+static int64_t FindBytes(const uint8_t* haystack, size_t haystack_length, const uint8_t* needle,
+                         size_t needle_length, int64_t offset, bool forward) {
+    if (needle_length > haystack_length) {
+        return -1;
+    }
+    size_t last_start = haystack_length - needle_length;
+    
+    if (forward) {
+        if (offset < 0) {
+            offset = 0;
+        }
+        if (static_cast<size_t>(offset) > last_start) {
+            return -1;
+        }
+        const uint8_t* found;
+        if (needle_length == 1) {
+            found = static_cast<const uint8_t*>(std::memchr(haystack + offset, needle[0], haystack_length - offset));
+        } else {
+            found = static_cast<const uint8_t*>(memmem(haystack + offset, haystack_length - offset,
+                                                       needle, needle_length));
+        }
+        return found ? found - haystack : -1;
+    }
+    
+    if (offset < 0) {
+        return -1;
+    }
+    size_t start = std::min(static_cast<size_t>(offset), last_start);
+    
+    // Find candidates by their first byte, then confirm the rest
+    size_t limit = start + 1;
+    while (limit > 0) {
+        const uint8_t* candidate = FindLastByte(haystack, limit, needle[0]);
+        if (!candidate) {
+            return -1;
+        }
+        if (std::memcmp(candidate + 1, needle + 1, needle_length - 1) == 0) {
+            return candidate - haystack;
+        }
+        limit = candidate - haystack;
+    }
+    return -1;
+}
+
+// indexOf(haystack, needle, byteOffset, forward)
+static void IndexOf(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* haystack;
+    uint8_t* needle;
+    size_t haystack_length;
+    size_t needle_length;
+    if (args.Length() < 4 || !GetBytes(args[0], &haystack, &haystack_length) ||
+        !GetBytes(args[1], &needle, &needle_length)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    int64_t offset = SearchStart(context, args[2], haystack_length);
+    bool forward = args[3]->BooleanValue(isolate);
+    
+    // An empty needle matches at the clamped offset
+    if (needle_length == 0) {
+        int64_t position = std::clamp<int64_t>(offset, 0, static_cast<int64_t>(haystack_length));
+        args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(position)));
+        return;
+    }
+    
+    int64_t result = FindBytes(haystack, haystack_length, needle, needle_length, offset, forward);
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(result)));
+}
+
+// indexOfByte(haystack, byte, byteOffset, forward)
+static void IndexOfByte(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* haystack;
+    size_t haystack_length;
+    if (args.Length() < 4 || !GetBytes(args[0], &haystack, &haystack_length) || !args[1]->IsNumber()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    uint8_t byte = static_cast<uint8_t>(args[1]->Uint32Value(context).FromJust());
+    int64_t offset = SearchStart(context, args[2], haystack_length);
+    bool forward = args[3]->BooleanValue(isolate);
+    
+    int64_t result = FindBytes(haystack, haystack_length, &byte, 1, offset, forward);
+    args.GetReturnValue().Set(v8::Number::New(isolate, static_cast<double>(result)));
+}
+
+// fill(target, pattern, start, end)
+static void Fill(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* target;
+    uint8_t* pattern;
+    size_t target_length;
+    size_t pattern_length;
+    if (args.Length() < 4 || !GetBytes(args[0], &target, &target_length) ||
+        !GetBytes(args[1], &pattern, &pattern_length) || pattern_length == 0) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    size_t start = ClampedArgument(context, args[2], target_length);
+    size_t end = std::max(start, ClampedArgument(context, args[3], target_length));
+    size_t length = end - start;
+    if (length == 0) {
+        return;
+    }
+    
+    // Copy the pattern once, then keep doubling the filled prefix
+    uint8_t* output = target + start;
+    size_t filled = std::min(pattern_length, length);
+    std::memmove(output, pattern, filled);
+    while (filled < length) {
+        size_t chunk = std::min(filled, length - filled);
+        std::memcpy(output + filled, output, chunk);
+        filled += chunk;
+    }
+}
+
+// isUtf8(view)
+static void IsUtf8(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    
+    uint8_t* data;
+    size_t length;
+    if (args.Length() < 1 || !GetBytes(args[0], &data, &length)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    args.GetReturnValue().Set(IsValidUtf8(data, length));
+}
+
+// isAscii(view)
+static void IsAscii(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    
+    uint8_t* data;
+    size_t length;
+    if (args.Length() < 1 || !GetBytes(args[0], &data, &length)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    args.GetReturnValue().Set(AsciiPrefixLength(data, length) == length);
+}
+
+// Register the internal/buffer module
+void RegisterBufferModule(Runtime* runtime) {
+    std::cout << "RegisterBufferModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the buffer module object
+        v8::Local<v8::Object> buffer = v8::Object::New(isolate);
+        
+        // Encoding names as accepted by Node.js, including aliases
+        static const struct {
+            const char* name;
+            BufferEncoding encoding;
+        } kEncodingNames[] = {
+            {"utf8", kEncodingUtf8}, {"utf-8", kEncodingUtf8},
+            {"latin1", kEncodingLatin1}, {"binary", kEncodingLatin1},
+            {"ascii", kEncodingAscii},
+            {"base64", kEncodingBase64}, {"base64url", kEncodingBase64Url},
+            {"hex", kEncodingHex},
+            {"utf16le", kEncodingUtf16Le}, {"utf-16le", kEncodingUtf16Le},
+            {"ucs2", kEncodingUtf16Le}, {"ucs-2", kEncodingUtf16Le},
+        };
+        v8::Local<v8::Object> encodings = v8::Object::New(isolate);
+        for (const auto& entry : kEncodingNames) {
+            encodings->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Integer::New(isolate, entry.encoding)).Check();
+        }
+        buffer->Set(context, v8::String::NewFromUtf8(isolate, "encodings").ToLocalChecked(), encodings).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"byteLength", ByteLength},
+            {"write", Write},
+            {"toString", ToString},
+            {"compare", Compare},
+            {"indexOf", IndexOf},
+            {"indexOfByte", IndexOfByte},
+            {"fill", Fill},
+            {"isUtf8", IsUtf8},
+            {"isAscii", IsAscii},
+        };
+        for (const auto& entry : kFunctions) {
+            buffer->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Function::New(context, entry.callback).ToLocalChecked()).Check();
+        }
+        
+        // Register the buffer module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/buffer", buffer);
+        
+        std::cout << "RegisterBufferModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterBufferModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterBufferModule" << std::endl;
+    }
+}
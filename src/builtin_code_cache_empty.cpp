@@ -0,0 +1,10 @@
+// Empty code cache table, linked when no generated cache is available: into
+// tiny_node_mkcodecache, which produces the cache, and into tiny_node_core
+// when TINY_NODE_CODE_CACHE is off. Built-in modules then compile from source.
+#include "builtins.h"
+
+extern const BuiltinCodeCache kBuiltinCodeCache[] = {
+    {nullptr, nullptr, 0},
+};
+
+extern const size_t kBuiltinCodeCacheCount = 0;
@@ -0,0 +1,66 @@
+#include "builtins.h"
+#include <cstring>
+
+// Generated by cmake/js2c.cmake
+extern const BuiltinSource kBuiltinSources[];
+extern const size_t kBuiltinSourceCount;
+
+// Generated by tiny_node_mkcodecache, or empty (src/builtin_code_cache_empty.cpp)
+extern const BuiltinCodeCache kBuiltinCodeCache[];
+extern const size_t kBuiltinCodeCacheCount;
+
+// External string resource pointing at a static built-in source
+class StaticOneByteResource : public v8::String::ExternalOneByteStringResource {
+public:
+    StaticOneByteResource(const uint8_t* data, size_t length)
+        : data_(reinterpret_cast<const char*>(data)), length_(length) {}
+    
+    const char* data() const override {
+        return data_;
+    }
+    
+    size_t length() const override {
+        return length_;
+    }
+    
+private:
+    const char* data_;
+    size_t length_;
+};
+
+// Get the number of built-in modules
+size_t GetBuiltinSourceCount() {
+    return kBuiltinSourceCount;
+}
+
+// Get a built-in module by index
+const BuiltinSource* GetBuiltinSource(size_t index) {
+    return index < kBuiltinSourceCount ? &kBuiltinSources[index] : nullptr;
+}
+
+// Find a built-in module by ID
+const BuiltinSource* FindBuiltinSource(const std::string& module_id) {
+    for (size_t i = 0; i < kBuiltinSourceCount; i++) {
+        if (module_id == kBuiltinSources[i].id) {
+            return &kBuiltinSources[i];
+        }
+    }
+    return nullptr;
+}
+
+// Find the code cache for a built-in module
+const BuiltinCodeCache* FindBuiltinCodeCache(const std::string& module_id) {
+    for (size_t i = 0; i < kBuiltinCodeCacheCount; i++) {
+        if (module_id == kBuiltinCodeCache[i].id) {
+            return &kBuiltinCodeCache[i];
+        }
+    }
+    return nullptr;
+}
+
+// Create a V8 string for a built-in module without copying it
+v8::Local<v8::String> NewBuiltinSourceString(v8::Isolate* isolate, const BuiltinSource* builtin) {
+    // V8 takes ownership of the resource object (not of the static bytes)
+    return v8::String::NewExternalOneByte(
+        isolate, new StaticOneByteResource(builtin->data, builtin->length)).ToLocalChecked();
+}
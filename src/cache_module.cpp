@@ -0,0 +1,611 @@
+#include "cache_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "property_keys.h"
+#include "hash.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using CacheClock = std::chrono::steady_clock;
+
+// Approximate per-entry bookkeeping cost charged against the byte budget
+static constexpr size_t kEntryOverhead = 64;
+
+// A cached key-value pair
+struct CacheEntry {
+    std::string key;
+    std::shared_ptr<v8::BackingStore> value;
+    uint64_t hash = 0;
+    CacheClock::time_point expires_at = CacheClock::time_point::max();
+    size_t charge = 0;
+    bool referenced = false;
+    bool live = false;
+};
+
+// Aggregated cache statistics
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+};
+
+// One shard: an open-addressing table with linear probing over an entry array
+//
+// Slots hold the full hash, so probing and backward-shift deletion never
+// touch entries until the hash matches.
+class CacheShard {
+public:
+    explicit CacheShard(size_t max_bytes)
+        : max_bytes_(max_bytes), slots_(16), mask_(15), hand_(0), bytes_(0), live_(0) {}
+    
+    std::shared_ptr<v8::BackingStore> Get(std::string_view key, uint64_t hash, CacheClock::time_point now) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t slot;
+        if (!Find(key, hash, &slot)) {
+            stats_.misses++;
+            return nullptr;
+        }
+        
+        CacheEntry& entry = entries_[slots_[slot].entry - 1];
+        if (entry.expires_at <= now) {
+            RemoveSlot(slot);
+            stats_.expirations++;
+            stats_.misses++;
+            return nullptr;
+        }
+        
+        entry.referenced = true;
+        stats_.hits++;
+        return entry.value;
+    }
+    
+    bool Set(std::string_view key, uint64_t hash, std::shared_ptr<v8::BackingStore> value,
+             CacheClock::time_point expires_at, CacheClock::time_point now) {
+        size_t charge = key.size() + value->ByteLength() + kEntryOverhead;
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (charge > max_bytes_) {
+            return false;
+        }
+        
+        size_t slot;
+        if (Find(key, hash, &slot)) {
+            RemoveSlot(slot);
+        }
+        
+        // Make room before inserting so the new entry is not its own victim
+        while (bytes_ + charge > max_bytes_ && live_ > 0) {
+            EvictOne(now);
+        }
+        
+        if ((live_ + 1) * 10 > slots_.size() * 7) {
+            Grow();
+        }
+        
+        uint32_t index;
+        if (!free_entries_.empty()) {
+            index = free_entries_.back();
+            free_entries_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(entries_.size());
+            entries_.emplace_back();
+        }
+        
+        CacheEntry& entry = entries_[index];
+        entry.key.assign(key.data(), key.size());
+        entry.value = std::move(value);
+        entry.hash = hash;
+        entry.expires_at = expires_at;
+        entry.charge = charge;
+        entry.referenced = false;
+        entry.live = true;
+        
+        InsertSlot(hash, index + 1);
+        bytes_ += charge;
+        live_++;
+        return true;
+    }
+    
+    bool Delete(std::string_view key, uint64_t hash) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t slot;
+        if (!Find(key, hash, &slot)) {
+            return false;
+        }
+        RemoveSlot(slot);
+        return true;
+    }
+    
+    bool Has(std::string_view key, uint64_t hash, CacheClock::time_point now) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t slot;
+        return Find(key, hash, &slot) && entries_[slots_[slot].entry - 1].expires_at > now;
+    }
+    
+    void Clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        slots_.assign(16, Slot());
+        mask_ = 15;
+        entries_.clear();
+        free_entries_.clear();
+        hand_ = 0;
+        bytes_ = 0;
+        live_ = 0;
+    }
+    
+    void AddStats(CacheStats* stats) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats->hits += stats_.hits;
+        stats->misses += stats_.misses;
+        stats->evictions += stats_.evictions;
+        stats->expirations += stats_.expirations;
+        stats->entries += live_;
+        stats->bytes += bytes_;
+    }
+    
+private:
+    struct Slot {
+        uint64_t hash = 0;
+        uint32_t entry = 0;  // Entry index + 1, 0 for an empty slot
+    };
+    
+    bool Find(std::string_view key, uint64_t hash, size_t* slot) const {
+        for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+            const Slot& candidate = slots_[i];
+            if (candidate.entry == 0) {
+                return false;
+            }
+            if (candidate.hash == hash && entries_[candidate.entry - 1].key == key) {
+                *slot = i;
+                return true;
+            }
+        }
+    }
+    
+    void InsertSlot(uint64_t hash, uint32_t entry) {
+        size_t i = hash & mask_;
+        while (slots_[i].entry != 0) {
+            i = (i + 1) & mask_;
+        }
+        slots_[i].hash = hash;
+        slots_[i].entry = entry;
+    }
+    
+    // Remove the entry in a slot, shifting later probes back over the hole
+    void RemoveSlot(size_t slot) {
+        uint32_t index = slots_[slot].entry - 1;
+        CacheEntry& entry = entries_[index];
+        bytes_ -= entry.charge;
+        live_--;
+        entry.live = false;
+        entry.value.reset();
+        entry.key.clear();
+        free_entries_.push_back(index);
+        
+        size_t hole = slot;
+        for (size_t i = (hole + 1) & mask_; slots_[i].entry != 0; i = (i + 1) & mask_) {
+            size_t home = slots_[i].hash & mask_;
+            // Move the slot back if its home position is not in (hole, i]
+            bool in_range = hole <= i ? (home > hole && home <= i) : (home > hole || home <= i);
+            if (!in_range) {
+                slots_[hole] = slots_[i];
+                hole = i;
+            }
+        }
+        slots_[hole] = Slot();
+    }
+    
+    // Evict one entry using the CLOCK algorithm, preferring expired entries
+    void EvictOne(CacheClock::time_point now) {
+        while (true) {
+            if (hand_ >= entries_.size()) {
+                hand_ = 0;
+            }
+            CacheEntry& entry = entries_[hand_++];
+            if (!entry.live) {
+                continue;
+            }
+            
+            bool expired = entry.expires_at <= now;
+            if (!expired && entry.referenced) {
+                entry.referenced = false;
+                continue;
+            }
+            
+            size_t slot;
+            Find(entry.key, entry.hash, &slot);
+            RemoveSlot(slot);
+            if (expired) {
+                stats_.expirations++;
+            } else {
+                stats_.evictions++;
+            }
+            return;
+        }
+    }
+    
+    void Grow() {
+        std::vector<Slot> old_slots(slots_.size() * 2);
+        old_slots.swap(slots_);
+        mask_ = slots_.size() - 1;
+        for (const Slot& slot : old_slots) {
+            if (slot.entry != 0) {
+                InsertSlot(slot.hash, slot.entry);
+            }
+        }
+    }
+    
+    std::mutex mutex_;
+    size_t max_bytes_;
+    std::vector<Slot> slots_;
+    size_t mask_;
+    std::vector<CacheEntry> entries_;
+    std::vector<uint32_t> free_entries_;
+    size_t hand_;
+    size_t bytes_;
+    size_t live_;
+    CacheStats stats_;
+};
+
+// A sharded off-heap cache
+class OffHeapCache {
+public:
+    OffHeapCache(size_t max_bytes, size_t shard_count, uint64_t default_ttl_ms)
+        : max_bytes_(max_bytes), default_ttl_ms_(default_ttl_ms) {
+        for (size_t i = 0; i < shard_count; i++) {
+            shards_.push_back(std::make_unique<CacheShard>(max_bytes / shard_count));
+        }
+    }
+    
+    static uint64_t Hash(std::string_view key) {
+        // XXH3 spreads both shard and slot bits and is vectorized for long keys
+        return Xxh3Hash64(key.data(), key.size(), 0);
+    }
+    
+    CacheShard& ShardFor(uint64_t hash) {
+        return *shards_[(hash >> 48) % shards_.size()];
+    }
+    
+    size_t MaxBytes() const {
+        return max_bytes_;
+    }
+    
+    uint64_t DefaultTtl() const {
+        return default_ttl_ms_;
+    }
+    
+    void Clear() {
+        for (auto& shard : shards_) {
+            shard->Clear();
+        }
+    }
+    
+    CacheStats Stats() {
+        CacheStats stats;
+        for (auto& shard : shards_) {
+            shard->AddStats(&stats);
+        }
+        return stats;
+    }
+    
+private:
+    size_t max_bytes_;
+    uint64_t default_ttl_ms_;
+    std::vector<std::unique_ptr<CacheShard>> shards_;
+};
+
+// Named caches shared by every runtime in the process
+static std::unordered_map<std::string, std::shared_ptr<OffHeapCache>> named_caches;
+static std::mutex named_caches_mutex;
+
+// A wrapper's reference to a cache
+struct CacheHandle {
+    std::shared_ptr<OffHeapCache> cache;
+    v8::Global<v8::Object> handle;
+};
+
+// Drop a cache reference when its wrapper is garbage collected
+static void CacheWeakCallback(const v8::WeakCallbackInfo<CacheHandle>& info) {
+    CacheHandle* cache_handle = info.GetParameter();
+    cache_handle->handle.Reset();
+    delete cache_handle;
+}
+
+// Get the cache behind a wrapper object
+static OffHeapCache* UnwrapCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    if (args.This()->InternalFieldCount() < 1) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    CacheHandle* cache_handle = static_cast<CacheHandle*>(args.This()->GetAlignedPointerFromInternalField(0));
+    return cache_handle->cache.get();
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// c.get(key)
+static void CacheGet(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    OffHeapCache* cache = UnwrapCache(args);
+    if (!cache) {
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::String::Utf8Value key(isolate, args[0]);
+    std::string_view key_view(*key, key.length());
+    uint64_t hash = OffHeapCache::Hash(key_view);
+    
+    std::shared_ptr<v8::BackingStore> value = cache->ShardFor(hash).Get(key_view, hash, CacheClock::now());
+    if (!value) {
+        args.GetReturnValue().SetUndefined();
+        return;
+    }
+    
+    // Hand out a copy: the cached memory is shared by every reader in every
+    // runtime, and writes through a view would race with them
+    size_t length = value->ByteLength();
+    std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(isolate, length);
+    std::memcpy(store->Data(), value->Data(), length);
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(store));
+    args.GetReturnValue().Set(v8::Uint8Array::New(buffer, 0, length));
+}
+
+// c.set(key, value, ttl)
+static void CacheSet(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    OffHeapCache* cache = UnwrapCache(args);
+    if (!cache) {
+        return;
+    }
+    if (args.Length() < 2 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    // Copy the value out of the V8 heap once, into its own backing store
+    std::unique_ptr<v8::BackingStore> store;
+    if (args[1]->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = args[1].As<v8::ArrayBufferView>();
+        store = v8::ArrayBuffer::NewBackingStore(isolate, view->ByteLength());
+        view->CopyContents(store->Data(), view->ByteLength());
+    } else if (args[1]->IsArrayBuffer()) {
+        v8::Local<v8::ArrayBuffer> source = args[1].As<v8::ArrayBuffer>();
+        store = v8::ArrayBuffer::NewBackingStore(isolate, source->ByteLength());
+        std::memcpy(store->Data(), source->Data(), source->ByteLength());
+    } else if (args[1]->IsString()) {
+        v8::Local<v8::String> source = args[1].As<v8::String>();
+        store = v8::ArrayBuffer::NewBackingStore(isolate, source->Utf8Length(isolate));
+        source->WriteUtf8(isolate, static_cast<char*>(store->Data()), static_cast<int>(store->ByteLength()),
+                          nullptr, v8::String::NO_NULL_TERMINATION);
+    } else {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    uint64_t ttl_ms = cache->DefaultTtl();
+    if (args.Length() >= 3 && args[2]->IsNumber()) {
+        ttl_ms = static_cast<uint64_t>(std::max<int64_t>(0, args[2]->IntegerValue(context).FromJust()));
+    }
+    
+    CacheClock::time_point now = CacheClock::now();
+    CacheClock::time_point expires_at = ttl_ms > 0
+        ? now + std::chrono::milliseconds(ttl_ms)
+        : CacheClock::time_point::max();
+    
+    v8::String::Utf8Value key(isolate, args[0]);
+    std::string_view key_view(*key, key.length());
+    uint64_t hash = OffHeapCache::Hash(key_view);
+    
+    bool stored = cache->ShardFor(hash).Set(key_view, hash, std::move(store), expires_at, now);
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, stored));
+}
+
+// c.has(key)
+static void CacheHas(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    OffHeapCache* cache = UnwrapCache(args);
+    if (!cache) {
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::String::Utf8Value key(isolate, args[0]);
+    std::string_view key_view(*key, key.length());
+    uint64_t hash = OffHeapCache::Hash(key_view);
+    args.GetReturnValue().Set(v8::Boolean::New(isolate,
+        cache->ShardFor(hash).Has(key_view, hash, CacheClock::now())));
+}
+
+// c.delete(key)
+static void CacheDelete(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    OffHeapCache* cache = UnwrapCache(args);
+    if (!cache) {
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::String::Utf8Value key(isolate, args[0]);
+    std::string_view key_view(*key, key.length());
+    uint64_t hash = OffHeapCache::Hash(key_view);
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, cache->ShardFor(hash).Delete(key_view, hash)));
+}
+
+// c.clear()
+static void CacheClear(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    OffHeapCache* cache = UnwrapCache(args);
+    if (cache) {
+        cache->Clear();
+    }
+}
+
+// c.stats()
+static void CacheStatsCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    OffHeapCache* cache = UnwrapCache(args);
+    if (!cache) {
+        return;
+    }
+    
+    CacheStats stats = cache->Stats();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    auto set = [&](v8::Local<v8::String> name, double value) {
+        result->Set(context, name, v8::Number::New(isolate, value)).Check();
+    };
+    set(keys.hits_string(), static_cast<double>(stats.hits));
+    set(keys.misses_string(), static_cast<double>(stats.misses));
+    set(keys.evictions_string(), static_cast<double>(stats.evictions));
+    set(keys.expirations_string(), static_cast<double>(stats.expirations));
+    set(keys.entries_string(), static_cast<double>(stats.entries));
+    set(keys.bytes_string(), static_cast<double>(stats.bytes));
+    set(keys.max_bytes_string(), static_cast<double>(cache->MaxBytes()));
+    args.GetReturnValue().Set(result);
+}
+
+// Read a numeric option, keeping the default if it is absent
+static bool ReadNumberOption(v8::Local<v8::Context> context, v8::Local<v8::Object> options,
+                             v8::Local<v8::String> name, int64_t* value) {
+    v8::Local<v8::Value> option;
+    if (!options->Get(context, name).ToLocal(&option)) {
+        return false;
+    }
+    if (option->IsNumber()) {
+        *value = option->IntegerValue(context).FromJust();
+    }
+    return true;
+}
+
+// Native create function
+static void CreateCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    int64_t max_bytes = 64 * 1024 * 1024;
+    int64_t shards = 16;
+    int64_t ttl = 0;
+    std::string name;
+    
+    if (args.Length() >= 1 && args[0]->IsObject()) {
+        v8::Local<v8::Object> options = args[0].As<v8::Object>();
+        const PropertyKeys& keys = PropertyKeys::Get(isolate);
+        if (!ReadNumberOption(context, options, keys.max_bytes_string(), &max_bytes) ||
+            !ReadNumberOption(context, options, keys.shards_string(), &shards) ||
+            !ReadNumberOption(context, options, keys.ttl_string(), &ttl)) {
+            return;
+        }
+        v8::Local<v8::Value> name_value;
+        if (!options->Get(context, keys.name_string()).ToLocal(&name_value)) {
+            return;
+        }
+        if (name_value->IsString()) {
+            name = *v8::String::Utf8Value(isolate, name_value);
+        }
+    }
+    
+    if (max_bytes <= 0 || shards <= 0 || shards > 1024 || ttl < 0) {
+        isolate->ThrowException(v8::Exception::RangeError(
+            v8::String::NewFromUtf8(isolate, "Invalid cache options").ToLocalChecked()));
+        return;
+    }
+    
+    std::shared_ptr<OffHeapCache> cache;
+    if (!name.empty()) {
+        std::lock_guard<std::mutex> lock(named_caches_mutex);
+        std::shared_ptr<OffHeapCache>& entry = named_caches[name];
+        if (!entry) {
+            entry = std::make_shared<OffHeapCache>(max_bytes, shards, ttl);
+        }
+        cache = entry;
+    } else {
+        cache = std::make_shared<OffHeapCache>(max_bytes, shards, ttl);
+    }
+    
+    v8::Local<v8::ObjectTemplate> object_template = v8::ObjectTemplate::New(isolate);
+    object_template->SetInternalFieldCount(1);
+    object_template->Set(isolate, "get", v8::FunctionTemplate::New(isolate, CacheGet));
+    object_template->Set(isolate, "set", v8::FunctionTemplate::New(isolate, CacheSet));
+    object_template->Set(isolate, "has", v8::FunctionTemplate::New(isolate, CacheHas));
+    object_template->Set(isolate, "delete", v8::FunctionTemplate::New(isolate, CacheDelete));
+    object_template->Set(isolate, "clear", v8::FunctionTemplate::New(isolate, CacheClear));
+    object_template->Set(isolate, "stats", v8::FunctionTemplate::New(isolate, CacheStatsCallback));
+    
+    v8::Local<v8::Object> object = object_template->NewInstance(context).ToLocalChecked();
+    CacheHandle* cache_handle = new CacheHandle();
+    cache_handle->cache = std::move(cache);
+    cache_handle->handle.Reset(isolate, object);
+    cache_handle->handle.SetWeak(cache_handle, CacheWeakCallback, v8::WeakCallbackType::kParameter);
+    object->SetAlignedPointerInInternalField(0, cache_handle);
+    
+    args.GetReturnValue().Set(object);
+}
+
+// Register the cache module
+void RegisterCacheModule(Runtime* runtime) {
+    std::cout << "RegisterCacheModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the cache module object
+        v8::Local<v8::Object> cache = v8::Object::New(isolate);
+        cache->Set(context,
+            v8::String::NewFromUtf8(isolate, "create").ToLocalChecked(),
+            v8::Function::New(context, CreateCache).ToLocalChecked()).Check();
+        
+        // Register the cache module
+        runtime->GetModuleSystem()->RegisterNativeModule("cache", cache);
+        
+        std::cout << "RegisterCacheModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterCacheModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterCacheModule" << std::endl;
+    }
+}
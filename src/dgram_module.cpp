@@ -0,0 +1,981 @@
+#include "dgram_module.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+#include "property_keys.h"
+#include <uv.h>
+#include <algorithm>
+#include <iostream>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/udp.h>
+#endif
+
+// Largest UDP payload, and the stride at which libuv's recvmmsg places datagrams
+static constexpr size_t kMaxDatagram = 64 * 1024;
+
+// Datagrams libuv reads with one recvmmsg call
+static constexpr size_t kRecvBatch = 20;
+
+// Size of the slabs received datagrams are packed into
+static constexpr size_t kSlabSize = 256 * 1024;
+
+// Messages handed to one sendmmsg call
+static constexpr size_t kSendBatch = 64;
+
+// Limits of a GSO message: segments, segment size (within a typical MTU) and bytes
+static constexpr size_t kMaxGsoSegments = 64;
+static constexpr size_t kMaxGsoSegmentSize = 1400;
+static constexpr size_t kMaxGsoBytes = 65000;
+
+// Address strings kept for the senders of received datagrams
+static constexpr size_t kMaxAddressNames = 256;
+
+struct UdpWrap;
+
+// A datagram about to be sent
+struct Datagram {
+    char* data;
+    size_t length;
+    sockaddr_storage address;
+    socklen_t address_length;
+};
+
+// Per-runtime state of the internal/udp module
+struct UdpBinding {
+    Runtime* runtime = nullptr;
+    
+    // Context the callbacks run in, set by setup()
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> onmessage;
+    v8::Global<v8::Function> onsend;
+    v8::Global<v8::Function> onclose;
+    
+    // Buffer libuv's recvmmsg reads into; datagrams are copied out at once
+    std::unique_ptr<char[]> recv_buffer;
+    
+    // Slab received datagrams are packed into and handed to JavaScript
+    v8::Global<v8::ArrayBuffer> slab;
+    char* slab_data = nullptr;
+    size_t slab_offset = 0;
+    
+    // Sockets holding datagrams that have not been delivered yet
+    std::vector<UdpWrap*> pending;
+    
+    // Delivers pending datagrams once per loop iteration, after polling
+    uv_check_t* check = nullptr;
+    
+    // Open handles, closed by the cleanup hook when the runtime goes away
+    std::unordered_set<UdpWrap*> wraps;
+    
+    // Strings for sender addresses, keyed by family and address bytes
+    std::unordered_map<std::string, v8::Global<v8::String>> address_names;
+    
+    // Scratch space reused by every send
+    std::vector<Datagram> datagrams;
+#ifdef __linux__
+    std::vector<struct mmsghdr> messages;
+    std::vector<size_t> message_datagrams;
+    std::vector<struct iovec> iovecs;
+    std::vector<char> controls;
+#endif
+};
+
+// A UDP handle, its JavaScript object and the datagrams it has received
+struct UdpWrap {
+    uv_udp_t handle;
+    UdpBinding* binding;
+    v8::Global<v8::Object> object;
+    bool closing = false;
+    bool gso = true;
+    bool pending = false;
+    
+    // Offset, length and port in the slab of each undelivered datagram
+    std::vector<uint32_t> layout;
+    std::vector<sockaddr_storage> sources;
+};
+
+// Datagrams queued on libuv by one send() call, and the memory they are sent from
+struct SendBatch {
+    UdpWrap* wrap;
+    size_t remaining = 0;
+    int status = 0;
+    std::vector<std::shared_ptr<v8::BackingStore>> stores;
+};
+
+struct SendReq {
+    uv_udp_send_t req;
+    SendBatch* batch;
+};
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Let the loop register watchers started outside of its own callbacks
+static void WakeLoop(UdpWrap* wrap) {
+    wrap->binding->runtime->GetEventLoop()->Wake();
+}
+
+// Call one of the setup() callbacks with the handle as this
+static void MakeCallback(UdpWrap* wrap, const v8::Global<v8::Function>& callback,
+                         int argc, v8::Local<v8::Value>* argv) {
+    UdpBinding* binding = wrap->binding;
+    if (callback.IsEmpty() || wrap->object.IsEmpty()) {
+        return;
+    }
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = binding->context.Get(isolate);
+    v8::Context::Scope context_scope(context);
+    
+    v8::TryCatch try_catch(isolate);
+    v8::Local<v8::Function> function = callback.Get(isolate);
+    if (function->Call(context, wrap->object.Get(isolate), argc, argv).IsEmpty() && try_catch.HasCaught()) {
+        v8::String::Utf8Value error(isolate, try_catch.Exception());
+        std::cerr << "Uncaught exception in dgram callback: " << *error << std::endl;
+    }
+    
+    // Settle promises resolved by the callback, as after any loop task
+    isolate->PerformMicrotaskCheckpoint();
+}
+
+// Call a callback with a single status argument
+static void MakeStatusCallback(UdpWrap* wrap, const v8::Global<v8::Function>& callback, int status) {
+    v8::Isolate* isolate = wrap->binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, status)};
+    MakeCallback(wrap, callback, 1, argv);
+}
+
+// Get the string for a sender address, creating it only the first time it is seen
+static v8::Local<v8::String> AddressName(UdpBinding* binding, v8::Isolate* isolate,
+                                         const sockaddr_storage& address) {
+    std::string key;
+    if (address.ss_family == AF_INET6) {
+        const sockaddr_in6* in6 = reinterpret_cast<const sockaddr_in6*>(&address);
+        key.assign(reinterpret_cast<const char*>(&in6->sin6_addr), sizeof(in6->sin6_addr));
+    } else {
+        const sockaddr_in* in = reinterpret_cast<const sockaddr_in*>(&address);
+        key.assign(reinterpret_cast<const char*>(&in->sin_addr), sizeof(in->sin_addr));
+    }
+    
+    auto it = binding->address_names.find(key);
+    if (it != binding->address_names.end()) {
+        return it->second.Get(isolate);
+    }
+    
+    char name[INET6_ADDRSTRLEN];
+    if (address.ss_family == AF_INET6) {
+        uv_ip6_name(reinterpret_cast<const sockaddr_in6*>(&address), name, sizeof(name));
+    } else {
+        uv_ip4_name(reinterpret_cast<const sockaddr_in*>(&address), name, sizeof(name));
+    }
+    v8::Local<v8::String> string = v8::String::NewFromUtf8(isolate, name).ToLocalChecked();
+    if (binding->address_names.size() >= kMaxAddressNames) {
+        binding->address_names.clear();
+    }
+    binding->address_names[key].Reset(isolate, string);
+    return string;
+}
+
+// Hand a socket's received datagrams to JavaScript in one call
+static void Deliver(UdpWrap* wrap) {
+    UdpBinding* binding = wrap->binding;
+    size_t count = wrap->sources.size();
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Context::Scope context_scope(binding->context.Get(isolate));
+    
+    v8::Local<v8::ArrayBuffer> layout_buffer = v8::ArrayBuffer::New(isolate, wrap->layout.size() * sizeof(uint32_t));
+    std::memcpy(layout_buffer->Data(), wrap->layout.data(), wrap->layout.size() * sizeof(uint32_t));
+    v8::Local<v8::Uint32Array> layout = v8::Uint32Array::New(layout_buffer, 0, wrap->layout.size());
+    
+    std::vector<v8::Local<v8::Value>> names(count);
+    for (size_t i = 0; i < count; i++) {
+        names[i] = AddressName(binding, isolate, wrap->sources[i]);
+    }
+    v8::Local<v8::Array> addresses = v8::Array::New(isolate, names.data(), count);
+    
+    // Keep the capacity for the next batch
+    wrap->layout.clear();
+    wrap->sources.clear();
+    
+    v8::Local<v8::Value> argv[] = {
+        v8::Integer::New(isolate, static_cast<int>(count)),
+        binding->slab.Get(isolate),
+        layout,
+        addresses,
+    };
+    MakeCallback(wrap, binding->onmessage, 4, argv);
+}
+
+// Deliver the datagrams of every socket that received some
+static void FlushPending(UdpBinding* binding) {
+    std::vector<UdpWrap*> wraps;
+    wraps.swap(binding->pending);
+    for (UdpWrap* wrap : wraps) {
+        wrap->pending = false;
+        if (wrap->closing) {
+            wrap->layout.clear();
+            wrap->sources.clear();
+            continue;
+        }
+        Deliver(wrap);
+    }
+}
+
+// Deliver after libuv has drained every readable socket in this iteration
+static void OnCheck(uv_check_t* check) {
+    UdpBinding* binding = static_cast<UdpBinding*>(check->data);
+    if (!binding->pending.empty()) {
+        FlushPending(binding);
+    }
+}
+
+// Give libuv the recvmmsg buffer; it is reused because datagrams are copied out
+static void OnAlloc(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+    UdpBinding* binding = static_cast<UdpWrap*>(handle->data)->binding;
+    if (!binding->recv_buffer) {
+        binding->recv_buffer.reset(new char[kRecvBatch * kMaxDatagram]);
+    }
+    buf->base = binding->recv_buffer.get();
+    buf->len = kRecvBatch * kMaxDatagram;
+}
+
+// Pack a received datagram into the slab until the iteration ends
+static void OnRecv(uv_udp_t* handle, ssize_t nread, const uv_buf_t* buf, const sockaddr* addr, unsigned flags) {
+    UdpWrap* wrap = static_cast<UdpWrap*>(handle->data);
+    UdpBinding* binding = wrap->binding;
+    
+    if (nread < 0) {
+        FlushPending(binding);
+        if (!wrap->closing) {
+            MakeStatusCallback(wrap, binding->onmessage, static_cast<int>(nread));
+        }
+        return;
+    }
+    
+    // Nothing more to read, or the end of a recvmmsg batch
+    if (addr == nullptr) {
+        return;
+    }
+    
+    size_t length = static_cast<size_t>(nread);
+    if (binding->slab_data == nullptr || kSlabSize - binding->slab_offset < length) {
+        // Earlier datagrams point into the current slab, so they go first
+        FlushPending(binding);
+        if (wrap->closing) {
+            return;
+        }
+        
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Context::Scope context_scope(binding->context.Get(isolate));
+        v8::Local<v8::ArrayBuffer> slab = v8::ArrayBuffer::New(isolate, kSlabSize);
+        binding->slab.Reset(isolate, slab);
+        binding->slab_data = static_cast<char*>(slab->Data());
+        binding->slab_offset = 0;
+    }
+    
+    size_t offset = binding->slab_offset;
+    std::memcpy(binding->slab_data + offset, buf->base, length);
+    binding->slab_offset += (length + 7) & ~static_cast<size_t>(7);
+    
+    uint16_t port = addr->sa_family == AF_INET6
+        ? ntohs(reinterpret_cast<const sockaddr_in6*>(addr)->sin6_port)
+        : ntohs(reinterpret_cast<const sockaddr_in*>(addr)->sin_port);
+    wrap->layout.push_back(static_cast<uint32_t>(offset));
+    wrap->layout.push_back(static_cast<uint32_t>(length));
+    wrap->layout.push_back(port);
+    sockaddr_storage source;
+    std::memcpy(&source, addr, addr->sa_family == AF_INET6 ? sizeof(sockaddr_in6) : sizeof(sockaddr_in));
+    wrap->sources.push_back(source);
+    
+    if (!wrap->pending) {
+        wrap->pending = true;
+        binding->pending.push_back(wrap);
+    }
+}
+
+// Report a queued batch once its last datagram has been sent
+static void OnSend(uv_udp_send_t* req, int status) {
+    SendReq* send_req = static_cast<SendReq*>(req->data);
+    SendBatch* batch = send_req->batch;
+    delete send_req;
+    if (status < 0 && batch->status == 0) {
+        batch->status = status;
+    }
+    if (--batch->remaining > 0) {
+        return;
+    }
+    
+    UdpWrap* wrap = batch->wrap;
+    int batch_status = batch->status;
+    delete batch;
+    if (wrap->binding) {
+        MakeStatusCallback(wrap, wrap->binding->onsend, batch_status);
+    }
+}
+
+// Free a handle, telling JavaScript first unless the runtime is going away
+static void OnClose(uv_handle_t* handle) {
+    UdpWrap* wrap = static_cast<UdpWrap*>(handle->data);
+    UdpBinding* binding = wrap->binding;
+    if (binding) {
+        MakeCallback(wrap, binding->onclose, 0, nullptr);
+        
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        wrap->object.Get(isolate)->SetAlignedPointerInInternalField(0, nullptr);
+        wrap->object.Reset();
+        binding->wraps.erase(wrap);
+        if (wrap->pending) {
+            binding->pending.erase(std::find(binding->pending.begin(), binding->pending.end(), wrap));
+        }
+    }
+    delete wrap;
+}
+
+// Get the wrap behind a handle object; closing handles report UV_EBADF
+static UdpWrap* UnwrapUdp(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = nullptr;
+    if (args.This()->InternalFieldCount() >= 1) {
+        wrap = static_cast<UdpWrap*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!wrap) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    if (wrap->closing) {
+        args.GetReturnValue().Set(UV_EBADF);
+        return nullptr;
+    }
+    return wrap;
+}
+
+// Parse an IP literal and port into a socket address
+static int ParseAddress(v8::Isolate* isolate, v8::Local<v8::Value> host, int port,
+                        sockaddr_storage* address, socklen_t* length) {
+    v8::String::Utf8Value ip(isolate, host);
+    if (uv_ip4_addr(*ip, port, reinterpret_cast<sockaddr_in*>(address)) == 0) {
+        *length = sizeof(sockaddr_in);
+        return 0;
+    }
+    *length = sizeof(sockaddr_in6);
+    return uv_ip6_addr(*ip, port, reinterpret_cast<sockaddr_in6*>(address));
+}
+
+// Read a port argument
+static bool ReadPort(v8::Local<v8::Context> context, v8::Local<v8::Value> value, int* port) {
+    if (!value->IsNumber()) {
+        return false;
+    }
+    *port = value->Int32Value(context).FromJust();
+    return *port >= 0 && *port <= 65535;
+}
+
+#ifdef __linux__
+// Number of datagrams from first on that can go out as one GSO message
+static size_t GsoRunLength(const Datagram* datagrams, size_t first, size_t count) {
+    size_t segment = datagrams[first].length;
+    if (segment == 0 || segment > kMaxGsoSegmentSize) {
+        return 1;
+    }
+    
+    size_t end = first + 1;
+    size_t total = segment;
+    while (end < count && end - first < kMaxGsoSegments) {
+        const Datagram& next = datagrams[end];
+        if (next.length == 0 || next.length > segment || total + next.length > kMaxGsoBytes ||
+            next.address_length != datagrams[first].address_length ||
+            std::memcmp(&next.address, &datagrams[first].address, next.address_length) != 0) {
+            break;
+        }
+        total += next.length;
+        end++;
+        
+        // Only the last segment may be shorter
+        if (next.length < segment) {
+            break;
+        }
+    }
+    return end - first;
+}
+
+// Send datagrams with sendmmsg until the socket buffer is full
+static size_t SendNow(UdpWrap* wrap, const Datagram* datagrams, size_t count, int* first_error) {
+    UdpBinding* binding = wrap->binding;
+    uv_os_fd_t fd;
+    if (uv_fileno(reinterpret_cast<uv_handle_t*>(&wrap->handle), &fd) != 0) {
+        return 0;
+    }
+    
+    size_t sent = 0;
+    while (sent < count) {
+        // Group the next datagrams into messages, merging runs for GSO
+        binding->message_datagrams.clear();
+        size_t next = sent;
+        while (next < count && binding->message_datagrams.size() < kSendBatch) {
+            size_t run = wrap->gso ? GsoRunLength(datagrams, next, count) : 1;
+            binding->message_datagrams.push_back(run);
+            next += run;
+        }
+        size_t message_count = binding->message_datagrams.size();
+        
+        binding->iovecs.resize(next - sent);
+        for (size_t i = sent; i < next; i++) {
+            binding->iovecs[i - sent].iov_base = datagrams[i].data;
+            binding->iovecs[i - sent].iov_len = datagrams[i].length;
+        }
+        binding->messages.assign(message_count, mmsghdr());
+        binding->controls.assign(message_count * CMSG_SPACE(sizeof(uint16_t)), 0);
+        
+        size_t first = sent;
+        for (size_t m = 0; m < message_count; m++) {
+            size_t run = binding->message_datagrams[m];
+            msghdr& header = binding->messages[m].msg_hdr;
+            header.msg_name = const_cast<sockaddr_storage*>(&datagrams[first].address);
+            header.msg_namelen = datagrams[first].address_length;
+            header.msg_iov = &binding->iovecs[first - sent];
+            header.msg_iovlen = run;
+            if (run > 1) {
+                // The kernel splits the payload back into datagrams of this size
+                header.msg_control = &binding->controls[m * CMSG_SPACE(sizeof(uint16_t))];
+                header.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+                cmsghdr* control = CMSG_FIRSTHDR(&header);
+                control->cmsg_level = SOL_UDP;
+                control->cmsg_type = UDP_SEGMENT;
+                control->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                uint16_t segment = static_cast<uint16_t>(datagrams[first].length);
+                std::memcpy(CMSG_DATA(control), &segment, sizeof(segment));
+            }
+            first += run;
+        }
+        
+        int result;
+        do {
+            result = sendmmsg(fd, binding->messages.data(), static_cast<unsigned int>(message_count), 0);
+        } while (result < 0 && errno == EINTR);
+        
+        if (result > 0) {
+            for (int m = 0; m < result; m++) {
+                sent += binding->message_datagrams[m];
+            }
+            continue;
+        }
+        
+        int err = errno;
+        if (err == EAGAIN || err == EWOULDBLOCK || err == ENOBUFS) {
+            break;
+        }
+        if (binding->message_datagrams[0] > 1 &&
+            (err == EIO || err == EINVAL || err == ENOPROTOOPT || err == EOPNOTSUPP)) {
+            // No GSO on this path; send the same datagrams one by one from now on
+            wrap->gso = false;
+            continue;
+        }
+        
+        // Drop the failing message, as a failed send would, and go on with the rest
+        if (*first_error == 0) {
+            *first_error = uv_translate_sys_error(err);
+        }
+        sent += binding->message_datagrams[0];
+    }
+    return sent;
+}
+#else
+// Send datagrams one by one until the socket buffer is full
+static size_t SendNow(UdpWrap* wrap, const Datagram* datagrams, size_t count, int* first_error) {
+    size_t sent = 0;
+    while (sent < count) {
+        uv_buf_t buf = uv_buf_init(datagrams[sent].data, static_cast<unsigned int>(datagrams[sent].length));
+        int result = uv_udp_try_send(&wrap->handle, &buf, 1,
+                                     reinterpret_cast<const sockaddr*>(&datagrams[sent].address));
+        if (result == UV_EAGAIN || result == UV_ENOSYS) {
+            break;
+        }
+        if (result < 0 && *first_error == 0) {
+            *first_error = result;
+        }
+        sent++;
+    }
+    return sent;
+}
+#endif
+
+// Constructor behind handle objects
+static void UdpConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    if (!args.IsConstructCall()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    UdpBinding* binding = static_cast<UdpBinding*>(args.Data().As<v8::External>()->Value());
+    uv_loop_t* loop = binding->runtime->GetEventLoop()->GetUvLoop();
+    
+    // One check handle per runtime delivers what every socket received
+    if (!binding->check) {
+        binding->check = new uv_check_t();
+        uv_check_init(loop, binding->check);
+        binding->check->data = binding;
+        uv_check_start(binding->check, OnCheck);
+        uv_unref(reinterpret_cast<uv_handle_t*>(binding->check));
+    }
+    
+    UdpWrap* wrap = new UdpWrap();
+    wrap->binding = binding;
+#if UV_VERSION_HEX >= ((1 << 16) | (40 << 8))
+    uv_udp_init_ex(loop, &wrap->handle, AF_UNSPEC | UV_UDP_RECVMMSG);
+#else
+    uv_udp_init(loop, &wrap->handle);
+#endif
+    wrap->handle.data = wrap;
+    wrap->object.Reset(isolate, args.This());
+    args.This()->SetAlignedPointerInInternalField(0, wrap);
+    binding->wraps.insert(wrap);
+}
+
+// handle.bind(ip, port, flags)
+static void UdpBind(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    int port;
+    if (!args[0]->IsString() || !ReadPort(context, args[1], &port)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    unsigned int flags = args[2]->IsNumber() ? args[2]->Uint32Value(context).FromJust() : 0;
+    sockaddr_storage address;
+    socklen_t length;
+    int err = ParseAddress(isolate, args[0], port, &address, &length);
+    if (err == 0) {
+        err = uv_udp_bind(&wrap->handle, reinterpret_cast<const sockaddr*>(&address), flags);
+    }
+    args.GetReturnValue().Set(err);
+}
+
+// handle.recvStart()
+static void UdpRecvStart(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    int err = uv_udp_recv_start(&wrap->handle, OnAlloc, OnRecv);
+    
+    // Receiving again while already receiving is fine
+    if (err == UV_EALREADY) {
+        err = 0;
+    }
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(err);
+}
+
+// handle.recvStop()
+static void UdpRecvStop(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    args.GetReturnValue().Set(uv_udp_recv_stop(&wrap->handle));
+}
+
+// handle.send(list) with list holding (data, port, ip) triples
+static void UdpSend(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    if (!args[0]->IsArray()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Array> list = args[0].As<v8::Array>();
+    size_t count = list->Length() / 3;
+    
+    UdpBinding* binding = wrap->binding;
+    std::vector<Datagram>& datagrams = binding->datagrams;
+    datagrams.resize(count);
+    
+    v8::Local<v8::Value> previous_host;
+    int previous_port = -1;
+    for (size_t i = 0; i < count; i++) {
+        v8::Local<v8::Value> data = list->Get(context, static_cast<uint32_t>(i * 3)).ToLocalChecked();
+        v8::Local<v8::Value> port_value = list->Get(context, static_cast<uint32_t>(i * 3 + 1)).ToLocalChecked();
+        v8::Local<v8::Value> host = list->Get(context, static_cast<uint32_t>(i * 3 + 2)).ToLocalChecked();
+        int port;
+        if (!data->IsArrayBufferView() || !host->IsString() || !ReadPort(context, port_value, &port)) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        
+        v8::Local<v8::ArrayBufferView> view = data.As<v8::ArrayBufferView>();
+        char* base = static_cast<char*>(view->Buffer()->Data());
+        datagrams[i].data = base ? base + view->ByteOffset() : nullptr;
+        datagrams[i].length = view->ByteLength();
+        
+        // Batches usually go to a handful of destinations, so reuse the last parse
+        if (i > 0 && port == previous_port && host->StrictEquals(previous_host)) {
+            datagrams[i].address = datagrams[i - 1].address;
+            datagrams[i].address_length = datagrams[i - 1].address_length;
+            continue;
+        }
+        int err = ParseAddress(isolate, host, port, &datagrams[i].address, &datagrams[i].address_length);
+        if (err != 0) {
+            args.GetReturnValue().Set(err);
+            return;
+        }
+        previous_host = host;
+        previous_port = port;
+    }
+    
+    // Sending directly would overtake datagrams libuv still has queued
+    int first_error = 0;
+    size_t sent = 0;
+    if (uv_udp_get_send_queue_count(&wrap->handle) == 0) {
+        sent = SendNow(wrap, datagrams.data(), count, &first_error);
+    }
+    if (sent == count) {
+        args.GetReturnValue().Set(first_error);
+        return;
+    }
+    
+    // Queue the rest on libuv, keeping the memory it is sent from alive
+    SendBatch* batch = new SendBatch();
+    batch->wrap = wrap;
+    for (size_t i = sent; i < count; i++) {
+        v8::Local<v8::Value> data = list->Get(context, static_cast<uint32_t>(i * 3)).ToLocalChecked();
+        std::shared_ptr<v8::BackingStore> store = data.As<v8::ArrayBufferView>()->Buffer()->GetBackingStore();
+        if (batch->stores.empty() || batch->stores.back() != store) {
+            batch->stores.push_back(std::move(store));
+        }
+        
+        SendReq* send_req = new SendReq();
+        send_req->batch = batch;
+        send_req->req.data = send_req;
+        uv_buf_t buf = uv_buf_init(datagrams[i].data, static_cast<unsigned int>(datagrams[i].length));
+        int err = uv_udp_send(&send_req->req, &wrap->handle, &buf, 1,
+                              reinterpret_cast<const sockaddr*>(&datagrams[i].address), OnSend);
+        if (err != 0) {
+            delete send_req;
+            if (first_error == 0) {
+                first_error = err;
+            }
+            continue;
+        }
+        batch->remaining++;
+    }
+    if (batch->remaining == 0) {
+        delete batch;
+        args.GetReturnValue().Set(first_error);
+        return;
+    }
+    batch->status = first_error;
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(1);
+}
+
+// handle.close(); onclose() follows once libuv has released the socket
+static void UdpClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    wrap->closing = true;
+    uv_close(reinterpret_cast<uv_handle_t*>(&wrap->handle), OnClose);
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(0);
+}
+
+// handle.getsockname(out)
+static void UdpGetSockName(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    if (!args[0]->IsObject()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    sockaddr_storage address;
+    int length = sizeof(address);
+    int err = uv_udp_getsockname(&wrap->handle, reinterpret_cast<sockaddr*>(&address), &length);
+    if (err == 0) {
+        const PropertyKeys& keys = PropertyKeys::Get(isolate);
+        char ip[INET6_ADDRSTRLEN];
+        int port;
+        v8::Local<v8::String> family;
+        if (address.ss_family == AF_INET6) {
+            const sockaddr_in6* in6 = reinterpret_cast<const sockaddr_in6*>(&address);
+            uv_ip6_name(in6, ip, sizeof(ip));
+            port = ntohs(in6->sin6_port);
+            family = keys.ipv6_string();
+        } else {
+            const sockaddr_in* in = reinterpret_cast<const sockaddr_in*>(&address);
+            uv_ip4_name(in, ip, sizeof(ip));
+            port = ntohs(in->sin_port);
+            family = keys.ipv4_string();
+        }
+        v8::Local<v8::Object> out = args[0].As<v8::Object>();
+        out->Set(context, keys.address_string(), v8::String::NewFromUtf8(isolate, ip).ToLocalChecked()).Check();
+        out->Set(context, keys.family_string(), family).Check();
+        out->Set(context, keys.port_string(), v8::Integer::New(isolate, port)).Check();
+    }
+    args.GetReturnValue().Set(err);
+}
+
+// handle.setBroadcast(on)
+static void UdpSetBroadcast(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        args.GetReturnValue().Set(uv_udp_set_broadcast(&wrap->handle, args[0]->BooleanValue(args.GetIsolate())));
+    }
+}
+
+// handle.setTTL(ttl)
+static void UdpSetTTL(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        int ttl = args[0]->Int32Value(args.GetIsolate()->GetCurrentContext()).FromMaybe(0);
+        args.GetReturnValue().Set(uv_udp_set_ttl(&wrap->handle, ttl));
+    }
+}
+
+// handle.setMulticastTTL(ttl)
+static void UdpSetMulticastTTL(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        int ttl = args[0]->Int32Value(args.GetIsolate()->GetCurrentContext()).FromMaybe(0);
+        args.GetReturnValue().Set(uv_udp_set_multicast_ttl(&wrap->handle, ttl));
+    }
+}
+
+// handle.setMulticastLoopback(on)
+static void UdpSetMulticastLoopback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        args.GetReturnValue().Set(uv_udp_set_multicast_loop(&wrap->handle, args[0]->BooleanValue(args.GetIsolate())));
+    }
+}
+
+// handle.setMembership(group, iface, join)
+static void UdpSetMembership(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    if (!args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::String::Utf8Value group(isolate, args[0]);
+    v8::String::Utf8Value iface(isolate, args[1]);
+    uv_membership membership = args[2]->BooleanValue(isolate) ? UV_JOIN_GROUP : UV_LEAVE_GROUP;
+    args.GetReturnValue().Set(uv_udp_set_membership(&wrap->handle, *group,
+                                                    args[1]->IsString() ? *iface : nullptr, membership));
+}
+
+// handle.bufferSize(size, receive): sets the size, or reads it when size is 0
+static void UdpBufferSize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (!wrap) {
+        return;
+    }
+    int value = args[0]->Int32Value(isolate->GetCurrentContext()).FromMaybe(0);
+    uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(&wrap->handle);
+    int err = args[1]->BooleanValue(isolate) ? uv_recv_buffer_size(handle, &value) : uv_send_buffer_size(handle, &value);
+    args.GetReturnValue().Set(err != 0 ? err : value);
+}
+
+// handle.getSendQueueSize()
+static void UdpGetSendQueueSize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        args.GetReturnValue().Set(static_cast<double>(uv_udp_get_send_queue_size(&wrap->handle)));
+    }
+}
+
+// handle.getSendQueueCount()
+static void UdpGetSendQueueCount(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        args.GetReturnValue().Set(static_cast<double>(uv_udp_get_send_queue_count(&wrap->handle)));
+    }
+}
+
+// handle.ref()
+static void UdpRef(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        uv_ref(reinterpret_cast<uv_handle_t*>(&wrap->handle));
+        WakeLoop(wrap);
+    }
+}
+
+// handle.unref(); an unreferenced handle does not keep the runtime alive
+static void UdpUnref(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    UdpWrap* wrap = UnwrapUdp(args);
+    if (wrap) {
+        uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle));
+        WakeLoop(wrap);
+    }
+}
+
+// Native setup function
+static void Setup(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    UdpBinding* binding = static_cast<UdpBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args[0]->IsObject()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Object> callbacks = args[0].As<v8::Object>();
+    
+    const struct {
+        const char* name;
+        v8::Global<v8::Function>* slot;
+    } kCallbacks[] = {
+        {"onmessage", &binding->onmessage},
+        {"onsend", &binding->onsend},
+        {"onclose", &binding->onclose},
+    };
+    for (const auto& entry : kCallbacks) {
+        v8::Local<v8::Value> value;
+        if (!callbacks->Get(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked()).ToLocal(&value) ||
+            !value->IsFunction()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        entry.slot->Reset(isolate, value.As<v8::Function>());
+    }
+    binding->context.Reset(isolate, context);
+}
+
+// Close every handle when the runtime is destroyed; libuv finishes the closes without V8
+static void CleanupBinding(UdpBinding* binding) {
+    for (UdpWrap* wrap : binding->wraps) {
+        wrap->binding = nullptr;
+        wrap->object.Reset();
+        if (!wrap->closing) {
+            wrap->closing = true;
+            uv_close(reinterpret_cast<uv_handle_t*>(&wrap->handle), OnClose);
+        }
+    }
+    if (binding->check) {
+        uv_close(reinterpret_cast<uv_handle_t*>(binding->check), [](uv_handle_t* handle) {
+            delete reinterpret_cast<uv_check_t*>(handle);
+        });
+    }
+    delete binding;
+}
+
+// Register the internal/udp module
+void RegisterDgramModule(Runtime* runtime) {
+    std::cout << "RegisterDgramModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        UdpBinding* binding = new UdpBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        
+        // Build the UDP handle class
+        v8::Local<v8::FunctionTemplate> udp_template = v8::FunctionTemplate::New(isolate, UdpConstructor, data);
+        udp_template->SetClassName(v8::String::NewFromUtf8(isolate, "UDP").ToLocalChecked());
+        udp_template->InstanceTemplate()->SetInternalFieldCount(1);
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kMethods[] = {
+            {"bind", UdpBind},
+            {"recvStart", UdpRecvStart},
+            {"recvStop", UdpRecvStop},
+            {"send", UdpSend},
+            {"close", UdpClose},
+            {"getsockname", UdpGetSockName},
+            {"setBroadcast", UdpSetBroadcast},
+            {"setTTL", UdpSetTTL},
+            {"setMulticastTTL", UdpSetMulticastTTL},
+            {"setMulticastLoopback", UdpSetMulticastLoopback},
+            {"setMembership", UdpSetMembership},
+            {"bufferSize", UdpBufferSize},
+            {"getSendQueueSize", UdpGetSendQueueSize},
+            {"getSendQueueCount", UdpGetSendQueueCount},
+            {"ref", UdpRef},
+            {"unref", UdpUnref},
+        };
+        for (const auto& entry : kMethods) {
+            udp_template->PrototypeTemplate()->Set(isolate, entry.name,
+                v8::FunctionTemplate::New(isolate, entry.callback));
+        }
+        
+        // Create the udp module object
+        v8::Local<v8::Object> udp = v8::Object::New(isolate);
+        udp->Set(context, v8::String::NewFromUtf8(isolate, "UDP").ToLocalChecked(),
+                 udp_template->GetFunction(context).ToLocalChecked()).Check();
+        
+        static const struct {
+            const char* name;
+            int value;
+        } kConstants[] = {
+            {"UV_UDP_IPV6ONLY", UV_UDP_IPV6ONLY},
+            {"UV_UDP_REUSEADDR", UV_UDP_REUSEADDR},
+            {"UV_EAFNOSUPPORT", UV_EAFNOSUPPORT},
+            {"UV_EADDRNOTAVAIL", UV_EADDRNOTAVAIL},
+            {"UV_EINVAL", UV_EINVAL},
+        };
+        v8::Local<v8::Object> constants = v8::Object::New(isolate);
+        for (const auto& entry : kConstants) {
+            constants->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Integer::New(isolate, entry.value)).Check();
+        }
+        udp->Set(context, v8::String::NewFromUtf8(isolate, "constants").ToLocalChecked(), constants).Check();
+        udp->Set(context, v8::String::NewFromUtf8(isolate, "setup").ToLocalChecked(),
+                 v8::Function::New(context, Setup, data).ToLocalChecked()).Check();
+        
+        // Register the udp module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/udp", udp);
+        
+        std::cout << "RegisterDgramModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterDgramModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterDgramModule" << std::endl;
+    }
+}
@@ -0,0 +1,409 @@
+#include "encoding.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TINY_NODE_ENCODING_SSE2 1
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define TINY_NODE_ENCODING_NEON 1
+#endif
+
+// Length of the leading ASCII run
+size_t AsciiPrefixLength(const uint8_t* data, size_t length) {
+    size_t i = 0;
+
+#if defined(TINY_NODE_ENCODING_SSE2)
+    // 64 bytes per iteration; the sign bits of all four vectors are OR'ed
+    for (; i + 64 <= length; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48));
+        __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d));
+        if (_mm_movemask_epi8(any) != 0) {
+            break;
+        }
+    }
+    for (; i + 16 <= length; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif defined(TINY_NODE_ENCODING_NEON)
+    for (; i + 16 <= length; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(data + i)) >= 0x80) {
+            break;
+        }
+    }
+#else
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) {
+            break;
+        }
+    }
+#endif
+    
+    while (i < length && data[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+// Decode one UTF-8 sequence starting with a non-ASCII byte
+//
+// Returns the code point, or -1 for an ill-formed subpart; *consumed is the
+// number of bytes to skip, which for errors is the maximal subpart length.
+static inline int32_t DecodeUtf8Sequence(const uint8_t* data, size_t length, size_t* consumed) {
+    uint8_t lead = data[0];
+    size_t needed;
+    uint8_t lower = 0x80;
+    uint8_t upper = 0xbf;
+    int32_t code_point;
+    
+    if (lead >= 0xc2 && lead <= 0xdf) {
+        needed = 1;
+        code_point = lead & 0x1f;
+    } else if (lead >= 0xe0 && lead <= 0xef) {
+        needed = 2;
+        code_point = lead & 0x0f;
+        if (lead == 0xe0) {
+            lower = 0xa0;
+        } else if (lead == 0xed) {
+            upper = 0x9f;
+        }
+    } else if (lead >= 0xf0 && lead <= 0xf4) {
+        needed = 3;
+        code_point = lead & 0x07;
+        if (lead == 0xf0) {
+            lower = 0x90;
+        } else if (lead == 0xf4) {
+            upper = 0x8f;
+        }
+    } else {
+        *consumed = 1;
+        return -1;
+    }
+    
+    size_t i = 1;
+    for (; i <= needed; i++) {
+        if (i >= length || data[i] < lower || data[i] > upper) {
+            *consumed = i;
+            return -1;
+        }
+        code_point = (code_point << 6) | (data[i] & 0x3f);
+        lower = 0x80;
+        upper = 0xbf;
+    }
+    
+    *consumed = i;
+    return code_point;
+}
+
+// Check if bytes are valid UTF-8
+bool IsValidUtf8(const uint8_t* data, size_t length) {
+    size_t i = AsciiPrefixLength(data, length);
+    while (i < length) {
+        if (data[i] < 0x80) {
+            i += AsciiPrefixLength(data + i, length - i);
+            continue;
+        }
+        size_t consumed;
+        if (DecodeUtf8Sequence(data + i, length - i, &consumed) < 0) {
+            return false;
+        }
+        i += consumed;
+    }
+    return true;
+}
+
+// Decode UTF-8 to UTF-16
+size_t Utf8ToUtf16(const uint8_t* data, size_t length, uint16_t* output) {
+    size_t i = 0;
+    size_t written = 0;
+    while (i < length) {
+        if (data[i] < 0x80) {
+            // Widen the whole ASCII run at once
+            size_t run = AsciiPrefixLength(data + i, length - i);
+            Latin1ToUtf16(data + i, run, output + written);
+            i += run;
+            written += run;
+            continue;
+        }
+        
+        size_t consumed;
+        int32_t code_point = DecodeUtf8Sequence(data + i, length - i, &consumed);
+        i += consumed;
+        if (code_point < 0) {
+            output[written++] = 0xfffd;
+        } else if (code_point >= 0x10000) {
+            code_point -= 0x10000;
+            output[written++] = static_cast<uint16_t>(0xd800 + (code_point >> 10));
+            output[written++] = static_cast<uint16_t>(0xdc00 + (code_point & 0x3ff));
+        } else {
+            output[written++] = static_cast<uint16_t>(code_point);
+        }
+    }
+    return written;
+}
+
+// Length of an unfinished UTF-8 sequence at the end of the bytes
+size_t Utf8IncompleteTailLength(const uint8_t* data, size_t length) {
+    // A sequence is at most 4 bytes, so its lead is in the last 3 bytes
+    for (size_t back = 1; back <= 3 && back <= length; back++) {
+        uint8_t byte = data[length - back];
+        if (byte < 0x80) {
+            return 0;
+        }
+        if (byte >= 0xc0) {
+            size_t consumed;
+            // Ill-formed when it stops before running out of input
+            if (DecodeUtf8Sequence(data + length - back, back, &consumed) < 0 && consumed == back) {
+                return back;
+            }
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// Widen Latin-1 to UTF-16
+void Latin1ToUtf16(const uint8_t* data, size_t length, uint16_t* output) {
+    size_t i = 0;
+
+#if defined(TINY_NODE_ENCODING_SSE2)
+    // Interleave with zero bytes: 16 characters in, 16 code units out
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#elif defined(TINY_NODE_ENCODING_NEON)
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t bytes = vld1q_u8(data + i);
+        vst1q_u16(output + i, vmovl_u8(vget_low_u8(bytes)));
+        vst1q_u16(output + i + 8, vmovl_u8(vget_high_u8(bytes)));
+    }
+#endif
+    
+    for (; i < length; i++) {
+        output[i] = data[i];
+    }
+}
+
+// UTF-8 length of Latin-1 characters
+size_t Latin1Utf8Length(const uint8_t* data, size_t length) {
+    size_t result = length;
+    size_t i = AsciiPrefixLength(data, length);
+    while (i < length) {
+        if (data[i] >= 0x80) {
+            result++;
+            i++;
+        } else {
+            i += AsciiPrefixLength(data + i, length - i);
+        }
+    }
+    return result;
+}
+
+// Encode Latin-1 characters as UTF-8 into a bounded buffer
+size_t Latin1ToUtf8(const uint8_t* data, size_t length, uint8_t* output, size_t capacity, size_t* read) {
+    size_t i = 0;
+    size_t written = 0;
+    while (i < length && written < capacity) {
+        if (data[i] < 0x80) {
+            // Copy the whole ASCII run at once
+            size_t run = AsciiPrefixLength(data + i, std::min(length - i, capacity - written));
+            std::memcpy(output + written, data + i, run);
+            i += run;
+            written += run;
+            continue;
+        }
+        if (capacity - written < 2) {
+            break;
+        }
+        output[written++] = static_cast<uint8_t>(0xc0 | (data[i] >> 6));
+        output[written++] = static_cast<uint8_t>(0x80 | (data[i] & 0x3f));
+        i++;
+    }
+    *read = i;
+    return written;
+}
+
+static const char kBase64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const char kBase64UrlAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+// Encoded base64 length
+size_t Base64EncodedLength(size_t length, bool url) {
+    if (url) {
+        return (length / 3) * 4 + (length % 3 == 0 ? 0 : length % 3 + 1);
+    }
+    return (length + 2) / 3 * 4;
+}
+
+// Encode bytes as base64
+size_t Base64Encode(const uint8_t* data, size_t length, char* output, bool url) {
+    const char* alphabet = url ? kBase64UrlAlphabet : kBase64Alphabet;
+    size_t i = 0;
+    char* out = output;
+    
+    for (; i + 3 <= length; i += 3) {
+        uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out[0] = alphabet[(triple >> 18) & 0x3f];
+        out[1] = alphabet[(triple >> 12) & 0x3f];
+        out[2] = alphabet[(triple >> 6) & 0x3f];
+        out[3] = alphabet[triple & 0x3f];
+        out += 4;
+    }
+    
+    size_t remaining = length - i;
+    if (remaining > 0) {
+        uint32_t triple = data[i] << 16;
+        if (remaining == 2) {
+            triple |= data[i + 1] << 8;
+        }
+        *out++ = alphabet[(triple >> 18) & 0x3f];
+        *out++ = alphabet[(triple >> 12) & 0x3f];
+        if (remaining == 2) {
+            *out++ = alphabet[(triple >> 6) & 0x3f];
+        } else if (!url) {
+            *out++ = '=';
+        }
+        if (!url) {
+            *out++ = '=';
+        }
+    }
+    return out - output;
+}
+
+// Base64 decoding table: 0-63 for digits, 64 for whitespace, 255 for anything else
+static const uint8_t* Base64DecodeTable() {
+    static const auto table = []() {
+        static uint8_t entries[256];
+        std::memset(entries, 255, sizeof(entries));
+        for (int i = 0; i < 64; i++) {
+            entries[static_cast<uint8_t>(kBase64Alphabet[i])] = static_cast<uint8_t>(i);
+            entries[static_cast<uint8_t>(kBase64UrlAlphabet[i])] = static_cast<uint8_t>(i);
+        }
+        for (const char* space = " \t\n\r\f\v"; *space; space++) {
+            entries[static_cast<uint8_t>(*space)] = 64;
+        }
+        return entries;
+    }();
+    return table;
+}
+
+// Decode base64
+size_t Base64Decode(const uint8_t* data, size_t length, uint8_t* output) {
+    const uint8_t* table = Base64DecodeTable();
+    size_t i = 0;
+    uint8_t* out = output;
+    
+    // Fast path: four valid digits at a time
+    while (i + 4 <= length) {
+        uint8_t a = table[data[i]];
+        uint8_t b = table[data[i + 1]];
+        uint8_t c = table[data[i + 2]];
+        uint8_t d = table[data[i + 3]];
+        if ((a | b | c | d) >= 64) {
+            break;
+        }
+        uint32_t triple = (a << 18) | (b << 12) | (c << 6) | d;
+        out[0] = static_cast<uint8_t>(triple >> 16);
+        out[1] = static_cast<uint8_t>(triple >> 8);
+        out[2] = static_cast<uint8_t>(triple);
+        out += 3;
+        i += 4;
+    }
+    
+    // Slow path: skip whitespace, stop at padding or invalid characters
+    uint32_t accumulator = 0;
+    int bits = 0;
+    for (; i < length; i++) {
+        uint8_t value = table[data[i]];
+        if (value == 64) {
+            continue;
+        }
+        if (value == 255) {
+            break;
+        }
+        accumulator = (accumulator << 6) | value;
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            *out++ = static_cast<uint8_t>(accumulator >> bits);
+        }
+    }
+    return out - output;
+}
+
+static const char kHexDigits[] = "0123456789abcdef";
+
+// Encode bytes as hex
+void HexEncode(const uint8_t* data, size_t length, char* output) {
+    size_t i = 0;
+
+#if defined(TINY_NODE_ENCODING_SSE2)
+    // Split into nibbles, map 0-9 to '0'-'9' and 10-15 to 'a'-'f', interleave
+    const __m128i low_mask = _mm_set1_epi8(0x0f);
+    const __m128i zero_char = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    const __m128i letter_offset = _mm_set1_epi8('a' - '0' - 10);
+    for (; i + 16 <= length; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), low_mask);
+        __m128i low = _mm_and_si128(bytes, low_mask);
+        high = _mm_add_epi8(_mm_add_epi8(high, zero_char),
+                            _mm_and_si128(_mm_cmpgt_epi8(high, nine), letter_offset));
+        low = _mm_add_epi8(_mm_add_epi8(low, zero_char),
+                           _mm_and_si128(_mm_cmpgt_epi8(low, nine), letter_offset));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * i), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 2 * i + 16), _mm_unpackhi_epi8(high, low));
+    }
+#elif defined(TINY_NODE_ENCODING_NEON)
+    const uint8x16_t digits = vld1q_u8(reinterpret_cast<const uint8_t*>(kHexDigits));
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t bytes = vld1q_u8(data + i);
+        uint8x16x2_t pairs;
+        pairs.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(bytes, 4));
+        pairs.val[1] = vqtbl1q_u8(digits, vandq_u8(bytes, vdupq_n_u8(0x0f)));
+        vst2q_u8(reinterpret_cast<uint8_t*>(output + 2 * i), pairs);
+    }
+#endif
+    
+    for (; i < length; i++) {
+        output[2 * i] = kHexDigits[data[i] >> 4];
+        output[2 * i + 1] = kHexDigits[data[i] & 0x0f];
+    }
+}
+
+// Value of a hex digit, or -1
+static inline int HexValue(uint8_t c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+// Decode hex
+size_t HexDecode(const uint8_t* data, size_t length, uint8_t* output) {
+    size_t pairs = length / 2;
+    for (size_t i = 0; i < pairs; i++) {
+        int high = HexValue(data[2 * i]);
+        int low = HexValue(data[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return i;
+        }
+        output[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return pairs;
+}
@@ -0,0 +1,447 @@
+#include "encoding_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "encoding.h"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Encoding codes shared with lib/util.js through the encodings object
+enum DecoderEncoding {
+    kDecoderUtf8 = 0,
+    kDecoderUtf16Le = 1,
+    kDecoderWindows1252 = 2,
+};
+
+// Flags for decode()
+enum DecoderFlags {
+    kDecodeFatal = 1,
+    kDecodeIgnoreBom = 2,
+    kDecodeStream = 4,
+};
+
+// Layout of the decoder state array: bytes held back from the previous
+// chunk, how many there are, and whether the BOM has been dealt with
+static constexpr size_t kStatePending = 0;
+static constexpr size_t kStatePendingLength = 4;
+static constexpr size_t kStateBomSeen = 5;
+static constexpr size_t kStateSize = 8;
+
+// Code points of bytes 0x80-0x9F in windows-1252; the rest match Latin-1
+static const uint16_t kWindows1252High[32] = {
+    0x20ac, 0x0081, 0x201a, 0x0192, 0x201e, 0x2026, 0x2020, 0x2021,
+    0x02c6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008d, 0x017d, 0x008f,
+    0x0090, 0x2018, 0x2019, 0x201c, 0x201d, 0x2022, 0x2013, 0x2014,
+    0x02dc, 0x2122, 0x0161, 0x203a, 0x0153, 0x009d, 0x017e, 0x0178,
+};
+
+// Result of decoding one chunk: either bytes usable as a one-byte string
+// as they are, or UTF-16 code units
+struct DecodedText {
+    const uint8_t* one_byte = nullptr;
+    size_t one_byte_length = 0;
+    std::vector<uint16_t> units;
+    bool invalid = false;
+};
+
+// Get the bytes of a Uint8Array (or any ArrayBufferView)
+static bool GetBytes(v8::Local<v8::Value> value, uint8_t** data, size_t* length) {
+    if (!value->IsArrayBufferView()) {
+        return false;
+    }
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    *data = static_cast<uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+    *length = view->ByteLength();
+    return true;
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Length of the UTF-8 sequence a lead byte starts
+static size_t Utf8SequenceLength(uint8_t lead) {
+    if (lead < 0xe0) {
+        return 2;
+    }
+    return lead < 0xf0 ? 3 : 4;
+}
+
+// Decode a UTF-8 chunk, finishing the sequence held back from the last one
+static void DecodeUtf8(uint8_t* state, const uint8_t* input, size_t length, bool stream, DecodedText* text) {
+    uint8_t head[4];
+    size_t head_length = state[kStatePendingLength];
+    size_t offset = 0;
+    std::memcpy(head, state + kStatePending, head_length);
+    
+    // Complete the held back sequence with continuation bytes from this chunk
+    if (head_length > 0) {
+        size_t needed = Utf8SequenceLength(head[0]);
+        while (head_length < needed && offset < length && (input[offset] & 0xc0) == 0x80) {
+            head[head_length++] = input[offset++];
+        }
+        if (head_length < needed && offset == length && stream &&
+            Utf8IncompleteTailLength(head, head_length) == head_length) {
+            // Still unfinished; keep waiting
+            std::memcpy(state + kStatePending, head, head_length);
+            state[kStatePendingLength] = static_cast<uint8_t>(head_length);
+            return;
+        }
+    }
+    
+    const uint8_t* body = input + offset;
+    size_t body_length = length - offset;
+    size_t tail = stream ? Utf8IncompleteTailLength(body, body_length) : 0;
+    body_length -= tail;
+    std::memcpy(state + kStatePending, body + body_length, tail);
+    state[kStatePendingLength] = static_cast<uint8_t>(tail);
+    
+    if (head_length == 0 && AsciiPrefixLength(body, body_length) == body_length) {
+        text->one_byte = body;
+        text->one_byte_length = body_length;
+        return;
+    }
+    
+    text->invalid = !IsValidUtf8(head, head_length) || !IsValidUtf8(body, body_length);
+    text->units.resize(head_length + body_length);
+    size_t count = Utf8ToUtf16(head, head_length, text->units.data());
+    count += Utf8ToUtf16(body, body_length, text->units.data() + count);
+    text->units.resize(count);
+}
+
+// Decode a UTF-16LE chunk, replacing lone surrogates
+static void DecodeUtf16Le(uint8_t* state, const uint8_t* input, size_t length, bool stream, DecodedText* text) {
+    size_t pending = state[kStatePendingLength];
+    size_t total = pending + length;
+    std::vector<uint16_t>& units = text->units;
+    units.resize(total / 2);
+    
+    // Pair up the held back bytes first, then copy the rest in one go
+    uint8_t lead[4];
+    size_t lead_length = pending;
+    size_t taken = 0;
+    std::memcpy(lead, state + kStatePending, pending);
+    if (lead_length % 2 != 0 && length > 0) {
+        lead[lead_length++] = input[taken++];
+    }
+    size_t count = 0;
+    for (size_t i = 0; i + 1 < lead_length; i += 2) {
+        units[count++] = static_cast<uint16_t>(lead[i] | (lead[i + 1] << 8));
+    }
+    size_t remaining = (length - taken) / 2;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (remaining > 0) {
+        std::memcpy(units.data() + count, input + taken, remaining * 2);
+    }
+#else
+    for (size_t i = 0; i < remaining; i++) {
+        units[count + i] = static_cast<uint16_t>(input[taken + 2 * i] | (input[taken + 2 * i + 1] << 8));
+    }
+#endif
+    count += remaining;
+    
+    // A byte left over when the total is odd
+    bool odd_byte = total % 2 != 0;
+    uint8_t last_byte = lead_length % 2 != 0 ? lead[lead_length - 1] : (length > 0 ? input[length - 1] : 0);
+    
+    // Hold back a trailing high surrogate and odd byte while streaming
+    size_t held = 0;
+    if (stream) {
+        if (count > 0 && units[count - 1] >= 0xd800 && units[count - 1] <= 0xdbff) {
+            count--;
+            state[kStatePending + held++] = static_cast<uint8_t>(units[count]);
+            state[kStatePending + held++] = static_cast<uint8_t>(units[count] >> 8);
+        }
+        if (odd_byte) {
+            state[kStatePending + held++] = last_byte;
+        }
+    }
+    state[kStatePendingLength] = static_cast<uint8_t>(held);
+    
+    // A lone high surrogate followed by an odd byte at the end is one error
+    bool trailing_high = count > 0 && units[count - 1] >= 0xd800 && units[count - 1] <= 0xdbff;
+    
+    for (size_t i = 0; i < count; i++) {
+        uint16_t unit = units[i];
+        if (unit < 0xd800 || unit > 0xdfff) {
+            continue;
+        }
+        if (unit <= 0xdbff && i + 1 < count && units[i + 1] >= 0xdc00 && units[i + 1] <= 0xdfff) {
+            i++;
+            continue;
+        }
+        units[i] = 0xfffd;
+        text->invalid = true;
+    }
+    units.resize(count);
+    
+    if (!stream && odd_byte) {
+        if (!trailing_high) {
+            units.push_back(0xfffd);
+        }
+        text->invalid = true;
+    }
+}
+
+// Decode a windows-1252 chunk; it is stateless and never invalid
+static void DecodeWindows1252(const uint8_t* input, size_t length, DecodedText* text) {
+    size_t ascii = AsciiPrefixLength(input, length);
+    bool has_high = false;
+    for (size_t i = ascii; i < length && !has_high; i++) {
+        has_high = input[i] >= 0x80 && input[i] <= 0x9f;
+    }
+    if (!has_high) {
+        // Plain Latin-1 maps one to one onto a one-byte string
+        text->one_byte = input;
+        text->one_byte_length = length;
+        return;
+    }
+    
+    text->units.resize(length);
+    Latin1ToUtf16(input, length, text->units.data());
+    for (size_t i = ascii; i < length; i++) {
+        if (input[i] >= 0x80 && input[i] <= 0x9f) {
+            text->units[i] = kWindows1252High[input[i] - 0x80];
+        }
+    }
+}
+
+// encode(string)
+static void Encode(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::Local<v8::String> string = args[0].As<v8::String>();
+    std::unique_ptr<v8::BackingStore> store;
+    
+    if (string->IsOneByte()) {
+        // Copy the characters straight into the result; that is already the
+        // UTF-8 encoding unless some are outside ASCII
+        size_t length = static_cast<size_t>(string->Length());
+        store = v8::ArrayBuffer::NewBackingStore(isolate, length);
+        uint8_t* data = static_cast<uint8_t*>(store->Data());
+        string->WriteOneByte(isolate, data, 0, static_cast<int>(length), v8::String::NO_NULL_TERMINATION);
+        
+        size_t ascii = AsciiPrefixLength(data, length);
+        if (ascii != length) {
+            size_t utf8_length = ascii + Latin1Utf8Length(data + ascii, length - ascii);
+            std::unique_ptr<v8::BackingStore> wide = v8::ArrayBuffer::NewBackingStore(isolate, utf8_length);
+            uint8_t* output = static_cast<uint8_t*>(wide->Data());
+            size_t read;
+            std::memcpy(output, data, ascii);
+            Latin1ToUtf8(data + ascii, length - ascii, output + ascii, utf8_length - ascii, &read);
+            store = std::move(wide);
+        }
+    } else {
+        size_t length = static_cast<size_t>(string->Utf8Length(isolate));
+        store = v8::ArrayBuffer::NewBackingStore(isolate, length);
+        string->WriteUtf8(isolate, static_cast<char*>(store->Data()), static_cast<int>(length), nullptr,
+                          v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+    }
+    
+    // Create the array in the caller's context so instanceof Uint8Array holds
+    v8::Local<v8::Context> context = isolate->GetEnteredOrMicrotaskContext();
+    v8::Context::Scope context_scope(context);
+    size_t byte_length = store->ByteLength();
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(store));
+    args.GetReturnValue().Set(v8::Uint8Array::New(buffer, 0, byte_length));
+}
+
+// encodeInto(string, target, results)
+static void EncodeInto(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    uint8_t* target;
+    size_t capacity;
+    if (args.Length() < 3 || !args[0]->IsString() || !GetBytes(args[1], &target, &capacity) ||
+        !args[2]->IsUint32Array() || args[2].As<v8::Uint32Array>()->Length() < 2) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::Local<v8::String> string = args[0].As<v8::String>();
+    size_t length = static_cast<size_t>(string->Length());
+    size_t read;
+    size_t written;
+    
+    if (string->IsOneByte()) {
+        size_t count = std::min(length, capacity);
+        string->WriteOneByte(isolate, target, 0, static_cast<int>(count), v8::String::NO_NULL_TERMINATION);
+        size_t ascii = AsciiPrefixLength(target, count);
+        if (ascii == count) {
+            read = count;
+            written = count;
+        } else {
+            // Expand the rest from a copy; each character takes at least a
+            // byte, so no more than the remaining capacity can fit
+            size_t rest = std::min(length, capacity) - ascii;
+            std::unique_ptr<uint8_t[]> characters(new uint8_t[rest]);
+            string->WriteOneByte(isolate, characters.get(), static_cast<int>(ascii), static_cast<int>(rest),
+                                 v8::String::NO_NULL_TERMINATION);
+            size_t rest_read;
+            written = ascii + Latin1ToUtf8(characters.get(), rest, target + ascii, capacity - ascii, &rest_read);
+            read = ascii + rest_read;
+        }
+    } else {
+        int characters = 0;
+        written = static_cast<size_t>(string->WriteUtf8(isolate, reinterpret_cast<char*>(target),
+            static_cast<int>(std::min<size_t>(capacity, INT32_MAX)), &characters,
+            v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8));
+        read = static_cast<size_t>(characters);
+    }
+    
+    uint8_t* results;
+    size_t results_length;
+    GetBytes(args[2], &results, &results_length);
+    uint32_t values[2] = {static_cast<uint32_t>(read), static_cast<uint32_t>(written)};
+    std::memcpy(results, values, sizeof(values));
+}
+
+// decode(state, input, encoding, flags)
+static void Decode(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uint8_t* state;
+    size_t state_length;
+    uint8_t* input;
+    size_t length;
+    if (args.Length() < 4 || !GetBytes(args[0], &state, &state_length) || state_length < kStateSize ||
+        !GetBytes(args[1], &input, &length) || !args[2]->IsInt32() || !args[3]->IsInt32()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    int encoding = args[2]->Int32Value(context).FromJust();
+    int flags = args[3]->Int32Value(context).FromJust();
+    bool stream = (flags & kDecodeStream) != 0;
+    
+    DecodedText text;
+    switch (encoding) {
+        case kDecoderUtf8:
+            DecodeUtf8(state, input, length, stream, &text);
+            break;
+        case kDecoderUtf16Le:
+            DecodeUtf16Le(state, input, length, stream, &text);
+            break;
+        case kDecoderWindows1252:
+            DecodeWindows1252(input, length, &text);
+            break;
+        default:
+            ThrowInvalidArguments(isolate);
+            return;
+    }
+    
+    if (text.invalid && (flags & kDecodeFatal)) {
+        std::memset(state, 0, kStateSize);
+        static const char* const kEncodingErrors[] = {
+            "The encoded data was not valid for encoding utf-8",
+            "The encoded data was not valid for encoding utf-16le",
+            "The encoded data was not valid for encoding windows-1252",
+        };
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, kEncodingErrors[encoding]).ToLocalChecked()));
+        return;
+    }
+    
+    // Strip a leading BOM once per stream
+    const uint16_t* units = text.units.data();
+    size_t count = text.units.size();
+    if (text.one_byte_length > 0 || count > 0) {
+        if (!state[kStateBomSeen] && !(flags & kDecodeIgnoreBom) && count > 0 && units[0] == 0xfeff) {
+            units++;
+            count--;
+        }
+        state[kStateBomSeen] = 1;
+    }
+    
+    // The next call after a flush starts a new stream
+    if (!stream) {
+        std::memset(state, 0, kStateSize);
+    }
+    
+    v8::MaybeLocal<v8::String> result;
+    if (text.one_byte != nullptr) {
+        result = v8::String::NewFromOneByte(isolate, text.one_byte, v8::NewStringType::kNormal,
+                                            static_cast<int>(text.one_byte_length));
+    } else {
+        result = v8::String::NewFromTwoByte(isolate, units, v8::NewStringType::kNormal, static_cast<int>(count));
+    }
+    
+    v8::Local<v8::String> string;
+    if (!result.ToLocal(&string)) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Cannot create a string longer than the maximum length").ToLocalChecked()));
+        return;
+    }
+    args.GetReturnValue().Set(string);
+}
+
+// Register the internal/encoding module
+void RegisterEncodingModule(Runtime* runtime) {
+    std::cout << "RegisterEncodingModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the encoding module object
+        v8::Local<v8::Object> encoding = v8::Object::New(isolate);
+        
+        static const struct {
+            const char* name;
+            DecoderEncoding encoding;
+        } kEncodingNames[] = {
+            {"utf-8", kDecoderUtf8},
+            {"utf-16le", kDecoderUtf16Le},
+            {"windows-1252", kDecoderWindows1252},
+        };
+        v8::Local<v8::Object> encodings = v8::Object::New(isolate);
+        for (const auto& entry : kEncodingNames) {
+            encodings->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Integer::New(isolate, entry.encoding)).Check();
+        }
+        encoding->Set(context, v8::String::NewFromUtf8(isolate, "encodings").ToLocalChecked(), encodings).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"encode", Encode},
+            {"encodeInto", EncodeInto},
+            {"decode", Decode},
+        };
+        for (const auto& entry : kFunctions) {
+            encoding->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Function::New(context, entry.callback).ToLocalChecked()).Check();
+        }
+        
+        // Register the encoding module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/encoding", encoding);
+        
+        std::cout << "RegisterEncodingModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterEncodingModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterEncodingModule" << std::endl;
+    }
+}
@@ -1,15 +1,33 @@
 #include "event_loop.h"
 #include "runtime.h"
 #include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <poll.h>
 
 // Constructor
 EventLoop::EventLoop(Runtime* runtime)
-    : runtime_(runtime), running_(false), next_task_id_(1) {
+    : runtime_(runtime), queues_closed_(false), next_listener_id_(1), running_batch_(false),
+      uv_alive_(false), uv_ready_(false), running_(false), wake_requested_(false), next_task_id_(1),
+      slice_interval_(0), slice_stop_(false), yield_requested_(false), progress_(0), slice_count_(0),
+      batch_waiting_(false), in_uv_(false) {
+    uv_loop_init(&uv_loop_);
+    
+    // Only used to interrupt a wait on the backend descriptor
+    uv_async_init(&uv_loop_, &wake_async_, nullptr);
+    uv_unref(reinterpret_cast<uv_handle_t*>(&wake_async_));
 }
 
 // Destructor
 EventLoop::~EventLoop() {
     Stop();
+    
+    // The runtime has closed its handles by now; let their close callbacks run
+    uv_close(reinterpret_cast<uv_handle_t*>(&wake_async_), nullptr);
+    uv_run(&uv_loop_, UV_RUN_DEFAULT);
+    if (uv_loop_close(&uv_loop_) != 0) {
+        std::cerr << "EventLoop: libuv loop closed with open handles" << std::endl;
+    }
 }
 
 // Start the event loop
@@ -22,36 +40,290 @@ void EventLoop::Start() {
     thread_ = std::thread(&EventLoop::Run, this);
 }
 
+// Pin the event loop thread
+void EventLoop::SetAffinity(const CpuAffinity& affinity) {
+    affinity_ = affinity;
+}
+
 // Stop the event loop
 void EventLoop::Stop() {
+    // Producers waiting for room must not wait for a loop that no longer runs
+    CloseQueues();
+    
+    // Stop interrupting JavaScript first; the runtime is shutting down
+    {
+        std::lock_guard<std::mutex> lock(slice_mutex_);
+        slice_stop_ = true;
+        slice_cv_.notify_one();
+    }
+    if (slice_thread_.joinable()) {
+        slice_thread_.join();
+    }
+    
     if (!running_) {
         return;
     }
     
+    running_ = false;
+    Wake();
+    
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+// Stop making producers wait for room
+void EventLoop::CloseQueues() {
     {
         std::lock_guard<std::mutex> lock(queue_mutex_);
-        running_ = false;
+        queues_closed_ = true;
+    }
+    space_cv_.notify_all();
+}
+
+// Schedule a task to be executed on the event loop
+void EventLoop::ScheduleTask(std::function<void()> task, TaskLane lane) {
+    // The thread holding the isolate is the one that would have to make room
+    bool can_wait = !v8::Locker::IsLocked(runtime_->GetIsolate());
+    bool paused;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (can_wait) {
+            WaitForRoomLocked(lock, lane);
+        }
+        paused = PushTask(lane, std::move(task));
         queue_cv_.notify_one();
     }
     
-    if (thread_.joinable()) {
-        thread_.join();
+    if (paused) {
+        NotifyBackpressure(lane);
+    }
+    if (uv_alive_) {
+        uv_async_send(&wake_async_);
     }
 }
 
-// Schedule a task to be executed on the event loop
-void EventLoop::ScheduleTask(std::function<void()> task) {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    task_queue_.push(task);
+// Wait while a lane is paused, unless this thread holds the isolate
+void EventLoop::WaitForRoom(TaskLane lane) {
+    if (v8::Locker::IsLocked(runtime_->GetIsolate())) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    WaitForRoomLocked(lock, lane);
+}
+
+// Wait with queue_mutex_ held until a lane resumes or the queues close
+void EventLoop::WaitForRoomLocked(std::unique_lock<std::mutex>& lock, TaskLane lane) {
+    // Without a loop thread, the host that pumps the loop may be the very producer that would wait
+    Lane& target = lanes_[static_cast<size_t>(lane)];
+    if (!target.stats.paused || queues_closed_ || !running_) {
+        return;
+    }
+    target.stats.waits++;
+    
+    // Wake the loop first; it may be waiting for the tasks this producer queued
     queue_cv_.notify_one();
+    if (uv_alive_) {
+        uv_async_send(&wake_async_);
+    }
+    space_cv_.wait(lock, [this, &target] { return !target.stats.paused || queues_closed_ || !running_; });
+}
+
+// Schedule a task unless its lane is full
+ScheduleResult EventLoop::TrySchedule(std::function<void()> task, TaskLane lane) {
+    bool paused;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        Lane& target = lanes_[static_cast<size_t>(lane)];
+        if (target.stats.paused) {
+            target.stats.rejected++;
+            return ScheduleResult::kFull;
+        }
+        paused = PushTask(lane, std::move(task));
+        queue_cv_.notify_one();
+    }
+    
+    if (paused) {
+        NotifyBackpressure(lane);
+    }
+    if (uv_alive_) {
+        uv_async_send(&wake_async_);
+    }
+    return ScheduleResult::kOk;
+}
+
+// Schedule the continuation of a yielded task
+void EventLoop::ScheduleContinuation(std::function<void()> task) {
+    ScheduleTask(std::move(task), TaskLane::kContinuation);
+}
+
+// Schedule the result of thread pool work, over capacity if need be
+void EventLoop::ScheduleCompletion(std::function<void()> task) {
+    bool paused;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        paused = PushTask(TaskLane::kCompletion, std::move(task));
+        queue_cv_.notify_one();
+    }
+    
+    if (paused) {
+        NotifyBackpressure(TaskLane::kCompletion);
+    }
+    if (uv_alive_) {
+        uv_async_send(&wake_async_);
+    }
+}
+
+// Set the capacity of a lane
+void EventLoop::SetLaneCapacity(TaskLane lane, size_t capacity) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        TaskLaneStats& stats = lanes_[static_cast<size_t>(lane)].stats;
+        stats.capacity = capacity;
+        stats.paused = capacity > 0 && stats.depth >= capacity;
+    }
+    space_cv_.notify_all();
+    NotifyBackpressure(lane);
+}
+
+// Get the counters of a lane
+TaskLaneStats EventLoop::GetLaneStats(TaskLane lane) {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    return lanes_[static_cast<size_t>(lane)].stats;
+}
+
+// Register a backpressure listener
+uint64_t EventLoop::AddBackpressureListener(TaskLane lane, std::function<void(bool paused)> listener) {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    uint64_t listener_id = next_listener_id_++;
+    listeners_[listener_id] = std::make_pair(lane, std::move(listener));
+    return listener_id;
+}
+
+// Unregister a backpressure listener
+void EventLoop::RemoveBackpressureListener(uint64_t listener_id) {
+    std::lock_guard<std::mutex> lock(listeners_mutex_);
+    listeners_.erase(listener_id);
+}
+
+// Add a task to a lane
+bool EventLoop::PushTask(TaskLane lane, std::function<void()> task) {
+    Lane& target = lanes_[static_cast<size_t>(lane)];
+    target.tasks.push(std::move(task));
+    TaskLaneStats& stats = target.stats;
+    stats.scheduled++;
+    stats.depth++;
+    stats.high_water = std::max(stats.high_water, stats.depth);
+    if (stats.capacity > 0 && stats.depth >= stats.capacity && !stats.paused) {
+        stats.paused = true;
+        return true;
+    }
+    return false;
+}
+
+// Check whether any lane has tasks queued
+bool EventLoop::HasQueuedTasks() const {
+    for (const Lane& lane : lanes_) {
+        if (!lane.tasks.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Take every queued task, continuations first
+void EventLoop::TakeBatch(std::queue<std::function<void()>>* batch, size_t (&counts)[kTaskLaneCount]) {
+    static constexpr TaskLane kOrder[] = {TaskLane::kContinuation, TaskLane::kTask, TaskLane::kCompletion};
+    for (TaskLane lane : kOrder) {
+        std::queue<std::function<void()>>& tasks = lanes_[static_cast<size_t>(lane)].tasks;
+        counts[static_cast<size_t>(lane)] = tasks.size();
+        if (batch->empty()) {
+            batch->swap(tasks);
+            continue;
+        }
+        while (!tasks.empty()) {
+            batch->push(std::move(tasks.front()));
+            tasks.pop();
+        }
+    }
+}
+
+// Run a batch and release its lane depth
+void EventLoop::RunBatch(std::queue<std::function<void()>>* batch, const size_t (&counts)[kTaskLaneCount]) {
+    while (!batch->empty()) {
+        // Tasks behind this one wait for it just as queued ones do
+        batch_waiting_ = batch->size() > 1;
+        RunTask(batch->front());
+        batch->pop();
+        
+        // A task that held the isolate for a whole slice lets ready I/O run before the next one.
+        // The rest of the batch keeps its order; due timers and new tasks wait for the next batch.
+        if (!batch->empty() && yield_requested_.exchange(false) && !in_uv_) {
+            uv_alive_ = RunUv();
+            progress_++;
+        }
+    }
+    
+    // Lanes that drained to half their capacity resume their producers
+    bool resumed[kTaskLaneCount] = {};
+    bool any_resumed = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        for (size_t i = 0; i < kTaskLaneCount; i++) {
+            TaskLaneStats& stats = lanes_[i].stats;
+            stats.depth -= counts[i];
+            if (stats.paused && stats.depth <= stats.capacity / 2) {
+                stats.paused = false;
+                resumed[i] = true;
+                any_resumed = true;
+            }
+        }
+    }
+    if (!any_resumed) {
+        return;
+    }
+    space_cv_.notify_all();
+    for (size_t i = 0; i < kTaskLaneCount; i++) {
+        if (resumed[i]) {
+            NotifyBackpressure(static_cast<TaskLane>(i));
+        }
+    }
+}
+
+// Tell the listeners of a lane whose paused state changed
+void EventLoop::NotifyBackpressure(TaskLane lane) {
+    // Report the state as it is now, so calls racing from two threads cannot arrive out of order
+    std::lock_guard<std::mutex> listeners_lock(listeners_mutex_);
+    bool paused;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        Lane& target = lanes_[static_cast<size_t>(lane)];
+        paused = target.stats.paused;
+        if (paused == target.notified_paused) {
+            return;
+        }
+        target.notified_paused = paused;
+    }
+    
+    for (auto& entry : listeners_) {
+        if (entry.second.first == lane) {
+            entry.second.second(paused);
+        }
+    }
 }
 
 // Schedule a task to be executed after a delay (in milliseconds)
 uint64_t EventLoop::ScheduleDelayedTask(std::function<void()> task, uint64_t delay_ms) {
-    std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
-    uint64_t task_id = next_task_id_++;
-    auto execution_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
-    delayed_tasks_[task_id] = std::make_pair(execution_time, task);
+    uint64_t task_id;
+    {
+        std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+        task_id = next_task_id_++;
+        auto execution_time = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+        delayed_tasks_[task_id] = std::make_pair(execution_time, task);
+    }
+    
+    // A pumping thread may be waiting for longer than this delay
+    Wake();
     return task_id;
 }
 
@@ -66,50 +338,189 @@ bool EventLoop::IsRunning() const {
     return running_;
 }
 
+// Wake up a thread blocked in RunOnce
+void EventLoop::Wake() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        wake_requested_ = true;
+        queue_cv_.notify_one();
+    }
+    
+    // A waiting thread watches the backend descriptor rather than the condition variable
+    if (uv_alive_) {
+        uv_async_send(&wake_async_);
+    }
+}
+
+// Check whether any work is pending
+bool EventLoop::HasPendingTasks() {
+    // Due delayed tasks move to the queue under this lock, so check it first
+    {
+        std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+        if (!delayed_tasks_.empty()) {
+            return true;
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (HasQueuedTasks() || running_batch_) {
+            return true;
+        }
+    }
+    
+    v8::Isolate* isolate = runtime_->GetIsolate();
+    v8::Locker locker(isolate);
+    return uv_loop_alive(&uv_loop_) != 0;
+}
+
+// Drop the tasks and timers that have not run yet
+void EventLoop::DiscardPendingTasks() {
+    std::map<uint64_t, std::pair<std::chrono::steady_clock::time_point, std::function<void()>>> delayed_tasks;
+    std::queue<std::function<void()>> tasks[kTaskLaneCount];
+    {
+        std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+        delayed_tasks.swap(delayed_tasks_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        for (size_t i = 0; i < kTaskLaneCount; i++) {
+            tasks[i].swap(lanes_[i].tasks);
+            lanes_[i].stats.depth = 0;
+            lanes_[i].stats.paused = false;
+        }
+    }
+    space_cv_.notify_all();
+    
+    // The tasks are destroyed on return, outside the locks
+}
+
+// Get the libuv loop
+uv_loop_t* EventLoop::GetUvLoop() {
+    return &uv_loop_;
+}
+
 // Event loop thread function
 void EventLoop::Run() {
+    affinity_.ApplyToCurrentThread();
     while (running_) {
-        // Process delayed tasks
-        ProcessDelayedTasks();
-        
-        // Process regular tasks
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            if (task_queue_.empty()) {
-                // Wait for a task or timeout after 10ms to check delayed tasks
-                queue_cv_.wait_for(lock, std::chrono::milliseconds(10), [this] {
-                    return !task_queue_.empty() || !running_;
-                });
-                
-                if (!running_) {
-                    break;
-                }
-                
-                if (task_queue_.empty()) {
-                    continue;
-                }
+        // Wait at most 10ms so stop requests and new delayed tasks are noticed
+        RunOnce(10);
+    }
+}
+
+// Run one iteration of the event loop on the calling thread
+size_t EventLoop::RunOnce(uint64_t timeout_ms) {
+    // Process delayed tasks, and never sleep past the next one
+    std::chrono::milliseconds wait = ProcessDelayedTasks(std::chrono::milliseconds(timeout_ms));
+    
+    // libuv callbacks that are already due must not wait
+    if (uv_ready_) {
+        wait = std::chrono::milliseconds(0);
+    }
+    
+    bool has_tasks;
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (!HasQueuedTasks() && !wake_requested_ && wait.count() > 0) {
+            if (uv_alive_) {
+                lock.unlock();
+                WaitForEvents(wait);
+                lock.lock();
+            } else {
+                queue_cv_.wait_for(lock, wait, [this] { return HasQueuedTasks() || wake_requested_; });
             }
-            
-            task = task_queue_.front();
-            task_queue_.pop();
         }
-        
-        // Execute the task
-        try {
-            task();
-        } catch (const std::exception& e) {
-            std::cerr << "Exception in event loop task: " << e.what() << std::endl;
-        } catch (...) {
-            std::cerr << "Unknown exception in event loop task" << std::endl;
+        wake_requested_ = false;
+        has_tasks = HasQueuedTasks();
+        running_batch_ = true;
+    }
+    
+    // Take the whole batch so producers are not blocked while tasks run, but
+    // only once the isolate is ours: while JavaScript on another thread holds
+    // it, the tasks stay queued, where the time slicing thread sees them waiting
+    size_t executed = 0;
+    if (has_tasks) {
+        v8::Locker locker(runtime_->GetIsolate());
+        std::queue<std::function<void()>> batch;
+        size_t counts[kTaskLaneCount];
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex_);
+            TakeBatch(&batch, counts);
         }
+        
+        // The loop has its turn now; a slice that expires from here on asks again
+        yield_requested_ = false;
+        
+        // Yielded tasks resume ahead of everything queued since they yielded
+        executed = batch.size();
+        RunBatch(&batch, counts);
     }
+    
+    // Deliver V8 foreground tasks such as Atomics.waitAsync wakeups
+    executed += runtime_->PumpPlatformTasks();
+    
+    // Run socket callbacks, including watchers the tasks above started
+    uv_alive_ = RunUv();
+    
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        running_batch_ = false;
+    }
+    progress_++;
+    return executed;
 }
 
-// Process delayed tasks
-void EventLoop::ProcessDelayedTasks() {
-    std::vector<std::function<void()>> tasks_to_run;
+// Run ready libuv callbacks
+bool EventLoop::RunUv() {
+    v8::Isolate* isolate = runtime_->GetIsolate();
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope isolate_scope(isolate);
+    
+    in_uv_ = true;
+    uv_run(&uv_loop_, UV_RUN_NOWAIT);
+    in_uv_ = false;
+    
+    // Writes completed inline and closes queue callbacks for the next pass
+    bool alive = uv_loop_alive(&uv_loop_) != 0;
+    uv_ready_ = alive && uv_backend_timeout(&uv_loop_) == 0;
+    return alive;
+}
+
+// Wait for the libuv backend descriptor without holding the isolate lock
+void EventLoop::WaitForEvents(std::chrono::milliseconds timeout) {
+    struct pollfd descriptor;
+    descriptor.fd = uv_backend_fd(&uv_loop_);
+    descriptor.events = POLLIN;
+    descriptor.revents = 0;
     
+    int result;
+    do {
+        result = poll(&descriptor, 1, static_cast<int>(timeout.count()));
+    } while (result < 0 && errno == EINTR);
+}
+
+// Execute a single task with the isolate locked
+void EventLoop::RunTask(const std::function<void()>& task) {
+    v8::Isolate* isolate = runtime_->GetIsolate();
+    v8::Locker locker(isolate);
+    v8::Isolate::Scope isolate_scope(isolate);
+    
+    try {
+        task();
+        
+        // Settle promises resolved by native code outside a JavaScript call
+        isolate->PerformMicrotaskCheckpoint();
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in event loop task: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in event loop task" << std::endl;
+    }
+}
+
+// Process delayed tasks
+std::chrono::milliseconds EventLoop::ProcessDelayedTasks(std::chrono::milliseconds timeout) {
+    bool filled = false;
     {
         std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
         auto now = std::chrono::steady_clock::now();
@@ -117,16 +528,103 @@ void EventLoop::ProcessDelayedTasks() {
         auto it = delayed_tasks_.begin();
         while (it != delayed_tasks_.end()) {
             if (it->second.first <= now) {
-                tasks_to_run.push_back(it->second.second);
+                // Queue due tasks before they leave the map, so HasPendingTasks() always sees them
+                {
+                    std::lock_guard<std::mutex> queue_lock(queue_mutex_);
+                    filled = PushTask(TaskLane::kTask, std::move(it->second.second)) || filled;
+                }
                 it = delayed_tasks_.erase(it);
             } else {
+                // Round up so a wait never ends just before the task is due
+                auto remaining = std::chrono::ceil<std::chrono::milliseconds>(it->second.first - now);
+                timeout = std::min(timeout, remaining);
                 ++it;
             }
         }
     }
     
-    // Execute tasks that are due
-    for (const auto& task : tasks_to_run) {
-        ScheduleTask(task);
+    // Timers are queued over capacity, but producers still see the lane fill
+    if (filled) {
+        NotifyBackpressure(TaskLane::kTask);
     }
-} 
\ No newline at end of file
+    return timeout;
+}
+
+// Start interrupting long-running JavaScript
+void EventLoop::StartTimeSlicing(uint64_t slice_ms) {
+    if (slice_thread_.joinable() || slice_ms == 0) {
+        return;
+    }
+    
+    slice_interval_ = std::chrono::milliseconds(slice_ms);
+    slice_thread_ = std::thread(&EventLoop::RunTimeSlicer, this);
+}
+
+// Get the number of time slices that ran
+uint64_t EventLoop::GetTimeSliceCount() const {
+    return slice_count_;
+}
+
+// Get the time slice length
+uint64_t EventLoop::GetTimeSlice() const {
+    return static_cast<uint64_t>(slice_interval_.count());
+}
+
+// Time slicing thread function
+void EventLoop::RunTimeSlicer() {
+    uint64_t last_progress = progress_;
+    std::unique_lock<std::mutex> lock(slice_mutex_);
+    while (!slice_stop_) {
+        slice_cv_.wait_for(lock, slice_interval_, [this] { return slice_stop_; });
+        if (slice_stop_) {
+            break;
+        }
+        
+        // Work the loop could not pick up for a whole slice means JavaScript holds the isolate.
+        // Only a flag is set; the running code is never interrupted to run other JavaScript.
+        uint64_t progress = progress_;
+        if (progress == last_progress && HasDueWork() && !yield_requested_.exchange(true)) {
+            slice_count_++;
+        }
+        last_progress = progress;
+    }
+}
+
+// Check whether running JavaScript should yield to the loop
+bool EventLoop::ShouldYield() const {
+    return yield_requested_;
+}
+
+// Check whether the loop has work it could run right now
+bool EventLoop::HasDueWork() {
+    if (batch_waiting_) {
+        return true;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (HasQueuedTasks()) {
+            return true;
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(delayed_tasks_mutex_);
+        auto now = std::chrono::steady_clock::now();
+        for (const auto& entry : delayed_tasks_) {
+            if (entry.second.first <= now) {
+                return true;
+            }
+        }
+    }
+    
+    // Polling the backend descriptor does not touch the loop itself
+    if (uv_alive_) {
+        struct pollfd descriptor;
+        descriptor.fd = uv_backend_fd(&uv_loop_);
+        descriptor.events = POLLIN;
+        descriptor.revents = 0;
+        return poll(&descriptor, 1, 0) > 0;
+    }
+    return false;
+}
@@ -1,9 +1,83 @@
+#include "fs_module.h"
 #include "runtime.h"
+#include "event_loop.h"
 #include "module.h"
+#include "stream_base.h"
+#include "async.h"
+#include "binding_table.h"
+#include <uv.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+// Bytes read from a file per chunk
+static constexpr size_t kFileChunkSize = 64 * 1024;
+
+struct FileStream;
+
+// Per-runtime state of the file streams in internal/fs
+struct FsBinding {
+    Runtime* runtime = nullptr;
+    
+    // Context the callbacks run in, set by setup()
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> onread;
+    v8::Global<v8::Function> onwrite;
+    v8::Global<v8::Function> onclose;
+    
+    // Open streams, closed by the cleanup hook when the runtime goes away
+    std::unordered_set<FileStream*> streams;
+};
+
+// A file opened for streaming and its JavaScript object
+//
+// Reads and writes run on the libuv thread pool at explicit offsets, so
+// queued writes land in order however the pool schedules them. The object
+// is held strongly until close() has finished. As a StreamBase the file can
+// be read and written by a native pipe.
+struct FileStream : StreamBase {
+    FsBinding* binding = nullptr;
+    v8::Global<v8::Object> object;
+    uv_file fd = -1;
+    int64_t read_offset = 0;
+    
+    // Offset reads stop at, or -1 to read to the end of the file
+    int64_t read_end = -1;
+    int64_t write_offset = 0;
+    
+    // Whether a native pipe is reading, and whether a read is in flight
+    bool reading = false;
+    bool read_pending = false;
+    bool closing = false;
+    int pending_requests = 0;
+    
+    int ReadStart() override;
+    int ReadStop() override;
+    int Write(const uv_buf_t* bufs, size_t count, Listener* listener, void* token) override;
+};
+
+// A read, write or close on a file stream
+struct FileReq {
+    uv_fs_t req = {};
+    FileStream* stream = nullptr;
+    
+    // Memory a JavaScript read lands in, or that JavaScript writes come from
+    std::shared_ptr<v8::BackingStore> store;
+    std::vector<std::shared_ptr<v8::BackingStore>> stores;
+    uv_buf_t buf = uv_buf_init(nullptr, 0);
+    size_t length = 0;
+    
+    // Set for reads and writes made by a native pipe
+    StreamBase::Listener* listener = nullptr;
+    void* token = nullptr;
+};
 
 // Native readFile function
 void ReadFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -37,6 +111,34 @@ void ReadFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, content.c_str()).ToLocalChecked());
 }
 
+// Read a file on the thread pool and settle with its bytes
+static JsPromise ReadFileAsync(v8::Isolate* isolate, std::string path) {
+    std::string contents = co_await FsRead(path);
+    
+    // Copied into memory from the isolate's allocator; with the V8 sandbox
+    // enabled, ArrayBuffers cannot wrap the string's memory
+    std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(isolate, contents.size());
+    std::memcpy(store->Data(), contents.data(), contents.size());
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(store));
+    co_return v8::Uint8Array::New(buffer, 0, buffer->ByteLength());
+}
+
+// Native readFileAsync function
+static void ReadFileAsyncCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Check arguments
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    std::string path = *v8::String::Utf8Value(isolate, args[0]);
+    args.GetReturnValue().Set(ReadFileAsync(isolate, path).GetPromise());
+}
+
 // Native writeFile function
 void WriteFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* isolate = args.GetIsolate();
@@ -92,66 +194,511 @@ void Exists(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(v8::Boolean::New(isolate, exists));
 }
 
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Get the loop file requests run on
+static uv_loop_t* GetLoop(FileStream* stream) {
+    return stream->binding->runtime->GetEventLoop()->GetUvLoop();
+}
+
+// Let the loop pick up requests started outside of its own callbacks
+static void WakeLoop(FileStream* stream) {
+    if (stream->binding) {
+        stream->binding->runtime->GetEventLoop()->Wake();
+    }
+}
+
+// Call one of the setup() callbacks with the stream's handle as this
+static void MakeCallback(FileStream* stream, const v8::Global<v8::Function>& callback,
+                         int argc, v8::Local<v8::Value>* argv) {
+    FsBinding* binding = stream->binding;
+    if (!binding || callback.IsEmpty() || stream->object.IsEmpty()) {
+        return;
+    }
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = binding->context.Get(isolate);
+    v8::Context::Scope context_scope(context);
+    
+    v8::TryCatch try_catch(isolate);
+    v8::Local<v8::Function> function = callback.Get(isolate);
+    if (function->Call(context, stream->object.Get(isolate), argc, argv).IsEmpty() && try_catch.HasCaught()) {
+        v8::String::Utf8Value error(isolate, try_catch.Exception());
+        std::cerr << "Uncaught exception in fs callback: " << *error << std::endl;
+    }
+    
+    // Settle promises resolved by the callback, as after any loop task
+    isolate->PerformMicrotaskCheckpoint();
+}
+
+// Free a stream once its file is closed, telling JavaScript first unless the runtime is going away
+static void OnFileClose(uv_fs_t* req) {
+    FileReq* file_req = static_cast<FileReq*>(req->data);
+    FileStream* stream = file_req->stream;
+    uv_fs_req_cleanup(req);
+    delete file_req;
+    
+    FsBinding* binding = stream->binding;
+    if (binding) {
+        MakeCallback(stream, binding->onclose, 0, nullptr);
+        
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Local<v8::Object> object = stream->object.Get(isolate);
+        object->SetAlignedPointerInInternalField(0, nullptr);
+        object->SetAlignedPointerInInternalField(StreamBase::kStreamBaseField, nullptr);
+        stream->object.Reset();
+        binding->streams.erase(stream);
+    }
+    delete stream;
+}
+
+// Close the file once no read or write refers to it any more
+static void MaybeCloseFile(FileStream* stream) {
+    if (!stream->closing || stream->pending_requests > 0) {
+        return;
+    }
+    
+    // Without a runtime there is no loop to close on, so close synchronously
+    if (!stream->binding) {
+        uv_fs_t req;
+        uv_fs_close(nullptr, &req, stream->fd, nullptr);
+        uv_fs_req_cleanup(&req);
+        delete stream;
+        return;
+    }
+    FileReq* file_req = new FileReq();
+    file_req->stream = stream;
+    file_req->req.data = file_req;
+    if (uv_fs_close(GetLoop(stream), &file_req->req, stream->fd, OnFileClose) != 0) {
+        OnFileClose(&file_req->req);
+        return;
+    }
+    stream->pending_requests++;
+}
+
+static void IssueRead(FileStream* stream, FileReq* file_req);
+
+// Hand a finished read to the pipe reading the file, or to JavaScript
+static void OnFileRead(uv_fs_t* req) {
+    FileReq* file_req = static_cast<FileReq*>(req->data);
+    FileStream* stream = file_req->stream;
+    ssize_t result = req->result;
+    uv_fs_req_cleanup(req);
+    stream->pending_requests--;
+    stream->read_pending = false;
+    if (result > 0) {
+        stream->read_offset += result;
+    }
+    
+    // The end of the file, or of the requested range, reads as UV_EOF
+    ssize_t nread = result == 0 ? static_cast<ssize_t>(UV_EOF) : result;
+    StreamBase::Listener* listener = file_req->listener;
+    if (listener) {
+        // The listener gets its memory back even if it was detached meanwhile
+        uv_buf_t buf = file_req->buf;
+        delete file_req;
+        bool attached = stream->GetReadListener() == listener;
+        listener->OnStreamRead(attached ? nread : static_cast<ssize_t>(UV_ECANCELED), buf);
+        
+        // Keep reading while the pipe wants more
+        if (attached && nread > 0 && stream->reading && stream->GetReadListener() == listener) {
+            IssueRead(stream, new FileReq());
+        }
+        MaybeCloseFile(stream);
+        return;
+    }
+    
+    FsBinding* binding = stream->binding;
+    if (binding && !stream->closing) {
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Context::Scope context_scope(binding->context.Get(isolate));
+        v8::Local<v8::Value> chunk = v8::Undefined(isolate);
+        if (nread > 0) {
+            // The chunk's ArrayBuffer takes over the memory the read landed in
+            v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, file_req->store);
+            chunk = v8::Uint8Array::New(buffer, 0, static_cast<size_t>(nread));
+        }
+        v8::Local<v8::Value> argv[] = {v8::Number::New(isolate, static_cast<double>(nread)), chunk};
+        MakeCallback(stream, binding->onread, 2, argv);
+    }
+    delete file_req;
+    MaybeCloseFile(stream);
+}
+
+// Start a read at the stream's offset, into file_req->buf or into memory from the reading pipe
+static void IssueRead(FileStream* stream, FileReq* file_req) {
+    file_req->stream = stream;
+    file_req->req.data = file_req;
+    StreamBase::Listener* listener = stream->GetReadListener();
+    if (listener) {
+        file_req->listener = listener;
+        listener->OnStreamAlloc(kFileChunkSize, &file_req->buf);
+    }
+    if (stream->read_end >= 0) {
+        int64_t remaining = std::max<int64_t>(stream->read_end - stream->read_offset, 0);
+        file_req->buf.len = static_cast<size_t>(std::min<int64_t>(file_req->buf.len, remaining));
+    }
+    
+    stream->pending_requests++;
+    stream->read_pending = true;
+    int err = uv_fs_read(GetLoop(stream), &file_req->req, stream->fd, &file_req->buf, 1,
+                         stream->read_offset, OnFileRead);
+    if (err != 0) {
+        // Report the failure like a completed read
+        file_req->req.result = err;
+        OnFileRead(&file_req->req);
+        return;
+    }
+    WakeLoop(stream);
+}
+
+// Report a finished write to the pipe that made it, or to JavaScript
+static void OnFileWrite(uv_fs_t* req) {
+    FileReq* file_req = static_cast<FileReq*>(req->data);
+    FileStream* stream = file_req->stream;
+    ssize_t result = req->result;
+    uv_fs_req_cleanup(req);
+    stream->pending_requests--;
+    
+    // Regular files take whole writes; a short one means the disk is full
+    int status = result < 0 ? static_cast<int>(result)
+               : static_cast<size_t>(result) < file_req->length ? UV_ENOSPC : 0;
+    StreamBase::Listener* listener = file_req->listener;
+    void* token = file_req->token;
+    delete file_req;
+    
+    if (listener) {
+        listener->OnStreamWrite(token, status);
+    } else if (stream->binding) {
+        v8::Isolate* isolate = stream->binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, status)};
+        MakeCallback(stream, stream->binding->onwrite, 1, argv);
+    }
+    MaybeCloseFile(stream);
+}
+
+// Queue a write of bufs at the stream's write offset
+static int IssueWrite(FileStream* stream, FileReq* file_req, const uv_buf_t* bufs, size_t count) {
+    file_req->stream = stream;
+    file_req->req.data = file_req;
+    for (size_t i = 0; i < count; i++) {
+        file_req->length += bufs[i].len;
+    }
+    
+    // libuv copies the buffer list, so it may live on the caller's stack
+    int err = uv_fs_write(GetLoop(stream), &file_req->req, stream->fd, bufs, static_cast<unsigned int>(count),
+                          stream->write_offset, OnFileWrite);
+    if (err != 0) {
+        delete file_req;
+        return err;
+    }
+    stream->write_offset += static_cast<int64_t>(file_req->length);
+    stream->pending_requests++;
+    WakeLoop(stream);
+    return 1;
+}
+
+// Start reading for a native pipe
+int FileStream::ReadStart() {
+    if (closing) {
+        return UV_EBADF;
+    }
+    reading = true;
+    if (!read_pending) {
+        IssueRead(this, new FileReq());
+    }
+    return 0;
+}
+
+// Stop reading for a native pipe; a read in flight still completes
+int FileStream::ReadStop() {
+    reading = false;
+    return 0;
+}
+
+// Write for a native pipe, from memory the listener keeps alive
+int FileStream::Write(const uv_buf_t* bufs, size_t count, Listener* listener, void* token) {
+    if (closing) {
+        return UV_EBADF;
+    }
+    FileReq* file_req = new FileReq();
+    file_req->listener = listener;
+    file_req->token = token;
+    return IssueWrite(this, file_req, bufs, count);
+}
+
+// Get the stream behind a handle object; closing streams report UV_EBADF
+static FileStream* UnwrapFileStream(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    FileStream* stream = nullptr;
+    if (args.This()->InternalFieldCount() >= 1) {
+        stream = static_cast<FileStream*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!stream) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    if (stream->closing) {
+        args.GetReturnValue().Set(UV_EBADF);
+        return nullptr;
+    }
+    return stream;
+}
+
+// Constructor behind file stream handles; open() attaches a file
+static void FileStreamConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    if (!args.IsConstructCall()) {
+        ThrowInvalidArguments(args.GetIsolate());
+        return;
+    }
+    args.This()->SetAlignedPointerInInternalField(0, nullptr);
+    args.This()->SetAlignedPointerInInternalField(StreamBase::kStreamBaseField, nullptr);
+}
+
+// handle.open(path, flags, mode, start, end): open synchronously, reading from start up to end inclusive
+static void FileStreamOpen(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    FsBinding* binding = static_cast<FsBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args[0]->IsString() || !args[1]->IsInt32() || !args[2]->IsInt32() ||
+        args.This()->InternalFieldCount() < 2 || args.This()->GetAlignedPointerFromInternalField(0) != nullptr) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::String::Utf8Value path(isolate, args[0]);
+    int flags = args[1].As<v8::Int32>()->Value();
+    int mode = args[2].As<v8::Int32>()->Value();
+    
+    // Appends go to explicit offsets from the current size, so O_APPEND is dropped
+    bool append = (flags & O_APPEND) != 0;
+    uv_fs_t req;
+    int fd = uv_fs_open(nullptr, &req, *path, flags & ~O_APPEND, mode, nullptr);
+    uv_fs_req_cleanup(&req);
+    if (fd < 0) {
+        args.GetReturnValue().Set(fd);
+        return;
+    }
+    
+    FileStream* stream = new FileStream();
+    stream->binding = binding;
+    stream->fd = fd;
+    if (args[3]->IsNumber()) {
+        stream->read_offset = static_cast<int64_t>(args[3]->NumberValue(context).FromJust());
+        stream->write_offset = stream->read_offset;
+    }
+    if (args[4]->IsNumber()) {
+        stream->read_end = static_cast<int64_t>(args[4]->NumberValue(context).FromJust()) + 1;
+    }
+    if (append && uv_fs_fstat(nullptr, &req, fd, nullptr) == 0) {
+        stream->write_offset = static_cast<int64_t>(req.statbuf.st_size);
+    }
+    uv_fs_req_cleanup(&req);
+    
+    stream->object.Reset(isolate, args.This());
+    args.This()->SetAlignedPointerInInternalField(0, stream);
+    args.This()->SetAlignedPointerInInternalField(StreamBase::kStreamBaseField, static_cast<StreamBase*>(stream));
+    binding->streams.insert(stream);
+    args.GetReturnValue().Set(0);
+}
+
+// handle.read(size): read the next chunk; onread(nread, chunk) follows
+static void FileStreamRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    FileStream* stream = UnwrapFileStream(args);
+    if (!stream) {
+        return;
+    }
+    if (stream->read_pending || stream->GetReadListener()) {
+        args.GetReturnValue().Set(0);
+        return;
+    }
+    size_t size = kFileChunkSize;
+    if (args[0]->IsNumber()) {
+        double requested = args[0].As<v8::Number>()->Value();
+        if (requested >= 1 && requested < kFileChunkSize) {
+            size = static_cast<size_t>(requested);
+        }
+    }
+    
+    FileReq* file_req = new FileReq();
+    file_req->store = v8::ArrayBuffer::NewBackingStore(isolate, size);
+    file_req->buf = uv_buf_init(static_cast<char*>(file_req->store->Data()), static_cast<unsigned int>(size));
+    IssueRead(stream, file_req);
+    args.GetReturnValue().Set(0);
+}
+
+// handle.writev(chunks): queue a write of every chunk; onwrite(status) follows
+static void FileStreamWritev(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    FileStream* stream = UnwrapFileStream(args);
+    if (!stream) {
+        return;
+    }
+    if (!args[0]->IsArray()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Array> chunks = args[0].As<v8::Array>();
+    uint32_t count = chunks->Length();
+    
+    // The request keeps the chunks' memory alive until the write has finished
+    FileReq* file_req = new FileReq();
+    std::vector<uv_buf_t> bufs(count);
+    file_req->stores.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        v8::Local<v8::Value> chunk;
+        if (!chunks->Get(context, i).ToLocal(&chunk) || !chunk->IsArrayBufferView()) {
+            delete file_req;
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        v8::Local<v8::ArrayBufferView> view = chunk.As<v8::ArrayBufferView>();
+        std::shared_ptr<v8::BackingStore> store = view->Buffer()->GetBackingStore();
+        char* data = static_cast<char*>(store->Data());
+        bufs[i] = uv_buf_init(data ? data + view->ByteOffset() : nullptr,
+                              static_cast<unsigned int>(view->ByteLength()));
+        file_req->stores.push_back(std::move(store));
+    }
+    args.GetReturnValue().Set(IssueWrite(stream, file_req, bufs.data(), bufs.size()));
+}
+
+// handle.close(); onclose() follows once reads and writes in flight have finished
+static void FileStreamClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    FileStream* stream = UnwrapFileStream(args);
+    if (!stream) {
+        return;
+    }
+    stream->closing = true;
+    stream->reading = false;
+    stream->NotifyClose();
+    MaybeCloseFile(stream);
+    WakeLoop(stream);
+    args.GetReturnValue().Set(0);
+}
+
+// Native setup function for file stream callbacks
+static void FsSetup(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    FsBinding* binding = static_cast<FsBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args[0]->IsObject()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Object> callbacks = args[0].As<v8::Object>();
+    
+    const struct {
+        const char* name;
+        v8::Global<v8::Function>* slot;
+    } kCallbacks[] = {
+        {"onread", &binding->onread},
+        {"onwrite", &binding->onwrite},
+        {"onclose", &binding->onclose},
+    };
+    for (const auto& entry : kCallbacks) {
+        v8::Local<v8::Value> value;
+        if (!callbacks->Get(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked()).ToLocal(&value) ||
+            !value->IsFunction()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        entry.slot->Reset(isolate, value.As<v8::Function>());
+    }
+    binding->context.Reset(isolate, context);
+}
+
+// Close every stream when the runtime is destroyed; requests in flight finish without V8
+static void CleanupBinding(FsBinding* binding) {
+    std::vector<FileStream*> streams(binding->streams.begin(), binding->streams.end());
+    for (FileStream* stream : streams) {
+        stream->object.Reset();
+        stream->reading = false;
+        if (!stream->closing) {
+            stream->closing = true;
+            stream->NotifyClose();
+        }
+        stream->binding = nullptr;
+        MaybeCloseFile(stream);
+    }
+    delete binding;
+}
+
+// Functions of internal/fs
+static constexpr NativeMethod kFsMethods[] = {
+    {"readFile", ReadFile, 1},
+    {"readFileAsync", ReadFileAsyncCallback, 1},
+    {"writeFile", WriteFile, 2},
+    {"exists", Exists, 1, v8::None, v8::SideEffectType::kHasNoSideEffect},
+    {"setup", FsSetup, 1},
+};
+static const BindingTableRegistration kFsRegistration(kFsMethods);
+
+// Methods of FileStream handles
+static constexpr NativeMethod kFileStreamMethods[] = {
+    {"open", FileStreamOpen, 3},
+    {"read", FileStreamRead, 1},
+    {"writev", FileStreamWritev, 1},
+    {"close", FileStreamClose},
+};
+static const BindingTableRegistration kFileStreamRegistration(kFileStreamMethods);
+
 // Register the fs module
 void RegisterFsModule(Runtime* runtime) {
     std::cout << "RegisterFsModule: Starting..." << std::endl;
     
     try {
         v8::Isolate* isolate = runtime->GetIsolate();
-        std::cout << "RegisterFsModule: Got isolate" << std::endl;
         
         // Create a handle scope
         v8::HandleScope scope(isolate);
-        std::cout << "RegisterFsModule: Created handle scope" << std::endl;
-        
-        // Create a new context for module initialization
-        v8::Local<v8::Context> context = v8::Context::New(isolate);
-        v8::Context::Scope context_scope(context);
-        std::cout << "RegisterFsModule: Created and entered context" << std::endl;
         
-        // Create the fs module object
-        v8::Local<v8::Object> fs = v8::Object::New(isolate);
-        std::cout << "RegisterFsModule: Created fs object" << std::endl;
+        FsBinding* binding = new FsBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
         
-        // Add the readFile function
-        std::cout << "RegisterFsModule: Adding readFile function..." << std::endl;
-        v8::Local<v8::Function> readFile = v8::Function::New(
-            context, 
-            ReadFile
-        ).ToLocalChecked();
-        fs->Set(
-            context,
-            v8::String::NewFromUtf8(isolate, "readFile").ToLocalChecked(),
-            readFile
-        ).Check();
+        // Build the fs module template from its table
+        v8::Local<v8::ObjectTemplate> fs = NewBindingTemplate(isolate, kFsMethods, data);
         
-        // Add the writeFile function
-        std::cout << "RegisterFsModule: Adding writeFile function..." << std::endl;
-        v8::Local<v8::Function> writeFile = v8::Function::New(
-            context, 
-            WriteFile
-        ).ToLocalChecked();
-        fs->Set(
-            context,
-            v8::String::NewFromUtf8(isolate, "writeFile").ToLocalChecked(),
-            writeFile
-        ).Check();
+        // Build the file stream handle class behind fs.ReadStream and fs.WriteStream
+        v8::Local<v8::FunctionTemplate> stream_template = v8::FunctionTemplate::New(isolate, FileStreamConstructor);
+        stream_template->SetClassName(v8::String::NewFromUtf8(isolate, "FileStream").ToLocalChecked());
+        stream_template->InstanceTemplate()->SetInternalFieldCount(2);
+        SetBindingMethods(isolate, stream_template->PrototypeTemplate(), kFileStreamMethods, data);
+        fs->Set(isolate, "FileStream", stream_template);
         
-        // Add the exists function
-        std::cout << "RegisterFsModule: Adding exists function..." << std::endl;
-        v8::Local<v8::Function> exists = v8::Function::New(
-            context, 
-            Exists
-        ).ToLocalChecked();
-        fs->Set(
-            context,
-            v8::String::NewFromUtf8(isolate, "exists").ToLocalChecked(),
-            exists
-        ).Check();
+        static const struct {
+            const char* name;
+            int value;
+        } kConstants[] = {
+            {"O_RDONLY", O_RDONLY},
+            {"O_WRONLY", O_WRONLY},
+            {"O_RDWR", O_RDWR},
+            {"O_CREAT", O_CREAT},
+            {"O_TRUNC", O_TRUNC},
+            {"O_APPEND", O_APPEND},
+            {"O_EXCL", O_EXCL},
+            {"UV_EOF", UV_EOF},
+        };
+        v8::Local<v8::ObjectTemplate> constants = v8::ObjectTemplate::New(isolate);
+        for (const auto& entry : kConstants) {
+            constants->Set(isolate, entry.name, v8::Integer::New(isolate, entry.value));
+        }
+        fs->Set(isolate, "constants", constants);
         
-        // Register the fs module
-        std::cout << "RegisterFsModule: Registering module with ModuleSystem..." << std::endl;
-        runtime->GetModuleSystem()->RegisterNativeModule("fs", fs);
+        // Register the binding; lib/fs.js builds the fs module on top of it
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/fs", fs);
         
         std::cout << "RegisterFsModule: Complete" << std::endl;
     } catch (const std::exception& e) {
@@ -0,0 +1,1054 @@
+#include "hash.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <cpuid.h>
+#include <immintrin.h>
+#define TINY_NODE_HASH_X86 1
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define TINY_NODE_HASH_ARM_CRC32 1
+#endif
+
+// Load and store helpers; byte order is explicit so unaligned input is fine
+static inline uint32_t Load32Be(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+static inline uint64_t Load64Be(const uint8_t* p) {
+    return (static_cast<uint64_t>(Load32Be(p)) << 32) | Load32Be(p + 4);
+}
+
+static inline void Store32Be(uint8_t* p, uint32_t v) {
+    p[0] = static_cast<uint8_t>(v >> 24);
+    p[1] = static_cast<uint8_t>(v >> 16);
+    p[2] = static_cast<uint8_t>(v >> 8);
+    p[3] = static_cast<uint8_t>(v);
+}
+
+static inline void Store64Be(uint8_t* p, uint64_t v) {
+    Store32Be(p, static_cast<uint32_t>(v >> 32));
+    Store32Be(p + 4, static_cast<uint32_t>(v));
+}
+
+static inline uint32_t Load32Le(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+static inline uint64_t Load64Le(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+static inline uint32_t Rotl32(uint32_t v, int n) {
+    return (v << n) | (v >> (32 - n));
+}
+
+static inline uint32_t Rotr32(uint32_t v, int n) {
+    return (v >> n) | (v << (32 - n));
+}
+
+static inline uint64_t Rotl64(uint64_t v, int n) {
+    return (v << n) | (v >> (64 - n));
+}
+
+static inline uint64_t Rotr64(uint64_t v, int n) {
+    return (v >> n) | (v << (64 - n));
+}
+
+// CPU features that select block functions
+struct CpuFeatures {
+    bool sha = false;
+    bool sse42 = false;
+    bool avx2 = false;
+};
+
+// Detect CPU features once
+static const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features = []() {
+        CpuFeatures result;
+#if defined(TINY_NODE_HASH_X86)
+        unsigned int eax, ebx, ecx, edx;
+        bool ssse3 = false;
+        bool sse41 = false;
+        bool os_avx = false;
+        if (__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+            ssse3 = (ecx & (1u << 9)) != 0;
+            sse41 = (ecx & (1u << 19)) != 0;
+            result.sse42 = (ecx & (1u << 20)) != 0;
+            // AVX state must be enabled by the OS (OSXSAVE, then XCR0 bits 1-2)
+            if ((ecx & (1u << 27)) != 0 && (ecx & (1u << 28)) != 0) {
+                unsigned int xcr0_low, xcr0_high;
+                __asm__("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+                os_avx = (xcr0_low & 0x6) == 0x6;
+            }
+        }
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            result.sha = ssse3 && sse41 && (ebx & (1u << 29)) != 0;
+            result.avx2 = os_avx && (ebx & (1u << 5)) != 0;
+        }
+#endif
+        return result;
+    }();
+    return features;
+}
+
+// Buffers input into fixed-size blocks for a Merkle-Damgard hash
+template <size_t BlockSize>
+class BlockBuffer {
+public:
+    // Call process(data, blocks) for every complete block
+    template <typename Process>
+    void Update(const uint8_t* data, size_t length, Process process) {
+        total_ += length;
+        if (buffered_ > 0) {
+            size_t take = std::min(length, BlockSize - buffered_);
+            std::memcpy(buffer_ + buffered_, data, take);
+            buffered_ += take;
+            data += take;
+            length -= take;
+            if (buffered_ < BlockSize) {
+                return;
+            }
+            process(buffer_, 1);
+            buffered_ = 0;
+        }
+        if (length >= BlockSize) {
+            size_t blocks = length / BlockSize;
+            process(data, blocks);
+            data += blocks * BlockSize;
+            length -= blocks * BlockSize;
+        }
+        std::memcpy(buffer_, data, length);
+        buffered_ = length;
+    }
+    
+    // Append the 0x80 terminator, zeros and the big-endian bit length
+    template <typename Process>
+    void Pad(size_t length_bytes, Process process) {
+        uint64_t bits = total_ * 8;
+        buffer_[buffered_++] = 0x80;
+        if (buffered_ > BlockSize - length_bytes) {
+            std::memset(buffer_ + buffered_, 0, BlockSize - buffered_);
+            process(buffer_, 1);
+            buffered_ = 0;
+        }
+        std::memset(buffer_ + buffered_, 0, BlockSize - buffered_);
+        Store64Be(buffer_ + BlockSize - 8, bits);
+        process(buffer_, 1);
+    }
+
+private:
+    uint8_t buffer_[BlockSize];
+    size_t buffered_ = 0;
+    uint64_t total_ = 0;
+};
+
+// SHA-1 compression, portable
+static void Sha1BlocksPortable(uint32_t state[5], const uint8_t* data, size_t blocks) {
+    for (; blocks > 0; blocks--, data += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = Load32Be(data + 4 * i);
+        }
+        for (int i = 16; i < 80; i++) {
+            w[i] = Rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+        
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5a827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ed9eba1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8f1bbcdc;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xca62c1d6;
+            }
+            uint32_t temp = Rotl32(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = Rotl32(b, 30);
+            b = a;
+            a = temp;
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
+
+static const uint32_t kSha256K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+// SHA-256 compression, portable
+static void Sha256BlocksPortable(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    for (; blocks > 0; blocks--, data += 64) {
+        uint32_t w[64];
+        for (int i = 0; i < 16; i++) {
+            w[i] = Load32Be(data + 4 * i);
+        }
+        for (int i = 16; i < 64; i++) {
+            uint32_t s0 = Rotr32(w[i - 15], 7) ^ Rotr32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = Rotr32(w[i - 2], 17) ^ Rotr32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+        
+        // Eight rounds per iteration, rotating the variable names instead of
+        // shuffling values between them
+#define TINY_NODE_SHA256_ROUND(a, b, c, d, e, f, g, h, i)                                        \
+        {                                                                                        \
+            uint32_t temp = h + (Rotr32(e, 6) ^ Rotr32(e, 11) ^ Rotr32(e, 25)) +                \
+                            ((e & f) ^ (~e & g)) + kSha256K[i] + w[i];                           \
+            d += temp;                                                                           \
+            h = temp + (Rotr32(a, 2) ^ Rotr32(a, 13) ^ Rotr32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c)); \
+        }
+        for (int i = 0; i < 64; i += 8) {
+            TINY_NODE_SHA256_ROUND(a, b, c, d, e, f, g, h, i)
+            TINY_NODE_SHA256_ROUND(h, a, b, c, d, e, f, g, i + 1)
+            TINY_NODE_SHA256_ROUND(g, h, a, b, c, d, e, f, i + 2)
+            TINY_NODE_SHA256_ROUND(f, g, h, a, b, c, d, e, i + 3)
+            TINY_NODE_SHA256_ROUND(e, f, g, h, a, b, c, d, i + 4)
+            TINY_NODE_SHA256_ROUND(d, e, f, g, h, a, b, c, i + 5)
+            TINY_NODE_SHA256_ROUND(c, d, e, f, g, h, a, b, i + 6)
+            TINY_NODE_SHA256_ROUND(b, c, d, e, f, g, h, a, i + 7)
+        }
+#undef TINY_NODE_SHA256_ROUND
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+#if defined(TINY_NODE_HASH_X86)
+// SHA-1 compression with the SHA extensions
+//
+// Each group of four rounds runs one sha1rnds4; the message schedule for
+// later groups is built alongside with sha1msg1/sha1msg2.
+__attribute__((target("sha,sse4.1,ssse3")))
+static void Sha1BlocksShaNi(uint32_t state[5], const uint8_t* data, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+    __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+    __m128i e1;
+    
+    for (; blocks > 0; blocks--, data += 64) {
+        __m128i abcd_save = abcd;
+        __m128i e0_save = e0;
+        __m128i msg[4];
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), mask);
+        }
+        
+        e0 = _mm_add_epi32(e0, msg[0]);
+        e1 = abcd;
+        abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+#define TINY_NODE_SHA1_GROUP(g, current, next, function)                               \
+        current = _mm_sha1nexte_epu32(current, msg[(g) % 4]);                           \
+        next = abcd;                                                                    \
+        if ((g) >= 3 && (g) <= 18) {                                                    \
+            msg[((g) + 1) % 4] = _mm_sha1msg2_epu32(msg[((g) + 1) % 4], msg[(g) % 4]);  \
+        }                                                                               \
+        abcd = _mm_sha1rnds4_epu32(abcd, current, function);                            \
+        if ((g) >= 1 && (g) <= 16) {                                                    \
+            msg[((g) + 3) % 4] = _mm_sha1msg1_epu32(msg[((g) + 3) % 4], msg[(g) % 4]);  \
+        }                                                                               \
+        if ((g) >= 2 && (g) <= 17) {                                                    \
+            msg[((g) + 2) % 4] = _mm_xor_si128(msg[((g) + 2) % 4], msg[(g) % 4]);       \
+        }
+        
+        TINY_NODE_SHA1_GROUP(1, e1, e0, 0)
+        TINY_NODE_SHA1_GROUP(2, e0, e1, 0)
+        TINY_NODE_SHA1_GROUP(3, e1, e0, 0)
+        TINY_NODE_SHA1_GROUP(4, e0, e1, 0)
+        TINY_NODE_SHA1_GROUP(5, e1, e0, 1)
+        TINY_NODE_SHA1_GROUP(6, e0, e1, 1)
+        TINY_NODE_SHA1_GROUP(7, e1, e0, 1)
+        TINY_NODE_SHA1_GROUP(8, e0, e1, 1)
+        TINY_NODE_SHA1_GROUP(9, e1, e0, 1)
+        TINY_NODE_SHA1_GROUP(10, e0, e1, 2)
+        TINY_NODE_SHA1_GROUP(11, e1, e0, 2)
+        TINY_NODE_SHA1_GROUP(12, e0, e1, 2)
+        TINY_NODE_SHA1_GROUP(13, e1, e0, 2)
+        TINY_NODE_SHA1_GROUP(14, e0, e1, 2)
+        TINY_NODE_SHA1_GROUP(15, e1, e0, 3)
+        TINY_NODE_SHA1_GROUP(16, e0, e1, 3)
+        TINY_NODE_SHA1_GROUP(17, e1, e0, 3)
+        TINY_NODE_SHA1_GROUP(18, e0, e1, 3)
+        TINY_NODE_SHA1_GROUP(19, e1, e0, 3)
+#undef TINY_NODE_SHA1_GROUP
+        
+        e0 = _mm_sha1nexte_epu32(e0, e0_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
+    }
+    
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1b));
+    state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+// SHA-256 compression with the SHA extensions
+//
+// State is kept as ABEF/CDGH for sha256rnds2; each group of four rounds
+// also advances the message schedule with sha256msg1/sha256msg2.
+__attribute__((target("sha,sse4.1,ssse3")))
+static void Sha256BlocksShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) {
+    const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i temp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0xb1);
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4)), 0x1b);
+    __m128i state0 = _mm_alignr_epi8(temp, state1, 8);
+    state1 = _mm_blend_epi16(state1, temp, 0xf0);
+    
+    for (; blocks > 0; blocks--, data += 64) {
+        __m128i abef_save = state0;
+        __m128i cdgh_save = state1;
+        __m128i msg[4];
+        for (int i = 0; i < 4; i++) {
+            msg[i] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), mask);
+        }
+        
+        for (int g = 0; g < 16; g++) {
+            __m128i words = _mm_add_epi32(msg[g % 4],
+                                          _mm_loadu_si128(reinterpret_cast<const __m128i*>(kSha256K + 4 * g)));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+            if (g >= 3 && g <= 14) {
+                __m128i next = _mm_add_epi32(msg[(g + 1) % 4], _mm_alignr_epi8(msg[g % 4], msg[(g + 3) % 4], 4));
+                msg[(g + 1) % 4] = _mm_sha256msg2_epu32(next, msg[g % 4]);
+            }
+            state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(words, 0x0e));
+            if (g >= 1 && g <= 12) {
+                msg[(g + 3) % 4] = _mm_sha256msg1_epu32(msg[(g + 3) % 4], msg[g % 4]);
+            }
+        }
+        
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+    }
+    
+    temp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(temp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, temp, 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state), state0);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), state1);
+}
+#endif
+
+static const uint64_t kSha512K[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL,
+};
+
+// SHA-512 compression, portable (x86 has no SHA-512 instructions before
+// Arrow Lake, and 64-bit rotates are already single instructions)
+static void Sha512Blocks(uint64_t state[8], const uint8_t* data, size_t blocks) {
+    for (; blocks > 0; blocks--, data += 128) {
+        uint64_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = Load64Be(data + 8 * i);
+        }
+        for (int i = 16; i < 80; i++) {
+            uint64_t s0 = Rotr64(w[i - 15], 1) ^ Rotr64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+            uint64_t s1 = Rotr64(w[i - 2], 19) ^ Rotr64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        
+        uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+        uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+#define TINY_NODE_SHA512_ROUND(a, b, c, d, e, f, g, h, i)                                        \
+        {                                                                                        \
+            uint64_t temp = h + (Rotr64(e, 14) ^ Rotr64(e, 18) ^ Rotr64(e, 41)) +               \
+                            ((e & f) ^ (~e & g)) + kSha512K[i] + w[i];                           \
+            d += temp;                                                                           \
+            h = temp + (Rotr64(a, 28) ^ Rotr64(a, 34) ^ Rotr64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c)); \
+        }
+        for (int i = 0; i < 80; i += 8) {
+            TINY_NODE_SHA512_ROUND(a, b, c, d, e, f, g, h, i)
+            TINY_NODE_SHA512_ROUND(h, a, b, c, d, e, f, g, i + 1)
+            TINY_NODE_SHA512_ROUND(g, h, a, b, c, d, e, f, i + 2)
+            TINY_NODE_SHA512_ROUND(f, g, h, a, b, c, d, e, i + 3)
+            TINY_NODE_SHA512_ROUND(e, f, g, h, a, b, c, d, i + 4)
+            TINY_NODE_SHA512_ROUND(d, e, f, g, h, a, b, c, i + 5)
+            TINY_NODE_SHA512_ROUND(c, d, e, f, g, h, a, b, i + 6)
+            TINY_NODE_SHA512_ROUND(b, c, d, e, f, g, h, a, i + 7)
+        }
+#undef TINY_NODE_SHA512_ROUND
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+        state[5] += f;
+        state[6] += g;
+        state[7] += h;
+    }
+}
+
+using Sha1BlockFunction = void (*)(uint32_t*, const uint8_t*, size_t);
+using Sha256BlockFunction = void (*)(uint32_t*, const uint8_t*, size_t);
+
+// Pick the SHA-1 block function for this CPU
+static Sha1BlockFunction GetSha1Blocks() {
+#if defined(TINY_NODE_HASH_X86)
+    if (GetCpuFeatures().sha) {
+        return Sha1BlocksShaNi;
+    }
+#endif
+    return Sha1BlocksPortable;
+}
+
+// Pick the SHA-256 block function for this CPU
+static Sha256BlockFunction GetSha256Blocks() {
+#if defined(TINY_NODE_HASH_X86)
+    if (GetCpuFeatures().sha) {
+        return Sha256BlocksShaNi;
+    }
+#endif
+    return Sha256BlocksPortable;
+}
+
+// SHA-1
+class Sha1Hasher : public Hasher {
+public:
+    void Update(const uint8_t* data, size_t length) override {
+        static const Sha1BlockFunction blocks = GetSha1Blocks();
+        buffer_.Update(data, length, [this](const uint8_t* block, size_t count) { blocks(state_, block, count); });
+    }
+    
+    void Final(uint8_t* output) override {
+        static const Sha1BlockFunction blocks = GetSha1Blocks();
+        buffer_.Pad(8, [this](const uint8_t* block, size_t count) { blocks(state_, block, count); });
+        for (int i = 0; i < 5; i++) {
+            Store32Be(output + 4 * i, state_[i]);
+        }
+    }
+    
+    size_t DigestLength() const override {
+        return 20;
+    }
+    
+    std::unique_ptr<Hasher> Clone() const override {
+        return std::make_unique<Sha1Hasher>(*this);
+    }
+
+private:
+    uint32_t state_[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    BlockBuffer<64> buffer_;
+};
+
+// SHA-256
+class Sha256Hasher : public Hasher {
+public:
+    void Update(const uint8_t* data, size_t length) override {
+        static const Sha256BlockFunction blocks = GetSha256Blocks();
+        buffer_.Update(data, length, [this](const uint8_t* block, size_t count) { blocks(state_, block, count); });
+    }
+    
+    void Final(uint8_t* output) override {
+        static const Sha256BlockFunction blocks = GetSha256Blocks();
+        buffer_.Pad(8, [this](const uint8_t* block, size_t count) { blocks(state_, block, count); });
+        for (int i = 0; i < 8; i++) {
+            Store32Be(output + 4 * i, state_[i]);
+        }
+    }
+    
+    size_t DigestLength() const override {
+        return 32;
+    }
+    
+    std::unique_ptr<Hasher> Clone() const override {
+        return std::make_unique<Sha256Hasher>(*this);
+    }
+
+private:
+    uint32_t state_[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                          0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    BlockBuffer<64> buffer_;
+};
+
+// SHA-512
+class Sha512Hasher : public Hasher {
+public:
+    void Update(const uint8_t* data, size_t length) override {
+        buffer_.Update(data, length, [this](const uint8_t* block, size_t count) { Sha512Blocks(state_, block, count); });
+    }
+    
+    void Final(uint8_t* output) override {
+        // The length field is 128 bits; inputs never exceed 2^64 bits here
+        buffer_.Pad(16, [this](const uint8_t* block, size_t count) { Sha512Blocks(state_, block, count); });
+        for (int i = 0; i < 8; i++) {
+            Store64Be(output + 8 * i, state_[i]);
+        }
+    }
+    
+    size_t DigestLength() const override {
+        return 64;
+    }
+    
+    std::unique_ptr<Hasher> Clone() const override {
+        return std::make_unique<Sha512Hasher>(*this);
+    }
+
+private:
+    uint64_t state_[8] = {0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL,
+                          0xa54ff53a5f1d36f1ULL, 0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+                          0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+    BlockBuffer<128> buffer_;
+};
+
+// XXH3 constants from the reference implementation
+static const uint32_t kXxPrime32_1 = 0x9e3779b1U;
+static const uint32_t kXxPrime32_2 = 0x85ebca77U;
+static const uint32_t kXxPrime32_3 = 0xc2b2ae3dU;
+static const uint64_t kXxPrime64_1 = 0x9e3779b185ebca87ULL;
+static const uint64_t kXxPrime64_2 = 0xc2b2ae3d27d4eb4fULL;
+static const uint64_t kXxPrime64_3 = 0x165667b19e3779f9ULL;
+static const uint64_t kXxPrime64_4 = 0x85ebca77c2b2ae63ULL;
+static const uint64_t kXxPrime64_5 = 0x27d4eb2f165667c5ULL;
+static const uint64_t kXxPrimeMx1 = 0x165667919e3779f9ULL;
+static const uint64_t kXxPrimeMx2 = 0x9fb21c651e98df25ULL;
+
+static constexpr size_t kXxSecretSize = 192;
+static constexpr size_t kXxStripeLength = 64;
+static constexpr size_t kXxStripesPerBlock = (kXxSecretSize - kXxStripeLength) / 8;
+static constexpr size_t kXxBufferSize = 256;
+static constexpr size_t kXxMidSizeMax = 240;
+
+static const uint8_t kXxSecret[kXxSecretSize] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// 64x64->128 multiply, folded to 64 bits
+static inline uint64_t XxMulFold64(uint64_t a, uint64_t b) {
+    unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+static inline uint64_t XxAvalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= kXxPrimeMx1;
+    return h ^ (h >> 32);
+}
+
+static inline uint64_t Xx64Avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= kXxPrime64_2;
+    h ^= h >> 29;
+    h *= kXxPrime64_3;
+    return h ^ (h >> 32);
+}
+
+static inline uint64_t XxRrmxmx(uint64_t h, uint64_t length) {
+    h ^= Rotl64(h, 49) ^ Rotl64(h, 24);
+    h *= kXxPrimeMx2;
+    h ^= (h >> 35) + length;
+    h *= kXxPrimeMx2;
+    return h ^ (h >> 28);
+}
+
+static inline uint64_t XxMix16(const uint8_t* input, const uint8_t* secret, uint64_t seed) {
+    return XxMulFold64(Load64Le(input) ^ (Load64Le(secret) + seed),
+                       Load64Le(input + 8) ^ (Load64Le(secret + 8) - seed));
+}
+
+// XXH3-64 of inputs up to 240 bytes, which never touch the accumulators
+static uint64_t Xxh3Short(const uint8_t* input, size_t length, uint64_t seed) {
+    const uint8_t* secret = kXxSecret;
+    if (length == 0) {
+        return Xx64Avalanche(seed ^ (Load64Le(secret + 56) ^ Load64Le(secret + 64)));
+    }
+    if (length <= 3) {
+        uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+                            (static_cast<uint32_t>(input[length >> 1]) << 24) |
+                            static_cast<uint32_t>(input[length - 1]) |
+                            (static_cast<uint32_t>(length) << 8);
+        uint64_t bitflip = (Load32Le(secret) ^ Load32Le(secret + 4)) + seed;
+        return Xx64Avalanche(static_cast<uint64_t>(combined) ^ bitflip);
+    }
+    if (length <= 8) {
+        seed ^= static_cast<uint64_t>(__builtin_bswap32(static_cast<uint32_t>(seed))) << 32;
+        uint64_t bitflip = (Load64Le(secret + 8) ^ Load64Le(secret + 16)) - seed;
+        uint64_t input64 = Load32Le(input + length - 4) + (static_cast<uint64_t>(Load32Le(input)) << 32);
+        return XxRrmxmx(input64 ^ bitflip, length);
+    }
+    if (length <= 16) {
+        uint64_t bitflip1 = (Load64Le(secret + 24) ^ Load64Le(secret + 32)) + seed;
+        uint64_t bitflip2 = (Load64Le(secret + 40) ^ Load64Le(secret + 48)) - seed;
+        uint64_t low = Load64Le(input) ^ bitflip1;
+        uint64_t high = Load64Le(input + length - 8) ^ bitflip2;
+        uint64_t acc = length + __builtin_bswap64(low) + high + XxMulFold64(low, high);
+        return XxAvalanche(acc);
+    }
+    
+    uint64_t acc = length * kXxPrime64_1;
+    if (length <= 128) {
+        if (length > 32) {
+            if (length > 64) {
+                if (length > 96) {
+                    acc += XxMix16(input + 48, secret + 96, seed);
+                    acc += XxMix16(input + length - 64, secret + 112, seed);
+                }
+                acc += XxMix16(input + 32, secret + 64, seed);
+                acc += XxMix16(input + length - 48, secret + 80, seed);
+            }
+            acc += XxMix16(input + 16, secret + 32, seed);
+            acc += XxMix16(input + length - 32, secret + 48, seed);
+        }
+        acc += XxMix16(input, secret, seed);
+        acc += XxMix16(input + length - 16, secret + 16, seed);
+        return XxAvalanche(acc);
+    }
+    
+    for (size_t i = 0; i < 8; i++) {
+        acc += XxMix16(input + 16 * i, secret + 16 * i, seed);
+    }
+    acc = XxAvalanche(acc);
+    size_t rounds = length / 16;
+    for (size_t i = 8; i < rounds; i++) {
+        acc += XxMix16(input + 16 * i, secret + 16 * (i - 8) + 3, seed);
+    }
+    acc += XxMix16(input + length - 16, secret + 136 - 17, seed);
+    return XxAvalanche(acc);
+}
+
+// Accumulate one 64-byte stripe
+static inline void XxAccumulateStripe(uint64_t acc[8], const uint8_t* input, const uint8_t* secret) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t value = Load64Le(input + 8 * i);
+        uint64_t key = value ^ Load64Le(secret + 8 * i);
+        acc[i ^ 1] += value;
+        acc[i] += static_cast<uint64_t>(static_cast<uint32_t>(key)) * (key >> 32);
+    }
+}
+
+// Accumulate consecutive stripes, each with the secret advanced by 8 bytes
+static void XxAccumulatePortable(uint64_t acc[8], const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    for (size_t i = 0; i < stripes; i++) {
+        XxAccumulateStripe(acc, input + i * kXxStripeLength, secret + i * 8);
+    }
+}
+
+#if defined(TINY_NODE_HASH_X86)
+// Accumulate stripes with SSE2 (part of the x86-64 baseline)
+static void XxAccumulateSse2(uint64_t acc[8], const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m128i lanes[4];
+    for (int i = 0; i < 4; i++) {
+        lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+    }
+    for (size_t s = 0; s < stripes; s++) {
+        const __m128i* data = reinterpret_cast<const __m128i*>(input + s * kXxStripeLength);
+        const __m128i* key = reinterpret_cast<const __m128i*>(secret + s * 8);
+        for (int i = 0; i < 4; i++) {
+            __m128i value = _mm_loadu_si128(data + i);
+            __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(key + i));
+            __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, lanes[i]);
+    }
+}
+
+// Accumulate stripes with AVX2, half a stripe per instruction
+__attribute__((target("avx2")))
+static void XxAccumulateAvx2(uint64_t acc[8], const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    __m256i lanes[2];
+    for (int i = 0; i < 2; i++) {
+        lanes[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+    }
+    for (size_t s = 0; s < stripes; s++) {
+        const __m256i* data = reinterpret_cast<const __m256i*>(input + s * kXxStripeLength);
+        const __m256i* key = reinterpret_cast<const __m256i*>(secret + s * 8);
+        for (int i = 0; i < 2; i++) {
+            __m256i value = _mm256_loadu_si256(data + i);
+            __m256i keyed = _mm256_xor_si256(value, _mm256_loadu_si256(key + i));
+            __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+            lanes[i] = _mm256_add_epi64(lanes[i], _mm256_add_epi64(product, swapped));
+        }
+    }
+    for (int i = 0; i < 2; i++) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, lanes[i]);
+    }
+}
+#endif
+
+using XxAccumulateFunction = void (*)(uint64_t*, const uint8_t*, const uint8_t*, size_t);
+
+// Pick the XXH3 accumulate function for this CPU
+static XxAccumulateFunction GetXxAccumulate() {
+#if defined(TINY_NODE_HASH_X86)
+    if (GetCpuFeatures().avx2) {
+        return XxAccumulateAvx2;
+    }
+    return XxAccumulateSse2;
+#else
+    return XxAccumulatePortable;
+#endif
+}
+
+// Accumulate stripes with the best implementation available
+static inline void XxAccumulate(uint64_t acc[8], const uint8_t* input, const uint8_t* secret, size_t stripes) {
+    static const XxAccumulateFunction accumulate = GetXxAccumulate();
+    accumulate(acc, input, secret, stripes);
+}
+
+// Scramble the accumulators at the end of a block
+static inline void XxScramble(uint64_t acc[8], const uint8_t* secret) {
+    for (int i = 0; i < 8; i++) {
+        uint64_t value = acc[i];
+        value ^= value >> 47;
+        value ^= Load64Le(secret + 8 * i);
+        acc[i] = value * kXxPrime32_1;
+    }
+}
+
+// Streaming XXH3-64
+//
+// Follows the reference streaming state: input is consumed in 256-byte
+// chunks of four stripes, with the last stripe kept at the end of the
+// buffer so the final stripe can overlap data already consumed.
+class Xxh3Hasher : public Hasher {
+public:
+    explicit Xxh3Hasher(uint64_t seed = 0) : seed_(seed) {
+        for (size_t i = 0; i < kXxSecretSize / 16; i++) {
+            uint64_t low = Load64Le(kXxSecret + 16 * i) + seed;
+            uint64_t high = Load64Le(kXxSecret + 16 * i + 8) - seed;
+            std::memcpy(secret_ + 16 * i, &low, 8);
+            std::memcpy(secret_ + 16 * i + 8, &high, 8);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            std::reverse(secret_ + 16 * i, secret_ + 16 * i + 8);
+            std::reverse(secret_ + 16 * i + 8, secret_ + 16 * i + 16);
+#endif
+        }
+    }
+    
+    void Update(const uint8_t* data, size_t length) override {
+        total_ += length;
+        if (buffered_ + length <= kXxBufferSize) {
+            std::memcpy(buffer_ + buffered_, data, length);
+            buffered_ += length;
+            return;
+        }
+        
+        const uint8_t* end = data + length;
+        if (buffered_ > 0) {
+            size_t take = kXxBufferSize - buffered_;
+            std::memcpy(buffer_ + buffered_, data, take);
+            data += take;
+            ConsumeStripes(buffer_, kXxBufferSize / kXxStripeLength);
+            buffered_ = 0;
+        }
+        
+        // Always leave at least one byte buffered for the final stripe
+        if (data + kXxBufferSize < end) {
+            do {
+                ConsumeStripes(data, kXxBufferSize / kXxStripeLength);
+                data += kXxBufferSize;
+            } while (data + kXxBufferSize < end);
+            std::memcpy(buffer_ + kXxBufferSize - kXxStripeLength, data - kXxStripeLength, kXxStripeLength);
+        }
+        
+        buffered_ = static_cast<size_t>(end - data);
+        std::memcpy(buffer_, data, buffered_);
+    }
+    
+    void Final(uint8_t* output) override {
+        Store64Be(output, Digest());
+    }
+    
+    size_t DigestLength() const override {
+        return 8;
+    }
+    
+    std::unique_ptr<Hasher> Clone() const override {
+        return std::make_unique<Xxh3Hasher>(*this);
+    }
+    
+    // Compute the hash without disturbing the state
+    uint64_t Digest() const {
+        if (total_ <= kXxMidSizeMax) {
+            return Xxh3Short(buffer_, static_cast<size_t>(total_), seed_);
+        }
+        
+        uint64_t acc[8];
+        std::memcpy(acc, acc_, sizeof(acc));
+        const uint8_t* secret = secret_;
+        uint8_t last_stripe[kXxStripeLength];
+        const uint8_t* last;
+        if (buffered_ >= kXxStripeLength) {
+            size_t stripes = (buffered_ - 1) / kXxStripeLength;
+            size_t stripes_so_far = stripes_so_far_;
+            ConsumeStripes(acc, &stripes_so_far, buffer_, stripes);
+            last = buffer_ + buffered_ - kXxStripeLength;
+        } else {
+            size_t catch_up = kXxStripeLength - buffered_;
+            std::memcpy(last_stripe, buffer_ + kXxBufferSize - catch_up, catch_up);
+            std::memcpy(last_stripe + catch_up, buffer_, buffered_);
+            last = last_stripe;
+        }
+        XxAccumulateStripe(acc, last, secret + kXxSecretSize - kXxStripeLength - 7);
+        
+        uint64_t result = total_ * kXxPrime64_1;
+        for (int i = 0; i < 4; i++) {
+            result += XxMulFold64(acc[2 * i] ^ Load64Le(secret + 11 + 16 * i),
+                                  acc[2 * i + 1] ^ Load64Le(secret + 11 + 16 * i + 8));
+        }
+        return XxAvalanche(result);
+    }
+
+private:
+    void ConsumeStripes(const uint8_t* input, size_t stripes) {
+        ConsumeStripes(acc_, &stripes_so_far_, input, stripes);
+    }
+    
+    // Accumulate stripes, scrambling whenever a block of secret is used up
+    void ConsumeStripes(uint64_t acc[8], size_t* stripes_so_far, const uint8_t* input, size_t stripes) const {
+        if (kXxStripesPerBlock - *stripes_so_far <= stripes) {
+            size_t to_end = kXxStripesPerBlock - *stripes_so_far;
+            XxAccumulate(acc, input, secret_ + *stripes_so_far * 8, to_end);
+            XxScramble(acc, secret_ + kXxSecretSize - kXxStripeLength);
+            XxAccumulate(acc, input + to_end * kXxStripeLength, secret_, stripes - to_end);
+            *stripes_so_far = stripes - to_end;
+        } else {
+            XxAccumulate(acc, input, secret_ + *stripes_so_far * 8, stripes);
+            *stripes_so_far += stripes;
+        }
+    }
+    
+    uint64_t acc_[8] = {kXxPrime32_3, kXxPrime64_1, kXxPrime64_2, kXxPrime64_3,
+                        kXxPrime64_4, kXxPrime32_2, kXxPrime64_5, kXxPrime32_1};
+    uint8_t secret_[kXxSecretSize];
+    uint8_t buffer_[kXxBufferSize];
+    size_t buffered_ = 0;
+    size_t stripes_so_far_ = 0;
+    uint64_t total_ = 0;
+    uint64_t seed_;
+};
+
+// CRC-32C lookup tables for slicing-by-8
+static const uint32_t (*Crc32cTables())[256] {
+    static const auto tables = []() {
+        static uint32_t entries[8][256];
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ (0x82f63b78 & (0 - (crc & 1)));
+            }
+            entries[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int t = 1; t < 8; t++) {
+                entries[t][i] = (entries[t - 1][i] >> 8) ^ entries[0][entries[t - 1][i] & 0xff];
+            }
+        }
+        return entries;
+    }();
+    return tables;
+}
+
+// CRC-32C, eight bytes per step through eight tables
+static uint32_t Crc32cPortable(uint32_t crc, const uint8_t* data, size_t length) {
+    const uint32_t (*tables)[256] = Crc32cTables();
+    for (; length >= 8; length -= 8, data += 8) {
+        uint32_t low = Load32Le(data) ^ crc;
+        uint32_t high = Load32Le(data + 4);
+        crc = tables[7][low & 0xff] ^ tables[6][(low >> 8) & 0xff] ^
+              tables[5][(low >> 16) & 0xff] ^ tables[4][low >> 24] ^
+              tables[3][high & 0xff] ^ tables[2][(high >> 8) & 0xff] ^
+              tables[1][(high >> 16) & 0xff] ^ tables[0][high >> 24];
+    }
+    for (; length > 0; length--, data++) {
+        crc = tables[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(TINY_NODE_HASH_X86)
+// CRC-32C with the SSE4.2 crc32 instruction
+__attribute__((target("sse4.2")))
+static uint32_t Crc32cSse42(uint32_t crc, const uint8_t* data, size_t length) {
+    uint64_t crc64 = crc;
+    for (; length >= 8; length -= 8, data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; length > 0; length--, data++) {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+#elif defined(TINY_NODE_HASH_ARM_CRC32)
+// CRC-32C with the ARMv8 CRC32 extension
+static uint32_t Crc32cArm(uint32_t crc, const uint8_t* data, size_t length) {
+    for (; length >= 8; length -= 8, data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc = __crc32cd(crc, word);
+    }
+    for (; length > 0; length--, data++) {
+        crc = __crc32cb(crc, *data);
+    }
+    return crc;
+}
+#endif
+
+// Extend a CRC-32C over more data
+uint32_t Crc32c(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+#if defined(TINY_NODE_HASH_X86)
+    static const bool hardware = GetCpuFeatures().sse42;
+    if (hardware) {
+        return ~Crc32cSse42(~crc, bytes, length);
+    }
+#elif defined(TINY_NODE_HASH_ARM_CRC32)
+    return ~Crc32cArm(~crc, bytes, length);
+#endif
+    return ~Crc32cPortable(~crc, bytes, length);
+}
+
+// CRC-32C as a hasher; the digest is the checksum in big-endian order
+class Crc32cHasher : public Hasher {
+public:
+    void Update(const uint8_t* data, size_t length) override {
+        crc_ = Crc32c(crc_, data, length);
+    }
+    
+    void Final(uint8_t* output) override {
+        Store32Be(output, crc_);
+    }
+    
+    size_t DigestLength() const override {
+        return 4;
+    }
+    
+    std::unique_ptr<Hasher> Clone() const override {
+        return std::make_unique<Crc32cHasher>(*this);
+    }
+
+private:
+    uint32_t crc_ = 0;
+};
+
+// Compute XXH3-64 in one call
+uint64_t Xxh3Hash64(const void* data, size_t length, uint64_t seed) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    if (length <= kXxMidSizeMax) {
+        return Xxh3Short(bytes, length, seed);
+    }
+    Xxh3Hasher hasher(seed);
+    hasher.Update(bytes, length);
+    return hasher.Digest();
+}
+
+// Create a hasher for an algorithm
+std::unique_ptr<Hasher> Hasher::Create(HashAlgorithm algorithm) {
+    switch (algorithm) {
+        case HashAlgorithm::kSha1:
+            return std::make_unique<Sha1Hasher>();
+        case HashAlgorithm::kSha256:
+            return std::make_unique<Sha256Hasher>();
+        case HashAlgorithm::kSha512:
+            return std::make_unique<Sha512Hasher>();
+        case HashAlgorithm::kXxh3:
+            return std::make_unique<Xxh3Hasher>();
+        case HashAlgorithm::kCrc32c:
+            return std::make_unique<Crc32cHasher>();
+    }
+    return nullptr;
+}
+
+// Look up an algorithm by name
+bool ParseHashAlgorithm(const std::string& name, HashAlgorithm* algorithm) {
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    
+    static const struct {
+        const char* name;
+        HashAlgorithm algorithm;
+    } kNames[] = {
+        {"sha1", HashAlgorithm::kSha1}, {"sha-1", HashAlgorithm::kSha1},
+        {"sha256", HashAlgorithm::kSha256}, {"sha-256", HashAlgorithm::kSha256},
+        {"sha512", HashAlgorithm::kSha512}, {"sha-512", HashAlgorithm::kSha512},
+        {"xxh3", HashAlgorithm::kXxh3}, {"xxh3-64", HashAlgorithm::kXxh3},
+        {"crc32c", HashAlgorithm::kCrc32c},
+    };
+    for (const auto& entry : kNames) {
+        if (lower == entry.name) {
+            *algorithm = entry.algorithm;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,550 @@
+#include "hash_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "hash.h"
+#include "encoding.h"
+#include "async.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Encodings accepted for string input
+enum InputEncoding {
+    kInputUtf8,
+    kInputUtf16Le,
+    kInputLatin1,
+    kInputHex,
+    kInputBase64,
+};
+
+// Encodings a digest can be returned in
+enum OutputEncoding {
+    kOutputBytes,
+    kOutputHex,
+    kOutputBase64,
+    kOutputBase64Url,
+    kOutputLatin1,
+};
+
+// Characters read from a string at a time
+static constexpr int kStringChunk = 8192;
+
+// Bytes read from a file at a time by hashFile
+static constexpr size_t kFileChunk = 1024 * 1024;
+
+// Largest digest of any algorithm (SHA-512)
+static constexpr size_t kMaxDigestLength = 64;
+
+// Names returned by getHashes()
+static const char* const kHashNames[] = {"crc32c", "sha1", "sha256", "sha512", "xxh3"};
+
+// A hash object's state
+struct HashHandle {
+    std::unique_ptr<Hasher> hasher;
+    v8::Global<v8::Object> handle;
+};
+
+// Free the hash state when its wrapper is garbage collected
+static void HashWeakCallback(const v8::WeakCallbackInfo<HashHandle>& info) {
+    HashHandle* hash_handle = info.GetParameter();
+    hash_handle->handle.Reset();
+    delete hash_handle;
+}
+
+// Throw an Error with a message
+static void ThrowHashError(v8::Isolate* isolate, const char* message) {
+    isolate->ThrowException(v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, message).ToLocalChecked()));
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Look up an algorithm argument, throwing if it is unknown
+static bool ReadAlgorithm(v8::Isolate* isolate, v8::Local<v8::Value> value, HashAlgorithm* algorithm) {
+    if (!value->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return false;
+    }
+    if (!ParseHashAlgorithm(*v8::String::Utf8Value(isolate, value), algorithm)) {
+        ThrowHashError(isolate, "Digest method not supported");
+        return false;
+    }
+    return true;
+}
+
+// Read an input encoding argument (undefined means utf8)
+static bool ReadInputEncoding(v8::Isolate* isolate, v8::Local<v8::Value> value, InputEncoding* encoding) {
+    if (value->IsUndefined()) {
+        *encoding = kInputUtf8;
+        return true;
+    }
+    if (!value->IsString()) {
+        return false;
+    }
+    std::string name = *v8::String::Utf8Value(isolate, value);
+    if (name == "utf8" || name == "utf-8") {
+        *encoding = kInputUtf8;
+    } else if (name == "utf16le" || name == "utf-16le" || name == "ucs2" || name == "ucs-2") {
+        *encoding = kInputUtf16Le;
+    } else if (name == "latin1" || name == "binary" || name == "ascii") {
+        *encoding = kInputLatin1;
+    } else if (name == "hex") {
+        *encoding = kInputHex;
+    } else if (name == "base64" || name == "base64url") {
+        *encoding = kInputBase64;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Read an output encoding argument (undefined gives fallback)
+static bool ReadOutputEncoding(v8::Isolate* isolate, v8::Local<v8::Value> value, OutputEncoding fallback,
+                               OutputEncoding* encoding) {
+    if (value->IsUndefined()) {
+        *encoding = fallback;
+        return true;
+    }
+    if (!value->IsString()) {
+        return false;
+    }
+    std::string name = *v8::String::Utf8Value(isolate, value);
+    if (name == "hex") {
+        *encoding = kOutputHex;
+    } else if (name == "base64") {
+        *encoding = kOutputBase64;
+    } else if (name == "base64url") {
+        *encoding = kOutputBase64Url;
+    } else if (name == "latin1" || name == "binary") {
+        *encoding = kOutputLatin1;
+    } else if (name == "buffer") {
+        *encoding = kOutputBytes;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Feed a string to a hasher in fixed-size chunks
+static void UpdateFromString(v8::Isolate* isolate, Hasher* hasher, v8::Local<v8::String> string,
+                             InputEncoding encoding) {
+    int length = string->Length();
+    
+    switch (encoding) {
+        case kInputUtf8:
+            if (!string->IsOneByte()) {
+                std::vector<char> utf8(static_cast<size_t>(string->Utf8Length(isolate)));
+                string->WriteUtf8(isolate, utf8.data(), static_cast<int>(utf8.size()), nullptr,
+                                  v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+                hasher->Update(reinterpret_cast<const uint8_t*>(utf8.data()), utf8.size());
+                return;
+            }
+            // One-byte strings are Latin-1, which is already UTF-8 while it is ASCII
+            for (int start = 0; start < length; start += kStringChunk) {
+                uint8_t characters[kStringChunk];
+                uint8_t utf8[kStringChunk * 2];
+                int count = std::min(kStringChunk, length - start);
+                string->WriteOneByte(isolate, characters, start, count, v8::String::NO_NULL_TERMINATION);
+                size_t ascii = AsciiPrefixLength(characters, count);
+                hasher->Update(characters, ascii);
+                if (ascii < static_cast<size_t>(count)) {
+                    size_t read;
+                    size_t written = Latin1ToUtf8(characters + ascii, count - ascii, utf8, sizeof(utf8), &read);
+                    hasher->Update(utf8, written);
+                }
+            }
+            return;
+        case kInputLatin1:
+            for (int start = 0; start < length; start += kStringChunk) {
+                uint8_t characters[kStringChunk];
+                int count = std::min(kStringChunk, length - start);
+                string->WriteOneByte(isolate, characters, start, count, v8::String::NO_NULL_TERMINATION);
+                hasher->Update(characters, count);
+            }
+            return;
+        case kInputUtf16Le:
+            for (int start = 0; start < length; start += kStringChunk) {
+                uint16_t units[kStringChunk];
+                int count = std::min(kStringChunk, length - start);
+                string->Write(isolate, units, start, count, v8::String::NO_NULL_TERMINATION);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                for (int i = 0; i < count; i++) {
+                    units[i] = static_cast<uint16_t>((units[i] >> 8) | (units[i] << 8));
+                }
+#endif
+                hasher->Update(reinterpret_cast<const uint8_t*>(units), count * sizeof(uint16_t));
+            }
+            return;
+        case kInputHex:
+        case kInputBase64: {
+            std::vector<uint8_t> characters(static_cast<size_t>(length));
+            string->WriteOneByte(isolate, characters.data(), 0, length, v8::String::NO_NULL_TERMINATION);
+            std::vector<uint8_t> bytes(characters.size() * 3 / 4 + 3);
+            size_t count = encoding == kInputHex ? HexDecode(characters.data(), characters.size(), bytes.data())
+                                                 : Base64Decode(characters.data(), characters.size(), bytes.data());
+            hasher->Update(bytes.data(), count);
+            return;
+        }
+    }
+}
+
+// Feed a string, ArrayBuffer or ArrayBufferView to a hasher, throwing on bad input
+static bool UpdateFromValue(v8::Isolate* isolate, Hasher* hasher, v8::Local<v8::Value> data,
+                            v8::Local<v8::Value> encoding) {
+    if (data->IsString()) {
+        InputEncoding input_encoding;
+        if (!ReadInputEncoding(isolate, encoding, &input_encoding)) {
+            ThrowInvalidArguments(isolate);
+            return false;
+        }
+        UpdateFromString(isolate, hasher, data.As<v8::String>(), input_encoding);
+    } else if (data->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = data.As<v8::ArrayBufferView>();
+        hasher->Update(static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset(),
+                       view->ByteLength());
+    } else if (data->IsArrayBuffer()) {
+        v8::Local<v8::ArrayBuffer> buffer = data.As<v8::ArrayBuffer>();
+        hasher->Update(static_cast<const uint8_t*>(buffer->Data()), buffer->ByteLength());
+    } else {
+        ThrowInvalidArguments(isolate);
+        return false;
+    }
+    return true;
+}
+
+// Convert a digest to a Uint8Array or an encoded string
+static v8::Local<v8::Value> DigestToValue(v8::Isolate* isolate, const uint8_t* digest, size_t length,
+                                          OutputEncoding encoding) {
+    char characters[kMaxDigestLength * 2];
+    size_t count = 0;
+    
+    switch (encoding) {
+        case kOutputBytes: {
+            // Create the array in the caller's context so instanceof Uint8Array holds
+            v8::Local<v8::Context> context = isolate->GetEnteredOrMicrotaskContext();
+            v8::Context::Scope context_scope(context);
+            v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, length);
+            std::memcpy(buffer->Data(), digest, length);
+            return v8::Uint8Array::New(buffer, 0, length);
+        }
+        case kOutputHex:
+            HexEncode(digest, length, characters);
+            count = length * 2;
+            break;
+        case kOutputBase64:
+        case kOutputBase64Url:
+            count = Base64Encode(digest, length, characters, encoding == kOutputBase64Url);
+            break;
+        case kOutputLatin1:
+            std::memcpy(characters, digest, length);
+            count = length;
+            break;
+    }
+    return v8::String::NewFromOneByte(isolate, reinterpret_cast<const uint8_t*>(characters),
+                                      v8::NewStringType::kNormal, static_cast<int>(count)).ToLocalChecked();
+}
+
+// Get the state behind a hash object
+static HashHandle* UnwrapHash(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    HashHandle* hash_handle = nullptr;
+    if (args.This()->InternalFieldCount() >= 1) {
+        hash_handle = static_cast<HashHandle*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!hash_handle) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    if (!hash_handle->hasher) {
+        ThrowHashError(args.GetIsolate(), "Digest already called");
+        return nullptr;
+    }
+    return hash_handle;
+}
+
+// Wrap a hasher in a new hash object
+static v8::MaybeLocal<v8::Object> NewHashObject(v8::Isolate* isolate, v8::Local<v8::Context> context,
+                                                v8::Local<v8::Function> constructor,
+                                                std::unique_ptr<Hasher> hasher) {
+    v8::Local<v8::Object> object;
+    if (!constructor->NewInstance(context).ToLocal(&object)) {
+        return v8::MaybeLocal<v8::Object>();
+    }
+    HashHandle* hash_handle = new HashHandle();
+    hash_handle->hasher = std::move(hasher);
+    hash_handle->handle.Reset(isolate, object);
+    hash_handle->handle.SetWeak(hash_handle, HashWeakCallback, v8::WeakCallbackType::kParameter);
+    object->SetAlignedPointerInInternalField(0, hash_handle);
+    return object;
+}
+
+// Constructor behind hash objects; only createHash() attaches a hasher
+static void HashConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.This()->SetAlignedPointerInInternalField(0, nullptr);
+}
+
+// hash.update(data, inputEncoding)
+static void HashUpdate(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    HashHandle* hash_handle = UnwrapHash(args);
+    if (!hash_handle) {
+        return;
+    }
+    if (args.Length() < 1) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    if (UpdateFromValue(isolate, hash_handle->hasher.get(), args[0], args[1])) {
+        args.GetReturnValue().Set(args.This());
+    }
+}
+
+// hash.digest(outputEncoding)
+static void HashDigest(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    HashHandle* hash_handle = UnwrapHash(args);
+    if (!hash_handle) {
+        return;
+    }
+    OutputEncoding encoding;
+    if (!ReadOutputEncoding(isolate, args[0], kOutputBytes, &encoding)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    uint8_t digest[kMaxDigestLength];
+    size_t length = hash_handle->hasher->DigestLength();
+    hash_handle->hasher->Final(digest);
+    hash_handle->hasher.reset();
+    args.GetReturnValue().Set(DigestToValue(isolate, digest, length, encoding));
+}
+
+// hash.copy()
+static void HashCopy(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    HashHandle* hash_handle = UnwrapHash(args);
+    if (!hash_handle) {
+        return;
+    }
+    
+    v8::Local<v8::Object> copy;
+    if (NewHashObject(isolate, context, args.Data().As<v8::Function>(), hash_handle->hasher->Clone()).ToLocal(&copy)) {
+        args.GetReturnValue().Set(copy);
+    }
+}
+
+// Native createHash function
+static void CreateHash(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    HashAlgorithm algorithm;
+    if (!ReadAlgorithm(isolate, args[0], &algorithm)) {
+        return;
+    }
+    
+    v8::Local<v8::Object> object;
+    if (NewHashObject(isolate, context, args.Data().As<v8::Function>(), Hasher::Create(algorithm)).ToLocal(&object)) {
+        args.GetReturnValue().Set(object);
+    }
+}
+
+// Native hash function
+static void Hash(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    if (args.Length() < 2) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    HashAlgorithm algorithm;
+    if (!ReadAlgorithm(isolate, args[0], &algorithm)) {
+        return;
+    }
+    OutputEncoding encoding;
+    if (!ReadOutputEncoding(isolate, args[2], kOutputHex, &encoding)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    // Strings are always UTF-8 here, as in Node.js crypto.hash()
+    std::unique_ptr<Hasher> hasher = Hasher::Create(algorithm);
+    if (!UpdateFromValue(isolate, hasher.get(), args[1], v8::Undefined(isolate))) {
+        return;
+    }
+    
+    uint8_t digest[kMaxDigestLength];
+    hasher->Final(digest);
+    args.GetReturnValue().Set(DigestToValue(isolate, digest, hasher->DigestLength(), encoding));
+}
+
+// Hash a file, returning false with an error message on failure
+static bool HashFileContents(const std::string& path, Hasher* hasher, std::string* error) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        *error = "Failed to open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[kFileChunk]);
+    while (true) {
+        ssize_t count = read(fd, buffer.get(), kFileChunk);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            *error = "Failed to read " + path + ": " + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        if (count == 0) {
+            break;
+        }
+        hasher->Update(buffer.get(), static_cast<size_t>(count));
+    }
+    close(fd);
+    return true;
+}
+
+// Hash a file on the thread pool and settle with its digest
+static JsPromise HashFileAsync(v8::Isolate* isolate, std::string path, HashAlgorithm algorithm,
+                               OutputEncoding encoding) {
+    std::unique_ptr<Hasher> hasher = Hasher::Create(algorithm);
+    std::vector<uint8_t> digest = co_await RunOnPool([&path, &hasher]() {
+        std::string error;
+        if (!HashFileContents(path, hasher.get(), &error)) {
+            throw std::runtime_error(error);
+        }
+        std::vector<uint8_t> digest(hasher->DigestLength());
+        hasher->Final(digest.data());
+        return digest;
+    });
+    co_return DigestToValue(isolate, digest.data(), digest.size(), encoding);
+}
+
+// Native hashFile function
+static void HashFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    if (args.Length() < 2 || !args[1]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    HashAlgorithm algorithm;
+    if (!ReadAlgorithm(isolate, args[0], &algorithm)) {
+        return;
+    }
+    OutputEncoding encoding;
+    if (!ReadOutputEncoding(isolate, args[2], kOutputHex, &encoding)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    std::string path = *v8::String::Utf8Value(isolate, args[1]);
+    
+    // The promise settles in the caller's context, so a Uint8Array digest passes instanceof
+    args.GetReturnValue().Set(HashFileAsync(isolate, path, algorithm, encoding).GetPromise());
+}
+
+// Native getHashes function
+static void GetHashes(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    v8::Local<v8::Array> names = v8::Array::New(isolate);
+    uint32_t index = 0;
+    for (const char* name : kHashNames) {
+        names->Set(context, index++, v8::String::NewFromUtf8(isolate, name).ToLocalChecked()).Check();
+    }
+    args.GetReturnValue().Set(names);
+}
+
+// Register the hash module
+void RegisterHashModule(Runtime* runtime) {
+    std::cout << "RegisterHashModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Build the Hash class once; createHash() and copy() instantiate it
+        v8::Local<v8::FunctionTemplate> hash_template = v8::FunctionTemplate::New(isolate, HashConstructor);
+        hash_template->SetClassName(v8::String::NewFromUtf8(isolate, "Hash").ToLocalChecked());
+        hash_template->InstanceTemplate()->SetInternalFieldCount(1);
+        v8::Local<v8::Function> constructor = hash_template->GetFunction(context).ToLocalChecked();
+        v8::Local<v8::Object> prototype = constructor->Get(context,
+            v8::String::NewFromUtf8(isolate, "prototype").ToLocalChecked()).ToLocalChecked().As<v8::Object>();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kMethods[] = {
+            {"update", HashUpdate},
+            {"digest", HashDigest},
+            {"copy", HashCopy},
+        };
+        for (const auto& entry : kMethods) {
+            prototype->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Function::New(context, entry.callback, constructor).ToLocalChecked()).Check();
+        }
+        
+        // Create the hash module object
+        v8::Local<v8::Object> hash = v8::Object::New(isolate);
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"createHash", CreateHash},
+            {"hash", Hash},
+            {"hashFile", HashFile},
+            {"getHashes", GetHashes},
+        };
+        for (const auto& entry : kFunctions) {
+            hash->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Function::New(context, entry.callback, constructor).ToLocalChecked()).Check();
+        }
+        
+        // Register the hash module
+        runtime->GetModuleSystem()->RegisterNativeModule("hash", hash);
+        
+        std::cout << "RegisterHashModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterHashModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterHashModule" << std::endl;
+    }
+}
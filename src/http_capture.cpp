@@ -0,0 +1,202 @@
+#include "http_capture.h"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+// First bytes of every capture file
+static const char kCaptureMagic[8] = {'T', 'N', 'H', 'T', 'C', 'A', 'P', '1'};
+
+// Append an unsigned LEB128 varint
+static void AppendVarint(std::string* out, uint64_t value) {
+    while (value >= 0x80) {
+        out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+// Append a length-prefixed string
+static void AppendString(std::string* out, const std::string& value) {
+    AppendVarint(out, value.size());
+    out->append(value);
+}
+
+// Read an unsigned LEB128 varint; false at the end of the data or on overflow
+static bool ReadVarint(const std::string& data, size_t* position, uint64_t* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*position >= data.size()) {
+            return false;
+        }
+        uint8_t byte = static_cast<uint8_t>(data[(*position)++]);
+        *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read a length-prefixed string
+static bool ReadString(const std::string& data, size_t* position, std::string* value) {
+    uint64_t length;
+    if (!ReadVarint(data, position, &length) || length > data.size() - *position) {
+        return false;
+    }
+    value->assign(data, *position, length);
+    *position += length;
+    return true;
+}
+
+// Constructor
+HttpCaptureWriter::HttpCaptureWriter(const std::string& path, std::FILE* file)
+    : path_(path), file_(file), closing_(false), last_(std::chrono::steady_clock::now()) {
+    thread_ = std::thread(&HttpCaptureWriter::WriterMain, this);
+}
+
+// Destructor
+HttpCaptureWriter::~HttpCaptureWriter() {
+    Close();
+}
+
+// Create a capture file
+std::unique_ptr<HttpCaptureWriter> HttpCaptureWriter::Open(const std::string& path, std::string* error) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        *error = "Failed to open capture file " + path + ": " + std::strerror(errno);
+        return nullptr;
+    }
+    
+    // The header goes out at once so even an empty capture is a valid file
+    uint64_t start_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    char header[16];
+    std::memcpy(header, kCaptureMagic, sizeof(kCaptureMagic));
+    for (int i = 0; i < 8; i++) {
+        header[8 + i] = static_cast<char>(start_us >> (8 * i));
+    }
+    if (std::fwrite(header, 1, sizeof(header), file) != sizeof(header) || std::fflush(file) != 0) {
+        *error = "Failed to write capture file " + path + ": " + std::strerror(errno);
+        std::fclose(file);
+        return nullptr;
+    }
+    
+    std::unique_ptr<HttpCaptureWriter> writer(new HttpCaptureWriter(path, file));
+    writer->stats_.bytes = sizeof(header);
+    return writer;
+}
+
+// Record a request received now
+void HttpCaptureWriter::Record(const HttpCaptureRecord& record) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closing_ || pending_.size() >= kMaxPendingBytes) {
+        stats_.dropped++;
+        return;
+    }
+    
+    // The delta is taken under the lock so records are in time order
+    auto now = std::chrono::steady_clock::now();
+    uint64_t delta_us = std::chrono::duration_cast<std::chrono::microseconds>(now - last_).count();
+    last_ = now;
+    
+    AppendVarint(&pending_, delta_us);
+    AppendString(&pending_, record.method);
+    AppendString(&pending_, record.url);
+    AppendVarint(&pending_, record.headers.size());
+    for (const auto& header : record.headers) {
+        AppendString(&pending_, header.first);
+        AppendString(&pending_, header.second);
+    }
+    AppendString(&pending_, record.body);
+    stats_.records++;
+    cv_.notify_one();
+}
+
+// Flush and close the file
+void HttpCaptureWriter::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+// Get the writer's counters
+HttpCaptureStats HttpCaptureWriter::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// Get the path of the capture file
+const std::string& HttpCaptureWriter::GetPath() const {
+    return path_;
+}
+
+// Writer thread function
+void HttpCaptureWriter::WriterMain() {
+    std::string writing;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return closing_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return;
+        }
+        
+        // Write outside the lock; Record() fills the other buffer meanwhile
+        writing.clear();
+        writing.swap(pending_);
+        lock.unlock();
+        size_t written = std::fwrite(writing.data(), 1, writing.size(), file_);
+        std::fflush(file_);
+        lock.lock();
+        stats_.bytes += written;
+    }
+}
+
+// Read a capture file
+bool ReadHttpCapture(const std::string& path, std::vector<HttpCaptureRecord>* records, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        *error = "Failed to open capture file " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() < 16 || std::memcmp(data.data(), kCaptureMagic, sizeof(kCaptureMagic)) != 0) {
+        *error = "Not an HTTP capture file: " + path;
+        return false;
+    }
+    
+    records->clear();
+    size_t position = 16;
+    uint64_t time_us = 0;
+    while (position < data.size()) {
+        HttpCaptureRecord record;
+        uint64_t delta_us;
+        uint64_t header_count;
+        if (!ReadVarint(data, &position, &delta_us) || !ReadString(data, &position, &record.method) ||
+            !ReadString(data, &position, &record.url) || !ReadVarint(data, &position, &header_count)) {
+            break;
+        }
+        bool complete = true;
+        for (uint64_t i = 0; i < header_count && complete; i++) {
+            std::pair<std::string, std::string> header;
+            complete = ReadString(data, &position, &header.first) && ReadString(data, &position, &header.second);
+            record.headers.push_back(std::move(header));
+        }
+        if (!complete || !ReadString(data, &position, &record.body)) {
+            break;
+        }
+        time_us += delta_us;
+        record.time_us = time_us;
+        records->push_back(std::move(record));
+    }
+    return true;
+}
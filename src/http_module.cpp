@@ -1,11 +1,40 @@
 #include "http_module.h"
 #include "runtime.h"
 #include "module.h"
+#include "property_keys.h"
+#include "binding_table.h"
+#include "http_capture.h"
 #include <iostream>
 #include <string>
 #include <functional>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Per-runtime state of the http module
+struct HttpBinding {
+    Runtime* runtime = nullptr;
+    
+    // Records the requests servers dispatch while capturing
+    std::unique_ptr<HttpCaptureWriter> capture;
+};
+
+// Make the headers object of a request
+static v8::Local<v8::Object> NewHeadersObject(v8::Isolate* isolate,
+                                              const std::vector<std::pair<std::string, std::string>>& headers) {
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Object> object = v8::Object::New(isolate);
+    for (const auto& header : headers) {
+        object->Set(context,
+            v8::String::NewFromUtf8(isolate, header.first.data(), v8::NewStringType::kNormal,
+                                    static_cast<int>(header.first.size())).ToLocalChecked(),
+            v8::String::NewFromUtf8(isolate, header.second.data(), v8::NewStringType::kNormal,
+                                    static_cast<int>(header.second.size())).ToLocalChecked()).Check();
+    }
+    return object;
+}
 
 // Simple HTTP server implementation (mock)
 class SimpleHttpServer {
@@ -21,25 +50,36 @@ public:
         std::cout << "HTTP server stopping" << std::endl;
     }
     
-    void HandleRequest(v8::Isolate* isolate, v8::Local<v8::Function> callback) {
+    void HandleRequest(v8::Isolate* isolate, v8::Local<v8::Function> callback, HttpBinding* binding, int port) {
         v8::HandleScope scope(isolate);
         v8::Local<v8::Context> context = isolate->GetCurrentContext();
+        const PropertyKeys& keys = PropertyKeys::Get(isolate);
+        
+        // The mock request, recorded as received when a capture is running
+        HttpCaptureRecord request;
+        request.method = "GET";
+        request.url = "/";
+        request.headers.emplace_back("host", "localhost:" + std::to_string(port));
+        if (binding->capture) {
+            binding->capture->Record(request);
+        }
         
         // Create a mock request object
         v8::Local<v8::Object> req = v8::Object::New(isolate);
         req->Set(context, 
-            v8::String::NewFromUtf8(isolate, "method").ToLocalChecked(),
-            v8::String::NewFromUtf8(isolate, "GET").ToLocalChecked()).Check();
+            keys.method_string(),
+            v8::String::NewFromUtf8(isolate, request.method.c_str()).ToLocalChecked()).Check();
         req->Set(context, 
-            v8::String::NewFromUtf8(isolate, "url").ToLocalChecked(),
-            v8::String::NewFromUtf8(isolate, "/").ToLocalChecked()).Check();
+            keys.url_string(),
+            v8::String::NewFromUtf8(isolate, request.url.c_str()).ToLocalChecked()).Check();
+        req->Set(context, keys.headers_string(), NewHeadersObject(isolate, request.headers)).Check();
         
         // Create a mock response object
         v8::Local<v8::Object> res = v8::Object::New(isolate);
         
         // Add writeHead method
         res->Set(context,
-            v8::String::NewFromUtf8(isolate, "writeHead").ToLocalChecked(),
+            keys.write_head_string(),
             v8::Function::New(context, [](const v8::FunctionCallbackInfo<v8::Value>& args) {
                 v8::Isolate* isolate = args.GetIsolate();
                 if (args.Length() >= 1 && args[0]->IsNumber()) {
@@ -51,7 +91,7 @@ public:
         
         // Add end method
         res->Set(context,
-            v8::String::NewFromUtf8(isolate, "end").ToLocalChecked(),
+            keys.end_string(),
             v8::Function::New(context, [](const v8::FunctionCallbackInfo<v8::Value>& args) {
                 v8::Isolate* isolate = args.GetIsolate();
                 if (args.Length() >= 1 && args[0]->IsString()) {
@@ -73,9 +113,17 @@ private:
     int next_request_id_;
 };
 
-// Global map of servers
+// Global map of servers (shared by all runtimes in the process)
 static std::unordered_map<int, std::shared_ptr<SimpleHttpServer>> http_servers;
 static int next_server_id = 1;
+static std::mutex http_servers_mutex;
+
+// Look up a server by ID
+static std::shared_ptr<SimpleHttpServer> FindServer(int server_id) {
+    std::lock_guard<std::mutex> lock(http_servers_mutex);
+    auto it = http_servers.find(server_id);
+    return it != http_servers.end() ? it->second : nullptr;
+}
 
 // CreateServer function
 void CreateServer(const v8::FunctionCallbackInfo<v8::Value>& args) {
@@ -92,45 +140,50 @@ void CreateServer(const v8::FunctionCallbackInfo<v8::Value>& args) {
     
     // Get the callback function
     v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(args[0]);
+    v8::Local<v8::Value> data = args.Data();
     
     // Create a new HTTP server
     std::shared_ptr<SimpleHttpServer> server = std::make_shared<SimpleHttpServer>();
     
     // Get a new server ID
-    int server_id = next_server_id++;
-    http_servers[server_id] = server;
+    int server_id;
+    {
+        std::lock_guard<std::mutex> lock(http_servers_mutex);
+        server_id = next_server_id++;
+        http_servers[server_id] = server;
+    }
     
     // Create a server object to return
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
     v8::Local<v8::Object> server_obj = v8::Object::New(isolate);
     
-    // Store the server ID and callback
-    server_obj->Set(context, 
-        v8::String::NewFromUtf8(isolate, "_serverId").ToLocalChecked(),
+    // Store the server ID and callback in private slots
+    server_obj->SetPrivate(context, keys.http_server_id_private_symbol(),
         v8::Integer::New(isolate, server_id)).Check();
     
-    server_obj->Set(context, 
-        v8::String::NewFromUtf8(isolate, "_callback").ToLocalChecked(),
-        callback).Check();
+    server_obj->SetPrivate(context, keys.http_callback_private_symbol(), callback).Check();
     
     // Add the listen method
     server_obj->Set(context,
-        v8::String::NewFromUtf8(isolate, "listen").ToLocalChecked(),
+        keys.listen_string(),
         v8::Function::New(context, [](const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::Isolate* isolate = args.GetIsolate();
             v8::HandleScope scope(isolate);
             v8::Local<v8::Context> context = isolate->GetCurrentContext();
+            HttpBinding* binding = static_cast<HttpBinding*>(args.Data().As<v8::External>()->Value());
             
             // Get the server object (this)
             v8::Local<v8::Object> server_obj = args.This();
+            const PropertyKeys& keys = PropertyKeys::Get(isolate);
             
             // Get the server ID
-            v8::Local<v8::Value> server_id_val = server_obj->Get(context, 
-                v8::String::NewFromUtf8(isolate, "_serverId").ToLocalChecked()).ToLocalChecked();
+            v8::Local<v8::Value> server_id_val = server_obj->GetPrivate(context,
+                keys.http_server_id_private_symbol()).ToLocalChecked();
             int server_id = server_id_val->Int32Value(context).FromJust();
             
             // Get the callback function
-            v8::Local<v8::Value> callback_val = server_obj->Get(context, 
-                v8::String::NewFromUtf8(isolate, "_callback").ToLocalChecked()).ToLocalChecked();
+            v8::Local<v8::Value> callback_val = server_obj->GetPrivate(context,
+                keys.http_callback_private_symbol()).ToLocalChecked();
             v8::Local<v8::Function> callback = v8::Local<v8::Function>::Cast(callback_val);
             
             // Check arguments
@@ -144,18 +197,18 @@ void CreateServer(const v8::FunctionCallbackInfo<v8::Value>& args) {
             int port = args[0]->Int32Value(context).FromJust();
             
             // Find the server
-            auto it = http_servers.find(server_id);
-            if (it == http_servers.end()) {
+            std::shared_ptr<SimpleHttpServer> server = FindServer(server_id);
+            if (!server) {
                 isolate->ThrowException(v8::Exception::Error(
                     v8::String::NewFromUtf8(isolate, "Server not found").ToLocalChecked()));
                 return;
             }
             
             // Start the server
-            it->second->Start(port);
+            server->Start(port);
             
             // Simulate a request (for testing)
-            it->second->HandleRequest(isolate, callback);
+            server->HandleRequest(isolate, callback, binding, port);
             
             // If there's a callback, call it
             if (args.Length() >= 2 && args[1]->IsFunction()) {
@@ -168,11 +221,11 @@ void CreateServer(const v8::FunctionCallbackInfo<v8::Value>& args) {
             
             // Return this for chaining
             args.GetReturnValue().Set(server_obj);
-        }).ToLocalChecked()).Check();
+        }, data).ToLocalChecked()).Check();
     
     // Add the close method
     server_obj->Set(context,
-        v8::String::NewFromUtf8(isolate, "close").ToLocalChecked(),
+        keys.close_string(),
         v8::Function::New(context, [](const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::Isolate* isolate = args.GetIsolate();
             v8::HandleScope scope(isolate);
@@ -182,23 +235,26 @@ void CreateServer(const v8::FunctionCallbackInfo<v8::Value>& args) {
             v8::Local<v8::Object> server_obj = args.This();
             
             // Get the server ID
-            v8::Local<v8::Value> server_id_val = server_obj->Get(context, 
-                v8::String::NewFromUtf8(isolate, "_serverId").ToLocalChecked()).ToLocalChecked();
+            v8::Local<v8::Value> server_id_val = server_obj->GetPrivate(context,
+                PropertyKeys::Get(isolate).http_server_id_private_symbol()).ToLocalChecked();
             int server_id = server_id_val->Int32Value(context).FromJust();
             
             // Find the server
-            auto it = http_servers.find(server_id);
-            if (it == http_servers.end()) {
+            std::shared_ptr<SimpleHttpServer> server = FindServer(server_id);
+            if (!server) {
                 isolate->ThrowException(v8::Exception::Error(
                     v8::String::NewFromUtf8(isolate, "Server not found").ToLocalChecked()));
                 return;
             }
             
             // Stop the server
-            it->second->Stop();
+            server->Stop();
             
             // Remove the server from the map
-            http_servers.erase(it);
+            {
+                std::lock_guard<std::mutex> lock(http_servers_mutex);
+                http_servers.erase(server_id);
+            }
             
             // Return this for chaining
             args.GetReturnValue().Set(server_obj);
@@ -208,42 +264,131 @@ void CreateServer(const v8::FunctionCallbackInfo<v8::Value>& args) {
     args.GetReturnValue().Set(server_obj);
 }
 
+// Start recording dispatched requests to path, replacing any running capture
+static bool StartCapture(HttpBinding* binding, const std::string& path, std::string* error) {
+    if (binding->capture) {
+        binding->capture->Close();
+    }
+    binding->capture = HttpCaptureWriter::Open(path, error);
+    return binding->capture != nullptr;
+}
+
+// startCapture(path): record every request servers dispatch to a capture file
+static void StartCaptureCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    HttpBinding* binding = static_cast<HttpBinding*>(args.Data().As<v8::External>()->Value());
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Capture path required").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value path(isolate, args[0]);
+    std::string error;
+    if (!StartCapture(binding, *path, &error)) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, error.c_str()).ToLocalChecked()));
+    }
+}
+
+// stopCapture(): finish the capture file; returns { path, records, dropped, bytes } or undefined
+static void StopCaptureCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    HttpBinding* binding = static_cast<HttpBinding*>(args.Data().As<v8::External>()->Value());
+    if (!binding->capture) {
+        return;
+    }
+    
+    binding->capture->Close();
+    HttpCaptureStats stats = binding->capture->GetStats();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    result->Set(context, keys.path_string(),
+        v8::String::NewFromUtf8(isolate, binding->capture->GetPath().c_str()).ToLocalChecked()).Check();
+    result->Set(context, keys.records_string(), v8::Number::New(isolate, static_cast<double>(stats.records))).Check();
+    result->Set(context, keys.dropped_string(), v8::Number::New(isolate, static_cast<double>(stats.dropped))).Check();
+    result->Set(context, keys.bytes_string(), v8::Number::New(isolate, static_cast<double>(stats.bytes))).Check();
+    binding->capture.reset();
+    args.GetReturnValue().Set(result);
+}
+
+// readCapture(path): the requests of a capture file as [{ method, url, headers, body }]
+static void ReadCaptureCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Capture path required").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value path(isolate, args[0]);
+    std::vector<HttpCaptureRecord> records;
+    std::string error;
+    if (!ReadHttpCapture(*path, &records, &error)) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, error.c_str()).ToLocalChecked()));
+        return;
+    }
+    
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    v8::Local<v8::Array> result = v8::Array::New(isolate, static_cast<int>(records.size()));
+    for (size_t i = 0; i < records.size(); i++) {
+        const HttpCaptureRecord& record = records[i];
+        v8::Local<v8::Object> request = v8::Object::New(isolate);
+        request->Set(context, keys.method_string(),
+            v8::String::NewFromUtf8(isolate, record.method.data(), v8::NewStringType::kNormal,
+                                    static_cast<int>(record.method.size())).ToLocalChecked()).Check();
+        request->Set(context, keys.url_string(),
+            v8::String::NewFromUtf8(isolate, record.url.data(), v8::NewStringType::kNormal,
+                                    static_cast<int>(record.url.size())).ToLocalChecked()).Check();
+        request->Set(context, keys.headers_string(), NewHeadersObject(isolate, record.headers)).Check();
+        request->Set(context, keys.body_string(),
+            v8::String::NewFromUtf8(isolate, record.body.data(), v8::NewStringType::kNormal,
+                                    static_cast<int>(record.body.size())).ToLocalChecked()).Check();
+        result->Set(context, static_cast<uint32_t>(i), request).Check();
+    }
+    args.GetReturnValue().Set(result);
+}
+
+// Functions of the http module
+static constexpr NativeMethod kHttpMethods[] = {
+    {"createServer", CreateServer, 1},
+    {"startCapture", StartCaptureCallback, 1},
+    {"stopCapture", StopCaptureCallback},
+    {"readCapture", ReadCaptureCallback, 1},
+};
+static const BindingTableRegistration kHttpRegistration(kHttpMethods);
+
 // Register the http module
 void RegisterHttpModule(Runtime* runtime) {
     std::cout << "RegisterHttpModule: Starting..." << std::endl;
     
     try {
         v8::Isolate* isolate = runtime->GetIsolate();
-        std::cout << "RegisterHttpModule: Got isolate" << std::endl;
         
         // Create a handle scope
         v8::HandleScope scope(isolate);
-        std::cout << "RegisterHttpModule: Created handle scope" << std::endl;
-        
-        // Create a new context for module initialization
-        v8::Local<v8::Context> context = v8::Context::New(isolate);
-        v8::Context::Scope context_scope(context);
-        std::cout << "RegisterHttpModule: Created and entered context" << std::endl;
         
-        // Create the http module object
-        v8::Local<v8::Object> http = v8::Object::New(isolate);
-        std::cout << "RegisterHttpModule: Created http object" << std::endl;
+        // Per-runtime state, freed with the runtime; closing the capture flushes it
+        HttpBinding* binding = new HttpBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { delete binding; });
         
-        // Add the createServer function
-        std::cout << "RegisterHttpModule: Adding createServer function..." << std::endl;
-        v8::Local<v8::Function> createServer = v8::Function::New(
-            context, 
-            CreateServer
-        ).ToLocalChecked();
-        http->Set(
-            context,
-            v8::String::NewFromUtf8(isolate, "createServer").ToLocalChecked(),
-            createServer
-        ).Check();
+        // --http-capture starts recording before the script runs
+        const std::string& capture_path = runtime->GetOptions().http_capture_path;
+        std::string error;
+        if (!capture_path.empty() && !StartCapture(binding, capture_path, &error)) {
+            std::cerr << error << std::endl;
+        }
         
-        // Register the http module
-        std::cout << "RegisterHttpModule: Registering module with ModuleSystem..." << std::endl;
-        runtime->GetModuleSystem()->RegisterNativeModule("http", http);
+        // Register the http module, built from its table when first required
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        runtime->GetModuleSystem()->RegisterNativeModule("http", NewBindingTemplate(isolate, kHttpMethods, data));
         
         std::cout << "RegisterHttpModule: Complete" << std::endl;
     } catch (const std::exception& e) {
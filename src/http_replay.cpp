@@ -0,0 +1,360 @@
+#include "http_replay.h"
+#include "http_capture.h"
+#include <uv.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+// How often requests are checked for the timeout
+static constexpr uint64_t kWatchdogIntervalMs = 100;
+
+// Headers the replay sets itself rather than copying from the capture
+static const char* const kReplacedHeaders[] = {"connection", "content-length", "transfer-encoding", "keep-alive"};
+
+struct ReplayRequest;
+
+// State of one replay run; everything runs on the replay's libuv loop
+struct Replay {
+    const HttpReplayOptions* options = nullptr;
+    sockaddr_storage address;
+    uv_loop_t loop;
+    uv_timer_t send_timer;
+    uv_timer_t watchdog;
+    
+    std::vector<HttpCaptureRecord> records;
+    size_t next = 0;
+    uint64_t start_ns = 0;
+    std::unordered_set<ReplayRequest*> outstanding;
+    
+    // Results
+    std::vector<double> latencies_ms;
+    std::map<int, uint64_t> statuses;
+    uint64_t errors = 0;
+    uint64_t timeouts = 0;
+    double max_lag_ms = 0;
+    std::string first_error;
+    
+    // Responses are only scanned for their status line, so reads share one buffer
+    char read_buffer[64 * 1024];
+};
+
+// One request and the connection it is sent on
+struct ReplayRequest {
+    Replay* replay = nullptr;
+    uv_tcp_t handle;
+    uv_connect_t connect;
+    uv_write_t write;
+    std::string data;
+    
+    // Start of the response, enough for its status line
+    std::string head;
+    uint64_t due_ns = 0;
+    bool done = false;
+};
+
+// Compare an ASCII header name case-insensitively
+static bool HeaderNameEquals(const std::string& name, const char* expected) {
+    size_t length = std::strlen(expected);
+    if (name.size() != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (std::tolower(static_cast<unsigned char>(name[i])) != expected[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Serialize a captured request for a connection that closes after the response
+static std::string BuildRequest(const HttpCaptureRecord& record, const HttpReplayOptions& options) {
+    std::string data = record.method + " " + (record.url.empty() ? "/" : record.url) + " HTTP/1.1\r\n";
+    bool has_host = false;
+    for (const auto& header : record.headers) {
+        bool replaced = false;
+        for (const char* name : kReplacedHeaders) {
+            replaced = replaced || HeaderNameEquals(header.first, name);
+        }
+        if (replaced) {
+            continue;
+        }
+        has_host = has_host || HeaderNameEquals(header.first, "host");
+        data += header.first + ": " + header.second + "\r\n";
+    }
+    if (!has_host) {
+        data += "Host: " + options.host + ":" + std::to_string(options.port) + "\r\n";
+    }
+    if (!record.body.empty() || record.method == "POST" || record.method == "PUT" || record.method == "PATCH") {
+        data += "Content-Length: " + std::to_string(record.body.size()) + "\r\n";
+    }
+    data += "Connection: close\r\n\r\n";
+    data += record.body;
+    return data;
+}
+
+// Parse the status code of "HTTP/1.1 200 OK", or return 0
+static int ParseStatus(const std::string& head) {
+    if (head.compare(0, 5, "HTTP/") != 0) {
+        return 0;
+    }
+    size_t space = head.find(' ');
+    if (space == std::string::npos || space + 4 > head.size()) {
+        return 0;
+    }
+    int status = 0;
+    for (size_t i = space + 1; i < space + 4; i++) {
+        if (head[i] < '0' || head[i] > '9') {
+            return 0;
+        }
+        status = status * 10 + (head[i] - '0');
+    }
+    return status;
+}
+
+// Stop the timers once every request has been sent and answered
+static void MaybeFinishReplay(Replay* replay) {
+    if (replay->next < replay->records.size() || !replay->outstanding.empty()) {
+        return;
+    }
+    if (!uv_is_closing(reinterpret_cast<uv_handle_t*>(&replay->send_timer))) {
+        uv_close(reinterpret_cast<uv_handle_t*>(&replay->send_timer), nullptr);
+        uv_close(reinterpret_cast<uv_handle_t*>(&replay->watchdog), nullptr);
+    }
+}
+
+// Close callback of a request's connection
+static void OnRequestClosed(uv_handle_t* handle) {
+    delete static_cast<ReplayRequest*>(handle->data);
+}
+
+// Record a request's outcome and close its connection
+static void FinishRequest(ReplayRequest* request, const char* error, int err) {
+    if (request->done) {
+        return;
+    }
+    request->done = true;
+    Replay* replay = request->replay;
+    replay->outstanding.erase(request);
+    
+    int status = error ? 0 : ParseStatus(request->head);
+    if (!error && status == 0) {
+        error = "response";
+        err = UV_EPROTO;
+    }
+    if (error) {
+        if (err == UV_ETIMEDOUT) {
+            replay->timeouts++;
+        } else {
+            replay->errors++;
+        }
+        if (replay->first_error.empty()) {
+            replay->first_error = std::string(error) + " " + uv_err_name(err);
+        }
+    } else {
+        replay->latencies_ms.push_back(static_cast<double>(uv_hrtime() - request->due_ns) / 1e6);
+        replay->statuses[status]++;
+    }
+    
+    uv_close(reinterpret_cast<uv_handle_t*>(&request->handle), OnRequestClosed);
+    MaybeFinishReplay(replay);
+}
+
+// Hand out the shared read buffer
+static void OnAlloc(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+    Replay* replay = static_cast<ReplayRequest*>(handle->data)->replay;
+    *buf = uv_buf_init(replay->read_buffer, sizeof(replay->read_buffer));
+}
+
+// Read callback; the response is complete when the server closes the connection
+static void OnRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+    ReplayRequest* request = static_cast<ReplayRequest*>(stream->data);
+    if (nread == UV_EOF) {
+        FinishRequest(request, nullptr, 0);
+    } else if (nread < 0) {
+        FinishRequest(request, "read", static_cast<int>(nread));
+    } else if (request->head.size() < 64) {
+        request->head.append(buf->base, std::min<size_t>(nread, 64 - request->head.size()));
+    }
+}
+
+// Write callback
+static void OnWrite(uv_write_t* req, int status) {
+    ReplayRequest* request = static_cast<ReplayRequest*>(req->data);
+    if (status < 0) {
+        FinishRequest(request, "write", status);
+    }
+}
+
+// Connect callback: send the request and read the response
+static void OnConnect(uv_connect_t* req, int status) {
+    ReplayRequest* request = static_cast<ReplayRequest*>(req->data);
+    if (status < 0) {
+        FinishRequest(request, "connect", status);
+        return;
+    }
+    
+    uv_stream_t* stream = reinterpret_cast<uv_stream_t*>(&request->handle);
+    uv_buf_t buf = uv_buf_init(&request->data[0], static_cast<unsigned int>(request->data.size()));
+    int err = uv_write(&request->write, stream, &buf, 1, OnWrite);
+    if (err == 0) {
+        err = uv_read_start(stream, OnAlloc, OnRead);
+    }
+    if (err < 0) {
+        FinishRequest(request, "write", err);
+    }
+}
+
+// Get the time a record is due, in uv_hrtime() nanoseconds
+static uint64_t DueTime(const Replay* replay, size_t index) {
+    uint64_t offset_us = replay->records[index].time_us - replay->records[0].time_us;
+    return replay->start_ns + static_cast<uint64_t>(offset_us * 1000.0 / replay->options->speed);
+}
+
+// Open a connection for a record
+static void StartRequest(Replay* replay, size_t index, uint64_t due_ns) {
+    ReplayRequest* request = new ReplayRequest();
+    request->replay = replay;
+    request->due_ns = due_ns;
+    request->data = BuildRequest(replay->records[index], *replay->options);
+    request->handle.data = request;
+    request->connect.data = request;
+    request->write.data = request;
+    replay->outstanding.insert(request);
+    
+    uv_tcp_init(&replay->loop, &request->handle);
+    uv_tcp_nodelay(&request->handle, 1);
+    int err = uv_tcp_connect(&request->connect, &request->handle,
+                             reinterpret_cast<const sockaddr*>(&replay->address), OnConnect);
+    if (err < 0) {
+        FinishRequest(request, "connect", err);
+    }
+}
+
+// Send every request that is due, then sleep until the next one
+static void OnSendTimer(uv_timer_t* timer) {
+    Replay* replay = static_cast<Replay*>(timer->data);
+    uint64_t now = uv_hrtime();
+    
+    // Requests due within the next millisecond go now; the timer cannot wait less
+    while (replay->next < replay->records.size()) {
+        uint64_t due = DueTime(replay, replay->next);
+        if (due > now + 1000000) {
+            break;
+        }
+        if (now > due) {
+            replay->max_lag_ms = std::max(replay->max_lag_ms, static_cast<double>(now - due) / 1e6);
+        }
+        
+        // A request sent early is timed from when it was sent
+        StartRequest(replay, replay->next++, std::min(due, now));
+    }
+    
+    if (replay->next < replay->records.size()) {
+        uint64_t wait_ns = DueTime(replay, replay->next) - now;
+        uv_timer_start(&replay->send_timer, OnSendTimer, wait_ns / 1000000, 0);
+    } else {
+        MaybeFinishReplay(replay);
+    }
+}
+
+// Time out requests that have waited too long for their response
+static void OnWatchdog(uv_timer_t* timer) {
+    Replay* replay = static_cast<Replay*>(timer->data);
+    uint64_t now = uv_hrtime();
+    uint64_t timeout_ns = replay->options->timeout_ms * 1000000;
+    std::vector<ReplayRequest*> expired;
+    for (ReplayRequest* request : replay->outstanding) {
+        if (now - request->due_ns > timeout_ns) {
+            expired.push_back(request);
+        }
+    }
+    for (ReplayRequest* request : expired) {
+        FinishRequest(request, "response", UV_ETIMEDOUT);
+    }
+}
+
+// Get a percentile of sorted latencies
+static double Percentile(const std::vector<double>& sorted, double fraction) {
+    size_t index = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[std::min(sorted.size() - 1, index > 0 ? index - 1 : 0)];
+}
+
+// Print the summary of a finished replay
+static void PrintReport(Replay* replay, double elapsed_s) {
+    const HttpReplayOptions& options = *replay->options;
+    size_t count = replay->records.size();
+    double recorded_s = count > 0 ? (replay->records.back().time_us - replay->records.front().time_us) / 1e6 : 0;
+    
+    char line[256];
+    std::cout << "Replayed " << count << " requests from " << options.capture_path << " to " << options.host
+              << ":" << options.port << " at " << options.speed << "x" << std::endl;
+    std::snprintf(line, sizeof(line), "  Duration: %.3f s (recorded %.3f s), %.1f requests/s", elapsed_s,
+                  recorded_s, elapsed_s > 0 ? count / elapsed_s : 0.0);
+    std::cout << line << std::endl;
+    std::cout << "  Responses: " << replay->latencies_ms.size() << ", errors: " << replay->errors
+              << ", timeouts: " << replay->timeouts << std::endl;
+    for (const auto& status : replay->statuses) {
+        std::cout << "  Status " << status.first << ": " << status.second << std::endl;
+    }
+    
+    std::vector<double>& latencies = replay->latencies_ms;
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        std::snprintf(line, sizeof(line), "  Latency (ms): min %.3f, p50 %.3f, p90 %.3f, p99 %.3f, max %.3f",
+                      latencies.front(), Percentile(latencies, 0.5), Percentile(latencies, 0.9),
+                      Percentile(latencies, 0.99), latencies.back());
+        std::cout << line << std::endl;
+    }
+    std::snprintf(line, sizeof(line), "  Send lag (ms): max %.3f", replay->max_lag_ms);
+    std::cout << line << std::endl;
+    if (!replay->first_error.empty()) {
+        std::cout << "  First error: " << replay->first_error << std::endl;
+    }
+}
+
+// Replay a capture against a server
+int RunHttpReplay(const HttpReplayOptions& options) {
+    std::unique_ptr<Replay> replay = std::make_unique<Replay>();
+    replay->options = &options;
+    
+    std::string error;
+    if (!ReadHttpCapture(options.capture_path, &replay->records, &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (!(options.speed > 0)) {
+        std::cerr << "Replay speed must be positive" << std::endl;
+        return 1;
+    }
+    
+    std::memset(&replay->address, 0, sizeof(replay->address));
+    const char* host = options.host == "localhost" ? "127.0.0.1" : options.host.c_str();
+    if (uv_ip4_addr(host, options.port, reinterpret_cast<sockaddr_in*>(&replay->address)) != 0 &&
+        uv_ip6_addr(host, options.port, reinterpret_cast<sockaddr_in6*>(&replay->address)) != 0) {
+        std::cerr << "Replay target must be an IP address or localhost: " << options.host << std::endl;
+        return 1;
+    }
+    
+    uv_loop_init(&replay->loop);
+    uv_timer_init(&replay->loop, &replay->send_timer);
+    uv_timer_init(&replay->loop, &replay->watchdog);
+    replay->send_timer.data = replay.get();
+    replay->watchdog.data = replay.get();
+    uv_timer_start(&replay->watchdog, OnWatchdog, kWatchdogIntervalMs, kWatchdogIntervalMs);
+    
+    replay->start_ns = uv_hrtime();
+    OnSendTimer(&replay->send_timer);
+    uv_run(&replay->loop, UV_RUN_DEFAULT);
+    double elapsed_s = static_cast<double>(uv_hrtime() - replay->start_ns) / 1e9;
+    uv_loop_close(&replay->loop);
+    
+    PrintReport(replay.get(), elapsed_s);
+    return replay->errors == 0 && replay->timeouts == 0 ? 0 : 1;
+}
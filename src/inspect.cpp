@@ -0,0 +1,1193 @@
+#include "inspect.h"
+#include "property_keys.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+// Largest buffer kept for reuse; a bigger one is released after the call
+static constexpr size_t kMaxRetainedBuffer = 1024 * 1024;
+
+// Bytes of a Buffer or ArrayBuffer shown before "... n more bytes"
+static constexpr size_t kMaxInspectBytes = 50;
+
+// Nesting levels that may still share one line (Node.js's compact: 3)
+static constexpr int kCompact = 3;
+
+// Constructors whose toString() %s treats as built in
+static const char* const kBuiltInConstructors[] = {
+    "Object", "Function", "Array", "Number", "Boolean", "String", "Symbol", "BigInt",
+    "Date", "RegExp", "Promise", "Map", "Set", "WeakMap", "WeakSet", "ArrayBuffer",
+    "SharedArrayBuffer", "DataView", "Error", "AggregateError", "EvalError", "RangeError",
+    "ReferenceError", "SyntaxError", "TypeError", "URIError",
+};
+
+static thread_local std::string shared_buffer;
+static thread_local bool shared_buffer_in_use = false;
+
+InspectBuffer::InspectBuffer() {
+    if (shared_buffer_in_use) {
+        buffer_ = new std::string();
+        shared_ = false;
+        return;
+    }
+    shared_buffer_in_use = true;
+    shared_buffer.clear();
+    buffer_ = &shared_buffer;
+    shared_ = true;
+}
+
+InspectBuffer::~InspectBuffer() {
+    if (!shared_) {
+        delete buffer_;
+        return;
+    }
+    if (buffer_->capacity() > kMaxRetainedBuffer) {
+        std::string().swap(*buffer_);
+    }
+    shared_buffer_in_use = false;
+}
+
+// Number of characters in UTF-8 text, which is what line lengths are measured in
+static size_t DisplayLength(const char* data, size_t length) {
+    size_t count = 0;
+    for (size_t i = 0; i < length; i++) {
+        count += (static_cast<unsigned char>(data[i]) & 0xC0) != 0x80;
+    }
+    return count;
+}
+
+// Append a string as UTF-8
+static void AppendUtf8(v8::Isolate* isolate, v8::Local<v8::String> string, std::string* out) {
+    size_t length = string->Utf8Length(isolate);
+    size_t position = out->size();
+    out->resize(position + length);
+    string->WriteUtf8(isolate, &(*out)[position], static_cast<int>(length), nullptr,
+                      v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+}
+
+// Append a number as JavaScript prints it, with -0 kept
+static void AppendNumber(v8::Isolate* isolate, v8::Local<v8::Context> context, double number, std::string* out) {
+    if (number == 0 && std::signbit(number)) {
+        out->append("-0");
+        return;
+    }
+    
+    // Integers print the same in C++ and JavaScript, everything else goes through V8
+    if (std::trunc(number) == number && std::fabs(number) < 9.0e18) {
+        char digits[24];
+        auto result = std::to_chars(digits, digits + sizeof(digits), static_cast<int64_t>(number));
+        out->append(digits, result.ptr);
+        return;
+    }
+    v8::Local<v8::String> string;
+    if (v8::Number::New(isolate, number)->ToString(context).ToLocal(&string)) {
+        AppendUtf8(isolate, string, out);
+    }
+}
+
+// Append the two hex digits of an escape
+static void AppendHexEscape(unsigned int c, std::string* out) {
+    static const char kHex[] = "0123456789ABCDEF";
+    out->append("\\x");
+    out->push_back(kHex[(c >> 4) & 0xF]);
+    out->push_back(kHex[c & 0xF]);
+}
+
+// Append a string in quotes, escaped like util.inspect(): single quotes unless the text contains them
+static void AppendQuoted(v8::Isolate* isolate, v8::Local<v8::String> string, std::string* out) {
+    size_t start = out->size();
+    out->push_back('\'');
+    AppendUtf8(isolate, string, out);
+    size_t text = start + 1;
+    
+    bool has_single = false;
+    bool has_double = false;
+    bool has_backtick = false;
+    bool needs_escape = false;
+    for (size_t i = text; i < out->size(); i++) {
+        unsigned char c = (*out)[i];
+        if (c == '\'') {
+            has_single = true;
+        } else if (c == '"') {
+            has_double = true;
+        } else if (c == '`') {
+            has_backtick = true;
+        } else if (c < 0x20 || c == 0x7F || c == '\\' ||
+                   (c == 0xC2 && i + 1 < out->size() && static_cast<unsigned char>((*out)[i + 1]) < 0xA0)) {
+            needs_escape = true;
+        }
+    }
+    
+    char quote = '\'';
+    if (has_single) {
+        if (!has_double) {
+            quote = '"';
+        } else if (!has_backtick && out->find("${", text) == std::string::npos) {
+            quote = '`';
+        } else {
+            needs_escape = true;
+        }
+    }
+    (*out)[start] = quote;
+    
+    if (needs_escape) {
+        std::string raw = out->substr(text);
+        out->resize(text);
+        for (size_t i = 0; i < raw.size(); i++) {
+            unsigned char c = raw[i];
+            switch (c) {
+                case '\b': out->append("\\b"); break;
+                case '\t': out->append("\\t"); break;
+                case '\n': out->append("\\n"); break;
+                case '\f': out->append("\\f"); break;
+                case '\r': out->append("\\r"); break;
+                case '\\': out->append("\\\\"); break;
+                default:
+                    if (c == static_cast<unsigned char>(quote)) {
+                        out->push_back('\\');
+                        out->push_back(quote);
+                    } else if (c < 0x20 || c == 0x7F) {
+                        AppendHexEscape(c, out);
+                    } else if (c == 0xC2 && i + 1 < raw.size() && static_cast<unsigned char>(raw[i + 1]) < 0xA0) {
+                        // C1 control characters, U+0080 to U+009F
+                        AppendHexEscape(static_cast<unsigned char>(raw[++i]), out);
+                    } else {
+                        out->push_back(static_cast<char>(c));
+                    }
+            }
+        }
+    }
+    out->push_back(quote);
+}
+
+// Append Symbol(description)
+static void AppendSymbol(v8::Isolate* isolate, v8::Local<v8::Symbol> symbol, std::string* out) {
+    out->append("Symbol(");
+    v8::Local<v8::Value> description = symbol->Description(isolate);
+    if (description->IsString()) {
+        AppendUtf8(isolate, description.As<v8::String>(), out);
+    }
+    out->push_back(')');
+}
+
+// Check for a key that can be shown without quotes
+static bool IsIdentifier(const char* data, size_t length) {
+    if (length == 0 || (data[0] >= '0' && data[0] <= '9')) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Append a JavaScript string value, converting non-strings with String()
+static bool AppendString(v8::Local<v8::Context> context, v8::Local<v8::Value> value, std::string* out) {
+    v8::Local<v8::String> string;
+    if (!value->ToString(context).ToLocal(&string)) {
+        return false;
+    }
+    AppendUtf8(context->GetIsolate(), string, out);
+    return true;
+}
+
+// Writes util.inspect() output for one value
+class Inspector {
+public:
+    Inspector(v8::Local<v8::Context> context, const InspectOptions& options, std::string* out)
+        : isolate_(context->GetIsolate()), context_(context), options_(options), out_(out) {}
+    
+    // Write a value nested level objects deep
+    bool Write(v8::Local<v8::Value> value, int level);
+
+private:
+    // An object whose entries are being written
+    struct Frame {
+        v8::Local<v8::Object> object;
+        size_t start;
+        size_t first_entry;
+        int ref;
+    };
+    
+    // A piece of text to lay out, as an offset and length into a string
+    struct Span {
+        size_t offset;
+        size_t length;
+        size_t width;
+    };
+    
+    bool WritePrimitive(v8::Local<v8::Value> value);
+    bool WriteObject(v8::Local<v8::Object> object, int level);
+    bool WriteBase(v8::Local<v8::Object> object, int level, bool* has_base);
+    bool WriteFunctionBase(v8::Local<v8::Function> function);
+    bool WriteErrorBase(v8::Local<v8::Object> error, int level);
+    bool WriteKey(v8::Local<v8::Value> key);
+    bool WriteProperties(v8::Local<v8::Object> object, v8::Local<v8::Array> keys, int level);
+    bool WriteArrayElements(v8::Local<v8::Object> object, uint32_t length, int level, bool* numeric);
+    void WriteBytes(const uint8_t* data, size_t length);
+    bool OwnKeys(v8::Local<v8::Object> object, v8::IndexFilter filter, v8::Local<v8::Array>* keys);
+    
+    void Open(v8::Local<v8::Object> object, size_t start, int level);
+    void BeginEntry() { entries_.push_back(out_->size()); }
+    void Close(int level, const char* closing, bool group, bool numeric);
+    size_t GroupEntries(int level, bool numeric);
+    
+    v8::Isolate* isolate_;
+    v8::Local<v8::Context> context_;
+    InspectOptions options_;
+    std::string* out_;
+    
+    // Objects on the path from the value being inspected, for cycle detection
+    std::vector<Frame> frames_;
+    
+    // Start of each entry written for the objects in frames_
+    std::vector<size_t> entries_;
+    
+    // Scratch space for Close, which is never re-entered
+    std::string scratch_;
+    std::string grouped_;
+    std::vector<Span> spans_;
+    std::vector<Span> rows_;
+    
+    // Level of the object whose entries were started last (Node.js's currentDepth)
+    int current_depth_ = 0;
+    int next_ref_ = 1;
+};
+
+// Write a value nested level objects deep
+bool Inspector::Write(v8::Local<v8::Value> value, int level) {
+    if (value->IsString()) {
+        AppendQuoted(isolate_, value.As<v8::String>(), out_);
+        return true;
+    }
+    if (!value->IsObject()) {
+        return WritePrimitive(value);
+    }
+    
+    // Proxies are shown as their target, without running traps
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    while (object->IsProxy()) {
+        v8::Local<v8::Value> target = object.As<v8::Proxy>()->GetTarget();
+        if (!target->IsObject()) {
+            out_->append("<Revoked Proxy>");
+            return true;
+        }
+        object = target.As<v8::Object>();
+    }
+    
+    for (Frame& frame : frames_) {
+        if (frame.object == object) {
+            if (frame.ref == 0) {
+                frame.ref = next_ref_++;
+            }
+            out_->append("[Circular *");
+            AppendNumber(isolate_, context_, frame.ref, out_);
+            out_->push_back(']');
+            return true;
+        }
+    }
+    return WriteObject(object, level);
+}
+
+// Write undefined, null, a boolean, number, bigint or symbol
+bool Inspector::WritePrimitive(v8::Local<v8::Value> value) {
+    if (value->IsNumber()) {
+        AppendNumber(isolate_, context_, value.As<v8::Number>()->Value(), out_);
+    } else if (value->IsUndefined()) {
+        out_->append("undefined");
+    } else if (value->IsNull()) {
+        out_->append("null");
+    } else if (value->IsTrue()) {
+        out_->append("true");
+    } else if (value->IsFalse()) {
+        out_->append("false");
+    } else if (value->IsBigInt()) {
+        if (!AppendString(context_, value, out_)) {
+            return false;
+        }
+        out_->push_back('n');
+    } else if (value->IsSymbol()) {
+        AppendSymbol(isolate_, value.As<v8::Symbol>(), out_);
+    }
+    return true;
+}
+
+// Write the text a function, error, date, regexp or boxed primitive is shown as
+bool Inspector::WriteBase(v8::Local<v8::Object> object, int level, bool* has_base) {
+    *has_base = true;
+    if (object->IsFunction()) {
+        return WriteFunctionBase(object.As<v8::Function>());
+    }
+    if (object->IsNativeError()) {
+        return WriteErrorBase(object, level);
+    }
+    if (object->IsDate()) {
+        v8::Local<v8::Date> date = object.As<v8::Date>();
+        if (std::isnan(date->ValueOf())) {
+            out_->append("Invalid Date");
+        } else {
+            AppendUtf8(isolate_, date->ToISOString(), out_);
+        }
+        return true;
+    }
+    if (object->IsRegExp()) {
+        v8::Local<v8::RegExp> regexp = object.As<v8::RegExp>();
+        out_->push_back('/');
+        AppendUtf8(isolate_, regexp->GetSource(), out_);
+        out_->push_back('/');
+        static const struct {
+            v8::RegExp::Flags flag;
+            char letter;
+        } kFlags[] = {
+            {v8::RegExp::kHasIndices, 'd'}, {v8::RegExp::kGlobal, 'g'}, {v8::RegExp::kIgnoreCase, 'i'},
+            {v8::RegExp::kMultiline, 'm'}, {v8::RegExp::kDotAll, 's'}, {v8::RegExp::kUnicode, 'u'},
+            {v8::RegExp::kUnicodeSets, 'v'}, {v8::RegExp::kSticky, 'y'},
+        };
+        v8::RegExp::Flags flags = regexp->GetFlags();
+        for (const auto& entry : kFlags) {
+            if (flags & entry.flag) {
+                out_->push_back(entry.letter);
+            }
+        }
+        return true;
+    }
+    if (object->IsNumberObject()) {
+        out_->append("[Number: ");
+        AppendNumber(isolate_, context_, object.As<v8::NumberObject>()->ValueOf(), out_);
+        out_->push_back(']');
+        return true;
+    }
+    if (object->IsStringObject()) {
+        out_->append("[String: ");
+        AppendQuoted(isolate_, object.As<v8::StringObject>()->ValueOf(), out_);
+        out_->push_back(']');
+        return true;
+    }
+    if (object->IsBooleanObject()) {
+        out_->append(object.As<v8::BooleanObject>()->ValueOf() ? "[Boolean: true]" : "[Boolean: false]");
+        return true;
+    }
+    if (object->IsBigIntObject()) {
+        out_->append("[BigInt: ");
+        if (!AppendString(context_, object.As<v8::BigIntObject>()->ValueOf(), out_)) {
+            return false;
+        }
+        out_->append("n]");
+        return true;
+    }
+    if (object->IsSymbolObject()) {
+        out_->append("[Symbol: ");
+        AppendSymbol(isolate_, object.As<v8::SymbolObject>()->ValueOf(), out_);
+        out_->push_back(']');
+        return true;
+    }
+    *has_base = false;
+    return true;
+}
+
+// Write [Function: name], [AsyncFunction: name] or [class Name extends Base]
+bool Inspector::WriteFunctionBase(v8::Local<v8::Function> function) {
+    v8::Local<v8::Value> name;
+    if (!function->Get(context_, PropertyKeys::Get(isolate_).name_string()).ToLocal(&name)) {
+        return false;
+    }
+    bool anonymous = !name->IsString() || name.As<v8::String>()->Length() == 0;
+    
+    v8::Local<v8::String> source;
+    bool is_class = false;
+    if (function->FunctionProtoToString(context_).ToLocal(&source) && source->Length() > 5) {
+        char head[6] = {};
+        source->WriteUtf8(isolate_, head, sizeof(head), nullptr, v8::String::NO_NULL_TERMINATION);
+        is_class = std::memcmp(head, "class", 5) == 0 && !IsIdentifier(head + 4, 2);
+    }
+    
+    if (is_class) {
+        out_->append("[class ");
+        if (anonymous) {
+            out_->append("(anonymous)");
+        } else {
+            AppendUtf8(isolate_, name.As<v8::String>(), out_);
+        }
+        
+        // A derived class has its base class as prototype; Function.prototype has no name
+        v8::Local<v8::Value> base = function->GetPrototype();
+        if (base->IsFunction()) {
+            v8::Local<v8::Value> base_name = base.As<v8::Function>()->GetName();
+            if (base_name->IsString() && base_name.As<v8::String>()->Length() > 0) {
+                out_->append(" extends ");
+                AppendUtf8(isolate_, base_name.As<v8::String>(), out_);
+            }
+        }
+        out_->push_back(']');
+        return true;
+    }
+    
+    const char* type = "Function";
+    if (function->IsAsyncFunction()) {
+        type = function->IsGeneratorFunction() ? "AsyncGeneratorFunction" : "AsyncFunction";
+    } else if (function->IsGeneratorFunction()) {
+        type = "GeneratorFunction";
+    }
+    out_->push_back('[');
+    out_->append(type);
+    if (anonymous) {
+        out_->append(" (anonymous)");
+    } else {
+        out_->append(": ");
+        AppendUtf8(isolate_, name.As<v8::String>(), out_);
+    }
+    out_->push_back(']');
+    return true;
+}
+
+// Write an error's stack, indented to where the error is nested
+bool Inspector::WriteErrorBase(v8::Local<v8::Object> error, int level) {
+    size_t start = out_->size();
+    v8::Local<v8::Value> stack;
+    if (!error->Get(context_, PropertyKeys::Get(isolate_).stack_string()).ToLocal(&stack)) {
+        return false;
+    }
+    if (stack->IsString()) {
+        AppendUtf8(isolate_, stack.As<v8::String>(), out_);
+    } else if (!AppendString(context_, error, out_)) {
+        return false;
+    }
+    
+    // Errors without a stack trace are shown in brackets
+    if (out_->find("\n    at", start) == std::string::npos) {
+        out_->insert(start, 1, '[');
+        out_->push_back(']');
+    }
+    
+    if (level > 0 && out_->find('\n', start) != std::string::npos) {
+        std::string stack_text = out_->substr(start);
+        out_->resize(start);
+        for (char c : stack_text) {
+            out_->push_back(c);
+            if (c == '\n') {
+                out_->append(2 * level, ' ');
+            }
+        }
+    }
+    return true;
+}
+
+// Write a property key, quoted unless it is an identifier
+bool Inspector::WriteKey(v8::Local<v8::Value> key) {
+    if (key->IsSymbol()) {
+        out_->push_back('[');
+        AppendSymbol(isolate_, key.As<v8::Symbol>(), out_);
+        out_->push_back(']');
+        return true;
+    }
+    v8::Local<v8::String> string;
+    if (!key->ToString(context_).ToLocal(&string)) {
+        return false;
+    }
+    size_t start = out_->size();
+    AppendUtf8(isolate_, string, out_);
+    if (!IsIdentifier(out_->data() + start, out_->size() - start)) {
+        out_->resize(start);
+        AppendQuoted(isolate_, string, out_);
+    }
+    return true;
+}
+
+// Get the own enumerable keys of an object, symbols included
+bool Inspector::OwnKeys(v8::Local<v8::Object> object, v8::IndexFilter filter, v8::Local<v8::Array>* keys) {
+    return object->GetPropertyNames(context_, v8::KeyCollectionMode::kOwnOnly, v8::ONLY_ENUMERABLE,
+                                    filter, v8::KeyConversionMode::kConvertToString).ToLocal(keys);
+}
+
+// Write "key: value" entries for keys
+bool Inspector::WriteProperties(v8::Local<v8::Object> object, v8::Local<v8::Array> keys, int level) {
+    uint32_t count = keys->Length();
+    for (uint32_t i = 0; i < count; i++) {
+        v8::Local<v8::Value> key;
+        v8::Local<v8::Value> value;
+        if (!keys->Get(context_, i).ToLocal(&key) || !object->Get(context_, key).ToLocal(&value)) {
+            return false;
+        }
+        BeginEntry();
+        if (!WriteKey(key)) {
+            return false;
+        }
+        out_->append(": ");
+        if (!Write(value, level + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Write the elements of an array-like object, with holes shown as <n empty items>
+bool Inspector::WriteArrayElements(v8::Local<v8::Object> object, uint32_t length, int level, bool* numeric) {
+    bool is_array = object->IsArray();
+    size_t shown = 0;
+    uint32_t i = 0;
+    while (i < length && shown < options_.max_array_length) {
+        if (is_array && !object->HasRealIndexedProperty(context_, i).FromMaybe(false)) {
+            uint32_t holes = 0;
+            while (i < length && !object->HasRealIndexedProperty(context_, i).FromMaybe(false)) {
+                holes++;
+                i++;
+            }
+            BeginEntry();
+            out_->push_back('<');
+            AppendNumber(isolate_, context_, holes, out_);
+            out_->append(holes == 1 ? " empty item>" : " empty items>");
+            *numeric = false;
+            shown++;
+            continue;
+        }
+        v8::Local<v8::Value> value;
+        if (!object->Get(context_, i).ToLocal(&value)) {
+            return false;
+        }
+        if (!value->IsNumber() && !value->IsBigInt()) {
+            *numeric = false;
+        }
+        BeginEntry();
+        if (!Write(value, level + 1)) {
+            return false;
+        }
+        shown++;
+        i++;
+    }
+    if (i < length) {
+        BeginEntry();
+        out_->append("... ");
+        AppendNumber(isolate_, context_, length - i, out_);
+        out_->append(length - i == 1 ? " more item" : " more items");
+    }
+    return true;
+}
+
+// Write bytes as hex pairs, up to kMaxInspectBytes
+void Inspector::WriteBytes(const uint8_t* data, size_t length) {
+    static const char kHex[] = "0123456789abcdef";
+    size_t shown = std::min(length, kMaxInspectBytes);
+    for (size_t i = 0; i < shown; i++) {
+        if (i > 0) {
+            out_->push_back(' ');
+        }
+        out_->push_back(kHex[data[i] >> 4]);
+        out_->push_back(kHex[data[i] & 0xF]);
+    }
+    if (length > shown) {
+        out_->append(" ... ");
+        AppendNumber(isolate_, context_, static_cast<double>(length - shown), out_);
+        out_->append(length - shown == 1 ? " more byte" : " more bytes");
+    }
+}
+
+// Write an object: its base text, or its entries between braces
+bool Inspector::WriteObject(v8::Local<v8::Object> object, int level) {
+    size_t start = out_->size();
+    bool too_deep = options_.depth >= 0 && level > options_.depth;
+    
+    // Functions, errors, dates, regexps and boxed primitives show extra keys after their base
+    bool has_base;
+    if (!WriteBase(object, level, &has_base)) {
+        return false;
+    }
+    if (has_base) {
+        v8::Local<v8::Array> keys;
+        v8::IndexFilter filter = object->IsStringObject() ? v8::IndexFilter::kSkipIndices
+                                                          : v8::IndexFilter::kIncludeIndices;
+        if (!OwnKeys(object, filter, &keys)) {
+            return false;
+        }
+        if (keys->Length() == 0) {
+            return true;
+        }
+        if (too_deep) {
+            out_->resize(start);
+            out_->push_back('[');
+            AppendUtf8(isolate_, object->GetConstructorName(), out_);
+            out_->push_back(']');
+            return true;
+        }
+        out_->append(" {");
+        Open(object, start, level);
+        if (!WriteProperties(object, keys, level)) {
+            return false;
+        }
+        Close(level, "}", false, false);
+        return true;
+    }
+    
+    v8::String::Utf8Value constructor_value(isolate_, object->GetConstructorName());
+    std::string constructor(*constructor_value, constructor_value.length());
+    
+    // Buffers and ArrayBuffers print their bytes
+    if (object->IsUint8Array() && (constructor == "Buffer" || constructor == "FastBuffer")) {
+        v8::Local<v8::Uint8Array> view = object.As<v8::Uint8Array>();
+        out_->append("<Buffer");
+        if (view->ByteLength() > 0) {
+            out_->push_back(' ');
+            const uint8_t* data = static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+            WriteBytes(data, view->ByteLength());
+        }
+        out_->push_back('>');
+        return true;
+    }
+    
+    // Work out the opening text and how many entries the object has
+    const char* closing = "}";
+    bool array_like = false;
+    uint32_t length = 0;
+    v8::Local<v8::Array> keys;
+    if (!OwnKeys(object, object->IsArray() || object->IsTypedArray() ? v8::IndexFilter::kSkipIndices
+                                                                     : v8::IndexFilter::kIncludeIndices, &keys)) {
+        return false;
+    }
+    bool empty = keys->Length() == 0;
+    
+    if (object->IsArray() || object->IsTypedArray()) {
+        array_like = true;
+        closing = "]";
+        if (object->IsArray()) {
+            length = object.As<v8::Array>()->Length();
+        } else {
+            length = static_cast<uint32_t>(object.As<v8::TypedArray>()->Length());
+        }
+        empty = empty && length == 0;
+        if (constructor != "Array" || object->IsTypedArray()) {
+            out_->append(constructor);
+            out_->push_back('(');
+            AppendNumber(isolate_, context_, length, out_);
+            out_->append(") ");
+        }
+        out_->push_back('[');
+    } else if (object->IsMap() || object->IsSet()) {
+        size_t size = object->IsMap() ? object.As<v8::Map>()->Size() : object.As<v8::Set>()->Size();
+        empty = empty && size == 0;
+        out_->append(constructor);
+        out_->push_back('(');
+        AppendNumber(isolate_, context_, static_cast<double>(size), out_);
+        out_->append(") {");
+    } else if (object->IsArrayBuffer() || object->IsSharedArrayBuffer()) {
+        empty = false;
+        out_->append(object->IsArrayBuffer() ? "ArrayBuffer {" : "SharedArrayBuffer {");
+    } else if (object->IsPromise() || object->IsWeakMap() || object->IsWeakSet()) {
+        empty = false;
+        out_->append(constructor);
+        out_->append(" {");
+    } else if (object->IsArgumentsObject()) {
+        constructor = "Arguments";
+        out_->append("[Arguments] {");
+    } else if (constructor == "Object" && object->GetPrototype()->IsNull()) {
+        constructor = "Object: null prototype";
+        out_->append("[Object: null prototype] {");
+    } else {
+        if (constructor != "Object") {
+            out_->append(constructor);
+            out_->push_back(' ');
+        }
+        out_->push_back('{');
+    }
+    
+    if (empty) {
+        out_->append(closing);
+        return true;
+    }
+    if (too_deep) {
+        out_->resize(start);
+        out_->push_back('[');
+        out_->append(constructor);
+        out_->push_back(']');
+        return true;
+    }
+    
+    Open(object, start, level);
+    bool numeric = true;
+    if (array_like) {
+        if (!WriteArrayElements(object, length, level, &numeric)) {
+            return false;
+        }
+    } else if (object->IsMap() || object->IsSet()) {
+        // Map entries come as key, value pairs
+        bool is_map = object->IsMap();
+        v8::Local<v8::Array> items = is_map ? object.As<v8::Map>()->AsArray() : object.As<v8::Set>()->AsArray();
+        uint32_t stride = is_map ? 2 : 1;
+        uint32_t count = items->Length() / stride;
+        uint32_t shown = static_cast<uint32_t>(std::min<size_t>(count, options_.max_array_length));
+        for (uint32_t i = 0; i < shown; i++) {
+            v8::Local<v8::Value> item;
+            if (!items->Get(context_, i * stride).ToLocal(&item)) {
+                return false;
+            }
+            BeginEntry();
+            if (!Write(item, level + 1)) {
+                return false;
+            }
+            if (is_map) {
+                if (!items->Get(context_, i * stride + 1).ToLocal(&item)) {
+                    return false;
+                }
+                out_->append(" => ");
+                if (!Write(item, level + 1)) {
+                    return false;
+                }
+            }
+        }
+        if (count > shown) {
+            BeginEntry();
+            out_->append("... ");
+            AppendNumber(isolate_, context_, count - shown, out_);
+            out_->append(count - shown == 1 ? " more item" : " more items");
+        }
+    } else if (object->IsArrayBuffer() || object->IsSharedArrayBuffer()) {
+        std::shared_ptr<v8::BackingStore> store = object->IsArrayBuffer()
+            ? object.As<v8::ArrayBuffer>()->GetBackingStore()
+            : object.As<v8::SharedArrayBuffer>()->GetBackingStore();
+        BeginEntry();
+        out_->append("[Uint8Contents]: <");
+        WriteBytes(static_cast<const uint8_t*>(store->Data()), store->ByteLength());
+        out_->push_back('>');
+        BeginEntry();
+        out_->append("byteLength: ");
+        AppendNumber(isolate_, context_, static_cast<double>(store->ByteLength()), out_);
+    } else if (object->IsPromise()) {
+        v8::Local<v8::Promise> promise = object.As<v8::Promise>();
+        BeginEntry();
+        if (promise->State() == v8::Promise::kPending) {
+            out_->append("<pending>");
+        } else {
+            if (promise->State() == v8::Promise::kRejected) {
+                out_->append("<rejected> ");
+            }
+            if (!Write(promise->Result(), level + 1)) {
+                return false;
+            }
+        }
+    } else if (object->IsWeakMap() || object->IsWeakSet()) {
+        BeginEntry();
+        out_->append("<items unknown>");
+    }
+    
+    if (!WriteProperties(object, keys, level)) {
+        return false;
+    }
+    Close(level, closing, array_like, numeric);
+    return true;
+}
+
+// Start collecting the entries of an object whose opening text begins at start
+void Inspector::Open(v8::Local<v8::Object> object, size_t start, int level) {
+    frames_.push_back({object, start, entries_.size(), 0});
+    current_depth_ = level;
+}
+
+// Lay out the entries of the innermost open object and close it
+void Inspector::Close(int level, const char* closing, bool group, bool numeric) {
+    Frame frame = frames_.back();
+    frames_.pop_back();
+    
+    // Mark an object that something inside it refers back to
+    if (frame.ref != 0) {
+        std::string reference = "<ref *";
+        AppendNumber(isolate_, context_, frame.ref, &reference);
+        reference.append("> ");
+        out_->insert(frame.start, reference);
+        for (size_t i = frame.first_entry; i < entries_.size(); i++) {
+            entries_[i] += reference.size();
+        }
+    }
+    
+    // Move the entries out and write them back with separators
+    size_t count = entries_.size() - frame.first_entry;
+    size_t body = entries_[frame.first_entry];
+    scratch_.assign(*out_, body, std::string::npos);
+    spans_.clear();
+    for (size_t i = 0; i < count; i++) {
+        size_t begin = entries_[frame.first_entry + i] - body;
+        size_t end = i + 1 < count ? entries_[frame.first_entry + i + 1] - body : scratch_.size();
+        spans_.push_back({begin, end - begin, DisplayLength(scratch_.data() + begin, end - begin)});
+    }
+    entries_.resize(frame.first_entry);
+    out_->resize(body);
+    
+    const std::string* source = &scratch_;
+    std::vector<Span>* output = &spans_;
+    if (group && count > 6 && GroupEntries(level, numeric) != count) {
+        source = &grouped_;
+        output = &rows_;
+    }
+    
+    // Keep everything on one line if it is short and nested no more than kCompact levels deep
+    const char* opening = out_->data() + frame.start;
+    size_t opening_length = body - frame.start;
+    if (current_depth_ - level < kCompact && output->size() == count &&
+        std::memchr(opening, '\n', opening_length) == nullptr) {
+        size_t total = output->size() + level * 2 + DisplayLength(opening, opening_length) + 10;
+        total += output->size();
+        bool fits = total + output->size() <= options_.break_length;
+        for (size_t i = 0; fits && i < output->size(); i++) {
+            total += (*output)[i].width;
+            fits = total <= options_.break_length;
+        }
+        if (fits && source->find('\n') == std::string::npos) {
+            out_->push_back(' ');
+            for (size_t i = 0; i < output->size(); i++) {
+                if (i > 0) {
+                    out_->append(", ");
+                }
+                out_->append(*source, (*output)[i].offset, (*output)[i].length);
+            }
+            out_->push_back(' ');
+            out_->append(closing);
+            return;
+        }
+    }
+    
+    // Otherwise put each entry on a line of its own
+    for (size_t i = 0; i < output->size(); i++) {
+        out_->append(i > 0 ? ",\n" : "\n");
+        out_->append(level * 2 + 2, ' ');
+        out_->append(*source, (*output)[i].offset, (*output)[i].length);
+    }
+    out_->push_back('\n');
+    out_->append(level * 2, ' ');
+    out_->append(closing);
+}
+
+// Group many short array entries into aligned columns, as Node.js does; returns the number of rows
+size_t Inspector::GroupEntries(int level, bool numeric) {
+    // Past max_array_length the last entry is "... n more items", which stays on its own
+    const size_t separator_space = 2;
+    bool has_more = spans_.size() > options_.max_array_length;
+    size_t output_length = spans_.size() - (has_more ? 1 : 0);
+    size_t total_length = 0;
+    size_t max_length = 0;
+    for (size_t i = 0; i < output_length; i++) {
+        total_length += spans_[i].width + separator_space;
+        max_length = std::max(max_length, spans_[i].width);
+    }
+    size_t actual_max = max_length + separator_space;
+    size_t indentation = level * 2;
+    if (actual_max * 3 + indentation >= options_.break_length ||
+        !(static_cast<double>(total_length) / actual_max > 5 || max_length <= 6)) {
+        return spans_.size();
+    }
+    
+    // Aim for a roughly square block, with more columns for short entries
+    const double approx_char_heights = 2.5;
+    double average_bias = std::sqrt(actual_max - static_cast<double>(total_length) / spans_.size());
+    double biased_max = std::max(actual_max - 3 - average_bias, 1.0);
+    size_t columns = static_cast<size_t>(
+        std::floor(std::sqrt(approx_char_heights * biased_max * output_length) / biased_max + 0.5));
+    columns = std::min({columns, (options_.break_length - indentation) / actual_max,
+                        static_cast<size_t>(kCompact * 4), static_cast<size_t>(15)});
+    if (columns <= 1) {
+        return spans_.size();
+    }
+    
+    std::vector<size_t> max_line_length(columns);
+    for (size_t i = 0; i < columns; i++) {
+        size_t line_length = 0;
+        for (size_t j = i; j < output_length; j += columns) {
+            line_length = std::max(line_length, spans_[j].width);
+        }
+        max_line_length[i] = line_length + separator_space;
+    }
+    
+    // Numbers are right-aligned, everything else left-aligned
+    grouped_.clear();
+    rows_.clear();
+    for (size_t i = 0; i < output_length; i += columns) {
+        size_t row_start = grouped_.size();
+        size_t max = std::min(i + columns, output_length);
+        for (size_t j = i; j < max; j++) {
+            const Span& span = spans_[j];
+            bool last = j == max - 1;
+            size_t width = span.width + (last ? 0 : separator_space);
+            size_t target = max_line_length[j - i] - (last ? separator_space : 0);
+            size_t padding = target > width ? target - width : 0;
+            if (numeric) {
+                grouped_.append(padding, ' ');
+            }
+            grouped_.append(scratch_, span.offset, span.length);
+            if (!last) {
+                grouped_.append(", ");
+                if (!numeric) {
+                    grouped_.append(padding, ' ');
+                }
+            }
+        }
+        size_t row_length = grouped_.size() - row_start;
+        rows_.push_back({row_start, row_length, DisplayLength(grouped_.data() + row_start, row_length)});
+    }
+    if (has_more) {
+        const Span& more = spans_[output_length];
+        rows_.push_back({grouped_.size(), more.length, more.width});
+        grouped_.append(scratch_, more.offset, more.length);
+    }
+    return rows_.size();
+}
+
+// Append the util.inspect() rendering of a value to a string
+bool InspectValue(v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                  const InspectOptions& options, std::string* out) {
+    Inspector inspector(context, options, out);
+    return inspector.Write(value, 0);
+}
+
+// Check whether %s should inspect an object rather than call its toString()
+static bool HasBuiltInToString(v8::Local<v8::Context> context, v8::Local<v8::Object> object) {
+    v8::Isolate* isolate = context->GetIsolate();
+    if (object->IsProxy()) {
+        return true;
+    }
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    v8::Local<v8::String> to_string_key = keys.to_string_string();
+    v8::Local<v8::Value> to_string;
+    if (!object->Get(context, to_string_key).ToLocal(&to_string) || !to_string->IsFunction()) {
+        return true;
+    }
+    
+    // Find the object in the prototype chain that defines toString, and its constructor
+    v8::Local<v8::Value> holder = object;
+    while (holder->IsObject()) {
+        v8::Local<v8::Object> current = holder.As<v8::Object>();
+        if (current->HasOwnProperty(context, to_string_key).FromMaybe(false)) {
+            if (current == object) {
+                return false;
+            }
+            v8::Local<v8::Value> constructor;
+            if (!current->GetRealNamedProperty(context, keys.constructor_string()).ToLocal(&constructor) ||
+                !constructor->IsFunction()) {
+                return false;
+            }
+            v8::String::Utf8Value name(isolate, constructor.As<v8::Function>()->GetName());
+            for (const char* built_in : kBuiltInConstructors) {
+                if (std::strcmp(*name, built_in) == 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        holder = current->GetPrototype();
+    }
+    return true;
+}
+
+// Parse the start of a string like parseInt() or parseFloat()
+static double ParseLeadingNumber(const std::string& text, bool integer) {
+    size_t i = 0;
+    while (i < text.size() && std::strchr(" \t\n\v\f\r", text[i]) != nullptr) {
+        i++;
+    }
+    bool negative = false;
+    if (i < text.size() && (text[i] == '+' || text[i] == '-')) {
+        negative = text[i] == '-';
+        i++;
+    }
+    
+    double result;
+    if (integer) {
+        int radix = 10;
+        if (i + 1 < text.size() && text[i] == '0' && (text[i + 1] == 'x' || text[i + 1] == 'X')) {
+            radix = 16;
+            i += 2;
+        }
+        size_t digits = 0;
+        result = 0;
+        for (; i < text.size(); i++, digits++) {
+            char c = text[i];
+            int digit = c >= '0' && c <= '9' ? c - '0'
+                      : c >= 'a' && c <= 'z' ? c - 'a' + 10
+                      : c >= 'A' && c <= 'Z' ? c - 'A' + 10 : 99;
+            if (digit >= radix) {
+                break;
+            }
+            result = result * radix + digit;
+        }
+        if (digits == 0) {
+            return std::nan("");
+        }
+    } else if (text.compare(i, 8, "Infinity") == 0) {
+        result = INFINITY;
+    } else {
+        // Only a decimal literal is accepted, so strtod's hex and inf forms never apply
+        size_t end = i;
+        while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+            end++;
+        }
+        if (end < text.size() && text[end] == '.') {
+            end++;
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                end++;
+            }
+        }
+        if (end == i || (end == i + 1 && text[i] == '.')) {
+            return std::nan("");
+        }
+        if (end < text.size() && (text[end] == 'e' || text[end] == 'E')) {
+            size_t exponent = end + 1;
+            if (exponent < text.size() && (text[exponent] == '+' || text[exponent] == '-')) {
+                exponent++;
+            }
+            if (exponent < text.size() && text[exponent] >= '0' && text[exponent] <= '9') {
+                end = exponent;
+                while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                    end++;
+                }
+            }
+        }
+        result = std::strtod(text.substr(i, end - i).c_str(), nullptr);
+    }
+    return negative ? -result : result;
+}
+
+// Append one argument for a format specifier
+static bool AppendFormatted(v8::Local<v8::Context> context, char specifier, v8::Local<v8::Value> arg,
+                            std::string* out) {
+    v8::Isolate* isolate = context->GetIsolate();
+    switch (specifier) {
+        case 's':
+            if (arg->IsString()) {
+                AppendUtf8(isolate, arg.As<v8::String>(), out);
+                return true;
+            }
+            if (arg->IsNumber() || arg->IsBigInt() || arg->IsSymbol()) {
+                InspectOptions options;
+                return InspectValue(context, arg, options, out);
+            }
+            if (arg->IsObject() && !arg->IsFunction() && HasBuiltInToString(context, arg.As<v8::Object>())) {
+                InspectOptions options;
+                options.depth = 0;
+                return InspectValue(context, arg, options, out);
+            }
+            return AppendString(context, arg, out);
+        case 'd':
+        case 'i':
+        case 'f': {
+            if (arg->IsBigInt()) {
+                if (specifier == 'f') {
+                    break;
+                }
+                if (!AppendString(context, arg, out)) {
+                    return false;
+                }
+                out->push_back('n');
+                return true;
+            }
+            double number = std::nan("");
+            if (arg->IsSymbol()) {
+                // Symbols cannot be converted and print as NaN
+            } else if (specifier == 'd') {
+                if (!arg->NumberValue(context).To(&number)) {
+                    return false;
+                }
+            } else {
+                v8::Local<v8::String> string;
+                if (!arg->ToString(context).ToLocal(&string)) {
+                    return false;
+                }
+                v8::String::Utf8Value text(isolate, string);
+                number = ParseLeadingNumber(std::string(*text, text.length()), specifier == 'i');
+            }
+            AppendNumber(isolate, context, number, out);
+            return true;
+        }
+        case 'j': {
+            v8::TryCatch try_catch(isolate);
+            v8::Local<v8::String> json;
+            if (!v8::JSON::Stringify(context, arg).ToLocal(&json)) {
+                v8::String::Utf8Value message(isolate, try_catch.Exception());
+                if (*message && std::strstr(*message, "circular") != nullptr) {
+                    out->append("[Circular]");
+                    return true;
+                }
+                try_catch.ReThrow();
+                return false;
+            }
+            AppendUtf8(isolate, json, out);
+            return true;
+        }
+        case 'o': {
+            InspectOptions options;
+            options.depth = 4;
+            return InspectValue(context, arg, options, out);
+        }
+        case 'O': {
+            InspectOptions options;
+            return InspectValue(context, arg, options, out);
+        }
+    }
+    
+    // parseFloat of a BigInt
+    v8::Local<v8::String> string;
+    if (!arg->ToString(context).ToLocal(&string)) {
+        return false;
+    }
+    v8::String::Utf8Value text(isolate, string);
+    AppendNumber(isolate, context, ParseLeadingNumber(std::string(*text, text.length()), false), out);
+    return true;
+}
+
+// Append the util.format() rendering of call arguments to a string
+bool FormatValues(v8::Local<v8::Context> context, const v8::FunctionCallbackInfo<v8::Value>& args,
+                  std::string* out) {
+    v8::Isolate* isolate = context->GetIsolate();
+    int argc = args.Length();
+    int next = 0;
+    
+    if (argc > 0 && args[0]->IsString()) {
+        next = 1;
+        size_t start = out->size();
+        AppendUtf8(isolate, args[0].As<v8::String>(), out);
+        if (argc > 1) {
+            // Expand the specifiers in place, copying the format string out first
+            std::string format = out->substr(start);
+            out->resize(start);
+            size_t last = 0;
+            for (size_t i = 0; i + 1 < format.size(); i++) {
+                if (format[i] != '%') {
+                    continue;
+                }
+                char specifier = format[i + 1];
+                if (specifier == '%') {
+                    out->append(format, last, i + 1 - last);
+                    last = i + 2;
+                    i++;
+                    continue;
+                }
+                if (next >= argc || std::strchr("sdifjoOc", specifier) == nullptr) {
+                    continue;
+                }
+                out->append(format, last, i - last);
+                if (specifier != 'c' && !AppendFormatted(context, specifier, args[next], out)) {
+                    return false;
+                }
+                next++;
+                last = i + 2;
+                i++;
+            }
+            out->append(format, last, std::string::npos);
+        }
+    }
+    
+    // Arguments without a specifier follow, separated by spaces
+    InspectOptions options;
+    for (int i = next; i < argc; i++) {
+        if (i > 0) {
+            out->push_back(' ');
+        }
+        if (args[i]->IsString()) {
+            AppendUtf8(isolate, args[i].As<v8::String>(), out);
+        } else if (!InspectValue(context, args[i], options, out)) {
+            return false;
+        }
+    }
+    return true;
+}
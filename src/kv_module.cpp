@@ -0,0 +1,1344 @@
+#include "kv_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "property_keys.h"
+#include "thread_pool.h"
+#include "hash.h"
+#include "async.h"
+#include <iostream>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <climits>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// On-disk format constants; integers are stored in host byte order
+static constexpr uint32_t kSegmentMagic = 0x4c564b54;   // "TKVL"
+static constexpr uint32_t kSnapshotMagic = 0x53564b54;  // "TKVS"
+static constexpr uint32_t kFormatVersion = 1;
+static constexpr uint32_t kTombstone = UINT32_MAX;
+static constexpr size_t kDefaultSegmentSize = 64 * 1024 * 1024;
+
+// Header at the start of every segment file
+//
+// base_id is the first segment a compacted segment replaced. Segments with
+// ids in [base_id, id) left behind by a crash after compaction are deleted
+// on open.
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t base_id;
+};
+
+// Header of a log record, followed by the key and value bytes
+struct RecordHeader {
+    uint32_t crc;
+    uint32_t key_length;
+    uint32_t value_length;  // kTombstone for a delete
+};
+
+// Header of the snapshot file, followed by count entries
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t count;
+    uint64_t segment;  // Log position the snapshot covers
+    uint64_t offset;
+    uint32_t crc;      // Over all entries
+    uint32_t reserved;
+};
+
+// Snapshot entry, followed by the key bytes
+struct SnapshotEntry {
+    uint32_t key_length;
+    uint32_t length;
+    uint64_t segment;
+    uint64_t offset;
+};
+
+// Checksum of a record's lengths, key and value
+static uint32_t RecordCrc(uint32_t key_length, uint32_t value_length,
+                          const void* key, const void* value) {
+    uint32_t crc = Crc32c(0, &key_length, sizeof(key_length));
+    crc = Crc32c(crc, &value_length, sizeof(value_length));
+    crc = Crc32c(crc, key, key_length);
+    if (value_length != kTombstone) {
+        crc = Crc32c(crc, value, value_length);
+    }
+    return crc;
+}
+
+// Size of a record on disk
+static size_t RecordSize(size_t key_length, uint32_t value_length) {
+    return sizeof(RecordHeader) + key_length + (value_length == kTombstone ? 0 : value_length);
+}
+
+// Format an error message with errno
+static std::string SystemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// Write every iovec, splitting at IOV_MAX and resuming after partial writes
+static bool WriteAll(int fd, std::vector<iovec>& iov) {
+    size_t index = 0;
+    while (index < iov.size()) {
+        int count = static_cast<int>(std::min<size_t>(iov.size() - index, IOV_MAX));
+        ssize_t written = ::writev(fd, &iov[index], count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        
+        size_t remaining = static_cast<size_t>(written);
+        while (index < iov.size() && remaining >= iov[index].iov_len) {
+            remaining -= iov[index].iov_len;
+            index++;
+        }
+        if (remaining > 0) {
+            iov[index].iov_base = static_cast<uint8_t*>(iov[index].iov_base) + remaining;
+            iov[index].iov_len -= remaining;
+        }
+    }
+    return true;
+}
+
+// An open log segment
+//
+// Segments are mapped for their whole capacity, so reads copy values
+// straight out of the page cache. A segment stays mapped until the store
+// and every reader holding it let go.
+struct LogSegment {
+    uint64_t id = 0;
+    int fd = -1;
+    uint8_t* map = nullptr;
+    size_t capacity = 0;
+    size_t size = 0;        // Bytes written, guarded by the store mutex
+    size_t live_bytes = 0;  // Bytes of records the index points at
+    
+    ~LogSegment() {
+        if (map) {
+            munmap(map, capacity);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+// Where a value lives in the log
+struct KvLocation {
+    uint64_t segment;
+    uint64_t offset;  // Offset of the value bytes
+    uint32_t length;
+};
+
+// A single write in a batch
+struct KvOperation {
+    std::string key;
+    std::string owned_value;
+    const uint8_t* value = nullptr;
+    size_t length = 0;
+    bool remove = false;
+    bool owned = false;
+};
+
+// Durability policy for writes
+enum class KvSyncMode {
+    kNone,
+    kGroup,
+    kAlways,
+};
+
+// Options for opening a store
+struct KvOptions {
+    std::string directory;
+    KvSyncMode sync = KvSyncMode::kNone;
+    uint64_t group_commit_ms = 5;
+    size_t segment_size = kDefaultSegmentSize;
+    double compact_threshold = 0.5;
+};
+
+// Store statistics
+struct KvStats {
+    uint64_t keys = 0;
+    uint64_t segments = 0;
+    uint64_t bytes = 0;
+    uint64_t live_bytes = 0;
+    uint64_t compactions = 0;
+};
+
+// Append-only log with an in-memory hash index
+class KvStore : public std::enable_shared_from_this<KvStore> {
+public:
+    explicit KvStore(const KvOptions& options)
+        : options_(options), closed_(false), compacting_(false), dirty_(false),
+          stopping_(false), compactions_(0) {}
+    
+    ~KvStore() {
+        std::string error;
+        Close(&error);
+    }
+    
+    // Open the store, recovering its index from the snapshot and the log
+    bool Open(std::string* error) {
+        if (mkdir(options_.directory.c_str(), 0755) != 0 && errno != EEXIST) {
+            *error = SystemError("Failed to create " + options_.directory);
+            return false;
+        }
+        
+        std::vector<uint64_t> ids;
+        if (!ListSegments(&ids, error)) {
+            return false;
+        }
+        
+        std::map<uint64_t, uint64_t> base_ids;
+        for (uint64_t id : ids) {
+            std::shared_ptr<LogSegment> segment;
+            uint64_t base_id;
+            if (!OpenSegment(id, &segment, &base_id, error)) {
+                return false;
+            }
+            segments_[id] = segment;
+            base_ids[id] = base_id;
+        }
+        
+        // Finish compactions that committed but did not delete their inputs
+        for (const auto& [id, base_id] : base_ids) {
+            for (auto it = segments_.lower_bound(base_id); it != segments_.end() && it->first < id;) {
+                std::remove(SegmentPath(it->first).c_str());
+                it = segments_.erase(it);
+            }
+        }
+        
+        // Map every segment; the newest keeps room to grow
+        for (auto it = segments_.begin(); it != segments_.end(); ++it) {
+            bool active = std::next(it) == segments_.end();
+            size_t capacity = active ? std::max(it->second->size, options_.segment_size) : it->second->size;
+            if (!MapSegment(it->second.get(), capacity, error)) {
+                return false;
+            }
+        }
+        
+        uint64_t replay_segment = 0;
+        uint64_t replay_offset = 0;
+        if (!LoadSnapshot(&replay_segment, &replay_offset)) {
+            index_.clear();
+            for (auto& entry : segments_) {
+                entry.second->live_bytes = 0;
+            }
+            replay_segment = 0;
+            replay_offset = 0;
+        }
+        
+        for (auto it = segments_.lower_bound(replay_segment); it != segments_.end(); ++it) {
+            bool last = std::next(it) == segments_.end();
+            size_t start = it->first == replay_segment ? replay_offset : sizeof(SegmentHeader);
+            if (!Replay(it->second.get(), std::max(start, sizeof(SegmentHeader)), last, error)) {
+                return false;
+            }
+        }
+        
+        if (segments_.empty()) {
+            std::shared_ptr<LogSegment> segment;
+            if (!CreateSegment(1, 1, options_.segment_size, &segment, error)) {
+                return false;
+            }
+            segments_[1] = segment;
+        }
+        active_ = segments_.rbegin()->second;
+        
+        if (options_.sync == KvSyncMode::kGroup) {
+            group_commit_thread_ = std::thread(&KvStore::GroupCommitMain, this);
+        }
+        return true;
+    }
+    
+    // Append a batch of operations with a single writev
+    bool Write(std::vector<KvOperation>& operations, std::string* error) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (closed_) {
+            *error = "Store is closed";
+            return false;
+        }
+        
+        std::vector<RecordHeader> headers(operations.size());
+        std::vector<iovec> iov;
+        iov.reserve(operations.size() * 3);
+        size_t total = 0;
+        
+        for (size_t i = 0; i < operations.size(); i++) {
+            KvOperation& operation = operations[i];
+            if (operation.owned) {
+                operation.value = reinterpret_cast<const uint8_t*>(operation.owned_value.data());
+                operation.length = operation.owned_value.size();
+            }
+            if (operation.key.size() >= kTombstone || operation.length >= kTombstone) {
+                *error = "Key or value too large";
+                return false;
+            }
+            
+            RecordHeader& header = headers[i];
+            header.key_length = static_cast<uint32_t>(operation.key.size());
+            header.value_length = operation.remove ? kTombstone : static_cast<uint32_t>(operation.length);
+            header.crc = RecordCrc(header.key_length, header.value_length, operation.key.data(), operation.value);
+            
+            iov.push_back({&header, sizeof(header)});
+            iov.push_back({const_cast<char*>(operation.key.data()), operation.key.size()});
+            if (!operation.remove && operation.length > 0) {
+                iov.push_back({const_cast<uint8_t*>(operation.value), operation.length});
+            }
+            total += RecordSize(operation.key.size(), header.value_length);
+        }
+        
+        if (active_->size + total > active_->capacity) {
+            if (!Roll(total, error)) {
+                return false;
+            }
+        }
+        
+        if (!WriteAll(active_->fd, iov)) {
+            *error = SystemError("Failed to append to the log");
+            // Drop a partial batch so the next write starts on a record boundary
+            if (ftruncate(active_->fd, active_->size) != 0) {
+                std::cerr << "kv: failed to truncate a partial write" << std::endl;
+            }
+            return false;
+        }
+        
+        size_t offset = active_->size;
+        for (size_t i = 0; i < operations.size(); i++) {
+            Apply(operations[i].key, active_.get(), offset, headers[i].value_length);
+            offset += RecordSize(operations[i].key.size(), headers[i].value_length);
+        }
+        active_->size = offset;
+        
+        if (options_.sync == KvSyncMode::kAlways) {
+            if (fdatasync(active_->fd) != 0) {
+                *error = SystemError("Failed to sync the log");
+                return false;
+            }
+        } else if (options_.sync == KvSyncMode::kGroup) {
+            dirty_ = true;
+        }
+        return true;
+    }
+    
+    // Look up a value, returning the segment that holds it
+    std::shared_ptr<LogSegment> Get(std::string_view key, KvLocation* location) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(std::string(key));
+        if (it == index_.end()) {
+            return nullptr;
+        }
+        *location = it->second;
+        return segments_[location->segment];
+    }
+    
+    // Check if a key exists
+    bool Has(std::string_view key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return index_.count(std::string(key)) > 0;
+    }
+    
+    // Get every key
+    std::vector<std::string> Keys() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> keys;
+        keys.reserve(index_.size());
+        for (const auto& entry : index_) {
+            keys.push_back(entry.first);
+        }
+        return keys;
+    }
+    
+    // Make every write so far durable
+    bool Flush(std::string* error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            return true;
+        }
+        if (fdatasync(active_->fd) != 0) {
+            *error = SystemError("Failed to sync the log");
+            return false;
+        }
+        dirty_ = false;
+        return true;
+    }
+    
+    // Write a snapshot of the index and the log position it covers
+    bool Checkpoint(std::string* error) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) {
+            *error = "Store is closed";
+            return false;
+        }
+        return WriteSnapshot(error);
+    }
+    
+    // Rewrite all sealed segments into one, dropping dead records
+    bool Compact(uint64_t* reclaimed, std::string* error) {
+        *reclaimed = 0;
+        std::vector<std::shared_ptr<LogSegment>> inputs;
+        std::vector<std::pair<std::string, KvLocation>> live;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_ || compacting_) {
+                return true;
+            }
+            for (const auto& entry : segments_) {
+                if (entry.second != active_) {
+                    inputs.push_back(entry.second);
+                }
+            }
+            if (inputs.empty()) {
+                return true;
+            }
+            
+            uint64_t last = inputs.back()->id;
+            for (const auto& entry : index_) {
+                if (entry.second.segment <= last) {
+                    live.emplace_back(entry.first, entry.second);
+                }
+            }
+            compacting_ = true;
+        }
+        
+        uint64_t first = inputs.front()->id;
+        uint64_t last = inputs.back()->id;
+        
+        // Copy live records in log order; sealed segments are immutable
+        std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) {
+            return a.second.segment != b.second.segment ? a.second.segment < b.second.segment
+                                                        : a.second.offset < b.second.offset;
+        });
+        
+        std::string temp_path = options_.directory + "/segment-" + std::to_string(last) + ".compact";
+        bool success = false;
+        std::vector<uint64_t> new_offsets(live.size());
+        int fd = open(temp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (fd < 0) {
+            *error = SystemError("Failed to create " + temp_path);
+        } else {
+            SegmentHeader header = {kSegmentMagic, kFormatVersion, first};
+            std::vector<iovec> iov;
+            iov.push_back({&header, sizeof(header)});
+            
+            std::map<uint64_t, LogSegment*> by_id;
+            for (const auto& segment : inputs) {
+                by_id[segment->id] = segment.get();
+            }
+            
+            uint64_t offset = sizeof(header);
+            for (size_t i = 0; i < live.size() && error->empty(); i++) {
+                const KvLocation& location = live[i].second;
+                LogSegment* input = by_id[location.segment];
+                size_t record_size = RecordSize(live[i].first.size(), location.length);
+                size_t record_start = location.offset - sizeof(RecordHeader) - live[i].first.size();
+                iov.push_back({input->map + record_start, record_size});
+                new_offsets[i] = offset + sizeof(RecordHeader) + live[i].first.size();
+                offset += record_size;
+            }
+            
+            if (!error->empty()) {
+                // Already reported
+            } else if (!WriteAll(fd, iov) || fdatasync(fd) != 0) {
+                *error = SystemError("Failed to write " + temp_path);
+            } else {
+                success = true;
+            }
+            close(fd);
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        compacting_ = false;
+        if (!success || closed_) {
+            std::remove(temp_path.c_str());
+            return success;
+        }
+        
+        // The stale snapshot points into the inputs, so it goes first
+        std::remove(SnapshotPath().c_str());
+        if (std::rename(temp_path.c_str(), SegmentPath(last).c_str()) != 0) {
+            *error = SystemError("Failed to install compacted segment");
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        SyncDirectory();
+        
+        std::shared_ptr<LogSegment> output;
+        uint64_t base_id;
+        if (!OpenSegment(last, &output, &base_id, error) || !MapSegment(output.get(), output->size, error)) {
+            return false;
+        }
+        
+        // Repoint keys that were not overwritten while compacting
+        for (size_t i = 0; i < live.size(); i++) {
+            auto it = index_.find(live[i].first);
+            if (it != index_.end() && it->second.segment == live[i].second.segment &&
+                it->second.offset == live[i].second.offset) {
+                it->second.segment = last;
+                it->second.offset = new_offsets[i];
+                output->live_bytes += RecordSize(live[i].first.size(), it->second.length);
+            }
+        }
+        
+        uint64_t input_bytes = 0;
+        for (const auto& segment : inputs) {
+            input_bytes += segment->size;
+            segments_.erase(segment->id);
+            if (segment->id != last) {
+                std::remove(SegmentPath(segment->id).c_str());
+            }
+        }
+        segments_[last] = output;
+        compactions_++;
+        *reclaimed = input_bytes > output->size ? input_bytes - output->size : 0;
+        
+        if (!WriteSnapshot(error)) {
+            std::cerr << "kv: " << *error << std::endl;
+            error->clear();
+        }
+        return true;
+    }
+    
+    // Flush, checkpoint and stop accepting writes
+    bool Close(std::string* error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_ || !active_) {
+                closed_ = true;
+                return true;
+            }
+            stopping_ = true;
+        }
+        group_commit_cv_.notify_all();
+        if (group_commit_thread_.joinable()) {
+            group_commit_thread_.join();
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool success = WriteSnapshot(error);
+        closed_ = true;
+        return success;
+    }
+    
+    // Collect statistics
+    KvStats Stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        KvStats stats;
+        stats.keys = index_.size();
+        stats.segments = segments_.size();
+        for (const auto& entry : segments_) {
+            stats.bytes += entry.second->size;
+            stats.live_bytes += entry.second->live_bytes;
+        }
+        stats.compactions = compactions_;
+        return stats;
+    }
+
+private:
+    std::string SegmentPath(uint64_t id) const {
+        return options_.directory + "/segment-" + std::to_string(id) + ".log";
+    }
+    
+    std::string SnapshotPath() const {
+        return options_.directory + "/snapshot";
+    }
+    
+    // Find the ids of the segment files in the directory
+    bool ListSegments(std::vector<uint64_t>* ids, std::string* error) {
+        DIR* dir = opendir(options_.directory.c_str());
+        if (!dir) {
+            *error = SystemError("Failed to open " + options_.directory);
+            return false;
+        }
+        while (dirent* entry = readdir(dir)) {
+            unsigned long long id;
+            char suffix[8];
+            if (std::sscanf(entry->d_name, "segment-%llu.%7s", &id, suffix) == 2) {
+                if (std::strcmp(suffix, "log") == 0) {
+                    ids->push_back(id);
+                } else if (std::strcmp(suffix, "compact") == 0) {
+                    // An unfinished compaction
+                    std::remove((options_.directory + "/" + entry->d_name).c_str());
+                }
+            }
+        }
+        closedir(dir);
+        std::sort(ids->begin(), ids->end());
+        return true;
+    }
+    
+    // Open an existing segment file and read its header
+    bool OpenSegment(uint64_t id, std::shared_ptr<LogSegment>* result, uint64_t* base_id, std::string* error) {
+        auto segment = std::make_shared<LogSegment>();
+        segment->id = id;
+        segment->fd = open(SegmentPath(id).c_str(), O_RDWR | O_APPEND);
+        if (segment->fd < 0) {
+            *error = SystemError("Failed to open " + SegmentPath(id));
+            return false;
+        }
+        
+        struct stat st;
+        if (fstat(segment->fd, &st) != 0) {
+            *error = SystemError("Failed to stat " + SegmentPath(id));
+            return false;
+        }
+        
+        SegmentHeader header;
+        if (st.st_size < static_cast<off_t>(sizeof(header))) {
+            // Crashed while creating the segment; start it over
+            header = {kSegmentMagic, kFormatVersion, id};
+            if (ftruncate(segment->fd, 0) != 0 || write(segment->fd, &header, sizeof(header)) != sizeof(header)) {
+                *error = SystemError("Failed to initialize " + SegmentPath(id));
+                return false;
+            }
+            st.st_size = sizeof(header);
+        } else if (pread(segment->fd, &header, sizeof(header), 0) != sizeof(header) ||
+                   header.magic != kSegmentMagic || header.version != kFormatVersion) {
+            *error = "Not a kv segment: " + SegmentPath(id);
+            return false;
+        }
+        
+        segment->size = static_cast<size_t>(st.st_size);
+        *base_id = header.base_id;
+        *result = segment;
+        return true;
+    }
+    
+    // Create a new, empty segment file
+    bool CreateSegment(uint64_t id, uint64_t base_id, size_t capacity,
+                       std::shared_ptr<LogSegment>* result, std::string* error) {
+        auto segment = std::make_shared<LogSegment>();
+        segment->id = id;
+        segment->fd = open(SegmentPath(id).c_str(), O_CREAT | O_TRUNC | O_RDWR | O_APPEND, 0644);
+        if (segment->fd < 0) {
+            *error = SystemError("Failed to create " + SegmentPath(id));
+            return false;
+        }
+        
+        SegmentHeader header = {kSegmentMagic, kFormatVersion, base_id};
+        if (write(segment->fd, &header, sizeof(header)) != sizeof(header)) {
+            *error = SystemError("Failed to write " + SegmentPath(id));
+            return false;
+        }
+        segment->size = sizeof(header);
+        SyncDirectory();
+        
+        if (!MapSegment(segment.get(), capacity, error)) {
+            return false;
+        }
+        *result = segment;
+        return true;
+    }
+    
+    // Map a segment; pages past the end of the file are never read
+    //
+    // The mapping is read-only; its pages track the page cache, and so see
+    // later appends.
+    bool MapSegment(LogSegment* segment, size_t capacity, std::string* error) {
+        void* map = mmap(nullptr, capacity, PROT_READ, MAP_PRIVATE, segment->fd, 0);
+        if (map == MAP_FAILED) {
+            *error = SystemError("Failed to map " + SegmentPath(segment->id));
+            return false;
+        }
+        segment->map = static_cast<uint8_t*>(map);
+        segment->capacity = capacity;
+        return true;
+    }
+    
+    // Seal the active segment and start a new one with room for a batch
+    bool Roll(size_t needed, std::string* error) {
+        if (options_.sync != KvSyncMode::kNone && fdatasync(active_->fd) != 0) {
+            *error = SystemError("Failed to sync the log");
+            return false;
+        }
+        
+        uint64_t id = active_->id + 1;
+        std::shared_ptr<LogSegment> segment;
+        size_t capacity = std::max(options_.segment_size, needed + sizeof(SegmentHeader));
+        if (!CreateSegment(id, id, capacity, &segment, error)) {
+            return false;
+        }
+        segments_[id] = segment;
+        active_ = segment;
+        
+        // Compact in the background once enough of the sealed log is dead
+        uint64_t sealed_bytes = 0;
+        uint64_t sealed_live = 0;
+        for (const auto& entry : segments_) {
+            if (entry.second != active_) {
+                sealed_bytes += entry.second->size;
+                sealed_live += entry.second->live_bytes;
+            }
+        }
+        if (!compacting_ && options_.compact_threshold > 0 && sealed_bytes > 0 &&
+            static_cast<double>(sealed_bytes - sealed_live) / sealed_bytes >= options_.compact_threshold) {
+            std::shared_ptr<KvStore> self = shared_from_this();
+            ThreadPool::GetDefault()->Submit([self]() {
+                uint64_t reclaimed;
+                std::string error;
+                if (!self->Compact(&reclaimed, &error)) {
+                    std::cerr << "kv: background compaction failed: " << error << std::endl;
+                }
+            });
+        }
+        return true;
+    }
+    
+    // Update the index for a record at an offset in a segment
+    void Apply(const std::string& key, LogSegment* segment, size_t record_offset, uint32_t value_length) {
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            auto old = segments_.find(it->second.segment);
+            if (old != segments_.end()) {
+                old->second->live_bytes -= RecordSize(key.size(), it->second.length);
+            }
+        }
+        
+        if (value_length == kTombstone) {
+            if (it != index_.end()) {
+                index_.erase(it);
+            }
+            return;
+        }
+        
+        KvLocation location = {segment->id, record_offset + sizeof(RecordHeader) + key.size(), value_length};
+        if (it != index_.end()) {
+            it->second = location;
+        } else {
+            index_.emplace(key, location);
+        }
+        segment->live_bytes += RecordSize(key.size(), value_length);
+    }
+    
+    // Apply the records of a segment from an offset, truncating a torn tail
+    bool Replay(LogSegment* segment, size_t offset, bool last, std::string* error) {
+        while (offset + sizeof(RecordHeader) <= segment->size) {
+            RecordHeader header;
+            std::memcpy(&header, segment->map + offset, sizeof(header));
+            size_t record_size = RecordSize(header.key_length, header.value_length);
+            if (record_size > segment->size - offset) {
+                break;
+            }
+            
+            const uint8_t* key = segment->map + offset + sizeof(header);
+            if (RecordCrc(header.key_length, header.value_length, key, key + header.key_length) != header.crc) {
+                break;
+            }
+            
+            Apply(std::string(reinterpret_cast<const char*>(key), header.key_length), segment, offset,
+                  header.value_length);
+            offset += record_size;
+        }
+        
+        if (offset != segment->size) {
+            if (!last) {
+                *error = "Corrupt record in " + SegmentPath(segment->id);
+                return false;
+            }
+            std::cerr << "kv: truncating " << (segment->size - offset) << " bytes of torn writes in "
+                      << SegmentPath(segment->id) << std::endl;
+            if (ftruncate(segment->fd, offset) != 0) {
+                *error = SystemError("Failed to truncate " + SegmentPath(segment->id));
+                return false;
+            }
+            segment->size = offset;
+        }
+        return true;
+    }
+    
+    // Load the index from the snapshot, if there is a valid one
+    bool LoadSnapshot(uint64_t* segment, uint64_t* offset) {
+        int fd = open(SnapshotPath().c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        
+        struct stat st;
+        bool valid = false;
+        if (fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(sizeof(SnapshotHeader))) {
+            void* map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                valid = ParseSnapshot(static_cast<const uint8_t*>(map), st.st_size, segment, offset);
+                munmap(map, st.st_size);
+            }
+        }
+        close(fd);
+        
+        if (!valid) {
+            std::cerr << "kv: ignoring invalid snapshot, replaying the whole log" << std::endl;
+        }
+        return valid;
+    }
+    
+    // Parse a mapped snapshot into the index
+    bool ParseSnapshot(const uint8_t* data, size_t size, uint64_t* segment, uint64_t* offset) {
+        SnapshotHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (header.magic != kSnapshotMagic || header.version != kFormatVersion ||
+            Crc32c(0, data + sizeof(header), size - sizeof(header)) != header.crc) {
+            return false;
+        }
+        
+        auto covered = segments_.find(header.segment);
+        if (covered == segments_.end() || header.offset > covered->second->size) {
+            return false;
+        }
+        
+        size_t position = sizeof(header);
+        index_.reserve(header.count);
+        for (uint64_t i = 0; i < header.count; i++) {
+            SnapshotEntry entry;
+            if (size - position < sizeof(entry)) {
+                return false;
+            }
+            std::memcpy(&entry, data + position, sizeof(entry));
+            position += sizeof(entry);
+            if (size - position < entry.key_length) {
+                return false;
+            }
+            
+            auto holder = segments_.find(entry.segment);
+            if (holder == segments_.end() || entry.offset + entry.length > holder->second->size) {
+                return false;
+            }
+            
+            std::string key(reinterpret_cast<const char*>(data + position), entry.key_length);
+            position += entry.key_length;
+            holder->second->live_bytes += RecordSize(key.size(), entry.length);
+            index_.emplace(std::move(key), KvLocation{entry.segment, entry.offset, entry.length});
+        }
+        
+        *segment = header.segment;
+        *offset = header.offset;
+        return true;
+    }
+    
+    // Write the snapshot atomically; the caller holds the mutex
+    bool WriteSnapshot(std::string* error) {
+        // The snapshot must never cover log bytes that are not durable
+        if (fdatasync(active_->fd) != 0) {
+            *error = SystemError("Failed to sync the log");
+            return false;
+        }
+        
+        std::string data(sizeof(SnapshotHeader), '\0');
+        for (const auto& [key, location] : index_) {
+            SnapshotEntry entry = {static_cast<uint32_t>(key.size()), location.length,
+                                   location.segment, location.offset};
+            data.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+            data.append(key);
+        }
+        
+        SnapshotHeader header = {kSnapshotMagic, kFormatVersion, index_.size(), active_->id, active_->size,
+                                 0, 0};
+        header.crc = Crc32c(0, data.data() + sizeof(header), data.size() - sizeof(header));
+        std::memcpy(data.data(), &header, sizeof(header));
+        
+        std::string temp_path = SnapshotPath() + ".tmp";
+        int fd = open(temp_path.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0644);
+        if (fd < 0) {
+            *error = SystemError("Failed to create " + temp_path);
+            return false;
+        }
+        
+        iovec iov = {data.data(), data.size()};
+        std::vector<iovec> iovs = {iov};
+        bool written = WriteAll(fd, iovs) && fsync(fd) == 0;
+        close(fd);
+        if (!written || std::rename(temp_path.c_str(), SnapshotPath().c_str()) != 0) {
+            *error = SystemError("Failed to write " + SnapshotPath());
+            std::remove(temp_path.c_str());
+            return false;
+        }
+        SyncDirectory();
+        return true;
+    }
+    
+    // Make file creations and renames in the directory durable
+    void SyncDirectory() {
+        int fd = open(options_.directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd >= 0) {
+            fsync(fd);
+            close(fd);
+        }
+    }
+    
+    // Group commit thread: one fdatasync per interval covers every write in it
+    void GroupCommitMain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            group_commit_cv_.wait_for(lock, std::chrono::milliseconds(options_.group_commit_ms),
+                                      [this]() { return stopping_; });
+            bool stop = stopping_;
+            if (dirty_) {
+                dirty_ = false;
+                std::shared_ptr<LogSegment> segment = active_;
+                lock.unlock();
+                if (fdatasync(segment->fd) != 0) {
+                    std::cerr << "kv: group commit failed: " << std::strerror(errno) << std::endl;
+                }
+                lock.lock();
+            }
+            if (stop) {
+                return;
+            }
+        }
+    }
+    
+    KvOptions options_;
+    std::mutex mutex_;
+    std::map<uint64_t, std::shared_ptr<LogSegment>> segments_;
+    std::shared_ptr<LogSegment> active_;
+    std::unordered_map<std::string, KvLocation> index_;
+    bool closed_;
+    bool compacting_;
+    bool dirty_;
+    bool stopping_;
+    uint64_t compactions_;
+    std::thread group_commit_thread_;
+    std::condition_variable group_commit_cv_;
+};
+
+// A wrapper's reference to a store
+struct KvHandle {
+    std::shared_ptr<KvStore> store;
+    v8::Global<v8::Object> handle;
+};
+
+// Drop a store reference when its wrapper is garbage collected
+static void KvWeakCallback(const v8::WeakCallbackInfo<KvHandle>& info) {
+    KvHandle* kv_handle = info.GetParameter();
+    kv_handle->handle.Reset();
+    delete kv_handle;
+}
+
+// Throw an Error with a message
+static void ThrowKvError(v8::Isolate* isolate, const std::string& message) {
+    isolate->ThrowException(v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()));
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Get the store behind a wrapper object
+static std::shared_ptr<KvStore> UnwrapStore(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    if (args.This()->InternalFieldCount() < 1) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    KvHandle* kv_handle = static_cast<KvHandle*>(args.This()->GetAlignedPointerFromInternalField(0));
+    return kv_handle->store;
+}
+
+// Fill an operation from a key and a value (undefined or null to delete)
+static bool ReadOperation(v8::Isolate* isolate, v8::Local<v8::Value> key, v8::Local<v8::Value> value,
+                          KvOperation* operation) {
+    if (!key->IsString()) {
+        return false;
+    }
+    v8::String::Utf8Value key_utf8(isolate, key);
+    operation->key.assign(*key_utf8, key_utf8.length());
+    
+    if (value->IsNullOrUndefined()) {
+        operation->remove = true;
+    } else if (value->IsArrayBufferView()) {
+        // Written straight from the view's memory
+        v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+        operation->value = static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+        operation->length = view->ByteLength();
+    } else if (value->IsArrayBuffer()) {
+        v8::Local<v8::ArrayBuffer> buffer = value.As<v8::ArrayBuffer>();
+        operation->value = static_cast<const uint8_t*>(buffer->Data());
+        operation->length = buffer->ByteLength();
+    } else if (value->IsString()) {
+        v8::String::Utf8Value value_utf8(isolate, value);
+        operation->owned_value.assign(*value_utf8, value_utf8.length());
+        operation->owned = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Write operations, throwing on failure
+static void WriteOperations(v8::Isolate* isolate, KvStore* store, std::vector<KvOperation>& operations) {
+    std::string error;
+    if (!store->Write(operations, &error)) {
+        ThrowKvError(isolate, error);
+    }
+}
+
+// db.put(key, value)
+static void KvPut(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    
+    std::vector<KvOperation> operations(1);
+    if (args.Length() < 2 || args[1]->IsNullOrUndefined() ||
+        !ReadOperation(isolate, args[0], args[1], &operations[0])) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    WriteOperations(isolate, store.get(), operations);
+}
+
+// db.delete(key)
+static void KvDelete(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    
+    std::vector<KvOperation> operations(1);
+    if (args.Length() < 1 || !ReadOperation(isolate, args[0], v8::Undefined(isolate), &operations[0])) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    // Deleting a missing key writes nothing
+    if (!store->Has(operations[0].key)) {
+        args.GetReturnValue().Set(false);
+        return;
+    }
+    WriteOperations(isolate, store.get(), operations);
+    args.GetReturnValue().Set(true);
+}
+
+// db.batch(entries)
+static void KvBatch(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::Local<v8::Array> entries = args[0].As<v8::Array>();
+    std::vector<KvOperation> operations(entries->Length());
+    for (uint32_t i = 0; i < entries->Length(); i++) {
+        v8::Local<v8::Value> entry;
+        if (!entries->Get(context, i).ToLocal(&entry)) {
+            return;
+        }
+        if (!entry->IsArray()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        
+        v8::Local<v8::Array> pair = entry.As<v8::Array>();
+        v8::Local<v8::Value> key;
+        v8::Local<v8::Value> value;
+        if (!pair->Get(context, 0).ToLocal(&key) || !pair->Get(context, 1).ToLocal(&value)) {
+            return;
+        }
+        if (!ReadOperation(isolate, key, value, &operations[i])) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+    }
+    
+    if (!operations.empty()) {
+        WriteOperations(isolate, store.get(), operations);
+    }
+}
+
+// db.get(key)
+static void KvGet(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::String::Utf8Value key(isolate, args[0]);
+    KvLocation location;
+    std::shared_ptr<LogSegment> segment = store->Get(std::string_view(*key, key.length()), &location);
+    if (!segment) {
+        args.GetReturnValue().SetUndefined();
+        return;
+    }
+    
+    // Copied out of the mapping; with the V8 sandbox enabled, ArrayBuffers
+    // cannot point at memory outside of it
+    std::unique_ptr<v8::BackingStore> backing_store = v8::ArrayBuffer::NewBackingStore(isolate, location.length);
+    std::memcpy(backing_store->Data(), segment->map + location.offset, location.length);
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(backing_store));
+    args.GetReturnValue().Set(v8::Uint8Array::New(buffer, 0, location.length));
+}
+
+// db.has(key)
+static void KvHas(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    v8::String::Utf8Value key(isolate, args[0]);
+    args.GetReturnValue().Set(store->Has(std::string_view(*key, key.length())));
+}
+
+// db.keys()
+static void KvKeys(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    
+    std::vector<std::string> keys = store->Keys();
+    v8::Local<v8::Array> result = v8::Array::New(isolate, static_cast<int>(keys.size()));
+    for (size_t i = 0; i < keys.size(); i++) {
+        v8::Local<v8::String> key = v8::String::NewFromUtf8(isolate, keys[i].data(), v8::NewStringType::kNormal,
+                                                            static_cast<int>(keys[i].size())).ToLocalChecked();
+        result->Set(context, static_cast<uint32_t>(i), key).Check();
+    }
+    args.GetReturnValue().Set(result);
+}
+
+// db.flush()
+static void KvFlush(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    std::string error;
+    if (store && !store->Flush(&error)) {
+        ThrowKvError(args.GetIsolate(), error);
+    }
+}
+
+// db.checkpoint()
+static void KvCheckpoint(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    std::string error;
+    if (store && !store->Checkpoint(&error)) {
+        ThrowKvError(args.GetIsolate(), error);
+    }
+}
+
+// db.close()
+static void KvClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    std::string error;
+    if (store && !store->Close(&error)) {
+        ThrowKvError(args.GetIsolate(), error);
+    }
+}
+
+// db.stats()
+static void KvStatsCallback(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    
+    KvStats stats = store->Stats();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    v8::Local<v8::Object> result = v8::Object::New(isolate);
+    auto set = [&](v8::Local<v8::String> name, double value) {
+        result->Set(context, name, v8::Number::New(isolate, value)).Check();
+    };
+    set(keys.keys_string(), static_cast<double>(stats.keys));
+    set(keys.segments_string(), static_cast<double>(stats.segments));
+    set(keys.bytes_string(), static_cast<double>(stats.bytes));
+    set(keys.live_bytes_string(), static_cast<double>(stats.live_bytes));
+    set(keys.compactions_string(), static_cast<double>(stats.compactions));
+    args.GetReturnValue().Set(result);
+}
+
+// Compact a store on the thread pool and settle with the bytes reclaimed
+static JsPromise CompactAsync(v8::Isolate* isolate, std::shared_ptr<KvStore> store) {
+    uint64_t reclaimed = 0;
+    std::string error;
+    bool success = co_await RunOnPool([&]() {
+        return store->Compact(&reclaimed, &error);
+    });
+    
+    if (!success) {
+        co_return Rejected{v8::Exception::Error(v8::String::NewFromUtf8(isolate, error.c_str()).ToLocalChecked())};
+    }
+    co_return v8::Number::New(isolate, static_cast<double>(reclaimed));
+}
+
+// db.compact()
+static void KvCompact(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<KvStore> store = UnwrapStore(args);
+    if (!store) {
+        return;
+    }
+    
+    args.GetReturnValue().Set(CompactAsync(isolate, store).GetPromise());
+}
+
+// Native open function
+static void KvOpen(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    KvOptions options;
+    options.directory = *v8::String::Utf8Value(isolate, args[0]);
+    
+    if (args.Length() >= 2 && args[1]->IsObject()) {
+        v8::Local<v8::Object> object = args[1].As<v8::Object>();
+        const PropertyKeys& keys = PropertyKeys::Get(isolate);
+        auto get = [&](v8::Local<v8::String> name, v8::Local<v8::Value>* value) {
+            return object->Get(context, name).ToLocal(value);
+        };
+        
+        v8::Local<v8::Value> sync, group_commit_ms, segment_size, compact_threshold;
+        if (!get(keys.sync_string(), &sync) || !get(keys.group_commit_ms_string(), &group_commit_ms) ||
+            !get(keys.segment_size_string(), &segment_size) ||
+            !get(keys.compact_threshold_string(), &compact_threshold)) {
+            return;
+        }
+        
+        if (sync->IsString()) {
+            std::string mode = *v8::String::Utf8Value(isolate, sync);
+            if (mode == "none") {
+                options.sync = KvSyncMode::kNone;
+            } else if (mode == "group") {
+                options.sync = KvSyncMode::kGroup;
+            } else if (mode == "always") {
+                options.sync = KvSyncMode::kAlways;
+            } else {
+                ThrowInvalidArguments(isolate);
+                return;
+            }
+        }
+        if (group_commit_ms->IsNumber()) {
+            options.group_commit_ms = std::max<int64_t>(1, group_commit_ms->IntegerValue(context).FromJust());
+        }
+        if (segment_size->IsNumber()) {
+            options.segment_size = std::max<int64_t>(4096, segment_size->IntegerValue(context).FromJust());
+        }
+        if (compact_threshold->IsNumber()) {
+            options.compact_threshold = compact_threshold->NumberValue(context).FromJust();
+        }
+    }
+    
+    auto store = std::make_shared<KvStore>(options);
+    std::string error;
+    if (!store->Open(&error)) {
+        ThrowKvError(isolate, error);
+        return;
+    }
+    
+    v8::Local<v8::ObjectTemplate> object_template = v8::ObjectTemplate::New(isolate);
+    object_template->SetInternalFieldCount(1);
+    object_template->Set(isolate, "put", v8::FunctionTemplate::New(isolate, KvPut));
+    object_template->Set(isolate, "get", v8::FunctionTemplate::New(isolate, KvGet));
+    object_template->Set(isolate, "has", v8::FunctionTemplate::New(isolate, KvHas));
+    object_template->Set(isolate, "delete", v8::FunctionTemplate::New(isolate, KvDelete));
+    object_template->Set(isolate, "batch", v8::FunctionTemplate::New(isolate, KvBatch));
+    object_template->Set(isolate, "keys", v8::FunctionTemplate::New(isolate, KvKeys));
+    object_template->Set(isolate, "flush", v8::FunctionTemplate::New(isolate, KvFlush));
+    object_template->Set(isolate, "checkpoint", v8::FunctionTemplate::New(isolate, KvCheckpoint));
+    object_template->Set(isolate, "compact", v8::FunctionTemplate::New(isolate, KvCompact));
+    object_template->Set(isolate, "stats", v8::FunctionTemplate::New(isolate, KvStatsCallback));
+    object_template->Set(isolate, "close", v8::FunctionTemplate::New(isolate, KvClose));
+    
+    v8::Local<v8::Object> object = object_template->NewInstance(context).ToLocalChecked();
+    KvHandle* kv_handle = new KvHandle();
+    kv_handle->store = std::move(store);
+    kv_handle->handle.Reset(isolate, object);
+    kv_handle->handle.SetWeak(kv_handle, KvWeakCallback, v8::WeakCallbackType::kParameter);
+    object->SetAlignedPointerInInternalField(0, kv_handle);
+    
+    args.GetReturnValue().Set(object);
+}
+
+// Register the kv module
+void RegisterKvModule(Runtime* runtime) {
+    std::cout << "RegisterKvModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the kv module object
+        v8::Local<v8::Object> kv = v8::Object::New(isolate);
+        kv->Set(context,
+            v8::String::NewFromUtf8(isolate, "open").ToLocalChecked(),
+            v8::Function::New(context, KvOpen).ToLocalChecked()).Check();
+        
+        // Register the kv module
+        runtime->GetModuleSystem()->RegisterNativeModule("kv", kv);
+        
+        std::cout << "RegisterKvModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterKvModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterKvModule" << std::endl;
+    }
+}
@@ -2,8 +2,13 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
 #include "runtime.h"
-#include "process_module.h"
+#include "inspect.h"
+#include "thread_pool.h"
+#include "http_replay.h"
 
 /**
  * @brief Native print function exposed to JavaScript
@@ -20,23 +25,68 @@ void Print(const v8::FunctionCallbackInfo<v8::Value>& args) {
     // Create a handle scope to manage the local handles
     v8::HandleScope scope(isolate);
     
-    // Iterate through all arguments and print them
-    for (int i = 0; i < args.Length(); i++) {
-        // Convert the JavaScript value to a C++ string
-        v8::String::Utf8Value str(isolate, args[i]);
-        std::cout << *str;
-        
-        // Add a space between arguments (but not after the last one)
-        if (i < args.Length() - 1) {
-            std::cout << " ";
-        }
+    // Format the arguments like util.format() into the reused buffer
+    InspectBuffer buffer;
+    std::string* line = buffer.Get();
+    if (!FormatValues(isolate->GetCurrentContext(), args, line)) {
+        return;
     }
-    std::cout << std::endl;
+    
+    // Write the line in one call
+    line->push_back('\n');
+    std::cout.write(line->data(), line->size());
+    std::cout.flush();
     
     // Return undefined (like most Node.js functions)
     args.GetReturnValue().SetUndefined();
 }
 
+/**
+ * @brief Replay an HTTP capture: --replay <capture> [--speed <n>x] [--target <host:port>]
+ * 
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line arguments, argv[1] being --replay
+ * @return int Exit code of the replay, or 1 for bad arguments
+ */
+static int ReplayMain(int argc, char* argv[]) {
+    HttpReplayOptions options;
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (option.compare(0, 2, "--") != 0) {
+            options.capture_path = option;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (option == "--speed") {
+            // "10x" and "10" both mean ten times the recorded rate
+            options.speed = std::strtod(value, nullptr);
+        } else if (option == "--target") {
+            const char* colon = std::strrchr(value, ':');
+            if (!colon) {
+                std::cerr << "Replay target must be <host:port>: " << value << std::endl;
+                return 1;
+            }
+            options.host.assign(value, colon - value);
+            options.port = std::atoi(colon + 1);
+        } else if (option == "--timeout") {
+            options.timeout_ms = std::strtoull(value, nullptr, 10);
+        } else {
+            std::cerr << "Unknown replay option: " << option << std::endl;
+            return 1;
+        }
+    }
+    if (options.capture_path.empty()) {
+        std::cerr << "Usage: " << argv[0]
+                  << " --replay <capture.bin> [--speed <n>x] [--target <host:port>] [--timeout <ms>]" << std::endl;
+        return 1;
+    }
+    return RunHttpReplay(options);
+}
+
 /**
  * @brief Main entry point for the tiny Node.js runtime
  * 
@@ -48,13 +98,64 @@ void Print(const v8::FunctionCallbackInfo<v8::Value>& args) {
  * @return int Exit code (0 for success, non-zero for failure)
  */
 int main(int argc, char* argv[]) {
+    // Replaying a capture is a client tool that needs no JavaScript runtime
+    if (argc > 1 && std::strcmp(argv[1], "--replay") == 0) {
+        return ReplayMain(argc, argv);
+    }
+    
     std::cout << "Starting main function..." << std::endl;
     
+    // Runtime options come before the script
+    RuntimeOptions options;
+    CpuAffinity pool_affinity;
+    int script_index = 1;
+    while (script_index < argc && std::strncmp(argv[script_index], "--", 2) == 0) {
+        const char* option = argv[script_index];
+        std::string error;
+        bool valid = true;
+        if (std::strncmp(option, "--time-slice=", 13) == 0) {
+            options.time_slice_ms = std::strtoull(option + 13, nullptr, 10);
+        } else if (std::strncmp(option, "--http-capture=", 15) == 0) {
+            options.http_capture_path = option + 15;
+        } else if (std::strncmp(option, "--task-queue-capacity=", 22) == 0) {
+            options.task_queue_capacity = std::strtoull(option + 22, nullptr, 10);
+        } else if (std::strncmp(option, "--loop-affinity=", 16) == 0) {
+            valid = CpuAffinity::Parse(option + 16, &options.loop_affinity, &error);
+        } else if (std::strncmp(option, "--worker-affinity=", 18) == 0) {
+            valid = CpuAffinity::Parse(option + 18, &options.worker_affinity, &error);
+        } else if (std::strncmp(option, "--pool-affinity=", 16) == 0) {
+            valid = CpuAffinity::Parse(option + 16, &pool_affinity, &error);
+        } else {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+        if (!valid) {
+            std::cerr << option << ": " << error << std::endl;
+            return 1;
+        }
+        script_index++;
+    }
+    
     // Check if a JavaScript file was provided
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <script.js>" << std::endl;
+    if (script_index >= argc) {
+        std::cerr << "Usage: " << argv[0] << " [--time-slice=<ms>] [--task-queue-capacity=<n>] [--loop-affinity=<cpus>]"
+                  << " [--pool-affinity=<cpus>] [--worker-affinity=<cpus>] <script.js> [args...]" << std::endl;
+        std::cerr << "       " << argv[0] << " [--http-capture=<file>] ... <script.js> [args...]" << std::endl;
+        std::cerr << "       " << argv[0]
+                  << " --replay <capture.bin> [--speed <n>x] [--target <host:port>] [--timeout <ms>]" << std::endl;
+        std::cerr << "CPU lists look like 0-3,8; node:0,1 names every CPU of NUMA nodes 0 and 1" << std::endl;
         return 1;
     }
+    const char* script = argv[script_index];
+    
+    // process.argv holds the executable, the script and the script's arguments
+    std::vector<char*> script_argv;
+    script_argv.push_back(argv[0]);
+    script_argv.insert(script_argv.end(), argv + script_index, argv + argc);
+    
+    // The main thread runs the script, so it lives where the loop does; the pool starts later
+    options.loop_affinity.ApplyToCurrentThread();
+    ThreadPool::SetDefaultAffinity(pool_affinity);
     
     std::cout << "Initializing runtime..." << std::endl;
     
@@ -66,30 +167,30 @@ int main(int argc, char* argv[]) {
     
     std::cout << "Creating runtime instance..." << std::endl;
     
-    // Create a new runtime instance
-    Runtime runtime;
+    // Create a new runtime instance; the process module is built from argv
+    options.argc = static_cast<int>(script_argv.size());
+    options.argv = script_argv.data();
+    Runtime runtime(options);
     
     // Register the native print function
     std::cout << "Registering print function..." << std::endl;
     runtime.RegisterNativeFunction("print", Print);
     
-    // Register the process module
-    std::cout << "Registering process module..." << std::endl;
-    RegisterProcessModule(&runtime, argc, argv);
-    
-    std::cout << "Executing file: " << argv[1] << std::endl;
+    std::cout << "Executing file: " << script << std::endl;
     
     // Execute the JavaScript file
-    if (!runtime.ExecuteFile(argv[1])) {
-        std::cerr << "Failed to execute file: " << argv[1] << std::endl;
+    if (!runtime.ExecuteFile(script)) {
+        std::cerr << "Failed to execute file: " << script << std::endl;
         Runtime::Shutdown();
         return 1;
     }
     
     std::cout << "File executed successfully, waiting for event loop..." << std::endl;
     
-    // Wait for a moment to allow async operations to complete
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+    // Keep running while timers, queued work or open sockets can still call back
+    while (runtime.HasPendingWork()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
     
     std::cout << "Shutting down runtime..." << std::endl;
     
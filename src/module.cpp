@@ -1,5 +1,7 @@
 #include "module.h"
 #include "runtime.h"
+#include "builtins.h"
+#include "property_keys.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -7,7 +9,12 @@
 
 // Module constructor
 Module::Module(Runtime* runtime, const std::string& id, const std::string& filename)
-    : runtime_(runtime), id_(id), filename_(filename), loaded_(false) {
+    : runtime_(runtime), id_(id), filename_(filename), builtin_(nullptr), loaded_(false) {
+}
+
+// Built-in module constructor
+Module::Module(Runtime* runtime, const BuiltinSource* builtin)
+    : runtime_(runtime), id_(builtin->id), filename_(builtin->id), builtin_(builtin), loaded_(false) {
 }
 
 // Module destructor
@@ -21,23 +28,6 @@ bool Module::Load() {
         return true;
     }
     
-    // Check if the file exists
-    std::ifstream file(filename_);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open module file: " << filename_ << std::endl;
-        return false;
-    }
-    
-    // Read the file content
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
-    
-    // Wrap the source in a function to create a module scope
-    std::string wrapped_source = "(function(exports, require, module, __filename, __dirname) {\n";
-    wrapped_source += source;
-    wrapped_source += "\n})";
-    
     // Get the isolate
     v8::Isolate* isolate = runtime_->GetIsolate();
     
@@ -48,35 +38,52 @@ bool Module::Load() {
     v8::Local<v8::Context> context = isolate->GetCurrentContext();
     v8::Context::Scope context_scope(context);
     
-    // Compile the wrapped source
-    v8::Local<v8::String> source_str = v8::String::NewFromUtf8(
-        isolate, wrapped_source.c_str(), v8::NewStringType::kNormal).ToLocalChecked();
+    v8::Local<v8::String> source_str;
+    v8::ScriptCompiler::CachedData* cached_data = nullptr;
+    if (builtin_) {
+        // Built-in modules are served from read-only memory
+        source_str = NewBuiltinSourceString(isolate, builtin_);
+        
+        const BuiltinCodeCache* code_cache = FindBuiltinCodeCache(id_);
+        if (code_cache) {
+            cached_data = new v8::ScriptCompiler::CachedData(
+                code_cache->data, static_cast<int>(code_cache->length),
+                v8::ScriptCompiler::CachedData::BufferNotOwned);
+        }
+    } else {
+        // Check if the file exists
+        std::ifstream file(filename_);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open module file: " << filename_ << std::endl;
+            return false;
+        }
+        
+        // Read the file content
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string source = buffer.str();
+        
+        source_str = v8::String::NewFromUtf8(
+            isolate, source.c_str(), v8::NewStringType::kNormal,
+            static_cast<int>(source.size())).ToLocalChecked();
+    }
     
+    // Compile the source as a function to create a module scope
     v8::TryCatch try_catch(isolate);
-    v8::Local<v8::Script> script;
-    if (!v8::Script::Compile(context, source_str).ToLocal(&script)) {
+    v8::Local<v8::Function> module_func;
+    if (!CompileFunction(context, source_str, filename_, cached_data).ToLocal(&module_func)) {
         v8::String::Utf8Value error(isolate, try_catch.Exception());
         std::cerr << "Failed to compile module: " << id_ << " - " << *error << std::endl;
         return false;
     }
     
-    // Run the script to get the module function
-    v8::Local<v8::Value> result;
-    if (!script->Run(context).ToLocal(&result)) {
-        v8::String::Utf8Value error(isolate, try_catch.Exception());
-        std::cerr << "Failed to run module: " << id_ << " - " << *error << std::endl;
-        return false;
-    }
-    
-    // Cast the result to a function
-    v8::Local<v8::Function> module_func = v8::Local<v8::Function>::Cast(result);
-    
     // Create the exports object
     v8::Local<v8::Object> exports = v8::Object::New(isolate);
     
     // Create the module object
+    const PropertyKeys& keys = runtime_->GetPropertyKeys();
     v8::Local<v8::Object> module = v8::Object::New(isolate);
-    module->Set(context, v8::String::NewFromUtf8(isolate, "exports").ToLocalChecked(), exports).Check();
+    module->Set(context, keys.exports_string(), exports).Check();
     
     // Get the directory name
     std::filesystem::path path(filename_);
@@ -100,7 +107,7 @@ bool Module::Load() {
     
     // Get the exports from the module object
     v8::Local<v8::Value> exports_value;
-    if (!module->Get(context, v8::String::NewFromUtf8(isolate, "exports").ToLocalChecked()).ToLocal(&exports_value)) {
+    if (!module->Get(context, keys.exports_string()).ToLocal(&exports_value)) {
         std::cerr << "Failed to get exports from module: " << id_ << std::endl;
         return false;
     }
@@ -114,6 +121,47 @@ bool Module::Load() {
     return true;
 }
 
+// Compile module source into its wrapper function
+v8::MaybeLocal<v8::Function> Module::CompileFunction(
+    v8::Local<v8::Context> context,
+    v8::Local<v8::String> source,
+    const std::string& filename,
+    v8::ScriptCompiler::CachedData* cached_data,
+    bool eager) {
+    v8::Isolate* isolate = context->GetIsolate();
+    v8::EscapableHandleScope handle_scope(isolate);
+    
+    v8::Local<v8::String> params[5] = {
+        v8::String::NewFromUtf8Literal(isolate, "exports"),
+        v8::String::NewFromUtf8Literal(isolate, "require"),
+        v8::String::NewFromUtf8Literal(isolate, "module"),
+        v8::String::NewFromUtf8Literal(isolate, "__filename"),
+        v8::String::NewFromUtf8Literal(isolate, "__dirname")
+    };
+    
+    v8::ScriptOrigin origin(v8::String::NewFromUtf8(isolate, filename.c_str()).ToLocalChecked());
+    v8::ScriptCompiler::Source script_source(source, origin, cached_data);
+    
+    v8::ScriptCompiler::CompileOptions options = v8::ScriptCompiler::kNoCompileOptions;
+    if (cached_data) {
+        options = v8::ScriptCompiler::kConsumeCodeCache;
+    } else if (eager) {
+        options = v8::ScriptCompiler::kEagerCompile;
+    }
+    
+    v8::Local<v8::Function> function;
+    if (!v8::ScriptCompiler::CompileFunction(
+            context, &script_source, 5, params, 0, nullptr, options).ToLocal(&function)) {
+        return v8::MaybeLocal<v8::Function>();
+    }
+    
+    if (cached_data && script_source.GetCachedData()->rejected) {
+        std::cerr << "Code cache rejected for " << filename << ", compiled from source" << std::endl;
+    }
+    
+    return handle_scope.Escape(function);
+}
+
 // Get the module ID
 const std::string& Module::GetId() const {
     return id_;
@@ -142,6 +190,7 @@ ModuleSystem::~ModuleSystem() {
         pair.second.Reset();
     }
     native_modules_.clear();
+    native_templates_.clear();
 }
 
 // Require a module
@@ -149,9 +198,9 @@ v8::Local<v8::Object> ModuleSystem::Require(const std::string& module_id) {
     v8::Isolate* isolate = runtime_->GetIsolate();
     
     // Check if it's a native module
-    auto native_it = native_modules_.find(module_id);
-    if (native_it != native_modules_.end()) {
-        return v8::Local<v8::Object>::New(isolate, native_it->second);
+    v8::Local<v8::Value> native_exports;
+    if (GetNativeModule(module_id, &native_exports)) {
+        return native_exports.As<v8::Object>();
     }
     
     // Check if the module is already loaded
@@ -160,6 +209,18 @@ v8::Local<v8::Object> ModuleSystem::Require(const std::string& module_id) {
         return it->second->GetExports(isolate);
     }
     
+    // Check if it's a built-in module compiled into the binary
+    const BuiltinSource* builtin = FindBuiltinSource(module_id);
+    if (builtin) {
+        std::shared_ptr<Module> module = std::make_shared<Module>(runtime_, builtin);
+        if (!module->Load()) {
+            v8::Local<v8::Object> empty = v8::Object::New(isolate);
+            return empty;
+        }
+        modules_[module_id] = module;
+        return module->GetExports(isolate);
+    }
+    
     // Resolve the module ID to a filename
     std::string filename = ResolveModuleId(module_id);
     if (filename.empty()) {
@@ -191,6 +252,13 @@ void ModuleSystem::RegisterNativeModule(const std::string& module_id, v8::Local<
     native_modules_[module_id].Reset(isolate, exports);
 }
 
+// Register a native module to be instantiated on first use
+void ModuleSystem::RegisterNativeModule(const std::string& module_id,
+                                        v8::Local<v8::ObjectTemplate> exports_template) {
+    v8::Isolate* isolate = runtime_->GetIsolate();
+    native_templates_[module_id].Reset(isolate, exports_template);
+}
+
 // Get a native module by ID
 bool ModuleSystem::GetNativeModule(const std::string& module_id, v8::Local<v8::Value>* result) {
     v8::Isolate* isolate = runtime_->GetIsolate();
@@ -201,7 +269,19 @@ bool ModuleSystem::GetNativeModule(const std::string& module_id, v8::Local<v8::V
         return true;
     }
     
-    return false;
+    // Instantiate a registered template in the calling context
+    auto template_it = native_templates_.find(module_id);
+    if (template_it == native_templates_.end() || !isolate->InContext()) {
+        return false;
+    }
+    v8::Local<v8::Object> exports;
+    if (!template_it->second.Get(isolate)->NewInstance(isolate->GetCurrentContext()).ToLocal(&exports)) {
+        return false;
+    }
+    native_templates_.erase(template_it);
+    native_modules_[module_id].Reset(isolate, exports);
+    *result = exports;
+    return true;
 }
 
 // Get the runtime
@@ -0,0 +1,950 @@
+#include "net_module.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+#include "property_keys.h"
+#include "stream_base.h"
+#include <uv.h>
+#include <iostream>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Size of the slabs reads are carved from
+static constexpr size_t kSlabSize = 256 * 1024;
+
+// A new slab is started when less than this is left in the current one
+static constexpr size_t kMinReadSpace = 16 * 1024;
+
+// Chunks a writev() call handles without allocating
+static constexpr size_t kStackBufs = 16;
+
+struct TcpWrap;
+
+// Per-runtime state of the internal/net module
+struct NetBinding {
+    Runtime* runtime = nullptr;
+    
+    // Context the callbacks run in, set by setup()
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> onread;
+    v8::Global<v8::Function> onconnection;
+    v8::Global<v8::Function> onconnect;
+    v8::Global<v8::Function> onwrite;
+    v8::Global<v8::Function> onshutdown;
+    v8::Global<v8::Function> onclose;
+    
+    // Class of handle objects, used to wrap accepted connections
+    v8::Global<v8::Function> tcp_constructor;
+    
+    // Read slab: reads are placed one after another and handed out as views
+    v8::Global<v8::ArrayBuffer> slab;
+    char* slab_data = nullptr;
+    size_t slab_offset = 0;
+    
+    // Open handles, closed by the cleanup hook when the runtime goes away
+    std::unordered_set<TcpWrap*> wraps;
+};
+
+// A TCP handle and its JavaScript object
+//
+// The object is held strongly while the handle is open, because libuv can
+// call back into it at any time; close() releases it. The wrap itself is
+// freed when the handle has closed and no DNS lookup refers to it. As a
+// StreamBase it can also be read and written by a native pipe.
+struct TcpWrap : StreamBase {
+    uv_tcp_t handle;
+    NetBinding* binding;
+    v8::Global<v8::Object> object;
+    bool closing = false;
+    bool closed = false;
+    int pending_lookups = 0;
+    
+    int ReadStart() override;
+    int ReadStop() override;
+    int Write(const uv_buf_t* bufs, size_t count, Listener* listener, void* token) override;
+};
+
+// A queued write and the memory it writes from; native writes name a listener instead
+struct WriteReq {
+    uv_write_t req;
+    TcpWrap* wrap;
+    std::vector<std::shared_ptr<v8::BackingStore>> stores;
+    StreamBase::Listener* listener = nullptr;
+    void* token = nullptr;
+};
+
+// A connect() whose host needs a DNS lookup first
+struct LookupReq {
+    uv_getaddrinfo_t req;
+    TcpWrap* wrap;
+    int port;
+};
+
+struct ConnectReq {
+    uv_connect_t req;
+    TcpWrap* wrap;
+};
+
+struct ShutdownReq {
+    uv_shutdown_t req;
+    TcpWrap* wrap;
+};
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Get the stream behind a wrap
+static uv_stream_t* Stream(TcpWrap* wrap) {
+    return reinterpret_cast<uv_stream_t*>(&wrap->handle);
+}
+
+// Let the loop register watchers started outside of its own callbacks
+static void WakeLoop(TcpWrap* wrap) {
+    wrap->binding->runtime->GetEventLoop()->Wake();
+}
+
+// Free a wrap once neither libuv nor a lookup refers to it
+static void MaybeDeleteWrap(TcpWrap* wrap) {
+    if (wrap->closed && wrap->pending_lookups == 0) {
+        delete wrap;
+    }
+}
+
+// Call one of the setup() callbacks with the handle as this
+static void MakeCallback(TcpWrap* wrap, const v8::Global<v8::Function>& callback,
+                         int argc, v8::Local<v8::Value>* argv) {
+    NetBinding* binding = wrap->binding;
+    if (callback.IsEmpty() || wrap->object.IsEmpty()) {
+        return;
+    }
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = binding->context.Get(isolate);
+    v8::Context::Scope context_scope(context);
+    
+    v8::TryCatch try_catch(isolate);
+    v8::Local<v8::Function> function = callback.Get(isolate);
+    if (function->Call(context, wrap->object.Get(isolate), argc, argv).IsEmpty() && try_catch.HasCaught()) {
+        v8::String::Utf8Value error(isolate, try_catch.Exception());
+        std::cerr << "Uncaught exception in net callback: " << *error << std::endl;
+    }
+    
+    // Settle promises resolved by the callback, as after any loop task
+    isolate->PerformMicrotaskCheckpoint();
+}
+
+// Call a callback with a single status argument
+static void MakeStatusCallback(TcpWrap* wrap, const v8::Global<v8::Function>& callback, int status) {
+    v8::Isolate* isolate = wrap->binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, status)};
+    MakeCallback(wrap, callback, 1, argv);
+}
+
+// Create the JavaScript object and libuv handle of a new wrap
+static TcpWrap* NewWrap(NetBinding* binding, v8::Isolate* isolate, v8::Local<v8::Object> object) {
+    TcpWrap* wrap = new TcpWrap();
+    wrap->binding = binding;
+    uv_tcp_init(binding->runtime->GetEventLoop()->GetUvLoop(), &wrap->handle);
+    wrap->handle.data = wrap;
+    wrap->object.Reset(isolate, object);
+    object->SetAlignedPointerInInternalField(0, wrap);
+    object->SetAlignedPointerInInternalField(StreamBase::kStreamBaseField, static_cast<StreamBase*>(wrap));
+    binding->wraps.insert(wrap);
+    return wrap;
+}
+
+// Hand out the unused part of the current slab, starting a new one when it runs low
+static void OnAlloc(uv_handle_t* handle, size_t suggested_size, uv_buf_t* buf) {
+    TcpWrap* wrap = static_cast<TcpWrap*>(handle->data);
+    NetBinding* binding = wrap->binding;
+    if (wrap->GetReadListener()) {
+        wrap->GetReadListener()->OnStreamAlloc(suggested_size, buf);
+        return;
+    }
+    
+    if (binding->slab_data == nullptr || kSlabSize - binding->slab_offset < kMinReadSpace) {
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Context::Scope context_scope(binding->context.Get(isolate));
+        v8::Local<v8::ArrayBuffer> slab = v8::ArrayBuffer::New(isolate, kSlabSize);
+        binding->slab.Reset(isolate, slab);
+        binding->slab_data = static_cast<char*>(slab->Data());
+        binding->slab_offset = 0;
+    }
+    
+    buf->base = binding->slab_data + binding->slab_offset;
+    buf->len = kSlabSize - binding->slab_offset;
+}
+
+// Pass a read to JavaScript as a view of the slab it landed in
+static void OnRead(uv_stream_t* stream, ssize_t nread, const uv_buf_t* buf) {
+    TcpWrap* wrap = static_cast<TcpWrap*>(stream->data);
+    NetBinding* binding = wrap->binding;
+    
+    // A native pipe reads into its own buffers, and gets them back even from empty reads
+    if (wrap->GetReadListener()) {
+        wrap->GetReadListener()->OnStreamRead(nread, *buf);
+        return;
+    }
+    if (nread == 0) {
+        return;
+    }
+    
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Context::Scope context_scope(binding->context.Get(isolate));
+    
+    if (nread < 0) {
+        v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, static_cast<int>(nread)), v8::Undefined(isolate)};
+        MakeCallback(wrap, binding->onread, 2, argv);
+        return;
+    }
+    
+    // The next read starts after this one, 8-byte aligned so views of any type fit
+    size_t offset = binding->slab_offset;
+    binding->slab_offset += (static_cast<size_t>(nread) + 7) & ~static_cast<size_t>(7);
+    v8::Local<v8::Uint8Array> chunk = v8::Uint8Array::New(binding->slab.Get(isolate), offset, nread);
+    
+    v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, static_cast<int>(nread)), chunk};
+    MakeCallback(wrap, binding->onread, 2, argv);
+}
+
+// Report a finished queued write
+static void OnWrite(uv_write_t* req, int status) {
+    WriteReq* write_req = static_cast<WriteReq*>(req->data);
+    TcpWrap* wrap = write_req->wrap;
+    StreamBase::Listener* listener = write_req->listener;
+    void* token = write_req->token;
+    delete write_req;
+    if (listener) {
+        listener->OnStreamWrite(token, status);
+    } else if (wrap->binding) {
+        MakeStatusCallback(wrap, wrap->binding->onwrite, status);
+    }
+}
+
+// Report the end of a shutdown
+static void OnShutdown(uv_shutdown_t* req, int status) {
+    ShutdownReq* shutdown_req = static_cast<ShutdownReq*>(req->data);
+    TcpWrap* wrap = shutdown_req->wrap;
+    delete shutdown_req;
+    if (wrap->binding) {
+        MakeStatusCallback(wrap, wrap->binding->onshutdown, status);
+    }
+}
+
+// Report the outcome of a connect
+static void OnConnect(uv_connect_t* req, int status) {
+    ConnectReq* connect_req = static_cast<ConnectReq*>(req->data);
+    TcpWrap* wrap = connect_req->wrap;
+    delete connect_req;
+    if (wrap->binding) {
+        MakeStatusCallback(wrap, wrap->binding->onconnect, status);
+    }
+}
+
+// Free a handle, telling JavaScript first unless the runtime is going away
+static void OnClose(uv_handle_t* handle) {
+    TcpWrap* wrap = static_cast<TcpWrap*>(handle->data);
+    wrap->closed = true;
+    NetBinding* binding = wrap->binding;
+    if (binding) {
+        MakeCallback(wrap, binding->onclose, 0, nullptr);
+        
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Local<v8::Object> object = wrap->object.Get(isolate);
+        object->SetAlignedPointerInInternalField(0, nullptr);
+        object->SetAlignedPointerInInternalField(StreamBase::kStreamBaseField, nullptr);
+        wrap->object.Reset();
+        binding->wraps.erase(wrap);
+    }
+    MaybeDeleteWrap(wrap);
+}
+
+// Start a connect to a resolved address
+static int StartConnect(TcpWrap* wrap, const sockaddr* address) {
+    ConnectReq* connect_req = new ConnectReq();
+    connect_req->wrap = wrap;
+    connect_req->req.data = connect_req;
+    int err = uv_tcp_connect(&connect_req->req, &wrap->handle, address, OnConnect);
+    if (err != 0) {
+        delete connect_req;
+    }
+    return err;
+}
+
+// Connect to the first address of a lookup, preferring IPv4 like the default resolver order
+static void OnLookup(uv_getaddrinfo_t* req, int status, struct addrinfo* result) {
+    LookupReq* lookup_req = static_cast<LookupReq*>(req->data);
+    TcpWrap* wrap = lookup_req->wrap;
+    int port = lookup_req->port;
+    delete lookup_req;
+    wrap->pending_lookups--;
+    
+    if (wrap->binding && !wrap->closing) {
+        if (status == 0) {
+            struct addrinfo* chosen = result;
+            for (struct addrinfo* entry = result; entry != nullptr; entry = entry->ai_next) {
+                if (entry->ai_family == AF_INET) {
+                    chosen = entry;
+                    break;
+                }
+            }
+            sockaddr_storage address;
+            std::memcpy(&address, chosen->ai_addr, chosen->ai_addrlen);
+            if (address.ss_family == AF_INET) {
+                reinterpret_cast<sockaddr_in*>(&address)->sin_port = htons(static_cast<uint16_t>(port));
+            } else {
+                reinterpret_cast<sockaddr_in6*>(&address)->sin6_port = htons(static_cast<uint16_t>(port));
+            }
+            status = StartConnect(wrap, reinterpret_cast<const sockaddr*>(&address));
+        }
+        if (status != 0) {
+            MakeStatusCallback(wrap, wrap->binding->onconnect, status);
+        }
+    }
+    
+    uv_freeaddrinfo(result);
+    MaybeDeleteWrap(wrap);
+}
+
+// Accept a connection into a new handle object
+static void OnConnection(uv_stream_t* server, int status) {
+    TcpWrap* wrap = static_cast<TcpWrap*>(server->data);
+    NetBinding* binding = wrap->binding;
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = binding->context.Get(isolate);
+    v8::Context::Scope context_scope(context);
+    
+    if (status < 0) {
+        v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, status), v8::Undefined(isolate)};
+        MakeCallback(wrap, binding->onconnection, 2, argv);
+        return;
+    }
+    
+    v8::Local<v8::Object> object;
+    if (!binding->tcp_constructor.Get(isolate)->NewInstance(context).ToLocal(&object)) {
+        return;
+    }
+    TcpWrap* client = NewWrap(binding, isolate, object);
+    int err = uv_accept(server, Stream(client));
+    if (err != 0) {
+        client->closing = true;
+        uv_close(reinterpret_cast<uv_handle_t*>(&client->handle), OnClose);
+        v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, err), v8::Undefined(isolate)};
+        MakeCallback(wrap, binding->onconnection, 2, argv);
+        return;
+    }
+    
+    v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, 0), object};
+    MakeCallback(wrap, binding->onconnection, 2, argv);
+}
+
+// Get the wrap behind a handle object; closing handles report UV_EBADF
+static TcpWrap* UnwrapTcp(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = nullptr;
+    if (args.This()->InternalFieldCount() >= 1) {
+        wrap = static_cast<TcpWrap*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!wrap) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    if (wrap->closing) {
+        args.GetReturnValue().Set(UV_EBADF);
+        return nullptr;
+    }
+    return wrap;
+}
+
+// Parse an IP literal and port into a socket address
+static int ParseAddress(v8::Isolate* isolate, v8::Local<v8::Value> host, int port, sockaddr_storage* address) {
+    v8::String::Utf8Value ip(isolate, host);
+    if (uv_ip4_addr(*ip, port, reinterpret_cast<sockaddr_in*>(address)) == 0) {
+        return 0;
+    }
+    return uv_ip6_addr(*ip, port, reinterpret_cast<sockaddr_in6*>(address));
+}
+
+// Read a port argument
+static bool ReadPort(v8::Local<v8::Context> context, v8::Local<v8::Value> value, int* port) {
+    if (!value->IsNumber()) {
+        return false;
+    }
+    *port = value->Int32Value(context).FromJust();
+    return *port >= 0 && *port <= 65535;
+}
+
+// Constructor behind handle objects
+static void TcpConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    if (!args.IsConstructCall()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    NetBinding* binding = static_cast<NetBinding*>(args.Data().As<v8::External>()->Value());
+    NewWrap(binding, isolate, args.This());
+}
+
+// handle.bind(ip, port)
+static void TcpBind(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    int port;
+    if (!args[0]->IsString() || !ReadPort(isolate->GetCurrentContext(), args[1], &port)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    sockaddr_storage address;
+    int err = ParseAddress(isolate, args[0], port, &address);
+    if (err == 0) {
+        err = uv_tcp_bind(&wrap->handle, reinterpret_cast<const sockaddr*>(&address), 0);
+    }
+    args.GetReturnValue().Set(err);
+}
+
+// handle.listen(backlog)
+static void TcpListen(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    int backlog = args[0]->IsNumber() ? args[0]->Int32Value(isolate->GetCurrentContext()).FromJust() : 511;
+    int err = uv_listen(Stream(wrap), backlog, OnConnection);
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(err);
+}
+
+// handle.connect(host, port), resolving host names on the libuv thread pool
+static void TcpConnect(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    int port;
+    if (!args[0]->IsString() || !ReadPort(isolate->GetCurrentContext(), args[1], &port)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    int err;
+    sockaddr_storage address;
+    if (ParseAddress(isolate, args[0], port, &address) == 0) {
+        err = StartConnect(wrap, reinterpret_cast<const sockaddr*>(&address));
+    } else {
+        LookupReq* lookup_req = new LookupReq();
+        lookup_req->wrap = wrap;
+        lookup_req->port = port;
+        lookup_req->req.data = lookup_req;
+        
+        struct addrinfo hints;
+        std::memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        v8::String::Utf8Value host(isolate, args[0]);
+        err = uv_getaddrinfo(wrap->handle.loop, &lookup_req->req, OnLookup, *host, nullptr, &hints);
+        if (err == 0) {
+            wrap->pending_lookups++;
+        } else {
+            delete lookup_req;
+        }
+    }
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(err);
+}
+
+// handle.readStart()
+static void TcpReadStart(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    int err = uv_read_start(Stream(wrap), OnAlloc, OnRead);
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(err);
+}
+
+// handle.readStop()
+static void TcpReadStop(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    args.GetReturnValue().Set(uv_read_stop(Stream(wrap)));
+}
+
+// Write what the socket takes at once, advancing *first and bufs[*first] past it
+//
+// Returns 0 when everything went out, 1 when the rest has to be queued, or a
+// negative libuv error.
+static int TryWriteAll(TcpWrap* wrap, uv_buf_t* bufs, size_t count, size_t total, size_t* first) {
+    // Most writes to a healthy socket complete here without a request or a loop round trip
+    int written = count > 0 ? uv_try_write(Stream(wrap), bufs, static_cast<unsigned int>(count)) : 0;
+    if (written == UV_EAGAIN || written == UV_ENOSYS) {
+        written = 0;
+    } else if (written < 0) {
+        return written;
+    }
+    if (static_cast<size_t>(written) == total) {
+        return 0;
+    }
+    
+    // Skip what went out
+    *first = 0;
+    size_t skip = static_cast<size_t>(written);
+    while (skip >= bufs[*first].len) {
+        skip -= bufs[*first].len;
+        (*first)++;
+    }
+    bufs[*first].base += skip;
+    bufs[*first].len -= skip;
+    return 1;
+}
+
+// handle.writev(chunks): write now if the socket takes it all, queue the rest otherwise
+static void TcpWritev(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    if (!args[0]->IsArray()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Array> chunks = args[0].As<v8::Array>();
+    uint32_t count = chunks->Length();
+    
+    uv_buf_t stack_bufs[kStackBufs];
+    std::vector<uv_buf_t> heap_bufs;
+    uv_buf_t* bufs = stack_bufs;
+    if (count > kStackBufs) {
+        heap_bufs.resize(count);
+        bufs = heap_bufs.data();
+    }
+    
+    size_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        v8::Local<v8::Value> chunk;
+        if (!chunks->Get(context, i).ToLocal(&chunk) || !chunk->IsArrayBufferView()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        v8::Local<v8::ArrayBufferView> view = chunk.As<v8::ArrayBufferView>();
+        char* data = static_cast<char*>(view->Buffer()->Data());
+        bufs[i] = uv_buf_init(data ? data + view->ByteOffset() : nullptr,
+                              static_cast<unsigned int>(view->ByteLength()));
+        total += view->ByteLength();
+    }
+    
+    size_t first = 0;
+    int result = TryWriteAll(wrap, bufs, count, total, &first);
+    if (result != 1) {
+        args.GetReturnValue().Set(result);
+        return;
+    }
+    
+    // Queue the remainder, keeping its memory alive
+    WriteReq* write_req = new WriteReq();
+    write_req->wrap = wrap;
+    write_req->req.data = write_req;
+    write_req->stores.reserve(count - first);
+    for (uint32_t i = static_cast<uint32_t>(first); i < count; i++) {
+        v8::Local<v8::Value> chunk = chunks->Get(context, i).ToLocalChecked();
+        write_req->stores.push_back(chunk.As<v8::ArrayBufferView>()->Buffer()->GetBackingStore());
+    }
+    int err = uv_write(&write_req->req, Stream(wrap), bufs + first, static_cast<unsigned int>(count - first), OnWrite);
+    if (err != 0) {
+        delete write_req;
+        args.GetReturnValue().Set(err);
+        return;
+    }
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(1);
+}
+
+// handle.shutdown()
+static void TcpShutdown(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    ShutdownReq* shutdown_req = new ShutdownReq();
+    shutdown_req->wrap = wrap;
+    shutdown_req->req.data = shutdown_req;
+    int err = uv_shutdown(&shutdown_req->req, Stream(wrap), OnShutdown);
+    if (err != 0) {
+        delete shutdown_req;
+    }
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(err);
+}
+
+// handle.close(); onclose() follows once libuv has released the socket
+static void TcpClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    wrap->closing = true;
+    wrap->NotifyClose();
+    uv_close(reinterpret_cast<uv_handle_t*>(&wrap->handle), OnClose);
+    WakeLoop(wrap);
+    args.GetReturnValue().Set(0);
+}
+
+// handle.setNoDelay(enable)
+static void TcpSetNoDelay(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    bool enable = args[0]->BooleanValue(args.GetIsolate());
+    args.GetReturnValue().Set(uv_tcp_nodelay(&wrap->handle, enable ? 1 : 0));
+}
+
+// handle.setKeepAlive(enable, delaySeconds)
+static void TcpSetKeepAlive(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    bool enable = args[0]->BooleanValue(isolate);
+    unsigned int delay = args[1]->IsNumber() ? args[1]->Uint32Value(isolate->GetCurrentContext()).FromJust() : 0;
+    
+    // Linux rejects a zero idle time, so fall back to a minute like Node.js
+    args.GetReturnValue().Set(uv_tcp_keepalive(&wrap->handle, enable ? 1 : 0, delay > 0 ? delay : 60));
+}
+
+// Store an address as { address, family, port } on an object
+static int FillAddress(v8::Isolate* isolate, v8::Local<v8::Value> target, const sockaddr_storage& address) {
+    if (!target->IsObject()) {
+        return UV_EINVAL;
+    }
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    char ip[INET6_ADDRSTRLEN];
+    int port;
+    v8::Local<v8::String> family;
+    if (address.ss_family == AF_INET6) {
+        const sockaddr_in6* in6 = reinterpret_cast<const sockaddr_in6*>(&address);
+        uv_ip6_name(in6, ip, sizeof(ip));
+        port = ntohs(in6->sin6_port);
+        family = keys.ipv6_string();
+    } else {
+        const sockaddr_in* in = reinterpret_cast<const sockaddr_in*>(&address);
+        uv_ip4_name(in, ip, sizeof(ip));
+        port = ntohs(in->sin_port);
+        family = keys.ipv4_string();
+    }
+    v8::Local<v8::Object> out = target.As<v8::Object>();
+    out->Set(context, keys.address_string(), v8::String::NewFromUtf8(isolate, ip).ToLocalChecked()).Check();
+    out->Set(context, keys.family_string(), family).Check();
+    out->Set(context, keys.port_string(), v8::Integer::New(isolate, port)).Check();
+    return 0;
+}
+
+// handle.getsockname(out)
+static void TcpGetSockName(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    sockaddr_storage address;
+    int length = sizeof(address);
+    int err = uv_tcp_getsockname(&wrap->handle, reinterpret_cast<sockaddr*>(&address), &length);
+    if (err == 0) {
+        err = FillAddress(isolate, args[0], address);
+    }
+    args.GetReturnValue().Set(err);
+}
+
+// handle.getpeername(out)
+static void TcpGetPeerName(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    sockaddr_storage address;
+    int length = sizeof(address);
+    int err = uv_tcp_getpeername(&wrap->handle, reinterpret_cast<sockaddr*>(&address), &length);
+    if (err == 0) {
+        err = FillAddress(isolate, args[0], address);
+    }
+    args.GetReturnValue().Set(err);
+}
+
+// handle.ref()
+static void TcpRef(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (wrap) {
+        uv_ref(reinterpret_cast<uv_handle_t*>(&wrap->handle));
+        WakeLoop(wrap);
+    }
+}
+
+// handle.unref(); an unreferenced handle does not keep the runtime alive
+static void TcpUnref(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (wrap) {
+        uv_unref(reinterpret_cast<uv_handle_t*>(&wrap->handle));
+        WakeLoop(wrap);
+    }
+}
+
+// handle.writeQueueSize()
+static void TcpWriteQueueSize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    TcpWrap* wrap = UnwrapTcp(args);
+    if (!wrap) {
+        return;
+    }
+    args.GetReturnValue().Set(static_cast<double>(wrap->handle.write_queue_size));
+}
+
+// Start reading for a native pipe; reads go to the read listener
+int TcpWrap::ReadStart() {
+    if (closing) {
+        return UV_EBADF;
+    }
+    int err = uv_read_start(Stream(this), OnAlloc, OnRead);
+    WakeLoop(this);
+    return err == UV_EALREADY ? 0 : err;
+}
+
+// Stop reading for a native pipe
+int TcpWrap::ReadStop() {
+    return closing ? 0 : uv_read_stop(Stream(this));
+}
+
+// Write for a native pipe, from memory the listener keeps alive
+int TcpWrap::Write(const uv_buf_t* bufs, size_t count, Listener* listener, void* token) {
+    if (closing) {
+        return UV_EBADF;
+    }
+    std::vector<uv_buf_t> pending(bufs, bufs + count);
+    size_t total = 0;
+    for (const uv_buf_t& buf : pending) {
+        total += buf.len;
+    }
+    
+    size_t first = 0;
+    int result = TryWriteAll(this, pending.data(), count, total, &first);
+    if (result != 1) {
+        return result;
+    }
+    WriteReq* write_req = new WriteReq();
+    write_req->wrap = this;
+    write_req->req.data = write_req;
+    write_req->listener = listener;
+    write_req->token = token;
+    int err = uv_write(&write_req->req, Stream(this), pending.data() + first,
+                       static_cast<unsigned int>(count - first), OnWrite);
+    if (err != 0) {
+        delete write_req;
+        return err;
+    }
+    WakeLoop(this);
+    return 1;
+}
+
+// Native setup function
+static void Setup(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    NetBinding* binding = static_cast<NetBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args[0]->IsObject()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Object> callbacks = args[0].As<v8::Object>();
+    
+    const struct {
+        const char* name;
+        v8::Global<v8::Function>* slot;
+    } kCallbacks[] = {
+        {"onread", &binding->onread},
+        {"onconnection", &binding->onconnection},
+        {"onconnect", &binding->onconnect},
+        {"onwrite", &binding->onwrite},
+        {"onshutdown", &binding->onshutdown},
+        {"onclose", &binding->onclose},
+    };
+    for (const auto& entry : kCallbacks) {
+        v8::Local<v8::Value> value;
+        if (!callbacks->Get(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked()).ToLocal(&value) ||
+            !value->IsFunction()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        entry.slot->Reset(isolate, value.As<v8::Function>());
+    }
+    binding->context.Reset(isolate, context);
+}
+
+// Native isIP function
+static void IsIP(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    int version = 0;
+    if (args[0]->IsString()) {
+        v8::String::Utf8Value input(isolate, args[0]);
+        unsigned char address[sizeof(struct in6_addr)];
+        if (uv_inet_pton(AF_INET, *input, address) == 0) {
+            version = 4;
+        } else if (uv_inet_pton(AF_INET6, *input, address) == 0) {
+            version = 6;
+        }
+    }
+    args.GetReturnValue().Set(version);
+}
+
+// Native errname function
+static void ErrName(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    int err = args[0]->IsNumber() ? args[0]->Int32Value(isolate->GetCurrentContext()).FromJust() : 0;
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, uv_err_name(err)).ToLocalChecked());
+}
+
+// Native strerror function
+static void StrError(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    int err = args[0]->IsNumber() ? args[0]->Int32Value(isolate->GetCurrentContext()).FromJust() : 0;
+    args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, uv_strerror(err)).ToLocalChecked());
+}
+
+// Close every handle when the runtime is destroyed; libuv finishes the closes without V8
+static void CleanupBinding(NetBinding* binding) {
+    for (TcpWrap* wrap : binding->wraps) {
+        wrap->binding = nullptr;
+        wrap->object.Reset();
+        if (!wrap->closing) {
+            wrap->closing = true;
+            wrap->NotifyClose();
+            uv_close(reinterpret_cast<uv_handle_t*>(&wrap->handle), OnClose);
+        }
+    }
+    delete binding;
+}
+
+// Register the internal/net module
+void RegisterNetModule(Runtime* runtime) {
+    std::cout << "RegisterNetModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        NetBinding* binding = new NetBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        
+        // Build the TCP handle class
+        v8::Local<v8::FunctionTemplate> tcp_template = v8::FunctionTemplate::New(isolate, TcpConstructor, data);
+        tcp_template->SetClassName(v8::String::NewFromUtf8(isolate, "TCP").ToLocalChecked());
+        tcp_template->InstanceTemplate()->SetInternalFieldCount(2);
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kMethods[] = {
+            {"bind", TcpBind},
+            {"listen", TcpListen},
+            {"connect", TcpConnect},
+            {"readStart", TcpReadStart},
+            {"readStop", TcpReadStop},
+            {"writev", TcpWritev},
+            {"shutdown", TcpShutdown},
+            {"close", TcpClose},
+            {"setNoDelay", TcpSetNoDelay},
+            {"setKeepAlive", TcpSetKeepAlive},
+            {"getsockname", TcpGetSockName},
+            {"getpeername", TcpGetPeerName},
+            {"ref", TcpRef},
+            {"unref", TcpUnref},
+            {"writeQueueSize", TcpWriteQueueSize},
+        };
+        for (const auto& entry : kMethods) {
+            tcp_template->PrototypeTemplate()->Set(isolate, entry.name,
+                v8::FunctionTemplate::New(isolate, entry.callback));
+        }
+        v8::Local<v8::Function> tcp_constructor = tcp_template->GetFunction(context).ToLocalChecked();
+        binding->tcp_constructor.Reset(isolate, tcp_constructor);
+        
+        // Create the net module object
+        v8::Local<v8::Object> net = v8::Object::New(isolate);
+        net->Set(context, v8::String::NewFromUtf8(isolate, "TCP").ToLocalChecked(), tcp_constructor).Check();
+        
+        static const struct {
+            const char* name;
+            int value;
+        } kConstants[] = {
+            {"UV_EOF", UV_EOF},
+            {"UV_EAFNOSUPPORT", UV_EAFNOSUPPORT},
+            {"UV_EADDRNOTAVAIL", UV_EADDRNOTAVAIL},
+            {"UV_ECANCELED", UV_ECANCELED},
+            {"UV_ECONNRESET", UV_ECONNRESET},
+        };
+        v8::Local<v8::Object> constants = v8::Object::New(isolate);
+        for (const auto& entry : kConstants) {
+            constants->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Integer::New(isolate, entry.value)).Check();
+        }
+        net->Set(context, v8::String::NewFromUtf8(isolate, "constants").ToLocalChecked(), constants).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"setup", Setup},
+            {"isIP", IsIP},
+            {"errname", ErrName},
+            {"strerror", StrError},
+        };
+        for (const auto& entry : kFunctions) {
+            net->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Function::New(context, entry.callback, data).ToLocalChecked()).Check();
+        }
+        
+        // Register the net module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/net", net);
+        
+        std::cout << "RegisterNetModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterNetModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterNetModule" << std::endl;
+    }
+}
@@ -1,6 +1,7 @@
 #include "process_module.h"
 #include "runtime.h"
 #include "module.h"
+#include "binding_table.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -11,38 +12,87 @@
 
 extern char** environ;
 
+// Per-runtime state of the process module
+struct ProcessBinding {
+    // Command-line arguments, turned into process.argv when it is first read
+    std::vector<std::string> argv;
+};
+
+// process.exit(code): exit the process
+static void ProcessExit(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Get the exit code
+    int exit_code = 0;
+    if (args.Length() > 0 && args[0]->IsNumber()) {
+        exit_code = args[0]->Int32Value(isolate->GetCurrentContext()).FromJust();
+    }
+    
+    std::cout << "Process exit called with code: " << exit_code << std::endl;
+    
+    // Exit the process
+    exit(exit_code);
+}
+
+// process.cwd(): the current working directory
+static void ProcessCwd(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Get the current working directory
+    char cwd[1024];
+    if (getcwd(cwd, sizeof(cwd)) != nullptr) {
+        args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, cwd).ToLocalChecked());
+    } else {
+        args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, "").ToLocalChecked());
+    }
+}
+
+// Build the process.argv array on first access
+static void ArgvGetter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    v8::Isolate* isolate = info.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    ProcessBinding* binding = static_cast<ProcessBinding*>(info.Data().As<v8::External>()->Value());
+    
+    v8::Local<v8::Array> js_argv = v8::Array::New(isolate, static_cast<int>(binding->argv.size()));
+    for (size_t i = 0; i < binding->argv.size(); i++) {
+        js_argv->Set(context, static_cast<uint32_t>(i),
+                     v8::String::NewFromUtf8(isolate, binding->argv[i].c_str()).ToLocalChecked()).Check();
+    }
+    info.GetReturnValue().Set(js_argv);
+}
+
+// Functions of the process module
+static constexpr NativeMethod kProcessMethods[] = {
+    {"exit", ProcessExit, 1},
+    {"cwd", ProcessCwd, 0, v8::None, v8::SideEffectType::kHasNoSideEffect},
+};
+static const BindingTableRegistration kProcessRegistration(kProcessMethods);
+
 // Register the process module
 void RegisterProcessModule(Runtime* runtime, int argc, char* argv[]) {
     std::cout << "RegisterProcessModule: Starting..." << std::endl;
     
     try {
         v8::Isolate* isolate = runtime->GetIsolate();
-        std::cout << "RegisterProcessModule: Got isolate" << std::endl;
         
         // Create a handle scope
         v8::HandleScope scope(isolate);
-        std::cout << "RegisterProcessModule: Created handle scope" << std::endl;
         
-        // Create a new context for module initialization
-        v8::Local<v8::Context> context = v8::Context::New(isolate);
-        v8::Context::Scope context_scope(context);
-        std::cout << "RegisterProcessModule: Created and entered context" << std::endl;
+        ProcessBinding* binding = new ProcessBinding();
+        binding->argv.assign(argv, argv + argc);
+        runtime->AddCleanupHook([binding]() { delete binding; });
         
-        // Create the process module object
-        v8::Local<v8::Object> process = v8::Object::New(isolate);
-        std::cout << "RegisterProcessModule: Created process object" << std::endl;
+        // Build the process module template from its table
+        v8::Local<v8::ObjectTemplate> process = NewBindingTemplate(isolate, kProcessMethods);
         
         // Add the argv array
-        std::cout << "RegisterProcessModule: Adding argv..." << std::endl;
-        v8::Local<v8::Array> js_argv = v8::Array::New(isolate, argc);
-        for (int i = 0; i < argc; i++) {
-            js_argv->Set(context, i, v8::String::NewFromUtf8(isolate, argv[i]).ToLocalChecked()).Check();
-        }
-        process->Set(context, v8::String::NewFromUtf8(isolate, "argv").ToLocalChecked(), js_argv).Check();
+        process->SetLazyDataProperty(v8::String::NewFromUtf8Literal(isolate, "argv"), ArgvGetter,
+                                     v8::External::New(isolate, binding));
         
         // Add the env object
-        std::cout << "RegisterProcessModule: Adding env..." << std::endl;
-        v8::Local<v8::Object> env = v8::Object::New(isolate);
+        v8::Local<v8::ObjectTemplate> env = v8::ObjectTemplate::New(isolate);
         
         // Get the environment variables
         char** env_vars = environ;
@@ -52,110 +102,35 @@ void RegisterProcessModule(Runtime* runtime, int argc, char* argv[]) {
             if (pos != std::string::npos) {
                 std::string name = env_var.substr(0, pos);
                 std::string value = env_var.substr(pos + 1);
-                env->Set(context, 
-                    v8::String::NewFromUtf8(isolate, name.c_str()).ToLocalChecked(),
-                    v8::String::NewFromUtf8(isolate, value.c_str()).ToLocalChecked()
-                ).Check();
+                env->Set(v8::String::NewFromUtf8(isolate, name.c_str()).ToLocalChecked(),
+                         v8::String::NewFromUtf8(isolate, value.c_str()).ToLocalChecked());
             }
             env_vars++;
         }
-        process->Set(context, v8::String::NewFromUtf8(isolate, "env").ToLocalChecked(), env).Check();
+        process->Set(isolate, "env", env);
         
         // Add version information
-        std::cout << "RegisterProcessModule: Adding version info..." << std::endl;
-        process->Set(context, 
-            v8::String::NewFromUtf8(isolate, "version").ToLocalChecked(),
-            v8::String::NewFromUtf8(isolate, "1.0.0").ToLocalChecked()
-        ).Check();
+        process->Set(isolate, "version", v8::String::NewFromUtf8Literal(isolate, "1.0.0"));
         
         // Create version object similar to Node.js
-        v8::Local<v8::Object> versions = v8::Object::New(isolate);
-        versions->Set(context,
-            v8::String::NewFromUtf8(isolate, "tiny_node").ToLocalChecked(),
-            v8::String::NewFromUtf8(isolate, "1.0.0").ToLocalChecked()
-        ).Check();
-        
-        // Add V8 version
-        versions->Set(context,
-            v8::String::NewFromUtf8(isolate, "v8").ToLocalChecked(),
-            v8::String::NewFromUtf8(isolate, v8::V8::GetVersion()).ToLocalChecked()
-        ).Check();
-        
-        process->Set(context, 
-            v8::String::NewFromUtf8(isolate, "versions").ToLocalChecked(), 
-            versions
-        ).Check();
+        v8::Local<v8::ObjectTemplate> versions = v8::ObjectTemplate::New(isolate);
+        versions->Set(isolate, "tiny_node", v8::String::NewFromUtf8Literal(isolate, "1.0.0"));
+        versions->Set(isolate, "v8", v8::String::NewFromUtf8(isolate, v8::V8::GetVersion()).ToLocalChecked());
+        process->Set(isolate, "versions", versions);
         
         // Add platform information
-        std::cout << "RegisterProcessModule: Adding platform info..." << std::endl;
         struct utsname system_info;
         if (uname(&system_info) == 0) {
-            process->Set(context, 
-                v8::String::NewFromUtf8(isolate, "platform").ToLocalChecked(),
-                v8::String::NewFromUtf8(isolate, system_info.sysname).ToLocalChecked()
-            ).Check();
-            
-            process->Set(context, 
-                v8::String::NewFromUtf8(isolate, "arch").ToLocalChecked(),
-                v8::String::NewFromUtf8(isolate, system_info.machine).ToLocalChecked()
-            ).Check();
+            process->Set(isolate, "platform", v8::String::NewFromUtf8(isolate, system_info.sysname).ToLocalChecked());
+            process->Set(isolate, "arch", v8::String::NewFromUtf8(isolate, system_info.machine).ToLocalChecked());
         } else {
-            process->Set(context, 
-                v8::String::NewFromUtf8(isolate, "platform").ToLocalChecked(),
-                v8::String::NewFromUtf8(isolate, "unknown").ToLocalChecked()
-            ).Check();
-            
-            process->Set(context, 
-                v8::String::NewFromUtf8(isolate, "arch").ToLocalChecked(),
-                v8::String::NewFromUtf8(isolate, "unknown").ToLocalChecked()
-            ).Check();
+            process->Set(isolate, "platform", v8::String::NewFromUtf8Literal(isolate, "unknown"));
+            process->Set(isolate, "arch", v8::String::NewFromUtf8Literal(isolate, "unknown"));
         }
         
-        // Add the exit method
-        std::cout << "RegisterProcessModule: Adding exit function..." << std::endl;
-        process->Set(context, 
-            v8::String::NewFromUtf8(isolate, "exit").ToLocalChecked(),
-            v8::Function::New(context, [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                v8::Isolate* isolate = args.GetIsolate();
-                v8::HandleScope scope(isolate);
-                
-                // Get the exit code
-                int exit_code = 0;
-                if (args.Length() > 0 && args[0]->IsNumber()) {
-                    exit_code = args[0]->Int32Value(isolate->GetCurrentContext()).FromJust();
-                }
-                
-                std::cout << "Process exit called with code: " << exit_code << std::endl;
-                
-                // Exit the process
-                exit(exit_code);
-            }).ToLocalChecked()
-        ).Check();
-        
-        // Add the cwd method
-        std::cout << "RegisterProcessModule: Adding cwd function..." << std::endl;
-        process->Set(context, 
-            v8::String::NewFromUtf8(isolate, "cwd").ToLocalChecked(),
-            v8::Function::New(context, [](const v8::FunctionCallbackInfo<v8::Value>& args) {
-                v8::Isolate* isolate = args.GetIsolate();
-                v8::HandleScope scope(isolate);
-                
-                // Get the current working directory
-                char cwd[1024];
-                if (getcwd(cwd, sizeof(cwd)) != nullptr) {
-                    args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, cwd).ToLocalChecked());
-                } else {
-                    args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, "").ToLocalChecked());
-                }
-            }).ToLocalChecked()
-        ).Check();
-        
-        // Register the process module as a global object
-        std::cout << "RegisterProcessModule: Registering as global object..." << std::endl;
+        // Register the process module; CreateContext() also installs it as a global
         runtime->GetModuleSystem()->RegisterNativeModule("process", process);
         
-        // We don't need to add it to the global object here, that will be handled in CreateContext
-        
         std::cout << "RegisterProcessModule: Complete" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Exception in RegisterProcessModule: " << e.what() << std::endl;
@@ -0,0 +1,22 @@
+#include "property_keys.h"
+#include "runtime.h"
+
+// Internalize every key once
+PropertyKeys::PropertyKeys(v8::Isolate* isolate) : isolate_(isolate) {
+#define V(accessor, value)                                                     \
+    accessor##_string_.Set(isolate, v8::String::NewFromUtf8Literal(            \
+        isolate, value, v8::NewStringType::kInternalized));
+    PROPERTY_KEY_STRINGS(V)
+#undef V
+    
+#define V(accessor, value)                                                     \
+    accessor##_private_symbol_.Set(isolate, v8::Private::New(                  \
+        isolate, v8::String::NewFromUtf8Literal(isolate, value)));
+    PROPERTY_KEY_PRIVATE_SYMBOLS(V)
+#undef V
+}
+
+// Get the keys of the runtime in the isolate's data slot
+const PropertyKeys& PropertyKeys::Get(v8::Isolate* isolate) {
+    return static_cast<Runtime*>(isolate->GetData(0))->GetPropertyKeys();
+}
@@ -1,16 +1,68 @@
 #include "runtime.h"
+#include "async.h"
 #include "event_loop.h"
 #include "module.h"
+#include "property_keys.h"
+#include "binding_table.h"
 #include "fs_module.h"
 #include "http_module.h"
+#include "process_module.h"
+#include "sharedbuffer_module.h"
+#include "v8_module.h"
+#include "cache_module.h"
+#include "kv_module.h"
+#include "buffer_module.h"
+#include "encoding_module.h"
+#include "hash_module.h"
+#include "zlib_module.h"
+#include "net_module.h"
+#include "dgram_module.h"
+#include "util_module.h"
+#include "vm_module.h"
+#include "workerpool_module.h"
+#include "wasm_module.h"
+#include "scheduler_module.h"
+#include "stream_module.h"
+#include "inspect.h"
+#include "thread_pool.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <functional>
+#include <mutex>
+
+// Globals backed by built-in JavaScript modules, loaded on first access
+struct LazyGlobal {
+    const char* name;
+    const char* module_id;
+};
+
+static const LazyGlobal kLazyGlobals[] = {
+    { "Buffer", "buffer" },
+    { "TextEncoder", "util" },
+    { "TextDecoder", "util" },
+    { "scheduler", "scheduler" },
+};
 
 // Initialize static members
 std::unique_ptr<v8::Platform> Runtime::platform_ = nullptr;
 
+// Guards the one-time V8 initialization when runtimes start on several threads
+static std::mutex platform_mutex;
+
+// Run a setTimeout callback once its delay has passed
+//
+// Cancelling the timer destroys the coroutine, and the callback's handle
+// with it.
+static AsyncTask RunTimeout(v8::Isolate* isolate, v8::Global<v8::Function> callback,
+                            uint64_t delay_ms, uint64_t* task_id) {
+    co_await Sleep(delay_ms, task_id);
+    
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    // The callback's result is unused, and an exception it throws ends the task
+    callback.Get(isolate)->Call(context, context->Global(), 0, nullptr).IsEmpty();
+}
+
 // Native setTimeout function
 void SetTimeout(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* isolate = args.GetIsolate();
@@ -29,39 +81,9 @@ void SetTimeout(const v8::FunctionCallbackInfo<v8::Value>& args) {
     // Get the delay
     uint64_t delay_ms = args[1]->IntegerValue(isolate->GetCurrentContext()).FromJust();
     
-    // Get the runtime from the external data
-    Runtime* runtime = static_cast<Runtime*>(isolate->GetData(0));
-    
-    // Create a persistent handle to the callback
-    v8::Global<v8::Function>* persistent_callback = new v8::Global<v8::Function>(isolate, callback);
-    
-    // Store the current context in a persistent handle
-    v8::Global<v8::Context>* persistent_context = new v8::Global<v8::Context>(isolate, isolate->GetCurrentContext());
-    
-    // Schedule the task
-    uint64_t task_id = runtime->ScheduleDelayedTask([isolate, persistent_context, persistent_callback]() {
-        v8::HandleScope handle_scope(isolate);
-        
-        // Use the stored context
-        v8::Local<v8::Context> context = v8::Local<v8::Context>::New(isolate, *persistent_context);
-        v8::Context::Scope context_scope(context);
-        
-        v8::Local<v8::Function> callback = v8::Local<v8::Function>::New(isolate, *persistent_callback);
-        v8::Local<v8::Value> result;
-        v8::MaybeLocal<v8::Value> maybe_result = callback->Call(context, context->Global(), 0, nullptr);
-        if (!maybe_result.IsEmpty()) {
-            bool success = maybe_result.ToLocal(&result);
-            if (!success) {
-                std::cerr << "Failed to convert MaybeLocal to Local in SetTimeout callback" << std::endl;
-            }
-        }
-        
-        // Release the persistent handles
-        persistent_callback->Reset();
-        delete persistent_callback;
-        persistent_context->Reset();
-        delete persistent_context;
-    }, delay_ms);
+    // Schedule the callback; the timer ID is known once the coroutine is asleep
+    uint64_t task_id = 0;
+    RunTimeout(isolate, v8::Global<v8::Function>(isolate, callback), delay_ms, &task_id);
     
     // Return the task ID
     args.GetReturnValue().Set(v8::Number::New(isolate, task_id));
@@ -96,20 +118,26 @@ static void Print(const v8::FunctionCallbackInfo<v8::Value>& args) {
     v8::Isolate* isolate = args.GetIsolate();
     v8::HandleScope scope(isolate);
     
-    for (int i = 0; i < args.Length(); i++) {
-        v8::String::Utf8Value str(isolate, args[i]);
-        std::cout << *str;
-        if (i < args.Length() - 1) {
-            std::cout << " ";
-        }
+    // Arguments are rendered like util.format() into the reused buffer
+    InspectBuffer buffer;
+    std::string* line = buffer.Get();
+    if (!FormatValues(isolate->GetCurrentContext(), args, line)) {
+        return;
     }
-    std::cout << std::endl;
+    line->push_back('\n');
+    std::cout.write(line->data(), line->size());
+    std::cout.flush();
     
     args.GetReturnValue().SetUndefined();
 }
 
 // Initialize the runtime
 bool Runtime::Initialize() {
+    std::lock_guard<std::mutex> lock(platform_mutex);
+    if (platform_) {
+        return true;
+    }
+    
     std::cout << "Initializing V8..." << std::endl;
     
     // Initialize V8 with the correct parameters for the custom build
@@ -152,23 +180,33 @@ void Runtime::Shutdown() {
 }
 
 // Constructor
-Runtime::Runtime() : isolate_(nullptr) {
+Runtime::Runtime(const RuntimeOptions& options) : isolate_(nullptr), options_(options), pending_work_(0) {
     std::cout << "Runtime constructor: Creating isolate..." << std::endl;
     
     // Create the isolate
     v8::Isolate::CreateParams create_params;
     create_params.array_buffer_allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+    create_params.external_references = GetBindingExternalReferences();
     isolate_ = v8::Isolate::New(create_params);
     
+    // Blocking Atomics.wait is only allowed where stalling the thread is acceptable
+    isolate_->SetAllowAtomicsWait(options_.allow_atomics_wait);
+    
     std::cout << "Runtime constructor: Isolate created" << std::endl;
     
     // Store this runtime instance in the isolate's data slot
     isolate_->SetData(0, this);
     
+    // Lock the isolate; the event loop and embedder threads take the same lock
+    v8::Locker locker(isolate_);
+    
     // Create a handle scope
     v8::Isolate::Scope isolate_scope(isolate_);
     v8::HandleScope handle_scope(isolate_);
     
+    // Intern the property keys before any binding needs them
+    property_keys_ = std::make_unique<PropertyKeys>(isolate_);
+    
     std::cout << "Runtime constructor: Creating global template..." << std::endl;
     
     // Create a global object template
@@ -192,25 +230,59 @@ Runtime::Runtime() : isolate_(nullptr) {
     // Register native modules
     RegisterNativeModules();
     
-    // Temporarily disable event loop creation
     std::cout << "Runtime constructor: Creating event loop..." << std::endl;
     event_loop_ = std::make_unique<EventLoop>(this);
-    event_loop_->Start();
+    event_loop_->SetAffinity(options_.loop_affinity);
+    event_loop_->SetLaneCapacity(TaskLane::kTask, options_.task_queue_capacity);
+    event_loop_->SetLaneCapacity(TaskLane::kCompletion, options_.task_queue_capacity);
+    if (options_.own_loop_thread) {
+        event_loop_->Start();
+    }
+    if (options_.time_slice_ms > 0) {
+        event_loop_->StartTimeSlicing(options_.time_slice_ms);
+    }
     
     std::cout << "Runtime constructor: Complete" << std::endl;
 }
 
 // Destructor
 Runtime::~Runtime() {
+    // Wait for thread pool work that will post back to this runtime, without backpressure
+    if (event_loop_) {
+        event_loop_->CloseQueues();
+    }
+    {
+        std::unique_lock<std::mutex> lock(pending_work_mutex_);
+        pending_work_cv_.wait(lock, [this]() { return pending_work_ == 0; });
+    }
+    
     // Stop the event loop
     if (event_loop_) {
         event_loop_->Stop();
     }
     
-    // Clean up the module system
-    module_system_.reset();
+    {
+        v8::Locker locker(isolate_);
+        v8::Isolate::Scope isolate_scope(isolate_);
+        
+        // Release what tasks and timers that never ran still hold
+        if (event_loop_) {
+            event_loop_->DiscardPendingTasks();
+        }
+        
+        // Let native modules close their handles while V8 is still usable
+        while (!cleanup_hooks_.empty()) {
+            std::function<void()> hook = std::move(cleanup_hooks_.back());
+            cleanup_hooks_.pop_back();
+            hook();
+        }
+        
+        // Clean up the module system
+        module_system_.reset();
+        
+        global_template_.Reset();
+    }
     
-    global_template_.Reset();
     isolate_->Dispose();
 }
 
@@ -227,6 +299,26 @@ std::string Runtime::ReadFile(const std::string& filename) {
     return buffer.str();
 }
 
+// Resolve a lazy global to the export of the same name from its module
+static void LazyGlobalGetter(v8::Local<v8::Name> property,
+                             const v8::PropertyCallbackInfo<v8::Value>& info) {
+    v8::Isolate* isolate = info.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    Runtime* runtime = static_cast<Runtime*>(isolate->GetData(0));
+    v8::String::Utf8Value module_id(isolate, info.Data());
+    v8::Local<v8::Object> exports = runtime->GetModuleSystem()->Require(*module_id);
+    if (exports.IsEmpty()) {
+        return;
+    }
+    
+    v8::Local<v8::Value> value;
+    if (exports->Get(context, property).ToLocal(&value)) {
+        info.GetReturnValue().Set(value);
+    }
+}
+
 // Create a new context
 v8::Local<v8::Context> Runtime::CreateContext() {
     std::cout << "CreateContext: Starting..." << std::endl;
@@ -259,6 +351,16 @@ v8::Local<v8::Context> Runtime::CreateContext() {
             global->Set(context, function_name, function).Check();
         }
         
+        // Install globals that require a built-in module the first time they are read
+        for (const LazyGlobal& lazy : kLazyGlobals) {
+            global->SetLazyDataProperty(
+                context,
+                v8::String::NewFromUtf8(isolate_, lazy.name).ToLocalChecked(),
+                LazyGlobalGetter,
+                v8::String::NewFromUtf8(isolate_, lazy.module_id).ToLocalChecked(),
+                v8::DontEnum).Check();
+        }
+        
         // Add native modules to the global object for direct access
         // This makes 'process' available as a global like in Node.js
         v8::Local<v8::Value> process_value;
@@ -266,7 +368,7 @@ v8::Local<v8::Context> Runtime::CreateContext() {
             std::cout << "CreateContext: Adding process to global object" << std::endl;
             global->Set(
                 context, 
-                v8::String::NewFromUtf8(isolate_, "process").ToLocalChecked(),
+                property_keys_->process_string(),
                 process_value
             ).Check();
         }
@@ -298,6 +400,7 @@ bool Runtime::ExecuteString(const std::string& source, const std::string& source
     std::cout << "ExecuteString: Starting..." << std::endl;
     
     try {
+        v8::Locker locker(isolate_);
         v8::Isolate::Scope isolate_scope(isolate_);
         std::cout << "ExecuteString: Created isolate scope" << std::endl;
         
@@ -370,6 +473,44 @@ bool Runtime::ExecuteString(const std::string& source, const std::string& source
     }
 }
 
+// Submit a script for execution on the event loop
+void Runtime::SubmitScript(const std::string& source, const std::string& source_name,
+                           std::function<void(bool)> done) {
+    ScheduleTask([this, source, source_name, done]() {
+        bool success = ExecuteString(source, source_name);
+        if (done) {
+            done(success);
+        }
+    });
+}
+
+// Pump the event loop from an embedder-owned thread
+size_t Runtime::PumpEventLoop(uint64_t timeout_ms) {
+    if (!event_loop_ || event_loop_->IsRunning()) {
+        return 0;
+    }
+    
+    return event_loop_->RunOnce(timeout_ms);
+}
+
+// Run V8 foreground tasks posted for this isolate
+size_t Runtime::PumpPlatformTasks() {
+    v8::Locker locker(isolate_);
+    v8::Isolate::Scope isolate_scope(isolate_);
+    
+    // These include Atomics.waitAsync resolutions and GC finalization tasks
+    size_t executed = 0;
+    while (v8::platform::PumpMessageLoop(platform_.get(), isolate_)) {
+        executed++;
+    }
+    
+    // Settle promises resolved by those tasks
+    if (executed > 0) {
+        isolate_->PerformMicrotaskCheckpoint();
+    }
+    return executed;
+}
+
 // Register a native function
 void Runtime::RegisterNativeFunction(const std::string& name, v8::FunctionCallback callback) {
     std::cout << "RegisterNativeFunction: Starting for " << name << "..." << std::endl;
@@ -387,6 +528,11 @@ void Runtime::RegisterNativeFunction(const std::string& name, v8::FunctionCallba
     }
 }
 
+// Get the options the runtime was created with
+const RuntimeOptions& Runtime::GetOptions() const {
+    return options_;
+}
+
 // Get the event loop
 EventLoop* Runtime::GetEventLoop() const {
     return event_loop_.get();
@@ -397,6 +543,11 @@ ModuleSystem* Runtime::GetModuleSystem() const {
     return module_system_.get();
 }
 
+// Get the interned property keys
+const PropertyKeys& Runtime::GetPropertyKeys() const {
+    return *property_keys_;
+}
+
 // Get the isolate
 v8::Isolate* Runtime::GetIsolate() const {
     return isolate_;
@@ -424,6 +575,52 @@ void Runtime::CancelDelayedTask(uint64_t task_id) {
     }
 }
 
+// Run work on the thread pool, then continue on the event loop
+void Runtime::QueueWork(std::function<void()> work, std::function<void()> after_work) {
+    // Backpressure applies here, to the submitter, and never to the shared pool thread
+    event_loop_->WaitForRoom(TaskLane::kCompletion);
+    {
+        std::lock_guard<std::mutex> lock(pending_work_mutex_);
+        pending_work_++;
+    }
+    
+    ThreadPool::GetDefault()->Submit([this, work, after_work]() {
+        // after_work still runs so the caller can settle its promise
+        try {
+            work();
+        } catch (const std::exception& e) {
+            std::cerr << "Exception in queued work: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Unknown exception in queued work" << std::endl;
+        }
+        event_loop_->ScheduleCompletion(after_work);
+        
+        {
+            std::lock_guard<std::mutex> lock(pending_work_mutex_);
+            pending_work_--;
+        }
+        pending_work_cv_.notify_all();
+    });
+}
+
+// Check whether anything will still call back into JavaScript
+bool Runtime::HasPendingWork() {
+    // Finished work schedules its callback before it stops counting, so check it first
+    {
+        std::lock_guard<std::mutex> lock(pending_work_mutex_);
+        if (pending_work_ > 0) {
+            return true;
+        }
+    }
+    
+    return event_loop_ && event_loop_->HasPendingTasks();
+}
+
+// Register a function to run when the runtime is destroyed
+void Runtime::AddCleanupHook(std::function<void()> hook) {
+    cleanup_hooks_.push_back(std::move(hook));
+}
+
 // Setup global functions
 void Runtime::SetupGlobalFunctions() {
     // Register the print function
@@ -455,6 +652,67 @@ void Runtime::RegisterNativeModules() {
         std::cout << "RegisterNativeModules: Registering http module..." << std::endl;
         RegisterHttpModule(this);
         
+        // Register the sharedbuffer module
+        std::cout << "RegisterNativeModules: Registering sharedbuffer module..." << std::endl;
+        RegisterSharedBufferModule(this);
+        
+        // Register the v8 module
+        std::cout << "RegisterNativeModules: Registering v8 module..." << std::endl;
+        RegisterV8Module(this);
+        
+        // Register the cache module
+        std::cout << "RegisterNativeModules: Registering cache module..." << std::endl;
+        RegisterCacheModule(this);
+        
+        // Register the kv module
+        std::cout << "RegisterNativeModules: Registering kv module..." << std::endl;
+        RegisterKvModule(this);
+        
+        // Register the buffer module
+        std::cout << "RegisterNativeModules: Registering buffer module..." << std::endl;
+        RegisterBufferModule(this);
+        
+        // Register the encoding module
+        std::cout << "RegisterNativeModules: Registering encoding module..." << std::endl;
+        RegisterEncodingModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering hash module..." << std::endl;
+        RegisterHashModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering zlib module..." << std::endl;
+        RegisterZlibModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering net module..." << std::endl;
+        RegisterNetModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering dgram module..." << std::endl;
+        RegisterDgramModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering util module..." << std::endl;
+        RegisterUtilModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering vm module..." << std::endl;
+        RegisterVmModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering workerpool module..." << std::endl;
+        RegisterWorkerPoolModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering wasm module..." << std::endl;
+        RegisterWasmModule(this);
+        
+        std::cout << "RegisterNativeModules: Registering scheduler module..." << std::endl;
+        RegisterSchedulerModule(this);
+        
+        // Registered after the modules whose handles it pipes, so its cleanup hook runs first
+        std::cout << "RegisterNativeModules: Registering stream module..." << std::endl;
+        RegisterStreamModule(this);
+        
+        // Register the process module when arguments were provided
+        if (options_.argc > 0) {
+            std::cout << "RegisterNativeModules: Registering process module..." << std::endl;
+            RegisterProcessModule(this, options_.argc, options_.argv);
+        }
+        
         std::cout << "RegisterNativeModules: Complete" << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Exception in RegisterNativeModules: " << e.what() << std::endl;
@@ -0,0 +1,105 @@
+#include "scheduler_module.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+#include "binding_table.h"
+#include "async.h"
+#include "property_keys.h"
+#include <iostream>
+
+// Resolve once the event loop has had a turn
+static JsPromise YieldAsync(v8::Isolate* isolate) {
+    co_await YieldToLoop();
+    co_return v8::Undefined(isolate);
+}
+
+// yield(): promise resolved on the next loop iteration
+static void Yield(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(YieldAsync(args.GetIsolate()).GetPromise());
+}
+
+// Describe the depth and backpressure counters of a lane
+static v8::Local<v8::Object> NewLaneStats(v8::Isolate* isolate, const TaskLaneStats& lane) {
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    const struct {
+        v8::Local<v8::String> name;
+        double value;
+    } fields[] = {
+        {keys.capacity_string(), static_cast<double>(lane.capacity)},
+        {keys.depth_string(), static_cast<double>(lane.depth)},
+        {keys.high_water_string(), static_cast<double>(lane.high_water)},
+        {keys.scheduled_string(), static_cast<double>(lane.scheduled)},
+        {keys.rejected_string(), static_cast<double>(lane.rejected)},
+        {keys.waits_string(), static_cast<double>(lane.waits)},
+    };
+    
+    v8::Local<v8::Object> stats = v8::Object::New(isolate);
+    for (const auto& field : fields) {
+        stats->Set(context, field.name, v8::Number::New(isolate, field.value)).Check();
+    }
+    stats->Set(context, keys.paused_string(), v8::Boolean::New(isolate, lane.paused)).Check();
+    return stats;
+}
+
+// stats(): { timeSlice, slices, queues: { task, completion, continuation } }
+static void Stats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    EventLoop* loop = static_cast<Runtime*>(isolate->GetData(0))->GetEventLoop();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    
+    v8::Local<v8::Object> stats = v8::Object::New(isolate);
+    stats->Set(context, keys.time_slice_string(),
+               v8::Number::New(isolate, static_cast<double>(loop->GetTimeSlice()))).Check();
+    stats->Set(context, keys.slices_string(),
+               v8::Number::New(isolate, static_cast<double>(loop->GetTimeSliceCount()))).Check();
+    
+    // Lane names indexed by TaskLane
+    const v8::Local<v8::String> lane_names[kTaskLaneCount] = {
+        keys.task_string(), keys.completion_string(), keys.continuation_string()};
+    v8::Local<v8::Object> queues = v8::Object::New(isolate);
+    for (size_t i = 0; i < kTaskLaneCount; i++) {
+        queues->Set(context, lane_names[i],
+                    NewLaneStats(isolate, loop->GetLaneStats(static_cast<TaskLane>(i)))).Check();
+    }
+    stats->Set(context, keys.queues_string(), queues).Check();
+    args.GetReturnValue().Set(stats);
+}
+
+// shouldYield(): whether loop work has waited a whole time slice for the running code
+static void ShouldYield(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    EventLoop* loop = static_cast<Runtime*>(isolate->GetData(0))->GetEventLoop();
+    args.GetReturnValue().Set(loop->ShouldYield());
+}
+
+// Functions of internal/scheduler
+static constexpr NativeMethod kSchedulerMethods[] = {
+    {"yield", Yield},
+    {"shouldYield", ShouldYield, 0, v8::None, v8::SideEffectType::kHasNoSideEffect},
+    {"stats", Stats, 0, v8::None, v8::SideEffectType::kHasNoSideEffect},
+};
+static const BindingTableRegistration kSchedulerRegistration(kSchedulerMethods);
+
+// Register the scheduler module
+void RegisterSchedulerModule(Runtime* runtime) {
+    std::cout << "RegisterSchedulerModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Register the binding; lib/scheduler.js builds the scheduler global on top of it
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/scheduler",
+                                                         NewBindingTemplate(isolate, kSchedulerMethods));
+        
+        std::cout << "RegisterSchedulerModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterSchedulerModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterSchedulerModule" << std::endl;
+    }
+}
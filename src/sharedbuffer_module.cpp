@@ -0,0 +1,167 @@
+#include "sharedbuffer_module.h"
+#include "runtime.h"
+#include "module.h"
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+
+// Process-wide registry of shared backing stores, visible to every runtime
+static std::unordered_map<std::string, std::shared_ptr<v8::BackingStore>> shared_buffers;
+static std::mutex shared_buffers_mutex;
+
+// Publish a backing store under a name
+bool PublishSharedBuffer(const std::string& name, std::shared_ptr<v8::BackingStore> backing_store) {
+    std::lock_guard<std::mutex> lock(shared_buffers_mutex);
+    return shared_buffers.emplace(name, std::move(backing_store)).second;
+}
+
+// Find a published backing store
+std::shared_ptr<v8::BackingStore> FindSharedBuffer(const std::string& name) {
+    std::lock_guard<std::mutex> lock(shared_buffers_mutex);
+    auto it = shared_buffers.find(name);
+    return it != shared_buffers.end() ? it->second : nullptr;
+}
+
+// Remove a name from the registry
+bool UnlinkSharedBuffer(const std::string& name) {
+    std::lock_guard<std::mutex> lock(shared_buffers_mutex);
+    return shared_buffers.erase(name) > 0;
+}
+
+// Native create function
+static void Create(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Check arguments
+    if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsNumber()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value name(isolate, args[0]);
+    int64_t byte_length = args[1]->IntegerValue(isolate->GetCurrentContext()).FromJust();
+    if (byte_length < 0) {
+        isolate->ThrowException(v8::Exception::RangeError(
+            v8::String::NewFromUtf8(isolate, "Invalid byte length").ToLocalChecked()));
+        return;
+    }
+    
+    // Allocate zero-initialized shared memory outside the V8 heap
+    std::shared_ptr<v8::BackingStore> backing_store =
+        v8::SharedArrayBuffer::NewBackingStore(isolate, static_cast<size_t>(byte_length));
+    
+    if (!PublishSharedBuffer(*name, backing_store)) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Shared buffer name already in use").ToLocalChecked()));
+        return;
+    }
+    
+    args.GetReturnValue().Set(v8::SharedArrayBuffer::New(isolate, backing_store));
+}
+
+// Native publish function
+static void Publish(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Check arguments
+    if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsSharedArrayBuffer()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value name(isolate, args[0]);
+    v8::Local<v8::SharedArrayBuffer> buffer = args[1].As<v8::SharedArrayBuffer>();
+    
+    if (!PublishSharedBuffer(*name, buffer->GetBackingStore())) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Shared buffer name already in use").ToLocalChecked()));
+        return;
+    }
+    
+    args.GetReturnValue().Set(buffer);
+}
+
+// Native open function
+static void Open(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Check arguments
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value name(isolate, args[0]);
+    std::shared_ptr<v8::BackingStore> backing_store = FindSharedBuffer(*name);
+    if (!backing_store) {
+        args.GetReturnValue().SetUndefined();
+        return;
+    }
+    
+    // A new SharedArrayBuffer object in this isolate over the same memory
+    args.GetReturnValue().Set(v8::SharedArrayBuffer::New(isolate, backing_store));
+}
+
+// Native unlink function
+static void Unlink(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    // Check arguments
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value name(isolate, args[0]);
+    args.GetReturnValue().Set(v8::Boolean::New(isolate, UnlinkSharedBuffer(*name)));
+}
+
+// Register the sharedbuffer module
+void RegisterSharedBufferModule(Runtime* runtime) {
+    std::cout << "RegisterSharedBufferModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the sharedbuffer module object
+        v8::Local<v8::Object> sharedbuffer = v8::Object::New(isolate);
+        
+        // Add the module functions
+        sharedbuffer->Set(context,
+            v8::String::NewFromUtf8(isolate, "create").ToLocalChecked(),
+            v8::Function::New(context, Create).ToLocalChecked()).Check();
+        sharedbuffer->Set(context,
+            v8::String::NewFromUtf8(isolate, "publish").ToLocalChecked(),
+            v8::Function::New(context, Publish).ToLocalChecked()).Check();
+        sharedbuffer->Set(context,
+            v8::String::NewFromUtf8(isolate, "open").ToLocalChecked(),
+            v8::Function::New(context, Open).ToLocalChecked()).Check();
+        sharedbuffer->Set(context,
+            v8::String::NewFromUtf8(isolate, "unlink").ToLocalChecked(),
+            v8::Function::New(context, Unlink).ToLocalChecked()).Check();
+        
+        // Register the sharedbuffer module
+        runtime->GetModuleSystem()->RegisterNativeModule("sharedbuffer", sharedbuffer);
+        
+        std::cout << "RegisterSharedBufferModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterSharedBufferModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterSharedBufferModule" << std::endl;
+    }
+}
@@ -0,0 +1,592 @@
+#include "stream_module.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+#include "property_keys.h"
+#include "stream_base.h"
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+// Size of the buffers a native pipe reads into
+static constexpr size_t kPipeBufferSize = 64 * 1024;
+
+// Queued chunks a BufferList lets its array's head move past before compacting it
+static constexpr uint32_t kCompactThreshold = 1024;
+
+class NativePipe;
+
+// Per-runtime state of internal/stream
+struct StreamBinding {
+    Runtime* runtime = nullptr;
+    
+    // Running pipes, detached by the cleanup hook when the runtime goes away
+    std::unordered_set<NativePipe*> pipes;
+};
+
+// The bookkeeping behind one side of a JavaScript stream
+//
+// Chunks are stored in a JavaScript array in internal field 1 of the list
+// object, from index head up to tail, so the garbage collector sees them
+// like any other property. Their sizes are kept here, together with the
+// sizes of chunks taken for a write that has not finished yet.
+struct BufferList {
+    v8::Global<v8::Object> handle;
+    double high_water_mark = 16384;
+    bool object_mode = false;
+    std::deque<size_t> sizes;
+    std::deque<size_t> in_flight;
+    
+    // Size of queued and in-flight chunks together
+    size_t length = 0;
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    bool need_drain = false;
+};
+
+// Moves data between two StreamBase streams without calling into JavaScript
+//
+// Reads land in buffers from the pipe's pool and are written to the sink
+// from the same memory. The pipe lives until it has finished and every
+// read and write still using its buffers has reported back.
+class NativePipe : public StreamBase::Listener {
+public:
+    NativePipe(StreamBinding* binding, StreamBase* source, StreamBase* sink, size_t high_water_mark)
+        : binding_(binding), source_(source), sink_(sink), high_water_mark_(high_water_mark) {}
+    
+    int Start();
+    void Detach();
+    
+    void OnStreamAlloc(size_t suggested_size, uv_buf_t* buf) override;
+    void OnStreamRead(ssize_t nread, const uv_buf_t& buf) override;
+    void OnStreamWrite(void* token, int status) override;
+    void OnStreamClose(StreamBase* stream) override;
+    
+    // Handle objects of the two streams and the completion callback
+    v8::Global<v8::Object> source_object;
+    v8::Global<v8::Object> sink_object;
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> callback;
+
+private:
+    void Recycle(char* buffer);
+    void Finish(int status);
+    void MaybeDelete();
+    
+    StreamBinding* binding_;
+    StreamBase* source_;
+    StreamBase* sink_;
+    size_t high_water_mark_;
+    std::vector<std::unique_ptr<char[]>> buffers_;
+    std::vector<char*> free_buffers_;
+    size_t reads_pending_ = 0;
+    size_t writes_pending_ = 0;
+    bool reading_ = false;
+    bool ended_ = false;
+    bool finished_ = false;
+};
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Attach the pipe to both streams and start reading
+int NativePipe::Start() {
+    source_->SetReadListener(this);
+    sink_->SetWriteListener(this);
+    reading_ = true;
+    int err = source_->ReadStart();
+    if (err != 0) {
+        reading_ = false;
+        source_->SetReadListener(nullptr);
+        sink_->SetWriteListener(nullptr);
+    }
+    return err;
+}
+
+// Stop without calling JavaScript; used when the runtime goes away
+void NativePipe::Detach() {
+    binding_ = nullptr;
+    source_object.Reset();
+    sink_object.Reset();
+    context.Reset();
+    callback.Reset();
+    Finish(UV_ECANCELED);
+}
+
+// Hand out a buffer from the pool, allocating one if all are in use
+void NativePipe::OnStreamAlloc(size_t suggested_size, uv_buf_t* buf) {
+    char* buffer;
+    if (free_buffers_.empty()) {
+        buffers_.push_back(std::make_unique<char[]>(kPipeBufferSize));
+        buffer = buffers_.back().get();
+    } else {
+        buffer = free_buffers_.back();
+        free_buffers_.pop_back();
+    }
+    reads_pending_++;
+    *buf = uv_buf_init(buffer, static_cast<unsigned int>(kPipeBufferSize));
+}
+
+// Write what was read, holding back reads while the sink is behind
+void NativePipe::OnStreamRead(ssize_t nread, const uv_buf_t& buf) {
+    reads_pending_--;
+    if (finished_ || nread <= 0) {
+        Recycle(buf.base);
+        if (finished_) {
+            MaybeDelete();
+        } else if (nread == UV_EOF) {
+            ended_ = true;
+            if (writes_pending_ == 0) {
+                Finish(0);
+            }
+        } else if (nread < 0) {
+            Finish(static_cast<int>(nread));
+        }
+        return;
+    }
+    
+    uv_buf_t data = uv_buf_init(buf.base, static_cast<unsigned int>(nread));
+    int result = sink_->Write(&data, 1, this, buf.base);
+    if (result < 0) {
+        Recycle(buf.base);
+        Finish(result);
+        return;
+    }
+    if (result == 0) {
+        Recycle(buf.base);
+        return;
+    }
+    writes_pending_++;
+    if (writes_pending_ >= high_water_mark_ && reading_) {
+        reading_ = false;
+        source_->ReadStop();
+    }
+}
+
+// Return a written buffer to the pool and resume reading once the sink catches up
+void NativePipe::OnStreamWrite(void* token, int status) {
+    writes_pending_--;
+    Recycle(static_cast<char*>(token));
+    if (finished_) {
+        MaybeDelete();
+        return;
+    }
+    if (status < 0) {
+        Finish(status);
+        return;
+    }
+    if (ended_) {
+        if (writes_pending_ == 0) {
+            Finish(0);
+        }
+        return;
+    }
+    if (!reading_ && writes_pending_ < high_water_mark_) {
+        reading_ = true;
+        int err = source_->ReadStart();
+        if (err != 0) {
+            Finish(err);
+        }
+    }
+}
+
+// Stop when either stream is closed under the pipe
+void NativePipe::OnStreamClose(StreamBase* stream) {
+    if (stream == source_) {
+        source_ = nullptr;
+    }
+    if (stream == sink_) {
+        sink_ = nullptr;
+    }
+    Finish(UV_ECANCELED);
+}
+
+// Put a buffer back on the free list
+void NativePipe::Recycle(char* buffer) {
+    free_buffers_.push_back(buffer);
+}
+
+// Detach from both streams and report the outcome to JavaScript
+void NativePipe::Finish(int status) {
+    if (finished_) {
+        return;
+    }
+    finished_ = true;
+    if (source_) {
+        source_->SetReadListener(nullptr);
+        if (reading_) {
+            source_->ReadStop();
+        }
+        source_ = nullptr;
+    }
+    if (sink_) {
+        sink_->SetWriteListener(nullptr);
+        sink_ = nullptr;
+    }
+    reading_ = false;
+    
+    if (binding_ && !callback.IsEmpty()) {
+        v8::Isolate* isolate = binding_->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        v8::Local<v8::Context> local_context = context.Get(isolate);
+        v8::Context::Scope context_scope(local_context);
+        v8::Local<v8::Function> function = callback.Get(isolate);
+        callback.Reset();
+        source_object.Reset();
+        sink_object.Reset();
+        
+        v8::TryCatch try_catch(isolate);
+        v8::Local<v8::Value> argv[] = {v8::Integer::New(isolate, status)};
+        if (function->Call(local_context, v8::Undefined(isolate), 1, argv).IsEmpty() && try_catch.HasCaught()) {
+            v8::String::Utf8Value error(isolate, try_catch.Exception());
+            std::cerr << "Uncaught exception in stream callback: " << *error << std::endl;
+        }
+        
+        // Settle promises resolved by the callback, as after any loop task
+        isolate->PerformMicrotaskCheckpoint();
+    }
+    MaybeDelete();
+}
+
+// Free the pipe once nothing uses its buffers any more
+void NativePipe::MaybeDelete() {
+    if (!finished_ || reads_pending_ > 0 || writes_pending_ > 0) {
+        return;
+    }
+    if (binding_) {
+        binding_->pipes.erase(this);
+    }
+    delete this;
+}
+
+// Native pipe function: pipe(source, sink, highWaterMark, callback)
+static void Pipe(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    StreamBinding* binding = static_cast<StreamBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args[0]->IsObject() || !args[1]->IsObject() || !args[2]->IsUint32() || !args[3]->IsFunction()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    StreamBase* source = StreamBase::FromObject(args[0].As<v8::Object>());
+    StreamBase* sink = StreamBase::FromObject(args[1].As<v8::Object>());
+    if (!source || !sink || source == sink) {
+        args.GetReturnValue().Set(UV_EINVAL);
+        return;
+    }
+    if (source->GetReadListener()) {
+        args.GetReturnValue().Set(UV_EBUSY);
+        return;
+    }
+    size_t high_water_mark = std::max<uint32_t>(args[2].As<v8::Uint32>()->Value(), 1);
+    
+    NativePipe* pipe = new NativePipe(binding, source, sink, high_water_mark);
+    int err = pipe->Start();
+    if (err != 0) {
+        delete pipe;
+        args.GetReturnValue().Set(err);
+        return;
+    }
+    pipe->source_object.Reset(isolate, args[0].As<v8::Object>());
+    pipe->sink_object.Reset(isolate, args[1].As<v8::Object>());
+    pipe->context.Reset(isolate, isolate->GetCurrentContext());
+    pipe->callback.Reset(isolate, args[3].As<v8::Function>());
+    binding->pipes.insert(pipe);
+    binding->runtime->GetEventLoop()->Wake();
+    args.GetReturnValue().Set(0);
+}
+
+// Free a buffer list once its object has been collected
+static void BufferListWeakCallback(const v8::WeakCallbackInfo<BufferList>& info) {
+    BufferList* list = info.GetParameter();
+    list->handle.Reset();
+    delete list;
+}
+
+// Size of a chunk for high-water mark accounting
+static size_t MeasureChunk(BufferList* list, v8::Local<v8::Value> chunk) {
+    if (list->object_mode) {
+        return 1;
+    }
+    if (chunk->IsArrayBufferView()) {
+        return chunk.As<v8::ArrayBufferView>()->ByteLength();
+    }
+    if (chunk->IsString()) {
+        return static_cast<size_t>(chunk.As<v8::String>()->Length());
+    }
+    return 1;
+}
+
+// Get the list behind a BufferList object, and its chunk array
+static BufferList* UnwrapBufferList(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Array>* chunks) {
+    BufferList* list = nullptr;
+    if (args.This()->InternalFieldCount() >= 2) {
+        list = static_cast<BufferList*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!list) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    *chunks = args.This()->GetInternalField(1).As<v8::Value>().As<v8::Array>();
+    return list;
+}
+
+// Remove the front chunk from the array
+static v8::Local<v8::Value> TakeFront(v8::Local<v8::Context> context, BufferList* list, v8::Local<v8::Array> chunks) {
+    v8::Isolate* isolate = context->GetIsolate();
+    v8::Local<v8::Value> chunk = chunks->Get(context, list->head).ToLocalChecked();
+    list->sizes.pop_front();
+    if (++list->head == list->tail) {
+        // Empty again: start over at index 0
+        list->head = 0;
+        list->tail = 0;
+        chunks->Set(context, PropertyKeys::Get(isolate).length_string(), v8::Integer::New(isolate, 0)).Check();
+    } else {
+        chunks->Set(context, list->head - 1, v8::Undefined(isolate)).Check();
+    }
+    return chunk;
+}
+
+// Move the queued chunks to the front of the array once the consumed prefix has grown long
+static void MaybeCompact(v8::Local<v8::Context> context, BufferList* list, v8::Local<v8::Array> chunks) {
+    if (list->head < kCompactThreshold || list->head < list->tail - list->head) {
+        return;
+    }
+    uint32_t count = list->tail - list->head;
+    for (uint32_t i = 0; i < count; i++) {
+        chunks->Set(context, i, chunks->Get(context, list->head + i).ToLocalChecked()).Check();
+    }
+    v8::Isolate* isolate = context->GetIsolate();
+    chunks->Set(context, PropertyKeys::Get(isolate).length_string(), v8::Integer::New(isolate, count)).Check();
+    list->head = 0;
+    list->tail = count;
+}
+
+// Constructor: new BufferList(highWaterMark, objectMode)
+static void BufferListConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    if (!args.IsConstructCall() || !args[0]->IsNumber()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    BufferList* list = new BufferList();
+    list->high_water_mark = args[0].As<v8::Number>()->Value();
+    list->object_mode = args[1]->BooleanValue(isolate);
+    list->handle.Reset(isolate, args.This());
+    list->handle.SetWeak(list, BufferListWeakCallback, v8::WeakCallbackType::kParameter);
+    args.This()->SetAlignedPointerInInternalField(0, list);
+    args.This()->SetInternalField(1, v8::Array::New(isolate));
+}
+
+// list.push(chunk, measured): queue chunk, sized by measured if given; true while below the high-water mark
+static void BufferListPush(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list) {
+        return;
+    }
+    size_t size = MeasureChunk(list, args.Length() > 1 ? args[1] : args[0]);
+    MaybeCompact(context, list, chunks);
+    chunks->Set(context, list->tail++, args[0]).Check();
+    list->sizes.push_back(size);
+    list->length += size;
+    
+    bool below = static_cast<double>(list->length) < list->high_water_mark;
+    if (!below) {
+        list->need_drain = true;
+    }
+    args.GetReturnValue().Set(below);
+}
+
+// list.shift(): remove and return the front chunk, or undefined
+static void BufferListShift(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list || list->sizes.empty()) {
+        return;
+    }
+    list->length -= list->sizes.front();
+    args.GetReturnValue().Set(TakeFront(isolate->GetCurrentContext(), list, chunks));
+}
+
+// list.take(): remove the front chunk for a write; it stays counted until done()
+static void BufferListTake(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list || list->sizes.empty()) {
+        return;
+    }
+    list->in_flight.push_back(list->sizes.front());
+    args.GetReturnValue().Set(TakeFront(isolate->GetCurrentContext(), list, chunks));
+}
+
+// list.takeAll(): remove every queued chunk for one write, as an array
+static void BufferListTakeAll(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list) {
+        return;
+    }
+    uint32_t count = list->tail - list->head;
+    v8::Local<v8::Array> taken = v8::Array::New(isolate, static_cast<int>(count));
+    for (uint32_t i = 0; i < count; i++) {
+        taken->Set(context, i, chunks->Get(context, list->head + i).ToLocalChecked()).Check();
+    }
+    list->in_flight.insert(list->in_flight.end(), list->sizes.begin(), list->sizes.end());
+    list->sizes.clear();
+    list->head = 0;
+    list->tail = 0;
+    chunks->Set(context, PropertyKeys::Get(isolate).length_string(), v8::Integer::New(isolate, 0)).Check();
+    args.GetReturnValue().Set(taken);
+}
+
+// list.done(count): stop counting the oldest count taken chunks (default 1)
+static void BufferListDone(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list) {
+        return;
+    }
+    uint32_t count = args[0]->IsUint32() ? args[0].As<v8::Uint32>()->Value() : 1;
+    for (uint32_t i = 0; i < count && !list->in_flight.empty(); i++) {
+        list->length -= list->in_flight.front();
+        list->in_flight.pop_front();
+    }
+}
+
+// list.takeDrain(): whether a push() reached the high-water mark since the last call
+static void BufferListTakeDrain(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list) {
+        return;
+    }
+    args.GetReturnValue().Set(list->need_drain);
+    list->need_drain = false;
+}
+
+// list.clear(): drop queued chunks and forget writes in flight
+static void BufferListClear(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (!list) {
+        return;
+    }
+    list->sizes.clear();
+    list->in_flight.clear();
+    list->length = 0;
+    list->head = 0;
+    list->tail = 0;
+    list->need_drain = false;
+    chunks->Set(isolate->GetCurrentContext(), PropertyKeys::Get(isolate).length_string(),
+                v8::Integer::New(isolate, 0)).Check();
+}
+
+// list.length(): size of queued and in-flight chunks
+static void BufferListLength(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (list) {
+        args.GetReturnValue().Set(static_cast<double>(list->length));
+    }
+}
+
+// list.count(): number of queued chunks
+static void BufferListCount(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Local<v8::Array> chunks;
+    BufferList* list = UnwrapBufferList(args, &chunks);
+    if (list) {
+        args.GetReturnValue().Set(list->tail - list->head);
+    }
+}
+
+// Stop every pipe when the runtime is destroyed; reads and writes in flight finish without V8
+static void CleanupBinding(StreamBinding* binding) {
+    std::vector<NativePipe*> pipes(binding->pipes.begin(), binding->pipes.end());
+    binding->pipes.clear();
+    for (NativePipe* pipe : pipes) {
+        pipe->Detach();
+    }
+    delete binding;
+}
+
+// Register the stream module
+void RegisterStreamModule(Runtime* runtime) {
+    std::cout << "RegisterStreamModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        StreamBinding* binding = new StreamBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        
+        // Build the BufferList class
+        v8::Local<v8::FunctionTemplate> list_template = v8::FunctionTemplate::New(isolate, BufferListConstructor);
+        list_template->SetClassName(v8::String::NewFromUtf8(isolate, "BufferList").ToLocalChecked());
+        list_template->InstanceTemplate()->SetInternalFieldCount(2);
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kMethods[] = {
+            {"push", BufferListPush},
+            {"shift", BufferListShift},
+            {"take", BufferListTake},
+            {"takeAll", BufferListTakeAll},
+            {"done", BufferListDone},
+            {"takeDrain", BufferListTakeDrain},
+            {"clear", BufferListClear},
+            {"length", BufferListLength},
+            {"count", BufferListCount},
+        };
+        for (const auto& entry : kMethods) {
+            list_template->PrototypeTemplate()->Set(isolate, entry.name,
+                v8::FunctionTemplate::New(isolate, entry.callback));
+        }
+        
+        // Create the stream module object
+        v8::Local<v8::Object> stream = v8::Object::New(isolate);
+        stream->Set(context, v8::String::NewFromUtf8(isolate, "BufferList").ToLocalChecked(),
+                    list_template->GetFunction(context).ToLocalChecked()).Check();
+        stream->Set(context, v8::String::NewFromUtf8(isolate, "pipe").ToLocalChecked(),
+                    v8::Function::New(context, Pipe, data).ToLocalChecked()).Check();
+        
+        // Register the stream module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/stream", stream);
+        
+        std::cout << "RegisterStreamModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterStreamModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterStreamModule" << std::endl;
+    }
+}
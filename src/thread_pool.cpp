@@ -0,0 +1,150 @@
+#include "thread_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <cstdlib>
+
+// Affinity of the process-wide pool, and whether the pool exists yet
+static CpuAffinity default_affinity;
+static std::atomic<bool> default_created(false);
+
+// Constructor
+ThreadPool::ThreadPool(size_t thread_count, const CpuAffinity& affinity)
+    : affinity_(affinity),
+      queues_(std::max<size_t>(1, affinity.GetNodes().size())),
+      node_queues_(GetNumaNodeCount(), -1),
+      next_queue_(0),
+      stopping_(false) {
+    const std::vector<int>& nodes = affinity_.GetNodes();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (static_cast<size_t>(nodes[i]) < node_queues_.size()) {
+            node_queues_[nodes[i]] = static_cast<int>(i);
+        }
+    }
+    
+    for (size_t i = 0; i < thread_count; i++) {
+        threads_.emplace_back(&ThreadPool::WorkerMain, this, i);
+    }
+}
+
+// Destructor
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    for (NodeQueue& queue : queues_) {
+        queue.cv.notify_all();
+    }
+    
+    for (std::thread& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+// Queue work for a worker thread, on the submitter's node when the pool serves it
+void ThreadPool::Submit(std::function<void()> work) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t home = 0;
+    if (queues_.size() > 1) {
+        int node = GetCurrentNumaNode();
+        if (static_cast<size_t>(node) < node_queues_.size() && node_queues_[node] >= 0) {
+            home = static_cast<size_t>(node_queues_[node]);
+        } else {
+            home = next_queue_++ % queues_.size();
+        }
+    }
+    queues_[home].queue.push(std::move(work));
+    
+    // Wake a worker of the same node if one is idle, or else any idle worker to steal it
+    for (size_t i = 0; i < queues_.size(); i++) {
+        NodeQueue& queue = queues_[(home + i) % queues_.size()];
+        if (queue.idle > 0) {
+            queue.cv.notify_one();
+            break;
+        }
+    }
+}
+
+// Get the number of worker threads
+size_t ThreadPool::GetThreadCount() const {
+    return threads_.size();
+}
+
+// Get the process-wide pool
+ThreadPool* ThreadPool::GetDefault() {
+    // Intentionally leaked so workers outlive static destructors at exit
+    static ThreadPool* pool = []() {
+        size_t thread_count = 4;
+        if (const char* size = std::getenv("TINY_NODE_THREADPOOL_SIZE")) {
+            long value = std::strtol(size, nullptr, 10);
+            if (value > 0 && value <= 1024) {
+                thread_count = static_cast<size_t>(value);
+            }
+        }
+        CpuAffinity affinity = default_affinity;
+        const char* spec = std::getenv("TINY_NODE_THREADPOOL_AFFINITY");
+        if (!affinity.IsSet() && spec) {
+            std::string error;
+            if (!CpuAffinity::Parse(spec, &affinity, &error)) {
+                std::cerr << "Ignoring TINY_NODE_THREADPOOL_AFFINITY: " << error << std::endl;
+            }
+        }
+        default_created = true;
+        return new ThreadPool(thread_count, affinity);
+    }();
+    return pool;
+}
+
+// Set the affinity of the process-wide pool before it is created
+bool ThreadPool::SetDefaultAffinity(const CpuAffinity& affinity) {
+    if (default_created) {
+        return false;
+    }
+    default_affinity = affinity;
+    return true;
+}
+
+// Take work from the worker's own queue, or steal from another node's
+bool ThreadPool::TakeWork(size_t home, std::function<void()>* work) {
+    for (size_t i = 0; i < queues_.size(); i++) {
+        std::queue<std::function<void()>>& queue = queues_[(home + i) % queues_.size()].queue;
+        if (!queue.empty()) {
+            *work = std::move(queue.front());
+            queue.pop();
+            return true;
+        }
+    }
+    return false;
+}
+
+// Worker thread main function
+void ThreadPool::WorkerMain(size_t slot) {
+    affinity_.ApplyToCurrentThread(slot);
+    size_t home = slot % queues_.size();
+    
+    while (true) {
+        std::function<void()> work;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!TakeWork(home, &work)) {
+                if (stopping_) {
+                    return;
+                }
+                queues_[home].idle++;
+                queues_[home].cv.wait(lock);
+                queues_[home].idle--;
+            }
+        }
+        
+        try {
+            work();
+        } catch (const std::exception& e) {
+            std::cerr << "Exception in thread pool work: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Unknown exception in thread pool work" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,76 @@
+#include "util_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "inspect.h"
+#include <cmath>
+#include <iostream>
+
+// Return the contents of a buffer as a JavaScript string
+static void ReturnString(const v8::FunctionCallbackInfo<v8::Value>& args, const std::string& text) {
+    v8::Local<v8::String> result;
+    if (v8::String::NewFromUtf8(args.GetIsolate(), text.data(), v8::NewStringType::kNormal,
+                                static_cast<int>(text.size())).ToLocal(&result)) {
+        args.GetReturnValue().Set(result);
+    }
+}
+
+// Native inspect function
+static void Inspect(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    InspectOptions options;
+    if (args[1]->IsNull()) {
+        options.depth = -1;
+    } else if (args[1]->IsNumber()) {
+        double depth = args[1].As<v8::Number>()->Value();
+        options.depth = depth >= INT32_MAX ? -1 : (depth >= 0 ? static_cast<int>(depth) : 0);
+    }
+    
+    InspectBuffer buffer;
+    if (!InspectValue(context, args[0], options, buffer.Get())) {
+        return;
+    }
+    ReturnString(args, *buffer.Get());
+}
+
+// Native format function
+static void Format(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    InspectBuffer buffer;
+    if (!FormatValues(args.GetIsolate()->GetCurrentContext(), args, buffer.Get())) {
+        return;
+    }
+    ReturnString(args, *buffer.Get());
+}
+
+// Register the internal/util module
+void RegisterUtilModule(Runtime* runtime) {
+    std::cout << "RegisterUtilModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the util module object
+        v8::Local<v8::Object> util = v8::Object::New(isolate);
+        util->Set(context, v8::String::NewFromUtf8(isolate, "inspect").ToLocalChecked(),
+                  v8::Function::New(context, Inspect).ToLocalChecked()).Check();
+        util->Set(context, v8::String::NewFromUtf8(isolate, "format").ToLocalChecked(),
+                  v8::Function::New(context, Format).ToLocalChecked()).Check();
+        
+        // Register the util module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/util", util);
+        
+        std::cout << "RegisterUtilModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterUtilModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterUtilModule" << std::endl;
+    }
+}
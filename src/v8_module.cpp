@@ -0,0 +1,750 @@
+#include "v8_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "property_keys.h"
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+
+// Pooled serialization buffers. Each block starts with a header recording its
+// capacity, so a released buffer can be reused by the next serialization.
+struct alignas(16) PoolBlockHeader {
+    size_t capacity;
+};
+
+static constexpr size_t kMinPooledCapacity = 4096;
+static constexpr size_t kMaxPooledCapacity = 1 << 20;
+static constexpr size_t kMaxPooledBlocks = 32;
+
+static std::vector<PoolBlockHeader*> free_blocks;
+static std::mutex free_blocks_mutex;
+
+// Registered host object codecs
+static std::vector<const HostObjectCodec*> host_object_codecs;
+
+// Transfer side data of a value serialized from JavaScript, kept while the
+// Uint8Array v8.serialize returned for it is alive
+struct PendingTransfer {
+    uint64_t token;
+    SerializedValue side_data;
+    v8::Isolate* isolate;
+    v8::Global<v8::ArrayBuffer> handle;
+};
+
+// Pending transfers, keyed by the token written into the serialized bytes
+static std::unordered_map<uint64_t, std::unique_ptr<PendingTransfer>> pending_transfers;
+static std::mutex pending_transfers_mutex;
+static std::atomic<uint64_t> next_transfer_token(1);
+
+// Get the header of a pooled buffer
+static PoolBlockHeader* BlockHeader(void* data) {
+    return static_cast<PoolBlockHeader*>(data) - 1;
+}
+
+// Take a buffer of at least size bytes from the pool
+static void* PoolAllocate(size_t size, size_t* actual_size) {
+    {
+        std::lock_guard<std::mutex> lock(free_blocks_mutex);
+        for (size_t i = 0; i < free_blocks.size(); i++) {
+            if (free_blocks[i]->capacity >= size) {
+                PoolBlockHeader* header = free_blocks[i];
+                free_blocks[i] = free_blocks.back();
+                free_blocks.pop_back();
+                *actual_size = header->capacity;
+                return header + 1;
+            }
+        }
+    }
+    
+    size_t capacity = std::max(size, kMinPooledCapacity);
+    PoolBlockHeader* header = static_cast<PoolBlockHeader*>(std::malloc(sizeof(PoolBlockHeader) + capacity));
+    if (!header) {
+        return nullptr;
+    }
+    header->capacity = capacity;
+    *actual_size = capacity;
+    return header + 1;
+}
+
+// Grow a pooled buffer
+static void* PoolReallocate(void* data, size_t size, size_t* actual_size) {
+    if (!data) {
+        return PoolAllocate(size, actual_size);
+    }
+    
+    PoolBlockHeader* header = BlockHeader(data);
+    if (header->capacity >= size) {
+        *actual_size = header->capacity;
+        return data;
+    }
+    
+    size_t capacity = std::max(size, header->capacity * 2);
+    header = static_cast<PoolBlockHeader*>(std::realloc(header, sizeof(PoolBlockHeader) + capacity));
+    if (!header) {
+        return nullptr;
+    }
+    header->capacity = capacity;
+    *actual_size = capacity;
+    return header + 1;
+}
+
+// Return a buffer to the pool (or free it if it is too large to keep)
+static void PoolFree(void* data) {
+    if (!data) {
+        return;
+    }
+    
+    PoolBlockHeader* header = BlockHeader(data);
+    if (header->capacity <= kMaxPooledCapacity) {
+        std::lock_guard<std::mutex> lock(free_blocks_mutex);
+        if (free_blocks.size() < kMaxPooledBlocks) {
+            free_blocks.push_back(header);
+            return;
+        }
+    }
+    std::free(header);
+}
+
+// Throw a DataCloneError-style exception
+static void ThrowCloneError(v8::Isolate* isolate, const char* message) {
+    isolate->ThrowException(v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, message).ToLocalChecked()));
+}
+
+// Serializer delegate writing into pooled buffers
+class SerializerDelegate : public v8::ValueSerializer::Delegate {
+public:
+    SerializerDelegate(v8::Isolate* isolate, SerializedValue* side_data)
+        : isolate_(isolate), side_data_(side_data) {}
+    
+    void ThrowDataCloneError(v8::Local<v8::String> message) override {
+        isolate_->ThrowException(v8::Exception::Error(message));
+    }
+    
+    bool HasCustomHostObject(v8::Isolate*) override {
+        return !host_object_codecs.empty();
+    }
+    
+    v8::Maybe<bool> IsHostObject(v8::Isolate*, v8::Local<v8::Object> object) override {
+        return v8::Just(FindCodec(object) != nullptr);
+    }
+    
+    v8::Maybe<bool> WriteHostObject(v8::Isolate* isolate, v8::Local<v8::Object> object) override {
+        const HostObjectCodec* codec = FindCodec(object);
+        if (!codec) {
+            ThrowCloneError(isolate, "Host object cannot be cloned");
+            return v8::Nothing<bool>();
+        }
+        
+        // The codec name selects the reader on the other side
+        uint32_t name_length = static_cast<uint32_t>(std::strlen(codec->name));
+        serializer_->WriteUint32(name_length);
+        serializer_->WriteRawBytes(codec->name, name_length);
+        if (!codec->write(isolate, serializer_, object)) {
+            return v8::Nothing<bool>();
+        }
+        return v8::Just(true);
+    }
+    
+    v8::Maybe<uint32_t> GetSharedArrayBufferId(v8::Isolate* isolate,
+                                               v8::Local<v8::SharedArrayBuffer> buffer) override {
+        if (!side_data_) {
+            ThrowCloneError(isolate, "SharedArrayBuffer cannot be written outside the process");
+            return v8::Nothing<uint32_t>();
+        }
+        
+        std::shared_ptr<v8::BackingStore> backing_store = buffer->GetBackingStore();
+        for (size_t i = 0; i < side_data_->shared.size(); i++) {
+            if (side_data_->shared[i] == backing_store) {
+                return v8::Just(static_cast<uint32_t>(i));
+            }
+        }
+        side_data_->shared.push_back(backing_store);
+        return v8::Just(static_cast<uint32_t>(side_data_->shared.size() - 1));
+    }
+    
+    void* ReallocateBufferMemory(void* old_buffer, size_t size, size_t* actual_size) override {
+        return PoolReallocate(old_buffer, size, actual_size);
+    }
+    
+    void FreeBufferMemory(void* buffer) override {
+        PoolFree(buffer);
+    }
+    
+    void SetSerializer(v8::ValueSerializer* serializer) {
+        serializer_ = serializer;
+    }
+    
+private:
+    const HostObjectCodec* FindCodec(v8::Local<v8::Object> object) {
+        for (const HostObjectCodec* codec : host_object_codecs) {
+            if (codec->matches(isolate_, object)) {
+                return codec;
+            }
+        }
+        return nullptr;
+    }
+    
+    v8::Isolate* isolate_;
+    SerializedValue* side_data_;
+    v8::ValueSerializer* serializer_ = nullptr;
+};
+
+// Deserializer delegate resolving host objects and shared buffers
+class DeserializerDelegate : public v8::ValueDeserializer::Delegate {
+public:
+    explicit DeserializerDelegate(const SerializedValue* side_data)
+        : side_data_(side_data) {}
+    
+    v8::MaybeLocal<v8::Object> ReadHostObject(v8::Isolate* isolate) override {
+        uint32_t name_length;
+        const void* name;
+        if (!deserializer_->ReadUint32(&name_length) || !deserializer_->ReadRawBytes(name_length, &name)) {
+            ThrowCloneError(isolate, "Invalid host object data");
+            return v8::MaybeLocal<v8::Object>();
+        }
+        
+        std::string codec_name(static_cast<const char*>(name), name_length);
+        for (const HostObjectCodec* codec : host_object_codecs) {
+            if (codec_name == codec->name) {
+                return codec->read(isolate, deserializer_);
+            }
+        }
+        
+        ThrowCloneError(isolate, "Unknown host object type");
+        return v8::MaybeLocal<v8::Object>();
+    }
+    
+    v8::MaybeLocal<v8::SharedArrayBuffer> GetSharedArrayBufferFromId(v8::Isolate* isolate,
+                                                                    uint32_t clone_id) override {
+        if (!side_data_ || clone_id >= side_data_->shared.size()) {
+            ThrowCloneError(isolate, "SharedArrayBuffer is not available in this context");
+            return v8::MaybeLocal<v8::SharedArrayBuffer>();
+        }
+        return v8::SharedArrayBuffer::New(isolate, side_data_->shared[clone_id]);
+    }
+    
+    void SetDeserializer(v8::ValueDeserializer* deserializer) {
+        deserializer_ = deserializer;
+    }
+    
+private:
+    const SerializedValue* side_data_;
+    v8::ValueDeserializer* deserializer_ = nullptr;
+};
+
+// Serialize a value into a pooled buffer
+//
+// The stream is: V8 header, uint64 transfer token, value. side_data is
+// nullptr when the bytes leave the process (files), which rules out
+// transfers and shared buffers.
+static bool SerializeInternal(v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                              const std::vector<v8::Local<v8::ArrayBuffer>>& transfer,
+                              uint64_t token, SerializedValue* side_data,
+                              std::pair<uint8_t*, size_t>* bytes) {
+    v8::Isolate* isolate = context->GetIsolate();
+    
+    SerializerDelegate delegate(isolate, side_data);
+    v8::ValueSerializer serializer(isolate, &delegate);
+    delegate.SetSerializer(&serializer);
+    
+    for (size_t i = 0; i < transfer.size(); i++) {
+        if (!transfer[i]->IsDetachable()) {
+            ThrowCloneError(isolate, "ArrayBuffer in transfer list cannot be detached");
+            return false;
+        }
+        serializer.TransferArrayBuffer(static_cast<uint32_t>(i), transfer[i]);
+    }
+    
+    serializer.WriteHeader();
+    serializer.WriteUint64(token);
+    if (!serializer.WriteValue(context, value).FromMaybe(false)) {
+        return false;
+    }
+    
+    // Detach transferred buffers only once the whole value was written
+    for (const v8::Local<v8::ArrayBuffer>& buffer : transfer) {
+        side_data->transferred.push_back(buffer->GetBackingStore());
+        buffer->Detach(v8::Local<v8::Value>()).Check();
+    }
+    
+    *bytes = serializer.Release();
+    return true;
+}
+
+// Deserialize a value written by SerializeInternal
+//
+// If side_data is nullptr and the stream carries a transfer token, the side
+// data registered by v8.serialize under that token is used.
+static v8::MaybeLocal<v8::Value> DeserializeInternal(v8::Local<v8::Context> context,
+                                                     const uint8_t* data, size_t length,
+                                                     SerializedValue* side_data) {
+    v8::Isolate* isolate = context->GetIsolate();
+    v8::EscapableHandleScope handle_scope(isolate);
+    
+    SerializedValue registered;
+    DeserializerDelegate delegate(side_data ? side_data : &registered);
+    v8::ValueDeserializer deserializer(isolate, data, length, &delegate);
+    delegate.SetDeserializer(&deserializer);
+    
+    uint64_t token;
+    if (!deserializer.ReadHeader(context).FromMaybe(false)) {
+        return v8::MaybeLocal<v8::Value>();
+    }
+    if (!deserializer.ReadUint64(&token)) {
+        ThrowCloneError(isolate, "Invalid serialized data");
+        return v8::MaybeLocal<v8::Value>();
+    }
+    
+    // Shared buffers stay registered for further deserializations of the same bytes
+    if (!side_data && token != 0) {
+        std::lock_guard<std::mutex> lock(pending_transfers_mutex);
+        auto it = pending_transfers.find(token);
+        if (it != pending_transfers.end()) {
+            registered.transferred = std::move(it->second->side_data.transferred);
+            it->second->side_data.transferred.clear();
+            registered.shared = it->second->side_data.shared;
+        }
+    }
+    
+    // Transferred buffers are consumed by this deserialization
+    SerializedValue* source = side_data ? side_data : &registered;
+    for (size_t i = 0; i < source->transferred.size(); i++) {
+        deserializer.TransferArrayBuffer(static_cast<uint32_t>(i),
+            v8::ArrayBuffer::New(isolate, source->transferred[i]));
+    }
+    source->transferred.clear();
+    
+    v8::Local<v8::Value> result;
+    if (!deserializer.ReadValue(context).ToLocal(&result)) {
+        return v8::MaybeLocal<v8::Value>();
+    }
+    return handle_scope.Escape(result);
+}
+
+// Register a host object codec
+void RegisterHostObjectCodec(const HostObjectCodec* codec) {
+    host_object_codecs.push_back(codec);
+}
+
+// Serialize a value for another runtime in the same process
+bool SerializeValue(v8::Local<v8::Context> context, v8::Local<v8::Value> value,
+                    const std::vector<v8::Local<v8::ArrayBuffer>>& transfer,
+                    SerializedValue* result) {
+    std::pair<uint8_t*, size_t> bytes;
+    if (!SerializeInternal(context, value, transfer, 0, result, &bytes)) {
+        return false;
+    }
+    result->data = std::shared_ptr<uint8_t>(bytes.first, [](uint8_t* data) { PoolFree(data); });
+    result->length = bytes.second;
+    return true;
+}
+
+// Deserialize a value produced by SerializeValue
+v8::MaybeLocal<v8::Value> DeserializeValue(v8::Local<v8::Context> context, SerializedValue* value) {
+    return DeserializeInternal(context, value->data.get(), value->length, value);
+}
+
+// Get the bytes of an ArrayBuffer or ArrayBufferView argument
+static bool GetBytes(v8::Local<v8::Value> value, const uint8_t** data, size_t* length) {
+    if (value->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+        *data = static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+        *length = view->ByteLength();
+        return true;
+    }
+    if (value->IsArrayBuffer()) {
+        v8::Local<v8::ArrayBuffer> buffer = value.As<v8::ArrayBuffer>();
+        *data = static_cast<const uint8_t*>(buffer->Data());
+        *length = buffer->ByteLength();
+        return true;
+    }
+    return false;
+}
+
+// Drop the side data of serialized bytes once JavaScript no longer holds them
+static void PendingTransferWeakCallback(const v8::WeakCallbackInfo<PendingTransfer>& info) {
+    uint64_t token = info.GetParameter()->token;
+    std::lock_guard<std::mutex> lock(pending_transfers_mutex);
+    pending_transfers.erase(token);
+}
+
+// Native serialize function
+static void Serialize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    // Collect the transfer list from the options object
+    std::vector<v8::Local<v8::ArrayBuffer>> transfer;
+    if (args.Length() >= 2 && args[1]->IsObject()) {
+        v8::Local<v8::Value> list;
+        if (!args[1].As<v8::Object>()->Get(context, PropertyKeys::Get(isolate).transfer_string()).ToLocal(&list)) {
+            return;
+        }
+        if (list->IsArray()) {
+            v8::Local<v8::Array> array = list.As<v8::Array>();
+            for (uint32_t i = 0; i < array->Length(); i++) {
+                v8::Local<v8::Value> item;
+                if (!array->Get(context, i).ToLocal(&item)) {
+                    return;
+                }
+                if (!item->IsArrayBuffer()) {
+                    isolate->ThrowException(v8::Exception::TypeError(
+                        v8::String::NewFromUtf8(isolate, "Transfer list may only contain ArrayBuffers").ToLocalChecked()));
+                    return;
+                }
+                transfer.push_back(item.As<v8::ArrayBuffer>());
+            }
+        }
+    }
+    
+    uint64_t token = next_transfer_token++;
+    SerializedValue side_data;
+    std::pair<uint8_t*, size_t> bytes;
+    if (!SerializeInternal(context, args.Length() > 0 ? args[0] : v8::Undefined(isolate).As<v8::Value>(),
+                           transfer, token, &side_data, &bytes)) {
+        return;
+    }
+    
+    // Copy into memory from the isolate's allocator; with the V8 sandbox
+    // enabled, ArrayBuffers cannot wrap memory allocated outside of it
+    std::unique_ptr<v8::BackingStore> backing_store = v8::ArrayBuffer::NewBackingStore(isolate, bytes.second);
+    std::memcpy(backing_store->Data(), bytes.first, bytes.second);
+    PoolFree(bytes.first);
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(backing_store));
+    
+    // Keep transferred and shared buffers while the bytes are alive
+    if (!side_data.transferred.empty() || !side_data.shared.empty()) {
+        std::unique_ptr<PendingTransfer> pending(new PendingTransfer());
+        pending->token = token;
+        pending->side_data = std::move(side_data);
+        pending->isolate = isolate;
+        pending->handle.Reset(isolate, buffer);
+        pending->handle.SetWeak(pending.get(), PendingTransferWeakCallback, v8::WeakCallbackType::kParameter);
+        std::lock_guard<std::mutex> lock(pending_transfers_mutex);
+        pending_transfers.emplace(token, std::move(pending));
+    }
+    
+    args.GetReturnValue().Set(v8::Uint8Array::New(buffer, 0, bytes.second));
+}
+
+// Native deserialize function
+static void Deserialize(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    const uint8_t* data;
+    size_t length;
+    if (args.Length() < 1 || !GetBytes(args[0], &data, &length)) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    v8::Local<v8::Value> result;
+    if (DeserializeInternal(isolate->GetCurrentContext(), data, length, nullptr).ToLocal(&result)) {
+        args.GetReturnValue().Set(result);
+    }
+}
+
+// Native releaseTransfers function
+static void ReleaseTransfers(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    const uint8_t* data;
+    size_t length;
+    if (args.Length() < 1 || !GetBytes(args[0], &data, &length)) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    // Only the token after the V8 header is needed
+    DeserializerDelegate delegate(nullptr);
+    v8::ValueDeserializer deserializer(isolate, data, length, &delegate);
+    delegate.SetDeserializer(&deserializer);
+    uint64_t token;
+    if (!deserializer.ReadHeader(isolate->GetCurrentContext()).FromMaybe(false)) {
+        return;
+    }
+    if (!deserializer.ReadUint64(&token)) {
+        ThrowCloneError(isolate, "Invalid serialized data");
+        return;
+    }
+    
+    // The entry's handle belongs to the isolate that serialized the value
+    std::lock_guard<std::mutex> lock(pending_transfers_mutex);
+    auto it = pending_transfers.find(token);
+    bool released = it != pending_transfers.end() && it->second->isolate == isolate;
+    if (released) {
+        pending_transfers.erase(it);
+    }
+    args.GetReturnValue().Set(released);
+}
+
+// Drop the pending transfers of a runtime that is shutting down
+static void ReleaseIsolateTransfers(v8::Isolate* isolate) {
+    std::lock_guard<std::mutex> lock(pending_transfers_mutex);
+    for (auto it = pending_transfers.begin(); it != pending_transfers.end();) {
+        if (it->second->isolate == isolate) {
+            it = pending_transfers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+struct RecordFile;
+
+// Per-runtime state of the v8 module
+struct V8Binding {
+    // Record files whose wrappers have not been collected; closed when the runtime is torn down
+    std::unordered_set<RecordFile*> record_files;
+};
+
+// An open record file, owned by its JavaScript wrapper object
+struct RecordFile {
+    FILE* file = nullptr;
+    v8::Global<v8::Object> handle;
+    V8Binding* binding = nullptr;
+};
+
+// Close a record file, flushing a writer's buffered records, and free it
+static void FreeRecordFile(RecordFile* record_file) {
+    if (record_file->file) {
+        std::fclose(record_file->file);
+    }
+    record_file->handle.Reset();
+    delete record_file;
+}
+
+// Release a record file when its wrapper is garbage collected
+static void RecordFileWeakCallback(const v8::WeakCallbackInfo<RecordFile>& info) {
+    RecordFile* record_file = info.GetParameter();
+    record_file->binding->record_files.erase(record_file);
+    FreeRecordFile(record_file);
+}
+
+// Close the record files still open and drop the transfers of a runtime that is torn down
+static void CleanupBinding(V8Binding* binding, v8::Isolate* isolate) {
+    for (RecordFile* record_file : binding->record_files) {
+        FreeRecordFile(record_file);
+    }
+    binding->record_files.clear();
+    ReleaseIsolateTransfers(isolate);
+    delete binding;
+}
+
+// Get the open record file behind a wrapper, throwing if it was closed
+static RecordFile* UnwrapRecordFile(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    if (args.This()->InternalFieldCount() < 1) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    
+    RecordFile* record_file = static_cast<RecordFile*>(args.This()->GetAlignedPointerFromInternalField(0));
+    if (!record_file->file) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "File is closed").ToLocalChecked()));
+        return nullptr;
+    }
+    return record_file;
+}
+
+// writer.write(value): append one length-prefixed record
+static void WriterWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    RecordFile* record_file = UnwrapRecordFile(args);
+    if (!record_file) {
+        return;
+    }
+    
+    std::pair<uint8_t*, size_t> bytes;
+    if (!SerializeInternal(isolate->GetCurrentContext(),
+                           args.Length() > 0 ? args[0] : v8::Undefined(isolate).As<v8::Value>(),
+                           {}, 0, nullptr, &bytes)) {
+        return;
+    }
+    
+    // Records are a uint32 length in host byte order followed by the data
+    uint32_t length = static_cast<uint32_t>(bytes.second);
+    bool ok = std::fwrite(&length, sizeof(length), 1, record_file->file) == 1 &&
+              std::fwrite(bytes.first, 1, bytes.second, record_file->file) == bytes.second;
+    PoolFree(bytes.first);
+    
+    if (!ok) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Failed to write record").ToLocalChecked()));
+        return;
+    }
+    args.GetReturnValue().Set(v8::Integer::NewFromUnsigned(isolate, length));
+}
+
+// writer.flush()
+static void WriterFlush(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    RecordFile* record_file = UnwrapRecordFile(args);
+    if (record_file) {
+        std::fflush(record_file->file);
+    }
+}
+
+// reader.read(): the next record, or undefined at the end of the file
+static void ReaderRead(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    RecordFile* record_file = UnwrapRecordFile(args);
+    if (!record_file) {
+        return;
+    }
+    
+    uint32_t length;
+    if (std::fread(&length, sizeof(length), 1, record_file->file) != 1) {
+        args.GetReturnValue().SetUndefined();
+        return;
+    }
+    
+    size_t capacity;
+    uint8_t* data = static_cast<uint8_t*>(PoolAllocate(length, &capacity));
+    if (!data || std::fread(data, 1, length, record_file->file) != length) {
+        PoolFree(data);
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Truncated record").ToLocalChecked()));
+        return;
+    }
+    
+    SerializedValue no_side_data;
+    v8::Local<v8::Value> result;
+    bool ok = DeserializeInternal(isolate->GetCurrentContext(), data, length, &no_side_data).ToLocal(&result);
+    PoolFree(data);
+    if (ok) {
+        args.GetReturnValue().Set(result);
+    }
+}
+
+// close() for both writers and readers
+static void RecordFileClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    RecordFile* record_file = UnwrapRecordFile(args);
+    if (record_file) {
+        std::fclose(record_file->file);
+        record_file->file = nullptr;
+    }
+}
+
+// Open a record file and wrap it in a JavaScript object with the given methods
+static void OpenRecordFile(const v8::FunctionCallbackInfo<v8::Value>& args, const char* mode,
+                           std::initializer_list<std::pair<const char*, v8::FunctionCallback>> methods) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    // Check arguments
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+        return;
+    }
+    
+    v8::String::Utf8Value path(isolate, args[0]);
+    FILE* file = std::fopen(*path, mode);
+    if (!file) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "Failed to open file").ToLocalChecked()));
+        return;
+    }
+    
+    // Large stdio buffer so that many small records become few syscalls
+    std::setvbuf(file, nullptr, _IOFBF, 256 * 1024);
+    
+    v8::Local<v8::ObjectTemplate> object_template = v8::ObjectTemplate::New(isolate);
+    object_template->SetInternalFieldCount(1);
+    for (const auto& [name, callback] : methods) {
+        object_template->Set(isolate, name, v8::FunctionTemplate::New(isolate, callback));
+    }
+    object_template->Set(isolate, "close", v8::FunctionTemplate::New(isolate, RecordFileClose));
+    
+    v8::Local<v8::Object> object = object_template->NewInstance(context).ToLocalChecked();
+    V8Binding* binding = static_cast<V8Binding*>(args.Data().As<v8::External>()->Value());
+    RecordFile* record_file = new RecordFile();
+    record_file->file = file;
+    record_file->binding = binding;
+    binding->record_files.insert(record_file);
+    record_file->handle.Reset(isolate, object);
+    record_file->handle.SetWeak(record_file, RecordFileWeakCallback, v8::WeakCallbackType::kParameter);
+    object->SetAlignedPointerInInternalField(0, record_file);
+    
+    args.GetReturnValue().Set(object);
+}
+
+// Native createWriter function
+static void CreateWriter(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    OpenRecordFile(args, "ab", {{"write", WriterWrite}, {"flush", WriterFlush}});
+}
+
+// Native createReader function
+static void CreateReader(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    OpenRecordFile(args, "rb", {{"read", ReaderRead}});
+}
+
+// Register the v8 module
+void RegisterV8Module(Runtime* runtime) {
+    std::cout << "RegisterV8Module: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the v8 module object
+        v8::Local<v8::Object> v8_module = v8::Object::New(isolate);
+        
+        // Add the module functions
+        v8_module->Set(context,
+            v8::String::NewFromUtf8(isolate, "serialize").ToLocalChecked(),
+            v8::Function::New(context, Serialize).ToLocalChecked()).Check();
+        v8_module->Set(context,
+            v8::String::NewFromUtf8(isolate, "deserialize").ToLocalChecked(),
+            v8::Function::New(context, Deserialize).ToLocalChecked()).Check();
+        v8_module->Set(context,
+            v8::String::NewFromUtf8(isolate, "releaseTransfers").ToLocalChecked(),
+            v8::Function::New(context, ReleaseTransfers).ToLocalChecked()).Check();
+        
+        // Weak callbacks do not run when the isolate is disposed
+        V8Binding* binding = new V8Binding();
+        runtime->AddCleanupHook([binding, isolate]() { CleanupBinding(binding, isolate); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        v8_module->Set(context,
+            v8::String::NewFromUtf8(isolate, "createWriter").ToLocalChecked(),
+            v8::Function::New(context, CreateWriter, data).ToLocalChecked()).Check();
+        v8_module->Set(context,
+            v8::String::NewFromUtf8(isolate, "createReader").ToLocalChecked(),
+            v8::Function::New(context, CreateReader, data).ToLocalChecked()).Check();
+        
+        // Register the v8 module
+        runtime->GetModuleSystem()->RegisterNativeModule("v8", v8_module);
+        
+        std::cout << "RegisterV8Module: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterV8Module: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterV8Module" << std::endl;
+    }
+}
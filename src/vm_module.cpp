@@ -0,0 +1,571 @@
+#include "vm_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "property_keys.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+// Embedder data slot of a vm context that holds its sandbox object
+static constexpr int kSandboxIndex = 1;
+
+// Blank contexts kept ready for makeContext()
+static constexpr size_t kContextPoolSize = 8;
+
+struct VmContext;
+
+// Per-runtime state of internal/vm
+struct VmBinding {
+    Runtime* runtime = nullptr;
+    
+    // Global template whose interceptors forward to the sandbox
+    v8::Global<v8::ObjectTemplate> global_template;
+    
+    // Contexts made ahead of time, and whether a refill task is queued
+    std::vector<v8::Global<v8::Context>> pool;
+    bool refill_scheduled = false;
+    
+    // Live contexts, freed by the cleanup hook when the runtime goes away
+    std::unordered_set<VmContext*> contexts;
+};
+
+// A context made by makeContext(), freed once it has been collected
+struct VmContext {
+    VmBinding* binding = nullptr;
+    v8::Global<v8::Context> context;
+};
+
+// A compiled script, not bound to any context
+struct ScriptHandle {
+    v8::Global<v8::Object> handle;
+    v8::Global<v8::UnboundScript> script;
+};
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Get the vm context and sandbox an interceptor was called for
+template <typename T>
+static bool GetSandbox(const v8::PropertyCallbackInfo<T>& info, v8::Local<v8::Context>* context,
+                       v8::Local<v8::Object>* sandbox) {
+    v8::Local<v8::Context> creation;
+    if (!info.This()->GetCreationContext().ToLocal(&creation) ||
+        creation->GetNumberOfEmbedderDataFields() <= static_cast<uint32_t>(kSandboxIndex)) {
+        return false;
+    }
+    v8::Local<v8::Value> value = creation->GetEmbedderData(kSandboxIndex);
+    if (!value->IsObject()) {
+        return false;
+    }
+    *context = creation;
+    *sandbox = value.As<v8::Object>();
+    return true;
+}
+
+// Global reads find the sandbox's properties first, then the context's builtins
+static v8::Intercepted GlobalGetter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox)) {
+        return v8::Intercepted::kNo;
+    }
+    v8::Local<v8::Value> value;
+    if (!sandbox->GetRealNamedProperty(context, property).ToLocal(&value)) {
+        return v8::Intercepted::kNo;
+    }
+    info.GetReturnValue().Set(value);
+    return v8::Intercepted::kYes;
+}
+
+// Global writes go to the sandbox, except to read-only builtins like undefined
+static v8::Intercepted GlobalSetter(v8::Local<v8::Name> property, v8::Local<v8::Value> value,
+                                    const v8::PropertyCallbackInfo<void>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox)) {
+        return v8::Intercepted::kNo;
+    }
+    v8::PropertyAttribute attributes = v8::None;
+    if (context->Global()->GetRealNamedPropertyAttributes(context, property).To(&attributes) &&
+        (attributes & v8::ReadOnly)) {
+        return v8::Intercepted::kNo;
+    }
+    sandbox->Set(context, property, value).IsNothing();
+    return v8::Intercepted::kYes;
+}
+
+// Report the attributes of sandbox properties
+static v8::Intercepted GlobalQuery(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Integer>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox)) {
+        return v8::Intercepted::kNo;
+    }
+    v8::PropertyAttribute attributes = v8::None;
+    if (!sandbox->GetRealNamedPropertyAttributes(context, property).To(&attributes)) {
+        return v8::Intercepted::kNo;
+    }
+    info.GetReturnValue().Set(static_cast<int32_t>(attributes));
+    return v8::Intercepted::kYes;
+}
+
+// delete of a global removes it from the sandbox
+static v8::Intercepted GlobalDeleter(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Boolean>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox) ||
+        !sandbox->HasRealNamedProperty(context, property).FromMaybe(false)) {
+        return v8::Intercepted::kNo;
+    }
+    bool deleted = false;
+    if (!sandbox->Delete(context, property).To(&deleted)) {
+        return v8::Intercepted::kYes;
+    }
+    info.GetReturnValue().Set(deleted);
+    return v8::Intercepted::kYes;
+}
+
+// Enumerating the global lists the sandbox's properties
+static void GlobalEnumerator(const v8::PropertyCallbackInfo<v8::Array>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox)) {
+        return;
+    }
+    v8::Local<v8::Array> names;
+    if (sandbox->GetPropertyNames(context).ToLocal(&names)) {
+        info.GetReturnValue().Set(names);
+    }
+}
+
+// Declarations (var, function, defineProperty) define the property on the sandbox
+static v8::Intercepted GlobalDefiner(v8::Local<v8::Name> property, const v8::PropertyDescriptor& desc,
+                                     const v8::PropertyCallbackInfo<void>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox)) {
+        return v8::Intercepted::kNo;
+    }
+    v8::Isolate* isolate = info.GetIsolate();
+    v8::Local<v8::Value> undefined = v8::Undefined(isolate);
+    std::unique_ptr<v8::PropertyDescriptor> copy;
+    if (desc.has_get() || desc.has_set()) {
+        copy = std::make_unique<v8::PropertyDescriptor>(desc.has_get() ? desc.get() : undefined,
+                                                        desc.has_set() ? desc.set() : undefined);
+    } else if (desc.has_value() && desc.has_writable()) {
+        copy = std::make_unique<v8::PropertyDescriptor>(desc.value(), desc.writable());
+    } else if (desc.has_value()) {
+        copy = std::make_unique<v8::PropertyDescriptor>(desc.value());
+    } else if (desc.has_writable()) {
+        copy = std::make_unique<v8::PropertyDescriptor>(undefined, desc.writable());
+    } else {
+        copy = std::make_unique<v8::PropertyDescriptor>();
+    }
+    if (desc.has_enumerable()) {
+        copy->set_enumerable(desc.enumerable());
+    }
+    if (desc.has_configurable()) {
+        copy->set_configurable(desc.configurable());
+    }
+    sandbox->DefineProperty(context, property, *copy).IsNothing();
+    return v8::Intercepted::kYes;
+}
+
+// Object.getOwnPropertyDescriptor on the global looks at the sandbox
+static v8::Intercepted GlobalDescriptor(v8::Local<v8::Name> property, const v8::PropertyCallbackInfo<v8::Value>& info) {
+    v8::Local<v8::Context> context;
+    v8::Local<v8::Object> sandbox;
+    if (!GetSandbox(info, &context, &sandbox) ||
+        !sandbox->HasOwnProperty(context, property).FromMaybe(false)) {
+        return v8::Intercepted::kNo;
+    }
+    v8::Local<v8::Value> descriptor;
+    if (sandbox->GetOwnPropertyDescriptor(context, property).ToLocal(&descriptor)) {
+        info.GetReturnValue().Set(descriptor);
+    }
+    return v8::Intercepted::kYes;
+}
+
+// Make a blank context from the startup snapshot with the sandbox-forwarding global
+static v8::Local<v8::Context> NewBlankContext(v8::Isolate* isolate, VmBinding* binding) {
+    return v8::Context::New(isolate, nullptr, binding->global_template.Get(isolate));
+}
+
+// Top the pool back up from the event loop, outside of any makeContext() call
+static void ScheduleRefill(VmBinding* binding) {
+    if (binding->refill_scheduled) {
+        return;
+    }
+    binding->refill_scheduled = true;
+    binding->runtime->ScheduleTask([binding]() {
+        v8::Isolate* isolate = binding->runtime->GetIsolate();
+        v8::HandleScope scope(isolate);
+        binding->refill_scheduled = false;
+        while (binding->pool.size() < kContextPoolSize) {
+            binding->pool.emplace_back(isolate, NewBlankContext(isolate, binding));
+        }
+    });
+}
+
+// Take a context from the pool, making one if the pool has run dry
+static v8::Local<v8::Context> TakeContext(v8::Isolate* isolate, VmBinding* binding) {
+    v8::EscapableHandleScope scope(isolate);
+    v8::Local<v8::Context> context;
+    if (!binding->pool.empty()) {
+        context = binding->pool.back().Get(isolate);
+        binding->pool.pop_back();
+    } else {
+        context = NewBlankContext(isolate, binding);
+    }
+    ScheduleRefill(binding);
+    return scope.Escape(context);
+}
+
+// Free a vm context once it has been collected
+static void VmContextWeakCallback(const v8::WeakCallbackInfo<VmContext>& info) {
+    VmContext* vm_context = info.GetParameter();
+    vm_context->binding->contexts.erase(vm_context);
+    vm_context->context.Reset();
+    delete vm_context;
+}
+
+// Get the vm context a sandbox was contextified into, or nullptr
+static VmContext* GetVmContext(VmBinding* binding, v8::Local<v8::Context> context, v8::Local<v8::Object> sandbox) {
+    v8::Isolate* isolate = context->GetIsolate();
+    v8::Local<v8::Value> value;
+    if (!sandbox->GetPrivate(context, PropertyKeys::Get(isolate).vm_context_private_symbol()).ToLocal(&value) || !value->IsExternal()) {
+        return nullptr;
+    }
+    return static_cast<VmContext*>(value.As<v8::External>()->Value());
+}
+
+// makeContext(sandbox): attach a fresh context to sandbox; no-op if it already has one
+static void MakeContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    VmBinding* binding = static_cast<VmBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args[0]->IsObject()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    v8::Local<v8::Object> sandbox = args[0].As<v8::Object>();
+    if (GetVmContext(binding, context, sandbox)) {
+        return;
+    }
+    
+    v8::Local<v8::Context> vm_context = TakeContext(isolate, binding);
+    vm_context->SetSecurityToken(isolate->GetEnteredOrMicrotaskContext()->GetSecurityToken());
+    vm_context->SetEmbedderData(kSandboxIndex, sandbox);
+    
+    VmContext* vm = new VmContext();
+    vm->binding = binding;
+    vm->context.Reset(isolate, vm_context);
+    vm->context.SetWeak(vm, VmContextWeakCallback, v8::WeakCallbackType::kParameter);
+    binding->contexts.insert(vm);
+    
+    // The sandbox holds its VmContext, and its context's global proxy so the
+    // context lives as long as the sandbox does
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    sandbox->SetPrivate(context, keys.vm_context_private_symbol(), v8::External::New(isolate, vm)).Check();
+    sandbox->SetPrivate(context, keys.vm_global_private_symbol(), vm_context->Global()).Check();
+}
+
+// isContext(object): whether makeContext() was called on object
+static void IsContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    VmBinding* binding = static_cast<VmBinding*>(args.Data().As<v8::External>()->Value());
+    bool result = args[0]->IsObject() &&
+                  GetVmContext(binding, isolate->GetCurrentContext(), args[0].As<v8::Object>()) != nullptr;
+    args.GetReturnValue().Set(result);
+}
+
+// Free a script once its object has been collected
+static void ScriptWeakCallback(const v8::WeakCallbackInfo<ScriptHandle>& info) {
+    ScriptHandle* script = info.GetParameter();
+    script->handle.Reset();
+    script->script.Reset();
+    delete script;
+}
+
+// Get the script behind a ContextifyScript object
+static ScriptHandle* UnwrapScript(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    ScriptHandle* script = nullptr;
+    if (args.This()->InternalFieldCount() >= 1) {
+        script = static_cast<ScriptHandle*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!script) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+    }
+    return script;
+}
+
+// Serialize a script's code cache into a Uint8Array
+static v8::Local<v8::Uint8Array> CreateCachedData(v8::Isolate* isolate, v8::Local<v8::UnboundScript> script) {
+    std::unique_ptr<v8::ScriptCompiler::CachedData> cache(v8::ScriptCompiler::CreateCodeCache(script));
+    size_t length = cache ? static_cast<size_t>(cache->length) : 0;
+    std::shared_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(isolate, length);
+    if (length > 0) {
+        memcpy(store->Data(), cache->data, length);
+    }
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, store);
+    return v8::Uint8Array::New(buffer, 0, length);
+}
+
+// Constructor: new ContextifyScript(code, filename, lineOffset, columnOffset, cachedData, produceCachedData)
+static void ScriptConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    if (!args.IsConstructCall() || !args[0]->IsString() || !args[1]->IsString() ||
+        !args[2]->IsInt32() || !args[3]->IsInt32() ||
+        !(args[4]->IsUndefined() || args[4]->IsArrayBufferView())) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    // The source takes ownership of the cache descriptor, not of the bytes it points to
+    v8::ScriptCompiler::CachedData* cached_data = nullptr;
+    if (args[4]->IsArrayBufferView()) {
+        v8::Local<v8::ArrayBufferView> view = args[4].As<v8::ArrayBufferView>();
+        const uint8_t* data = static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+        cached_data = new v8::ScriptCompiler::CachedData(data, static_cast<int>(view->ByteLength()));
+    }
+    v8::ScriptOrigin origin(args[1], args[2].As<v8::Int32>()->Value(), args[3].As<v8::Int32>()->Value());
+    v8::ScriptCompiler::Source source(args[0].As<v8::String>(), origin, cached_data);
+    v8::ScriptCompiler::CompileOptions options =
+        cached_data ? v8::ScriptCompiler::kConsumeCodeCache : v8::ScriptCompiler::kNoCompileOptions;
+    
+    // Compile errors propagate to the caller as SyntaxErrors
+    v8::Local<v8::UnboundScript> unbound;
+    if (!v8::ScriptCompiler::CompileUnboundScript(isolate, &source, options).ToLocal(&unbound)) {
+        return;
+    }
+    
+    ScriptHandle* script = new ScriptHandle();
+    script->script.Reset(isolate, unbound);
+    script->handle.Reset(isolate, args.This());
+    script->handle.SetWeak(script, ScriptWeakCallback, v8::WeakCallbackType::kParameter);
+    args.This()->SetAlignedPointerInInternalField(0, script);
+    
+    if (cached_data) {
+        args.This()->Set(context, PropertyKeys::Get(isolate).cached_data_rejected_string(),
+                         v8::Boolean::New(isolate, source.GetCachedData()->rejected)).Check();
+    }
+    if (args[5]->BooleanValue(isolate)) {
+        args.This()->Set(context, PropertyKeys::Get(isolate).cached_data_string(),
+                         CreateCachedData(isolate, unbound)).Check();
+    }
+}
+
+// Thread that terminates execution in an isolate once a timeout expires, unless stopped first
+class Watchdog {
+public:
+    Watchdog(v8::Isolate* isolate, int64_t timeout_ms)
+        : isolate_(isolate), thread_([this, timeout_ms]() { Run(timeout_ms); }) {}
+    
+    ~Watchdog() {
+        Stop();
+    }
+    
+    // Stop the watchdog; returns whether it had already terminated execution
+    bool Stop() {
+        if (thread_.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopped_ = true;
+            }
+            cv_.notify_one();
+            thread_.join();
+        }
+        return timed_out_;
+    }
+    
+private:
+    void Run(int64_t timeout_ms) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this]() { return stopped_; })) {
+            timed_out_ = true;
+            isolate_->TerminateExecution();
+        }
+    }
+    
+    v8::Isolate* isolate_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stopped_ = false;
+    std::atomic<bool> timed_out_{false};
+    std::thread thread_;
+};
+
+// script.run(sandbox, timeout): run in the context of a contextified sandbox, or in the caller's for null;
+// a positive timeout in milliseconds terminates it if it runs longer
+static void ScriptRun(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    VmBinding* binding = static_cast<VmBinding*>(args.Data().As<v8::External>()->Value());
+    ScriptHandle* script = UnwrapScript(args);
+    if (!script) {
+        return;
+    }
+    
+    // The function's own context is the one it was registered in; null means the caller's
+    v8::Local<v8::Context> target = isolate->GetEnteredOrMicrotaskContext();
+    if (args[0]->IsObject()) {
+        VmContext* vm = GetVmContext(binding, context, args[0].As<v8::Object>());
+        if (!vm) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        target = vm->context.Get(isolate);
+    } else if (!args[0]->IsNullOrUndefined()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    int64_t timeout = 0;
+    if (args[1]->IsNumber()) {
+        timeout = args[1]->IntegerValue(context).FromMaybe(0);
+    }
+    
+    // Binding is cheap: the compiled code is shared by every context the script runs in
+    v8::Context::Scope context_scope(target);
+    v8::Local<v8::Script> bound = script->script.Get(isolate)->BindToCurrentContext();
+    v8::Local<v8::Value> result;
+    if (timeout <= 0) {
+        if (bound->Run(target).ToLocal(&result)) {
+            args.GetReturnValue().Set(result);
+        }
+        return;
+    }
+    
+    // A watchdog terminates the script if it is still running when the timeout expires
+    Watchdog watchdog(isolate, timeout);
+    bool ok = bound->Run(target).ToLocal(&result);
+    bool timed_out = watchdog.Stop();
+    if (timed_out) {
+        // The termination may have landed after the script finished; it is cleared either way
+        isolate->CancelTerminateExecution();
+    }
+    if (ok) {
+        args.GetReturnValue().Set(result);
+        return;
+    }
+    if (!timed_out) {
+        return;
+    }
+    std::string message = "Script execution timed out after " + std::to_string(timeout) + "ms";
+    v8::Local<v8::Object> exception = v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, message.c_str()).ToLocalChecked()).As<v8::Object>();
+    exception->Set(context, PropertyKeys::Get(isolate).code_string(),
+                   v8::String::NewFromUtf8Literal(isolate, "ERR_SCRIPT_EXECUTION_TIMEOUT")).Check();
+    isolate->ThrowException(exception);
+}
+
+// script.createCachedData(): the script's code cache as a Uint8Array
+static void ScriptCreateCachedData(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    ScriptHandle* script = UnwrapScript(args);
+    if (!script) {
+        return;
+    }
+    args.GetReturnValue().Set(CreateCachedData(isolate, script->script.Get(isolate)));
+}
+
+// Free the binding and every context still alive when the runtime is torn down
+static void CleanupBinding(VmBinding* binding) {
+    for (VmContext* vm_context : binding->contexts) {
+        vm_context->context.Reset();
+        delete vm_context;
+    }
+    binding->contexts.clear();
+    binding->pool.clear();
+    binding->global_template.Reset();
+    delete binding;
+}
+
+// Register the vm module
+void RegisterVmModule(Runtime* runtime) {
+    std::cout << "RegisterVmModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        VmBinding* binding = new VmBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        
+        // Build the global template of vm contexts
+        v8::Local<v8::ObjectTemplate> global_template = v8::ObjectTemplate::New(isolate);
+        global_template->SetHandler(v8::NamedPropertyHandlerConfiguration(
+            GlobalGetter, GlobalSetter, GlobalQuery, GlobalDeleter, GlobalEnumerator,
+            GlobalDefiner, GlobalDescriptor));
+        binding->global_template.Reset(isolate, global_template);
+        
+        // Build the ContextifyScript class
+        v8::Local<v8::FunctionTemplate> script_template = v8::FunctionTemplate::New(isolate, ScriptConstructor);
+        script_template->SetClassName(v8::String::NewFromUtf8(isolate, "ContextifyScript").ToLocalChecked());
+        script_template->InstanceTemplate()->SetInternalFieldCount(1);
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kMethods[] = {
+            {"run", ScriptRun},
+            {"createCachedData", ScriptCreateCachedData},
+        };
+        for (const auto& entry : kMethods) {
+            script_template->PrototypeTemplate()->Set(isolate, entry.name,
+                v8::FunctionTemplate::New(isolate, entry.callback, data));
+        }
+        
+        // Create the vm module object
+        v8::Local<v8::Object> vm = v8::Object::New(isolate);
+        vm->Set(context, v8::String::NewFromUtf8(isolate, "ContextifyScript").ToLocalChecked(),
+                script_template->GetFunction(context).ToLocalChecked()).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"makeContext", MakeContext},
+            {"isContext", IsContext},
+        };
+        for (const auto& entry : kFunctions) {
+            vm->Set(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                    v8::Function::New(context, entry.callback, data).ToLocalChecked()).Check();
+        }
+        
+        // Register the vm module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/vm", vm);
+        
+        std::cout << "RegisterVmModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterVmModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterVmModule" << std::endl;
+    }
+}
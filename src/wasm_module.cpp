@@ -0,0 +1,696 @@
+#include "wasm_module.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+#include "property_keys.h"
+#include "hash.h"
+#include "thread_pool.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Bytes of a .wasm file read per chunk handed to the streaming compiler
+static constexpr size_t kReadChunk = 64 * 1024;
+
+// How often the event loop wakes to pump V8's tasks while a compile is in flight
+static constexpr uint64_t kCompilePumpMs = 1;
+
+// Cache file header, followed by the serialized module
+static constexpr uint32_t kCacheMagic = 0x4d57544e;  // "NTWM"
+static constexpr uint32_t kCacheVersion = 1;
+
+struct CacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t wire_length;
+    uint64_t wire_hash;
+    uint64_t module_length;
+};
+
+// What is known about one .wasm file, keyed by its canonical path
+struct WasmEntry {
+    std::string cache_path;
+    uint64_t wire_length = 0;
+    uint64_t wire_hash = 0;
+    
+    // Whether the cache file holds the code compiled this run
+    bool cached = false;
+    
+    // The compiled module, once its compile has resolved
+    std::shared_ptr<v8::CompiledWasmModule> module;
+};
+
+// Cache state, shared with V8's compile threads and the thread pool
+struct WasmCache {
+    std::mutex mutex;
+    
+    // Empty when caching is turned off
+    std::string directory;
+    
+    // Set by the cleanup hook; late serialization callbacks are dropped
+    bool closed = false;
+    
+    std::unordered_map<std::string, std::shared_ptr<WasmEntry>> entries;
+    
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> writes{0};
+    std::atomic<uint64_t> bytes_streamed{0};
+};
+
+// Per-runtime state of internal/wasm
+struct WasmBinding {
+    Runtime* runtime = nullptr;
+    v8::Global<v8::FunctionTemplate> source_template;
+    std::shared_ptr<WasmCache> cache;
+    
+    // Streaming compilations whose promise has not settled yet
+    size_t compiling = 0;
+    uint64_t pump_task = 0;
+};
+
+// One streaming compilation of a .wasm file
+struct StreamJob {
+    Runtime* runtime = nullptr;
+    std::shared_ptr<WasmCache> cache;
+    std::shared_ptr<v8::WasmStreaming> streaming;
+    v8::Global<v8::Context> context;
+    std::string path;
+    
+    // Filled in on the thread pool
+    std::string canonical_path;
+    std::string cache_path;
+    CacheHeader cached_header = {};
+    std::vector<uint8_t> cached_module;
+    uint64_t wire_length = 0;
+    uint64_t wire_hash = 0;
+    std::string error;
+    
+    // Whether V8 took cached_module, which must then outlive Finish()
+    bool cache_accepted = false;
+};
+
+// The streaming and promise callbacks are per isolate and carry no data, so
+// they find their binding here
+static std::mutex bindings_mutex;
+static std::unordered_map<v8::Isolate*, WasmBinding*> bindings;
+
+static WasmBinding* GetBinding(v8::Isolate* isolate) {
+    std::lock_guard<std::mutex> lock(bindings_mutex);
+    auto it = bindings.find(isolate);
+    return it == bindings.end() ? nullptr : it->second;
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Default cache directory: $TINY_NODE_WASM_CACHE, else under the user's cache directory
+static std::string DefaultCacheDirectory() {
+    if (const char* directory = std::getenv("TINY_NODE_WASM_CACHE")) {
+        return directory;
+    }
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME")) {
+        if (*xdg) {
+            return std::string(xdg) + "/tiny_node/wasm";
+        }
+    }
+    if (const char* home = std::getenv("HOME")) {
+        if (*home) {
+            return std::string(home) + "/.cache/tiny_node/wasm";
+        }
+    }
+    return "";
+}
+
+// Cache file of a .wasm file, named after the hash of its canonical path
+static std::string CachePath(const std::string& directory, const std::string& canonical_path) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.wasmcache",
+                  static_cast<unsigned long long>(Xxh3Hash64(canonical_path.data(), canonical_path.size(), 0)));
+    return directory + "/" + name;
+}
+
+// Create a directory and its parents
+static bool MakeDirectories(const std::string& directory) {
+    std::string path;
+    size_t start = 0;
+    while (start <= directory.size()) {
+        size_t end = directory.find('/', start);
+        if (end == std::string::npos) {
+            end = directory.size();
+        }
+        path = directory.substr(0, end);
+        if (!path.empty() && mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+// Read all of count bytes, retrying short reads
+static bool ReadFully(int fd, void* buffer, size_t count) {
+    uint8_t* bytes = static_cast<uint8_t*>(buffer);
+    while (count > 0) {
+        ssize_t result = read(fd, bytes, count);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        bytes += result;
+        count -= static_cast<size_t>(result);
+    }
+    return true;
+}
+
+// Load a cache file; a missing or malformed one is simply not used
+static bool LoadCacheFile(const std::string& cache_path, CacheHeader* header, std::vector<uint8_t>* module) {
+    int fd = open(cache_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0 &&
+              ReadFully(fd, header, sizeof(*header)) &&
+              header->magic == kCacheMagic &&
+              header->version == kCacheVersion &&
+              header->module_length == static_cast<uint64_t>(info.st_size) - sizeof(*header);
+    if (ok) {
+        module->resize(header->module_length);
+        ok = ReadFully(fd, module->data(), module->size());
+    }
+    close(fd);
+    return ok;
+}
+
+// Write a cache file through a temporary file, so readers never see half of one
+static bool WriteCacheFile(const std::string& cache_path, const CacheHeader& header,
+                           const uint8_t* module, size_t length) {
+    size_t slash = cache_path.rfind('/');
+    if (slash != std::string::npos && !MakeDirectories(cache_path.substr(0, slash))) {
+        return false;
+    }
+    std::string temporary = cache_path + ".XXXXXX";
+    int fd = mkstemp(&temporary[0]);
+    if (fd < 0) {
+        return false;
+    }
+    bool ok = write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header));
+    while (ok && length > 0) {
+        ssize_t result = write(fd, module, length);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        ok = result > 0;
+        if (ok) {
+            module += result;
+            length -= static_cast<size_t>(result);
+        }
+    }
+    ok = close(fd) == 0 && ok && rename(temporary.c_str(), cache_path.c_str()) == 0;
+    if (!ok) {
+        unlink(temporary.c_str());
+    }
+    return ok;
+}
+
+// Serialize a compiled module and write its cache file; safe on any thread.
+// V8 only serializes modules with optimized code, so until tier-up has run
+// this fails and the entry stays uncached for a later attempt.
+static bool SaveModule(WasmCache* cache, WasmEntry* entry, v8::CompiledWasmModule& module) {
+    v8::OwnedBuffer serialized = module.Serialize();
+    CacheHeader header = {kCacheMagic, kCacheVersion, entry->wire_length, entry->wire_hash, serialized.size};
+    if (serialized.size == 0 ||
+        !WriteCacheFile(entry->cache_path, header, serialized.buffer.get(), serialized.size)) {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        entry->cached = false;
+        return false;
+    }
+    cache->writes++;
+    return true;
+}
+
+// Keep the event loop awake while compilations are in flight. The task does
+// nothing itself: each loop iteration that runs it also pumps the isolate's
+// platform tasks, which is where V8 finishes compiles and resolves promises.
+static void PumpCompiles(WasmBinding* binding) {
+    if (binding->compiling == 0) {
+        binding->pump_task = 0;
+        return;
+    }
+    binding->pump_task = binding->runtime->ScheduleDelayedTask([binding]() {
+        PumpCompiles(binding);
+    }, kCompilePumpMs);
+}
+
+// Read a .wasm file on the thread pool, passing chunks to the event loop.
+// They go through the completion lane, which never holds back a shared pool
+// thread, ahead of the completion that finishes the stream.
+static void ReadSource(std::shared_ptr<StreamJob> job) {
+    EventLoop* loop = job->runtime->GetEventLoop();
+    char resolved[PATH_MAX];
+    if (!realpath(job->path.c_str(), resolved)) {
+        job->error = "Failed to open " + job->path + ": " + std::strerror(errno);
+        return;
+    }
+    job->canonical_path = resolved;
+    int fd = open(resolved, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        job->error = "Failed to open " + job->path + ": " + std::strerror(errno);
+        return;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    
+    {
+        std::lock_guard<std::mutex> lock(job->cache->mutex);
+        if (!job->cache->directory.empty()) {
+            job->cache_path = CachePath(job->cache->directory, job->canonical_path);
+        }
+    }
+    if (!job->cache_path.empty() && !LoadCacheFile(job->cache_path, &job->cached_header, &job->cached_module)) {
+        job->cached_module.clear();
+    }
+    
+    // The cached module must reach V8 before the first chunk does
+    loop->ScheduleCompletion([job]() {
+        if (!job->cached_module.empty()) {
+            job->cache_accepted = job->streaming->SetCompiledModuleBytes(
+                job->cached_module.data(), job->cached_module.size());
+        }
+    });
+    
+    std::unique_ptr<Hasher> hasher = Hasher::Create(HashAlgorithm::kXxh3);
+    while (true) {
+        auto chunk = std::make_shared<std::vector<uint8_t>>(kReadChunk);
+        ssize_t count = read(fd, chunk->data(), chunk->size());
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            job->error = "Failed to read " + job->path + ": " + std::strerror(errno);
+            break;
+        }
+        if (count == 0) {
+            break;
+        }
+        chunk->resize(static_cast<size_t>(count));
+        hasher->Update(chunk->data(), chunk->size());
+        job->wire_length += chunk->size();
+        loop->ScheduleCompletion([job, chunk]() {
+            v8::HandleScope scope(job->runtime->GetIsolate());
+            job->streaming->OnBytesReceived(chunk->data(), chunk->size());
+        });
+    }
+    close(fd);
+    
+    uint8_t digest[8];
+    hasher->Final(digest);
+    std::memcpy(&job->wire_hash, digest, sizeof(digest));
+    job->cache->bytes_streamed += job->wire_length;
+}
+
+// Finish a streaming compilation once every chunk has been passed on
+static void FinishStream(const std::shared_ptr<StreamJob>& job) {
+    v8::Isolate* isolate = job->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = job->context.Get(isolate);
+    v8::Context::Scope context_scope(context);
+    job->context.Reset();
+    
+    if (!job->error.empty()) {
+        job->streaming->Abort(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, job->error.c_str()).ToLocalChecked()));
+        return;
+    }
+    
+    // V8 checks that the cache came from this V8 and these flags; we check the wire bytes
+    bool use_cache = job->cache_accepted &&
+                     job->cached_header.wire_length == job->wire_length &&
+                     job->cached_header.wire_hash == job->wire_hash;
+    WasmCache* cache = job->cache.get();
+    if (job->cache_path.empty()) {
+        // Caching is off
+    } else if (use_cache) {
+        cache->hits++;
+    } else if (job->cached_module.empty()) {
+        cache->misses++;
+    } else {
+        cache->rejected++;
+    }
+    
+    std::shared_ptr<WasmEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        std::shared_ptr<WasmEntry>& slot = cache->entries[job->canonical_path];
+        slot = std::make_shared<WasmEntry>();
+        slot->cache_path = job->cache_path;
+        slot->wire_length = job->wire_length;
+        slot->wire_hash = job->wire_hash;
+        slot->cached = use_cache || job->cache_path.empty();
+        entry = slot;
+    }
+    
+    // Called, possibly on a compile thread, whenever tier-up has produced enough
+    // new code. V8 keeps the callback as long as the module lives, and the entry
+    // holds the module, so the callback only holds weak references.
+    if (!job->cache_path.empty()) {
+        std::weak_ptr<WasmCache> weak_cache = job->cache;
+        std::weak_ptr<WasmEntry> weak_entry = entry;
+        job->streaming->SetMoreFunctionsCanBeSerializedCallback(
+            [weak_cache, weak_entry](v8::CompiledWasmModule module) {
+                std::shared_ptr<WasmCache> cache = weak_cache.lock();
+                std::shared_ptr<WasmEntry> entry = weak_entry.lock();
+                if (!cache || !entry) {
+                    return;
+                }
+                auto compiled = std::make_shared<v8::CompiledWasmModule>(module);
+                {
+                    std::lock_guard<std::mutex> lock(cache->mutex);
+                    if (cache->closed) {
+                        return;
+                    }
+                    entry->cached = true;
+                }
+                ThreadPool::GetDefault()->Submit([cache, entry, compiled]() {
+                    SaveModule(cache.get(), entry.get(), *compiled);
+                });
+            });
+    }
+    
+    // The URL is how ResolvePromise() finds the entry of the compiled module
+    job->streaming->SetUrl(job->canonical_path.data(), job->canonical_path.size());
+    job->streaming->Finish(use_cache);
+}
+
+// Streaming callback for WebAssembly.compileStreaming() and instantiateStreaming()
+static void StreamingCallback(const v8::FunctionCallbackInfo<v8::Value>& info) {
+    v8::Isolate* isolate = info.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    std::shared_ptr<v8::WasmStreaming> streaming = v8::WasmStreaming::Unpack(isolate, info.Data());
+    
+    WasmBinding* binding = GetBinding(isolate);
+    if (!binding) {
+        streaming->Abort(v8::Exception::Error(
+            v8::String::NewFromUtf8Literal(isolate, "WebAssembly streaming is not available")));
+        return;
+    }
+    
+    // Every streaming compile, a failed one too, settles through ResolvePromise()
+    if (binding->compiling++ == 0 && binding->pump_task == 0) {
+        PumpCompiles(binding);
+    }
+    if (!binding->source_template.Get(isolate)->HasInstance(info[0])) {
+        streaming->Abort(v8::Exception::TypeError(v8::String::NewFromUtf8(isolate,
+            "WebAssembly.compileStreaming() expects a WasmSource from require('wasm').source()").ToLocalChecked()));
+        return;
+    }
+    v8::Local<v8::Value> path = info[0].As<v8::Object>()->GetInternalField(0).As<v8::Value>();
+    
+    auto job = std::make_shared<StreamJob>();
+    job->runtime = binding->runtime;
+    job->cache = binding->cache;
+    job->streaming = streaming;
+    job->context.Reset(isolate, context);
+    job->path = *v8::String::Utf8Value(isolate, path);
+    binding->runtime->QueueWork([job]() {
+        ReadSource(job);
+    }, [job]() {
+        FinishStream(job);
+    });
+}
+
+// Settle the promise of an asynchronous WebAssembly operation
+static void ResolvePromise(v8::Isolate* isolate, v8::Local<v8::Context> context,
+                           v8::Local<v8::Promise::Resolver> resolver, v8::Local<v8::Value> result,
+                           v8::WasmAsyncSuccess success) {
+    WasmBinding* binding = GetBinding(isolate);
+    
+    // Remember the compiled module of a streamed file, for flushCache() and shutdown
+    if (binding && success == v8::WasmAsyncSuccess::kSuccess) {
+        v8::Local<v8::Value> module = result;
+        if (!module->IsWasmModuleObject() && result->IsObject()) {
+            v8::Local<v8::Value> value;
+            if (result.As<v8::Object>()->Get(context, PropertyKeys::Get(isolate).module_string()).ToLocal(&value)) {
+                module = value;
+            }
+        }
+        if (module->IsWasmModuleObject()) {
+            auto compiled = std::make_shared<v8::CompiledWasmModule>(
+                module.As<v8::WasmModuleObject>()->GetCompiledModule());
+            std::lock_guard<std::mutex> lock(binding->cache->mutex);
+            auto it = binding->cache->entries.find(compiled->source_url());
+            if (it != binding->cache->entries.end() && !it->second->module) {
+                it->second->module = compiled;
+            }
+        }
+    }
+    
+    // Non-streaming WebAssembly.compile() also settles here, so never count below zero
+    if (binding && binding->compiling > 0) {
+        binding->compiling--;
+    }
+    
+    if (success == v8::WasmAsyncSuccess::kSuccess) {
+        resolver->Resolve(context, result).IsNothing();
+    } else {
+        resolver->Reject(context, result).IsNothing();
+    }
+}
+
+// Entries whose compiled module is not in the cache yet
+static std::vector<std::shared_ptr<WasmEntry>> TakeUncached(WasmCache* cache) {
+    std::vector<std::shared_ptr<WasmEntry>> uncached;
+    for (auto& pair : cache->entries) {
+        WasmEntry* entry = pair.second.get();
+        if (!entry->cached && entry->module && !entry->cache_path.empty()) {
+            entry->cached = true;
+            uncached.push_back(pair.second);
+        }
+    }
+    return uncached;
+}
+
+// WasmSource constructor
+static void SourceConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    if (!args.IsConstructCall()) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Class constructor WasmSource cannot be invoked without 'new'").ToLocalChecked()));
+        return;
+    }
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    args.This()->SetInternalField(0, args[0]);
+    args.This()->Set(isolate->GetCurrentContext(), PropertyKeys::Get(isolate).path_string(), args[0]).Check();
+}
+
+// Native setCacheDirectory function
+static void SetCacheDirectory(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    WasmBinding* binding = static_cast<WasmBinding*>(args.Data().As<v8::External>()->Value());
+    
+    if (args.Length() < 1 || !(args[0]->IsString() || args[0]->IsNull())) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    std::string directory = args[0]->IsString() ? *v8::String::Utf8Value(isolate, args[0]) : "";
+    
+    std::lock_guard<std::mutex> lock(binding->cache->mutex);
+    binding->cache->directory = directory;
+}
+
+// Native cacheDirectory function
+static void CacheDirectory(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    WasmBinding* binding = static_cast<WasmBinding*>(args.Data().As<v8::External>()->Value());
+    
+    std::lock_guard<std::mutex> lock(binding->cache->mutex);
+    if (binding->cache->directory.empty()) {
+        args.GetReturnValue().SetNull();
+    } else {
+        args.GetReturnValue().Set(v8::String::NewFromUtf8(isolate, binding->cache->directory.c_str()).ToLocalChecked());
+    }
+}
+
+// Native flushCache function: serialize and write uncached modules on the thread pool
+static void FlushCache(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetEnteredOrMicrotaskContext();
+    WasmBinding* binding = static_cast<WasmBinding*>(args.Data().As<v8::External>()->Value());
+    
+    v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(context).ToLocalChecked();
+    args.GetReturnValue().Set(resolver->GetPromise());
+    
+    std::shared_ptr<WasmCache> cache = binding->cache;
+    std::vector<std::shared_ptr<WasmEntry>> uncached;
+    {
+        std::lock_guard<std::mutex> lock(cache->mutex);
+        uncached = TakeUncached(cache.get());
+    }
+    
+    auto persistent_resolver = std::make_shared<v8::Global<v8::Promise::Resolver>>(isolate, resolver);
+    auto persistent_context = std::make_shared<v8::Global<v8::Context>>(isolate, context);
+    auto written = std::make_shared<uint32_t>(0);
+    binding->runtime->QueueWork([cache, uncached, written]() {
+        for (const auto& entry : uncached) {
+            if (SaveModule(cache.get(), entry.get(), *entry->module)) {
+                (*written)++;
+            }
+        }
+    }, [isolate, persistent_resolver, persistent_context, written]() {
+        v8::HandleScope handle_scope(isolate);
+        v8::Local<v8::Context> context = persistent_context->Get(isolate);
+        v8::Context::Scope context_scope(context);
+        persistent_resolver->Get(isolate)->Resolve(context, v8::Integer::NewFromUnsigned(isolate, *written)).Check();
+        persistent_resolver->Reset();
+        persistent_context->Reset();
+    });
+}
+
+// Native stats function
+static void Stats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    WasmBinding* binding = static_cast<WasmBinding*>(args.Data().As<v8::External>()->Value());
+    WasmCache* cache = binding->cache.get();
+    
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    const struct {
+        v8::Local<v8::String> name;
+        double value;
+    } fields[] = {
+        {keys.compiling_string(), static_cast<double>(binding->compiling)},
+        {keys.cache_hits_string(), static_cast<double>(cache->hits)},
+        {keys.cache_misses_string(), static_cast<double>(cache->misses)},
+        {keys.cache_rejected_string(), static_cast<double>(cache->rejected)},
+        {keys.cache_writes_string(), static_cast<double>(cache->writes)},
+        {keys.bytes_streamed_string(), static_cast<double>(cache->bytes_streamed)},
+    };
+    v8::Local<v8::Object> stats = v8::Object::New(isolate);
+    for (const auto& field : fields) {
+        stats->Set(context, field.name, v8::Number::New(isolate, field.value)).Check();
+    }
+    args.GetReturnValue().Set(stats);
+}
+
+// Write what is still uncached, then release the binding
+static void CleanupBinding(WasmBinding* binding) {
+    std::vector<std::shared_ptr<WasmEntry>> uncached;
+    {
+        std::lock_guard<std::mutex> lock(binding->cache->mutex);
+        binding->cache->closed = true;
+        uncached = TakeUncached(binding->cache.get());
+    }
+    for (const auto& entry : uncached) {
+        SaveModule(binding->cache.get(), entry.get(), *entry->module);
+    }
+    
+    // Compiled modules must not outlive the isolate
+    {
+        std::lock_guard<std::mutex> lock(binding->cache->mutex);
+        binding->cache->entries.clear();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(bindings_mutex);
+        bindings.erase(binding->runtime->GetIsolate());
+    }
+    if (binding->pump_task != 0) {
+        binding->runtime->CancelDelayedTask(binding->pump_task);
+    }
+    binding->source_template.Reset();
+    delete binding;
+}
+
+// Register the wasm module
+void RegisterWasmModule(Runtime* runtime) {
+    std::cout << "RegisterWasmModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        WasmBinding* binding = new WasmBinding();
+        binding->runtime = runtime;
+        binding->cache = std::make_shared<WasmCache>();
+        binding->cache->directory = DefaultCacheDirectory();
+        {
+            std::lock_guard<std::mutex> lock(bindings_mutex);
+            bindings[isolate] = binding;
+        }
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        
+        // Contexts created from here on get WebAssembly.compileStreaming()
+        isolate->SetWasmStreamingCallback(StreamingCallback);
+        isolate->SetWasmAsyncResolvePromiseCallback(ResolvePromise);
+        
+        // Build the WasmSource class
+        v8::Local<v8::FunctionTemplate> source_template = v8::FunctionTemplate::New(isolate, SourceConstructor);
+        source_template->SetClassName(v8::String::NewFromUtf8(isolate, "WasmSource").ToLocalChecked());
+        source_template->InstanceTemplate()->SetInternalFieldCount(1);
+        binding->source_template.Reset(isolate, source_template);
+        
+        // Create the wasm module object
+        v8::Local<v8::Object> wasm = v8::Object::New(isolate);
+        wasm->Set(context, v8::String::NewFromUtf8(isolate, "WasmSource").ToLocalChecked(),
+                  source_template->GetFunction(context).ToLocalChecked()).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"setCacheDirectory", SetCacheDirectory},
+            {"cacheDirectory", CacheDirectory},
+            {"flushCache", FlushCache},
+            {"stats", Stats},
+        };
+        for (const auto& entry : kFunctions) {
+            wasm->Set(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                      v8::Function::New(context, entry.callback, data).ToLocalChecked()).Check();
+        }
+        
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/wasm", wasm);
+        
+        std::cout << "RegisterWasmModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterWasmModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterWasmModule" << std::endl;
+    }
+}
@@ -0,0 +1,866 @@
+#include "workerpool_module.h"
+#include "runtime.h"
+#include "event_loop.h"
+#include "module.h"
+#include "property_keys.h"
+#include "v8_module.h"
+#include <uv.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// How long a worker waiting for an asynchronous task pumps its loop between cancellation checks
+static constexpr uint64_t kPumpIntervalMs = 5;
+
+// Largest number of workers a pool may start
+static constexpr uint32_t kMaxPoolSize = 1024;
+
+// Outcome of a task, as reported to oncomplete()
+enum TaskStatus : int {
+    kTaskOk = 0,
+    kTaskError = 1,
+    kTaskCancelled = 2,
+    kTaskTimedOut = 3,
+};
+
+// Script each worker runtime runs once, at startup, to register its dispatcher
+static const char* kWorkerBootstrap = "require('workerpool')._setupWorker();";
+
+struct WorkerPool;
+
+// A submitted task, owned by its pool until the outcome has been delivered
+struct Task {
+    int64_t id = 0;
+    std::string code;
+    bool is_path = false;
+    SerializedValue args;
+    uint64_t timer_id = 0;
+    
+    // Set once by cancel() or the timeout, and read by the worker running the task
+    std::atomic<int> cancel_status{kTaskOk};
+    
+    // Filled in on the worker thread
+    int status = kTaskOk;
+    bool settled = false;
+    SerializedValue result;
+};
+
+// A worker thread and the runtime it owns
+struct Worker {
+    WorkerPool* pool = nullptr;
+    size_t index = 0;
+    std::thread thread;
+    
+    // Tasks waiting for this worker; the worker takes from the front, thieves from the back
+    std::mutex mutex;
+    std::deque<Task*> queue;
+    Task* running = nullptr;
+    v8::Isolate* isolate = nullptr;
+    
+    // Worker-side state, only used on the worker thread
+    Runtime* runtime = nullptr;
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> dispatch;
+    v8::Global<v8::Function> done;
+};
+
+// Per-runtime state of internal/workerpool
+struct WorkerPoolBinding {
+    Runtime* runtime = nullptr;
+    
+    // Context the callbacks run in, set by setup()
+    v8::Global<v8::Context> context;
+    v8::Global<v8::Function> oncomplete;
+    
+    // Running pools, stopped by the cleanup hook when the runtime goes away
+    std::unordered_set<WorkerPool*> pools;
+};
+
+// A fixed set of workers and the tasks submitted to them
+//
+// Fields under "owner" are only used on the thread of the runtime that
+// created the pool; the rest is shared with the workers.
+struct WorkerPool {
+    WorkerPoolBinding* binding = nullptr;
+    std::vector<std::unique_ptr<Worker>> workers;
+    
+    // Worker i is pinned to slot i of the affinity
+    CpuAffinity affinity;
+    
+    // Idle workers sleep on wake_cv until something is queued
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic<int64_t> queued{0};
+    std::atomic<bool> stopping{false};
+    
+    // Finished tasks waiting for the owning loop, which async wakes up
+    std::mutex completed_mutex;
+    std::deque<Task*> completed;
+    uv_async_t* async = nullptr;
+    
+    // Shared counters
+    std::atomic<int64_t> running{0};
+    std::atomic<uint64_t> stolen{0};
+    
+    // Owner: the pool object, held until terminate(), and tasks not delivered yet
+    v8::Global<v8::Object> object;
+    std::unordered_map<int64_t, Task*> tasks;
+    size_t next_worker = 0;
+    int64_t max_queued = 0;
+    uint64_t submitted = 0;
+    uint64_t succeeded = 0;
+    uint64_t failed = 0;
+    uint64_t cancelled = 0;
+    uint64_t timed_out = 0;
+};
+
+// The worker running on this thread, if any
+static thread_local Worker* current_worker = nullptr;
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Fail a task with an exception, or with its message if the exception cannot be cloned
+static void SettleWithException(v8::Local<v8::Context> context, Task* task, v8::Local<v8::Value> exception) {
+    v8::Isolate* isolate = context->GetIsolate();
+    task->status = kTaskError;
+    task->settled = true;
+    task->result = SerializedValue();
+    
+    v8::TryCatch try_catch(isolate);
+    if (!exception.IsEmpty() && SerializeValue(context, exception, {}, &task->result)) {
+        return;
+    }
+    try_catch.Reset();
+    v8::String::Utf8Value message(isolate, exception);
+    v8::Local<v8::Value> error = v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, *message ? *message : "Task failed").ToLocalChecked());
+    task->result = SerializedValue();
+    SerializeValue(context, error, {}, &task->result);
+}
+
+// Fail a task with a new Error
+static void SettleWithMessage(v8::Local<v8::Context> context, Task* task, const char* message) {
+    v8::Isolate* isolate = context->GetIsolate();
+    SettleWithException(context, task, v8::Exception::Error(v8::String::NewFromUtf8(isolate, message).ToLocalChecked()));
+}
+
+// Take the next task: from the front of the worker's own deque, else from the back of another's
+static Task* NextTask(Worker* worker) {
+    WorkerPool* pool = worker->pool;
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        if (!worker->queue.empty()) {
+            Task* task = worker->queue.front();
+            worker->queue.pop_front();
+            worker->running = task;
+            pool->queued--;
+            return task;
+        }
+    }
+    
+    size_t count = pool->workers.size();
+    for (size_t i = 1; i < count; i++) {
+        Worker* victim = pool->workers[(worker->index + i) % count].get();
+        Task* task = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            if (victim->queue.empty()) {
+                continue;
+            }
+            task = victim->queue.back();
+            victim->queue.pop_back();
+        }
+        pool->queued--;
+        pool->stolen++;
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->running = task;
+        return task;
+    }
+    return nullptr;
+}
+
+// Run a task in the worker's runtime until it settles or is cancelled
+static void RunTask(Worker* worker, Task* task) {
+    WorkerPool* pool = worker->pool;
+    
+    // Cancelled between leaving its queue and starting
+    if (task->cancel_status != kTaskOk || pool->stopping) {
+        task->status = task->cancel_status != kTaskOk ? task->cancel_status.load() : kTaskCancelled;
+    } else {
+        Runtime* runtime = worker->runtime;
+        v8::Isolate* isolate = worker->isolate;
+        pool->running++;
+        {
+            v8::Locker locker(isolate);
+            v8::Isolate::Scope isolate_scope(isolate);
+            v8::HandleScope scope(isolate);
+            v8::Local<v8::Context> context =
+                worker->context.IsEmpty() ? v8::Context::New(isolate) : worker->context.Get(isolate);
+            v8::Context::Scope context_scope(context);
+            
+            v8::TryCatch try_catch(isolate);
+            v8::Local<v8::Value> args;
+            if (worker->dispatch.IsEmpty()) {
+                SettleWithMessage(context, task, "Worker runtime failed to start");
+            } else if (!DeserializeValue(context, &task->args).ToLocal(&args)) {
+                SettleWithException(context, task, try_catch.Exception());
+            } else {
+                v8::Local<v8::Value> argv[] = {
+                    v8::Number::New(isolate, static_cast<double>(task->id)),
+                    v8::String::NewFromUtf8(isolate, task->code.data(), v8::NewStringType::kNormal,
+                                            static_cast<int>(task->code.size())).ToLocalChecked(),
+                    v8::Boolean::New(isolate, task->is_path),
+                    args,
+                    worker->done.Get(isolate),
+                };
+                worker->dispatch.Get(isolate)->Call(context, v8::Undefined(isolate), 5, argv).IsEmpty();
+                isolate->PerformMicrotaskCheckpoint();
+            }
+        }
+        
+        // Asynchronous tasks settle from the worker's own event loop
+        while (!task->settled && task->cancel_status == kTaskOk) {
+            if (!runtime->HasPendingWork()) {
+                v8::Locker locker(isolate);
+                v8::Isolate::Scope isolate_scope(isolate);
+                v8::HandleScope scope(isolate);
+                v8::Local<v8::Context> context = worker->context.Get(isolate);
+                v8::Context::Scope context_scope(context);
+                SettleWithMessage(context, task, "Task returned a promise that can never settle");
+                break;
+            }
+            runtime->PumpEventLoop(kPumpIntervalMs);
+        }
+        pool->running--;
+        
+        // A termination can also cut short the reporting of a result
+        if (!task->settled || (task->cancel_status != kTaskOk && task->result.length == 0)) {
+            task->status = task->cancel_status;
+        }
+    }
+    
+    // Stop being the running task before clearing a termination that was meant for it
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->running = nullptr;
+    }
+    v8::Locker locker(worker->isolate);
+    worker->isolate->CancelTerminateExecution();
+}
+
+// Main function of each worker thread
+static void WorkerMain(Worker* worker) {
+    WorkerPool* pool = worker->pool;
+    
+    // Pin before the runtime exists so its heap is allocated on the worker's node
+    pool->affinity.ApplyToCurrentThread(worker->index);
+    
+    // The runtime is made once and serves every task this worker runs
+    RuntimeOptions options;
+    options.own_loop_thread = false;
+    Runtime runtime(options);
+    worker->runtime = &runtime;
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->isolate = runtime.GetIsolate();
+    }
+    current_worker = worker;
+    if (!runtime.ExecuteString(kWorkerBootstrap, "workerpool:worker") || worker->dispatch.IsEmpty()) {
+        std::cerr << "Worker pool: worker " << worker->index << " failed to start" << std::endl;
+    }
+    
+    while (true) {
+        Task* task = NextTask(worker);
+        if (!task) {
+            std::unique_lock<std::mutex> lock(pool->wake_mutex);
+            if (pool->stopping) {
+                break;
+            }
+            pool->wake_cv.wait(lock, [pool]() { return pool->queued > 0 || pool->stopping; });
+            continue;
+        }
+        
+        RunTask(worker, task);
+        
+        // Hand the outcome to the owning loop
+        {
+            std::lock_guard<std::mutex> lock(pool->completed_mutex);
+            pool->completed.push_back(task);
+        }
+        uv_async_send(pool->async);
+    }
+    
+    // Release worker-side handles before the runtime goes away
+    {
+        v8::Locker locker(worker->isolate);
+        v8::Isolate::Scope isolate_scope(worker->isolate);
+        worker->dispatch.Reset();
+        worker->done.Reset();
+        worker->context.Reset();
+    }
+    current_worker = nullptr;
+    std::lock_guard<std::mutex> lock(worker->mutex);
+    worker->isolate = nullptr;
+    worker->runtime = nullptr;
+}
+
+// done(id, ok, value, transfer): report the outcome of the running task (worker side)
+static void TaskDone(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    Worker* worker = static_cast<Worker*>(args.Data().As<v8::External>()->Value());
+    
+    // Late calls from tasks that were cancelled or have already settled are ignored
+    Task* task = worker->running;
+    if (!task || task->settled || !args[0]->IsNumber() ||
+        args[0].As<v8::Number>()->Value() != static_cast<double>(task->id)) {
+        return;
+    }
+    
+    v8::TryCatch try_catch(isolate);
+    std::vector<v8::Local<v8::ArrayBuffer>> transfer;
+    if (args[3]->IsArray()) {
+        v8::Local<v8::Array> list = args[3].As<v8::Array>();
+        for (uint32_t i = 0; i < list->Length(); i++) {
+            v8::Local<v8::Value> entry;
+            if (!list->Get(context, i).ToLocal(&entry)) {
+                SettleWithException(context, task, try_catch.Exception());
+                return;
+            }
+            if (!entry->IsArrayBuffer()) {
+                SettleWithMessage(context, task, "Transfer list entries must be ArrayBuffers");
+                return;
+            }
+            transfer.push_back(entry.As<v8::ArrayBuffer>());
+        }
+    }
+    
+    // A result that cannot be cloned fails the task with the clone error
+    if (!SerializeValue(context, args[2], transfer, &task->result)) {
+        SettleWithException(context, task, try_catch.Exception());
+        return;
+    }
+    task->status = args[1]->BooleanValue(isolate) ? kTaskOk : kTaskError;
+    task->settled = true;
+}
+
+// Keep the owning loop alive only while tasks are outstanding
+static void UpdateRef(WorkerPool* pool) {
+    uv_handle_t* handle = reinterpret_cast<uv_handle_t*>(pool->async);
+    if (pool->tasks.empty()) {
+        uv_unref(handle);
+    } else {
+        uv_ref(handle);
+    }
+}
+
+// Hand a task's outcome to JavaScript and free it
+static void DeliverTask(WorkerPool* pool, Task* task) {
+    WorkerPoolBinding* binding = pool->binding;
+    std::unique_ptr<Task> owned(task);
+    pool->tasks.erase(task->id);
+    if (task->timer_id != 0) {
+        binding->runtime->CancelDelayedTask(task->timer_id);
+    }
+    switch (task->status) {
+        case kTaskOk: pool->succeeded++; break;
+        case kTaskError: pool->failed++; break;
+        case kTaskTimedOut: pool->timed_out++; break;
+        default: pool->cancelled++; break;
+    }
+    if (binding->oncomplete.IsEmpty() || pool->object.IsEmpty()) {
+        return;
+    }
+    
+    v8::Isolate* isolate = binding->runtime->GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = binding->context.Get(isolate);
+    v8::Context::Scope context_scope(context);
+    v8::TryCatch try_catch(isolate);
+    
+    int status = task->status;
+    v8::Local<v8::Value> value = v8::Undefined(isolate);
+    if ((status == kTaskOk || status == kTaskError) && !DeserializeValue(context, &task->result).ToLocal(&value)) {
+        status = kTaskError;
+        value = try_catch.Exception();
+        try_catch.Reset();
+    }
+    
+    v8::Local<v8::Value> argv[] = {
+        v8::Number::New(isolate, static_cast<double>(task->id)),
+        v8::Integer::New(isolate, status),
+        value,
+    };
+    if (binding->oncomplete.Get(isolate)->Call(context, pool->object.Get(isolate), 3, argv).IsEmpty() &&
+        try_catch.HasCaught()) {
+        v8::String::Utf8Value error(isolate, try_catch.Exception());
+        std::cerr << "Uncaught exception in workerpool callback: " << *error << std::endl;
+    }
+    
+    // Settle promises resolved by the callback, as after any loop task
+    isolate->PerformMicrotaskCheckpoint();
+}
+
+// Deliver every finished task; one wakeup may cover many
+static void OnTasksCompleted(uv_async_t* handle) {
+    WorkerPool* pool = static_cast<WorkerPool*>(handle->data);
+    while (!pool->stopping) {
+        Task* task = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(pool->completed_mutex);
+            if (pool->completed.empty()) {
+                break;
+            }
+            task = pool->completed.front();
+            pool->completed.pop_front();
+        }
+        DeliverTask(pool, task);
+    }
+    if (!pool->stopping) {
+        UpdateRef(pool);
+    }
+}
+
+// Cancel a task with status: a queued one is reported at once, a running one is terminated
+static bool CancelTask(WorkerPool* pool, int64_t id, int status) {
+    auto it = pool->tasks.find(id);
+    if (it == pool->tasks.end() || pool->stopping) {
+        return false;
+    }
+    Task* task = it->second;
+    int expected = kTaskOk;
+    if (!task->cancel_status.compare_exchange_strong(expected, status)) {
+        return false;
+    }
+    
+    bool dequeued = false;
+    for (auto& worker : pool->workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        auto queued = std::find(worker->queue.begin(), worker->queue.end(), task);
+        if (queued != worker->queue.end()) {
+            worker->queue.erase(queued);
+            dequeued = true;
+            break;
+        }
+        if (worker->running == task) {
+            worker->isolate->TerminateExecution();
+            break;
+        }
+    }
+    if (dequeued) {
+        pool->queued--;
+        task->status = status;
+        DeliverTask(pool, task);
+        UpdateRef(pool);
+    }
+    return true;
+}
+
+// Stop the workers and wait for their threads; running tasks are terminated
+static void StopWorkers(WorkerPool* pool) {
+    {
+        std::lock_guard<std::mutex> lock(pool->wake_mutex);
+        pool->stopping = true;
+    }
+    for (auto& worker : pool->workers) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->queue.clear();
+        if (worker->running) {
+            int expected = kTaskOk;
+            worker->running->cancel_status.compare_exchange_strong(expected, kTaskCancelled);
+            worker->isolate->TerminateExecution();
+        }
+    }
+    pool->queued = 0;
+    pool->wake_cv.notify_all();
+    for (auto& worker : pool->workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+// Close the pool's async handle; the pool is freed once libuv is done with it
+static void ClosePool(WorkerPool* pool) {
+    pool->binding->pools.erase(pool);
+    pool->object.Reset();
+    uv_close(reinterpret_cast<uv_handle_t*>(pool->async), [](uv_handle_t* handle) {
+        WorkerPool* pool = static_cast<WorkerPool*>(handle->data);
+        delete reinterpret_cast<uv_async_t*>(handle);
+        delete pool;
+    });
+}
+
+// Get the pool behind a WorkerPool object
+static WorkerPool* UnwrapPool(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    WorkerPool* pool = nullptr;
+    if (args.This()->InternalFieldCount() >= 1) {
+        pool = static_cast<WorkerPool*>(args.This()->GetAlignedPointerFromInternalField(0));
+    }
+    if (!pool) {
+        args.GetIsolate()->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(args.GetIsolate(), "Illegal invocation").ToLocalChecked()));
+    }
+    return pool;
+}
+
+// Constructor: new WorkerPool(size, affinity)
+static void PoolConstructor(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    WorkerPoolBinding* binding = static_cast<WorkerPoolBinding*>(args.Data().As<v8::External>()->Value());
+    if (!args.IsConstructCall() || !args[0]->IsUint32() || args[0].As<v8::Uint32>()->Value() == 0 ||
+        args[0].As<v8::Uint32>()->Value() > kMaxPoolSize) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    uint32_t size = args[0].As<v8::Uint32>()->Value();
+    
+    // An affinity string pins the workers; without one the runtime's default applies
+    CpuAffinity affinity = binding->runtime->GetOptions().worker_affinity;
+    if (args[1]->IsString()) {
+        v8::String::Utf8Value spec(isolate, args[1]);
+        std::string error;
+        if (!CpuAffinity::Parse(*spec, &affinity, &error)) {
+            isolate->ThrowException(v8::Exception::RangeError(
+                v8::String::NewFromUtf8(isolate, error.c_str()).ToLocalChecked()));
+            return;
+        }
+    }
+    
+    WorkerPool* pool = new WorkerPool();
+    pool->binding = binding;
+    pool->affinity = affinity;
+    pool->object.Reset(isolate, args.This());
+    pool->async = new uv_async_t();
+    uv_async_init(binding->runtime->GetEventLoop()->GetUvLoop(), pool->async, OnTasksCompleted);
+    pool->async->data = pool;
+    uv_unref(reinterpret_cast<uv_handle_t*>(pool->async));
+    args.This()->SetAlignedPointerInInternalField(0, pool);
+    binding->pools.insert(pool);
+    
+    // Every worker exists before any thread starts looking for tasks to steal
+    for (uint32_t i = 0; i < size; i++) {
+        std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+        worker->pool = pool;
+        worker->index = i;
+        pool->workers.push_back(std::move(worker));
+    }
+    for (auto& worker : pool->workers) {
+        worker->thread = std::thread(WorkerMain, worker.get());
+    }
+}
+
+// pool.submit(id, code, isPath, args, transfer, timeoutMs): queue a task; its outcome goes to oncomplete
+static void PoolSubmit(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    WorkerPool* pool = UnwrapPool(args);
+    if (!pool) {
+        return;
+    }
+    if (!args[0]->IsNumber() || !args[1]->IsString() || !args[3]->IsArray() || !args[4]->IsArray() ||
+        !args[5]->IsNumber() || pool->stopping) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    int64_t id = static_cast<int64_t>(args[0].As<v8::Number>()->Value());
+    if (pool->tasks.count(id) != 0) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    std::vector<v8::Local<v8::ArrayBuffer>> transfer;
+    v8::Local<v8::Array> list = args[4].As<v8::Array>();
+    for (uint32_t i = 0; i < list->Length(); i++) {
+        v8::Local<v8::Value> entry;
+        if (!list->Get(context, i).ToLocal(&entry)) {
+            return;
+        }
+        if (!entry->IsArrayBuffer()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        transfer.push_back(entry.As<v8::ArrayBuffer>());
+    }
+    
+    // Arguments that cannot be cloned throw here, before anything is queued
+    std::unique_ptr<Task> task = std::make_unique<Task>();
+    task->id = id;
+    v8::String::Utf8Value code(isolate, args[1]);
+    task->code.assign(*code, code.length());
+    task->is_path = args[2]->BooleanValue(isolate);
+    if (!SerializeValue(context, args[3], transfer, &task->args)) {
+        return;
+    }
+    double timeout = args[5].As<v8::Number>()->Value();
+    if (timeout > 0) {
+        task->timer_id = pool->binding->runtime->ScheduleDelayedTask([pool, id]() {
+            CancelTask(pool, id, kTaskTimedOut);
+        }, static_cast<uint64_t>(timeout));
+    }
+    
+    Task* raw = task.release();
+    pool->tasks[id] = raw;
+    Worker* worker = pool->workers[pool->next_worker++ % pool->workers.size()].get();
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->queue.push_back(raw);
+    }
+    int64_t depth;
+    {
+        std::lock_guard<std::mutex> lock(pool->wake_mutex);
+        depth = ++pool->queued;
+    }
+    pool->wake_cv.notify_one();
+    pool->max_queued = std::max(pool->max_queued, depth);
+    pool->submitted++;
+    UpdateRef(pool);
+}
+
+// pool.cancel(id): cancel a task that has not finished; false if it is unknown or already stopping
+static void PoolCancel(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    WorkerPool* pool = UnwrapPool(args);
+    if (!pool) {
+        return;
+    }
+    if (!args[0]->IsNumber()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    int64_t id = static_cast<int64_t>(args[0].As<v8::Number>()->Value());
+    args.GetReturnValue().Set(CancelTask(pool, id, kTaskCancelled));
+}
+
+// pool.stats(): worker count, queue depths and task counters
+static void PoolStats(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    WorkerPool* pool = UnwrapPool(args);
+    if (!pool) {
+        return;
+    }
+    
+    v8::Local<v8::Array> depths = v8::Array::New(isolate, static_cast<int>(pool->workers.size()));
+    for (size_t i = 0; i < pool->workers.size(); i++) {
+        size_t depth;
+        {
+            std::lock_guard<std::mutex> lock(pool->workers[i]->mutex);
+            depth = pool->workers[i]->queue.size();
+        }
+        depths->Set(context, static_cast<uint32_t>(i), v8::Number::New(isolate, static_cast<double>(depth))).Check();
+    }
+    
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    const struct {
+        v8::Local<v8::String> name;
+        double value;
+    } kFields[] = {
+        {keys.workers_string(), static_cast<double>(pool->workers.size())},
+        {keys.queued_string(), static_cast<double>(std::max<int64_t>(pool->queued.load(), 0))},
+        {keys.running_string(), static_cast<double>(pool->running.load())},
+        {keys.max_queued_string(), static_cast<double>(pool->max_queued)},
+        {keys.submitted_string(), static_cast<double>(pool->submitted)},
+        {keys.completed_string(), static_cast<double>(pool->succeeded)},
+        {keys.failed_string(), static_cast<double>(pool->failed)},
+        {keys.cancelled_string(), static_cast<double>(pool->cancelled)},
+        {keys.timed_out_string(), static_cast<double>(pool->timed_out)},
+        {keys.stolen_string(), static_cast<double>(pool->stolen.load())},
+    };
+    v8::Local<v8::Object> stats = v8::Object::New(isolate);
+    for (const auto& field : kFields) {
+        stats->Set(context, field.name, v8::Number::New(isolate, field.value)).Check();
+    }
+    stats->Set(context, keys.queue_depths_string(), depths).Check();
+    args.GetReturnValue().Set(stats);
+}
+
+// pool.terminate(): stop the workers; finished tasks are delivered and the rest reported cancelled
+static void PoolTerminate(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    WorkerPool* pool = UnwrapPool(args);
+    if (!pool) {
+        return;
+    }
+    args.This()->SetAlignedPointerInInternalField(0, nullptr);
+    StopWorkers(pool);
+    
+    std::deque<Task*> completed;
+    {
+        std::lock_guard<std::mutex> lock(pool->completed_mutex);
+        completed.swap(pool->completed);
+    }
+    for (Task* task : completed) {
+        DeliverTask(pool, task);
+    }
+    while (!pool->tasks.empty()) {
+        Task* task = pool->tasks.begin()->second;
+        task->status = kTaskCancelled;
+        DeliverTask(pool, task);
+    }
+    ClosePool(pool);
+}
+
+// setup({ oncomplete }): set the callback that receives task outcomes
+static void Setup(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    WorkerPoolBinding* binding = static_cast<WorkerPoolBinding*>(args.Data().As<v8::External>()->Value());
+    v8::Local<v8::Value> oncomplete;
+    if (!args[0]->IsObject() ||
+        !args[0].As<v8::Object>()->Get(context, PropertyKeys::Get(isolate).oncomplete_string())
+            .ToLocal(&oncomplete) ||
+        !oncomplete->IsFunction()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    binding->oncomplete.Reset(isolate, oncomplete.As<v8::Function>());
+    binding->context.Reset(isolate, context);
+}
+
+// setupWorker(dispatch): register the function that runs tasks in this worker runtime
+static void SetupWorker(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    Worker* worker = current_worker;
+    if (!worker || !args[0]->IsFunction()) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    // Tasks run in the context of the bootstrap script, which lives as long as the worker
+    v8::Local<v8::Context> context = isolate->GetEnteredOrMicrotaskContext();
+    worker->context.Reset(isolate, context);
+    worker->dispatch.Reset(isolate, args[0].As<v8::Function>());
+    worker->done.Reset(isolate, v8::Function::New(context, TaskDone, v8::External::New(isolate, worker)).ToLocalChecked());
+}
+
+// isWorker(): whether this runtime is a pool worker
+static void IsWorker(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    args.GetReturnValue().Set(current_worker != nullptr);
+}
+
+// Stop every pool without calling JavaScript; used when the runtime goes away
+static void CleanupBinding(WorkerPoolBinding* binding) {
+    std::vector<WorkerPool*> pools(binding->pools.begin(), binding->pools.end());
+    for (WorkerPool* pool : pools) {
+        StopWorkers(pool);
+        for (Task* task : pool->completed) {
+            pool->tasks.erase(task->id);
+            delete task;
+        }
+        pool->completed.clear();
+        for (auto& entry : pool->tasks) {
+            delete entry.second;
+        }
+        pool->tasks.clear();
+        ClosePool(pool);
+    }
+    delete binding;
+}
+
+// Register the workerpool module
+void RegisterWorkerPoolModule(Runtime* runtime) {
+    std::cout << "RegisterWorkerPoolModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        WorkerPoolBinding* binding = new WorkerPoolBinding();
+        binding->runtime = runtime;
+        runtime->AddCleanupHook([binding]() { CleanupBinding(binding); });
+        v8::Local<v8::External> data = v8::External::New(isolate, binding);
+        
+        // Build the WorkerPool class
+        v8::Local<v8::FunctionTemplate> pool_template = v8::FunctionTemplate::New(isolate, PoolConstructor, data);
+        pool_template->SetClassName(v8::String::NewFromUtf8(isolate, "WorkerPool").ToLocalChecked());
+        pool_template->InstanceTemplate()->SetInternalFieldCount(1);
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kMethods[] = {
+            {"submit", PoolSubmit},
+            {"cancel", PoolCancel},
+            {"stats", PoolStats},
+            {"terminate", PoolTerminate},
+        };
+        for (const auto& entry : kMethods) {
+            pool_template->PrototypeTemplate()->Set(isolate, entry.name,
+                v8::FunctionTemplate::New(isolate, entry.callback));
+        }
+        
+        // Create the workerpool module object
+        v8::Local<v8::Object> workerpool = v8::Object::New(isolate);
+        workerpool->Set(context, v8::String::NewFromUtf8(isolate, "WorkerPool").ToLocalChecked(),
+                        pool_template->GetFunction(context).ToLocalChecked()).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"setup", Setup},
+            {"setupWorker", SetupWorker},
+            {"isWorker", IsWorker},
+        };
+        for (const auto& entry : kFunctions) {
+            workerpool->Set(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                            v8::Function::New(context, entry.callback, data).ToLocalChecked()).Check();
+        }
+        
+        unsigned int cpus = std::thread::hardware_concurrency();
+        workerpool->Set(context, v8::String::NewFromUtf8(isolate, "defaultSize").ToLocalChecked(),
+                        v8::Integer::NewFromUnsigned(isolate, cpus > 0 ? cpus : 4)).Check();
+        
+        static const struct {
+            const char* name;
+            int value;
+        } kConstants[] = {
+            {"TASK_OK", kTaskOk},
+            {"TASK_ERROR", kTaskError},
+            {"TASK_CANCELLED", kTaskCancelled},
+            {"TASK_TIMED_OUT", kTaskTimedOut},
+        };
+        v8::Local<v8::Object> constants = v8::Object::New(isolate);
+        for (const auto& entry : kConstants) {
+            constants->Set(context, v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                           v8::Integer::New(isolate, entry.value)).Check();
+        }
+        workerpool->Set(context, v8::String::NewFromUtf8(isolate, "constants").ToLocalChecked(), constants).Check();
+        
+        // Register the workerpool module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/workerpool", workerpool);
+        
+        std::cout << "RegisterWorkerPoolModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterWorkerPoolModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterWorkerPoolModule" << std::endl;
+    }
+}
@@ -0,0 +1,798 @@
+#include "zlib_module.h"
+#include "runtime.h"
+#include "module.h"
+#include "property_keys.h"
+#include "async.h"
+#include <iostream>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+// Modes shared with lib/zlib.js through the constants object
+enum ZlibMode {
+    kModeDeflate = 1,
+    kModeInflate = 2,
+    kModeGzip = 3,
+    kModeGunzip = 4,
+    kModeDeflateRaw = 5,
+    kModeInflateRaw = 6,
+    kModeUnzip = 7,
+};
+
+// Smallest amount of free output space handed to zlib
+static constexpr size_t kMinOutputSpace = 16 * 1024;
+
+// Largest input handed to zlib in one call (avail_in is an unsigned int)
+static constexpr size_t kMaxInputPiece = 1u << 30;
+
+// Idle contexts kept by the pool
+static constexpr size_t kMaxIdleContexts = 8;
+
+// Parameters a context is created with
+struct ZlibParams {
+    int mode = kModeDeflate;
+    int level = Z_DEFAULT_COMPRESSION;
+    int window_bits = 15;
+    int mem_level = 8;
+    int strategy = Z_DEFAULT_STRATEGY;
+    
+    bool operator==(const ZlibParams& other) const {
+        return mode == other.mode && level == other.level && window_bits == other.window_bits &&
+               mem_level == other.mem_level && strategy == other.strategy;
+    }
+};
+
+// A failed zlib call
+struct ZlibError {
+    int code = Z_OK;
+    std::string message;
+};
+
+// Output buffer grown with realloc
+//
+// Compression runs on the thread pool, where the isolate's allocator is out
+// of reach, so the output is copied into V8 memory once it is complete; with
+// the V8 sandbox enabled, ArrayBuffers cannot wrap malloc'd memory.
+class ZlibOutput {
+public:
+    ZlibOutput() : data_(nullptr), size_(0), capacity_(0) {}
+    
+    ~ZlibOutput() {
+        std::free(data_);
+    }
+    
+    ZlibOutput(const ZlibOutput&) = delete;
+    ZlibOutput& operator=(const ZlibOutput&) = delete;
+    
+    // Make room for at least extra more bytes
+    bool Reserve(size_t extra) {
+        if (capacity_ - size_ >= extra) {
+            return true;
+        }
+        size_t capacity = std::max(capacity_ * 2, size_ + extra);
+        uint8_t* data = static_cast<uint8_t*>(std::realloc(data_, capacity));
+        if (!data) {
+            return false;
+        }
+        data_ = data;
+        capacity_ = capacity;
+        return true;
+    }
+    
+    uint8_t* Tail() {
+        return data_ + size_;
+    }
+    
+    size_t Available() const {
+        return capacity_ - size_;
+    }
+    
+    void Commit(size_t count) {
+        size_ += count;
+    }
+    
+    size_t Size() const {
+        return size_;
+    }
+    
+    // Copy the bytes into a Uint8Array in the current context and release them
+    v8::Local<v8::Uint8Array> ToArray(v8::Isolate* isolate) {
+        std::unique_ptr<v8::BackingStore> store = v8::ArrayBuffer::NewBackingStore(isolate, size_);
+        if (size_ > 0) {
+            std::memcpy(store->Data(), data_, size_);
+        }
+        size_t length = size_;
+        std::free(data_);
+        data_ = nullptr;
+        size_ = 0;
+        capacity_ = 0;
+        v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, std::move(store));
+        return v8::Uint8Array::New(buffer, 0, length);
+    }
+
+private:
+    uint8_t* data_;
+    size_t size_;
+    size_t capacity_;
+};
+
+// A deflate or inflate stream
+//
+// Contexts never touch V8, so they can run on the thread pool. Reset()
+// rewinds a context to its initial state while keeping its allocations,
+// which is what makes pooling them worthwhile.
+class ZlibContext {
+public:
+    explicit ZlibContext(const ZlibParams& params)
+        : params_(params), initialized_(false), ended_(false), busy_(false) {
+        std::memset(&stream_, 0, sizeof(stream_));
+    }
+    
+    ~ZlibContext() {
+        if (initialized_) {
+            if (IsDeflate()) {
+                deflateEnd(&stream_);
+            } else {
+                inflateEnd(&stream_);
+            }
+        }
+    }
+    
+    ZlibContext(const ZlibContext&) = delete;
+    ZlibContext& operator=(const ZlibContext&) = delete;
+    
+    const ZlibParams& Params() const {
+        return params_;
+    }
+    
+    bool Init(ZlibError* error) {
+        int window_bits = params_.window_bits;
+        int result;
+        switch (params_.mode) {
+            case kModeGzip:
+            case kModeGunzip:
+                window_bits += 16;
+                break;
+            case kModeUnzip:
+                window_bits += 32;
+                break;
+            case kModeDeflateRaw:
+            case kModeInflateRaw:
+                window_bits = -window_bits;
+                break;
+        }
+        if (IsDeflate()) {
+            result = deflateInit2(&stream_, params_.level, Z_DEFLATED, window_bits, params_.mem_level,
+                                  params_.strategy);
+        } else {
+            result = inflateInit2(&stream_, window_bits);
+        }
+        if (result != Z_OK) {
+            SetError(result, error);
+            return false;
+        }
+        initialized_ = true;
+        return true;
+    }
+    
+    // Rewind to the start of a new stream
+    void Reset() {
+        if (IsDeflate()) {
+            deflateReset(&stream_);
+        } else {
+            inflateReset(&stream_);
+        }
+        ended_ = false;
+    }
+    
+    // Run input through the stream, appending whatever it produces
+    bool Process(const uint8_t* input, size_t length, int flush, ZlibOutput* output, ZlibError* error) {
+        // Feed oversized input in pieces, flushing only with the last one
+        while (length > kMaxInputPiece) {
+            if (!ProcessPiece(input, kMaxInputPiece, Z_NO_FLUSH, output, error)) {
+                return false;
+            }
+            input += kMaxInputPiece;
+            length -= kMaxInputPiece;
+        }
+        return ProcessPiece(input, length, flush, output, error);
+    }
+    
+    // Set while a writeAsync() call owns the context
+    bool IsBusy() const {
+        return busy_;
+    }
+    
+    void SetBusy(bool busy) {
+        busy_ = busy;
+    }
+
+private:
+    bool IsDeflate() const {
+        return params_.mode == kModeDeflate || params_.mode == kModeGzip || params_.mode == kModeDeflateRaw;
+    }
+    
+    void SetError(int code, ZlibError* error) {
+        error->code = code;
+        if (stream_.msg) {
+            error->message = stream_.msg;
+        } else if (code == Z_BUF_ERROR) {
+            error->message = "unexpected end of file";
+        } else {
+            error->message = zError(code);
+        }
+    }
+    
+    bool ProcessPiece(const uint8_t* input, size_t length, int flush, ZlibOutput* output, ZlibError* error) {
+        stream_.next_in = const_cast<Bytef*>(input);
+        stream_.avail_in = static_cast<uInt>(length);
+        
+        if (IsDeflate()) {
+            size_t estimate = flush == Z_FINISH ? deflateBound(&stream_, length) : length / 2;
+            if (!output->Reserve(std::max(estimate, kMinOutputSpace))) {
+                SetError(Z_MEM_ERROR, error);
+                return false;
+            }
+            // Once deflate leaves output space unused it has done all it can for this flush
+            while (true) {
+                if (output->Available() < kMinOutputSpace && !output->Reserve(kMinOutputSpace)) {
+                    SetError(Z_MEM_ERROR, error);
+                    return false;
+                }
+                size_t available = std::min(output->Available(), static_cast<size_t>(UINT_MAX));
+                stream_.next_out = output->Tail();
+                stream_.avail_out = static_cast<uInt>(available);
+                int result = deflate(&stream_, flush);
+                output->Commit(available - stream_.avail_out);
+                if (result == Z_STREAM_ERROR) {
+                    SetError(result, error);
+                    return false;
+                }
+                if (stream_.avail_out != 0 || result == Z_STREAM_END) {
+                    return true;
+                }
+            }
+        }
+        
+        if (ended_) {
+            // Data after the end of the stream is ignored
+            return true;
+        }
+        if (!output->Reserve(std::max(std::min(length, kMaxInputPiece) * 2, kMinOutputSpace))) {
+            SetError(Z_MEM_ERROR, error);
+            return false;
+        }
+        while (true) {
+            if (output->Available() < kMinOutputSpace && !output->Reserve(kMinOutputSpace)) {
+                SetError(Z_MEM_ERROR, error);
+                return false;
+            }
+            size_t available = std::min(output->Available(), static_cast<size_t>(UINT_MAX));
+            stream_.next_out = output->Tail();
+            stream_.avail_out = static_cast<uInt>(available);
+            int result = inflate(&stream_, flush == Z_FINISH ? Z_SYNC_FLUSH : flush);
+            output->Commit(available - stream_.avail_out);
+            
+            if (result == Z_STREAM_END) {
+                // Concatenated gzip members decompress as one stream
+                bool gzip_member_follows = stream_.avail_in >= 2 && stream_.next_in[0] == 0x1f &&
+                                           stream_.next_in[1] == 0x8b &&
+                                           (params_.mode == kModeGunzip || params_.mode == kModeUnzip);
+                if (!gzip_member_follows) {
+                    ended_ = true;
+                    return true;
+                }
+                inflateReset(&stream_);
+                continue;
+            }
+            if (result == Z_NEED_DICT || result == Z_DATA_ERROR || result == Z_MEM_ERROR ||
+                result == Z_STREAM_ERROR) {
+                SetError(result == Z_NEED_DICT ? Z_DATA_ERROR : result, error);
+                if (result == Z_NEED_DICT) {
+                    error->message = "Missing dictionary";
+                }
+                return false;
+            }
+            if (stream_.avail_out != 0 || (result == Z_BUF_ERROR && stream_.avail_in == 0)) {
+                // Out of input before the end of the stream
+                if (flush == Z_FINISH) {
+                    SetError(Z_BUF_ERROR, error);
+                    return false;
+                }
+                return true;
+            }
+        }
+    }
+    
+    ZlibParams params_;
+    z_stream stream_;
+    bool initialized_;
+    bool ended_;
+    bool busy_;
+};
+
+// Idle contexts for one-shot calls, shared by every runtime and the thread pool
+class ZlibContextPool {
+public:
+    static std::unique_ptr<ZlibContext> Acquire(const ZlibParams& params, ZlibError* error) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto it = idle_.begin(); it != idle_.end(); ++it) {
+                if ((*it)->Params() == params) {
+                    std::unique_ptr<ZlibContext> context = std::move(*it);
+                    idle_.erase(it);
+                    return context;
+                }
+            }
+        }
+        auto context = std::make_unique<ZlibContext>(params);
+        if (!context->Init(error)) {
+            return nullptr;
+        }
+        return context;
+    }
+    
+    static void Release(std::unique_ptr<ZlibContext> context) {
+        context->Reset();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.size() >= kMaxIdleContexts) {
+            idle_.erase(idle_.begin());
+        }
+        idle_.push_back(std::move(context));
+    }
+
+private:
+    static std::mutex mutex_;
+    static std::vector<std::unique_ptr<ZlibContext>> idle_;
+};
+
+std::mutex ZlibContextPool::mutex_;
+std::vector<std::unique_ptr<ZlibContext>> ZlibContextPool::idle_;
+
+// Compress or decompress a whole buffer with a pooled context
+static bool ProcessAll(const ZlibParams& params, const uint8_t* data, size_t length, ZlibOutput* output,
+                       ZlibError* error) {
+    std::unique_ptr<ZlibContext> context = ZlibContextPool::Acquire(params, error);
+    if (!context) {
+        return false;
+    }
+    bool success = context->Process(data, length, Z_FINISH, output, error);
+    ZlibContextPool::Release(std::move(context));
+    return success;
+}
+
+// A wrapper's reference to a streaming context
+struct ZlibHandle {
+    std::shared_ptr<ZlibContext> context;
+    v8::Global<v8::Object> handle;
+};
+
+// Drop a context reference when its wrapper is garbage collected
+static void ZlibWeakCallback(const v8::WeakCallbackInfo<ZlibHandle>& info) {
+    ZlibHandle* zlib_handle = info.GetParameter();
+    zlib_handle->handle.Reset();
+    delete zlib_handle;
+}
+
+// Throw a TypeError for bad arguments
+static void ThrowInvalidArguments(v8::Isolate* isolate) {
+    isolate->ThrowException(v8::Exception::TypeError(
+        v8::String::NewFromUtf8(isolate, "Invalid arguments").ToLocalChecked()));
+}
+
+// Create an Error for a failed zlib call, with errno and code like Node.js
+static v8::Local<v8::Value> NewZlibError(v8::Isolate* isolate, const ZlibError& error) {
+    static const struct {
+        int code;
+        const char* name;
+    } kCodeNames[] = {
+        {Z_NEED_DICT, "Z_NEED_DICT"},
+        {Z_ERRNO, "Z_ERRNO"},
+        {Z_STREAM_ERROR, "Z_STREAM_ERROR"},
+        {Z_DATA_ERROR, "Z_DATA_ERROR"},
+        {Z_MEM_ERROR, "Z_MEM_ERROR"},
+        {Z_BUF_ERROR, "Z_BUF_ERROR"},
+        {Z_VERSION_ERROR, "Z_VERSION_ERROR"},
+    };
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    v8::Local<v8::Object> exception = v8::Exception::Error(
+        v8::String::NewFromUtf8(isolate, error.message.c_str()).ToLocalChecked()).As<v8::Object>();
+    const PropertyKeys& keys = PropertyKeys::Get(isolate);
+    exception->Set(context, keys.error_number_string(), v8::Integer::New(isolate, error.code)).Check();
+    for (const auto& entry : kCodeNames) {
+        if (entry.code == error.code) {
+            exception->Set(context, keys.code_string(),
+                           v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked()).Check();
+        }
+    }
+    return exception;
+}
+
+// Read mode, level, windowBits, memLevel and strategy starting at an argument
+static bool ReadParams(const v8::FunctionCallbackInfo<v8::Value>& args, int first, ZlibParams* params) {
+    v8::Local<v8::Context> context = args.GetIsolate()->GetCurrentContext();
+    int values[5];
+    for (int i = 0; i < 5; i++) {
+        if (!args[first + i]->IsInt32()) {
+            return false;
+        }
+        values[i] = args[first + i]->Int32Value(context).FromJust();
+    }
+    params->mode = values[0];
+    params->level = values[1];
+    params->window_bits = values[2];
+    params->mem_level = values[3];
+    params->strategy = values[4];
+    
+    // inflate accepts windowBits 0 (use the header's window size)
+    bool window_ok = (params->window_bits >= 8 && params->window_bits <= 15) ||
+                     (params->window_bits == 0 && (params->mode == kModeInflate || params->mode == kModeGunzip ||
+                                                   params->mode == kModeUnzip));
+    return params->mode >= kModeDeflate && params->mode <= kModeUnzip &&
+           params->level >= Z_DEFAULT_COMPRESSION && params->level <= Z_BEST_COMPRESSION && window_ok &&
+           params->mem_level >= 1 && params->mem_level <= MAX_MEM_LEVEL &&
+           params->strategy >= Z_DEFAULT_STRATEGY && params->strategy <= Z_FIXED;
+}
+
+// Get the bytes of an ArrayBufferView
+static bool GetBytes(v8::Local<v8::Value> value, const uint8_t** data, size_t* length) {
+    if (!value->IsArrayBufferView()) {
+        return false;
+    }
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    *data = static_cast<const uint8_t*>(view->Buffer()->Data()) + view->ByteOffset();
+    *length = view->ByteLength();
+    return true;
+}
+
+// Process bytes on the thread pool and settle with the output
+static JsPromise ProcessAsync(v8::Isolate* isolate, std::shared_ptr<v8::BackingStore> store, size_t offset,
+                              size_t length,
+                              std::function<bool(const uint8_t*, size_t, ZlibOutput*, ZlibError*)> work,
+                              std::function<void()> done) {
+    ZlibOutput output;
+    ZlibError error;
+    bool success = co_await RunOnPool([&]() {
+        return work(static_cast<const uint8_t*>(store->Data()) + offset, length, &output, &error);
+    });
+    
+    if (done) {
+        done();
+    }
+    if (!success) {
+        co_return Rejected{NewZlibError(isolate, error)};
+    }
+    co_return output.ToArray(isolate);
+}
+
+// Run a context on the thread pool, settling a Promise with its output
+static void ProcessOnPool(const v8::FunctionCallbackInfo<v8::Value>& args, v8::Local<v8::Value> input,
+                          std::function<bool(const uint8_t*, size_t, ZlibOutput*, ZlibError*)> work,
+                          std::function<void()> done) {
+    // Hold the input's backing store so the bytes outlive the caller's references
+    v8::Local<v8::ArrayBufferView> view = input.As<v8::ArrayBufferView>();
+    std::shared_ptr<v8::BackingStore> store = view->Buffer()->GetBackingStore();
+    
+    // The promise settles in the caller's context, so the result passes instanceof Uint8Array
+    JsPromise promise = ProcessAsync(args.GetIsolate(), store, view->ByteOffset(), view->ByteLength(),
+                                     std::move(work), std::move(done));
+    args.GetReturnValue().Set(promise.GetPromise());
+}
+
+// Get the context behind a wrapper object
+static std::shared_ptr<ZlibContext> UnwrapContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    if (args.This()->InternalFieldCount() < 1) {
+        isolate->ThrowException(v8::Exception::TypeError(
+            v8::String::NewFromUtf8(isolate, "Illegal invocation").ToLocalChecked()));
+        return nullptr;
+    }
+    ZlibHandle* zlib_handle = static_cast<ZlibHandle*>(args.This()->GetAlignedPointerFromInternalField(0));
+    if (!zlib_handle->context) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "zlib context is closed").ToLocalChecked()));
+        return nullptr;
+    }
+    if (zlib_handle->context->IsBusy()) {
+        isolate->ThrowException(v8::Exception::Error(
+            v8::String::NewFromUtf8(isolate, "zlib context is busy").ToLocalChecked()));
+        return nullptr;
+    }
+    return zlib_handle->context;
+}
+
+// Read the chunk and flush arguments of write() and writeAsync()
+static bool ReadChunk(const v8::FunctionCallbackInfo<v8::Value>& args, int* flush) {
+    if (args.Length() < 2 || !args[0]->IsArrayBufferView() || !args[1]->IsInt32()) {
+        return false;
+    }
+    *flush = args[1]->Int32Value(args.GetIsolate()->GetCurrentContext()).FromJust();
+    return *flush >= Z_NO_FLUSH && *flush <= Z_BLOCK;
+}
+
+// context.write(chunk, flush)
+static void ContextWrite(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<ZlibContext> zlib_context = UnwrapContext(args);
+    if (!zlib_context) {
+        return;
+    }
+    int flush;
+    const uint8_t* data;
+    size_t length;
+    if (!ReadChunk(args, &flush) || !GetBytes(args[0], &data, &length)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    ZlibOutput output;
+    ZlibError error;
+    if (!zlib_context->Process(data, length, flush, &output, &error)) {
+        isolate->ThrowException(NewZlibError(isolate, error));
+        return;
+    }
+    
+    // Create the array in the caller's context so instanceof Uint8Array holds
+    v8::Context::Scope context_scope(isolate->GetEnteredOrMicrotaskContext());
+    args.GetReturnValue().Set(output.ToArray(isolate));
+}
+
+// context.writeAsync(chunk, flush)
+static void ContextWriteAsync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    std::shared_ptr<ZlibContext> zlib_context = UnwrapContext(args);
+    if (!zlib_context) {
+        return;
+    }
+    int flush;
+    if (!ReadChunk(args, &flush)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    // The context is only touched by the pool until the Promise settles
+    zlib_context->SetBusy(true);
+    ProcessOnPool(args, args[0], [zlib_context, flush](const uint8_t* data, size_t length, ZlibOutput* output,
+                                                       ZlibError* error) {
+        return zlib_context->Process(data, length, flush, output, error);
+    }, [zlib_context]() {
+        zlib_context->SetBusy(false);
+    });
+}
+
+// context.reset()
+static void ContextReset(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    std::shared_ptr<ZlibContext> zlib_context = UnwrapContext(args);
+    if (zlib_context) {
+        zlib_context->Reset();
+    }
+}
+
+// context.close()
+static void ContextClose(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    if (args.This()->InternalFieldCount() < 1) {
+        ThrowInvalidArguments(args.GetIsolate());
+        return;
+    }
+    // A pending writeAsync() keeps its own reference until it finishes
+    ZlibHandle* zlib_handle = static_cast<ZlibHandle*>(args.This()->GetAlignedPointerFromInternalField(0));
+    zlib_handle->context.reset();
+}
+
+// Native processSync function
+static void ProcessSync(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    ZlibParams params;
+    const uint8_t* data;
+    size_t length;
+    if (!GetBytes(args[0], &data, &length) || !ReadParams(args, 1, &params)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    ZlibOutput output;
+    ZlibError error;
+    if (!ProcessAll(params, data, length, &output, &error)) {
+        isolate->ThrowException(NewZlibError(isolate, error));
+        return;
+    }
+    
+    // Create the array in the caller's context so instanceof Uint8Array holds
+    v8::Context::Scope context_scope(isolate->GetEnteredOrMicrotaskContext());
+    args.GetReturnValue().Set(output.ToArray(isolate));
+}
+
+// Native process function
+static void Process(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    
+    ZlibParams params;
+    if (!args[0]->IsArrayBufferView() || !ReadParams(args, 1, &params)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    ProcessOnPool(args, args[0], [params](const uint8_t* data, size_t length, ZlibOutput* output,
+                                          ZlibError* error) {
+        return ProcessAll(params, data, length, output, error);
+    }, nullptr);
+}
+
+// Native createContext function
+static void CreateContext(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    ZlibParams params;
+    if (!ReadParams(args, 0, &params)) {
+        ThrowInvalidArguments(isolate);
+        return;
+    }
+    
+    auto zlib_context = std::make_shared<ZlibContext>(params);
+    ZlibError error;
+    if (!zlib_context->Init(&error)) {
+        isolate->ThrowException(NewZlibError(isolate, error));
+        return;
+    }
+    
+    v8::Local<v8::ObjectTemplate> object_template = v8::ObjectTemplate::New(isolate);
+    object_template->SetInternalFieldCount(1);
+    object_template->Set(isolate, "write", v8::FunctionTemplate::New(isolate, ContextWrite));
+    object_template->Set(isolate, "writeAsync", v8::FunctionTemplate::New(isolate, ContextWriteAsync));
+    object_template->Set(isolate, "reset", v8::FunctionTemplate::New(isolate, ContextReset));
+    object_template->Set(isolate, "close", v8::FunctionTemplate::New(isolate, ContextClose));
+    
+    v8::Local<v8::Object> object = object_template->NewInstance(context).ToLocalChecked();
+    ZlibHandle* zlib_handle = new ZlibHandle();
+    zlib_handle->context = std::move(zlib_context);
+    zlib_handle->handle.Reset(isolate, object);
+    zlib_handle->handle.SetWeak(zlib_handle, ZlibWeakCallback, v8::WeakCallbackType::kParameter);
+    object->SetAlignedPointerInInternalField(0, zlib_handle);
+    
+    args.GetReturnValue().Set(object);
+}
+
+// Native crc32 function
+static void Crc32(const v8::FunctionCallbackInfo<v8::Value>& args) {
+    v8::Isolate* isolate = args.GetIsolate();
+    v8::HandleScope scope(isolate);
+    v8::Local<v8::Context> context = isolate->GetCurrentContext();
+    
+    uLong crc = 0;
+    if (args.Length() >= 2 && !args[1]->IsUndefined()) {
+        if (!args[1]->IsNumber()) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        crc = args[1]->Uint32Value(context).FromJust();
+    }
+    
+    if (args[0]->IsString()) {
+        v8::String::Utf8Value utf8(isolate, args[0]);
+        crc = crc32_z(crc, reinterpret_cast<const Bytef*>(*utf8), utf8.length());
+    } else {
+        const uint8_t* data;
+        size_t length;
+        if (!GetBytes(args[0], &data, &length)) {
+            ThrowInvalidArguments(isolate);
+            return;
+        }
+        crc = crc32_z(crc, data, length);
+    }
+    args.GetReturnValue().Set(v8::Integer::NewFromUnsigned(isolate, static_cast<uint32_t>(crc)));
+}
+
+// Register the internal/zlib module
+void RegisterZlibModule(Runtime* runtime) {
+    std::cout << "RegisterZlibModule: Starting..." << std::endl;
+    
+    try {
+        v8::Isolate* isolate = runtime->GetIsolate();
+        
+        // Create a handle scope
+        v8::HandleScope scope(isolate);
+        
+        // Create a new context for module initialization
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        // Create the zlib module object
+        v8::Local<v8::Object> zlib = v8::Object::New(isolate);
+        
+        static const struct {
+            const char* name;
+            int value;
+        } kConstants[] = {
+            {"Z_NO_FLUSH", Z_NO_FLUSH},
+            {"Z_PARTIAL_FLUSH", Z_PARTIAL_FLUSH},
+            {"Z_SYNC_FLUSH", Z_SYNC_FLUSH},
+            {"Z_FULL_FLUSH", Z_FULL_FLUSH},
+            {"Z_FINISH", Z_FINISH},
+            {"Z_BLOCK", Z_BLOCK},
+            {"Z_OK", Z_OK},
+            {"Z_STREAM_END", Z_STREAM_END},
+            {"Z_NEED_DICT", Z_NEED_DICT},
+            {"Z_ERRNO", Z_ERRNO},
+            {"Z_STREAM_ERROR", Z_STREAM_ERROR},
+            {"Z_DATA_ERROR", Z_DATA_ERROR},
+            {"Z_MEM_ERROR", Z_MEM_ERROR},
+            {"Z_BUF_ERROR", Z_BUF_ERROR},
+            {"Z_VERSION_ERROR", Z_VERSION_ERROR},
+            {"Z_NO_COMPRESSION", Z_NO_COMPRESSION},
+            {"Z_BEST_SPEED", Z_BEST_SPEED},
+            {"Z_BEST_COMPRESSION", Z_BEST_COMPRESSION},
+            {"Z_DEFAULT_COMPRESSION", Z_DEFAULT_COMPRESSION},
+            {"Z_FILTERED", Z_FILTERED},
+            {"Z_HUFFMAN_ONLY", Z_HUFFMAN_ONLY},
+            {"Z_RLE", Z_RLE},
+            {"Z_FIXED", Z_FIXED},
+            {"Z_DEFAULT_STRATEGY", Z_DEFAULT_STRATEGY},
+            {"ZLIB_VERNUM", ZLIB_VERNUM},
+            {"DEFLATE", kModeDeflate},
+            {"INFLATE", kModeInflate},
+            {"GZIP", kModeGzip},
+            {"GUNZIP", kModeGunzip},
+            {"DEFLATERAW", kModeDeflateRaw},
+            {"INFLATERAW", kModeInflateRaw},
+            {"UNZIP", kModeUnzip},
+            {"Z_MIN_WINDOWBITS", 8},
+            {"Z_MAX_WINDOWBITS", 15},
+            {"Z_DEFAULT_WINDOWBITS", 15},
+            {"Z_MIN_CHUNK", 64},
+            {"Z_DEFAULT_CHUNK", 16 * 1024},
+            {"Z_MIN_MEMLEVEL", 1},
+            {"Z_MAX_MEMLEVEL", MAX_MEM_LEVEL},
+            {"Z_DEFAULT_MEMLEVEL", 8},
+            {"Z_MIN_LEVEL", -1},
+            {"Z_MAX_LEVEL", 9},
+            {"Z_DEFAULT_LEVEL", Z_DEFAULT_COMPRESSION},
+        };
+        v8::Local<v8::Object> constants = v8::Object::New(isolate);
+        for (const auto& entry : kConstants) {
+            constants->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Integer::New(isolate, entry.value)).Check();
+        }
+        zlib->Set(context, v8::String::NewFromUtf8(isolate, "constants").ToLocalChecked(), constants).Check();
+        
+        static const struct {
+            const char* name;
+            v8::FunctionCallback callback;
+        } kFunctions[] = {
+            {"processSync", ProcessSync},
+            {"process", Process},
+            {"createContext", CreateContext},
+            {"crc32", Crc32},
+        };
+        for (const auto& entry : kFunctions) {
+            zlib->Set(context,
+                v8::String::NewFromUtf8(isolate, entry.name).ToLocalChecked(),
+                v8::Function::New(context, entry.callback).ToLocalChecked()).Check();
+        }
+        
+        // Register the zlib module
+        runtime->GetModuleSystem()->RegisterNativeModule("internal/zlib", zlib);
+        
+        std::cout << "RegisterZlibModule: Complete" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception in RegisterZlibModule: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Unknown exception in RegisterZlibModule" << std::endl;
+    }
+}
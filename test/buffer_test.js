@@ -0,0 +1,76 @@
+/**
+ * Test Script for Buffer in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - Buffer.from/alloc/concat: Construction and the shared allocation pool
+ * - toString/write: utf8, latin1, ascii, base64, base64url, hex and utf16le
+ * - indexOf/lastIndexOf/compare/fill: Native search and comparison
+ * - read/write helpers: Fixed-width integers, floats and BigInts
+ */
+
+print("===== Buffer Test =====");
+
+const { Buffer, isUtf8, isAscii } = require('buffer');
+
+// The global is the same constructor as the module export
+print(`global Buffer: ${globalThis.Buffer === Buffer}`);
+
+// Construction
+const hello = Buffer.from('héllo wörld');
+print(`utf8 length: ${hello.length}`);
+print(`utf8 roundtrip: ${hello.toString()}`);
+print(`isBuffer: ${Buffer.isBuffer(hello)}, Uint8Array: ${hello instanceof Uint8Array}`);
+print(`from array: ${Buffer.from([104, 105]).toString()}`);
+print(`alloc fill: ${Buffer.alloc(5, 'ab').toString()}`);
+print(`concat: ${Buffer.concat([Buffer.from('foo'), Buffer.from('bar')]).toString()}`);
+
+// Small allocations share one pooled ArrayBuffer
+const small1 = Buffer.allocUnsafe(10);
+const small2 = Buffer.allocUnsafe(10);
+print(`pooled: ${small1.buffer === small2.buffer}, aligned: ${small2.byteOffset % 8 === 0}`);
+
+// Encodings
+print(`hex: ${Buffer.from('tiny').toString('hex')}`);
+print(`from hex: ${Buffer.from('74696e79', 'hex').toString()}`);
+print(`base64: ${Buffer.from('hello world').toString('base64')}`);
+print(`from base64: ${Buffer.from('aGVsbG8gd29ybGQ=', 'base64').toString()}`);
+print(`base64url: ${Buffer.from([0xfb, 0xff]).toString('base64url')}`);
+print(`latin1: ${Buffer.from('café', 'latin1').length}`);
+print(`utf16le: ${Buffer.from('hi', 'utf16le').toString('hex')}`);
+print(`invalid utf8: ${Buffer.from([0x61, 0xff, 0x62]).toString() === 'a�b'}`);
+print(`byteLength: ${Buffer.byteLength('héllo')}, ${Buffer.byteLength('aGk=', 'base64')}`);
+
+// Writing into an existing buffer
+const target = Buffer.alloc(8);
+const written = target.write('abc', 2);
+print(`write: ${written} ${target.toString('hex')}`);
+
+// Search and comparison
+print(`indexOf: ${hello.indexOf('l')}, lastIndexOf: ${hello.lastIndexOf('l')}`);
+print(`indexOf byte: ${hello.indexOf(0x20)}, includes: ${hello.includes('wör')}`);
+print(`compare: ${Buffer.compare(Buffer.from('a'), Buffer.from('b'))}`);
+print(`equals: ${Buffer.from('abc').equals(Buffer.from('abc'))}`);
+
+// Views and copies
+const view = hello.subarray(0, 5);
+view[0] = 0x48;
+print(`subarray shares memory: ${hello.toString().startsWith('H')}`);
+const copy = Buffer.alloc(3);
+Buffer.from('abcdef').copy(copy, 0, 3);
+print(`copy: ${copy.toString()}`);
+
+// Fixed-width reads and writes
+const numbers = Buffer.alloc(24);
+numbers.writeUInt32BE(0xdeadbeef, 0);
+numbers.writeInt16LE(-2, 4);
+numbers.writeDoubleLE(3.5, 8);
+numbers.writeBigInt64BE(-5n, 16);
+print(`readUInt32BE: ${numbers.readUInt32BE(0).toString(16)}`);
+print(`readInt16LE: ${numbers.readInt16LE(4)}`);
+print(`readDoubleLE: ${numbers.readDoubleLE(8)}`);
+print(`readBigInt64BE: ${numbers.readBigInt64BE(16)}`);
+
+// Validation helpers
+print(`isUtf8: ${isUtf8(hello)}, isAscii: ${isAscii(Buffer.from('plain'))}`);
+
+print("===== Buffer Test Complete =====");
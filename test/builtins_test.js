@@ -0,0 +1,87 @@
+/**
+ * Test Script for Built-in JavaScript Modules in Tiny Node.js Runtime
+ * 
+ * These modules are compiled into the binary (see lib/ and cmake/js2c.cmake)
+ * and are loaded without touching the file system:
+ * - events: EventEmitter
+ * - path: POSIX path utilities
+ * - util: format, inspect, inherits, promisify
+ * - stream: Readable, Writable, Transform and pipeline
+ */
+
+print("===== Built-in Modules Test =====");
+
+// Test events
+const EventEmitter = require('events');
+const emitter = new EventEmitter();
+emitter.on('greet', (name) => print(`  on: hello ${name}`));
+emitter.once('greet', (name) => print(`  once: hello ${name}`));
+emitter.emit('greet', 'first');
+emitter.emit('greet', 'second');
+print(`Listener count after once: ${emitter.listenerCount('greet')}`);
+
+// Listeners added or removed during emit only affect later emits
+const calls = [];
+const late = () => calls.push('late');
+const first = () => {
+    calls.push('first');
+    emitter.removeListener('tick', second);
+    emitter.on('tick', late);
+};
+const second = () => calls.push('second');
+emitter.on('tick', first);
+emitter.on('tick', second);
+emitter.emit('tick');
+emitter.emit('tick');
+print(`Emit during changes: ${calls.join(',')}`);
+emitter.on('many', (...args) => print(`Many arguments: ${args.join(' ')}`));
+emitter.emit('many', 1, 2, 3, 4, 5);
+
+// Test path
+const path = require('path');
+print(`path.join: ${path.join('/usr', 'local/../lib', 'node')}`);
+print(`path.basename: ${path.basename('/tmp/file.txt', '.txt')}`);
+print(`path.extname: ${path.extname('archive.tar.gz')}`);
+print(`path.dirname: ${path.dirname('/a/b/c')}`);
+
+// Test util
+const util = require('util');
+print(util.format('util.format: %s has %d items %j', 'cart', 3, { ok: true }));
+print(`util.inspect: ${util.inspect({ list: [1, 2, { deep: true }], name: 'x' })}`);
+const cyclic = { name: 'loop' };
+cyclic.self = cyclic;
+print(`util.inspect cycle: ${util.inspect(cyclic)}`);
+print(`util.inspect depth: ${util.inspect({ a: { b: { c: { d: 1 } } } }, { depth: 1 })}`);
+print(`util.inspect map: ${util.inspect(new Map([['k', new Set([1, 2])]]))}`);
+class Point {
+    constructor() {
+        this.x = 1;
+        this.y = 2;
+    }
+}
+print(`util.inspect class: ${util.inspect(new Point())} ${util.inspect(Point)}`);
+print(`util.inspect grouped: ${util.inspect(Array.from({ length: 12 }, (_, i) => i * 11)).split('\n').length} lines`);
+print('print formats:', { nested: [1, 'two'] }, 'with %s', 'specifiers');
+
+// Test stream
+const { Readable, Transform, Writable, pipeline } = require('stream');
+const collected = [];
+pipeline(
+    Readable.from(['a', 'b', 'c']),
+    new Transform({
+        transform(chunk, encoding, callback) {
+            callback(null, chunk.toUpperCase());
+        }
+    }),
+    new Writable({
+        objectMode: true,
+        write(chunk, encoding, callback) {
+            collected.push(chunk);
+            callback();
+        }
+    }),
+    (err) => {
+        print(`stream.pipeline: ${err ? err.message : collected.join('')}`);
+        print("\n===== Built-in Modules Test Complete =====");
+    }
+);
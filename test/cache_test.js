@@ -0,0 +1,66 @@
+/**
+ * Test Script for the Cache Module in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - cache.create: Creating off-heap caches with a byte budget
+ * - get/set/has/delete: Basic operations; get returns a copy
+ * - Eviction: CLOCK eviction once the byte budget is exceeded
+ * - TTLs and stats: Expiry and hit/miss accounting
+ */
+
+print("===== Cache Module Test =====");
+
+const cache = require('cache');
+const v8 = require('v8');
+
+// Basic operations
+const c = cache.create({ maxBytes: 1024 * 1024, shards: 4 });
+c.set('greeting', 'hello');
+c.set('bytes', new Uint8Array([1, 2, 3, 4]));
+c.set('object', v8.serialize({ id: 7, tags: ['a', 'b'] }));
+
+const greeting = c.get('greeting');
+print(`greeting: ${String.fromCharCode(...greeting)}`);
+print(`bytes: ${c.get('bytes').join(',')}`);
+print(`object.id: ${v8.deserialize(c.get('object')).id}`);
+print(`has bytes: ${c.has('bytes')}`);
+print(`delete bytes: ${c.delete('bytes')}`);
+print(`get deleted: ${c.get('bytes')}`);
+
+// Writing into a returned array does not reach the cache
+greeting[0] = 0x4a;
+print(`other get unaffected: ${String.fromCharCode(...c.get('greeting'))}`);
+
+// Arrays stay valid after the entry is replaced
+c.set('greeting', 'replaced');
+print(`old array still reads: ${String.fromCharCode(...greeting)}`);
+
+// Eviction under a small budget
+const small = cache.create({ maxBytes: 16 * 1024, shards: 1 });
+const block = new Uint8Array(1024);
+for (let i = 0; i < 64; i++) {
+    small.set(`key-${i}`, block);
+}
+const smallStats = small.stats();
+print(`entries within budget: ${smallStats.bytes <= smallStats.maxBytes}`);
+print(`evictions: ${smallStats.evictions > 0}`);
+print(`most recent kept: ${small.has('key-63')}`);
+
+// Values larger than the budget are rejected
+print(`oversized set: ${small.set('huge', new Uint8Array(32 * 1024))}`);
+
+// TTLs
+c.set('short', 'lived', 1);
+setTimeout(() => {
+    print(`expired: ${c.get('short') === undefined}`);
+    
+    const stats = c.stats();
+    print(`hits: ${stats.hits}, misses: ${stats.misses}, expirations: ${stats.expirations}`);
+    
+    // Named caches are shared
+    const shared = cache.create({ name: 'shared-test' });
+    shared.set('k', 'v');
+    print(`shared lookup: ${cache.create({ name: 'shared-test' }).has('k')}`);
+    
+    print("===== Cache Module Test Complete =====");
+}, 20);
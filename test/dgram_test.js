@@ -0,0 +1,88 @@
+/**
+ * Test Script for the Dgram Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - createSocket/bind: UDP sockets on ephemeral ports
+ * - send: Single datagrams, a batch sent in one tick, and send callbacks
+ * - message/messages: Per-datagram events and whole batches per loop iteration
+ * - close: The close event and sends on a closed socket
+ */
+
+print("===== Dgram Module Test =====");
+
+const dgram = require('dgram');
+
+const server = dgram.createSocket('udp4');
+const client = dgram.createSocket({ type: 'udp4' });
+
+try {
+    dgram.createSocket('udp5');
+} catch (error) {
+    print(`bad type: ${error.code}`);
+}
+
+const BATCH = 64;
+let received = 0;
+let batches = 0;
+let batchTotal = 0;
+let inOrder = true;
+
+server.on('messages', (batch) => {
+    batches++;
+    batchTotal += batch.count;
+});
+
+server.on('message', (msg, rinfo) => {
+    if (received === 0) {
+        print(`first: ${msg.toString()} from ${rinfo.address} ${rinfo.family} ${rinfo.port === client.address().port}`);
+        received++;
+        testBatch(rinfo.port);
+        return;
+    }
+    if (msg.toString() !== 'datagram ' + received) {
+        inOrder = false;
+    }
+    received++;
+    if (received === BATCH + 1) {
+        print(`batch: ${received - 1} datagrams in order ${inOrder}`);
+        print(`messages events: ${batchTotal === received} ${batches < received}`);
+        testClose();
+    }
+});
+
+server.bind(0, '127.0.0.1', () => {
+    const address = server.address();
+    print(`listening: ${address.address} ${address.family} ${address.port > 0}`);
+    client.send('hello', address.port, '127.0.0.1', (error, bytes) => {
+        print(`sent: ${error} ${bytes}`);
+    });
+});
+
+function testBatch() {
+    // Sends made in one tick reach the kernel together
+    const port = server.address().port;
+    let callbacks = 0;
+    for (let i = 0; i < BATCH; i++) {
+        client.send(Buffer.from('datagram ' + (i + 1)), port, 'localhost', () => {
+            callbacks++;
+            if (callbacks === BATCH) {
+                print(`send callbacks: ${callbacks}`);
+            }
+        });
+    }
+}
+
+function testClose() {
+    client.close(() => {
+        print('client closed');
+        try {
+            client.send('late', 1234);
+        } catch (error) {
+            print(`send after close: ${error.code}`);
+        }
+        server.close(() => {
+            print('server closed');
+            print("===== Dgram Module Test Complete =====");
+        });
+    });
+}
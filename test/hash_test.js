@@ -0,0 +1,71 @@
+/**
+ * Test Script for the Hash Module in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - hash: One-shot digests of strings and byte arrays
+ * - createHash: Incremental update(), digest() encodings and copy()
+ * - hashFile: Hashing a file on the thread pool
+ */
+
+print("===== Hash Module Test =====");
+
+const hash = require('hash');
+
+print(`algorithms: ${hash.getHashes().join(',')}`);
+
+// Known answers
+print(`sha256(abc): ${hash.hash('sha256', 'abc')}`);
+print(`sha1(non-ASCII): ${hash.hash('sha1', 'héllo wörld')}`);
+print(`sha512(empty) prefix: ${hash.hash('sha512', '').slice(0, 32)}`);
+print(`xxh3(tiny_node): ${hash.hash('xxh3', 'tiny_node')}`);
+print(`crc32c(123456789): ${hash.hash('crc32c', new Uint8Array([49, 50, 51, 52, 53, 54, 55, 56, 57]))}`);
+print(`sha256(abc) base64: ${hash.hash('sha256', 'abc', 'base64')}`);
+
+// Incremental updates match the one-shot digest
+const data = new Uint8Array(100000);
+for (let i = 0; i < data.length; i++) {
+    data[i] = (i * 31) & 0xff;
+}
+const incremental = hash.createHash('sha256');
+for (let i = 0; i < data.length; i += 777) {
+    incremental.update(data.subarray(i, i + 777));
+}
+const copy = incremental.copy();
+print(`incremental matches: ${incremental.digest('hex') === hash.hash('sha256', data)}`);
+
+// A copy continues independently
+copy.update('more');
+print(`copy differs: ${copy.digest('hex') !== hash.hash('sha256', data)}`);
+
+// Input encodings
+const fromHex = hash.createHash('xxh3').update('616263', 'hex').digest('hex');
+print(`hex input matches: ${fromHex === hash.hash('xxh3', 'abc')}`);
+const bytes = hash.createHash('sha1').update('abc').digest();
+print(`digest bytes: ${bytes instanceof Uint8Array} ${bytes.length}`);
+
+// A digest can only be taken once
+const finished = hash.createHash('sha1');
+finished.digest();
+try {
+    finished.update('x');
+    print('update after digest: no error');
+} catch (error) {
+    print(`update after digest: ${error.message}`);
+}
+
+try {
+    hash.createHash('md4');
+} catch (error) {
+    print(`unknown algorithm: ${error.message}`);
+}
+
+// Hash this script on the thread pool
+hash.hashFile('sha256', 'test/hash_test.js').then((digest) => {
+    print(`file digest length: ${digest.length}`);
+    return hash.hashFile('sha256', 'test/missing-file');
+}).then(() => {
+    print('missing file: no error');
+}, (error) => {
+    print(`missing file rejected: ${error.message.startsWith('Failed to open')}`);
+    print("===== Hash Module Test Complete =====");
+});
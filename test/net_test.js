@@ -0,0 +1,77 @@
+/**
+ * Test Script for the Net Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - createServer/listen: A TCP echo server on an ephemeral port
+ * - connect: Client sockets, corked writes and half-close
+ * - pause/resume: Flow control while a megabyte is echoed back
+ * - Errors: Connecting to a closed port
+ */
+
+print("===== Net Module Test =====");
+
+const net = require('net');
+
+print(`isIP: ${net.isIP('127.0.0.1')} ${net.isIP('::1')} ${net.isIP('localhost')}`);
+
+// Echo everything back and end when the client does
+const server = net.createServer((socket) => {
+    socket.setNoDelay(true);
+    socket.on('data', (chunk) => socket.write(chunk));
+});
+
+server.listen(0, '127.0.0.1', () => {
+    const port = server.address().port;
+    print(`listening: ${server.address().address} ${port > 0}`);
+    testEcho(port);
+});
+
+function testEcho(port) {
+    const received = [];
+    const client = net.connect(port, '127.0.0.1', () => {
+        print(`connected: ${client.remotePort === port}`);
+        
+        // Corked writes leave in a single writev
+        client.cork();
+        client.write('hello ');
+        client.write(Buffer.from('corked '));
+        client.write('world');
+        client.uncork();
+        client.end();
+    });
+    client.on('data', (chunk) => received.push(chunk));
+    client.on('end', () => {
+        print(`echoed: ${Buffer.concat(received).toString()}`);
+        print(`bytes written/read: ${client.bytesWritten} ${client.bytesRead}`);
+    });
+    client.on('close', () => testFlowControl(port));
+}
+
+function testFlowControl(port) {
+    const payload = Buffer.alloc(1024 * 1024, 'x');
+    let total = 0;
+    let paused = false;
+    const client = net.connect({ port, host: '127.0.0.1' }, () => client.end(payload));
+    client.on('data', (chunk) => {
+        total += chunk.length;
+        if (!paused) {
+            paused = true;
+            client.pause();
+            print(`paused: ${client.isPaused()}`);
+            setTimeout(() => client.resume(), 50);
+        }
+    });
+    client.on('end', () => print(`flow control: ${total === payload.length}`));
+    client.on('close', () => testRefused(port));
+}
+
+function testRefused(port) {
+    server.close(() => {
+        print('server closed');
+        const client = net.connect(port, '127.0.0.1');
+        client.on('error', (error) => {
+            print(`refused: ${error.code}`);
+            print("===== Net Module Test Complete =====");
+        });
+    });
+}
@@ -0,0 +1,76 @@
+/**
+ * Test Script for the Scheduler Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - scheduler.yield(): Resuming ahead of tasks queued while yielded
+ * - Timers: A chunked batch job lets due timers run between chunks
+ * - shouldYield(): Asking a busy loop to yield, with --time-slice
+ * - stats(): Time slice length, slice count and queue high-water marks
+ *
+ * Run with --time-slice=<ms> (bin/run_all_tests.sh does so once) to also
+ * check that scheduler.shouldYield() asks a busy loop to yield for its
+ * timers; the test exits with status 1 if it does not.
+ */
+
+print("===== Scheduler Module Test =====");
+
+print(`global: ${typeof scheduler} ${scheduler === require('scheduler').scheduler}`);
+
+async function main() {
+    // A yielded task resumes before a timer set while it was yielded
+    const order = [];
+    setTimeout(() => order.push('timer'), 0);
+    await scheduler.yield();
+    order.push('resumed');
+    await new Promise((resolve) => setTimeout(resolve, 5));
+    print(`order: ${order.join(' ')}`);
+    
+    // A batch job that yields between chunks lets a timer fire mid-way
+    const started = Date.now();
+    let firedAfter = -1;
+    let chunks = 0;
+    setTimeout(() => { firedAfter = chunks; }, 20);
+    while (Date.now() - started < 100) {
+        const chunkEnd = Date.now() + 5;
+        while (Date.now() < chunkEnd) {}
+        chunks++;
+        await scheduler.yield();
+    }
+    print(`timer fired mid-batch: ${firedAfter > 0 && firedAfter < chunks}`);
+    
+    // A busy loop that only yields when asked to lets the timers run with time slicing on,
+    // and never yields without it. The running code is never interrupted.
+    let sliced = false;
+    let immediate = false;
+    let yields = 0;
+    const busyStart = Date.now();
+    setTimeout(() => { immediate = true; }, 0);
+    setTimeout(() => { sliced = true; }, 10);
+    while (Date.now() - busyStart < 100) {
+        if (scheduler.shouldYield()) {
+            yields++;
+            await scheduler.yield();
+        }
+    }
+    const stats = scheduler.stats();
+    print(`time slice: ${stats.timeSlice}ms, timers ran during busy loop: ${immediate && sliced}, ` +
+          `sliced: ${stats.timeSlice === 0 ? stats.slices === 0 && yields === 0 : stats.slices > 0}`);
+    if (stats.timeSlice > 0 && !(immediate && sliced)) {
+        print('FAILED: time slicing did not ask the busy loop to yield for its timers');
+        process.exit(1);
+    }
+    
+    // Queue depths are tracked per lane, with their high-water marks
+    for (let i = 0; i < 100; i++) {
+        setTimeout(() => {}, 0);
+    }
+    await new Promise((resolve) => setTimeout(resolve, 5));
+    const { task, completion, continuation } = scheduler.stats().queues;
+    print(`task queue: capacity=${task.capacity} highWater>=100: ${task.highWater >= 100} ` +
+          `rejected=${task.rejected} paused=${task.paused}`);
+    print(`completion capacity=${completion.capacity}, continuations seen: ${continuation.scheduled > 0}`);
+    
+    print("===== Scheduler Module Test Complete =====");
+}
+
+main();
@@ -0,0 +1,39 @@
+/**
+ * Test Script for the SharedBuffer Module in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - sharedbuffer.create/open: Two SharedArrayBuffers over the same memory
+ * - Atomics.waitAsync: Non-blocking wait whose wakeup arrives via the event loop
+ * - sharedbuffer.unlink: Removing a name from the registry
+ */
+
+print("===== SharedBuffer Module Test =====");
+
+const sharedbuffer = require('sharedbuffer');
+
+// Create a buffer and open it again, as another runtime would
+const created = sharedbuffer.create('test-ring', 64);
+const opened = sharedbuffer.open('test-ring');
+print(`Created byteLength: ${created.byteLength}`);
+
+const writer = new Int32Array(created);
+const reader = new Int32Array(opened);
+Atomics.store(writer, 1, 42);
+print(`Value seen through the opened buffer: ${Atomics.load(reader, 1)}`);
+
+// Wait asynchronously for slot 0 to change from 0
+const result = Atomics.waitAsync(reader, 0, 0, 1000);
+print(`waitAsync is async: ${result.async}`);
+result.value.then((outcome) => {
+    print(`waitAsync resolved with: ${outcome}`);
+    print(`Slot 0 is now: ${Atomics.load(reader, 0)}`);
+    print(`Unlinked: ${sharedbuffer.unlink('test-ring')}`);
+    print(`Open after unlink: ${sharedbuffer.open('test-ring')}`);
+    print("\n===== SharedBuffer Module Test Complete =====");
+});
+
+// Wake the waiter from a timer
+setTimeout(() => {
+    Atomics.store(writer, 0, 1);
+    print(`Notified waiters: ${Atomics.notify(writer, 0)}`);
+}, 100);
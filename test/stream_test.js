@@ -0,0 +1,143 @@
+/**
+ * Test Script for the Stream Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - Backpressure: write() and push() return values against the high-water mark, and 'drain'
+ * - fs.createReadStream/createWriteStream: Chunked reads, ranges and appends
+ * - pipeline: A file copied to another file and sent over a socket by a native pipe
+ * - Fallback: pipeline through a Transform in JavaScript
+ * - fs.promises.readFile: Whole-file reads on the thread pool
+ */
+
+print("===== Stream Module Test =====");
+
+const fs = require('fs');
+const net = require('net');
+const { Readable, Writable, Transform, pipeline } = require('stream');
+
+const source = 'test/stream-source.tmp';
+const copy = 'test/stream-copy.tmp';
+const payload = Buffer.alloc(1024 * 1024 + 123);
+for (let i = 0; i < payload.length; i++) {
+    payload[i] = (i * 7) & 0xff;
+}
+
+// A writable stream reports backpressure once the high-water mark is reached
+const results = [];
+const slow = new Writable({
+    highWaterMark: 10,
+    write(chunk, encoding, callback) {
+        setTimeout(callback, 1);
+    },
+});
+results.push(slow.write('12345'));
+results.push(slow.write('67890'));
+print(`write below/at high-water mark: ${results.join(' ')} (length ${slow._writableState.length})`);
+slow.on('drain', () => {
+    print(`drain: length ${slow._writableState.length}`);
+    testReadable();
+});
+
+function testReadable() {
+    const readable = new Readable({ highWaterMark: 3, objectMode: true, read() {} });
+    print(`push in object mode: ${readable.push('a')} ${readable.push('b')} ${readable.push('c')}`);
+    print(`read: ${readable.read()} (length ${readable._readableState.length})`);
+    testFileStreams();
+}
+
+function testFileStreams() {
+    // Write the payload in pieces, then read it back
+    const output = fs.createWriteStream(source);
+    output.write(payload.subarray(0, 1000));
+    output.write(payload.subarray(1000, 70000));
+    output.end(payload.subarray(70000), () => {
+        print(`write stream bytes: ${output.bytesWritten}`);
+        const chunks = [];
+        const input = fs.createReadStream(source);
+        input.on('data', (chunk) => chunks.push(chunk));
+        input.on('end', () => {
+            const data = Buffer.concat(chunks);
+            print(`read stream: ${data.length} bytes, ${chunks.length > 1 ? 'several chunks' : 'one chunk'}, ` +
+                  `equal ${data.equals(payload)}`);
+            testRange();
+        });
+    });
+}
+
+function testRange() {
+    const chunks = [];
+    const input = fs.createReadStream(source, { start: 10, end: 19 });
+    input.on('data', (chunk) => chunks.push(chunk));
+    input.on('end', () => {
+        print(`range: ${Buffer.concat(chunks).equals(payload.subarray(10, 20))}`);
+        testMissing();
+    });
+}
+
+function testMissing() {
+    const input = fs.createReadStream('test/no-such-file.tmp');
+    input.on('error', (error) => {
+        print(`missing file: ${error.code} ${error.syscall}`);
+        testFileCopy();
+    });
+}
+
+function testFileCopy() {
+    pipeline(fs.createReadStream(source), fs.createWriteStream(copy), (err) => {
+        const chunks = [];
+        const input = fs.createReadStream(copy);
+        input.on('data', (chunk) => chunks.push(chunk));
+        input.on('end', () => {
+            print(`file to file: ${err || 'ok'}, equal ${Buffer.concat(chunks).equals(payload)}`);
+            testFileToSocket();
+        });
+    });
+}
+
+function testFileToSocket() {
+    // The server pipes the file into each connection; the client checks what arrives
+    const server = net.createServer((socket) => {
+        pipeline(fs.createReadStream(source), socket, (err) => print(`file to socket: ${err || 'ok'}`));
+    });
+    server.listen(0, '127.0.0.1', () => {
+        const chunks = [];
+        const client = net.connect(server.address().port, '127.0.0.1');
+        client.on('data', (chunk) => chunks.push(chunk));
+        client.on('end', () => {
+            print(`received: ${Buffer.concat(chunks).equals(payload)}`);
+            client.end();
+            server.close(testTransform);
+        });
+    });
+}
+
+function testTransform() {
+    // A Transform in the middle keeps the pipeline in JavaScript
+    const upper = new Transform({
+        transform(chunk, encoding, callback) {
+            callback(null, chunk.toString().toUpperCase());
+        },
+    });
+    const output = fs.createWriteStream(copy);
+    pipeline(Readable.from(['stream ', 'test']), upper, output, (err) => {
+        print(`transform pipeline: ${err || 'ok'}, ${fs.readFile(copy)}`);
+        fs.createWriteStream(copy, { flags: 'a' }).end('!', () => {
+            print(`append: ${fs.readFile(copy)}`);
+            testReadFilePromise();
+        });
+    });
+}
+
+function testReadFilePromise() {
+    // fs.promises.readFile reads the whole file on the thread pool
+    fs.promises.readFile(source).then((data) => {
+        print(`promises.readFile: ${Buffer.isBuffer(data)}, equal ${data.equals(payload)}`);
+        return fs.promises.readFile(copy, 'utf8');
+    }).then((text) => {
+        print(`promises.readFile utf8: ${text}`);
+        return fs.promises.readFile('test/missing-file');
+    }).catch((err) => {
+        print(`promises.readFile missing: ${err.message}`);
+        print("===== Stream Module Test Complete =====");
+    });
+}
@@ -0,0 +1,77 @@
+/**
+ * Test Script for TextEncoder and TextDecoder in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - TextEncoder.encode/encodeInto: ASCII, Latin-1 and two-byte strings
+ * - TextDecoder: utf-8, utf-16le and latin1 (windows-1252)
+ * - Streaming: Characters split across chunks
+ * - fatal and ignoreBOM options
+ */
+
+print("===== TextEncoder/TextDecoder Test =====");
+
+const hex = (bytes) => Array.from(bytes, (b) => b.toString(16).padStart(2, '0')).join('');
+
+// Encoding
+const encoder = new TextEncoder();
+print(`encoding: ${encoder.encoding}`);
+print(`ascii: ${hex(encoder.encode('tiny'))}`);
+print(`latin1 string: ${hex(encoder.encode('café'))}`);
+print(`two-byte string: ${hex(encoder.encode('€😀'))}`);
+print(`lone surrogate: ${hex(encoder.encode('\ud800'))}`);
+print(`is Uint8Array: ${encoder.encode('x') instanceof Uint8Array}`);
+
+// encodeInto never splits a character
+const target = new Uint8Array(5);
+const result = encoder.encodeInto('ab€c', target);
+print(`encodeInto: read ${result.read}, written ${result.written}, ${hex(target)}`);
+const small = new Uint8Array(3);
+const latin1Result = encoder.encodeInto('aéé', small);
+print(`encodeInto latin1: read ${latin1Result.read}, written ${latin1Result.written}`);
+
+// Decoding
+const decoder = new TextDecoder();
+print(`utf-8: ${decoder.decode(encoder.encode('héllo wörld'))}`);
+print(`invalid utf-8: ${decoder.decode(new Uint8Array([0x61, 0xff, 0x62])) === 'a�b'}`);
+print(`BOM stripped: ${decoder.decode(new Uint8Array([0xef, 0xbb, 0xbf, 0x41]))}`);
+print(`ArrayBuffer input: ${decoder.decode(encoder.encode('buffer').buffer)}`);
+
+const utf16 = new TextDecoder('utf-16le');
+print(`utf-16le: ${utf16.decode(new Uint8Array([0x68, 0x00, 0x69, 0x00]))}`);
+
+const latin1 = new TextDecoder('latin1');
+print(`latin1 encoding: ${latin1.encoding}`);
+print(`latin1: ${latin1.decode(new Uint8Array([0x63, 0x61, 0x66, 0xe9, 0x80]))}`);
+
+// Streaming: a four-byte character split one byte per chunk
+const streaming = new TextDecoder();
+const bytes = encoder.encode('a😀b');
+let text = '';
+for (let i = 0; i < bytes.length; i++) {
+    text += streaming.decode(bytes.subarray(i, i + 1), { stream: true });
+}
+text += streaming.decode();
+print(`streamed: ${text === 'a😀b'}`);
+
+const streaming16 = new TextDecoder('utf-16le');
+const pair = new Uint8Array([0x3d, 0xd8, 0x00, 0xde]);
+const part = streaming16.decode(pair.subarray(0, 3), { stream: true }) + streaming16.decode(pair.subarray(3));
+print(`streamed utf-16le: ${part === '😀'}`);
+
+// Options
+try {
+    new TextDecoder('utf-8', { fatal: true }).decode(new Uint8Array([0xc3]));
+    print('fatal: no error');
+} catch (e) {
+    print(`fatal: ${e.message}`);
+}
+const keepBom = new TextDecoder('utf-8', { ignoreBOM: true });
+print(`ignoreBOM keeps BOM: ${keepBom.decode(new Uint8Array([0xef, 0xbb, 0xbf])).length === 1}`);
+
+try {
+    new TextDecoder('klingon');
+} catch (e) {
+    print(`unsupported: ${e.message}`);
+}
+
+print("===== TextEncoder/TextDecoder Test Complete =====");
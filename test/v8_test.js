@@ -0,0 +1,81 @@
+/**
+ * Test Script for the V8 Module in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - v8.serialize/v8.deserialize: Structured clone round trips
+ * - Transferable ArrayBuffers: Moving memory without copying
+ * - v8.releaseTransfers: Dropping the buffers kept for serialized bytes
+ * - v8.createWriter/v8.createReader: Streaming records to and from a file
+ */
+
+print("===== V8 Module Test =====");
+
+const v8 = require('v8');
+
+// Round trip values that JSON cannot represent
+const original = {
+    name: 'cache-entry',
+    created: new Date(0),
+    tags: new Set(['a', 'b']),
+    lookup: new Map([[1, 'one']]),
+    bytes: new Uint8Array([1, 2, 3]),
+};
+original.self = original;
+
+const bytes = v8.serialize(original);
+print(`Serialized size: ${bytes.length} bytes`);
+
+const copy = v8.deserialize(bytes);
+print(`name: ${copy.name}`);
+print(`created: ${copy.created.toISOString()}`);
+print(`tags: ${[...copy.tags].join(',')}`);
+print(`lookup: ${copy.lookup.get(1)}`);
+print(`bytes: ${copy.bytes.join(',')}`);
+print(`Cycle preserved: ${copy.self === copy}`);
+
+// Transfer an ArrayBuffer instead of copying it
+const payload = new Uint8Array([9, 8, 7]).buffer;
+const message = v8.serialize({ payload }, { transfer: [payload] });
+print(`Source detached: ${payload.byteLength === 0}`);
+const received = v8.deserialize(message);
+print(`Transferred bytes: ${new Uint8Array(received.payload).join(',')}`);
+
+// Shared buffers are kept with the bytes: every deserialization sees the same memory
+const shared = new SharedArrayBuffer(4);
+const sharedMessage = v8.serialize({ shared });
+const first = v8.deserialize(sharedMessage);
+const second = v8.deserialize(sharedMessage);
+new Uint8Array(first.shared)[0] = 42;
+print(`Shared across deserializations: ${new Uint8Array(second.shared)[0] === 42}`);
+
+// Releasing the bytes drops what was kept for them
+print(`Released: ${v8.releaseTransfers(sharedMessage)}`);
+print(`Released again: ${v8.releaseTransfers(sharedMessage)}`);
+try {
+    v8.deserialize(sharedMessage);
+    print('Deserialized after release: unexpected');
+} catch (e) {
+    print(`Deserialize after release throws: ${e.message}`);
+}
+
+// Stream many records through a file
+const file = 'test/v8-records.bin';
+const fs = require('fs');
+fs.writeFile(file, '');
+const writer = v8.createWriter(file);
+for (let i = 0; i < 1000; i++) {
+    writer.write({ id: i, label: `record-${i}` });
+}
+writer.close();
+
+const reader = v8.createReader(file);
+let count = 0;
+let last;
+for (let record = reader.read(); record !== undefined; record = reader.read()) {
+    last = record;
+    count++;
+}
+reader.close();
+print(`Records read: ${count}, last label: ${last.label}`);
+
+print("\n===== V8 Module Test Complete =====");
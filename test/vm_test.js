@@ -0,0 +1,79 @@
+/**
+ * Test Script for the Vm Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - createContext/runInContext: Globals read from and written to the sandbox
+ * - Script: One compiled script run in many contexts
+ * - Code cache: cachedData produced, accepted and rejected
+ * - Errors: Syntax errors, thrown exceptions and non-contexts
+ */
+
+print("===== Vm Module Test =====");
+
+const vm = require('vm');
+
+// Globals of a context live on its sandbox
+const sandbox = vm.createContext({ x: 2, log: [] });
+print(`isContext: ${vm.isContext(sandbox)} ${vm.isContext({})}`);
+vm.runInContext('var y = x * 10; function twice(v) { return v * 2; } z = twice(y); log.push(typeof Array);', sandbox);
+print(`sandbox: y=${sandbox.y} z=${sandbox.z} twice=${typeof sandbox.twice} log=${sandbox.log.join()}`);
+print(`createContext is idempotent: ${vm.createContext(sandbox) === sandbox}`);
+print(`isolated: ${vm.runInNewContext('typeof print')} ${vm.runInThisContext('typeof print')}`);
+
+// One script, compiled once, runs against many contexts
+const rule = new vm.Script('amount > limit ? "reject" : "accept"', { filename: 'rule.js' });
+const decisions = [];
+for (let i = 0; i < 100; i++) {
+    const tenant = vm.createContext({ amount: i, limit: 50 });
+    decisions.push(rule.runInContext(tenant));
+}
+print(`decisions: ${decisions.filter((d) => d === 'accept').length} accept, ` +
+      `${decisions.filter((d) => d === 'reject').length} reject`);
+const counter = vm.createContext({ count: 0 });
+const increment = new vm.Script('count += 1');
+for (let i = 0; i < 5; i++) {
+    increment.runInContext(counter);
+}
+print(`counter: ${counter.count}`);
+
+// A code cache lets a later compile of the same source skip compiling
+const source = 'function fib(n) { return n < 2 ? n : fib(n - 1) + fib(n - 2); } fib(15)';
+const producer = new vm.Script(source, { filename: 'fib.js', produceCachedData: true });
+print(`cache produced: ${producer.cachedDataProduced} ${Buffer.isBuffer(producer.cachedData)}`);
+const consumer = new vm.Script(source, { filename: 'fib.js', cachedData: producer.cachedData });
+print(`cache accepted: ${!consumer.cachedDataRejected}, result ${consumer.runInNewContext()}`);
+const other = new vm.Script(source + ';', { cachedData: producer.createCachedData() });
+print(`cache for other source rejected: ${other.cachedDataRejected}`);
+
+// Errors
+try {
+    new vm.Script('let = ;');
+} catch (error) {
+    print(`syntax error: ${error.name}`);
+}
+try {
+    vm.runInContext('throw new Error("from context")', vm.createContext());
+} catch (error) {
+    print(`thrown: ${error.message}`);
+}
+try {
+    rule.runInContext({});
+} catch (error) {
+    print(`not a context: ${error.name}`);
+}
+
+// Timeout
+try {
+    vm.runInNewContext('while (true) {}', {}, { timeout: 50 });
+    print("timeout: FAILED, loop returned");
+} catch (error) {
+    print(`timeout: ${error.code}`);
+}
+print(`after timeout: ${vm.runInNewContext('x * 2', { x: 21 }, { timeout: 1000 })}`);
+try {
+    vm.runInThisContext('1', { timeout: -1 });
+} catch (error) {
+    print(`bad timeout: ${error.code}`);
+}
+
+print("===== Vm Module Test Complete =====");
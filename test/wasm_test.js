@@ -0,0 +1,117 @@
+/**
+ * Test Script for the Wasm Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - compileStreaming: Modules streamed from .wasm files and instantiated
+ * - Cache: Compiled modules written, reused, and rejected once the file changes
+ * - Errors: Bad sources, missing files and invalid modules
+ */
+
+print("===== Wasm Module Test =====");
+
+const fs = require('fs');
+const wasm = require('wasm');
+
+const kernel = 'test/wasm-kernel.tmp';
+const broken = 'test/wasm-broken.tmp';
+wasm.setCacheDirectory('test/wasm-cache.tmp');
+
+// add(a, b) and triangle(n), the sum of 1..n
+const bytes = [
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00,
+    0x01, 0x0c, 0x02, 0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7f,
+    0x03, 0x03, 0x02, 0x00, 0x01,
+    0x07, 0x12, 0x02, 0x03, 0x61, 0x64, 0x64, 0x00, 0x00,
+    0x08, 0x74, 0x72, 0x69, 0x61, 0x6e, 0x67, 0x6c, 0x65, 0x00, 0x01,
+    0x0a, 0x2b, 0x02,
+    0x07, 0x00, 0x20, 0x00, 0x20, 0x01, 0x6a, 0x0b,
+    0x21, 0x01, 0x01, 0x7f, 0x02, 0x40, 0x03, 0x40,
+    0x20, 0x00, 0x45, 0x0d, 0x01,
+    0x20, 0x01, 0x20, 0x00, 0x6a, 0x21, 0x01,
+    0x20, 0x00, 0x41, 0x01, 0x6b, 0x21, 0x00,
+    0x0c, 0x00, 0x0b, 0x0b, 0x20, 0x01, 0x0b,
+];
+
+// A custom section changes the file without changing the code
+function customSection(name) {
+    const section = [name.length].concat(Array.from(name, (c) => c.charCodeAt(0)));
+    return [0x00, section.length].concat(section);
+}
+
+function sleep(ms) {
+    return new Promise((resolve) => setTimeout(resolve, ms));
+}
+
+function writeFile(path, contents) {
+    return new Promise((resolve, reject) => {
+        const output = fs.createWriteStream(path);
+        output.on('error', reject);
+        output.on('finish', resolve);
+        output.end(Buffer.from(contents));
+    });
+}
+
+async function main() {
+    // Each run compiles a file no earlier run has cached
+    const contents = bytes.concat(customSection('run' + Date.now()));
+    await writeFile(kernel, contents);
+    await writeFile(broken, [0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0xff]);
+    print(`cache directory: ${wasm.cacheDirectory()}`);
+    
+    // Stream a module from a file
+    const module = await wasm.compileFile(kernel);
+    const names = WebAssembly.Module.exports(module).map((entry) => entry.name);
+    print(`compiled: ${module instanceof WebAssembly.Module} exports=${names.join()}`);
+    const instance = await WebAssembly.instantiate(module);
+    print(`add: ${instance.exports.add(2, 3)} triangle: ${instance.exports.triangle(100)}`);
+    
+    // instantiateStreaming takes a source too
+    const result = await WebAssembly.instantiateStreaming(wasm.source(kernel));
+    print(`instantiateStreaming: ${result.instance.exports.triangle(1000)}`);
+    
+    let stats = wasm.stats();
+    print(`first compiles: hits=${stats.cacheHits} bytesStreamed=${stats.bytesStreamed === 2 * contents.length} ` +
+          `compiling=${stats.compiling}`);
+    
+    // Only optimized code is cached, so run the kernel until tier-up has happened
+    for (let i = 0; i < 200 && wasm.stats().cacheWrites === 0; i++) {
+        result.instance.exports.triangle(1000000);
+        await wasm.flushCache();
+        await sleep(5);
+    }
+    print(`cache written: ${wasm.stats().cacheWrites > 0}`);
+    
+    // The next compile of the same file comes from the cache
+    const cached = await wasm.compileFile(kernel);
+    stats = wasm.stats();
+    print(`from cache: hits=${stats.cacheHits} works=${new WebAssembly.Instance(cached).exports.add(20, 22)}`);
+    
+    // A changed file does not use the old code
+    await writeFile(kernel, contents.concat(customSection('changed')));
+    const before = stats;
+    const changed = await wasm.instantiateFile(kernel);
+    stats = wasm.stats();
+    print(`changed file: hits=${stats.cacheHits - before.cacheHits} rejected=${stats.cacheRejected - before.cacheRejected} ` +
+          `works=${changed.instance.exports.triangle(10)}`);
+    
+    // Errors
+    try {
+        await WebAssembly.compileStreaming({ path: kernel });
+    } catch (error) {
+        print(`not a source: ${error.name}`);
+    }
+    try {
+        await wasm.compileFile('test/no-such-file.wasm');
+    } catch (error) {
+        print(`missing file: ${error.message.startsWith('Failed to open')}`);
+    }
+    try {
+        await wasm.compileFile(broken);
+    } catch (error) {
+        print(`invalid module: ${error instanceof WebAssembly.CompileError}`);
+    }
+    
+    print("===== Wasm Module Test Complete =====");
+}
+
+main();
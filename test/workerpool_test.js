@@ -0,0 +1,109 @@
+/**
+ * Test Script for the Workerpool Module in Tiny Node.js Runtime
+ *
+ * This script tests:
+ * - run: Function and module path tasks, sync and async, across the pool
+ * - Errors: Exceptions thrown by a task reach the caller
+ * - Transfer: ArrayBuffers moved to a worker and back
+ * - Cancel and timeout: Queued and running tasks stopped, worker reused
+ * - stats/terminate: Counters and rejection of outstanding tasks
+ */
+
+print("===== Workerpool Module Test =====");
+
+const { WorkerPool, transfer, isWorker } = require('workerpool');
+
+const pool = new WorkerPool({ size: 2 });
+print(`pool size: ${pool.size}, isWorker: ${isWorker}`);
+
+function fib(n) {
+    return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+async function main() {
+    // Function tasks spread over the workers
+    const results = await Promise.all([20, 21, 22, 23].map((n) => pool.run(fib, [n])));
+    print(`fib: ${results.join(' ')}`);
+    
+    // A module path with a named export
+    print(`math.add: ${await pool.run('./test/math', [2, 3], { method: 'add' })}`);
+    
+    // Async tasks settle when their promise does
+    const delayed = await pool.run(function(value) {
+        return new Promise((resolve) => setTimeout(() => resolve(value * 2), 10));
+    }, [21]);
+    print(`async: ${delayed}`);
+    
+    // Exceptions are cloned back to the caller
+    try {
+        await pool.run(function() {
+            throw new RangeError('bad input');
+        });
+    } catch (error) {
+        print(`thrown: ${error.name} ${error.message}`);
+    }
+    
+    // Transferred buffers are moved, not copied, in both directions
+    const input = new Uint8Array([1, 2, 3, 4]).buffer;
+    const output = await pool.run(function(buffer) {
+        const bytes = new Uint8Array(buffer);
+        for (let i = 0; i < bytes.length; i++) {
+            bytes[i] *= 10;
+        }
+        return require('workerpool').transfer(buffer, [buffer]);
+    }, [input], { transfer: [input] });
+    print(`transfer: detached=${input.byteLength === 0} result=${Array.from(new Uint8Array(output)).join()}`);
+    
+    // A task that never finishes is stopped by its timeout
+    const spin = function() {
+        for (;;) {}
+    };
+    try {
+        await pool.run(spin, [], { timeout: 50 });
+    } catch (error) {
+        print(`timeout: ${error.code}`);
+    }
+    
+    // Cancel a running task and one still queued behind the busy workers
+    const running = [pool.run(spin), pool.run(spin)];
+    const queued = pool.run(fib, [10]);
+    queued.cancel();
+    running.forEach((task) => task.cancel());
+    const settled = await Promise.allSettled(running.concat(queued));
+    print(`cancelled: ${settled.map((result) => result.reason.code).join(' ')}`);
+    
+    // The workers are still usable afterwards
+    print(`after cancel: ${await pool.run(fib, [15])}`);
+    
+    const stats = pool.stats();
+    print(`stats: workers=${stats.workers} submitted=${stats.submitted} failed=${stats.failed} ` +
+          `cancelled=${stats.cancelled} timedOut=${stats.timedOut} pending=${stats.pending}`);
+    
+    // Terminating rejects whatever is still outstanding
+    const outstanding = pool.run(spin);
+    await pool.terminate();
+    try {
+        await outstanding;
+    } catch (error) {
+        print(`terminated: ${error.code}`);
+    }
+    try {
+        await pool.run(fib, [1]);
+    } catch (error) {
+        print(`after terminate: ${error.code}`);
+    }
+    
+    // Workers can be pinned to CPUs or NUMA nodes
+    const pinned = new WorkerPool({ size: 2, affinity: 'node:0' });
+    print(`pinned: ${await pinned.run(fib, [10])}`);
+    await pinned.terminate();
+    try {
+        new WorkerPool({ size: 1, affinity: 'node:9999' });
+    } catch (error) {
+        print(`bad affinity: ${error.name}`);
+    }
+    
+    print("===== Workerpool Module Test Complete =====");
+}
+
+main();
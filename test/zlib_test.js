@@ -0,0 +1,77 @@
+/**
+ * Test Script for the Zlib Module in Tiny Node.js Runtime
+ * 
+ * This script tests:
+ * - deflateSync/inflateSync, gzipSync/gunzipSync and raw deflate round trips
+ * - gzip/gunzip: Compression on the thread pool
+ * - createGzip/createGunzip: Streaming compression through pipe()
+ * - Errors for corrupt and truncated input
+ */
+
+print("===== Zlib Module Test =====");
+
+const zlib = require('zlib');
+
+const text = 'tiny_node compresses log archives and HTTP payloads. '.repeat(2000);
+const data = Buffer.from(text);
+
+// Synchronous round trips
+for (const [compress, decompress] of [['deflate', 'inflate'], ['gzip', 'gunzip'], ['deflateRaw', 'inflateRaw']]) {
+    const compressed = zlib[compress + 'Sync'](data, { level: 9 });
+    const restored = zlib[decompress + 'Sync'](compressed);
+    print(`${compress}: ${compressed.length < data.length / 20} ${restored.toString() === text}`);
+}
+print(`unzip detects gzip: ${zlib.unzipSync(zlib.gzipSync('abc')).toString()}`);
+print(`gzip magic: ${Array.from(zlib.gzipSync('abc').subarray(0, 2)).join(',')}`);
+
+// Concatenated gzip members decompress as one stream
+const twice = Buffer.concat([zlib.gzipSync('ab'), zlib.gzipSync('cd')]);
+print(`concatenated members: ${zlib.gunzipSync(twice).toString()}`);
+
+// Errors carry zlib's code
+try {
+    zlib.inflateSync(Buffer.from('not compressed'));
+} catch (error) {
+    print(`corrupt input: ${error.code} (${error.message})`);
+}
+try {
+    const compressed = zlib.gzipSync(data);
+    zlib.gunzipSync(compressed.subarray(0, compressed.length - 10));
+} catch (error) {
+    print(`truncated input: ${error.code} (${error.message})`);
+}
+try {
+    zlib.deflateSync(data, { level: 12 });
+} catch (error) {
+    print(`bad level: ${error instanceof RangeError}`);
+}
+
+print(`crc32: ${zlib.crc32('hello')}`);
+
+// Asynchronous compression on the thread pool, then streaming
+zlib.gzip(data, (err, compressed) => {
+    print(`async gzip: ${!err && compressed.length > 0}`);
+    zlib.gunzip(compressed, (err, restored) => {
+        print(`async gunzip: ${!err && restored.toString() === text}`);
+        testStreams();
+    });
+});
+
+function testStreams() {
+    const gzip = zlib.createGzip();
+    const gunzip = zlib.createGunzip();
+    const chunks = [];
+
+    gunzip.on('data', (chunk) => chunks.push(chunk));
+    gunzip.on('end', () => {
+        print(`stream round trip: ${Buffer.concat(chunks).toString() === text}`);
+        print(`bytes written: ${gzip.bytesWritten}`);
+        print("===== Zlib Module Test Complete =====");
+    });
+    gzip.pipe(gunzip);
+
+    for (let i = 0; i < data.length; i += 4096) {
+        gzip.write(data.subarray(i, i + 4096));
+    }
+    gzip.end();
+}
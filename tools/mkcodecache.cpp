@@ -0,0 +1,107 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <memory>
+#include <cctype>
+#include "runtime.h"
+#include "module.h"
+#include "builtins.h"
+
+/**
+ * @brief Build-time tool that generates the code cache for built-in modules
+ * 
+ * Compiles every built-in module embedded by cmake/js2c.cmake exactly the
+ * way Module::Load does, serializes V8's code cache for it, and writes a C++
+ * source file defining the kBuiltinCodeCache table that src/builtins.cpp
+ * reads. The tool itself links src/builtin_code_cache_empty.cpp instead; the
+ * generated table goes into tiny_node_core, so embedders get it too.
+ * 
+ * Usage: tiny_node_mkcodecache <output.cpp>
+ */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <output.cpp>" << std::endl;
+        return 1;
+    }
+    
+    if (!Runtime::Initialize()) {
+        std::cerr << "Failed to initialize V8" << std::endl;
+        return 1;
+    }
+    
+    std::ostringstream arrays;
+    std::ostringstream entries;
+    size_t count = 0;
+    
+    {
+        RuntimeOptions options;
+        options.own_loop_thread = false;
+        Runtime runtime(options);
+        
+        v8::Isolate* isolate = runtime.GetIsolate();
+        v8::Locker locker(isolate);
+        v8::Isolate::Scope isolate_scope(isolate);
+        v8::HandleScope handle_scope(isolate);
+        v8::Local<v8::Context> context = v8::Context::New(isolate);
+        v8::Context::Scope context_scope(context);
+        
+        for (size_t i = 0; i < GetBuiltinSourceCount(); i++) {
+            const BuiltinSource* builtin = GetBuiltinSource(i);
+            
+            v8::TryCatch try_catch(isolate);
+            v8::Local<v8::Function> function;
+            if (!Module::CompileFunction(context, NewBuiltinSourceString(isolate, builtin),
+                                         builtin->id, nullptr, true).ToLocal(&function)) {
+                v8::String::Utf8Value error(isolate, try_catch.Exception());
+                std::cerr << "Failed to compile built-in module " << builtin->id << ": " << *error << std::endl;
+                return 1;
+            }
+            
+            std::unique_ptr<v8::ScriptCompiler::CachedData> cache(
+                v8::ScriptCompiler::CreateCodeCacheForFunction(function));
+            if (!cache || cache->length <= 0) {
+                std::cerr << "No code cache produced for " << builtin->id << std::endl;
+                continue;
+            }
+            
+            // Module IDs become part of C identifiers
+            std::string symbol = builtin->id;
+            for (char& c : symbol) {
+                if (!std::isalnum(static_cast<unsigned char>(c))) {
+                    c = '_';
+                }
+            }
+            
+            arrays << "static const uint8_t k_" << symbol << "_code_cache[] = {";
+            for (int j = 0; j < cache->length; j++) {
+                arrays << static_cast<int>(cache->data[j]) << ",";
+            }
+            arrays << "};\n";
+            entries << "    {\"" << builtin->id << "\", k_" << symbol << "_code_cache, "
+                    << cache->length << "},\n";
+            count++;
+        }
+    }
+    
+    std::ofstream output(argv[1]);
+    if (!output.is_open()) {
+        std::cerr << "Failed to open output file: " << argv[1] << std::endl;
+        return 1;
+    }
+    
+    output << "// Generated by tiny_node_mkcodecache. Do not edit.\n"
+           << "#include \"builtins.h\"\n\n"
+           << arrays.str() << "\n";
+    
+    // Keep the table well-formed when nothing was cached
+    if (count == 0) {
+        entries << "    {nullptr, nullptr, 0},\n";
+    }
+    output << "extern const BuiltinCodeCache kBuiltinCodeCache[] = {\n"
+           << entries.str() << "};\n\n"
+           << "extern const size_t kBuiltinCodeCacheCount = " << count << ";\n";
+    
+    Runtime::Shutdown();
+    return 0;
+}